@@ -921,6 +921,30 @@
  */
 #define MBEDTLS_PKCS1_V21
 
+/**
+ * \def MBEDTLS_PSA_CRYPTO_KEY_CACHE
+ *
+ * Keep persistent keys loaded in memory after psa_close_key(), so that a
+ * later psa_open_key() of the same key identifier does not read and parse
+ * the key from storage again.
+ *
+ * Up to MBEDTLS_PSA_KEY_CACHE_SIZE closed keys are kept, in otherwise
+ * unused key slots. The least recently closed key is dropped when the
+ * cache is full or when a key slot is needed for another key.
+ *
+ * \warning Closed keys remain in RAM until they are dropped from the cache,
+ *          psa_destroy_key() is called on the same key, or
+ *          mbedtls_psa_crypto_free() is called. Changes made to the key
+ *          storage other than through this library are not seen while a
+ *          key is cached.
+ *
+ * Module:  library/psa_crypto_slot_management.c
+ * Requires: MBEDTLS_PSA_CRYPTO_STORAGE_C
+ *
+ * Comment this macro to always load keys from storage in psa_open_key().
+ */
+//#define MBEDTLS_PSA_CRYPTO_KEY_CACHE
+
 /**
  * \def MBEDTLS_PSA_CRYPTO_SPM
  *
@@ -1916,6 +1940,9 @@
 //#define MBEDTLS_ENTROPY_MAX_GATHER                128 /**< Maximum amount requested from entropy sources */
 //#define MBEDTLS_ENTROPY_MIN_HARDWARE               32 /**< Default minimum number of bytes required for the hardware entropy source mbedtls_hardware_poll() before entropy is released */
 
+/* PSA crypto options */
+//#define MBEDTLS_PSA_KEY_CACHE_SIZE         4 /**< Maximum number of closed persistent keys kept in memory */
+
 /* Memory buffer allocator options */
 //#define MBEDTLS_MEMORY_ALIGN_MULTIPLE      4 /**< Align on multiples of this value */
 
@@ -66,6 +66,50 @@
       | (uint32_t) ( (uint32_t) (data)[( offset ) + 3] << 24 )    \
     )
 
+#define U32_TO_BYTES_LE( value, data, offset )                      \
+    do {                                                            \
+        (data)[offset]         = (unsigned char) ( (value)       ); \
+        (data)[( offset ) + 1] = (unsigned char) ( (value) >>  8 ); \
+        (data)[( offset ) + 2] = (unsigned char) ( (value) >> 16 ); \
+        (data)[( offset ) + 3] = (unsigned char) ( (value) >> 24 ); \
+    } while( 0 )
+
+/*
+ * Little-endian targets that can load and store unaligned words read and
+ * write the message a word at a time. This includes the Armv7E-M and
+ * Armv8-M Mainline cores with the DSP extension, and 32- and 64-bit x86.
+ */
+#if ( defined(__ARM_FEATURE_UNALIGNED) && defined(__ARMEL__) ) ||     \
+    ( defined(__aarch64__) && defined(__AARCH64EL__) ) ||             \
+    defined(__i386__) || defined(__x86_64__) ||                       \
+    defined(_M_IX86) || defined(_M_X64)
+#define CHACHA20_WORD_ACCESS
+#endif
+
+#if defined(CHACHA20_WORD_ACCESS)
+static inline uint32_t chacha20_load_u32( const unsigned char *p )
+{
+    uint32_t value;
+    memcpy( &value, p, sizeof( value ) );
+    return( value );
+}
+
+static inline void chacha20_store_u32( unsigned char *p, uint32_t value )
+{
+    memcpy( p, &value, sizeof( value ) );
+}
+#else
+static inline uint32_t chacha20_load_u32( const unsigned char *p )
+{
+    return( BYTES_TO_U32_LE( p, 0 ) );
+}
+
+static inline void chacha20_store_u32( unsigned char *p, uint32_t value )
+{
+    U32_TO_BYTES_LE( value, p, 0 );
+}
+#endif /* CHACHA20_WORD_ACCESS */
+
 #define ROTL32( value, amount ) \
     ( (uint32_t) ( (value) << (amount) ) | ( (value) >> ( 32 - (amount) ) ) )
 
@@ -82,107 +126,103 @@
  *                      3.  a += b; d ^= a; d <<<= 8;
  *                      4.  c += d; b ^= c; b <<<= 7;
  *
- * \param state     ChaCha20 state to modify.
- * \param a         The index of 'a' in the state.
- * \param b         The index of 'b' in the state.
- * \param c         The index of 'c' in the state.
- * \param d         The index of 'd' in the state.
+ *                  The state words are local variables, so that the
+ *                  compiler can keep as many of them in registers as the
+ *                  target has.
  */
-static inline void chacha20_quarter_round( uint32_t state[16],
-                                           size_t a,
-                                           size_t b,
-                                           size_t c,
-                                           size_t d )
-{
-    /* a += b; d ^= a; d <<<= 16; */
-    state[a] += state[b];
-    state[d] ^= state[a];
-    state[d] = ROTL32( state[d], 16 );
-
-    /* c += d; b ^= c; b <<<= 12 */
-    state[c] += state[d];
-    state[b] ^= state[c];
-    state[b] = ROTL32( state[b], 12 );
-
-    /* a += b; d ^= a; d <<<= 8; */
-    state[a] += state[b];
-    state[d] ^= state[a];
-    state[d] = ROTL32( state[d], 8 );
-
-    /* c += d; b ^= c; b <<<= 7; */
-    state[c] += state[d];
-    state[b] ^= state[c];
-    state[b] = ROTL32( state[b], 7 );
-}
+#define CHACHA20_QUARTER_ROUND( a, b, c, d )                    \
+    do {                                                        \
+        (a) += (b); (d) ^= (a); (d) = ROTL32( (d), 16 );        \
+        (c) += (d); (b) ^= (c); (b) = ROTL32( (b), 12 );        \
+        (a) += (b); (d) ^= (a); (d) = ROTL32( (d),  8 );        \
+        (c) += (d); (b) ^= (c); (b) = ROTL32( (b),  7 );        \
+    } while( 0 )
 
 /**
- * \brief           Perform the ChaCha20 inner block operation.
+ * \brief               Generates a keystream block.
  *
- *                  This function performs two rounds: the column round and the
- *                  diagonal round.
+ *                      The rounds run on local variables, so \p keystream
+ *                      is the only memory this function leaves secret data
+ *                      in. The caller reuses that buffer for every block it
+ *                      generates and zeroizes it once it is done.
  *
- * \param state     The ChaCha20 state to update.
+ * \param initial_state The initial ChaCha20 state (key, nonce, counter).
+ * \param keystream     The 16 keystream words are written to this buffer.
  */
-static void chacha20_inner_block( uint32_t state[16] )
+static void chacha20_block( const uint32_t initial_state[16],
+                            uint32_t keystream[16] )
 {
-    chacha20_quarter_round( state, 0, 4, 8,  12 );
-    chacha20_quarter_round( state, 1, 5, 9,  13 );
-    chacha20_quarter_round( state, 2, 6, 10, 14 );
-    chacha20_quarter_round( state, 3, 7, 11, 15 );
-
-    chacha20_quarter_round( state, 0, 5, 10, 15 );
-    chacha20_quarter_round( state, 1, 6, 11, 12 );
-    chacha20_quarter_round( state, 2, 7, 8,  13 );
-    chacha20_quarter_round( state, 3, 4, 9,  14 );
+    uint32_t x0  = initial_state[ 0], x1  = initial_state[ 1];
+    uint32_t x2  = initial_state[ 2], x3  = initial_state[ 3];
+    uint32_t x4  = initial_state[ 4], x5  = initial_state[ 5];
+    uint32_t x6  = initial_state[ 6], x7  = initial_state[ 7];
+    uint32_t x8  = initial_state[ 8], x9  = initial_state[ 9];
+    uint32_t x10 = initial_state[10], x11 = initial_state[11];
+    uint32_t x12 = initial_state[12], x13 = initial_state[13];
+    uint32_t x14 = initial_state[14], x15 = initial_state[15];
+    size_t i;
+
+    for( i = 0U; i < 10U; i++ )
+    {
+        /* Column round */
+        CHACHA20_QUARTER_ROUND( x0, x4, x8,  x12 );
+        CHACHA20_QUARTER_ROUND( x1, x5, x9,  x13 );
+        CHACHA20_QUARTER_ROUND( x2, x6, x10, x14 );
+        CHACHA20_QUARTER_ROUND( x3, x7, x11, x15 );
+
+        /* Diagonal round */
+        CHACHA20_QUARTER_ROUND( x0, x5, x10, x15 );
+        CHACHA20_QUARTER_ROUND( x1, x6, x11, x12 );
+        CHACHA20_QUARTER_ROUND( x2, x7, x8,  x13 );
+        CHACHA20_QUARTER_ROUND( x3, x4, x9,  x14 );
+    }
+
+    keystream[ 0] = x0  + initial_state[ 0];
+    keystream[ 1] = x1  + initial_state[ 1];
+    keystream[ 2] = x2  + initial_state[ 2];
+    keystream[ 3] = x3  + initial_state[ 3];
+    keystream[ 4] = x4  + initial_state[ 4];
+    keystream[ 5] = x5  + initial_state[ 5];
+    keystream[ 6] = x6  + initial_state[ 6];
+    keystream[ 7] = x7  + initial_state[ 7];
+    keystream[ 8] = x8  + initial_state[ 8];
+    keystream[ 9] = x9  + initial_state[ 9];
+    keystream[10] = x10 + initial_state[10];
+    keystream[11] = x11 + initial_state[11];
+    keystream[12] = x12 + initial_state[12];
+    keystream[13] = x13 + initial_state[13];
+    keystream[14] = x14 + initial_state[14];
+    keystream[15] = x15 + initial_state[15];
 }
 
 /**
- * \brief               Generates a keystream block.
+ * \brief               XOR a whole block of data with a keystream block,
+ *                      one word at a time.
  *
- * \param initial_state The initial ChaCha20 state (key, nonce, counter).
- * \param keystream     Generated keystream bytes are written to this buffer.
+ * \param keystream     The 16 keystream words.
+ * \param input         The 64-byte input block.
+ * \param output        The 64-byte output block. May be equal to \p input.
  */
-static void chacha20_block( const uint32_t initial_state[16],
-                            unsigned char keystream[64] )
+static void chacha20_xor_block( const uint32_t keystream[16],
+                                const unsigned char *input,
+                                unsigned char *output )
 {
-    uint32_t working_state[16];
     size_t i;
 
-    memcpy( working_state,
-            initial_state,
-            CHACHA20_BLOCK_SIZE_BYTES );
-
-    for( i = 0U; i < 10U; i++ )
-        chacha20_inner_block( working_state );
-
-    working_state[ 0] += initial_state[ 0];
-    working_state[ 1] += initial_state[ 1];
-    working_state[ 2] += initial_state[ 2];
-    working_state[ 3] += initial_state[ 3];
-    working_state[ 4] += initial_state[ 4];
-    working_state[ 5] += initial_state[ 5];
-    working_state[ 6] += initial_state[ 6];
-    working_state[ 7] += initial_state[ 7];
-    working_state[ 8] += initial_state[ 8];
-    working_state[ 9] += initial_state[ 9];
-    working_state[10] += initial_state[10];
-    working_state[11] += initial_state[11];
-    working_state[12] += initial_state[12];
-    working_state[13] += initial_state[13];
-    working_state[14] += initial_state[14];
-    working_state[15] += initial_state[15];
-
-    for( i = 0U; i < 16; i++ )
+    for( i = 0U; i < 16U; i += 4U )
     {
-        size_t offset = i * 4U;
-
-        keystream[offset     ] = (unsigned char)( working_state[i]       );
-        keystream[offset + 1U] = (unsigned char)( working_state[i] >>  8 );
-        keystream[offset + 2U] = (unsigned char)( working_state[i] >> 16 );
-        keystream[offset + 3U] = (unsigned char)( working_state[i] >> 24 );
+        const unsigned char *in = input + 4U * i;
+        unsigned char *out = output + 4U * i;
+        uint32_t w0 = chacha20_load_u32( in       ) ^ keystream[i    ];
+        uint32_t w1 = chacha20_load_u32( in +  4U ) ^ keystream[i + 1];
+        uint32_t w2 = chacha20_load_u32( in +  8U ) ^ keystream[i + 2];
+        uint32_t w3 = chacha20_load_u32( in + 12U ) ^ keystream[i + 3];
+
+        chacha20_store_u32( out,       w0 );
+        chacha20_store_u32( out +  4U, w1 );
+        chacha20_store_u32( out +  8U, w2 );
+        chacha20_store_u32( out + 12U, w3 );
     }
-
-    mbedtls_platform_zeroize( working_state, sizeof( working_state ) );
 }
 
 void mbedtls_chacha20_init( mbedtls_chacha20_context *ctx )
@@ -257,6 +297,7 @@ int mbedtls_chacha20_update( mbedtls_chacha20_context *ctx,
                               const unsigned char *input,
                               unsigned char *output )
 {
+    uint32_t working_state[16];
     size_t offset = 0U;
     size_t i;
 
@@ -279,20 +320,10 @@ int mbedtls_chacha20_update( mbedtls_chacha20_context *ctx,
     while( size >= CHACHA20_BLOCK_SIZE_BYTES )
     {
         /* Generate new keystream block and increment counter */
-        chacha20_block( ctx->state, ctx->keystream8 );
+        chacha20_block( ctx->state, working_state );
         ctx->state[CHACHA20_CTR_INDEX]++;
 
-        for( i = 0U; i < 64U; i += 8U )
-        {
-            output[offset + i  ] = input[offset + i  ] ^ ctx->keystream8[i  ];
-            output[offset + i+1] = input[offset + i+1] ^ ctx->keystream8[i+1];
-            output[offset + i+2] = input[offset + i+2] ^ ctx->keystream8[i+2];
-            output[offset + i+3] = input[offset + i+3] ^ ctx->keystream8[i+3];
-            output[offset + i+4] = input[offset + i+4] ^ ctx->keystream8[i+4];
-            output[offset + i+5] = input[offset + i+5] ^ ctx->keystream8[i+5];
-            output[offset + i+6] = input[offset + i+6] ^ ctx->keystream8[i+6];
-            output[offset + i+7] = input[offset + i+7] ^ ctx->keystream8[i+7];
-        }
+        chacha20_xor_block( working_state, input + offset, output + offset );
 
         offset += CHACHA20_BLOCK_SIZE_BYTES;
         size   -= CHACHA20_BLOCK_SIZE_BYTES;
@@ -302,9 +333,12 @@ int mbedtls_chacha20_update( mbedtls_chacha20_context *ctx,
     if( size > 0U )
     {
         /* Generate new keystream block and increment counter */
-        chacha20_block( ctx->state, ctx->keystream8 );
+        chacha20_block( ctx->state, working_state );
         ctx->state[CHACHA20_CTR_INDEX]++;
 
+        for( i = 0U; i < 16U; i++ )
+            U32_TO_BYTES_LE( working_state[i], ctx->keystream8, i * 4U );
+
         for( i = 0U; i < size; i++)
         {
             output[offset + i] = input[offset + i] ^ ctx->keystream8[i];
@@ -314,6 +348,9 @@ int mbedtls_chacha20_update( mbedtls_chacha20_context *ctx,
 
     }
 
+    /* One wipe covers every block generated by this call */
+    mbedtls_platform_zeroize( working_state, sizeof( working_state ) );
+
     return( 0 );
 }
 
@@ -55,6 +55,10 @@
 #define CHACHAPOLY_STATE_CIPHERTEXT ( 2 ) /* Encrypting or decrypting */
 #define CHACHAPOLY_STATE_FINISHED   ( 3 )
 
+/* Amount of data encrypted and authenticated in one go: a ChaCha20 block,
+ * which is also four Poly1305 blocks */
+#define CHACHAPOLY_CHUNK_SIZE       ( 64U )
+
 /**
  * \brief           Adds nul bytes to pad the AAD for Poly1305.
  *
@@ -192,6 +196,7 @@ int mbedtls_chachapoly_update( mbedtls_chachapoly_context *ctx,
                                unsigned char *output )
 {
     int ret;
+    size_t chunk_len;
     CHACHAPOLY_VALIDATE_RET( ctx != NULL );
     CHACHAPOLY_VALIDATE_RET( len == 0 || input != NULL );
     CHACHAPOLY_VALIDATE_RET( len == 0 || output != NULL );
@@ -213,25 +218,42 @@ int mbedtls_chachapoly_update( mbedtls_chachapoly_context *ctx,
 
     ctx->ciphertext_len += len;
 
-    if( ctx->mode == MBEDTLS_CHACHAPOLY_ENCRYPT )
+    /* Make a single pass over the data: each chunk of ciphertext is
+     * authenticated right after it has been produced (or right before it is
+     * decrypted), while it is still in the cache. */
+    while( len > 0U )
     {
-        ret = mbedtls_chacha20_update( &ctx->chacha20_ctx, len, input, output );
-        if( ret != 0 )
-            return( ret );
-
-        ret = mbedtls_poly1305_update( &ctx->poly1305_ctx, output, len );
-        if( ret != 0 )
-            return( ret );
-    }
-    else /* DECRYPT */
-    {
-        ret = mbedtls_poly1305_update( &ctx->poly1305_ctx, input, len );
-        if( ret != 0 )
-            return( ret );
-
-        ret = mbedtls_chacha20_update( &ctx->chacha20_ctx, len, input, output );
-        if( ret != 0 )
-            return( ret );
+        chunk_len = ( len < CHACHAPOLY_CHUNK_SIZE ) ? len :
+                                                    CHACHAPOLY_CHUNK_SIZE;
+
+        if( ctx->mode == MBEDTLS_CHACHAPOLY_ENCRYPT )
+        {
+            ret = mbedtls_chacha20_update( &ctx->chacha20_ctx, chunk_len,
+                                           input, output );
+            if( ret != 0 )
+                return( ret );
+
+            ret = mbedtls_poly1305_update( &ctx->poly1305_ctx, output,
+                                           chunk_len );
+            if( ret != 0 )
+                return( ret );
+        }
+        else /* DECRYPT */
+        {
+            ret = mbedtls_poly1305_update( &ctx->poly1305_ctx, input,
+                                           chunk_len );
+            if( ret != 0 )
+                return( ret );
+
+            ret = mbedtls_chacha20_update( &ctx->chacha20_ctx, chunk_len,
+                                           input, output );
+            if( ret != 0 )
+                return( ret );
+        }
+
+        input  += chunk_len;
+        output += chunk_len;
+        len    -= chunk_len;
     }
 
     return( 0 );
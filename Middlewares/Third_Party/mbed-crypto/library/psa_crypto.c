@@ -964,9 +964,12 @@ psa_status_t psa_destroy_key( psa_key_handle_t handle )
     {
         storage_status =
             psa_destroy_persistent_key( slot->persistent_storage_id );
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+        psa_forget_persistent_key( slot->persistent_storage_id );
+#endif
     }
 #endif /* defined(MBEDTLS_PSA_CRYPTO_STORAGE_C) */
-    status = psa_wipe_key_slot( slot );
+    status = psa_release_key_slot( handle );
     if( status != PSA_SUCCESS )
         return( status );
     return( storage_status );
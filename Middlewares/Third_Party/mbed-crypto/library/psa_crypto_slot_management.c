@@ -45,9 +45,35 @@
 
 #define ARRAY_LENGTH( array ) ( sizeof( array ) / sizeof( *( array ) ) )
 
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+#if !defined(MBEDTLS_PSA_KEY_CACHE_SIZE)
+#define MBEDTLS_PSA_KEY_CACHE_SIZE 4
+#endif
+#if MBEDTLS_PSA_KEY_CACHE_SIZE < 1 || \
+    MBEDTLS_PSA_KEY_CACHE_SIZE >= PSA_KEY_SLOT_COUNT
+#error "MBEDTLS_PSA_KEY_CACHE_SIZE must be between 1 and PSA_KEY_SLOT_COUNT - 1"
+#endif
+#endif /* MBEDTLS_PSA_CRYPTO_KEY_CACHE */
+
 typedef struct
 {
     psa_key_slot_t key_slots[PSA_KEY_SLOT_COUNT];
+    /* The slots that are neither allocated nor cached form a singly linked
+     * list starting at first_free. next_free[handle - 1] is the handle of
+     * the next free slot, and 0 terminates the list. */
+    psa_key_handle_t next_free[PSA_KEY_SLOT_COUNT];
+    psa_key_handle_t first_free;
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    /* Handles of the slots holding a closed persistent key, most recently
+     * closed first. These slots are not allocated, so their handle is
+     * invalid, but their content is intact. */
+    psa_key_handle_t cached[MBEDTLS_PSA_KEY_CACHE_SIZE];
+    size_t cached_count;
+    /* stale[handle - 1] is set on the allocated slots holding a copy of a
+     * persistent key that has been destroyed through another handle. Such
+     * a slot must not enter the cache when it is closed. */
+    uint8_t stale[PSA_KEY_SLOT_COUNT];
+#endif /* MBEDTLS_PSA_CRYPTO_KEY_CACHE */
     unsigned key_slots_initialized : 1;
 } psa_global_data_t;
 
@@ -79,11 +105,27 @@ psa_status_t psa_get_key_slot( psa_key_handle_t handle,
     return( PSA_SUCCESS );
 }
 
+/* Put a slot that is neither allocated nor cached on the free list. */
+static void psa_push_free_key_slot( psa_key_handle_t handle )
+{
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    global_data.stale[handle - 1] = 0;
+#endif
+    global_data.next_free[handle - 1] = global_data.first_free;
+    global_data.first_free = handle;
+}
+
 psa_status_t psa_initialize_key_slots( void )
 {
-    /* Nothing to do: program startup and psa_wipe_all_key_slots() both
-     * guarantee that the key slots are initialized to all-zero, which
-     * means that all the key slots are in a valid, empty state. */
+    psa_key_handle_t key;
+
+    /* Program startup and psa_wipe_all_key_slots() both guarantee that the
+     * key slots are initialized to all-zero, which means that all the key
+     * slots are in a valid, empty state. Build the free list so that
+     * slots are handed out from the highest handle down. */
+    global_data.first_free = 0;
+    for( key = 1; key <= PSA_KEY_SLOT_COUNT; key++ )
+        psa_push_free_key_slot( key );
     global_data.key_slots_initialized = 1;
     return( PSA_SUCCESS );
 }
@@ -96,42 +138,147 @@ void psa_wipe_all_key_slots( void )
         psa_key_slot_t *slot = &global_data.key_slots[key - 1];
         (void) psa_wipe_key_slot( slot );
     }
+    global_data.first_free = 0;
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    global_data.cached_count = 0;
+    memset( global_data.stale, 0, sizeof( global_data.stale ) );
+#endif
     global_data.key_slots_initialized = 0;
 }
 
-/** Find a free key slot and mark it as in use.
- *
- * \param[out] handle   On success, a slot number that is not in use. This
- *                      value can be used as a handle to the slot.
- *
- * \retval #PSA_SUCCESS
- * \retval #PSA_ERROR_INSUFFICIENT_MEMORY
- */
-static psa_status_t psa_internal_allocate_key_slot( psa_key_handle_t *handle )
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+static int psa_key_file_id_equal( psa_key_file_id_t id1,
+                                  psa_key_file_id_t id2 )
+{
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_FILE_ID_ENCODES_OWNER)
+    return( id1.key_id == id2.key_id && id1.owner == id2.owner );
+#else
+    return( id1 == id2 );
+#endif
+}
+
+/* Remove the entry at the given position from the cache. The slot itself
+ * is left untouched. */
+static psa_key_handle_t psa_key_cache_remove( size_t i )
+{
+    psa_key_handle_t handle = global_data.cached[i];
+    memmove( &global_data.cached[i], &global_data.cached[i + 1],
+             ( global_data.cached_count - i - 1 ) *
+             sizeof( global_data.cached[0] ) );
+    --global_data.cached_count;
+    return( handle );
+}
+
+/* Drop the entry at the given position from the cache, wipe the slot and
+ * put it on the free list. */
+static void psa_key_cache_drop( size_t i )
+{
+    psa_key_handle_t handle = psa_key_cache_remove( i );
+    (void) psa_wipe_key_slot( &global_data.key_slots[handle - 1] );
+    psa_push_free_key_slot( handle );
+}
+
+/* Drop the least recently closed key from the cache. */
+static void psa_key_cache_evict( void )
+{
+    psa_key_cache_drop( global_data.cached_count - 1 );
+}
+
+/* Find the cached copy of the persistent key with the given identifier,
+ * if any. Return its position in the cache, or -1. */
+static int psa_key_cache_find( psa_key_file_id_t id )
+{
+    size_t i;
+    for( i = 0; i < global_data.cached_count; i++ )
+    {
+        const psa_key_slot_t *slot =
+            &global_data.key_slots[global_data.cached[i] - 1];
+        if( psa_key_file_id_equal( slot->persistent_storage_id, id ) )
+            return( (int) i );
+    }
+    return( -1 );
+}
+
+/* Drop the cached copy of the persistent key with the given identifier,
+ * if any. */
+static void psa_key_cache_purge( psa_key_file_id_t id )
 {
-    for( *handle = PSA_KEY_SLOT_COUNT; *handle != 0; --( *handle ) )
+    int i = psa_key_cache_find( id );
+    if( i >= 0 )
+        psa_key_cache_drop( i );
+}
+
+void psa_forget_persistent_key( psa_key_file_id_t id )
+{
+    psa_key_handle_t key;
+
+    psa_key_cache_purge( id );
+    for( key = 1; key <= PSA_KEY_SLOT_COUNT; key++ )
     {
-        psa_key_slot_t *slot = &global_data.key_slots[*handle - 1];
-        if( ! slot->allocated )
+        const psa_key_slot_t *slot = &global_data.key_slots[key - 1];
+        if( slot->allocated &&
+            slot->lifetime == PSA_KEY_LIFETIME_PERSISTENT &&
+            psa_key_file_id_equal( slot->persistent_storage_id, id ) )
         {
-            slot->allocated = 1;
-            return( PSA_SUCCESS );
+            global_data.stale[key - 1] = 1;
         }
     }
-    return( PSA_ERROR_INSUFFICIENT_MEMORY );
 }
 
-/** Wipe a key slot and mark it as available.
+/* Move an allocated slot containing a persistent key to the cache. The
+ * handle becomes invalid. If another copy of the same key is already
+ * cached, keep that one and wipe this slot instead. */
+static void psa_key_cache_insert( psa_key_handle_t handle )
+{
+    psa_key_slot_t *slot = &global_data.key_slots[handle - 1];
+
+    if( psa_key_cache_find( slot->persistent_storage_id ) >= 0 )
+    {
+        (void) psa_wipe_key_slot( slot );
+        psa_push_free_key_slot( handle );
+        return;
+    }
+
+    if( global_data.cached_count == MBEDTLS_PSA_KEY_CACHE_SIZE )
+        psa_key_cache_evict( );
+
+    slot->allocated = 0;
+    memmove( &global_data.cached[1], &global_data.cached[0],
+             global_data.cached_count * sizeof( global_data.cached[0] ) );
+    global_data.cached[0] = handle;
+    ++global_data.cached_count;
+}
+#endif /* MBEDTLS_PSA_CRYPTO_KEY_CACHE */
+
+/** Find a free key slot and mark it as in use.
  *
- * This does not affect persistent storage.
+ * If no slot is free, a slot holding a cached key is reused.
  *
- * \param handle        The handle to the key slot to release.
+ * \param[out] handle   On success, a slot number that is not in use. This
+ *                      value can be used as a handle to the slot.
  *
  * \retval #PSA_SUCCESS
- * \retval #PSA_ERROR_INVALID_ARGUMENT
- * \retval #PSA_ERROR_TAMPERING_DETECTED
+ * \retval #PSA_ERROR_INSUFFICIENT_MEMORY
+ * \retval #PSA_ERROR_BAD_STATE
  */
-static psa_status_t psa_internal_release_key_slot( psa_key_handle_t handle )
+static psa_status_t psa_internal_allocate_key_slot( psa_key_handle_t *handle )
+{
+    if( ! global_data.key_slots_initialized )
+        return( PSA_ERROR_BAD_STATE );
+
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    if( global_data.first_free == 0 && global_data.cached_count != 0 )
+        psa_key_cache_evict( );
+#endif
+    *handle = global_data.first_free;
+    if( *handle == 0 )
+        return( PSA_ERROR_INSUFFICIENT_MEMORY );
+    global_data.first_free = global_data.next_free[*handle - 1];
+    global_data.key_slots[*handle - 1].allocated = 1;
+    return( PSA_SUCCESS );
+}
+
+psa_status_t psa_release_key_slot( psa_key_handle_t handle )
 {
     psa_key_slot_t *slot;
     psa_status_t status;
@@ -140,7 +287,14 @@ static psa_status_t psa_internal_release_key_slot( psa_key_handle_t handle )
     if( status != PSA_SUCCESS )
         return( status );
 
-    return( psa_wipe_key_slot( slot ) );
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    if( slot->lifetime == PSA_KEY_LIFETIME_PERSISTENT )
+        psa_key_cache_purge( slot->persistent_storage_id );
+#endif
+
+    status = psa_wipe_key_slot( slot );
+    psa_push_free_key_slot( handle );
+    return( status );
 }
 
 psa_status_t psa_allocate_key( psa_key_handle_t *handle )
@@ -251,6 +405,23 @@ static psa_status_t persistent_key_setup( psa_key_lifetime_t lifetime,
     if( lifetime != PSA_KEY_LIFETIME_PERSISTENT )
         return( PSA_ERROR_INVALID_ARGUMENT );
 
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    /* If the key was closed recently, it is still loaded: take it back
+     * from the cache without touching the storage. */
+    if( psa_is_key_id_valid( id ) )
+    {
+        int i = psa_key_cache_find( id );
+        if( i >= 0 )
+        {
+            if( wanted_load_status != PSA_SUCCESS )
+                return( PSA_SUCCESS );
+            *handle = psa_key_cache_remove( i );
+            global_data.key_slots[*handle - 1].allocated = 1;
+            return( PSA_SUCCESS );
+        }
+    }
+#endif /* MBEDTLS_PSA_CRYPTO_KEY_CACHE */
+
     status = psa_internal_allocate_key_slot( handle );
     if( status != PSA_SUCCESS )
         return( status );
@@ -258,7 +429,7 @@ static psa_status_t persistent_key_setup( psa_key_lifetime_t lifetime,
     status = psa_internal_make_key_persistent( *handle, id );
     if( status != wanted_load_status )
     {
-        psa_internal_release_key_slot( *handle );
+        psa_release_key_slot( *handle );
         *handle = 0;
     }
     return( status );
@@ -289,7 +460,28 @@ psa_status_t psa_create_key( psa_key_lifetime_t lifetime,
 
 psa_status_t psa_close_key( psa_key_handle_t handle )
 {
-    return( psa_internal_release_key_slot( handle ) );
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    psa_key_slot_t *slot;
+    psa_status_t status;
+
+    status = psa_get_key_slot( handle, &slot );
+    if( status != PSA_SUCCESS )
+        return( status );
+
+    /* Keep persistent keys loaded, but not slots created with
+     * psa_create_key() that were never filled, nor copies of a key that
+     * was destroyed through another handle, since there is no such key
+     * in storage. */
+    if( slot->lifetime == PSA_KEY_LIFETIME_PERSISTENT &&
+        slot->type != PSA_KEY_TYPE_NONE &&
+        ! global_data.stale[handle - 1] )
+    {
+        psa_key_cache_insert( handle );
+        return( PSA_SUCCESS );
+    }
+#endif /* MBEDTLS_PSA_CRYPTO_KEY_CACHE */
+
+    return( psa_release_key_slot( handle ) );
 }
 
 #endif /* MBEDTLS_PSA_CRYPTO_C */
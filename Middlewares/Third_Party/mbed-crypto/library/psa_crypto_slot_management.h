@@ -50,6 +50,33 @@ psa_status_t psa_get_key_slot( psa_key_handle_t handle,
  */
 psa_status_t psa_initialize_key_slots( void );
 
+/** Wipe a key slot and make it available for a new key.
+ *
+ * This does not affect persistent storage. The key is not kept in the
+ * persistent key cache, and any copy of the same persistent key that
+ * is in the cache is dropped.
+ *
+ * \param handle        The handle to the key slot to release.
+ *
+ * \retval #PSA_SUCCESS
+ * \retval #PSA_ERROR_INVALID_HANDLE
+ * \retval #PSA_ERROR_BAD_STATE
+ * \retval #PSA_ERROR_TAMPERING_DETECTED
+ */
+psa_status_t psa_release_key_slot( psa_key_handle_t handle );
+
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+/** Forget the copies in memory of a persistent key that is destroyed.
+ *
+ * The cached copy of the key, if any, is dropped. Slots that are still
+ * open on the key keep their content until they are closed, but are then
+ * released instead of entering the cache.
+ *
+ * \param id            The identifier of the destroyed key.
+ */
+void psa_forget_persistent_key( psa_key_file_id_t id );
+#endif /* MBEDTLS_PSA_CRYPTO_KEY_CACHE */
+
 /** Delete all data from key slots in memory.
  *
  * This does not affect persistent storage. */
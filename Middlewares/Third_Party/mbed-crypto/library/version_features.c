@@ -390,6 +390,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_PKCS1_V21)
     "MBEDTLS_PKCS1_V21",
 #endif /* MBEDTLS_PKCS1_V21 */
+#if defined(MBEDTLS_PSA_CRYPTO_KEY_CACHE)
+    "MBEDTLS_PSA_CRYPTO_KEY_CACHE",
+#endif /* MBEDTLS_PSA_CRYPTO_KEY_CACHE */
 #if defined(MBEDTLS_PSA_CRYPTO_SPM)
     "MBEDTLS_PSA_CRYPTO_SPM",
 #endif /* MBEDTLS_PSA_CRYPTO_SPM */
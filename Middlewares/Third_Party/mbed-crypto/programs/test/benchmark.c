@@ -52,6 +52,7 @@ int main( void )
 
 #include "mbedtls/timing.h"
 
+#include "mbedtls/md.h"
 #include "mbedtls/md4.h"
 #include "mbedtls/md5.h"
 #include "mbedtls/ripemd160.h"
@@ -83,6 +84,10 @@ int main( void )
 
 #include "mbedtls/error.h"
 
+#if defined(MBEDTLS_PSA_CRYPTO_C)
+#include "psa/crypto.h"
+#endif
+
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
 #include "mbedtls/memory_buffer_alloc.h"
 #endif
@@ -99,107 +104,371 @@ int main( void )
  */
 #define HEAP_SIZE       (1u << 16)  // 64k
 
+/*
+ * Message size used by default for the symmetric primitives, and largest
+ * size that can be selected with sizes=.
+ */
 #define BUFSIZE         1024
+#if !defined(BENCH_MAX_SIZE)
+#define BENCH_MAX_SIZE  ( 64 * 1024 )
+#endif
+#define BENCH_MAX_SIZES 16
+
+/*
+ * Number of bytes processed while counting cycles, whatever the message size.
+ */
+#define BENCH_TSC_BYTES ( 1024 * 1024 )
+#define BENCH_TSC_ROUNDS( len )                                         \
+    ( ( len ) < BENCH_TSC_BYTES ? BENCH_TSC_BYTES / ( len ) : 1 )
+
 #define HEADER_FORMAT   "  %-24s :  "
 #define TITLE_LEN       25
 
 #define OPTIONS                                                         \
-    "md4, md5, ripemd160, sha1, sha256, sha512,\n"                      \
+    "md4, md5, ripemd160, sha1, sha256, sha512, hmac,\n"                \
     "arc4, des3, des, camellia, blowfish, chacha20,\n"                  \
     "aes_cbc, aes_gcm, aes_ccm, aes_ctx, chachapoly,\n"                 \
     "aes_cmac, des3_cmac, poly1305\n"                                   \
     "havege, ctr_drbg, hmac_drbg\n"                                     \
-    "rsa, dhm, ecdsa, ecdh.\n"
+    "rsa, dhm, ecdsa, ecdh,\n"                                          \
+    "psa_hash, psa_mac, psa_aead, psa_sign, psa_ka, psa_key.\n"         \
+    "format=text|csv|json\n"                                            \
+    "sizes=all|<size>[,<size>...] (multiples of 16, up to %u)\n"
+
+#define FORMAT_TEXT     0
+#define FORMAT_CSV      1
+#define FORMAT_JSON     2
+
+/*
+ * Output format and message sizes
+ */
+static struct
+{
+    int format;                         /* FORMAT_xxx                   */
+    size_t sizes[BENCH_MAX_SIZES];      /* message sizes to measure     */
+    size_t size_count;
+    int sizes_given;                    /* sizes= appeared              */
+    unsigned long results;              /* results printed so far       */
+} opt;
+
+static const size_t all_sizes[] = { 16, 64, 256, 1024, 4096, 16384, 65536 };
+
+#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) && defined(MBEDTLS_MEMORY_DEBUG)
+
+#define MEMORY_MEASURE_INIT                                             \
+    size_t max_used, max_blocks;                                        \
+    size_t prv_used, prv_blocks;                                        \
+    mbedtls_memory_buffer_alloc_cur_get( &prv_used, &prv_blocks );      \
+    mbedtls_memory_buffer_alloc_max_reset( );
+
+/* The maximum is only updated on allocation: it stays below the usage at
+ * the start if the operation did not allocate anything. */
+#define MEMORY_MEASURE_GET( heap )                                      \
+    mbedtls_memory_buffer_alloc_max_get( &max_used, &max_blocks );      \
+    if( max_used < prv_used || max_blocks < prv_blocks )                \
+        ( heap ) = 0;                                                   \
+    else                                                                \
+        ( heap ) = (long) ( max_used - prv_used +                       \
+                   MEM_BLOCK_OVERHEAD * ( max_blocks - prv_blocks ) );
+
+#else
+#define MEMORY_MEASURE_INIT
+#define MEMORY_MEASURE_GET( heap )      ( heap ) = -1;
+#endif
+
+/*
+ * An operation to measure: op( ctx, len ) processes a message of len bytes,
+ * or does one public-key operation when len is 0, and returns 0 on success.
+ */
+typedef int (*bench_op_t)( void *ctx, size_t len );
+
+/* Stack usage of an operation that went past the painted area */
+#define STACK_TOO_DEEP          -2
+
+/*
+ * The stack used by an operation is estimated by filling
+ * BENCH_STACK_PAINT_SIZE bytes below the current stack frame with a known
+ * pattern, running the operation once, and checking how much of the pattern
+ * was overwritten. This is done by default on hosted GCC-compatible builds.
+ * On targets with a small stack, define BENCH_STACK_PAINT_SIZE to a value
+ * that fits, or to 0 to disable the measurement.
+ */
+#if !defined(BENCH_STACK_PAINT_SIZE) && defined(__GNUC__) &&            \
+    ( defined(__unix__) || defined(__APPLE__) )
+#define BENCH_STACK_PAINT_SIZE  16384
+#endif
+
+#if defined(BENCH_STACK_PAINT_SIZE) && BENCH_STACK_PAINT_SIZE > 0
+
+#define STACK_PAINT_BYTE        0x5A
+
+/*
+ * Paint the area below the caller's frame, or return the number of bytes
+ * of it that are still painted, starting from the deepest one.
+ */
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static size_t stack_probe( int paint )
+{
+    volatile unsigned char area[BENCH_STACK_PAINT_SIZE];
+    size_t i;
+
+#if defined(__GNUC__)
+    /* The area is deliberately read without being written by this call:
+     * tell the compiler that it may have been. */
+    __asm__ __volatile__( "" : : "r" ( area ) : "memory" );
+#endif
+
+    if( paint )
+    {
+        for( i = 0; i < sizeof( area ); i++ )
+            area[i] = STACK_PAINT_BYTE;
+        return( 0 );
+    }
+
+    /* The stack grows down: the deepest bytes are at the start. */
+    for( i = 0; i < sizeof( area ) && area[i] == STACK_PAINT_BYTE; i++ )
+        ;
+    return( i );
+}
+
+/*
+ * Run an operation once and return the stack it used, or STACK_TOO_DEEP if
+ * it overwrote the whole painted area. Both probes and the operation are
+ * called from this function's frame, so they all start at the same stack
+ * pointer, whatever the code calling this function does with its own.
+ */
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+static long stack_measure( bench_op_t op, void *ctx, size_t len, int *ret )
+{
+    size_t unused;
+
+    (void) stack_probe( 1 );
+    *ret = op( ctx, len );
+    unused = stack_probe( 0 );
+
+    if( unused == 0 )
+        return( STACK_TOO_DEEP );
+    return( (long) ( BENCH_STACK_PAINT_SIZE - unused ) );
+}
 
+#define STACK_MEASURE( stack, OP, CTX, LEN )                            \
+    if( ret == 0 )                                                      \
+        ( stack ) = stack_measure( OP, CTX, LEN, &ret );                \
+    else                                                                \
+        ( stack ) = -1;
+
+#else
+#define STACK_MEASURE( stack, OP, CTX, LEN )    ( stack ) = -1;
+#endif
+
+/*
+ * Print the title of a measurement before it starts (text output only).
+ * msg_len is 0 for operations that do not process a message.
+ */
+static void print_header( const char *title, size_t msg_len )
+{
+    char header[TITLE_LEN + 16];
+
+    if( opt.format != FORMAT_TEXT )
+        return;
+
+    if( opt.sizes_given && msg_len != 0 )
+    {
+        mbedtls_snprintf( header, sizeof( header ), "%s, %u B",
+                          title, (unsigned) msg_len );
+        title = header;
+    }
+
+    mbedtls_printf( HEADER_FORMAT, title );
+    fflush( stdout );
+}
+
+/*
+ * Print the result of a measurement.
+ *
+ * For message processing, msg_len is the message size, the rate is in KiB/s
+ * and cycles is the number of cycles per byte. Otherwise msg_len is 0, the
+ * rate is in operations per second and cycles is not used. heap and stack
+ * are -1 when they were not measured, and stack is STACK_TOO_DEEP when the
+ * operation used more than BENCH_STACK_PAINT_SIZE bytes, which is reported
+ * as "n/a".
+ */
+static void print_result( const char *title, size_t msg_len,
+                          const char *unit, unsigned long rate,
+                          unsigned long cycles, long heap, long stack,
+                          int ret )
+{
+    char err[100];
+    size_t n;
+
+    /* TIME_PUBLIC() units are padded for alignment in text mode */
+    for( n = 0; unit[n] == ' '; n++ )
+        ;
+
+    if( ret != 0 )
+    {
+        /* PSA status codes are between -128 and -255, where there are no
+         * mbed TLS error codes */
+        if( ret <= -0x80 && ret > -0x100 )
+            mbedtls_snprintf( err, sizeof( err ), "PSA status %d", ret );
+        else
+        {
 #if defined(MBEDTLS_ERROR_C)
-#define PRINT_ERROR                                                     \
-        mbedtls_strerror( ret, ( char * )tmp, sizeof( tmp ) );          \
-        mbedtls_printf( "FAILED: %s\n", tmp );
+            mbedtls_strerror( ret, err, sizeof( err ) );
 #else
-#define PRINT_ERROR                                                     \
-        mbedtls_printf( "FAILED: -0x%04x\n", -ret );
+            mbedtls_snprintf( err, sizeof( err ), "-0x%04x", -ret );
 #endif
+        }
+    }
+
+    switch( opt.format )
+    {
+        case FORMAT_TEXT:
+            if( ret != 0 )
+            {
+                mbedtls_printf( "FAILED: %s\n", err );
+                return;
+            }
+            if( msg_len != 0 )
+            {
+                mbedtls_printf( "%9lu KiB/s,  %9lu cycles/byte",
+                                rate, cycles );
+                if( heap >= 0 )
+                    mbedtls_printf( ",  %6ld heap bytes", heap );
+            }
+            else
+            {
+                mbedtls_printf( "%6lu %s/s", rate, unit );
+                if( heap >= 0 )
+                {
+                    for( n = strlen( unit ) + 1; n < 12; n++ )
+                        mbedtls_printf( " " );
+                    mbedtls_printf( "%6ld heap bytes", heap );
+                }
+            }
+            if( stack >= 0 )
+                mbedtls_printf( ",  %6ld stack bytes", stack );
+            else if( stack == STACK_TOO_DEEP )
+                mbedtls_printf( ",  %6s stack bytes", "n/a" );
+            mbedtls_printf( "\n" );
+            break;
+
+        case FORMAT_CSV:
+            mbedtls_printf( "%s,%u,%s/s,", title, (unsigned) msg_len,
+                            msg_len != 0 ? "KiB" : unit + n );
+            if( ret == 0 )
+                mbedtls_printf( "%lu", rate );
+            mbedtls_printf( "," );
+            if( ret == 0 && msg_len != 0 )
+                mbedtls_printf( "%lu", cycles );
+            mbedtls_printf( "," );
+            if( ret == 0 && heap >= 0 )
+                mbedtls_printf( "%ld", heap );
+            mbedtls_printf( "," );
+            if( ret == 0 && stack >= 0 )
+                mbedtls_printf( "%ld", stack );
+            else if( ret == 0 && stack == STACK_TOO_DEEP )
+                mbedtls_printf( "n/a" );
+            mbedtls_printf( ",%s\n", ret == 0 ? "ok" : err );
+            break;
+
+        case FORMAT_JSON:
+            mbedtls_printf( "%s  { \"name\": \"%s\", \"size\": %u, "
+                            "\"unit\": \"%s/s\", ",
+                            opt.results == 0 ? "" : ",\n",
+                            title, (unsigned) msg_len,
+                            msg_len != 0 ? "KiB" : unit + n );
+            if( ret != 0 )
+            {
+                mbedtls_printf( "\"error\": \"%s\" }", err );
+                break;
+            }
+            mbedtls_printf( "\"rate\": %lu, \"cycles_per_byte\": ", rate );
+            if( msg_len != 0 )
+                mbedtls_printf( "%lu", cycles );
+            else
+                mbedtls_printf( "null" );
+            mbedtls_printf( ", \"heap_bytes\": " );
+            if( heap >= 0 )
+                mbedtls_printf( "%ld", heap );
+            else
+                mbedtls_printf( "null" );
+            mbedtls_printf( ", \"stack_bytes\": " );
+            if( stack >= 0 )
+                mbedtls_printf( "%ld", stack );
+            else if( stack == STACK_TOO_DEEP )
+                mbedtls_printf( "\"n/a\"" );
+            else
+                mbedtls_printf( "null" );
+            mbedtls_printf( " }" );
+            break;
+    }
 
-#define TIME_AND_TSC( TITLE, CODE )                                     \
+    opt.results++;
+}
+
+#define TIME_AND_TSC_LEN( TITLE, LEN, OP, CTX )                         \
 do {                                                                    \
-    unsigned long ii, jj, tsc;                                          \
+    const size_t msg_len = ( LEN );                                     \
+    unsigned long ii, jj, tsc, cycles = 0;                              \
+    long heap, stack;                                                   \
     int ret = 0;                                                        \
+    MEMORY_MEASURE_INIT;                                                \
                                                                         \
-    mbedtls_printf( HEADER_FORMAT, TITLE );                             \
-    fflush( stdout );                                                   \
+    print_header( TITLE, msg_len );                                     \
                                                                         \
     mbedtls_set_alarm( 1 );                                             \
     for( ii = 1; ret == 0 && ! mbedtls_timing_alarmed; ii++ )           \
     {                                                                   \
-        ret = CODE;                                                     \
+        ret = OP( CTX, msg_len );                                       \
     }                                                                   \
                                                                         \
     tsc = mbedtls_timing_hardclock();                                   \
-    for( jj = 0; ret == 0 && jj < 1024; jj++ )                          \
+    for( jj = 0; ret == 0 && jj < BENCH_TSC_ROUNDS( msg_len ); jj++ )   \
     {                                                                   \
-        ret = CODE;                                                     \
+        ret = OP( CTX, msg_len );                                       \
     }                                                                   \
+    if( ret == 0 )                                                      \
+        cycles = ( mbedtls_timing_hardclock() - tsc ) / ( jj * msg_len ); \
                                                                         \
-    if( ret != 0 )                                                      \
-    {                                                                   \
-        PRINT_ERROR;                                                    \
-    }                                                                   \
-    else                                                                \
-    {                                                                   \
-        mbedtls_printf( "%9lu KiB/s,  %9lu cycles/byte\n",              \
-                         ii * BUFSIZE / 1024,                           \
-                         ( mbedtls_timing_hardclock() - tsc )           \
-                         / ( jj * BUFSIZE ) );                          \
-    }                                                                   \
+    MEMORY_MEASURE_GET( heap );                                         \
+    STACK_MEASURE( stack, OP, CTX, msg_len );                           \
+                                                                        \
+    print_result( TITLE, msg_len, "KiB", ii * msg_len / 1024, cycles,   \
+                  heap, stack, ret );                                   \
 } while( 0 )
 
-#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) && defined(MBEDTLS_MEMORY_DEBUG)
-
-#define MEMORY_MEASURE_INIT                                             \
-    size_t max_used, max_blocks, max_bytes;                             \
-    size_t prv_used, prv_blocks;                                        \
-    mbedtls_memory_buffer_alloc_cur_get( &prv_used, &prv_blocks );      \
-    mbedtls_memory_buffer_alloc_max_reset( );
-
-#define MEMORY_MEASURE_PRINT( title_len )                               \
-    mbedtls_memory_buffer_alloc_max_get( &max_used, &max_blocks );      \
-    for( ii = 12 - (title_len); ii != 0; ii-- ) mbedtls_printf( " " );  \
-    max_used -= prv_used;                                               \
-    max_blocks -= prv_blocks;                                           \
-    max_bytes = max_used + MEM_BLOCK_OVERHEAD * max_blocks;             \
-    mbedtls_printf( "%6u heap bytes", (unsigned) max_bytes );
-
-#else
-#define MEMORY_MEASURE_INIT
-#define MEMORY_MEASURE_PRINT( title_len )
-#endif
+#define TIME_AND_TSC( TITLE, OP, CTX )                                  \
+do {                                                                    \
+    size_t size_index;                                                  \
+    for( size_index = 0; size_index < opt.size_count; size_index++ )    \
+        TIME_AND_TSC_LEN( TITLE, opt.sizes[size_index], OP, CTX );      \
+} while( 0 )
 
-#define TIME_PUBLIC( TITLE, TYPE, CODE )                                \
+#define TIME_PUBLIC( TITLE, TYPE, OP, CTX )                             \
 do {                                                                    \
     unsigned long ii;                                                   \
+    long heap, stack;                                                   \
     int ret;                                                            \
     MEMORY_MEASURE_INIT;                                                \
                                                                         \
-    mbedtls_printf( HEADER_FORMAT, TITLE );                             \
-    fflush( stdout );                                                   \
+    print_header( TITLE, 0 );                                           \
     mbedtls_set_alarm( 3 );                                             \
                                                                         \
     ret = 0;                                                            \
     for( ii = 1; ! mbedtls_timing_alarmed && ! ret ; ii++ )             \
     {                                                                   \
-        CODE;                                                           \
+        ret = OP( CTX, 0 );                                             \
     }                                                                   \
                                                                         \
-    if( ret != 0 )                                                      \
-    {                                                                   \
-        PRINT_ERROR;                                                    \
-    }                                                                   \
-    else                                                                \
-    {                                                                   \
-        mbedtls_printf( "%6lu " TYPE "/s", ii / 3 );                    \
-        MEMORY_MEASURE_PRINT( sizeof( TYPE ) + 1 );                     \
-        mbedtls_printf( "\n" );                                         \
-    }                                                                   \
+    MEMORY_MEASURE_GET( heap );                                         \
+    STACK_MEASURE( stack, OP, CTX, 0 );                                 \
+                                                                        \
+    print_result( TITLE, 0, TYPE, ii / 3, 0, heap, stack, ret );        \
 } while( 0 )
 
 static int myrand( void *rng_state, unsigned char *output, size_t len )
@@ -245,19 +514,644 @@ void ecp_clear_precomputed( mbedtls_ecp_group *grp )
 #define ecp_clear_precomputed( g )
 #endif
 
-unsigned char buf[BUFSIZE];
+/* Room for an authentication tag after the largest message */
+unsigned char buf[BENCH_MAX_SIZE + 16];
+
+/* Keys, IVs and other outputs of the operations */
+unsigned char tmp[200];
+
+/*
+ * The operations that are measured. Each takes its context, if any, and the
+ * message length, which is 0 for public-key operations, and returns 0 on
+ * success.
+ */
+#if defined(MBEDTLS_MD4_C)
+static int bench_md4( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_md4_ret( buf, len, tmp ) );
+}
+#endif
+
+#if defined(MBEDTLS_MD5_C)
+static int bench_md5( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_md5_ret( buf, len, tmp ) );
+}
+#endif
+
+#if defined(MBEDTLS_RIPEMD160_C)
+static int bench_ripemd160( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_ripemd160_ret( buf, len, tmp ) );
+}
+#endif
+
+#if defined(MBEDTLS_SHA1_C)
+static int bench_sha1( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_sha1_ret( buf, len, tmp ) );
+}
+#endif
+
+#if defined(MBEDTLS_SHA256_C)
+static int bench_sha256( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_sha256_ret( buf, len, tmp, 0 ) );
+}
+#endif
+
+#if defined(MBEDTLS_SHA512_C)
+static int bench_sha512( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_sha512_ret( buf, len, tmp, 0 ) );
+}
+#endif
+
+#if defined(MBEDTLS_MD_C) && defined(MBEDTLS_SHA256_C)
+static int bench_hmac( void *ctx, size_t len )
+{
+    return( mbedtls_md_hmac( ctx, tmp, 32, buf, len, tmp + 32 ) );
+}
+#endif
+
+#if defined(MBEDTLS_ARC4_C)
+static int bench_arc4( void *ctx, size_t len )
+{
+    return( mbedtls_arc4_crypt( ctx, len, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_DES_C) && defined(MBEDTLS_CIPHER_MODE_CBC)
+static int bench_des3( void *ctx, size_t len )
+{
+    return( mbedtls_des3_crypt_cbc( ctx, MBEDTLS_DES_ENCRYPT, len,
+                                    tmp, buf, buf ) );
+}
+
+static int bench_des( void *ctx, size_t len )
+{
+    return( mbedtls_des_crypt_cbc( ctx, MBEDTLS_DES_ENCRYPT, len,
+                                   tmp, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_CMAC_C)
+typedef struct
+{
+    const mbedtls_cipher_info_t *cipher_info;
+    size_t keybits;
+} bench_cmac_ctx;
+
+static int bench_cmac( void *ctx, size_t len )
+{
+    const bench_cmac_ctx *cmac = ctx;
+    unsigned char output[MBEDTLS_CIPHER_BLKSIZE_MAX];
+
+    return( mbedtls_cipher_cmac( cmac->cipher_info, tmp, cmac->keybits,
+                                 buf, len, output ) );
+}
+
+#if defined(MBEDTLS_AES_C)
+static int bench_aes_cmac_prf_128( void *ctx, size_t len )
+{
+    unsigned char output[16];
+
+    (void) ctx;
+    return( mbedtls_aes_cmac_prf_128( tmp, 16, buf, len, output ) );
+}
+#endif
+#endif /* MBEDTLS_CMAC_C */
+
+#if defined(MBEDTLS_AES_C)
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+static int bench_aes_cbc( void *ctx, size_t len )
+{
+    return( mbedtls_aes_crypt_cbc( ctx, MBEDTLS_AES_ENCRYPT, len,
+                                   tmp, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+static int bench_aes_xts( void *ctx, size_t len )
+{
+    return( mbedtls_aes_crypt_xts( ctx, MBEDTLS_AES_ENCRYPT, len,
+                                   tmp, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_GCM_C)
+static int bench_aes_gcm( void *ctx, size_t len )
+{
+    return( mbedtls_gcm_crypt_and_tag( ctx, MBEDTLS_GCM_ENCRYPT, len,
+                                       tmp, 12, NULL, 0, buf, buf,
+                                       16, tmp ) );
+}
+#endif
+
+#if defined(MBEDTLS_CCM_C)
+static int bench_aes_ccm( void *ctx, size_t len )
+{
+    return( mbedtls_ccm_encrypt_and_tag( ctx, len, tmp, 12, NULL, 0,
+                                         buf, buf, tmp, 16 ) );
+}
+#endif
+#endif /* MBEDTLS_AES_C */
+
+#if defined(MBEDTLS_CHACHAPOLY_C)
+static int bench_chachapoly( void *ctx, size_t len )
+{
+    return( mbedtls_chachapoly_encrypt_and_tag( ctx, len, tmp, NULL, 0,
+                                                buf, buf, tmp ) );
+}
+#endif
+
+#if defined(MBEDTLS_ARIA_C) && defined(MBEDTLS_CIPHER_MODE_CBC)
+static int bench_aria( void *ctx, size_t len )
+{
+    return( mbedtls_aria_crypt_cbc( ctx, MBEDTLS_ARIA_ENCRYPT, len,
+                                    tmp, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_CAMELLIA_C) && defined(MBEDTLS_CIPHER_MODE_CBC)
+static int bench_camellia( void *ctx, size_t len )
+{
+    return( mbedtls_camellia_crypt_cbc( ctx, MBEDTLS_CAMELLIA_ENCRYPT, len,
+                                        tmp, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_CHACHA20_C)
+static int bench_chacha20( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_chacha20_crypt( buf, buf, 0U, len, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_POLY1305_C)
+static int bench_poly1305( void *ctx, size_t len )
+{
+    (void) ctx;
+    return( mbedtls_poly1305_mac( buf, buf, len, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_BLOWFISH_C) && defined(MBEDTLS_CIPHER_MODE_CBC)
+static int bench_blowfish( void *ctx, size_t len )
+{
+    return( mbedtls_blowfish_crypt_cbc( ctx, MBEDTLS_BLOWFISH_ENCRYPT, len,
+                                        tmp, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_HAVEGE_C)
+static int bench_havege( void *ctx, size_t len )
+{
+    return( mbedtls_havege_random( ctx, buf, len ) );
+}
+#endif
+
+#if defined(MBEDTLS_CTR_DRBG_C)
+static int bench_ctr_drbg( void *ctx, size_t len )
+{
+    return( mbedtls_ctr_drbg_random( ctx, buf, len ) );
+}
+#endif
+
+#if defined(MBEDTLS_HMAC_DRBG_C)
+static int bench_hmac_drbg( void *ctx, size_t len )
+{
+    return( mbedtls_hmac_drbg_random( ctx, buf, len ) );
+}
+#endif
+
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_GENPRIME)
+static int bench_rsa_public( void *ctx, size_t len )
+{
+    (void) len;
+    buf[0] = 0;
+    return( mbedtls_rsa_public( ctx, buf, buf ) );
+}
+
+static int bench_rsa_private( void *ctx, size_t len )
+{
+    (void) len;
+    buf[0] = 0;
+    return( mbedtls_rsa_private( ctx, myrand, NULL, buf, buf ) );
+}
+#endif
+
+#if defined(MBEDTLS_DHM_C) && defined(MBEDTLS_BIGNUM_C)
+static int bench_dhe( void *ctx, size_t len )
+{
+    mbedtls_dhm_context *dhm = ctx;
+    size_t olen;
+    int ret;
+
+    (void) len;
+    ret = mbedtls_dhm_make_public( dhm, (int) dhm->len, buf, dhm->len,
+                                   myrand, NULL );
+    if( ret == 0 )
+        ret = mbedtls_dhm_calc_secret( dhm, buf, sizeof( buf ), &olen,
+                                       myrand, NULL );
+    return( ret );
+}
+
+static int bench_dh( void *ctx, size_t len )
+{
+    size_t olen;
+
+    (void) len;
+    return( mbedtls_dhm_calc_secret( ctx, buf, sizeof( buf ), &olen,
+                                     myrand, NULL ) );
+}
+#endif
+
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
+typedef struct
+{
+    mbedtls_ecdsa_context ecdsa;
+    size_t hash_len;
+    size_t sig_len;                 /* of the signature in tmp */
+} bench_ecdsa_ctx;
+
+static int bench_ecdsa_sign( void *ctx, size_t len )
+{
+    bench_ecdsa_ctx *ecdsa = ctx;
+
+    (void) len;
+    return( mbedtls_ecdsa_write_signature( &ecdsa->ecdsa, MBEDTLS_MD_SHA256,
+                                           buf, ecdsa->hash_len,
+                                           tmp, &ecdsa->sig_len,
+                                           myrand, NULL ) );
+}
+
+static int bench_ecdsa_verify( void *ctx, size_t len )
+{
+    bench_ecdsa_ctx *ecdsa = ctx;
+
+    (void) len;
+    return( mbedtls_ecdsa_read_signature( &ecdsa->ecdsa, buf, ecdsa->hash_len,
+                                          tmp, ecdsa->sig_len ) );
+}
+#endif
+
+#if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
+typedef struct
+{
+    mbedtls_ecdh_context ecdh;
+    mbedtls_mpi z;                  /* shared secret on Montgomery curves */
+} bench_ecdh_ctx;
+
+static int bench_ecdhe( void *ctx, size_t len )
+{
+    bench_ecdh_ctx *ecdh = ctx;
+    size_t olen;
+    int ret;
+
+    (void) len;
+    ret = mbedtls_ecdh_make_public( &ecdh->ecdh, &olen, buf, sizeof( buf ),
+                                    myrand, NULL );
+    if( ret == 0 )
+        ret = mbedtls_ecdh_calc_secret( &ecdh->ecdh, &olen, buf,
+                                        sizeof( buf ), myrand, NULL );
+    return( ret );
+}
+
+static int bench_ecdh( void *ctx, size_t len )
+{
+    bench_ecdh_ctx *ecdh = ctx;
+    size_t olen;
+
+    (void) len;
+    return( mbedtls_ecdh_calc_secret( &ecdh->ecdh, &olen, buf, sizeof( buf ),
+                                      myrand, NULL ) );
+}
+
+static int bench_ecdhe_montgomery( void *ctx, size_t len )
+{
+    bench_ecdh_ctx *ecdh = ctx;
+    int ret;
+
+    (void) len;
+    ret = mbedtls_ecdh_gen_public( &ecdh->ecdh.grp, &ecdh->ecdh.d,
+                                   &ecdh->ecdh.Q, myrand, NULL );
+    if( ret == 0 )
+        ret = mbedtls_ecdh_compute_shared( &ecdh->ecdh.grp, &ecdh->z,
+                                           &ecdh->ecdh.Qp, &ecdh->ecdh.d,
+                                           myrand, NULL );
+    return( ret );
+}
+
+static int bench_ecdh_montgomery( void *ctx, size_t len )
+{
+    bench_ecdh_ctx *ecdh = ctx;
+
+    (void) len;
+    return( mbedtls_ecdh_compute_shared( &ecdh->ecdh.grp, &ecdh->z,
+                                         &ecdh->ecdh.Qp, &ecdh->ecdh.d,
+                                         myrand, NULL ) );
+}
+#endif
 
 typedef struct {
-    char md4, md5, ripemd160, sha1, sha256, sha512,
+    char md4, md5, ripemd160, sha1, sha256, sha512, hmac,
          arc4, des3, des,
          aes_cbc, aes_gcm, aes_ccm, aes_xts, chachapoly,
          aes_cmac, des3_cmac,
          aria, camellia, blowfish, chacha20,
          poly1305,
          havege, ctr_drbg, hmac_drbg,
-         rsa, dhm, ecdsa, ecdh;
+         rsa, dhm, ecdsa, ecdh,
+         psa_hash, psa_mac, psa_aead, psa_sign, psa_ka, psa_key;
 } todo_list;
 
+#if defined(MBEDTLS_PSA_CRYPTO_STORAGE_C)
+/*
+ * Persistent keys used to time psa_open_key(). The identifiers are chosen
+ * so as not to clash with keys that an application may have stored in the
+ * current directory.
+ */
+#define PSA_KEY_BENCH_ID        ( (psa_key_id_t) 0x62656e00 )
+#define PSA_KEY_BENCH_COUNT     16
+
+static int psa_key_bench_setup( psa_key_type_t type,
+                                const unsigned char *key, size_t key_len )
+{
+    psa_key_handle_t handle;
+    psa_key_policy_t policy = PSA_KEY_POLICY_INIT;
+    psa_status_t status = PSA_SUCCESS;
+    psa_key_id_t i;
+
+    psa_key_policy_set_usage( &policy, PSA_KEY_USAGE_EXPORT, 0 );
+    for( i = 0; i < PSA_KEY_BENCH_COUNT && status == PSA_SUCCESS; i++ )
+    {
+        status = psa_create_key( PSA_KEY_LIFETIME_PERSISTENT,
+                                 PSA_KEY_BENCH_ID + i, &handle );
+        if( status != PSA_SUCCESS )
+            break;
+        status = psa_set_key_policy( handle, &policy );
+        if( status == PSA_SUCCESS )
+            status = psa_import_key( handle, type, key, key_len );
+        if( status == PSA_SUCCESS )
+            status = psa_close_key( handle );
+        else
+            (void) psa_destroy_key( handle );
+    }
+    return( status == PSA_SUCCESS ? 0 : -1 );
+}
+
+static void psa_key_bench_cleanup( void )
+{
+    psa_key_handle_t handle;
+    psa_key_id_t i;
+
+    for( i = 0; i < PSA_KEY_BENCH_COUNT; i++ )
+    {
+        if( psa_open_key( PSA_KEY_LIFETIME_PERSISTENT,
+                          PSA_KEY_BENCH_ID + i, &handle ) == PSA_SUCCESS )
+            (void) psa_destroy_key( handle );
+    }
+}
+
+/*
+ * Open and close the key PSA_KEY_BENCH_ID + *index, then move *index to
+ * the next key if index is not NULL.
+ */
+static int psa_key_bench_open_close( void *index, size_t len )
+{
+    psa_key_id_t *n = index;
+    psa_key_handle_t handle;
+    psa_status_t status;
+
+    (void) len;
+    status = psa_open_key( PSA_KEY_LIFETIME_PERSISTENT,
+                           PSA_KEY_BENCH_ID + ( n != NULL ? *n : 0 ),
+                           &handle );
+    if( status == PSA_SUCCESS )
+        status = psa_close_key( handle );
+    if( n != NULL )
+        *n = ( *n + 1 ) % PSA_KEY_BENCH_COUNT;
+    return( status == PSA_SUCCESS ? 0 : -1 );
+}
+
+/*
+ * Time opening the same key repeatedly, then cycling through more keys than
+ * the persistent key cache holds, so that every open reads from storage.
+ */
+static void psa_key_bench( const char *name, psa_key_type_t type,
+                           const unsigned char *key, size_t key_len )
+{
+    char title[TITLE_LEN];
+    psa_key_id_t index = 0;
+
+    mbedtls_snprintf( title, sizeof( title ), "PSA open %s", name );
+
+    if( psa_key_bench_setup( type, key, key_len ) != 0 )
+    {
+        print_header( title, 0 );
+        print_result( title, 0, "open", 0, 0, -1, -1, -1 );
+        psa_key_bench_cleanup( );
+        return;
+    }
+
+    TIME_PUBLIC( title, "open", psa_key_bench_open_close, NULL );
+
+    mbedtls_snprintf( title, sizeof( title ), "PSA open %s cold", name );
+    TIME_PUBLIC( title, "open", psa_key_bench_open_close, &index );
+
+    psa_key_bench_cleanup( );
+}
+#endif /* MBEDTLS_PSA_CRYPTO_STORAGE_C */
+
+#if defined(MBEDTLS_PSA_CRYPTO_C)
+/*
+ * Allocate a volatile key slot with the given policy, for a key to be
+ * imported or generated.
+ */
+static psa_status_t psa_bench_allocate( psa_key_handle_t *handle,
+                                        psa_key_usage_t usage,
+                                        psa_algorithm_t alg )
+{
+    psa_key_policy_t policy = PSA_KEY_POLICY_INIT;
+    psa_status_t status;
+
+    status = psa_allocate_key( handle );
+    if( status != PSA_SUCCESS )
+        return( status );
+
+    psa_key_policy_set_usage( &policy, usage, alg );
+    status = psa_set_key_policy( *handle, &policy );
+    if( status != PSA_SUCCESS )
+        (void) psa_destroy_key( *handle );
+    return( status );
+}
+
+/*
+ * Context of the PSA operations. They fail with status without doing
+ * anything if the key could not be set up.
+ */
+typedef struct
+{
+    psa_status_t status;
+    psa_key_handle_t handle;
+    psa_algorithm_t alg;
+    const unsigned char *peer_key;
+    size_t peer_key_len;
+} psa_bench_ctx;
+
+static int psa_hash_bench( void *ctx, size_t len )
+{
+    const psa_bench_ctx *bench = ctx;
+    psa_hash_operation_t operation = PSA_HASH_OPERATION_INIT;
+    unsigned char hash[PSA_HASH_MAX_SIZE];
+    size_t hash_len;
+    psa_status_t status;
+
+    status = psa_hash_setup( &operation, bench->alg );
+    if( status == PSA_SUCCESS )
+        status = psa_hash_update( &operation, buf, len );
+    if( status == PSA_SUCCESS )
+        status = psa_hash_finish( &operation, hash, sizeof( hash ),
+                                  &hash_len );
+    (void) psa_hash_abort( &operation );
+    return( (int) status );
+}
+
+static int psa_mac_bench( void *ctx, size_t len )
+{
+    const psa_bench_ctx *bench = ctx;
+    psa_mac_operation_t operation = PSA_MAC_OPERATION_INIT;
+    unsigned char mac[PSA_MAC_MAX_SIZE];
+    size_t mac_len;
+    psa_status_t status;
+
+    if( bench->status != PSA_SUCCESS )
+        return( (int) bench->status );
+
+    status = psa_mac_sign_setup( &operation, bench->handle, bench->alg );
+    if( status == PSA_SUCCESS )
+        status = psa_mac_update( &operation, buf, len );
+    if( status == PSA_SUCCESS )
+        status = psa_mac_sign_finish( &operation, mac, sizeof( mac ),
+                                      &mac_len );
+    (void) psa_mac_abort( &operation );
+    return( (int) status );
+}
+
+static int psa_aead_bench( void *ctx, size_t len )
+{
+    const psa_bench_ctx *bench = ctx;
+    static const unsigned char nonce[12] = { 0 };
+    size_t out_len;
+
+    if( bench->status != PSA_SUCCESS )
+        return( (int) bench->status );
+
+    /* Encrypt in place, buf has room for the tag */
+    return( (int) psa_aead_encrypt( bench->handle, bench->alg,
+                                    nonce, sizeof( nonce ),
+                                    NULL, 0, buf, len,
+                                    buf, len + 16, &out_len ) );
+}
+
+/* Last signature made by psa_sign_bench(), for psa_verify_bench() */
+static unsigned char psa_signature[PSA_ASYMMETRIC_SIGNATURE_MAX_SIZE];
+static size_t psa_signature_len;
+
+/* Sign or verify a 32-byte hash */
+static int psa_sign_bench( void *ctx, size_t len )
+{
+    const psa_bench_ctx *bench = ctx;
+
+    (void) len;
+    if( bench->status != PSA_SUCCESS )
+        return( (int) bench->status );
+
+    return( (int) psa_asymmetric_sign( bench->handle, bench->alg, buf, 32,
+                                       psa_signature,
+                                       sizeof( psa_signature ),
+                                       &psa_signature_len ) );
+}
+
+static int psa_verify_bench( void *ctx, size_t len )
+{
+    const psa_bench_ctx *bench = ctx;
+
+    (void) len;
+    if( bench->status != PSA_SUCCESS )
+        return( (int) bench->status );
+
+    return( (int) psa_asymmetric_verify( bench->handle, bench->alg, buf, 32,
+                                         psa_signature,
+                                         psa_signature_len ) );
+}
+
+static int psa_ka_bench( void *ctx, size_t len )
+{
+    const psa_bench_ctx *bench = ctx;
+    psa_crypto_generator_t generator = PSA_CRYPTO_GENERATOR_INIT;
+    unsigned char secret[32];
+    psa_status_t status;
+
+    (void) len;
+    if( bench->status != PSA_SUCCESS )
+        return( (int) bench->status );
+
+    status = psa_key_agreement( &generator, bench->handle,
+                                bench->peer_key, bench->peer_key_len,
+                                bench->alg );
+    if( status == PSA_SUCCESS )
+        status = psa_generator_read( &generator, secret, sizeof( secret ) );
+    (void) psa_generator_abort( &generator );
+    return( (int) status );
+}
+#endif /* MBEDTLS_PSA_CRYPTO_C */
+
+/*
+ * Parse the value of the sizes= option
+ */
+static int parse_sizes( const char *arg )
+{
+    unsigned long size;
+    char *end;
+    size_t i;
+
+    if( strcmp( arg, "all" ) == 0 )
+    {
+        for( i = 0; i < sizeof( all_sizes ) / sizeof( all_sizes[0] ) &&
+                    all_sizes[i] <= BENCH_MAX_SIZE; i++ )
+        {
+            opt.sizes[i] = all_sizes[i];
+        }
+        opt.size_count = i;
+        return( 0 );
+    }
+
+    opt.size_count = 0;
+    while( *arg != '\0' )
+    {
+        size = strtoul( arg, &end, 10 );
+        if( end == arg || ( *end != ',' && *end != '\0' ) ||
+            size == 0 || size % 16 != 0 || size > BENCH_MAX_SIZE ||
+            opt.size_count == BENCH_MAX_SIZES )
+        {
+            return( -1 );
+        }
+        opt.sizes[opt.size_count++] = size;
+        arg = ( *end == ',' ) ? end + 1 : end;
+    }
+
+    return( opt.size_count == 0 ? -1 : 0 );
+}
+
 #if defined(MBEDTLS_CHECK_PARAMS)
 #include "mbedtls/platform_util.h"
 void mbedtls_param_failed( const char *failure_condition,
@@ -273,88 +1167,138 @@ void mbedtls_param_failed( const char *failure_condition,
 int main( int argc, char *argv[] )
 {
     int i;
-    unsigned char tmp[200];
+    int selected = 0;
     char title[TITLE_LEN];
     todo_list todo;
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     unsigned char alloc_buf[HEAP_SIZE] = { 0 };
 #endif
 
-    if( argc <= 1 )
-    {
-        memset( &todo, 1, sizeof( todo ) );
-    }
-    else
-    {
-        memset( &todo, 0, sizeof( todo ) );
+    opt.format = FORMAT_TEXT;
+    opt.sizes[0] = BUFSIZE;
+    opt.size_count = 1;
+
+    memset( &todo, 0, sizeof( todo ) );
 
-        for( i = 1; i < argc; i++ )
+    for( i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "format=text" ) == 0 )
         {
-            if( strcmp( argv[i], "md4" ) == 0 )
-                todo.md4 = 1;
-            else if( strcmp( argv[i], "md5" ) == 0 )
-                todo.md5 = 1;
-            else if( strcmp( argv[i], "ripemd160" ) == 0 )
-                todo.ripemd160 = 1;
-            else if( strcmp( argv[i], "sha1" ) == 0 )
-                todo.sha1 = 1;
-            else if( strcmp( argv[i], "sha256" ) == 0 )
-                todo.sha256 = 1;
-            else if( strcmp( argv[i], "sha512" ) == 0 )
-                todo.sha512 = 1;
-            else if( strcmp( argv[i], "arc4" ) == 0 )
-                todo.arc4 = 1;
-            else if( strcmp( argv[i], "des3" ) == 0 )
-                todo.des3 = 1;
-            else if( strcmp( argv[i], "des" ) == 0 )
-                todo.des = 1;
-            else if( strcmp( argv[i], "aes_cbc" ) == 0 )
-                todo.aes_cbc = 1;
-            else if( strcmp( argv[i], "aes_xts" ) == 0 )
-                todo.aes_xts = 1;
-            else if( strcmp( argv[i], "aes_gcm" ) == 0 )
-                todo.aes_gcm = 1;
-            else if( strcmp( argv[i], "aes_ccm" ) == 0 )
-                todo.aes_ccm = 1;
-            else if( strcmp( argv[i], "chachapoly" ) == 0 )
-                todo.chachapoly = 1;
-            else if( strcmp( argv[i], "aes_cmac" ) == 0 )
-                todo.aes_cmac = 1;
-            else if( strcmp( argv[i], "des3_cmac" ) == 0 )
-                todo.des3_cmac = 1;
-            else if( strcmp( argv[i], "aria" ) == 0 )
-                todo.aria = 1;
-            else if( strcmp( argv[i], "camellia" ) == 0 )
-                todo.camellia = 1;
-            else if( strcmp( argv[i], "blowfish" ) == 0 )
-                todo.blowfish = 1;
-            else if( strcmp( argv[i], "chacha20" ) == 0 )
-                todo.chacha20 = 1;
-            else if( strcmp( argv[i], "poly1305" ) == 0 )
-                todo.poly1305 = 1;
-            else if( strcmp( argv[i], "havege" ) == 0 )
-                todo.havege = 1;
-            else if( strcmp( argv[i], "ctr_drbg" ) == 0 )
-                todo.ctr_drbg = 1;
-            else if( strcmp( argv[i], "hmac_drbg" ) == 0 )
-                todo.hmac_drbg = 1;
-            else if( strcmp( argv[i], "rsa" ) == 0 )
-                todo.rsa = 1;
-            else if( strcmp( argv[i], "dhm" ) == 0 )
-                todo.dhm = 1;
-            else if( strcmp( argv[i], "ecdsa" ) == 0 )
-                todo.ecdsa = 1;
-            else if( strcmp( argv[i], "ecdh" ) == 0 )
-                todo.ecdh = 1;
-            else
+            opt.format = FORMAT_TEXT;
+            continue;
+        }
+        else if( strcmp( argv[i], "format=csv" ) == 0 )
+        {
+            opt.format = FORMAT_CSV;
+            continue;
+        }
+        else if( strcmp( argv[i], "format=json" ) == 0 )
+        {
+            opt.format = FORMAT_JSON;
+            continue;
+        }
+        else if( strncmp( argv[i], "sizes=", 6 ) == 0 )
+        {
+            if( parse_sizes( argv[i] + 6 ) != 0 )
             {
-                mbedtls_printf( "Unrecognized option: %s\n", argv[i] );
-                mbedtls_printf( "Available options: " OPTIONS );
+                mbedtls_printf( "Invalid sizes: %s\n", argv[i] + 6 );
+                mbedtls_printf( "Available options: " OPTIONS,
+                                (unsigned) BENCH_MAX_SIZE );
+                mbedtls_exit( MBEDTLS_EXIT_FAILURE );
             }
+            opt.sizes_given = 1;
+            continue;
+        }
+
+        selected = 1;
+        if( strcmp( argv[i], "md4" ) == 0 )
+            todo.md4 = 1;
+        else if( strcmp( argv[i], "md5" ) == 0 )
+            todo.md5 = 1;
+        else if( strcmp( argv[i], "ripemd160" ) == 0 )
+            todo.ripemd160 = 1;
+        else if( strcmp( argv[i], "sha1" ) == 0 )
+            todo.sha1 = 1;
+        else if( strcmp( argv[i], "sha256" ) == 0 )
+            todo.sha256 = 1;
+        else if( strcmp( argv[i], "sha512" ) == 0 )
+            todo.sha512 = 1;
+        else if( strcmp( argv[i], "arc4" ) == 0 )
+            todo.arc4 = 1;
+        else if( strcmp( argv[i], "des3" ) == 0 )
+            todo.des3 = 1;
+        else if( strcmp( argv[i], "des" ) == 0 )
+            todo.des = 1;
+        else if( strcmp( argv[i], "aes_cbc" ) == 0 )
+            todo.aes_cbc = 1;
+        else if( strcmp( argv[i], "aes_xts" ) == 0 )
+            todo.aes_xts = 1;
+        else if( strcmp( argv[i], "aes_gcm" ) == 0 )
+            todo.aes_gcm = 1;
+        else if( strcmp( argv[i], "aes_ccm" ) == 0 )
+            todo.aes_ccm = 1;
+        else if( strcmp( argv[i], "chachapoly" ) == 0 )
+            todo.chachapoly = 1;
+        else if( strcmp( argv[i], "aes_cmac" ) == 0 )
+            todo.aes_cmac = 1;
+        else if( strcmp( argv[i], "des3_cmac" ) == 0 )
+            todo.des3_cmac = 1;
+        else if( strcmp( argv[i], "aria" ) == 0 )
+            todo.aria = 1;
+        else if( strcmp( argv[i], "camellia" ) == 0 )
+            todo.camellia = 1;
+        else if( strcmp( argv[i], "blowfish" ) == 0 )
+            todo.blowfish = 1;
+        else if( strcmp( argv[i], "chacha20" ) == 0 )
+            todo.chacha20 = 1;
+        else if( strcmp( argv[i], "poly1305" ) == 0 )
+            todo.poly1305 = 1;
+        else if( strcmp( argv[i], "havege" ) == 0 )
+            todo.havege = 1;
+        else if( strcmp( argv[i], "ctr_drbg" ) == 0 )
+            todo.ctr_drbg = 1;
+        else if( strcmp( argv[i], "hmac_drbg" ) == 0 )
+            todo.hmac_drbg = 1;
+        else if( strcmp( argv[i], "rsa" ) == 0 )
+            todo.rsa = 1;
+        else if( strcmp( argv[i], "dhm" ) == 0 )
+            todo.dhm = 1;
+        else if( strcmp( argv[i], "ecdsa" ) == 0 )
+            todo.ecdsa = 1;
+        else if( strcmp( argv[i], "ecdh" ) == 0 )
+            todo.ecdh = 1;
+        else if( strcmp( argv[i], "hmac" ) == 0 )
+            todo.hmac = 1;
+        else if( strcmp( argv[i], "psa_hash" ) == 0 )
+            todo.psa_hash = 1;
+        else if( strcmp( argv[i], "psa_mac" ) == 0 )
+            todo.psa_mac = 1;
+        else if( strcmp( argv[i], "psa_aead" ) == 0 )
+            todo.psa_aead = 1;
+        else if( strcmp( argv[i], "psa_sign" ) == 0 )
+            todo.psa_sign = 1;
+        else if( strcmp( argv[i], "psa_ka" ) == 0 )
+            todo.psa_ka = 1;
+        else if( strcmp( argv[i], "psa_key" ) == 0 )
+            todo.psa_key = 1;
+        else
+        {
+            mbedtls_printf( "Unrecognized option: %s\n", argv[i] );
+            mbedtls_printf( "Available options: " OPTIONS,
+                            (unsigned) BENCH_MAX_SIZE );
         }
     }
 
-    mbedtls_printf( "\n" );
+    if( ! selected )
+        memset( &todo, 1, sizeof( todo ) );
+
+    if( opt.format == FORMAT_CSV )
+        mbedtls_printf( "name,size,unit,rate,cycles_per_byte,heap_bytes,"
+                        "stack_bytes,status\n" );
+    else if( opt.format == FORMAT_JSON )
+        mbedtls_printf( "[\n" );
+    else
+        mbedtls_printf( "\n" );
 
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     mbedtls_memory_buffer_alloc_init( alloc_buf, sizeof( alloc_buf ) );
@@ -364,32 +1308,41 @@ int main( int argc, char *argv[] )
 
 #if defined(MBEDTLS_MD4_C)
     if( todo.md4 )
-        TIME_AND_TSC( "MD4", mbedtls_md4_ret( buf, BUFSIZE, tmp ) );
+        TIME_AND_TSC( "MD4", bench_md4, NULL );
 #endif
 
 #if defined(MBEDTLS_MD5_C)
     if( todo.md5 )
-        TIME_AND_TSC( "MD5", mbedtls_md5_ret( buf, BUFSIZE, tmp ) );
+        TIME_AND_TSC( "MD5", bench_md5, NULL );
 #endif
 
 #if defined(MBEDTLS_RIPEMD160_C)
     if( todo.ripemd160 )
-        TIME_AND_TSC( "RIPEMD160", mbedtls_ripemd160_ret( buf, BUFSIZE, tmp ) );
+        TIME_AND_TSC( "RIPEMD160", bench_ripemd160, NULL );
 #endif
 
 #if defined(MBEDTLS_SHA1_C)
     if( todo.sha1 )
-        TIME_AND_TSC( "SHA-1", mbedtls_sha1_ret( buf, BUFSIZE, tmp ) );
+        TIME_AND_TSC( "SHA-1", bench_sha1, NULL );
 #endif
 
 #if defined(MBEDTLS_SHA256_C)
     if( todo.sha256 )
-        TIME_AND_TSC( "SHA-256", mbedtls_sha256_ret( buf, BUFSIZE, tmp, 0 ) );
+        TIME_AND_TSC( "SHA-256", bench_sha256, NULL );
 #endif
 
 #if defined(MBEDTLS_SHA512_C)
     if( todo.sha512 )
-        TIME_AND_TSC( "SHA-512", mbedtls_sha512_ret( buf, BUFSIZE, tmp, 0 ) );
+        TIME_AND_TSC( "SHA-512", bench_sha512, NULL );
+#endif
+
+#if defined(MBEDTLS_MD_C) && defined(MBEDTLS_SHA256_C)
+    if( todo.hmac )
+    {
+        const mbedtls_md_info_t *md_info =
+            mbedtls_md_info_from_type( MBEDTLS_MD_SHA256 );
+        TIME_AND_TSC( "HMAC-SHA-256", bench_hmac, (void *) md_info );
+    }
 #endif
 
 #if defined(MBEDTLS_ARC4_C)
@@ -398,7 +1351,7 @@ int main( int argc, char *argv[] )
         mbedtls_arc4_context arc4;
         mbedtls_arc4_init( &arc4 );
         mbedtls_arc4_setup( &arc4, tmp, 32 );
-        TIME_AND_TSC( "ARC4", mbedtls_arc4_crypt( &arc4, BUFSIZE, buf, buf ) );
+        TIME_AND_TSC( "ARC4", bench_arc4, &arc4 );
         mbedtls_arc4_free( &arc4 );
     }
 #endif
@@ -410,8 +1363,7 @@ int main( int argc, char *argv[] )
         mbedtls_des3_context des3;
         mbedtls_des3_init( &des3 );
         mbedtls_des3_set3key_enc( &des3, tmp );
-        TIME_AND_TSC( "3DES",
-                mbedtls_des3_crypt_cbc( &des3, MBEDTLS_DES_ENCRYPT, BUFSIZE, tmp, buf, buf ) );
+        TIME_AND_TSC( "3DES", bench_des3, &des3 );
         mbedtls_des3_free( &des3 );
     }
 
@@ -420,8 +1372,7 @@ int main( int argc, char *argv[] )
         mbedtls_des_context des;
         mbedtls_des_init( &des );
         mbedtls_des_setkey_enc( &des, tmp );
-        TIME_AND_TSC( "DES",
-                mbedtls_des_crypt_cbc( &des, MBEDTLS_DES_ENCRYPT, BUFSIZE, tmp, buf, buf ) );
+        TIME_AND_TSC( "DES", bench_des, &des );
         mbedtls_des_free( &des );
     }
 
@@ -429,17 +1380,15 @@ int main( int argc, char *argv[] )
 #if defined(MBEDTLS_CMAC_C)
     if( todo.des3_cmac )
     {
-        unsigned char output[8];
-        const mbedtls_cipher_info_t *cipher_info;
+        bench_cmac_ctx cmac;
 
         memset( buf, 0, sizeof( buf ) );
         memset( tmp, 0, sizeof( tmp ) );
 
-        cipher_info = mbedtls_cipher_info_from_type( MBEDTLS_CIPHER_DES_EDE3_ECB );
+        cmac.cipher_info = mbedtls_cipher_info_from_type( MBEDTLS_CIPHER_DES_EDE3_ECB );
+        cmac.keybits = 192;
 
-        TIME_AND_TSC( "3DES-CMAC",
-                      mbedtls_cipher_cmac( cipher_info, tmp, 192, buf,
-                      BUFSIZE, output ) );
+        TIME_AND_TSC( "3DES-CMAC", bench_cmac, &cmac );
     }
 #endif /* MBEDTLS_CMAC_C */
 #endif /* MBEDTLS_DES_C */
@@ -459,8 +1408,7 @@ int main( int argc, char *argv[] )
             memset( tmp, 0, sizeof( tmp ) );
             mbedtls_aes_setkey_enc( &aes, tmp, keysize );
 
-            TIME_AND_TSC( title,
-                mbedtls_aes_crypt_cbc( &aes, MBEDTLS_AES_ENCRYPT, BUFSIZE, tmp, buf, buf ) );
+            TIME_AND_TSC( title, bench_aes_cbc, &aes );
         }
         mbedtls_aes_free( &aes );
     }
@@ -480,9 +1428,7 @@ int main( int argc, char *argv[] )
             memset( tmp, 0, sizeof( tmp ) );
             mbedtls_aes_xts_setkey_enc( &ctx, tmp, keysize * 2 );
 
-            TIME_AND_TSC( title,
-                    mbedtls_aes_crypt_xts( &ctx, MBEDTLS_AES_ENCRYPT, BUFSIZE,
-                                           tmp, buf, buf ) );
+            TIME_AND_TSC( title, bench_aes_xts, &ctx );
 
             mbedtls_aes_xts_free( &ctx );
         }
@@ -503,9 +1449,7 @@ int main( int argc, char *argv[] )
             memset( tmp, 0, sizeof( tmp ) );
             mbedtls_gcm_setkey( &gcm, MBEDTLS_CIPHER_ID_AES, tmp, keysize );
 
-            TIME_AND_TSC( title,
-                    mbedtls_gcm_crypt_and_tag( &gcm, MBEDTLS_GCM_ENCRYPT, BUFSIZE, tmp,
-                        12, NULL, 0, buf, buf, 16, tmp ) );
+            TIME_AND_TSC( title, bench_aes_gcm, &gcm );
 
             mbedtls_gcm_free( &gcm );
         }
@@ -526,9 +1470,7 @@ int main( int argc, char *argv[] )
             memset( tmp, 0, sizeof( tmp ) );
             mbedtls_ccm_setkey( &ccm, MBEDTLS_CIPHER_ID_AES, tmp, keysize );
 
-            TIME_AND_TSC( title,
-                    mbedtls_ccm_encrypt_and_tag( &ccm, BUFSIZE, tmp,
-                        12, NULL, 0, buf, buf, tmp, 16 ) );
+            TIME_AND_TSC( title, bench_aes_ccm, &ccm );
 
             mbedtls_ccm_free( &ccm );
         }
@@ -547,9 +1489,7 @@ int main( int argc, char *argv[] )
 
         mbedtls_chachapoly_setkey( &chachapoly, tmp );
 
-        TIME_AND_TSC( title,
-                mbedtls_chachapoly_encrypt_and_tag( &chachapoly,
-                    BUFSIZE, tmp, NULL, 0, buf, buf, tmp ) );
+        TIME_AND_TSC( title, bench_chachapoly, &chachapoly );
 
         mbedtls_chachapoly_free( &chachapoly );
     }
@@ -557,8 +1497,7 @@ int main( int argc, char *argv[] )
 #if defined(MBEDTLS_CMAC_C)
     if( todo.aes_cmac )
     {
-        unsigned char output[16];
-        const mbedtls_cipher_info_t *cipher_info;
+        bench_cmac_ctx cmac;
         mbedtls_cipher_type_t cipher_type;
         int keysize;
 
@@ -571,18 +1510,15 @@ int main( int argc, char *argv[] )
             memset( buf, 0, sizeof( buf ) );
             memset( tmp, 0, sizeof( tmp ) );
 
-            cipher_info = mbedtls_cipher_info_from_type( cipher_type );
+            cmac.cipher_info = mbedtls_cipher_info_from_type( cipher_type );
+            cmac.keybits = keysize;
 
-            TIME_AND_TSC( title,
-                          mbedtls_cipher_cmac( cipher_info, tmp, keysize,
-                                               buf, BUFSIZE, output ) );
+            TIME_AND_TSC( title, bench_cmac, &cmac );
         }
 
         memset( buf, 0, sizeof( buf ) );
         memset( tmp, 0, sizeof( tmp ) );
-        TIME_AND_TSC( "AES-CMAC-PRF-128",
-                      mbedtls_aes_cmac_prf_128( tmp, 16, buf, BUFSIZE,
-                                                output ) );
+        TIME_AND_TSC( "AES-CMAC-PRF-128", bench_aes_cmac_prf_128, NULL );
     }
 #endif /* MBEDTLS_CMAC_C */
 #endif /* MBEDTLS_AES_C */
@@ -601,9 +1537,7 @@ int main( int argc, char *argv[] )
             memset( tmp, 0, sizeof( tmp ) );
             mbedtls_aria_setkey_enc( &aria, tmp, keysize );
 
-            TIME_AND_TSC( title,
-                    mbedtls_aria_crypt_cbc( &aria, MBEDTLS_ARIA_ENCRYPT,
-                        BUFSIZE, tmp, buf, buf ) );
+            TIME_AND_TSC( title, bench_aria, &aria );
         }
         mbedtls_aria_free( &aria );
     }
@@ -623,9 +1557,7 @@ int main( int argc, char *argv[] )
             memset( tmp, 0, sizeof( tmp ) );
             mbedtls_camellia_setkey_enc( &camellia, tmp, keysize );
 
-            TIME_AND_TSC( title,
-                    mbedtls_camellia_crypt_cbc( &camellia, MBEDTLS_CAMELLIA_ENCRYPT,
-                        BUFSIZE, tmp, buf, buf ) );
+            TIME_AND_TSC( title, bench_camellia, &camellia );
         }
         mbedtls_camellia_free( &camellia );
     }
@@ -634,14 +1566,14 @@ int main( int argc, char *argv[] )
 #if defined(MBEDTLS_CHACHA20_C)
     if ( todo.chacha20 )
     {
-        TIME_AND_TSC( "ChaCha20", mbedtls_chacha20_crypt( buf, buf, 0U, BUFSIZE, buf, buf ) );
+        TIME_AND_TSC( "ChaCha20", bench_chacha20, NULL );
     }
 #endif
 
 #if defined(MBEDTLS_POLY1305_C)
     if ( todo.poly1305 )
     {
-        TIME_AND_TSC( "Poly1305", mbedtls_poly1305_mac( buf, buf, BUFSIZE, buf ) );
+        TIME_AND_TSC( "Poly1305", bench_poly1305, NULL );
     }
 #endif
 
@@ -660,9 +1592,7 @@ int main( int argc, char *argv[] )
             memset( tmp, 0, sizeof( tmp ) );
             mbedtls_blowfish_setkey( &blowfish, tmp, keysize );
 
-            TIME_AND_TSC( title,
-                    mbedtls_blowfish_crypt_cbc( &blowfish, MBEDTLS_BLOWFISH_ENCRYPT, BUFSIZE,
-                        tmp, buf, buf ) );
+            TIME_AND_TSC( title, bench_blowfish, &blowfish );
         }
 
         mbedtls_blowfish_free( &blowfish );
@@ -674,7 +1604,7 @@ int main( int argc, char *argv[] )
     {
         mbedtls_havege_state hs;
         mbedtls_havege_init( &hs );
-        TIME_AND_TSC( "HAVEGE", mbedtls_havege_random( &hs, buf, BUFSIZE ) );
+        TIME_AND_TSC_LEN( "HAVEGE", BUFSIZE, bench_havege, &hs );
         mbedtls_havege_free( &hs );
     }
 #endif
@@ -688,14 +1618,14 @@ int main( int argc, char *argv[] )
 
         if( mbedtls_ctr_drbg_seed( &ctr_drbg, myrand, NULL, NULL, 0 ) != 0 )
             mbedtls_exit(1);
-        TIME_AND_TSC( "CTR_DRBG (NOPR)",
-                mbedtls_ctr_drbg_random( &ctr_drbg, buf, BUFSIZE ) );
+        TIME_AND_TSC_LEN( "CTR_DRBG (NOPR)", BUFSIZE,
+                          bench_ctr_drbg, &ctr_drbg );
 
         if( mbedtls_ctr_drbg_seed( &ctr_drbg, myrand, NULL, NULL, 0 ) != 0 )
             mbedtls_exit(1);
         mbedtls_ctr_drbg_set_prediction_resistance( &ctr_drbg, MBEDTLS_CTR_DRBG_PR_ON );
-        TIME_AND_TSC( "CTR_DRBG (PR)",
-                mbedtls_ctr_drbg_random( &ctr_drbg, buf, BUFSIZE ) );
+        TIME_AND_TSC_LEN( "CTR_DRBG (PR)", BUFSIZE,
+                          bench_ctr_drbg, &ctr_drbg );
         mbedtls_ctr_drbg_free( &ctr_drbg );
     }
 #endif
@@ -714,15 +1644,15 @@ int main( int argc, char *argv[] )
 
         if( mbedtls_hmac_drbg_seed( &hmac_drbg, md_info, myrand, NULL, NULL, 0 ) != 0 )
             mbedtls_exit(1);
-        TIME_AND_TSC( "HMAC_DRBG SHA-1 (NOPR)",
-                mbedtls_hmac_drbg_random( &hmac_drbg, buf, BUFSIZE ) );
+        TIME_AND_TSC_LEN( "HMAC_DRBG SHA-1 (NOPR)", BUFSIZE,
+                          bench_hmac_drbg, &hmac_drbg );
 
         if( mbedtls_hmac_drbg_seed( &hmac_drbg, md_info, myrand, NULL, NULL, 0 ) != 0 )
             mbedtls_exit(1);
         mbedtls_hmac_drbg_set_prediction_resistance( &hmac_drbg,
                                              MBEDTLS_HMAC_DRBG_PR_ON );
-        TIME_AND_TSC( "HMAC_DRBG SHA-1 (PR)",
-                mbedtls_hmac_drbg_random( &hmac_drbg, buf, BUFSIZE ) );
+        TIME_AND_TSC_LEN( "HMAC_DRBG SHA-1 (PR)", BUFSIZE,
+                          bench_hmac_drbg, &hmac_drbg );
 #endif
 
 #if defined(MBEDTLS_SHA256_C)
@@ -731,15 +1661,15 @@ int main( int argc, char *argv[] )
 
         if( mbedtls_hmac_drbg_seed( &hmac_drbg, md_info, myrand, NULL, NULL, 0 ) != 0 )
             mbedtls_exit(1);
-        TIME_AND_TSC( "HMAC_DRBG SHA-256 (NOPR)",
-                mbedtls_hmac_drbg_random( &hmac_drbg, buf, BUFSIZE ) );
+        TIME_AND_TSC_LEN( "HMAC_DRBG SHA-256 (NOPR)", BUFSIZE,
+                          bench_hmac_drbg, &hmac_drbg );
 
         if( mbedtls_hmac_drbg_seed( &hmac_drbg, md_info, myrand, NULL, NULL, 0 ) != 0 )
             mbedtls_exit(1);
         mbedtls_hmac_drbg_set_prediction_resistance( &hmac_drbg,
                                              MBEDTLS_HMAC_DRBG_PR_ON );
-        TIME_AND_TSC( "HMAC_DRBG SHA-256 (PR)",
-                mbedtls_hmac_drbg_random( &hmac_drbg, buf, BUFSIZE ) );
+        TIME_AND_TSC_LEN( "HMAC_DRBG SHA-256 (PR)", BUFSIZE,
+                          bench_hmac_drbg, &hmac_drbg );
 #endif
         mbedtls_hmac_drbg_free( &hmac_drbg );
     }
@@ -757,13 +1687,9 @@ int main( int argc, char *argv[] )
             mbedtls_rsa_init( &rsa, MBEDTLS_RSA_PKCS_V15, 0 );
             mbedtls_rsa_gen_key( &rsa, myrand, NULL, keysize, 65537 );
 
-            TIME_PUBLIC( title, " public",
-                    buf[0] = 0;
-                    ret = mbedtls_rsa_public( &rsa, buf, buf ) );
+            TIME_PUBLIC( title, " public", bench_rsa_public, &rsa );
 
-            TIME_PUBLIC( title, "private",
-                    buf[0] = 0;
-                    ret = mbedtls_rsa_private( &rsa, myrand, NULL, buf, buf ) );
+            TIME_PUBLIC( title, "private", bench_rsa_private, &rsa );
 
             mbedtls_rsa_free( &rsa );
         }
@@ -792,7 +1718,6 @@ int main( int argc, char *argv[] )
                                       sizeof( dhm_G_3072 ) };
 
         mbedtls_dhm_context dhm;
-        size_t olen;
         for( i = 0; (size_t) i < sizeof( dhm_sizes ) / sizeof( dhm_sizes[0] ); i++ )
         {
             mbedtls_dhm_init( &dhm );
@@ -811,14 +1736,10 @@ int main( int argc, char *argv[] )
                 mbedtls_exit( 1 );
 
             mbedtls_snprintf( title, sizeof( title ), "DHE-%d", dhm_sizes[i] );
-            TIME_PUBLIC( title, "handshake",
-                    ret |= mbedtls_dhm_make_public( &dhm, (int) dhm.len, buf, dhm.len,
-                                            myrand, NULL );
-                    ret |= mbedtls_dhm_calc_secret( &dhm, buf, sizeof( buf ), &olen, myrand, NULL ) );
+            TIME_PUBLIC( title, "handshake", bench_dhe, &dhm );
 
             mbedtls_snprintf( title, sizeof( title ), "DH-%d", dhm_sizes[i] );
-            TIME_PUBLIC( title, "handshake",
-                    ret |= mbedtls_dhm_calc_secret( &dhm, buf, sizeof( buf ), &olen, myrand, NULL ) );
+            TIME_PUBLIC( title, "handshake", bench_dh, &dhm );
 
             mbedtls_dhm_free( &dhm );
         }
@@ -828,9 +1749,8 @@ int main( int argc, char *argv[] )
 #if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_SHA256_C)
     if( todo.ecdsa )
     {
-        mbedtls_ecdsa_context ecdsa;
+        bench_ecdsa_ctx ecdsa;
         const mbedtls_ecp_curve_info *curve_info;
-        size_t sig_len;
 
         memset( buf, 0x2A, sizeof( buf ) );
 
@@ -838,42 +1758,39 @@ int main( int argc, char *argv[] )
              curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
              curve_info++ )
         {
-            mbedtls_ecdsa_init( &ecdsa );
+            mbedtls_ecdsa_init( &ecdsa.ecdsa );
+            ecdsa.hash_len = curve_info->bit_size;
 
-            if( mbedtls_ecdsa_genkey( &ecdsa, curve_info->grp_id, myrand, NULL ) != 0 )
+            if( mbedtls_ecdsa_genkey( &ecdsa.ecdsa, curve_info->grp_id, myrand, NULL ) != 0 )
                 mbedtls_exit( 1 );
-            ecp_clear_precomputed( &ecdsa.grp );
+            ecp_clear_precomputed( &ecdsa.ecdsa.grp );
 
             mbedtls_snprintf( title, sizeof( title ), "ECDSA-%s",
                                               curve_info->name );
-            TIME_PUBLIC( title, "sign",
-                    ret = mbedtls_ecdsa_write_signature( &ecdsa, MBEDTLS_MD_SHA256, buf, curve_info->bit_size,
-                                                tmp, &sig_len, myrand, NULL ) );
+            TIME_PUBLIC( title, "sign", bench_ecdsa_sign, &ecdsa );
 
-            mbedtls_ecdsa_free( &ecdsa );
+            mbedtls_ecdsa_free( &ecdsa.ecdsa );
         }
 
         for( curve_info = mbedtls_ecp_curve_list();
              curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
              curve_info++ )
         {
-            mbedtls_ecdsa_init( &ecdsa );
+            mbedtls_ecdsa_init( &ecdsa.ecdsa );
+            ecdsa.hash_len = curve_info->bit_size;
 
-            if( mbedtls_ecdsa_genkey( &ecdsa, curve_info->grp_id, myrand, NULL ) != 0 ||
-                mbedtls_ecdsa_write_signature( &ecdsa, MBEDTLS_MD_SHA256, buf, curve_info->bit_size,
-                                               tmp, &sig_len, myrand, NULL ) != 0 )
+            if( mbedtls_ecdsa_genkey( &ecdsa.ecdsa, curve_info->grp_id, myrand, NULL ) != 0 ||
+                bench_ecdsa_sign( &ecdsa, 0 ) != 0 )
             {
                 mbedtls_exit( 1 );
             }
-            ecp_clear_precomputed( &ecdsa.grp );
+            ecp_clear_precomputed( &ecdsa.ecdsa.grp );
 
             mbedtls_snprintf( title, sizeof( title ), "ECDSA-%s",
                                               curve_info->name );
-            TIME_PUBLIC( title, "verify",
-                    ret = mbedtls_ecdsa_read_signature( &ecdsa, buf, curve_info->bit_size,
-                                                tmp, sig_len ) );
+            TIME_PUBLIC( title, "verify", bench_ecdsa_verify, &ecdsa );
 
-            mbedtls_ecdsa_free( &ecdsa );
+            mbedtls_ecdsa_free( &ecdsa.ecdsa );
         }
     }
 #endif
@@ -881,8 +1798,7 @@ int main( int argc, char *argv[] )
 #if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECDH_LEGACY_CONTEXT)
     if( todo.ecdh )
     {
-        mbedtls_ecdh_context ecdh;
-        mbedtls_mpi z;
+        bench_ecdh_ctx ecdh;
         const mbedtls_ecp_curve_info montgomery_curve_list[] = {
 #if defined(MBEDTLS_ECP_DP_CURVE25519_ENABLED)
             { MBEDTLS_ECP_DP_CURVE25519, 0, 0, "Curve25519" },
@@ -899,25 +1815,21 @@ int main( int argc, char *argv[] )
              curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
              curve_info++ )
         {
-            mbedtls_ecdh_init( &ecdh );
+            mbedtls_ecdh_init( &ecdh.ecdh );
 
-            if( mbedtls_ecp_group_load( &ecdh.grp, curve_info->grp_id ) != 0 ||
-                mbedtls_ecdh_make_public( &ecdh, &olen, buf, sizeof( buf),
+            if( mbedtls_ecp_group_load( &ecdh.ecdh.grp, curve_info->grp_id ) != 0 ||
+                mbedtls_ecdh_make_public( &ecdh.ecdh, &olen, buf, sizeof( buf),
                                   myrand, NULL ) != 0 ||
-                mbedtls_ecp_copy( &ecdh.Qp, &ecdh.Q ) != 0 )
+                mbedtls_ecp_copy( &ecdh.ecdh.Qp, &ecdh.ecdh.Q ) != 0 )
             {
                 mbedtls_exit( 1 );
             }
-            ecp_clear_precomputed( &ecdh.grp );
+            ecp_clear_precomputed( &ecdh.ecdh.grp );
 
             mbedtls_snprintf( title, sizeof( title ), "ECDHE-%s",
                                               curve_info->name );
-            TIME_PUBLIC( title, "handshake",
-                    ret |= mbedtls_ecdh_make_public( &ecdh, &olen, buf, sizeof( buf),
-                                             myrand, NULL );
-                    ret |= mbedtls_ecdh_calc_secret( &ecdh, &olen, buf, sizeof( buf ),
-                                             myrand, NULL ) );
-            mbedtls_ecdh_free( &ecdh );
+            TIME_PUBLIC( title, "handshake", bench_ecdhe, &ecdh );
+            mbedtls_ecdh_free( &ecdh.ecdh );
         }
 
         /* Montgomery curves need to be handled separately */
@@ -925,50 +1837,44 @@ int main( int argc, char *argv[] )
               curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
               curve_info++ )
         {
-            mbedtls_ecdh_init( &ecdh );
-            mbedtls_mpi_init( &z );
+            mbedtls_ecdh_init( &ecdh.ecdh );
+            mbedtls_mpi_init( &ecdh.z );
 
-            if( mbedtls_ecp_group_load( &ecdh.grp, curve_info->grp_id ) != 0 ||
-                mbedtls_ecdh_gen_public( &ecdh.grp, &ecdh.d, &ecdh.Qp, myrand, NULL ) != 0 )
+            if( mbedtls_ecp_group_load( &ecdh.ecdh.grp, curve_info->grp_id ) != 0 ||
+                mbedtls_ecdh_gen_public( &ecdh.ecdh.grp, &ecdh.ecdh.d, &ecdh.ecdh.Qp, myrand, NULL ) != 0 )
             {
                 mbedtls_exit( 1 );
             }
 
             mbedtls_snprintf( title, sizeof(title), "ECDHE-%s",
                               curve_info->name );
-            TIME_PUBLIC(  title, "handshake",
-                    ret |= mbedtls_ecdh_gen_public( &ecdh.grp, &ecdh.d, &ecdh.Q,
-                                            myrand, NULL );
-                    ret |= mbedtls_ecdh_compute_shared( &ecdh.grp, &z, &ecdh.Qp, &ecdh.d,
-                                                myrand, NULL ) );
-
-            mbedtls_ecdh_free( &ecdh );
-            mbedtls_mpi_free( &z );
+            TIME_PUBLIC( title, "handshake", bench_ecdhe_montgomery, &ecdh );
+
+            mbedtls_ecdh_free( &ecdh.ecdh );
+            mbedtls_mpi_free( &ecdh.z );
         }
 
         for( curve_info = mbedtls_ecp_curve_list();
              curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
              curve_info++ )
         {
-            mbedtls_ecdh_init( &ecdh );
+            mbedtls_ecdh_init( &ecdh.ecdh );
 
-            if( mbedtls_ecp_group_load( &ecdh.grp, curve_info->grp_id ) != 0 ||
-                mbedtls_ecdh_make_public( &ecdh, &olen, buf, sizeof( buf),
+            if( mbedtls_ecp_group_load( &ecdh.ecdh.grp, curve_info->grp_id ) != 0 ||
+                mbedtls_ecdh_make_public( &ecdh.ecdh, &olen, buf, sizeof( buf),
                                   myrand, NULL ) != 0 ||
-                mbedtls_ecp_copy( &ecdh.Qp, &ecdh.Q ) != 0 ||
-                mbedtls_ecdh_make_public( &ecdh, &olen, buf, sizeof( buf),
+                mbedtls_ecp_copy( &ecdh.ecdh.Qp, &ecdh.ecdh.Q ) != 0 ||
+                mbedtls_ecdh_make_public( &ecdh.ecdh, &olen, buf, sizeof( buf),
                                   myrand, NULL ) != 0 )
             {
                 mbedtls_exit( 1 );
             }
-            ecp_clear_precomputed( &ecdh.grp );
+            ecp_clear_precomputed( &ecdh.ecdh.grp );
 
             mbedtls_snprintf( title, sizeof( title ), "ECDH-%s",
                                               curve_info->name );
-            TIME_PUBLIC( title, "handshake",
-                    ret |= mbedtls_ecdh_calc_secret( &ecdh, &olen, buf, sizeof( buf ),
-                                             myrand, NULL ) );
-            mbedtls_ecdh_free( &ecdh );
+            TIME_PUBLIC( title, "handshake", bench_ecdh, &ecdh );
+            mbedtls_ecdh_free( &ecdh.ecdh );
         }
 
         /* Montgomery curves need to be handled separately */
@@ -976,30 +1882,239 @@ int main( int argc, char *argv[] )
               curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
               curve_info++)
         {
-            mbedtls_ecdh_init( &ecdh );
-            mbedtls_mpi_init( &z );
+            mbedtls_ecdh_init( &ecdh.ecdh );
+            mbedtls_mpi_init( &ecdh.z );
 
-            if( mbedtls_ecp_group_load( &ecdh.grp, curve_info->grp_id ) != 0 ||
-                mbedtls_ecdh_gen_public( &ecdh.grp, &ecdh.d, &ecdh.Qp,
+            if( mbedtls_ecp_group_load( &ecdh.ecdh.grp, curve_info->grp_id ) != 0 ||
+                mbedtls_ecdh_gen_public( &ecdh.ecdh.grp, &ecdh.ecdh.d, &ecdh.ecdh.Qp,
                                  myrand, NULL ) != 0 ||
-                mbedtls_ecdh_gen_public( &ecdh.grp, &ecdh.d, &ecdh.Q, myrand, NULL ) != 0 )
+                mbedtls_ecdh_gen_public( &ecdh.ecdh.grp, &ecdh.ecdh.d, &ecdh.ecdh.Q, myrand, NULL ) != 0 )
             {
                 mbedtls_exit( 1 );
             }
 
             mbedtls_snprintf( title, sizeof(title), "ECDH-%s",
                               curve_info->name );
-            TIME_PUBLIC(  title, "handshake",
-                    ret |= mbedtls_ecdh_compute_shared( &ecdh.grp, &z, &ecdh.Qp, &ecdh.d,
-                                                myrand, NULL ) );
+            TIME_PUBLIC( title, "handshake", bench_ecdh_montgomery, &ecdh );
 
-            mbedtls_ecdh_free( &ecdh );
-            mbedtls_mpi_free( &z );
+            mbedtls_ecdh_free( &ecdh.ecdh );
+            mbedtls_mpi_free( &ecdh.z );
         }
     }
 #endif
 
-    mbedtls_printf( "\n" );
+#if defined(MBEDTLS_PSA_CRYPTO_C)
+    if( todo.psa_hash || todo.psa_mac || todo.psa_aead || todo.psa_sign ||
+        todo.psa_ka || todo.psa_key )
+    {
+        psa_bench_ctx bench;
+        psa_status_t alloc_status;
+
+        memset( &bench, 0, sizeof( bench ) );
+
+        if( psa_crypto_init( ) != PSA_SUCCESS )
+        {
+            mbedtls_printf( "PSA crypto initialization failed\n" );
+            mbedtls_exit( 1 );
+        }
+
+        if( todo.psa_hash )
+        {
+#if defined(MBEDTLS_SHA256_C)
+            bench.alg = PSA_ALG_SHA_256;
+            TIME_AND_TSC( "PSA SHA-256", psa_hash_bench, &bench );
+#endif
+#if defined(MBEDTLS_SHA512_C)
+            bench.alg = PSA_ALG_SHA_512;
+            TIME_AND_TSC( "PSA SHA-512", psa_hash_bench, &bench );
+#endif
+        }
+
+        if( todo.psa_mac )
+        {
+#if defined(MBEDTLS_SHA256_C)
+            bench.alg = PSA_ALG_HMAC( PSA_ALG_SHA_256 );
+            bench.status = psa_bench_allocate( &bench.handle,
+                                               PSA_KEY_USAGE_SIGN, bench.alg );
+            alloc_status = bench.status;
+            if( bench.status == PSA_SUCCESS )
+                bench.status = psa_import_key( bench.handle,
+                                               PSA_KEY_TYPE_HMAC, tmp, 32 );
+            TIME_AND_TSC( "PSA HMAC-SHA-256", psa_mac_bench, &bench );
+            if( alloc_status == PSA_SUCCESS )
+                (void) psa_destroy_key( bench.handle );
+#endif
+#if defined(MBEDTLS_AES_C) && defined(MBEDTLS_CMAC_C)
+            bench.alg = PSA_ALG_CMAC;
+            bench.status = psa_bench_allocate( &bench.handle,
+                                               PSA_KEY_USAGE_SIGN, bench.alg );
+            alloc_status = bench.status;
+            if( bench.status == PSA_SUCCESS )
+                bench.status = psa_import_key( bench.handle,
+                                               PSA_KEY_TYPE_AES, tmp, 16 );
+            TIME_AND_TSC( "PSA AES-CMAC-128", psa_mac_bench, &bench );
+            if( alloc_status == PSA_SUCCESS )
+                (void) psa_destroy_key( bench.handle );
+#endif
+        }
+
+#if defined(MBEDTLS_AES_C)
+        if( todo.psa_aead )
+        {
+            static const struct
+            {
+                const char *name;
+                psa_algorithm_t alg;
+            } aeads[] = {
+#if defined(MBEDTLS_GCM_C)
+                { "GCM", PSA_ALG_GCM },
+#endif
+#if defined(MBEDTLS_CCM_C)
+                { "CCM", PSA_ALG_CCM },
+#endif
+                { NULL, 0 }
+            };
+            size_t n;
+            int keysize;
+
+            for( n = 0; aeads[n].name != NULL; n++ )
+            {
+                for( keysize = 128; keysize <= 256; keysize += 128 )
+                {
+                    mbedtls_snprintf( title, sizeof( title ),
+                                      "PSA AES-%s-%d", aeads[n].name,
+                                      keysize );
+
+                    bench.alg = aeads[n].alg;
+                    bench.status = psa_bench_allocate( &bench.handle,
+                                                       PSA_KEY_USAGE_ENCRYPT,
+                                                       bench.alg );
+                    alloc_status = bench.status;
+                    if( bench.status == PSA_SUCCESS )
+                        bench.status = psa_import_key( bench.handle,
+                                                       PSA_KEY_TYPE_AES,
+                                                       tmp, keysize / 8 );
+                    TIME_AND_TSC( title, psa_aead_bench, &bench );
+                    if( alloc_status == PSA_SUCCESS )
+                        (void) psa_destroy_key( bench.handle );
+                }
+            }
+        }
+#endif /* MBEDTLS_AES_C */
+
+#if defined(MBEDTLS_SHA256_C)
+        if( todo.psa_sign )
+        {
+            static const struct
+            {
+                const char *name;
+                psa_key_type_t type;
+                size_t bits;
+                psa_algorithm_t alg;
+            } signers[] = {
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+                { "ECDSA-secp256r1",
+                  PSA_KEY_TYPE_ECC_KEYPAIR( PSA_ECC_CURVE_SECP256R1 ), 256,
+                  PSA_ALG_ECDSA( PSA_ALG_SHA_256 ) },
+#endif
+#if defined(MBEDTLS_RSA_C) && defined(MBEDTLS_GENPRIME)
+                { "RSA-2048", PSA_KEY_TYPE_RSA_KEYPAIR, 2048,
+                  PSA_ALG_RSA_PKCS1V15_SIGN( PSA_ALG_SHA_256 ) },
+#endif
+                { NULL, 0, 0, 0 }
+            };
+            size_t n;
+
+            for( n = 0; signers[n].name != NULL; n++ )
+            {
+                bench.alg = signers[n].alg;
+                bench.status = psa_bench_allocate( &bench.handle,
+                                                   PSA_KEY_USAGE_SIGN |
+                                                   PSA_KEY_USAGE_VERIFY,
+                                                   bench.alg );
+                alloc_status = bench.status;
+                if( bench.status == PSA_SUCCESS )
+                    bench.status = psa_generate_key( bench.handle,
+                                                     signers[n].type,
+                                                     signers[n].bits,
+                                                     NULL, 0 );
+
+                mbedtls_snprintf( title, sizeof( title ), "PSA %s",
+                                  signers[n].name );
+                TIME_PUBLIC( title, "sign", psa_sign_bench, &bench );
+
+                TIME_PUBLIC( title, "verify", psa_verify_bench, &bench );
+
+                if( alloc_status == PSA_SUCCESS )
+                    (void) psa_destroy_key( bench.handle );
+            }
+        }
+#endif /* MBEDTLS_SHA256_C */
+
+#if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED) && \
+    defined(MBEDTLS_HKDF_C) && defined(MBEDTLS_SHA256_C)
+        if( todo.psa_ka )
+        {
+            const psa_key_type_t type =
+                PSA_KEY_TYPE_ECC_KEYPAIR( PSA_ECC_CURVE_SECP256R1 );
+            unsigned char peer[PSA_KEY_EXPORT_MAX_SIZE(
+                PSA_KEY_TYPE_ECC_PUBLIC_KEY( PSA_ECC_CURVE_SECP256R1 ), 256 )];
+            size_t peer_len = 0;
+
+            /* The peer is our own public key: it is a valid point, which
+             * is all the key agreement needs */
+            bench.alg = PSA_ALG_ECDH( PSA_ALG_HKDF( PSA_ALG_SHA_256 ) );
+            bench.status = psa_bench_allocate( &bench.handle,
+                                               PSA_KEY_USAGE_DERIVE,
+                                               bench.alg );
+            alloc_status = bench.status;
+            if( bench.status == PSA_SUCCESS )
+                bench.status = psa_generate_key( bench.handle, type, 256,
+                                                 NULL, 0 );
+            if( bench.status == PSA_SUCCESS )
+                bench.status = psa_export_public_key( bench.handle,
+                                                      peer, sizeof( peer ),
+                                                      &peer_len );
+            bench.peer_key = peer;
+            bench.peer_key_len = peer_len;
+
+            TIME_PUBLIC( "PSA ECDH-secp256r1", "agreement",
+                         psa_ka_bench, &bench );
+
+            if( alloc_status == PSA_SUCCESS )
+                (void) psa_destroy_key( bench.handle );
+        }
+#endif
+
+#if defined(MBEDTLS_PSA_CRYPTO_STORAGE_C)
+        if( todo.psa_key )
+        {
+            psa_key_bench( "AES-128", PSA_KEY_TYPE_AES, tmp, 16 );
+#if defined(MBEDTLS_ECP_DP_SECP256R1_ENABLED)
+            {
+                static const unsigned char ecc_key[32] = {
+                    0x49, 0xc9, 0xa8, 0xc1, 0x8c, 0x4b, 0x88, 0x56,
+                    0x38, 0xc4, 0x31, 0xcf, 0x1d, 0xf1, 0xc9, 0x94,
+                    0x13, 0x16, 0x09, 0xb5, 0x80, 0xd4, 0xfd, 0x43,
+                    0xa0, 0xca, 0xb1, 0x7d, 0xb2, 0xf1, 0x3e, 0xee
+                };
+                psa_key_bench( "secp256r1",
+                               PSA_KEY_TYPE_ECC_KEYPAIR(
+                                   PSA_ECC_CURVE_SECP256R1 ),
+                               ecc_key, sizeof( ecc_key ) );
+            }
+#endif
+        }
+#endif /* MBEDTLS_PSA_CRYPTO_STORAGE_C */
+
+        mbedtls_psa_crypto_free( );
+    }
+#endif /* MBEDTLS_PSA_CRYPTO_C */
+
+    if( opt.format == FORMAT_JSON )
+        mbedtls_printf( "\n]\n" );
+    else if( opt.format == FORMAT_TEXT )
+        mbedtls_printf( "\n" );
 
 #if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C)
     mbedtls_memory_buffer_alloc_free();
@@ -585,6 +585,17 @@ component_test_rsa_no_crt () {
     make test
 }
 
+component_test_psa_key_cache () {
+    msg "build: Default + PSA_CRYPTO_KEY_CACHE (ASan build)" # ~ 6 min
+    scripts/config.pl set MBEDTLS_PSA_CRYPTO_KEY_CACHE
+    scripts/config.pl set MBEDTLS_PSA_KEY_CACHE_SIZE 2
+    CC=gcc cmake -D CMAKE_BUILD_TYPE:String=Asan .
+    make
+
+    msg "test: PSA_CRYPTO_KEY_CACHE - main suites (inc. selftests) (ASan build)" # ~ 50s
+    make test
+}
+
 component_test_new_ecdh_context () {
     msg "build: new ECDH context (ASan build)" # ~ 6 min
     scripts/config.pl unset MBEDTLS_ECDH_LEGACY_CONTEXT
@@ -1622,6 +1622,24 @@
  */
 //#define MBEDTLS_SSL_TRUNCATED_HMAC_COMPAT
 
+/**
+ * \def MBEDTLS_SSL_ZERO_COPY
+ *
+ * Enable the zero-copy application data API: mbedtls_ssl_write_get_buf(),
+ * mbedtls_ssl_write_commit(), mbedtls_ssl_read_get_buf() and
+ * mbedtls_ssl_read_release().
+ *
+ * The application writes its plaintext directly into the outgoing record,
+ * where it is encrypted in place, and reads decrypted plaintext directly
+ * from the incoming record, saving one copy of every byte in each
+ * direction and the need for separate application buffers.
+ *
+ * Requires: MBEDTLS_SSL_TLS_C
+ *
+ * Uncomment this to enable the zero-copy API.
+ */
+//#define MBEDTLS_SSL_ZERO_COPY
+
 /**
  * \def MBEDTLS_THREADING_ALT
  *
@@ -1716,6 +1734,23 @@
  */
 #define MBEDTLS_X509_RSASSA_PSS_SUPPORT
 
+/**
+ * \def MBEDTLS_X509_STREAM_VERIFY
+ *
+ * Enable mbedtls_x509_crt_verify_stream(), which verifies a chain of
+ * DER certificates in place, one link at a time, instead of parsing the
+ * whole chain into mbedtls_x509_crt structures first.
+ *
+ * Only the fields needed for path validation are extracted, they point into
+ * the caller's buffer, and at most one public key of the chain is loaded at
+ * any time, so the heap usage does not depend on the chain length.
+ *
+ * Requires: MBEDTLS_X509_CRT_PARSE_C
+ *
+ * Uncomment this macro to enable streaming certificate chain verification.
+ */
+//#define MBEDTLS_X509_STREAM_VERIFY
+
 /**
  * \def MBEDTLS_ZLIB_SUPPORT
  *
@@ -3159,6 +3159,93 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
  */
 int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_t len );
 
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+/**
+ * \brief          Get a pointer to the decrypted application data of the
+ *                 current incoming record, without copying it.
+ *
+ * \param ssl      SSL context
+ * \param buf      On success, set to the start of the available plaintext.
+ *                 The pointer stays valid until the next call to
+ *                 \c mbedtls_ssl_read_release() that consumes all of it, or
+ *                 any other read-side call on \p ssl.
+ * \param len      On success, set to the number of bytes available at
+ *                 \p buf. \c 0 means the read end of the underlying
+ *                 transport was closed (as \c mbedtls_ssl_read() returning
+ *                 \c 0), or an empty application data record was received.
+ *
+ * \return         \c 0 if successful.
+ * \return         Any error code that \c mbedtls_ssl_read() may return,
+ *                 with the same meaning and handling requirements.
+ *
+ * \note           Call \c mbedtls_ssl_read_release() once the data has been
+ *                 processed. Until then, repeated calls return the same
+ *                 data. This can be freely mixed with \c mbedtls_ssl_read().
+ */
+int mbedtls_ssl_read_get_buf( mbedtls_ssl_context *ssl,
+                              const unsigned char **buf, size_t *len );
+
+/**
+ * \brief          Mark application data obtained through
+ *                 \c mbedtls_ssl_read_get_buf() as consumed.
+ *
+ * \param ssl      SSL context
+ * \param len      Number of bytes consumed, at most the length returned by
+ *                 the last call to \c mbedtls_ssl_read_get_buf().
+ *
+ * \return         \c 0 if successful, or #MBEDTLS_ERR_SSL_BAD_INPUT_DATA if
+ *                 more data is released than available.
+ */
+int mbedtls_ssl_read_release( mbedtls_ssl_context *ssl, size_t len );
+
+/**
+ * \brief          Get the plaintext area of the next outgoing record, so
+ *                 that the application can build its data in place.
+ *
+ * \param ssl      SSL context
+ * \param buf      On success, set to the start of the plaintext area.
+ * \param len      On success, set to the maximum number of bytes that may
+ *                 be written at \p buf (the current maximum outgoing record
+ *                 payload, see \c mbedtls_ssl_get_max_out_record_payload()).
+ *
+ * \return         \c 0 if successful.
+ * \return         #MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE if 1/n-1 CBC record
+ *                 splitting is active on this connection; use
+ *                 \c mbedtls_ssl_write() instead.
+ * \return         Any error code that \c mbedtls_ssl_write() may return,
+ *                 with the same meaning and handling requirements. In
+ *                 particular, #MBEDTLS_ERR_SSL_WANT_WRITE means previously
+ *                 committed data is still being flushed.
+ *
+ * \note           The data is encrypted in place by
+ *                 \c mbedtls_ssl_write_commit(). No other function that may
+ *                 send a record (write, read, handshake, alert) may be
+ *                 called on \p ssl between these two calls.
+ */
+int mbedtls_ssl_write_get_buf( mbedtls_ssl_context *ssl,
+                               unsigned char **buf, size_t *len );
+
+/**
+ * \brief          Encrypt and send \p len bytes of application data that
+ *                 were written in place after \c mbedtls_ssl_write_get_buf().
+ *
+ * \param ssl      SSL context
+ * \param len      Number of bytes written in the buffer. Must not exceed
+ *                 the length returned by \c mbedtls_ssl_write_get_buf().
+ *
+ * \return         \c 0 if the whole record was sent.
+ * \return         #MBEDTLS_ERR_SSL_BAD_INPUT_DATA if \p len is too large
+ *                 or no handshake has been completed.
+ * \return         #MBEDTLS_ERR_SSL_WANT_WRITE if the record was encrypted
+ *                 but not completely sent - in this case you must call this
+ *                 function again with the same \p len when the underlying
+ *                 transport is ready, without writing to the buffer again.
+ * \return         Another SSL error code, with the same handling
+ *                 requirements as for \c mbedtls_ssl_write().
+ */
+int mbedtls_ssl_write_commit( mbedtls_ssl_context *ssl, size_t len );
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+
 /**
  * \brief           Send an alert message
  *
@@ -456,6 +456,46 @@ int mbedtls_x509_crt_verify_restartable( mbedtls_x509_crt *crt,
                      void *p_vrfy,
                      mbedtls_x509_crt_restart_ctx *rs_ctx );
 
+#if defined(MBEDTLS_X509_STREAM_VERIFY)
+/**
+ * \brief          Verify a DER certificate chain in place, with a fixed
+ *                 amount of memory
+ *
+ * \note           Performs the same checks as
+ *                 \c mbedtls_x509_crt_verify_with_profile() without CRLs and
+ *                 without a verification callback, but never builds
+ *                 \c mbedtls_x509_crt structures for the chain: certificates
+ *                 are decoded one at a time from \p chain, keeping only the
+ *                 fields needed for path validation, and at most one public
+ *                 key of the chain is loaded at any time.
+ *
+ * \note           Intermediate CAs are only looked for after the certificate
+ *                 they issued, as in the Certificate message of TLS.
+ *                 Certificates that are not needed to reach a trusted CA are
+ *                 not parsed.
+ *
+ * \param chain    concatenation of DER certificates, end-entity first; the
+ *                 buffer must stay valid and unmodified during the call
+ * \param chain_len length of \p chain in bytes
+ * \param trust_ca the list of trusted CAs
+ * \param profile  security profile for verification
+ * \param cn       expected Common Name (can be set to
+ *                 NULL if the CN must not be verified)
+ * \param flags    result of the verification
+ *
+ * \return         0 if successful or MBEDTLS_ERR_X509_CERT_VERIFY_FAILED
+ *                 in which case *flags will have one or more
+ *                 MBEDTLS_X509_BADCERT_XXX flags set,
+ *                 or another error (and *flags set to -1) if a certificate
+ *                 could not be parsed or in case of a fatal error.
+ */
+int mbedtls_x509_crt_verify_stream( const unsigned char *chain,
+                     size_t chain_len,
+                     mbedtls_x509_crt *trust_ca,
+                     const mbedtls_x509_crt_profile *profile,
+                     const char *cn, uint32_t *flags );
+#endif /* MBEDTLS_X509_STREAM_VERIFY */
+
 #if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
 /**
  * \brief          Check usage of certificate against keyUsage extension.
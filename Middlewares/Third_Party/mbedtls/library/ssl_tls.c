@@ -8257,17 +8257,15 @@ static int ssl_check_ctr_renegotiate( mbedtls_ssl_context *ssl )
 #endif /* MBEDTLS_SSL_RENEGOTIATION */
 
 /*
- * Receive application data decrypted from the SSL layer
+ * Make sure decrypted application data is available in ssl->in_offt,
+ * performing or continuing a handshake or renegotiation if needed.
+ *
+ * If the underlying transport was closed, 0 is returned and ssl->in_offt
+ * is left NULL.
  */
-int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
+static int ssl_read_prepare( mbedtls_ssl_context *ssl )
 {
     int ret;
-    size_t n;
-
-    if( ssl == NULL || ssl->conf == NULL )
-        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
-
-    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read" ) );
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
     if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
@@ -8537,10 +8535,14 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
 #endif /* MBEDTLS_SSL_PROTO_DTLS */
     }
 
-    n = ( len < ssl->in_msglen )
-        ? len : ssl->in_msglen;
+    return( 0 );
+}
 
-    memcpy( buf, ssl->in_offt, n );
+/*
+ * Mark n bytes of the current application data record as consumed
+ */
+static void ssl_read_consume( mbedtls_ssl_context *ssl, size_t n )
+{
     ssl->in_msglen -= n;
 
     if( ssl->in_msglen == 0 )
@@ -8554,12 +8556,89 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
         /* more data available */
         ssl->in_offt += n;
     }
+}
+
+/*
+ * Receive application data decrypted from the SSL layer
+ */
+int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
+{
+    int ret;
+    size_t n;
+
+    if( ssl == NULL || ssl->conf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read" ) );
+
+    if( ( ret = ssl_read_prepare( ssl ) ) != 0 )
+        return( ret );
+
+    /* underlying transport closed */
+    if( ssl->in_offt == NULL )
+        return( 0 );
+
+    n = ( len < ssl->in_msglen )
+        ? len : ssl->in_msglen;
+
+    memcpy( buf, ssl->in_offt, n );
+    ssl_read_consume( ssl, n );
 
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= read" ) );
 
     return( (int) n );
 }
 
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+/*
+ * Zero-copy read: expose the decrypted record in place
+ */
+int mbedtls_ssl_read_get_buf( mbedtls_ssl_context *ssl,
+                              const unsigned char **buf, size_t *len )
+{
+    int ret;
+
+    if( ssl == NULL || ssl->conf == NULL || buf == NULL || len == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read get buf" ) );
+
+    *buf = NULL;
+    *len = 0;
+
+    if( ( ret = ssl_read_prepare( ssl ) ) != 0 )
+        return( ret );
+
+    /* underlying transport closed: *len stays 0 */
+    if( ssl->in_offt == NULL )
+        return( 0 );
+
+    *buf = ssl->in_offt;
+    *len = ssl->in_msglen;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= read get buf" ) );
+
+    return( 0 );
+}
+
+int mbedtls_ssl_read_release( mbedtls_ssl_context *ssl, size_t len )
+{
+    if( ssl == NULL || ssl->conf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    if( ssl->in_offt == NULL || len > ssl->in_msglen )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "releasing more application data "
+                                    "than available" ) );
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+    }
+
+    ssl_read_consume( ssl, len );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+
 /*
  * Send application data to be encrypted by the SSL layer, taking care of max
  * fragment length and buffer size.
@@ -8618,11 +8697,13 @@ static int ssl_write_real( mbedtls_ssl_context *ssl,
         /*
          * The user is trying to send a message the first time, so we need to
          * copy the data into the internal buffers and setup the data structure
-         * to keep track of partial writes
+         * to keep track of partial writes.
+         * With MBEDTLS_SSL_ZERO_COPY the data may already be in place.
          */
         ssl->out_msglen  = len;
         ssl->out_msgtype = MBEDTLS_SSL_MSG_APPLICATION_DATA;
-        memcpy( ssl->out_msg, buf, len );
+        if( buf != ssl->out_msg )
+            memcpy( ssl->out_msg, buf, len );
 
         if( ( ret = mbedtls_ssl_write_record( ssl, SSL_FORCE_FLUSH ) ) != 0 )
         {
@@ -8712,6 +8793,108 @@ int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_
     return( ret );
 }
 
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+/*
+ * Zero-copy write: hand out the plaintext area of the outgoing record
+ */
+int mbedtls_ssl_write_get_buf( mbedtls_ssl_context *ssl,
+                               unsigned char **buf, size_t *len )
+{
+    int ret;
+
+    if( ssl == NULL || ssl->conf == NULL || buf == NULL || len == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write get buf" ) );
+
+    *buf = NULL;
+    *len = 0;
+
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    if( ( ret = ssl_check_ctr_renegotiate( ssl ) ) != 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "ssl_check_ctr_renegotiate", ret );
+        return( ret );
+    }
+#endif
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+    {
+        if( ( ret = mbedtls_ssl_handshake( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_handshake", ret );
+            return( ret );
+        }
+    }
+
+#if defined(MBEDTLS_SSL_CBC_RECORD_SPLITTING)
+    /* 1/n-1 splitting would encrypt the first byte in place and clobber
+     * the rest of the caller's plaintext with the MAC and padding. */
+    if( ssl->conf->cbc_record_splitting !=
+            MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED &&
+        ssl->minor_ver <= MBEDTLS_SSL_MINOR_VERSION_1 &&
+        mbedtls_cipher_get_cipher_mode( &ssl->transform_out->cipher_ctx_enc )
+                                == MBEDTLS_MODE_CBC )
+    {
+        MBEDTLS_SSL_DEBUG_MSG( 1, ( "zero-copy write not available "
+                                    "with CBC record splitting" ) );
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+    }
+#endif /* MBEDTLS_SSL_CBC_RECORD_SPLITTING */
+
+    /* The record buffer must be free before handing it out */
+    if( ssl->out_left != 0 )
+    {
+        if( ( ret = mbedtls_ssl_flush_output( ssl ) ) != 0 )
+        {
+            MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_flush_output", ret );
+            return( ret );
+        }
+    }
+
+    if( ( ret = mbedtls_ssl_get_max_out_record_payload( ssl ) ) < 0 )
+    {
+        MBEDTLS_SSL_DEBUG_RET( 1, "mbedtls_ssl_get_max_out_record_payload", ret );
+        return( ret );
+    }
+
+    *buf = ssl->out_msg;
+    *len = (size_t) ret;
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= write get buf" ) );
+
+    return( 0 );
+}
+
+int mbedtls_ssl_write_commit( mbedtls_ssl_context *ssl, size_t len )
+{
+    int ret;
+
+    if( ssl == NULL || ssl->conf == NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> write commit" ) );
+
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ret = mbedtls_ssl_get_max_out_record_payload( ssl );
+    if( ret < 0 )
+        return( ret );
+
+    /* Unlike mbedtls_ssl_write(), truncating would silently drop data that
+     * the caller already placed in the record. */
+    if( len > (size_t) ret )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    ret = ssl_write_real( ssl, ssl->out_msg, len );
+
+    MBEDTLS_SSL_DEBUG_MSG( 2, ( "<= write commit" ) );
+
+    return( ret < 0 ? ret : 0 );
+}
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+
 /*
  * Notify the peer that the connection is being closed
  */
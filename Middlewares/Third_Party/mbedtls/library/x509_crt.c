@@ -2605,6 +2605,1087 @@ exit:
     return( 0 );
 }
 
+#if defined(MBEDTLS_X509_STREAM_VERIFY)
+/*
+ * Subset of a certificate used by mbedtls_x509_crt_verify_stream().
+ *
+ * All buffers point into the DER being verified (or into the raw data of a
+ * trusted certificate), the only allocated member is sig_opts for RSASSA-PSS.
+ */
+typedef struct
+{
+    mbedtls_x509_buf raw;           /* the whole certificate                */
+    mbedtls_x509_buf tbs;           /* the signed part                      */
+    mbedtls_x509_buf issuer_raw;    /* Name, including the SEQUENCE header  */
+    mbedtls_x509_buf subject_raw;   /* Name, including the SEQUENCE header  */
+    mbedtls_x509_buf pk_raw;        /* SubjectPublicKeyInfo                 */
+    mbedtls_x509_buf san_raw;       /* contents of GeneralNames, if present */
+    mbedtls_x509_buf sig;
+
+    mbedtls_x509_time valid_from;
+    mbedtls_x509_time valid_to;
+
+    int version;
+    int ext_types;
+    int ca_istrue;
+    int max_pathlen;
+    unsigned int key_usage;
+
+    mbedtls_md_type_t sig_md;
+    mbedtls_pk_type_t sig_pk;
+    void *sig_opts;
+}
+x509_crt_frame;
+
+static void x509_crt_frame_init( x509_crt_frame *frame )
+{
+    memset( frame, 0, sizeof( x509_crt_frame ) );
+}
+
+static void x509_crt_frame_free( x509_crt_frame *frame )
+{
+#if defined(MBEDTLS_X509_RSASSA_PSS_SUPPORT)
+    mbedtls_free( frame->sig_opts );
+#endif
+
+    x509_crt_frame_init( frame );
+}
+
+/*
+ * Get the next AttributeTypeAndValue of a Name in place, without allocating.
+ * *p and *end_set keep track of the position: start with *p pointing to the
+ * contents of the RDNSequence and *end_set == *p.
+ *
+ * Same checks as mbedtls_x509_get_name(). At the end of the Name, returns 0
+ * with cur->oid.p == NULL.
+ */
+static int x509_name_raw_next( unsigned char **p, const unsigned char *end,
+                               unsigned char **end_set,
+                               mbedtls_x509_name *cur )
+{
+    int ret;
+    size_t len;
+    const unsigned char *end_attr;
+
+    memset( cur, 0, sizeof( mbedtls_x509_name ) );
+
+    if( *p == *end_set )
+    {
+        if( *p == end )
+            return( 0 );
+
+        if( ( ret = mbedtls_asn1_get_tag( p, end, &len,
+                MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SET ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_NAME + ret );
+
+        *end_set = *p + len;
+    }
+
+    if( ( ret = mbedtls_asn1_get_tag( p, *end_set, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_NAME + ret );
+
+    end_attr = *p + len;
+
+    cur->oid.tag = MBEDTLS_ASN1_OID;
+    if( ( ret = mbedtls_asn1_get_tag( p, end_attr, &cur->oid.len,
+                                      MBEDTLS_ASN1_OID ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_NAME + ret );
+
+    cur->oid.p = *p;
+    *p += cur->oid.len;
+
+    if( ( end_attr - *p ) < 1 )
+        return( MBEDTLS_ERR_X509_INVALID_NAME +
+                MBEDTLS_ERR_ASN1_OUT_OF_DATA );
+
+    if( **p != MBEDTLS_ASN1_BMP_STRING && **p != MBEDTLS_ASN1_UTF8_STRING      &&
+        **p != MBEDTLS_ASN1_T61_STRING && **p != MBEDTLS_ASN1_PRINTABLE_STRING &&
+        **p != MBEDTLS_ASN1_IA5_STRING && **p != MBEDTLS_ASN1_UNIVERSAL_STRING &&
+        **p != MBEDTLS_ASN1_BIT_STRING )
+        return( MBEDTLS_ERR_X509_INVALID_NAME +
+                MBEDTLS_ERR_ASN1_UNEXPECTED_TAG );
+
+    cur->val.tag = *(*p)++;
+
+    if( ( ret = mbedtls_asn1_get_len( p, end_attr, &cur->val.len ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_NAME + ret );
+
+    cur->val.p = *p;
+    *p += cur->val.len;
+
+    if( *p != end_attr )
+        return( MBEDTLS_ERR_X509_INVALID_NAME +
+                MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
+
+    cur->next_merged = ( *p != *end_set );
+
+    return( 0 );
+}
+
+/*
+ * Open a raw Name (including its SEQUENCE header) for x509_name_raw_next()
+ */
+static int x509_name_raw_open( const mbedtls_x509_buf *raw,
+                               unsigned char **p, const unsigned char **end )
+{
+    int ret;
+    size_t len;
+
+    *p = raw->p;
+
+    if( ( ret = mbedtls_asn1_get_tag( p, raw->p + raw->len, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
+
+    *end = *p + len;
+
+    return( 0 );
+}
+
+/*
+ * Compare two raw X.509 Names, with the same rules as x509_name_cmp().
+ *
+ * Return 0 if equal, -1 otherwise.
+ */
+static int x509_name_cmp_raw( const mbedtls_x509_buf *a,
+                              const mbedtls_x509_buf *b )
+{
+    unsigned char *pa, *pb, *set_a, *set_b;
+    const unsigned char *end_a, *end_b;
+    mbedtls_x509_name na, nb;
+
+    if( x509_name_raw_open( a, &pa, &end_a ) != 0 ||
+        x509_name_raw_open( b, &pb, &end_b ) != 0 )
+    {
+        return( -1 );
+    }
+
+    set_a = pa;
+    set_b = pb;
+
+    while( 1 )
+    {
+        if( x509_name_raw_next( &pa, end_a, &set_a, &na ) != 0 ||
+            x509_name_raw_next( &pb, end_b, &set_b, &nb ) != 0 )
+        {
+            return( -1 );
+        }
+
+        if( na.oid.p == NULL || nb.oid.p == NULL )
+            return( na.oid.p == nb.oid.p ? 0 : -1 );
+
+        /* type */
+        if( na.oid.len != nb.oid.len ||
+            memcmp( na.oid.p, nb.oid.p, nb.oid.len ) != 0 )
+        {
+            return( -1 );
+        }
+
+        /* value */
+        if( x509_string_cmp( &na.val, &nb.val ) != 0 )
+            return( -1 );
+
+        /* structure of the list of sets */
+        if( na.next_merged != nb.next_merged )
+            return( -1 );
+    }
+}
+
+/*
+ * Walk a Name, as mbedtls_x509_get_name() would parse it, but in place
+ */
+static int x509_name_raw_check( unsigned char *p, const unsigned char *end )
+{
+    int ret;
+    unsigned char *end_set = p;
+    mbedtls_x509_name cur;
+
+    do
+    {
+        if( ( ret = x509_name_raw_next( &p, end, &end_set, &cur ) ) != 0 )
+            return( ret );
+    }
+    while( cur.oid.p != NULL );
+
+    return( 0 );
+}
+
+/*
+ * SubjectAltName, as x509_get_subject_alt_name() but only recording where
+ * the GeneralNames are
+ */
+static int x509_crt_frame_get_san( unsigned char **p,
+                                   const unsigned char *end,
+                                   mbedtls_x509_buf *san_raw )
+{
+    int ret;
+    size_t len, tag_len;
+
+    if( ( ret = mbedtls_asn1_get_tag( p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+    if( *p + len != end )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
+
+    san_raw->p = *p;
+    san_raw->len = len;
+
+    while( *p < end )
+    {
+        if( ( **p & MBEDTLS_ASN1_TAG_CLASS_MASK ) !=
+                MBEDTLS_ASN1_CONTEXT_SPECIFIC )
+        {
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                    MBEDTLS_ERR_ASN1_UNEXPECTED_TAG );
+        }
+
+        (*p)++;
+        if( ( ret = mbedtls_asn1_get_len( p, end, &tag_len ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        *p += tag_len;
+    }
+
+    return( 0 );
+}
+
+/*
+ * ExtKeyUsageSyntax, as x509_get_ext_key_usage() but without building the
+ * list (extendedKeyUsage is not used for path validation)
+ */
+static int x509_crt_frame_skip_ext_key_usage( unsigned char **p,
+                                              const unsigned char *end )
+{
+    int ret;
+    size_t len;
+
+    if( ( ret = mbedtls_asn1_get_tag( p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+    if( *p + len != end )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
+
+    /* Sequence length must be >= 1 */
+    if( len == 0 )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                MBEDTLS_ERR_ASN1_INVALID_LENGTH );
+
+    while( *p < end )
+    {
+        if( ( ret = mbedtls_asn1_get_tag( p, end, &len,
+                                          MBEDTLS_ASN1_OID ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        *p += len;
+    }
+
+    return( 0 );
+}
+
+/*
+ * X.509 v3 extensions, as x509_get_crt_ext()
+ */
+static int x509_crt_frame_get_ext( unsigned char **p,
+                                   const unsigned char *end,
+                                   x509_crt_frame *frame )
+{
+    int ret;
+    size_t len;
+    unsigned char *end_ext_data, *end_ext_octet;
+    unsigned char ns_cert_type;
+    mbedtls_x509_buf v3_ext;
+
+    if( *p == end )
+        return( 0 );
+
+    if( ( ret = mbedtls_x509_get_ext( p, end, &v3_ext, 3 ) ) != 0 )
+        return( ret );
+
+    end = v3_ext.p + v3_ext.len;
+    while( *p < end )
+    {
+        mbedtls_x509_buf extn_oid = {0, 0, NULL};
+        int is_critical = 0; /* DEFAULT FALSE */
+        int ext_type = 0;
+
+        if( ( ret = mbedtls_asn1_get_tag( p, end, &len,
+                MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        end_ext_data = *p + len;
+
+        /* Get extension ID */
+        if( ( ret = mbedtls_asn1_get_tag( p, end_ext_data, &extn_oid.len,
+                                          MBEDTLS_ASN1_OID ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        extn_oid.tag = MBEDTLS_ASN1_OID;
+        extn_oid.p = *p;
+        *p += extn_oid.len;
+
+        /* Get optional critical */
+        if( ( ret = mbedtls_asn1_get_bool( p, end_ext_data, &is_critical ) ) != 0 &&
+            ( ret != MBEDTLS_ERR_ASN1_UNEXPECTED_TAG ) )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        /* Data should be octet string type */
+        if( ( ret = mbedtls_asn1_get_tag( p, end_ext_data, &len,
+                MBEDTLS_ASN1_OCTET_STRING ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        end_ext_octet = *p + len;
+
+        if( end_ext_octet != end_ext_data )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                    MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
+
+        if( mbedtls_oid_get_x509_ext_type( &extn_oid, &ext_type ) != 0 )
+        {
+            /* No parser found, skip extension */
+            *p = end_ext_octet;
+
+#if !defined(MBEDTLS_X509_ALLOW_UNSUPPORTED_CRITICAL_EXTENSION)
+            if( is_critical )
+            {
+                /* Data is marked as critical: fail */
+                return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                        MBEDTLS_ERR_ASN1_UNEXPECTED_TAG );
+            }
+#endif
+            continue;
+        }
+
+        /* Forbid repeated extensions */
+        if( ( frame->ext_types & ext_type ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS );
+
+        frame->ext_types |= ext_type;
+
+        switch( ext_type )
+        {
+        case MBEDTLS_X509_EXT_BASIC_CONSTRAINTS:
+            ret = x509_get_basic_constraints( p, end_ext_octet,
+                    &frame->ca_istrue, &frame->max_pathlen );
+            break;
+
+        case MBEDTLS_X509_EXT_KEY_USAGE:
+            ret = x509_get_key_usage( p, end_ext_octet, &frame->key_usage );
+            break;
+
+        case MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE:
+            ret = x509_crt_frame_skip_ext_key_usage( p, end_ext_octet );
+            break;
+
+        case MBEDTLS_X509_EXT_SUBJECT_ALT_NAME:
+            ret = x509_crt_frame_get_san( p, end_ext_octet, &frame->san_raw );
+            break;
+
+        case MBEDTLS_X509_EXT_NS_CERT_TYPE:
+            ret = x509_get_ns_cert_type( p, end_ext_octet, &ns_cert_type );
+            break;
+
+        default:
+            ret = MBEDTLS_ERR_X509_FEATURE_UNAVAILABLE;
+        }
+
+        if( ret != 0 )
+            return( ret );
+    }
+
+    if( *p != end )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS +
+                MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
+
+    return( 0 );
+}
+
+/*
+ * Decode the certificate at *buf in place, with the same checks as
+ * x509_crt_parse_der_core() except that the public key is only located
+ * (see x509_crt_frame_get_pk()). On success, *buf is moved past it.
+ */
+static int x509_crt_frame_parse( x509_crt_frame *frame,
+                                 unsigned char **buf,
+                                 const unsigned char *buf_end )
+{
+    int ret;
+    size_t len;
+    unsigned char *p, *end, *crt_end;
+    mbedtls_x509_buf serial, uid;
+    mbedtls_x509_buf sig_oid1, sig_params1, sig_oid2, sig_params2;
+
+    memset( &sig_params1, 0, sizeof( mbedtls_x509_buf ) );
+    memset( &sig_params2, 0, sizeof( mbedtls_x509_buf ) );
+    memset( &sig_oid2, 0, sizeof( mbedtls_x509_buf ) );
+
+    x509_crt_frame_init( frame );
+
+    /*
+     * Certificate  ::=  SEQUENCE  {
+     */
+    p = *buf;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, buf_end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_FORMAT );
+
+    crt_end = p + len;
+
+    frame->raw.p = *buf;
+    frame->raw.len = crt_end - *buf;
+
+    /*
+     * TBSCertificate  ::=  SEQUENCE  {
+     */
+    frame->tbs.p = p;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, crt_end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+    {
+        ret = MBEDTLS_ERR_X509_INVALID_FORMAT + ret;
+        goto cleanup;
+    }
+
+    end = p + len;
+    frame->tbs.len = end - frame->tbs.p;
+
+    if( ( ret = x509_get_version( &p, end, &frame->version ) ) != 0 ||
+        ( ret = mbedtls_x509_get_serial( &p, end, &serial ) ) != 0 ||
+        ( ret = mbedtls_x509_get_alg( &p, end, &sig_oid1,
+                                      &sig_params1 ) ) != 0 )
+    {
+        goto cleanup;
+    }
+
+    if( frame->version < 0 || frame->version > 2 )
+    {
+        ret = MBEDTLS_ERR_X509_UNKNOWN_VERSION;
+        goto cleanup;
+    }
+
+    frame->version++;
+
+    if( ( ret = mbedtls_x509_get_sig_alg( &sig_oid1, &sig_params1,
+                                          &frame->sig_md, &frame->sig_pk,
+                                          &frame->sig_opts ) ) != 0 )
+    {
+        goto cleanup;
+    }
+
+    /*
+     * issuer               Name
+     */
+    frame->issuer_raw.p = p;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+    {
+        ret = MBEDTLS_ERR_X509_INVALID_FORMAT + ret;
+        goto cleanup;
+    }
+
+    /* unlike the subject, the issuer must not be empty */
+    if( len == 0 )
+    {
+        ret = MBEDTLS_ERR_X509_INVALID_NAME + MBEDTLS_ERR_ASN1_OUT_OF_DATA;
+        goto cleanup;
+    }
+
+    if( ( ret = x509_name_raw_check( p, p + len ) ) != 0 )
+        goto cleanup;
+
+    p += len;
+    frame->issuer_raw.len = p - frame->issuer_raw.p;
+
+    /*
+     * Validity ::= SEQUENCE {
+     */
+    if( ( ret = x509_get_dates( &p, end, &frame->valid_from,
+                                         &frame->valid_to ) ) != 0 )
+    {
+        goto cleanup;
+    }
+
+    /*
+     * subject              Name
+     */
+    frame->subject_raw.p = p;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+    {
+        ret = MBEDTLS_ERR_X509_INVALID_FORMAT + ret;
+        goto cleanup;
+    }
+
+    if( ( ret = x509_name_raw_check( p, p + len ) ) != 0 )
+        goto cleanup;
+
+    p += len;
+    frame->subject_raw.len = p - frame->subject_raw.p;
+
+    /*
+     * SubjectPublicKeyInfo
+     */
+    frame->pk_raw.p = p;
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+    {
+        ret = MBEDTLS_ERR_PK_KEY_INVALID_FORMAT + ret;
+        goto cleanup;
+    }
+
+    p += len;
+    frame->pk_raw.len = p - frame->pk_raw.p;
+
+    /*
+     *  issuerUniqueID  [1]  IMPLICIT UniqueIdentifier OPTIONAL,
+     *  subjectUniqueID [2]  IMPLICIT UniqueIdentifier OPTIONAL,
+     *  extensions      [3]  EXPLICIT Extensions OPTIONAL
+     */
+    if( frame->version == 2 || frame->version == 3 )
+    {
+        if( ( ret = x509_get_uid( &p, end, &uid, 1 ) ) != 0 ||
+            ( ret = x509_get_uid( &p, end, &uid, 2 ) ) != 0 )
+        {
+            goto cleanup;
+        }
+    }
+
+#if !defined(MBEDTLS_X509_ALLOW_EXTENSIONS_NON_V3)
+    if( frame->version == 3 )
+#endif
+    {
+        if( ( ret = x509_crt_frame_get_ext( &p, end, frame ) ) != 0 )
+            goto cleanup;
+    }
+
+    if( p != end )
+    {
+        ret = MBEDTLS_ERR_X509_INVALID_FORMAT +
+              MBEDTLS_ERR_ASN1_LENGTH_MISMATCH;
+        goto cleanup;
+    }
+
+    end = crt_end;
+
+    /*
+     *  signatureAlgorithm   AlgorithmIdentifier,
+     *  signatureValue       BIT STRING
+     */
+    if( ( ret = mbedtls_x509_get_alg( &p, end, &sig_oid2, &sig_params2 ) ) != 0 )
+        goto cleanup;
+
+    if( sig_oid1.len != sig_oid2.len ||
+        memcmp( sig_oid1.p, sig_oid2.p, sig_oid1.len ) != 0 ||
+        sig_params1.len != sig_params2.len ||
+        ( sig_params1.len != 0 &&
+          memcmp( sig_params1.p, sig_params2.p, sig_params1.len ) != 0 ) )
+    {
+        ret = MBEDTLS_ERR_X509_SIG_MISMATCH;
+        goto cleanup;
+    }
+
+    if( ( ret = mbedtls_x509_get_sig( &p, end, &frame->sig ) ) != 0 )
+        goto cleanup;
+
+    if( p != end )
+    {
+        ret = MBEDTLS_ERR_X509_INVALID_FORMAT +
+              MBEDTLS_ERR_ASN1_LENGTH_MISMATCH;
+        goto cleanup;
+    }
+
+    *buf = crt_end;
+
+cleanup:
+    if( ret != 0 )
+        x509_crt_frame_free( frame );
+
+    return( ret );
+}
+
+/*
+ * View a trusted certificate as a frame (nothing is allocated or copied, and
+ * sig_opts is left out as trusted certificates are never the child)
+ */
+static void x509_crt_frame_from_crt( x509_crt_frame *frame,
+                                     const mbedtls_x509_crt *crt )
+{
+    x509_crt_frame_init( frame );
+
+    frame->raw = crt->raw;
+    frame->tbs = crt->tbs;
+    frame->issuer_raw = crt->issuer_raw;
+    frame->subject_raw = crt->subject_raw;
+    frame->sig = crt->sig;
+    frame->valid_from = crt->valid_from;
+    frame->valid_to = crt->valid_to;
+    frame->version = crt->version;
+    frame->ext_types = crt->ext_types;
+    frame->ca_istrue = crt->ca_istrue;
+    frame->max_pathlen = crt->max_pathlen;
+    frame->key_usage = crt->key_usage;
+    frame->sig_md = crt->sig_md;
+    frame->sig_pk = crt->sig_pk;
+}
+
+/*
+ * Load the public key of a frame into an initialized pk context
+ */
+static int x509_crt_frame_get_pk( const x509_crt_frame *frame,
+                                  mbedtls_pk_context *pk )
+{
+    unsigned char *p = frame->pk_raw.p;
+
+    return( mbedtls_pk_parse_subpubkey( &p, p + frame->pk_raw.len, pk ) );
+}
+
+/*
+ * Same as x509_crt_check_signature(), not restartable
+ */
+static int x509_crt_frame_check_signature( const x509_crt_frame *child,
+                                           mbedtls_pk_context *pk )
+{
+    const mbedtls_md_info_t *md_info;
+    unsigned char hash[MBEDTLS_MD_MAX_SIZE];
+
+    md_info = mbedtls_md_info_from_type( child->sig_md );
+    if( mbedtls_md( md_info, child->tbs.p, child->tbs.len, hash ) != 0 )
+        return( -1 );
+
+    if( ! mbedtls_pk_can_do( pk, child->sig_pk ) )
+        return( -1 );
+
+    return( mbedtls_pk_verify_ext( child->sig_pk, child->sig_opts, pk,
+                child->sig_md, hash, mbedtls_md_get_size( md_info ),
+                child->sig.p, child->sig.len ) );
+}
+
+/*
+ * Same as x509_crt_check_parent(), plus the pathlen constraint checked by
+ * x509_crt_find_parent_in()
+ */
+static int x509_crt_frame_check_parent( const x509_crt_frame *child,
+                                        const x509_crt_frame *parent,
+                                        int top,
+                                        unsigned path_cnt,
+                                        unsigned self_cnt )
+{
+    int need_ca_bit;
+
+    if( x509_name_cmp_raw( &child->issuer_raw, &parent->subject_raw ) != 0 )
+        return( -1 );
+
+    need_ca_bit = 1;
+
+    if( top && parent->version < 3 )
+        need_ca_bit = 0;
+
+    if( need_ca_bit && ! parent->ca_istrue )
+        return( -1 );
+
+#if defined(MBEDTLS_X509_CHECK_KEY_USAGE)
+    if( need_ca_bit &&
+        ( parent->ext_types & MBEDTLS_X509_EXT_KEY_USAGE ) != 0 &&
+        ( parent->key_usage & MBEDTLS_X509_KU_KEY_CERT_SIGN ) == 0 )
+    {
+        return( -1 );
+    }
+#endif
+
+    if( parent->max_pathlen > 0 &&
+        (size_t) parent->max_pathlen < 1 + path_cnt - self_cnt )
+    {
+        return( -1 );
+    }
+
+    return( 0 );
+}
+
+static int x509_crt_frame_time_is_valid( const x509_crt_frame *frame )
+{
+    return( ! mbedtls_x509_time_is_past( &frame->valid_to ) &&
+            ! mbedtls_x509_time_is_future( &frame->valid_from ) );
+}
+
+/*
+ * Find a parent for child in trust_ca, see x509_crt_find_parent_in() with
+ * top == 1 for the selection rules
+ */
+static mbedtls_x509_crt *x509_crt_frame_find_trusted_parent(
+                        const x509_crt_frame *child,
+                        mbedtls_x509_crt *trust_ca,
+                        unsigned path_cnt,
+                        unsigned self_cnt )
+{
+    mbedtls_x509_crt *ca, *fallback_ca = NULL;
+    x509_crt_frame parent;
+
+    for( ca = trust_ca; ca != NULL; ca = ca->next )
+    {
+        x509_crt_frame_from_crt( &parent, ca );
+
+        if( x509_crt_frame_check_parent( child, &parent, 1,
+                                         path_cnt, self_cnt ) != 0 )
+            continue;
+
+        if( x509_crt_frame_check_signature( child, &ca->pk ) != 0 )
+            continue;
+
+        if( x509_crt_frame_time_is_valid( &parent ) )
+            return( ca );
+
+        if( fallback_ca == NULL )
+            fallback_ca = ca;
+    }
+
+    return( fallback_ca );
+}
+
+/*
+ * Find a parent for child among the certificates in [p, end), see
+ * x509_crt_find_parent_in() with top == 0 for the selection rules.
+ *
+ * Candidates are decoded one after the other into parent, and their key into
+ * pk. On return, parent->raw.p is NULL if no parent was found; otherwise
+ * parent and pk hold the parent and its key, and *next points after it.
+ */
+static int x509_crt_frame_find_parent_in_chain(
+                        const x509_crt_frame *child,
+                        unsigned char *p,
+                        const unsigned char *end,
+                        x509_crt_frame *parent,
+                        mbedtls_pk_context *pk,
+                        unsigned char **next,
+                        int *signature_is_good,
+                        unsigned path_cnt,
+                        unsigned self_cnt )
+{
+    int ret;
+    unsigned char *cur;
+    unsigned char *fallback = NULL;
+    int fallback_signature_is_good = 0;
+
+    while( p < end )
+    {
+        cur = p;
+
+        if( ( ret = x509_crt_frame_parse( parent, &p, end ) ) != 0 )
+            return( ret );
+
+        if( x509_crt_frame_check_parent( child, parent, 0,
+                                         path_cnt, self_cnt ) == 0 )
+        {
+            if( ( ret = x509_crt_frame_get_pk( parent, pk ) ) != 0 )
+            {
+                x509_crt_frame_free( parent );
+                return( ret );
+            }
+
+            *signature_is_good =
+                x509_crt_frame_check_signature( child, pk ) == 0;
+
+            if( x509_crt_frame_time_is_valid( parent ) )
+            {
+                *next = p;
+                return( 0 );
+            }
+
+            if( fallback == NULL )
+            {
+                fallback = cur;
+                fallback_signature_is_good = *signature_is_good;
+            }
+
+            mbedtls_pk_free( pk );
+            mbedtls_pk_init( pk );
+        }
+
+        x509_crt_frame_free( parent );
+    }
+
+    if( fallback == NULL )
+        return( 0 );
+
+    /* Already parsed once, so this can't fail except for the key */
+    p = fallback;
+    if( ( ret = x509_crt_frame_parse( parent, &p, end ) ) != 0 )
+        return( ret );
+
+    if( ( ret = x509_crt_frame_get_pk( parent, pk ) ) != 0 )
+    {
+        x509_crt_frame_free( parent );
+        return( ret );
+    }
+
+    *signature_is_good = fallback_signature_is_good;
+    *next = p;
+
+    return( 0 );
+}
+
+/*
+ * Same as x509_crt_verify_name(), reading the names in place
+ */
+static void x509_crt_frame_verify_name( const x509_crt_frame *frame,
+                                        const char *cn,
+                                        uint32_t *flags )
+{
+    unsigned char *p, *end_set;
+    const unsigned char *end;
+    unsigned char tag;
+    mbedtls_x509_buf san;
+    mbedtls_x509_name name;
+    size_t cn_len = strlen( cn );
+
+    if( frame->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
+    {
+        /* already validated by x509_crt_frame_get_san() */
+        p = frame->san_raw.p;
+        end = p + frame->san_raw.len;
+
+        while( p < end )
+        {
+            tag = *p++;
+            if( mbedtls_asn1_get_len( &p, end, &san.len ) != 0 )
+                break;
+
+            san.p = p;
+            p += san.len;
+
+            if( tag == ( MBEDTLS_ASN1_CONTEXT_SPECIFIC | 2 ) &&
+                x509_crt_check_cn( &san, cn, cn_len ) == 0 )
+            {
+                return;
+            }
+        }
+    }
+    else if( x509_name_raw_open( &frame->subject_raw, &p, &end ) == 0 )
+    {
+        end_set = p;
+
+        while( x509_name_raw_next( &p, end, &end_set, &name ) == 0 &&
+               name.oid.p != NULL )
+        {
+            if( MBEDTLS_OID_CMP( MBEDTLS_OID_AT_CN, &name.oid ) == 0 &&
+                x509_crt_check_cn( &name.val, cn, cn_len ) == 0 )
+            {
+                return;
+            }
+        }
+    }
+
+    *flags |= MBEDTLS_X509_BADCERT_CN_MISMATCH;
+}
+
+/*
+ * Same as x509_crt_check_ee_locally_trusted()
+ */
+static int x509_crt_frame_check_ee_locally_trusted(
+                    const x509_crt_frame *frame,
+                    mbedtls_x509_crt *trust_ca )
+{
+    mbedtls_x509_crt *cur;
+
+    if( x509_name_cmp_raw( &frame->issuer_raw, &frame->subject_raw ) != 0 )
+        return( -1 );
+
+    for( cur = trust_ca; cur != NULL; cur = cur->next )
+    {
+        if( frame->raw.len == cur->raw.len &&
+            memcmp( frame->raw.p, cur->raw.p, frame->raw.len ) == 0 )
+        {
+            return( 0 );
+        }
+    }
+
+    return( -1 );
+}
+
+/*
+ * Verify a chain of DER certificates in place.
+ *
+ * This follows x509_crt_verify_chain(), but only two links are decoded at any
+ * time (child and parent, swapped when going up the chain) and flags are
+ * accumulated on the way as there is no verification callback.
+ */
+int mbedtls_x509_crt_verify_stream( const unsigned char *chain,
+                     size_t chain_len,
+                     mbedtls_x509_crt *trust_ca,
+                     const mbedtls_x509_crt_profile *profile,
+                     const char *cn, uint32_t *flags )
+{
+    int ret;
+    unsigned char *p, *next;
+    const unsigned char *end;
+    x509_crt_frame frames[2];
+    x509_crt_frame *child, *parent, *tmp;
+    mbedtls_pk_context pk;
+    mbedtls_x509_crt *ca;
+    uint32_t cur_flags;
+    int signature_is_good;
+    unsigned path_cnt, self_cnt;
+
+    *flags = 0;
+    x509_crt_frame_init( &frames[0] );
+    x509_crt_frame_init( &frames[1] );
+    mbedtls_pk_init( &pk );
+
+    if( chain == NULL || profile == NULL )
+    {
+        ret = MBEDTLS_ERR_X509_BAD_INPUT_DATA;
+        goto exit;
+    }
+
+    p = (unsigned char *) chain;
+    end = chain + chain_len;
+    child = &frames[0];
+    parent = &frames[1];
+
+    if( ( ret = x509_crt_frame_parse( child, &p, end ) ) != 0 )
+        goto exit;
+
+    cur_flags = 0;
+
+    /* check name if requested */
+    if( cn != NULL )
+        x509_crt_frame_verify_name( child, cn, &cur_flags );
+
+    /* Check the type and size of the key */
+    if( ( ret = x509_crt_frame_get_pk( child, &pk ) ) != 0 )
+        goto exit;
+
+    if( x509_profile_check_pk_alg( profile, mbedtls_pk_get_type( &pk ) ) != 0 )
+        cur_flags |= MBEDTLS_X509_BADCERT_BAD_PK;
+
+    if( x509_profile_check_key( profile, &pk ) != 0 )
+        cur_flags |= MBEDTLS_X509_BADCERT_BAD_KEY;
+
+    mbedtls_pk_free( &pk );
+    mbedtls_pk_init( &pk );
+
+    path_cnt = 0;
+    self_cnt = 0;
+
+    while( 1 )
+    {
+        /* Check time-validity (all certificates) */
+        if( mbedtls_x509_time_is_past( &child->valid_to ) )
+            cur_flags |= MBEDTLS_X509_BADCERT_EXPIRED;
+
+        if( mbedtls_x509_time_is_future( &child->valid_from ) )
+            cur_flags |= MBEDTLS_X509_BADCERT_FUTURE;
+
+        /* Check signature algorithm: MD & PK algs */
+        if( x509_profile_check_md_alg( profile, child->sig_md ) != 0 )
+            cur_flags |= MBEDTLS_X509_BADCERT_BAD_MD;
+
+        if( x509_profile_check_pk_alg( profile, child->sig_pk ) != 0 )
+            cur_flags |= MBEDTLS_X509_BADCERT_BAD_PK;
+
+        /* Special case: EE certs that are locally trusted */
+        if( path_cnt == 0 &&
+            x509_crt_frame_check_ee_locally_trusted( child, trust_ca ) == 0 )
+        {
+            break;
+        }
+
+        /* Look for a parent in trusted CAs, then up the chain */
+        signature_is_good = 1;
+        ca = x509_crt_frame_find_trusted_parent( child, trust_ca,
+                                                 path_cnt, self_cnt );
+        if( ca == NULL )
+        {
+            ret = x509_crt_frame_find_parent_in_chain( child, p, end,
+                        parent, &pk, &next, &signature_is_good,
+                        path_cnt, self_cnt );
+            if( ret != 0 )
+                goto exit;
+
+            /* No parent? We're done here */
+            if( parent->raw.p == NULL )
+            {
+                cur_flags |= MBEDTLS_X509_BADCERT_NOT_TRUSTED;
+                break;
+            }
+        }
+
+        /* Count intermediate self-issued (not necessarily self-signed) certs,
+         * they are excluded from max_pathlen checks */
+        if( path_cnt != 0 &&
+            x509_name_cmp_raw( &child->issuer_raw, &child->subject_raw ) == 0 )
+        {
+            self_cnt++;
+        }
+
+        if( ca == NULL && path_cnt + 1 > MBEDTLS_X509_MAX_INTERMEDIATE_CA )
+        {
+            ret = MBEDTLS_ERR_X509_FATAL_ERROR;
+            goto exit;
+        }
+
+        if( ! signature_is_good )
+            cur_flags |= MBEDTLS_X509_BADCERT_NOT_TRUSTED;
+
+        /* check size of signing key */
+        if( x509_profile_check_key( profile, ca != NULL ? &ca->pk : &pk ) != 0 )
+            cur_flags |= MBEDTLS_X509_BADCERT_BAD_KEY;
+
+        *flags |= cur_flags;
+        cur_flags = 0;
+
+        /* Stop at trusted roots, after checking their time-validity */
+        if( ca != NULL )
+        {
+            if( mbedtls_x509_time_is_past( &ca->valid_to ) )
+                cur_flags |= MBEDTLS_X509_BADCERT_EXPIRED;
+
+            if( mbedtls_x509_time_is_future( &ca->valid_from ) )
+                cur_flags |= MBEDTLS_X509_BADCERT_FUTURE;
+
+            break;
+        }
+
+        /* prepare for next iteration: only the parent is kept */
+        mbedtls_pk_free( &pk );
+        mbedtls_pk_init( &pk );
+        x509_crt_frame_free( child );
+
+        tmp = child;
+        child = parent;
+        parent = tmp;
+        p = next;
+        path_cnt++;
+    }
+
+    *flags |= cur_flags;
+    ret = 0;
+
+exit:
+    x509_crt_frame_free( &frames[0] );
+    x509_crt_frame_free( &frames[1] );
+    mbedtls_pk_free( &pk );
+
+    if( ret != 0 )
+    {
+        *flags = (uint32_t) -1;
+        return( ret );
+    }
+
+    if( *flags != 0 )
+        return( MBEDTLS_ERR_X509_CERT_VERIFY_FAILED );
+
+    return( 0 );
+}
+#endif /* MBEDTLS_X509_STREAM_VERIFY */
+
 /*
  * Initialize a certificate chain
  */
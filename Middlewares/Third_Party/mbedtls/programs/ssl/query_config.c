@@ -1410,6 +1410,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_SSL_TRUNCATED_HMAC_COMPAT */
 
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+    if( strcmp( "MBEDTLS_SSL_ZERO_COPY", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_SSL_ZERO_COPY );
+        return( 0 );
+    }
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+
 #if defined(MBEDTLS_THREADING_ALT)
     if( strcmp( "MBEDTLS_THREADING_ALT", config ) == 0 )
     {
@@ -1474,6 +1482,14 @@ int query_config( const char *config )
     }
 #endif /* MBEDTLS_X509_RSASSA_PSS_SUPPORT */
 
+#if defined(MBEDTLS_X509_STREAM_VERIFY)
+    if( strcmp( "MBEDTLS_X509_STREAM_VERIFY", config ) == 0 )
+    {
+        MACRO_EXPANSION_TO_STR( MBEDTLS_X509_STREAM_VERIFY );
+        return( 0 );
+    }
+#endif /* MBEDTLS_X509_STREAM_VERIFY */
+
 #if defined(MBEDTLS_ZLIB_SUPPORT)
     if( strcmp( "MBEDTLS_ZLIB_SUPPORT", config ) == 0 )
     {
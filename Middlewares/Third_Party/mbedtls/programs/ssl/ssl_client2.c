@@ -115,6 +115,8 @@ int main( void )
 #define DFL_FALLBACK            -1
 #define DFL_EXTENDED_MS         -1
 #define DFL_ETM                 -1
+#define DFL_ZERO_COPY           0
+#define DFL_BENCH_BYTES         0
 
 #define GET_REQUEST "GET %s HTTP/1.0\r\nExtra-header: "
 #define GET_REQUEST_END "\r\n\r\n"
@@ -154,6 +156,14 @@ int main( void )
 #define USAGE_TICKETS ""
 #endif /* MBEDTLS_SSL_SESSION_TICKETS */
 
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+#define USAGE_ZERO_COPY                                     \
+    "    zero_copy=%%d        default: 0 (use mbedtls_ssl_read/write)\n" \
+    "                        1: use the zero-copy read/write API (TLS only)\n"
+#else
+#define USAGE_ZERO_COPY ""
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
 #define USAGE_TRUNC_HMAC                                    \
     "    trunc_hmac=%%d       default: library default\n"
@@ -292,6 +302,10 @@ int main( void )
     "    allow_legacy=%%d     default: (library default: no)\n"   \
     USAGE_RENEGO                                            \
     "    exchanges=%%d        default: 1\n"                 \
+    "    bench_bytes=%%d      default: 0 (disabled)\n"      \
+    "                        If > 0, upload this many bytes as one request\n" \
+    "                        (TLS only) and report the throughput\n"  \
+    USAGE_ZERO_COPY                                         \
     "    reconnect=%%d        default: 0 (disabled)\n"      \
     "    reco_delay=%%d       default: 0 seconds\n"         \
     "    reconnect_hard=%%d   default: 0 (disabled)\n"      \
@@ -387,6 +401,8 @@ struct options
     int dgram_packing;          /* allow/forbid datagram packing            */
     int extended_ms;            /* negotiate extended master secret?        */
     int etm;                    /* negotiate encrypt then mac?              */
+    int zero_copy;              /* use the zero-copy read/write API?        */
+    int bench_bytes;            /* size of the benchmark upload             */
 } opt;
 
 int query_config( const char *config );
@@ -538,9 +554,80 @@ int idle( mbedtls_net_context *fd,
     return( 0 );
 }
 
+/*
+ * Fill one chunk of the benchmark upload; the last chunk ends with "\r\n"
+ * so that the server sees a single terminated request.
+ */
+static void bench_fill( unsigned char *p, size_t n, size_t left )
+{
+    memset( p, 'A', n );
+
+    if( n == left )
+    {
+        if( n >= 2 ) p[n - 2] = '\r';
+        if( n >= 1 ) p[n - 1] = '\n';
+    }
+}
+
+/*
+ * Upload total bytes of application data, generated either in the
+ * application buffer (mbedtls_ssl_write() copies it into the record) or,
+ * with zero_copy=1, directly in the record buffer.
+ */
+static int bench_upload( mbedtls_ssl_context *ssl,
+                         unsigned char *buf, size_t buf_len, size_t total )
+{
+    int ret;
+    size_t n, left = total;
+
+    while( left > 0 )
+    {
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+        if( opt.zero_copy )
+        {
+            unsigned char *rec;
+
+            do ret = mbedtls_ssl_write_get_buf( ssl, &rec, &n );
+            while( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+                   ret == MBEDTLS_ERR_SSL_WANT_WRITE );
+            if( ret != 0 )
+                return( ret );
+
+            if( n > left )
+                n = left;
+            bench_fill( rec, n, left );
+
+            do ret = mbedtls_ssl_write_commit( ssl, n );
+            while( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+                   ret == MBEDTLS_ERR_SSL_WANT_WRITE );
+            if( ret != 0 )
+                return( ret );
+
+            left -= n;
+            continue;
+        }
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+
+        n = ( left < buf_len ) ? left : buf_len;
+        bench_fill( buf, n, left );
+
+        do ret = mbedtls_ssl_write( ssl, buf, n );
+        while( ret == MBEDTLS_ERR_SSL_WANT_READ ||
+               ret == MBEDTLS_ERR_SSL_WANT_WRITE );
+        if( ret < 0 )
+            return( ret );
+
+        /* mbedtls_ssl_write() may have sent less than a full chunk */
+        left -= (size_t) ret;
+    }
+
+    return( 0 );
+}
+
 int main( int argc, char *argv[] )
 {
     int ret = 0, len, tail_len, i, written, frags, retry_left;
+    int bench_pending = 0;
     mbedtls_net_context server_fd;
 
     unsigned char buf[MAX_REQUEST_SIZE + 1];
@@ -569,6 +656,7 @@ int main( int argc, char *argv[] )
     mbedtls_ssl_session saved_session;
 #if defined(MBEDTLS_TIMING_C)
     mbedtls_timing_delay_context timer;
+    struct mbedtls_timing_hr_time bench_timer;
 #endif
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
     uint32_t flags;
@@ -664,6 +752,8 @@ int main( int argc, char *argv[] )
     opt.extended_ms         = DFL_EXTENDED_MS;
     opt.etm                 = DFL_ETM;
     opt.dgram_packing       = DFL_DGRAM_PACKING;
+    opt.zero_copy           = DFL_ZERO_COPY;
+    opt.bench_bytes         = DFL_BENCH_BYTES;
 
     for( i = 1; i < argc; i++ )
     {
@@ -784,6 +874,20 @@ int main( int argc, char *argv[] )
             if( opt.exchanges < 1 )
                 goto usage;
         }
+        else if( strcmp( p, "bench_bytes" ) == 0 )
+        {
+            opt.bench_bytes = atoi( q );
+            if( opt.bench_bytes < 0 )
+                goto usage;
+        }
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+        else if( strcmp( p, "zero_copy" ) == 0 )
+        {
+            opt.zero_copy = atoi( q );
+            if( opt.zero_copy < 0 || opt.zero_copy > 1 )
+                goto usage;
+        }
+#endif
         else if( strcmp( p, "reconnect" ) == 0 )
         {
             opt.reconnect = atoi( q );
@@ -1739,6 +1843,31 @@ int main( int argc, char *argv[] )
      */
     retry_left = opt.max_resend;
 send_request:
+    /*
+     * 6a. Or upload a large benchmark request instead
+     */
+    if( opt.bench_bytes > 0 &&
+        opt.transport == MBEDTLS_SSL_TRANSPORT_STREAM )
+    {
+        mbedtls_printf( "  > Upload %d bytes to server:", opt.bench_bytes );
+        fflush( stdout );
+
+#if defined(MBEDTLS_TIMING_C)
+        (void) mbedtls_timing_get_timer( &bench_timer, 1 );
+#endif
+        ret = bench_upload( &ssl, buf, sizeof( buf ) - 1,
+                            (size_t) opt.bench_bytes );
+        if( ret != 0 )
+        {
+            mbedtls_printf( " failed\n  ! upload returned -0x%x\n\n", -ret );
+            goto exit;
+        }
+
+        mbedtls_printf( " ok\n" );
+        bench_pending = 1;
+        goto read_response;
+    }
+
     mbedtls_printf( "  > Write to server:" );
     fflush( stdout );
 
@@ -1860,6 +1989,7 @@ send_request:
     /*
      * 7. Read the HTTP response
      */
+read_response:
     mbedtls_printf( "  < Read from server:" );
     fflush( stdout );
 
@@ -1872,6 +2002,24 @@ send_request:
         {
             len = sizeof( buf ) - 1;
             memset( buf, 0, sizeof( buf ) );
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+            if( opt.zero_copy )
+            {
+                const unsigned char *rec;
+                size_t rec_len;
+
+                /* Process the record in place, the copy to buf below is
+                 * only there to print it */
+                ret = mbedtls_ssl_read_get_buf( &ssl, &rec, &rec_len );
+                if( ret == 0 )
+                {
+                    ret = (int) ( rec_len < (size_t) len ? rec_len : (size_t) len );
+                    memcpy( buf, rec, ret );
+                    mbedtls_ssl_read_release( &ssl, ret );
+                }
+            }
+            else
+#endif /* MBEDTLS_SSL_ZERO_COPY */
             ret = mbedtls_ssl_read( &ssl, buf, len );
 
 #if defined(MBEDTLS_ECP_RESTARTABLE)
@@ -1986,6 +2134,22 @@ send_request:
         ret = 0;
     }
 
+    if( bench_pending )
+    {
+        bench_pending = 0;
+#if defined(MBEDTLS_TIMING_C)
+        {
+            unsigned long ms = mbedtls_timing_get_timer( &bench_timer, 0 );
+
+            if( ms == 0 )
+                ms = 1;
+            mbedtls_printf( "  . Upload throughput: %lu KiB/s (%d bytes in %lu ms)\n",
+                            (unsigned long) ( opt.bench_bytes / 1024 ) * 1000 / ms,
+                            opt.bench_bytes, ms );
+        }
+#endif /* MBEDTLS_TIMING_C */
+    }
+
     /*
      * 7b. Simulate hard reset and reconnect from same port?
      */
@@ -159,6 +159,7 @@ int main( void )
 #define DFL_DGRAM_PACKING        1
 #define DFL_EXTENDED_MS         -1
 #define DFL_ETM                 -1
+#define DFL_ZERO_COPY           0
 
 #define LONG_RESPONSE "<p>01-blah-blah-blah-blah-blah-blah-blah-blah-blah\r\n" \
     "02-blah-blah-blah-blah-blah-blah-blah-blah-blah-blah-blah-blah-blah\r\n"  \
@@ -274,6 +275,14 @@ int main( void )
 #define USAGE_MAX_FRAG_LEN ""
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
 
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+#define USAGE_ZERO_COPY                                     \
+    "    zero_copy=%%d        default: 0 (use mbedtls_ssl_read)\n" \
+    "                        1: read requests in place (TLS only)\n"
+#else
+#define USAGE_ZERO_COPY ""
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+
 #if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
 #define USAGE_TRUNC_HMAC \
     "    trunc_hmac=%%d       default: library default\n"
@@ -402,6 +411,7 @@ int main( void )
     "    allow_legacy=%%d     default: (library default: no)\n"      \
     USAGE_RENEGO                                            \
     "    exchanges=%%d        default: 1\n"                 \
+    USAGE_ZERO_COPY                                         \
     "\n"                                                    \
     USAGE_TICKETS                                           \
     USAGE_CACHE                                             \
@@ -518,6 +528,7 @@ struct options
     int dtls_mtu;               /* UDP Maximum tranport unit for DTLS       */
     int dgram_packing;          /* allow/forbid datagram packing            */
     int badmac_limit;           /* Limit of records with bad MAC            */
+    int zero_copy;              /* use the zero-copy read API?              */
 } opt;
 
 int query_config( const char *config );
@@ -1407,6 +1418,7 @@ int main( int argc, char *argv[] )
     opt.badmac_limit        = DFL_BADMAC_LIMIT;
     opt.extended_ms         = DFL_EXTENDED_MS;
     opt.etm                 = DFL_ETM;
+    opt.zero_copy           = DFL_ZERO_COPY;
 
     for( i = 1; i < argc; i++ )
     {
@@ -1703,6 +1715,14 @@ int main( int argc, char *argv[] )
                 default: goto usage;
             }
         }
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+        else if( strcmp( p, "zero_copy" ) == 0 )
+        {
+            opt.zero_copy = atoi( q );
+            if( opt.zero_copy < 0 || opt.zero_copy > 1 )
+                goto usage;
+        }
+#endif
         else if( strcmp( p, "etm" ) == 0 )
         {
             switch( atoi( q ) )
@@ -2839,9 +2859,42 @@ data_exchange:
         do
         {
             int terminated = 0;
-            len = opt.buffer_size - 1;
-            memset( buf, 0, opt.buffer_size );
-            ret = mbedtls_ssl_read( &ssl, buf, len );
+#if defined(MBEDTLS_SSL_ZERO_COPY)
+            if( opt.zero_copy )
+            {
+                const unsigned char *rec;
+                size_t rec_len;
+
+                /* The whole record is available in place, so there is no
+                 * need for buf or for a larger buffer */
+                ret = mbedtls_ssl_read_get_buf( &ssl, &rec, &rec_len );
+                if( ret == 0 && rec_len > 0 )
+                {
+                    mbedtls_printf( " %u bytes read\n\n%.*s\n",
+                                    (unsigned) rec_len, (int) rec_len,
+                                    (const char *) rec );
+
+                    /* End of message should be detected according to the
+                     * syntax of the application protocol (eg HTTP), just
+                     * use a dummy test here. */
+                    terminated = ( rec[rec_len - 1] == '\n' );
+                    mbedtls_ssl_read_release( &ssl, rec_len );
+
+                    if( terminated )
+                    {
+                        ret = 0;
+                        break;
+                    }
+                    continue;
+                }
+            }
+            else
+#endif /* MBEDTLS_SSL_ZERO_COPY */
+            {
+                len = opt.buffer_size - 1;
+                memset( buf, 0, opt.buffer_size );
+                ret = mbedtls_ssl_read( &ssl, buf, len );
+            }
 
             if( mbedtls_status_is_ssl_in_progress( ret ) )
             {
@@ -0,0 +1,268 @@
+/*
+ *  Peak heap usage of certificate chain verification
+ *
+ *  Copyright (C) 2006-2019, ARM Limited, All Rights Reserved
+ *  SPDX-License-Identifier: Apache-2.0
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License"); you may
+ *  not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ *  WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  This file is part of mbed TLS (https://tls.mbed.org)
+ */
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_PLATFORM_C)
+#include "mbedtls/platform.h"
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#define mbedtls_printf          printf
+#define mbedtls_exit            exit
+#define MBEDTLS_EXIT_SUCCESS    EXIT_SUCCESS
+#define MBEDTLS_EXIT_FAILURE    EXIT_FAILURE
+#endif /* MBEDTLS_PLATFORM_C */
+
+#if !defined(MBEDTLS_X509_CRT_PARSE_C) || !defined(MBEDTLS_FS_IO) ||     \
+    !defined(MBEDTLS_X509_STREAM_VERIFY) ||                               \
+    !defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) || !defined(MBEDTLS_MEMORY_DEBUG)
+int main( void )
+{
+    mbedtls_printf("MBEDTLS_X509_CRT_PARSE_C and/or MBEDTLS_FS_IO and/or "
+           "MBEDTLS_X509_STREAM_VERIFY and/or MBEDTLS_MEMORY_BUFFER_ALLOC_C "
+           "and/or MBEDTLS_MEMORY_DEBUG not defined.\n");
+    return( 0 );
+}
+#else
+
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/memory_buffer_alloc.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define DFL_CA_FILE             "data_files/test-ca_cat12.crt"
+#define DFL_CHAINS              "data_files/server2.crt,"               \
+                                "data_files/server5.crt,"               \
+                                "data_files/server7_int-ca.crt,"        \
+                                "data_files/server10_int3_int-ca2_ca.crt"
+#define DFL_CN                  NULL
+
+#define HEAP_SIZE               ( 1u << 17 )
+#define MAX_CHAIN_SIZE          16384
+
+/* Same accounting as programs/test/benchmark.c */
+#define MEM_BLOCK_OVERHEAD      ( 2 * sizeof( size_t ) )
+
+#define USAGE \
+    "\n usage: cert_verify_heap param=<>...\n"                          \
+    "\n Prints the peak heap used to verify each chain with\n"         \
+    " mbedtls_x509_crt_verify_with_profile() (including parsing the\n" \
+    " chain) and with mbedtls_x509_crt_verify_stream().\n"              \
+    "\n acceptable parameters:\n"                                       \
+    "    ca_file=%%s          default: " DFL_CA_FILE "\n"              \
+    "    chains=%%s           comma-separated list of files, each\n"   \
+    "                        holding a chain, end-entity first\n"       \
+    "                        default: the chains in data_files/\n"      \
+    "    cn=%%s               default: none\n"                          \
+    "\n"
+
+#if defined(MBEDTLS_CHECK_PARAMS)
+#define mbedtls_exit            exit
+void mbedtls_param_failed( const char *failure_condition,
+                           const char *file,
+                           int line )
+{
+    mbedtls_printf( "%s:%i: Input param failed - %s\n",
+                    file, line, failure_condition );
+    mbedtls_exit( MBEDTLS_EXIT_FAILURE );
+}
+#endif
+
+/*
+ * global options
+ */
+struct options
+{
+    const char *ca_file;        /* the trusted CAs                      */
+    char *chains;               /* the chains to verify                 */
+    const char *cn;             /* expected CN, if any                  */
+} opt;
+
+static size_t prv_used, prv_blocks;
+
+static void heap_measure_start( void )
+{
+    mbedtls_memory_buffer_alloc_cur_get( &prv_used, &prv_blocks );
+    mbedtls_memory_buffer_alloc_max_reset( );
+}
+
+static size_t heap_measure_peak( void )
+{
+    size_t max_used, max_blocks;
+
+    mbedtls_memory_buffer_alloc_max_get( &max_used, &max_blocks );
+
+    return( max_used - prv_used +
+            MEM_BLOCK_OVERHEAD * ( max_blocks - prv_blocks ) );
+}
+
+int main( int argc, char *argv[] )
+{
+    int ret = 1;
+    int exit_code = MBEDTLS_EXIT_FAILURE;
+    unsigned char alloc_buf[HEAP_SIZE];
+    static unsigned char der[MAX_CHAIN_SIZE];
+    char dfl_chains[] = DFL_CHAINS;
+    size_t der_len, classic_peak, stream_peak;
+    mbedtls_x509_crt cacert, chain;
+    const mbedtls_x509_crt *cur;
+    uint32_t classic_flags, stream_flags;
+    int classic_ret, stream_ret, n;
+    int i;
+    char *p, *q, *file;
+
+    mbedtls_memory_buffer_alloc_init( alloc_buf, sizeof( alloc_buf ) );
+
+    /*
+     * Set to sane values
+     */
+    mbedtls_x509_crt_init( &cacert );
+    mbedtls_x509_crt_init( &chain );
+
+    opt.ca_file             = DFL_CA_FILE;
+    opt.chains              = dfl_chains;
+    opt.cn                  = DFL_CN;
+
+    for( i = 1; i < argc; i++ )
+    {
+        p = argv[i];
+        if( ( q = strchr( p, '=' ) ) == NULL )
+        {
+        usage:
+            mbedtls_printf( USAGE );
+            goto exit;
+        }
+        *q++ = '\0';
+
+        if( strcmp( p, "ca_file" ) == 0 )
+            opt.ca_file = q;
+        else if( strcmp( p, "chains" ) == 0 )
+            opt.chains = q;
+        else if( strcmp( p, "cn" ) == 0 )
+            opt.cn = q;
+        else
+            goto usage;
+    }
+
+    /*
+     * 1. Load the trusted CAs (not counted)
+     */
+    mbedtls_printf( "\n  . Loading the CA root certificate ..." );
+    fflush( stdout );
+
+    if( ( ret = mbedtls_x509_crt_parse_file( &cacert, opt.ca_file ) ) != 0 )
+    {
+        mbedtls_printf( " failed\n  !  mbedtls_x509_crt_parse_file returned -0x%x\n\n", -ret );
+        goto exit;
+    }
+
+    mbedtls_printf( " ok\n\n" );
+    mbedtls_printf( "  %-42s %5s %10s %10s %12s %12s\n", "chain", "certs",
+                    "flags", "flags", "heap bytes", "heap bytes" );
+    mbedtls_printf( "  %-42s %5s %10s %10s %12s %12s\n", "", "",
+                    "(classic)", "(stream)", "(classic)", "(stream)" );
+
+    /*
+     * 2. For each chain: parse and verify, then verify in place
+     */
+    for( file = strtok( opt.chains, "," ); file != NULL;
+         file = strtok( NULL, "," ) )
+    {
+        heap_measure_start();
+
+        if( ( ret = mbedtls_x509_crt_parse_file( &chain, file ) ) != 0 )
+        {
+            mbedtls_printf( "  ! mbedtls_x509_crt_parse_file( %s ) returned -0x%x\n",
+                            file, -ret );
+            goto exit;
+        }
+
+        classic_ret = mbedtls_x509_crt_verify_with_profile( &chain, &cacert,
+                          NULL, &mbedtls_x509_crt_profile_default, opt.cn,
+                          &classic_flags, NULL, NULL );
+
+        classic_peak = heap_measure_peak();
+
+        /* The DER input of the streaming verification lives outside the
+         * heap, as it would in a received handshake message */
+        der_len = 0;
+        n = 0;
+        for( cur = &chain; cur != NULL; cur = cur->next )
+        {
+            if( cur->raw.len > sizeof( der ) - der_len )
+            {
+                mbedtls_printf( "  ! %s: chain too large\n", file );
+                goto exit;
+            }
+
+            memcpy( der + der_len, cur->raw.p, cur->raw.len );
+            der_len += cur->raw.len;
+            n++;
+        }
+
+        mbedtls_x509_crt_free( &chain );
+        mbedtls_x509_crt_init( &chain );
+
+        heap_measure_start();
+
+        stream_ret = mbedtls_x509_crt_verify_stream( der, der_len, &cacert,
+                         &mbedtls_x509_crt_profile_default, opt.cn,
+                         &stream_flags );
+
+        stream_peak = heap_measure_peak();
+
+        mbedtls_printf( "  %-42s %5d %10x %10x %12u %12u\n", file, n,
+                        (unsigned) classic_flags, (unsigned) stream_flags,
+                        (unsigned) classic_peak, (unsigned) stream_peak );
+
+        if( classic_ret != stream_ret || classic_flags != stream_flags )
+        {
+            mbedtls_printf( "  ! %s: results differ (-0x%x, -0x%x)\n", file,
+                            -classic_ret, -stream_ret );
+            goto exit;
+        }
+    }
+
+    mbedtls_printf( "\n" );
+
+    exit_code = MBEDTLS_EXIT_SUCCESS;
+
+exit:
+    mbedtls_x509_crt_free( &chain );
+    mbedtls_x509_crt_free( &cacert );
+    mbedtls_memory_buffer_alloc_free();
+
+#if defined(_WIN32)
+    mbedtls_printf( "  + Press Enter to exit this program.\n" );
+    fflush( stdout ); getchar();
+#endif
+
+    return( exit_code );
+}
+#endif /* MBEDTLS_X509_CRT_PARSE_C && MBEDTLS_FS_IO &&
+          MBEDTLS_X509_STREAM_VERIFY && MBEDTLS_MEMORY_BUFFER_ALLOC_C &&
+          MBEDTLS_MEMORY_DEBUG */
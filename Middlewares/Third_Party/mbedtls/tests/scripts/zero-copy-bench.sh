@@ -0,0 +1,82 @@
+#!/bin/sh
+
+# zero-copy-bench.sh
+#
+# This file is part of mbed TLS (https://tls.mbed.org)
+#
+# Purpose
+#
+# Loopback throughput benchmark of the application data path, comparing
+# mbedtls_ssl_write()/mbedtls_ssl_read() with the zero-copy API
+# (MBEDTLS_SSL_ZERO_COPY) between programs/ssl/ssl_client2 and
+# programs/ssl/ssl_server2.
+#
+# The client uploads BENCH_BYTES of application data as a single request and
+# reports the throughput; the server output is discarded so that printing the
+# request does not dominate the measurement.
+#
+# Usage: tests/scripts/zero-copy-bench.sh [ciphersuite...]
+#
+# Environment: BENCH_BYTES (default 16 MiB), ROUNDS (default 3),
+#              SRV_PORT (default 4433)
+
+set -eu
+
+if [ -d library -a -d include -a -d tests ]; then :; else
+    echo "Must be run from mbed TLS root" >&2
+    exit 1
+fi
+
+: ${BENCH_BYTES:=16777216}
+: ${ROUNDS:=3}
+: ${SRV_PORT:=4433}
+
+P_SRV=programs/ssl/ssl_server2
+P_CLI=programs/ssl/ssl_client2
+
+if [ ! -x "$P_SRV" -o ! -x "$P_CLI" ]; then
+    echo "Build $P_SRV and $P_CLI first" >&2
+    exit 1
+fi
+
+if ! $P_CLI query_config=MBEDTLS_SSL_ZERO_COPY >/dev/null; then
+    echo "MBEDTLS_SSL_ZERO_COPY is not enabled in the configuration" >&2
+    exit 1
+fi
+
+if [ $# -eq 0 ]; then
+    set -- TLS-RSA-WITH-AES-128-GCM-SHA256 \
+           TLS-RSA-WITH-AES-128-CBC-SHA256 \
+           TLS-ECDHE-RSA-WITH-CHACHA20-POLY1305-SHA256
+fi
+
+# run_one <ciphersuite> <zero_copy>: print the throughput in KiB/s
+run_one() {
+    $P_SRV server_port=$SRV_PORT buffer_size=16385 zero_copy=$2 \
+        force_ciphersuite=$1 >/dev/null 2>&1 &
+    SRV_PID=$!
+    sleep 1
+
+    OUT=$( $P_CLI server_port=$SRV_PORT bench_bytes=$BENCH_BYTES \
+               zero_copy=$2 force_ciphersuite=$1 auth_mode=none 2>&1 ) || true
+
+    kill $SRV_PID 2>/dev/null || true
+    wait $SRV_PID 2>/dev/null || true
+
+    echo "$OUT" | sed -n 's/.*Upload throughput: \([0-9]*\) KiB\/s.*/\1/p'
+}
+
+printf "%-45s %12s %12s\n" "ciphersuite" "copy KiB/s" "zc KiB/s"
+for CS in "$@"; do
+    BEST_COPY=0
+    BEST_ZC=0
+    i=0
+    while [ $i -lt $ROUNDS ]; do
+        T=$( run_one $CS 0 )
+        [ -n "$T" ] && [ "$T" -gt $BEST_COPY ] && BEST_COPY=$T
+        T=$( run_one $CS 1 )
+        [ -n "$T" ] && [ "$T" -gt $BEST_ZC ] && BEST_ZC=$T
+        i=$(( i + 1 ))
+    done
+    printf "%-45s %12s %12s\n" $CS $BEST_COPY $BEST_ZC
+done
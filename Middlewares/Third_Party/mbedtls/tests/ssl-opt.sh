@@ -1480,6 +1480,57 @@ run_test    "CBC Record splitting: TLS 1.0, splitting, nbio" \
             -s "Read from client: 1 bytes read" \
             -s "122 bytes read"
 
+# Tests for the zero-copy read/write API
+
+requires_config_enabled MBEDTLS_SSL_ZERO_COPY
+run_test    "Zero-copy: server reads in place" \
+            "$P_SRV zero_copy=1" \
+            "$P_CLI request_size=123" \
+            0 \
+            -s "Read from client: 123 bytes read" \
+            -c "Read from server: .* bytes read"
+
+requires_config_enabled MBEDTLS_SSL_ZERO_COPY
+run_test    "Zero-copy: client reads in place" \
+            "$P_SRV response_size=1000" \
+            "$P_CLI zero_copy=1" \
+            0 \
+            -c "Read from server: 1000 bytes read"
+
+requires_config_enabled MBEDTLS_SSL_ZERO_COPY
+run_test    "Zero-copy: multi-record upload written in place" \
+            "$P_SRV zero_copy=1" \
+            "$P_CLI zero_copy=1 bench_bytes=100000" \
+            0 \
+            -s "Read from client: 16384 bytes read" \
+            -c "Upload 100000 bytes to server: ok" \
+            -c "Upload throughput"
+
+requires_config_enabled MBEDTLS_SSL_ZERO_COPY
+run_test    "Zero-copy: multi-record upload written in place, nbio" \
+            "$P_SRV nbio=2 zero_copy=1" \
+            "$P_CLI nbio=2 zero_copy=1 bench_bytes=100000" \
+            0 \
+            -c "Upload 100000 bytes to server: ok"
+
+requires_config_enabled MBEDTLS_SSL_ZERO_COPY
+requires_config_enabled MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+run_test    "Zero-copy: upload honours max_frag_len" \
+            "$P_SRV zero_copy=1" \
+            "$P_CLI zero_copy=1 max_frag_len=1024 bench_bytes=5000" \
+            0 \
+            -s "Read from client: 1024 bytes read" \
+            -S "Read from client: 1025 bytes read"
+
+requires_config_enabled MBEDTLS_SSL_ZERO_COPY
+requires_config_enabled MBEDTLS_SSL_CBC_RECORD_SPLITTING
+run_test    "Zero-copy: refused with CBC record splitting" \
+            "$P_SRV" \
+            "$P_CLI zero_copy=1 bench_bytes=1000 force_version=tls1 \
+             force_ciphersuite=TLS-RSA-WITH-AES-128-CBC-SHA" \
+            1 \
+            -c "upload returned -0x7080"
+
 # Tests for Session Tickets
 
 run_test    "Session resume using tickets: basic" \
@@ -63,9 +63,43 @@
 
 MCUBOOT_LOG_MODULE_DECLARE(mcuboot);
 
+/*
+ * Largest frame accepted, once decoded, and the number of such frames the
+ * transport queues: a host may send that many upload requests before waiting
+ * for the response to the first one.  Both are reported by the MCUmgr
+ * parameters command, for the host to size its chunks and window.
+ */
+#ifdef CONFIG_BOOT_SERIAL_MAX_RECEIVE_SIZE
+#define BOOT_SERIAL_INPUT_MAX   CONFIG_BOOT_SERIAL_MAX_RECEIVE_SIZE
+#else
 #define BOOT_SERIAL_INPUT_MAX   512
+#endif
+#ifdef CONFIG_BOOT_LINE_BUFS
+/*
+ * The transport queues lines of input.  A line holds, after its two start
+ * bytes and before its newline, a whole number of base64 quanta of a frame,
+ * so a frame of the largest size fills BOOT_SERIAL_FRAME_LINES of them.
+ */
+#define BOOT_SERIAL_LINE_ENC_LEN \
+    (((CONFIG_BOOT_MAX_LINE_INPUT_LEN - 3) / 4) * 4)
+#define BOOT_SERIAL_FRAME_ENC_LEN \
+    (((BOOT_SERIAL_INPUT_MAX + 2) / 3) * 4)
+#define BOOT_SERIAL_FRAME_LINES \
+    ((BOOT_SERIAL_FRAME_ENC_LEN + BOOT_SERIAL_LINE_ENC_LEN - 1) / \
+     BOOT_SERIAL_LINE_ENC_LEN)
+#if CONFIG_BOOT_LINE_BUFS >= BOOT_SERIAL_FRAME_LINES
+#define BOOT_SERIAL_IN_FRAMES   (CONFIG_BOOT_LINE_BUFS / BOOT_SERIAL_FRAME_LINES)
+#else
+#define BOOT_SERIAL_IN_FRAMES   1
+#endif
+#else
+#define BOOT_SERIAL_IN_FRAMES   1
+#endif
 #define BOOT_SERIAL_OUT_MAX     128
 
+/* Flash write alignments above this are not supported. */
+#define BOOT_SERIAL_ALIGN_MAX   32
+
 #ifdef __ZEPHYR__
 /* base64 lib encodes data to null-terminated string */
 #define BASE64_ENCODE_SIZE(in_size) ((((((in_size) - 1) / 3) * 4) + 4) + 1)
@@ -92,6 +126,12 @@ static char dec_buf[BOOT_SERIAL_INPUT_MAX + 1];
 const struct boot_uart_funcs *boot_uf;
 static uint32_t curr_off;
 static uint32_t img_size;
+/*
+ * Bytes of the image received but not written yet, as the chunks need not
+ * end on the write alignment: they are written with the next chunk.
+ */
+static uint8_t tail_buf[BOOT_SERIAL_ALIGN_MAX];
+static uint32_t tail_len;
 static struct nmgr_hdr *bs_hdr;
 
 static char bs_obuf[BOOT_SERIAL_OUT_MAX];
@@ -230,7 +270,9 @@ bs_upload(char *buf, int len)
     const uint8_t *img_data = NULL;
     long long int off = UINT_MAX;
     size_t img_blen = 0;
-    uint8_t rem_bytes;
+    uint32_t align;
+    uint32_t wr_off;
+    uint32_t wr_len;
     long long int data_len = UINT_MAX;
     int img_num;
     size_t slen;
@@ -295,8 +337,15 @@ bs_upload(char *buf, int len)
         goto out;
     }
 
+    align = flash_area_align(fap);
+    if (align > sizeof(tail_buf)) {
+        rc = MGMT_ERR_EINVAL;
+        goto out;
+    }
+
     if (off == 0) {
         curr_off = 0;
+        tail_len = 0;
         if (data_len > fap->fa_size) {
             goto out_invalid_data;
         }
@@ -312,11 +361,8 @@ bs_upload(char *buf, int len)
         rc = 0;
         goto out;
     }
-    if (curr_off + img_blen < img_size) {
-        rem_bytes = img_blen % flash_area_align(fap);
-        if (rem_bytes) {
-            img_blen -= rem_bytes;
-        }
+    if (curr_off + img_blen > img_size) {
+        goto out_invalid_data;
     }
 
 #ifdef CONFIG_BOOT_ERASE_PROGRESSIVELY
@@ -336,10 +382,46 @@ bs_upload(char *buf, int len)
     }
 #endif
 
-    BOOT_LOG_INF("Writing at 0x%x until 0x%x", curr_off, curr_off + img_blen);
-    rc = flash_area_write(fap, curr_off, img_data, img_blen);
-    if (rc == 0) {
+    /*
+     * Complete the bytes left from the previous chunk to a write alignment,
+     * then write the rest of the chunk from the request itself, keeping the
+     * bytes past its last alignment for the next chunk.
+     */
+    wr_off = curr_off - tail_len;
+    rc = 0;
+    if (tail_len > 0) {
+        wr_len = align - tail_len;
+        if (wr_len > img_blen) {
+            wr_len = img_blen;
+        }
+        memcpy(&tail_buf[tail_len], img_data, wr_len);
+        tail_len += wr_len;
+        img_data += wr_len;
+        img_blen -= wr_len;
+        curr_off += wr_len;
+        if (tail_len == align || curr_off == img_size) {
+            rc = flash_area_write(fap, wr_off, tail_buf, tail_len);
+            wr_off += tail_len;
+            tail_len = 0;
+        }
+    }
+    if (rc == 0 && img_blen > 0) {
+        wr_len = img_blen;
+        if (curr_off + img_blen < img_size) {
+            wr_len -= img_blen % align;
+        }
+        BOOT_LOG_DBG("Writing at 0x%x until 0x%x", wr_off, wr_off + wr_len);
+        rc = flash_area_write(fap, wr_off, img_data, wr_len);
+        memcpy(tail_buf, img_data + wr_len, img_blen - wr_len);
+        tail_len = img_blen - wr_len;
         curr_off += img_blen;
+    }
+    if (rc != 0) {
+        /* Part of the image was not written: the upload must start over. */
+        curr_off = 0;
+        tail_len = 0;
+    }
+    if (rc == 0) {
 #ifdef CONFIG_BOOT_ERASE_PROGRESSIVELY
         if (curr_off == img_size) {
             /* get the last sector offset */
@@ -367,7 +449,7 @@ bs_upload(char *buf, int len)
     }
 
 out:
-    BOOT_LOG_INF("RX: 0x%x", rc);
+    BOOT_LOG_DBG("RX: 0x%x", rc);
     cbor_encoder_create_map(&bs_root, &bs_rsp, CborIndefiniteLength);
     cbor_encode_text_stringz(&bs_rsp, "rc");
     cbor_encode_int(&bs_rsp, rc);
@@ -394,6 +476,22 @@ bs_empty_rsp(char *buf, int len)
     boot_serial_output();
 }
 
+/*
+ * MCUmgr parameters: the largest frame accepted and the number queued, for
+ * the host to pipeline its upload requests.
+ */
+static void
+bs_params(char *buf, int len)
+{
+    cbor_encoder_create_map(&bs_root, &bs_rsp, CborIndefiniteLength);
+    cbor_encode_text_stringz(&bs_rsp, "buf_size");
+    cbor_encode_uint(&bs_rsp, BOOT_SERIAL_INPUT_MAX);
+    cbor_encode_text_stringz(&bs_rsp, "buf_count");
+    cbor_encode_uint(&bs_rsp, BOOT_SERIAL_IN_FRAMES);
+    cbor_encoder_close_container(&bs_root, &bs_rsp);
+    boot_serial_output();
+}
+
 /*
  * Reset, and (presumably) boot to newly uploaded image. Flush console
  * before restarting.
@@ -459,6 +557,9 @@ boot_serial_input(char *buf, int len)
         case NMGR_ID_RESET:
             bs_reset(buf, len);
             break;
+        case NMGR_ID_PARAMS:
+            bs_params(buf, len);
+            break;
         default:
             break;
         }
@@ -516,7 +617,7 @@ boot_serial_output(void)
 #endif
     boot_uf->write(encoded_buf, totlen);
     boot_uf->write("\n\r", 2);
-    BOOT_LOG_INF("TX");
+    BOOT_LOG_DBG("TX");
 }
 
 /*
@@ -609,10 +710,12 @@ boot_serial_start(const struct boot_uart_funcs *f)
         if (in_buf[0] == SHELL_NLIP_PKT_START1 &&
           in_buf[1] == SHELL_NLIP_PKT_START2) {
             dec_off = 0;
-            rc = boot_serial_in_dec(&in_buf[2], off - 2, dec_buf, &dec_off, max_input);
+            rc = boot_serial_in_dec(&in_buf[2], off - 2, dec_buf, &dec_off,
+                                    sizeof(dec_buf));
         } else if (in_buf[0] == SHELL_NLIP_DATA_START1 &&
           in_buf[1] == SHELL_NLIP_DATA_START2) {
-            rc = boot_serial_in_dec(&in_buf[2], off - 2, dec_buf, &dec_off, max_input);
+            rc = boot_serial_in_dec(&in_buf[2], off - 2, dec_buf, &dec_off,
+                                    sizeof(dec_buf));
         }
 
         /* serve errors: out of decode memory, or bad encoding */
@@ -0,0 +1,413 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Host port of boot_serial, for measuring serial recovery uploads from a
+ * host over a pty (see upload.py).  The UART is stdin and stdout, the
+ * primary slot a RAM flash with the write alignment and program time of
+ * STM32L5 internal flash: double-words of 8 bytes, programmed once between
+ * erases, taking PROG_NS nanoseconds each.  The reset command writes the
+ * slot to the file named by OUT and exits.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "base64/base64.h"
+#include "crc/crc16.h"
+#include "flash_map_backend/flash_map_backend.h"
+#include "hal/hal_system.h"
+#include "os/os_cputime.h"
+#include "sysflash/sysflash.h"
+#include "tinycbor/cbor.h"
+#include "bootutil/image.h"
+#include "boot_serial/boot_serial.h"
+
+#define HOST_SLOT_SIZE          (512 * 1024)
+#define HOST_FLASH_ALIGN        8
+#define HOST_PROG_NS            82000
+
+static uint8_t host_slot[HOST_SLOT_SIZE];
+static uint8_t host_programmed[HOST_SLOT_SIZE / HOST_FLASH_ALIGN];
+static long host_prog_ns = HOST_PROG_NS;
+static long host_erase_ns;
+
+static const struct flash_area host_fa = {
+    .fa_id = FLASH_AREA_IMAGE_PRIMARY(0),
+    .fa_size = HOST_SLOT_SIZE,
+};
+
+static void
+host_delay(long ns)
+{
+    struct timespec ts = { ns / 1000000000, ns % 1000000000 };
+
+    if (ns > 0) {
+        nanosleep(&ts, NULL);
+    }
+}
+
+/* Flash */
+
+int
+flash_area_open(uint8_t id, const struct flash_area **fap)
+{
+    if (id != host_fa.fa_id) {
+        return -1;
+    }
+    *fap = &host_fa;
+    return 0;
+}
+
+void
+flash_area_close(const struct flash_area *fap)
+{
+}
+
+int
+flash_area_read(const struct flash_area *fap, uint32_t off, void *dst,
+                uint32_t len)
+{
+    if (off + len > HOST_SLOT_SIZE) {
+        return -1;
+    }
+    memcpy(dst, &host_slot[off], len);
+    return 0;
+}
+
+int
+flash_area_write(const struct flash_area *fap, uint32_t off, const void *src,
+                 uint32_t len)
+{
+    uint32_t dw;
+
+    if (off % HOST_FLASH_ALIGN != 0 || off + len > HOST_SLOT_SIZE) {
+        fprintf(stderr, "unaligned write of %u at 0x%x\n", len, off);
+        abort();
+    }
+    for (dw = off / HOST_FLASH_ALIGN;
+         dw < (off + len + HOST_FLASH_ALIGN - 1) / HOST_FLASH_ALIGN; dw++) {
+        if (host_programmed[dw]) {
+            fprintf(stderr, "double-word at 0x%x programmed twice\n",
+                    dw * HOST_FLASH_ALIGN);
+            abort();
+        }
+        host_programmed[dw] = 1;
+    }
+    memcpy(&host_slot[off], src, len);
+    host_delay(host_prog_ns *
+               ((len + HOST_FLASH_ALIGN - 1) / HOST_FLASH_ALIGN));
+    return 0;
+}
+
+int
+flash_area_erase(const struct flash_area *fap, uint32_t off, uint32_t len)
+{
+    if (off + len > HOST_SLOT_SIZE) {
+        return -1;
+    }
+    memset(&host_slot[off], 0xff, len);
+    memset(&host_programmed[off / HOST_FLASH_ALIGN], 0,
+           len / HOST_FLASH_ALIGN);
+    host_delay(host_erase_ns * (len / 4096));
+    return 0;
+}
+
+uint8_t
+flash_area_align(const struct flash_area *fap)
+{
+    return HOST_FLASH_ALIGN;
+}
+
+uint8_t
+flash_area_erased_val(const struct flash_area *fap)
+{
+    return 0xff;
+}
+
+int
+flash_area_id_from_multi_image_slot(int image_index, int slot)
+{
+    return slot == 0 ? FLASH_AREA_IMAGE_PRIMARY(image_index) :
+                       FLASH_AREA_IMAGE_SECONDARY(image_index);
+}
+
+/* The image state command is not measured. */
+int
+bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
+                      struct image_header *hdr, const struct flash_area *fap,
+                      uint8_t *tmp_buf, uint32_t tmp_buf_sz,
+                      uint8_t *seed, int seed_len, uint8_t *out_hash)
+{
+    return -1;
+}
+
+/* System */
+
+void
+hal_system_reset(void)
+{
+    const char *path = getenv("OUT");
+    FILE *f;
+
+    if (path != NULL) {
+        f = fopen(path, "wb");
+        if (f != NULL) {
+            fwrite(host_slot, 1, sizeof(host_slot), f);
+            fclose(f);
+        }
+    }
+    exit(0);
+}
+
+void
+os_cputime_delay_usecs(uint32_t usecs)
+{
+}
+
+/* CBOR encoder, of what the responses use */
+
+static int
+host_cbor_head(CborEncoder *encoder, int major, uint64_t value)
+{
+    char buf[5];
+    int len;
+
+    if (value < 24) {
+        buf[0] = major << 5 | value;
+        len = 1;
+    } else if (value < 0x100) {
+        buf[0] = major << 5 | 24;
+        buf[1] = value;
+        len = 2;
+    } else if (value < 0x10000) {
+        buf[0] = major << 5 | 25;
+        buf[1] = value >> 8;
+        buf[2] = value;
+        len = 3;
+    } else {
+        buf[0] = major << 5 | 26;
+        buf[1] = value >> 24;
+        buf[2] = value >> 16;
+        buf[3] = value >> 8;
+        buf[4] = value;
+        len = 5;
+    }
+    return encoder->writer->write(encoder->writer, buf, len);
+}
+
+void
+cbor_encoder_init(CborEncoder *encoder, struct cbor_encoder_writer *w,
+                  int flags)
+{
+    encoder->writer = w;
+}
+
+int
+cbor_encoder_create_map(CborEncoder *encoder, CborEncoder *map, size_t length)
+{
+    map->writer = encoder->writer;
+    return encoder->writer->write(encoder->writer, "\xbf", 1);
+}
+
+int
+cbor_encoder_create_array(CborEncoder *encoder, CborEncoder *array,
+                          size_t length)
+{
+    array->writer = encoder->writer;
+    return encoder->writer->write(encoder->writer, "\x9f", 1);
+}
+
+int
+cbor_encoder_close_container(CborEncoder *encoder,
+                             const CborEncoder *container)
+{
+    return encoder->writer->write(encoder->writer, "\xff", 1);
+}
+
+int
+cbor_encode_text_stringz(CborEncoder *encoder, const char *string)
+{
+    int rc;
+
+    rc = host_cbor_head(encoder, 3, strlen(string));
+    if (rc != 0) {
+        return rc;
+    }
+    return encoder->writer->write(encoder->writer, string, strlen(string));
+}
+
+int
+cbor_encode_uint(CborEncoder *encoder, uint64_t value)
+{
+    return host_cbor_head(encoder, 0, value);
+}
+
+int
+cbor_encode_int(CborEncoder *encoder, int64_t value)
+{
+    if (value < 0) {
+        return host_cbor_head(encoder, 1, -1 - value);
+    }
+    return host_cbor_head(encoder, 0, value);
+}
+
+/* CRC16-CCITT and base64 */
+
+uint16_t
+crc16_ccitt(uint16_t initial_crc, const void *buf, int len)
+{
+    const uint8_t *ptr = buf;
+    uint16_t crc = initial_crc;
+    int i;
+
+    while (len-- > 0) {
+        crc ^= *ptr++ << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static const char host_b64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int
+base64_encode(const void *data, int size, char *s, uint8_t should_pad)
+{
+    const uint8_t *d = data;
+    uint32_t v;
+    int len = 0;
+    int i;
+
+    for (i = 0; i < size; i += 3) {
+        v = d[i] << 16;
+        if (i + 1 < size) {
+            v |= d[i + 1] << 8;
+        }
+        if (i + 2 < size) {
+            v |= d[i + 2];
+        }
+        s[len++] = host_b64[(v >> 18) & 63];
+        s[len++] = host_b64[(v >> 12) & 63];
+        s[len++] = (i + 1 < size) ? host_b64[(v >> 6) & 63] : '=';
+        s[len++] = (i + 2 < size) ? host_b64[v & 63] : '=';
+    }
+    s[len] = '\0';
+    return len;
+}
+
+static int
+host_b64_val(char c)
+{
+    const char *p;
+
+    if (c == '=') {
+        return 0;
+    }
+    p = strchr(host_b64, c);
+    return (c != '\0' && p != NULL) ? p - host_b64 : -1;
+}
+
+int
+base64_decode_len(const char *str)
+{
+    int len = 0;
+
+    while (str[len] != '\0' && str[len] != '\n' && str[len] != '\r') {
+        len++;
+    }
+    return len / 4 * 3;
+}
+
+int
+base64_decode(const char *str, void *data)
+{
+    uint8_t *d = data;
+    uint32_t v;
+    int len = 0;
+    int i;
+
+    for (; str[0] != '\0' && str[0] != '\n' && str[0] != '\r'; str += 4) {
+        v = 0;
+        for (i = 0; i < 4; i++) {
+            if (host_b64_val(str[i]) < 0) {
+                return -1;
+            }
+            v = v << 6 | host_b64_val(str[i]);
+        }
+        d[len++] = v >> 16;
+        if (str[2] != '=') {
+            d[len++] = v >> 8;
+        }
+        if (str[3] != '=') {
+            d[len++] = v;
+        }
+        if (str[2] == '=' || str[3] == '=') {
+            break;
+        }
+    }
+    return len;
+}
+
+/* UART */
+
+static int
+host_uart_read(char *str, int cnt, int *newline)
+{
+    int len = 0;
+    int rc;
+
+    *newline = 0;
+    while (len < cnt) {
+        rc = read(STDIN_FILENO, &str[len], 1);
+        if (rc <= 0) {
+            exit(rc < 0);
+        }
+        if (str[len++] == '\n') {
+            *newline = 1;
+            break;
+        }
+    }
+    return len;
+}
+
+static void
+host_uart_write(const char *ptr, int cnt)
+{
+    int rc;
+
+    while (cnt > 0) {
+        rc = write(STDOUT_FILENO, ptr, cnt);
+        if (rc <= 0) {
+            exit(1);
+        }
+        ptr += rc;
+        cnt -= rc;
+    }
+}
+
+static const struct boot_uart_funcs host_uart = {
+    .read = host_uart_read,
+    .write = host_uart_write,
+};
+
+int
+main(void)
+{
+    if (getenv("PROG_NS") != NULL) {
+        host_prog_ns = atol(getenv("PROG_NS"));
+    }
+    if (getenv("ERASE_NS") != NULL) {
+        host_erase_ns = atol(getenv("ERASE_NS"));
+    }
+    memset(host_slot, 0xff, sizeof(host_slot));
+
+    boot_serial_start(&host_uart);
+    return 0;
+}
@@ -0,0 +1,18 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of base64/base64.h. */
+
+#ifndef H_HOST_BASE64_H
+#define H_HOST_BASE64_H
+
+#include <stdint.h>
+
+#define BASE64_ENCODE_SIZE(__size) (((((__size) - 1) / 3) * 4) + 4)
+
+int base64_encode(const void *data, int size, char *s, uint8_t should_pad);
+int base64_decode(const char *str, void *data);
+int base64_decode_len(const char *str);
+
+#endif /* H_HOST_BASE64_H */
@@ -0,0 +1,10 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of bsp/bsp.h. */
+
+#ifndef H_HOST_BSP_H
+#define H_HOST_BSP_H
+
+#endif /* H_HOST_BSP_H */
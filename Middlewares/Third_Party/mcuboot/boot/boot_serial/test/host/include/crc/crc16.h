@@ -0,0 +1,16 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of crc/crc16.h. */
+
+#ifndef H_HOST_CRC16_H
+#define H_HOST_CRC16_H
+
+#include <stdint.h>
+
+#define CRC16_INITIAL_CRC       0
+
+uint16_t crc16_ccitt(uint16_t initial_crc, const void *buf, int len);
+
+#endif /* H_HOST_CRC16_H */
@@ -0,0 +1,31 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of flash_map_backend/flash_map_backend.h. */
+
+#ifndef H_HOST_FLASH_MAP_BACKEND_H
+#define H_HOST_FLASH_MAP_BACKEND_H
+
+#include <stdint.h>
+
+struct flash_area {
+    uint8_t fa_id;
+    uint8_t fa_device_id;
+    uint16_t pad16;
+    uint32_t fa_off;
+    uint32_t fa_size;
+};
+
+int flash_area_open(uint8_t id, const struct flash_area **fap);
+void flash_area_close(const struct flash_area *fap);
+int flash_area_read(const struct flash_area *fap, uint32_t off, void *dst,
+                    uint32_t len);
+int flash_area_write(const struct flash_area *fap, uint32_t off,
+                     const void *src, uint32_t len);
+int flash_area_erase(const struct flash_area *fap, uint32_t off, uint32_t len);
+uint8_t flash_area_align(const struct flash_area *fap);
+uint8_t flash_area_erased_val(const struct flash_area *fap);
+int flash_area_id_from_multi_image_slot(int image_index, int slot);
+
+#endif /* H_HOST_FLASH_MAP_BACKEND_H */
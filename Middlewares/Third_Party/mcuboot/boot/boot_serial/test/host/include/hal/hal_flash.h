@@ -0,0 +1,10 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of hal/hal_flash.h. */
+
+#ifndef H_HOST_HAL_FLASH_H
+#define H_HOST_HAL_FLASH_H
+
+#endif /* H_HOST_HAL_FLASH_H */
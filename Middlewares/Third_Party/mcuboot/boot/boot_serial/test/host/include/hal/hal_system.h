@@ -0,0 +1,12 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of hal/hal_system.h. */
+
+#ifndef H_HOST_HAL_SYSTEM_H
+#define H_HOST_HAL_SYSTEM_H
+
+void hal_system_reset(void);
+
+#endif /* H_HOST_HAL_SYSTEM_H */
@@ -0,0 +1,17 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of mcuboot_config/mcuboot_config.h. */
+
+#ifndef H_HOST_MCUBOOT_CONFIG_H
+#define H_HOST_MCUBOOT_CONFIG_H
+
+#define MCUBOOT_IMAGE_NUMBER        1
+#define MCUBOOT_SIGN_RSA
+#define MCUBOOT_USE_MBED_TLS
+#define MCUBOOT_VALIDATE_PRIMARY_SLOT
+#define MCUBOOT_MAX_IMG_SECTORS     128
+#define MCUBOOT_HAVE_LOGGING        1
+
+#endif /* H_HOST_MCUBOOT_CONFIG_H */
@@ -0,0 +1,31 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of mcuboot_config/mcuboot_logging.h. */
+
+#ifndef H_HOST_MCUBOOT_LOGGING_H
+#define H_HOST_MCUBOOT_LOGGING_H
+
+#include <stdio.h>
+
+#define MCUBOOT_LOG_LEVEL_OFF       0
+#define MCUBOOT_LOG_LEVEL_ERROR     1
+#define MCUBOOT_LOG_LEVEL_WARNING   2
+#define MCUBOOT_LOG_LEVEL_INFO      3
+#define MCUBOOT_LOG_LEVEL_DEBUG     4
+
+/* The UART is on stdout: logs go to stderr. */
+#define MCUBOOT_LOG_LEVEL           MCUBOOT_LOG_LEVEL_ERROR
+
+#define MCUBOOT_LOG_MODULE_DECLARE(domain)
+#define MCUBOOT_LOG_MODULE_REGISTER(domain)
+
+#define MCUBOOT_LOG_ERR(_fmt, ...) \
+    fprintf(stderr, "[ERR] " _fmt "\n", ##__VA_ARGS__)
+#define MCUBOOT_LOG_WRN(_fmt, ...) \
+    fprintf(stderr, "[WRN] " _fmt "\n", ##__VA_ARGS__)
+#define MCUBOOT_LOG_INF(_fmt, ...) ((void)0)
+#define MCUBOOT_LOG_DBG(_fmt, ...) ((void)0)
+
+#endif /* H_HOST_MCUBOOT_LOGGING_H */
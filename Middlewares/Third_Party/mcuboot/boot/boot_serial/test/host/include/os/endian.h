@@ -0,0 +1,12 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of os/endian.h. */
+
+#ifndef H_HOST_OS_ENDIAN_H
+#define H_HOST_OS_ENDIAN_H
+
+#include <arpa/inet.h>
+
+#endif /* H_HOST_OS_ENDIAN_H */
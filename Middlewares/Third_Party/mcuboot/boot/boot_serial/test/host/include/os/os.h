@@ -0,0 +1,15 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of os/os.h. */
+
+#ifndef H_HOST_OS_H
+#define H_HOST_OS_H
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#endif /* H_HOST_OS_H */
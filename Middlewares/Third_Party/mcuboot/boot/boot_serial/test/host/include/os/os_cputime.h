@@ -0,0 +1,14 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of os/os_cputime.h. */
+
+#ifndef H_HOST_OS_CPUTIME_H
+#define H_HOST_OS_CPUTIME_H
+
+#include <stdint.h>
+
+void os_cputime_delay_usecs(uint32_t usecs);
+
+#endif /* H_HOST_OS_CPUTIME_H */
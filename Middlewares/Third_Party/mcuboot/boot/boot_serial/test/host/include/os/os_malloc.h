@@ -0,0 +1,10 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of os/os_malloc.h. */
+
+#ifndef H_HOST_OS_MALLOC_H
+#define H_HOST_OS_MALLOC_H
+
+#endif /* H_HOST_OS_MALLOC_H */
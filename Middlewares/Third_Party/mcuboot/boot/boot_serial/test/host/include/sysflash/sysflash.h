@@ -0,0 +1,14 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of sysflash/sysflash.h. */
+
+#ifndef H_HOST_SYSFLASH_H
+#define H_HOST_SYSFLASH_H
+
+#define FLASH_AREA_IMAGE_PRIMARY(x)     1
+#define FLASH_AREA_IMAGE_SECONDARY(x)   2
+#define FLASH_AREA_IMAGE_SCRATCH        3
+
+#endif /* H_HOST_SYSFLASH_H */
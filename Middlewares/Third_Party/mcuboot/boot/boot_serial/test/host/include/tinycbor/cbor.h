@@ -0,0 +1,39 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Host build stand-in of tinycbor/cbor.h. */
+
+#ifndef H_HOST_CBOR_H
+#define H_HOST_CBOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Encoder of the definite and indefinite length items of the responses. */
+
+#define CborIndefiniteLength    ((size_t)-1)
+#define CborErrorOutOfMemory    (-1)
+
+struct cbor_encoder_writer {
+    int (*write)(struct cbor_encoder_writer *w, const char *data, int len);
+    int bytes_written;
+};
+
+typedef struct CborEncoder {
+    struct cbor_encoder_writer *writer;
+} CborEncoder;
+
+void cbor_encoder_init(CborEncoder *encoder, struct cbor_encoder_writer *w,
+                       int flags);
+int cbor_encoder_create_map(CborEncoder *encoder, CborEncoder *map,
+                            size_t length);
+int cbor_encoder_create_array(CborEncoder *encoder, CborEncoder *array,
+                              size_t length);
+int cbor_encoder_close_container(CborEncoder *encoder,
+                                 const CborEncoder *container);
+int cbor_encode_text_stringz(CborEncoder *encoder, const char *string);
+int cbor_encode_int(CborEncoder *encoder, int64_t value);
+int cbor_encode_uint(CborEncoder *encoder, uint64_t value);
+
+#endif /* H_HOST_CBOR_H */
@@ -0,0 +1,210 @@
+#! /usr/bin/env python3
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""
+Uploads a random image to the host build of boot_serial over a pty, as a
+host on a UART of the given baud rate would, and reports the throughput.
+
+The chunk size and the number of requests sent before waiting for a
+response are those reported by the MCUmgr parameters command, unless
+given.  The image is read back from the slot once the device resets.
+"""
+
+import argparse
+import base64
+import collections
+import os
+import pty
+import select
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+import tty
+
+# Room left in a frame of the reported size for the headers and the CBOR
+# members other than the data.
+FRAME_OVERHEAD = 64
+
+# Base64 characters of a frame per line: BOOT_MAX_LINE_INPUT_LEN less the two
+# start bytes and the newline, in whole quanta.
+LINE_ENC_LEN = (512 - 3) // 4 * 4
+
+PKT_START = b'\x06\x09'
+DATA_START = b'\x04\x14'
+
+
+def crc16(data, crc=0):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xffff
+    return crc
+
+
+def cbor_head(major, value):
+    if value < 24:
+        return bytes([major << 5 | value])
+    if value < 0x100:
+        return bytes([major << 5 | 24, value])
+    if value < 0x10000:
+        return bytes([major << 5 | 25]) + struct.pack('>H', value)
+    return bytes([major << 5 | 26]) + struct.pack('>I', value)
+
+
+def cbor_map(members):
+    out = cbor_head(5, len(members))
+    for key, value in members.items():
+        out += cbor_head(3, len(key)) + key.encode()
+        if isinstance(value, bytes):
+            out += cbor_head(2, len(value)) + value
+        else:
+            out += cbor_head(0, value)
+    return out
+
+
+def cbor_parse_rsp(data):
+    """Parses a response: an indefinite map of text keys to integers."""
+    pos = 1
+    out = {}
+
+    def item():
+        nonlocal pos
+        major, info = data[pos] >> 5, data[pos] & 31
+        pos += 1
+        if info < 24:
+            value = info
+        else:
+            size = 1 << (info - 24)
+            value = int.from_bytes(data[pos:pos + size], 'big')
+            pos += size
+        if major == 3:
+            value, pos = data[pos:pos + value].decode(), pos + value
+        elif major == 1:
+            value = -1 - value
+        return value
+
+    while data[pos] != 0xff:
+        key = item()
+        out[key] = item()
+    return out
+
+
+class Link:
+    def __init__(self, argv, baud, env):
+        self.master, slave = pty.openpty()
+        tty.setraw(slave)
+        self.proc = subprocess.Popen(argv, stdin=slave, stdout=slave, env=env)
+        os.close(slave)
+        self.byte_time = 10.0 / baud
+        self.tx_end = time.monotonic()
+        self.rx = b''
+        self.seq = 0
+
+    def send(self, group, cmd, payload, op=2):
+        hdr = struct.pack('>BBHHBB', op, 0, len(payload), group,
+                          self.seq & 0xff, cmd)
+        self.seq += 1
+        pkt = hdr + payload
+        pkt += struct.pack('>H', crc16(pkt))
+        enc = base64.b64encode(struct.pack('>H', len(pkt)) + pkt)
+        lines = b''
+        for i in range(0, len(enc), LINE_ENC_LEN):
+            lines += PKT_START if i == 0 else DATA_START
+            lines += enc[i:i + LINE_ENC_LEN] + b'\n'
+
+        # The frame reaches the device once the UART has transmitted it.
+        self.tx_end = max(self.tx_end, time.monotonic())
+        self.tx_end += len(lines) * self.byte_time
+        delay = self.tx_end - time.monotonic()
+        if delay > 0:
+            time.sleep(delay)
+        view = memoryview(lines)
+        while view:
+            view = view[os.write(self.master, view):]
+
+    def recv(self, timeout=10):
+        while b'\n' not in self.rx:
+            ready, _, _ = select.select([self.master], [], [], timeout)
+            if not ready:
+                raise TimeoutError(self.rx)
+            self.rx += os.read(self.master, 4096)
+        line, self.rx = self.rx.split(b'\n', 1)
+        line = line.strip(b'\r')
+        if line[:2] != PKT_START:
+            raise ValueError(line)
+        pkt = base64.b64decode(line[2:])
+        return cbor_parse_rsp(pkt[2 + 8:-2])
+
+
+def upload(link, img, chunk, window):
+    """
+    Sends up to window chunks ahead of the responses.  A response with an
+    offset other than the end of its chunk rewinds the upload to it.
+    """
+    off = 0
+    acked = 0
+    inflight = collections.deque()
+    rewinds = 0
+    while acked < len(img):
+        while off < len(img) and len(inflight) < window:
+            # The decoder requires the three members in every request.
+            data = img[off:off + chunk]
+            link.send(1, 1, cbor_map({'data': data, 'len': len(img),
+                                      'off': off}))
+            off += len(data)
+            inflight.append(off)
+        rsp = link.recv()
+        end = inflight.popleft()
+        if end is None:
+            continue
+        if rsp['rc'] != 0:
+            raise RuntimeError('upload failed: {}'.format(rsp))
+        acked = rsp['off']
+        if acked != end:
+            rewinds += 1
+            off = acked
+            inflight = collections.deque([None] * len(inflight))
+    return rewinds
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('device', help='host build of boot_serial')
+    parser.add_argument('baud', type=int)
+    parser.add_argument('size', type=int, help='image size, in bytes')
+    parser.add_argument('--chunk', type=int, default=0)
+    parser.add_argument('--window', type=int, default=0)
+    args = parser.parse_args()
+
+    img = os.urandom(args.size)
+    out = tempfile.NamedTemporaryFile()
+    link = Link([args.device], args.baud, dict(os.environ, OUT=out.name))
+
+    chunk, window = args.chunk, args.window
+    if not chunk or not window:
+        link.send(0, 6, cbor_map({}), op=0)
+        params = link.recv()
+        chunk = chunk or params['buf_size'] - FRAME_OVERHEAD
+        window = window or params['buf_count']
+
+    start = time.monotonic()
+    rewinds = upload(link, img, chunk, window)
+    elapsed = time.monotonic() - start
+
+    link.send(0, 5, cbor_map({}))
+    link.recv()
+    link.proc.wait(10)
+    ok = out.read(args.size) == img
+
+    print('baud={} chunk={} window={}: {:.1f} KB/s ({:.2f} s, {} rewinds) {}'
+          .format(args.baud, chunk, window, args.size / 1024 / elapsed,
+                  elapsed, rewinds, 'OK' if ok else 'MISMATCH'))
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -39,10 +39,24 @@ TEST_CASE_DECL(boot_serial_empty_msg)
 TEST_CASE_DECL(boot_serial_empty_img_msg)
 TEST_CASE_DECL(boot_serial_img_msg)
 TEST_CASE_DECL(boot_serial_upload_bigger_image)
+TEST_CASE_DECL(boot_serial_upload_unaligned)
+
+/* Last response, base64 encoded, and whether its start bytes were written */
+static char rsp_enc[256];
+static int rsp_started;
 
 static void
 test_uart_write(const char *str, int len)
 {
+    if (len == 2 && str[0] == SHELL_NLIP_PKT_START1 &&
+      str[1] == SHELL_NLIP_PKT_START2) {
+        rsp_started = 1;
+    } else if (rsp_started) {
+        assert(len < sizeof(rsp_enc));
+        memcpy(rsp_enc, str, len);
+        rsp_enc[len] = '\0';
+        rsp_started = 0;
+    }
 }
 
 static const struct boot_uart_funcs test_uart = {
@@ -55,6 +69,27 @@ tx_msg(void *src, int len)
     boot_serial_input(src, len);
 }
 
+int
+rx_rsp(void *dst, int max)
+{
+    char dec[sizeof(rsp_enc)];
+    uint16_t len;
+    int rc;
+
+    rc = base64_decode(rsp_enc, dec);
+    assert(rc > sizeof(len) + sizeof(struct nmgr_hdr) + sizeof(uint16_t));
+    memcpy(&len, dec, sizeof(len));
+    assert(ntohs(len) == rc - sizeof(len));
+    assert(crc16_ccitt(CRC16_INITIAL_CRC, &dec[sizeof(len)],
+                       rc - sizeof(len)) == 0);
+
+    rc -= sizeof(len) + sizeof(struct nmgr_hdr) + sizeof(uint16_t);
+    assert(rc <= max);
+    memcpy(dst, &dec[sizeof(len) + sizeof(struct nmgr_hdr)], rc);
+
+    return rc;
+}
+
 TEST_SUITE(boot_serial_suite)
 {
     boot_serial_setup();
@@ -62,6 +97,7 @@ TEST_SUITE(boot_serial_suite)
     boot_serial_empty_img_msg();
     boot_serial_img_msg();
     boot_serial_upload_bigger_image();
+    boot_serial_upload_unaligned();
 }
 
 int
@@ -43,6 +43,12 @@ extern "C" {
 
 void tx_msg(void *src, int len);
 
+/*
+ * Copies the CBOR payload of the last response to dst, checking its framing
+ * and CRC, and returns its length.
+ */
+int rx_rsp(void *dst, int max);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,121 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <flash_map_backend/flash_map_backend.h>
+#include <tinycbor/cborconstants_p.h>
+
+#include "boot_test.h"
+
+/*
+ * Upload an image in chunks not ending on the write alignment, sent back to
+ * back as a pipelining host does: every chunk must be accepted whole.
+ */
+TEST_CASE(boot_serial_upload_unaligned)
+{
+    char img[104];
+    char rd_img[sizeof(img)];
+    char buf[sizeof(struct nmgr_hdr) + 64];
+    uint8_t rsp[16];
+    int len;
+    int off;
+    int rc;
+    struct nmgr_hdr *hdr;
+    const struct flash_area *fap;
+    int i;
+
+    const int payload_off = sizeof *hdr;
+    const int img_data_off = payload_off + 7;
+
+    /* 00000000  a3 64 64 61 74 61 4d 00  |.ddataM.|
+     * 00000008  00 00 00 00 00 00 00 00  |........|
+     * 00000010  00 00 00 00 63 6c 65 6e  |....clen|
+     * 00000018  18 68 63 6f 66 66 18 00  |.hcoff..|
+     */
+    static const uint8_t payload[] = {
+        0xa3, 0x64, 0x64, 0x61, 0x74, 0x61, 0x4d,
+        /* 13 bytes of image data starts here. */
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00,
+        0x63, 0x6c, 0x65, 0x6e, 0x18, sizeof(img),
+        0x63, 0x6f, 0x66, 0x66,
+        /* 2 bytes of offset value starts here. */
+        0x18, 0x00
+    };
+
+    /* 00000000  bf 62 72 63 00 63 6f 66  |.brc.cof|
+     * 00000008  66 18 00 ff              |f...|
+     */
+    static const uint8_t rsp_ok[] = {
+        0xbf, 0x62, 0x72, 0x63, 0x00, 0x63, 0x6f, 0x66, 0x66,
+        /* 2 bytes of offset value starts here. */
+        0x18, 0x00,
+        0xff
+    };
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(0), &fap);
+    assert(rc == 0);
+    assert(flash_area_align(fap) > 1);
+
+    for (i = 0; i < sizeof(img); i++) {
+        img[i] = 0xa5 ^ i;
+    }
+
+    for (off = 0; off < sizeof(img); off += 13) {
+        hdr = (struct nmgr_hdr *)buf;
+        memset(hdr, 0, sizeof(*hdr));
+        hdr->nh_op = NMGR_OP_WRITE;
+        hdr->nh_group = htons(MGMT_GROUP_ID_IMAGE);
+        hdr->nh_id = IMGMGR_NMGR_ID_UPLOAD;
+
+        memcpy(buf + payload_off, payload, sizeof payload);
+        len = sizeof payload;
+        buf[payload_off + len - 1] = off;
+        memcpy(buf + img_data_off, img + off, 13);
+        hdr->nh_len = htons(len);
+
+        len = sizeof(*hdr) + len;
+
+        tx_msg(buf, len);
+
+        /*
+         * The chunk is accepted whole, the host sends the next one from
+         * where it ended.
+         */
+        len = rx_rsp(rsp, sizeof(rsp));
+        if (off + 13 < 24) {
+            /* Offsets below 24 are encoded in the initial byte. */
+            assert(len == sizeof(rsp_ok) - 1);
+            assert(!memcmp(rsp, rsp_ok, 9));
+            assert(rsp[9] == off + 13);
+            assert(rsp[10] == 0xff);
+        } else {
+            assert(len == sizeof(rsp_ok));
+            assert(!memcmp(rsp, rsp_ok, 10));
+            assert(rsp[10] == off + 13);
+            assert(rsp[11] == 0xff);
+        }
+    }
+
+    /*
+     * Validate contents inside the primary slot
+     */
+    rc = flash_area_read(fap, 0, rd_img, sizeof(rd_img));
+    assert(rc == 0);
+    assert(!memcmp(rd_img, img, sizeof(img)));
+}
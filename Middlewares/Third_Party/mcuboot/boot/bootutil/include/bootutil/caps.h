@@ -45,6 +45,12 @@ uint32_t bootutil_get_caps(void);
 #define BOOTUTIL_CAP_ENC_EC256              (1<<10)
 #define BOOTUTIL_CAP_SWAP_USING_MOVE        (1<<11)
 #define BOOTUTIL_CAP_DOWNGRADE_PREVENTION   (1<<12)
+#define BOOTUTIL_CAP_HASH_WHILE_COPY        (1<<13)
+#define BOOTUTIL_CAP_DIRECT_XIP             (1<<14)
+#define BOOTUTIL_CAP_DECOMPRESS_IMAGES      (1<<15)
+#define BOOTUTIL_CAP_DELTA_IMAGES           (1<<16)
+#define BOOTUTIL_CAP_VALIDATE_CACHE         (1<<17)
+#define BOOTUTIL_CAP_ASYNC_FLASH_WRITE      (1<<18)
 
 /*
  * Query the number of images this bootloader is configured for.  This
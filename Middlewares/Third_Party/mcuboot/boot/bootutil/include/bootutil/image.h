@@ -61,6 +61,19 @@ struct flash_area;
  */
 #define IMAGE_F_RAM_LOAD                 0x00000020
 
+/*
+ * The payload is compressed; it is expanded into the primary slot when the
+ * image is installed.  See the IMAGE_TLV_DECOMP_[...] TLVs.
+ */
+#define IMAGE_F_COMPRESSED               0x00000040
+
+/*
+ * The payload is a patch against the image in the primary slot; it is
+ * applied in place when the image is installed.  See the
+ * IMAGE_TLV_DELTA_[...] TLVs.
+ */
+#define IMAGE_F_DELTA                    0x00000080
+
 /*
  * ECSDA224 is with NIST P-224
  * ECSDA256 is with NIST P-256
@@ -89,6 +102,11 @@ struct flash_area;
 #define IMAGE_TLV_DEPENDENCY        0x40   /* Image depends on other image */
 #define IMAGE_TLV_SEC_CNT           0x50   /* security counter */
 #define IMAGE_TLV_BOOT_RECORD       0x60   /* measured boot record */
+#define IMAGE_TLV_DECOMP_SIZE       0x70   /* Size of the expanded payload */
+#define IMAGE_TLV_DECOMP_SHA256     0x71   /* SHA256 of the expanded image */
+#define IMAGE_TLV_DECOMP_SIGNATURE  0x72   /* Signature of the expanded image */
+#define IMAGE_TLV_DELTA_BASE_SHA256 0x73   /* SHA256 of the image patched */
+#define IMAGE_TLV_DELTA_SHA256      0x74   /* SHA256 of the patched image */
 #define IMAGE_TLV_ANY               0xffff /* Used to iterate over all TLV */
 
 struct image_version {
@@ -133,6 +151,8 @@ struct image_tlv {
 };
 
 #define IS_ENCRYPTED(hdr) ((hdr)->ih_flags & (IMAGE_F_ENCRYPTED))
+#define IS_COMPRESSED(hdr) ((hdr)->ih_flags & (IMAGE_F_COMPRESSED))
+#define IS_DELTA(hdr) ((hdr)->ih_flags & (IMAGE_F_DELTA))
 
 #define IS_PRIMARY_ONLY(hdr) ((hdr)->ih_flags & (IMAGE_F_PRIMARY_ONLY))
 #define MUST_DECRYPT_PRIMARY_ONLY(fap, idx, hdr) \
@@ -155,6 +175,11 @@ int bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
                           const struct flash_area *fap,
                           uint8_t *tmp_buf, uint32_t tmp_buf_sz,
                           uint8_t *seed, int seed_len, uint8_t *out_hash);
+#ifdef MCUBOOT_HASH_WHILE_COPY
+int bootutil_img_validate_tlvs(int image_index, struct image_header *hdr,
+                               const struct flash_area *fap,
+                               uint8_t *out_hash);
+#endif
 
 struct image_tlv_iter {
     const struct image_header *hdr;
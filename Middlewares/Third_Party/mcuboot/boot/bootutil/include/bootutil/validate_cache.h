@@ -0,0 +1,53 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __VALIDATE_CACHE_H__
+#define __VALIDATE_CACHE_H__
+
+/**
+ * @file validate_cache.h
+ *
+ * Platform interface of MCUBOOT_VALIDATE_CACHE.
+ *
+ * @note The key must be unique to the device and readable by the bootloader
+ *       only: anyone knowing it can write a record accepting any image in
+ *       the primary slot.  It is not used as is, the bootloader derives the
+ *       key of its records from it.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reads the device-unique key authenticating the validation records, such
+ * as the hardware unique key (HUK) of the device.
+ *
+ * @param key               Buffer to store the key.
+ * @param key_size          Size of the key, in bytes (32).
+ *
+ * @return                  0 on success; nonzero if there is no such key,
+ *                          in which case the primary slot is validated in
+ *                          full on every boot.
+ */
+int32_t boot_validate_cache_key_get(uint8_t *key, size_t key_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VALIDATE_CACHE_H__ */
@@ -186,6 +186,10 @@ boot_trailer_sz(uint32_t min_write_sz)
 {
     return /* state for all sectors */
            boot_status_sz(min_write_sz)           +
+#ifdef MCUBOOT_VALIDATE_CACHE
+           /* validation record */
+           boot_validate_cache_sz()               +
+#endif
 #ifdef MCUBOOT_ENC_IMAGES
            /* encryption keys */
 #  if MCUBOOT_SWAP_SAVE_ENCTLV
@@ -228,6 +232,14 @@ boot_status_off(const struct flash_area *fap)
     return fap->fa_size - off_from_end;
 }
 
+#ifdef MCUBOOT_VALIDATE_CACHE
+uint32_t
+boot_validate_cache_off(const struct flash_area *fap)
+{
+    return boot_status_off(fap) + boot_status_sz(flash_area_align(fap));
+}
+#endif
+
 uint32_t
 boot_magic_off(const struct flash_area *fap)
 {
@@ -578,6 +590,74 @@ boot_write_swap_size(const struct flash_area *fap, uint32_t swap_size)
     return boot_write_trailer(fap, off, (const uint8_t *) &swap_size, 4);
 }
 
+/**
+ * Writes the fields of a trailer set when a swap starts, other than its
+ * flags: the encryption keys, the swap size and, unless swap_type is
+ * BOOT_SWAP_TYPE_NONE, the swap info.  These are contiguous, and written in
+ * one flash operation rather than one per field; the keys are written on
+ * their own when they are saved as TLVs, which are much larger.  The magic,
+ * written after them, is still what makes them valid.
+ */
+int
+boot_write_swap_fields(const struct flash_area *fap,
+                       const struct boot_status *bs, uint8_t swap_type,
+                       uint8_t image_num)
+{
+#if defined(MCUBOOT_ENC_IMAGES) && !MCUBOOT_SWAP_SAVE_ENCTLV
+    uint8_t buf[BOOT_ENC_KEY_SIZE * BOOT_NUM_SLOTS + BOOT_MAX_ALIGN * 2];
+#else
+    uint8_t buf[BOOT_MAX_ALIGN * 2];
+#endif
+    uint32_t off;
+    uint32_t len;
+    uint8_t swap_info;
+    int rc;
+
+    if (flash_area_align(fap) > BOOT_MAX_ALIGN) {
+        return -1;
+    }
+
+#if defined(MCUBOOT_ENC_IMAGES) && MCUBOOT_SWAP_SAVE_ENCTLV
+    rc = boot_write_enc_key(fap, 0, bs);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = boot_write_enc_key(fap, 1, bs);
+    if (rc != 0) {
+        return rc;
+    }
+#endif
+
+    memset(buf, flash_area_erased_val(fap), sizeof(buf));
+    off = boot_swap_size_off(fap);
+    len = 0;
+#if defined(MCUBOOT_ENC_IMAGES) && !MCUBOOT_SWAP_SAVE_ENCTLV
+    /* The key of the secondary slot comes first. */
+    off = boot_enc_key_off(fap, 1);
+    memcpy(buf, bs->enckey[1], BOOT_ENC_KEY_SIZE);
+    memcpy(&buf[BOOT_ENC_KEY_SIZE], bs->enckey[0], BOOT_ENC_KEY_SIZE);
+    len = BOOT_ENC_KEY_SIZE * BOOT_NUM_SLOTS;
+#endif
+    memcpy(&buf[len], &bs->swap_size, sizeof(bs->swap_size));
+    len += BOOT_MAX_ALIGN;
+    if (swap_type != BOOT_SWAP_TYPE_NONE) {
+        BOOT_SET_SWAP_INFO(swap_info, image_num, swap_type);
+        buf[len] = swap_info;
+        len += BOOT_MAX_ALIGN;
+    }
+
+    BOOT_LOG_DBG("writing swap fields; fa_id=%d off=0x%lx (0x%lx) len=%lu",
+                 fap->fa_id, (unsigned long)off,
+                 (unsigned long)(fap->fa_off + off), (unsigned long)len);
+    rc = flash_area_write(fap, off, buf, len);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    return 0;
+}
+
 #ifdef MCUBOOT_ENC_IMAGES
 int
 boot_write_enc_key(const struct flash_area *fap, uint8_t slot,
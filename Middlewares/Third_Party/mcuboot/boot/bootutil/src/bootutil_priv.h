@@ -35,6 +35,9 @@
 #ifdef MCUBOOT_ENC_IMAGES
 #include "bootutil/enc_key.h"
 #endif
+#ifdef MCUBOOT_HASH_WHILE_COPY
+#include "bootutil/sha256.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -69,10 +72,90 @@ struct flash_area;
 #error "Please enable only one of MCUBOOT_OVERWRITE_ONLY or MCUBOOT_SWAP_USING_MOVE"
 #endif
 
-#if !defined(MCUBOOT_OVERWRITE_ONLY) && !defined(MCUBOOT_SWAP_USING_MOVE)
+#if defined(MCUBOOT_DIRECT_XIP)
+#if defined(MCUBOOT_OVERWRITE_ONLY) || defined(MCUBOOT_SWAP_USING_MOVE) || \
+    defined(MCUBOOT_PRIMARY_ONLY)
+#error "MCUBOOT_DIRECT_XIP cannot be combined with another upgrade strategy"
+#endif
+#if defined(MCUBOOT_ENC_IMAGES)
+/* Images are executed in place, so they must be stored in plaintext. */
+#error "MCUBOOT_DIRECT_XIP does not support MCUBOOT_ENC_IMAGES"
+#endif
+#if defined(MCUBOOT_IMAGE_NUMBER) && (MCUBOOT_IMAGE_NUMBER > 1)
+#error "MCUBOOT_DIRECT_XIP supports a single image only"
+#endif
+#endif
+
+#if !defined(MCUBOOT_OVERWRITE_ONLY) && !defined(MCUBOOT_SWAP_USING_MOVE) && \
+    !defined(MCUBOOT_DIRECT_XIP)
 #define MCUBOOT_SWAP_USING_SCRATCH 1
 #endif
 
+#if defined(MCUBOOT_HASH_WHILE_COPY)
+#if !defined(MCUBOOT_OVERWRITE_ONLY) || defined(MCUBOOT_PRIMARY_ONLY)
+#error "MCUBOOT_HASH_WHILE_COPY requires MCUBOOT_OVERWRITE_ONLY"
+#endif
+#if !defined(MCUBOOT_SIGN_RSA) && !defined(MCUBOOT_SIGN_EC) && \
+    !defined(MCUBOOT_SIGN_EC256) && !defined(MCUBOOT_SIGN_ED25519)
+/* The digest the copied data is checked against must be authenticated. */
+#error "MCUBOOT_HASH_WHILE_COPY requires an image signature"
+#endif
+#endif
+
+#if defined(MCUBOOT_DECOMPRESS_IMAGES)
+#if !defined(MCUBOOT_OVERWRITE_ONLY) || defined(MCUBOOT_PRIMARY_ONLY)
+/* The image is rebuilt in the primary slot and cannot be swapped back. */
+#error "MCUBOOT_DECOMPRESS_IMAGES requires MCUBOOT_OVERWRITE_ONLY"
+#endif
+#if defined(MCUBOOT_HASH_WHILE_COPY)
+#error "MCUBOOT_DECOMPRESS_IMAGES cannot be combined with MCUBOOT_HASH_WHILE_COPY"
+#endif
+/* RAM kept for back-references, and so the largest match offset accepted. */
+#ifndef MCUBOOT_DECOMPRESS_WINDOW
+#define MCUBOOT_DECOMPRESS_WINDOW 4096
+#endif
+#if (MCUBOOT_DECOMPRESS_WINDOW & (MCUBOOT_DECOMPRESS_WINDOW - 1)) != 0 || \
+    MCUBOOT_DECOMPRESS_WINDOW > 32768
+#error "MCUBOOT_DECOMPRESS_WINDOW must be a power of two, at most 32768"
+#endif
+#endif
+
+#if defined(MCUBOOT_DELTA_IMAGES)
+#if !defined(MCUBOOT_OVERWRITE_ONLY) || defined(MCUBOOT_PRIMARY_ONLY)
+/* The patch is applied in place to the image in the primary slot. */
+#error "MCUBOOT_DELTA_IMAGES requires MCUBOOT_OVERWRITE_ONLY"
+#endif
+#if defined(MCUBOOT_HASH_WHILE_COPY)
+#error "MCUBOOT_DELTA_IMAGES cannot be combined with MCUBOOT_HASH_WHILE_COPY"
+#endif
+#endif
+
+#if defined(MCUBOOT_VALIDATE_CACHE)
+#if !defined(MCUBOOT_VALIDATE_PRIMARY_SLOT) || defined(MCUBOOT_DIRECT_XIP)
+#error "MCUBOOT_VALIDATE_CACHE requires MCUBOOT_VALIDATE_PRIMARY_SLOT"
+#endif
+#if defined(MCUBOOT_PRIMARY_ONLY)
+/* The in-place decryption of an image rewrites the whole slot. */
+#error "MCUBOOT_VALIDATE_CACHE cannot be combined with MCUBOOT_PRIMARY_ONLY"
+#endif
+#endif
+
+/*
+ * Size of each buffer of boot_copy_region(), e.g. the flash page or the burst
+ * size of an external flash.  With MCUBOOT_PRIMARY_ONLY, a buffer is erased
+ * before being written, so it must be the sector size.
+ */
+#ifndef MCUBOOT_COPY_BUF_SIZE
+#if defined(MCUBOOT_OVERWRITE_ONLY)
+#define MCUBOOT_COPY_BUF_SIZE   4096
+#else
+#define MCUBOOT_COPY_BUF_SIZE   1024
+#endif
+#endif
+#if (MCUBOOT_COPY_BUF_SIZE % BOOT_MAX_ALIGN) != 0
+#error "MCUBOOT_COPY_BUF_SIZE must be a multiple of BOOT_MAX_ALIGN"
+#endif
+
 #define BOOT_STATUS_OP_MOVE     1
 #define BOOT_STATUS_OP_SWAP     2
 
@@ -248,6 +331,15 @@ struct boot_loader_state {
     struct enc_key_data enc[BOOT_IMAGE_NUMBER][BOOT_NUM_SLOTS];
 #endif
 
+#if defined(MCUBOOT_HASH_WHILE_COPY)
+    /* Signed digest of the image in the secondary slot; the payload is only
+     * hashed while it is copied, see boot_copy_image(). */
+    uint8_t hash[BOOT_IMAGE_NUMBER][32];
+    /* Running digest of the copy in progress, NULL when not hashing. */
+    bootutil_sha256_context *copy_sha;
+    uint32_t copy_hash_sz;
+#endif
+
 #if (BOOT_IMAGE_NUMBER > 1)
     uint8_t curr_img_idx;
 #endif
@@ -275,6 +367,9 @@ int boot_write_image_ok(const struct flash_area *fap);
 int boot_write_swap_info(const struct flash_area *fap, uint8_t swap_type,
                          uint8_t image_num);
 int boot_write_swap_size(const struct flash_area *fap, uint32_t swap_size);
+int boot_write_swap_fields(const struct flash_area *fap,
+                           const struct boot_status *bs, uint8_t swap_type,
+                           uint8_t image_num);
 int boot_read_swap_size(int image_index, uint32_t *swap_size);
 int boot_slots_compatible(struct boot_loader_state *state);
 uint32_t boot_status_internal_off(const struct boot_status *bs, int elem_sz);
@@ -285,6 +380,27 @@ int boot_copy_region(struct boot_loader_state *state,
                      const struct flash_area *fap_dst,
                      uint32_t off_src, uint32_t off_dst, uint32_t sz);
 int boot_erase_region(const struct flash_area *fap, uint32_t off, uint32_t sz);
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+int boot_decompressed_size(struct boot_loader_state *state,
+                           const struct flash_area *fap, uint32_t *size);
+int boot_decompress_image(struct boot_loader_state *state,
+                          const struct flash_area *fap_src,
+                          const struct flash_area *fap_dst);
+#endif
+#ifdef MCUBOOT_VALIDATE_CACHE
+uint32_t boot_validate_cache_sz(void);
+uint32_t boot_validate_cache_off(const struct flash_area *fap);
+int boot_validate_cache_check(struct boot_loader_state *state);
+int boot_validate_cache_save(struct boot_loader_state *state);
+#endif
+#ifdef MCUBOOT_DELTA_IMAGES
+int boot_delta_check(struct boot_loader_state *state,
+                     struct image_header *hdr, const struct flash_area *fap,
+                     uint8_t *tmpbuf, uint32_t tmpbuf_sz);
+int boot_delta_image(struct boot_loader_state *state,
+                     const struct flash_area *fap_src,
+                     const struct flash_area *fap_dst);
+#endif
 bool boot_status_is_reset(const struct boot_status *bs);
 
 #ifdef MCUBOOT_ENC_IMAGES
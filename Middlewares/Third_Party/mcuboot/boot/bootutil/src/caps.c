@@ -38,7 +38,9 @@ uint32_t bootutil_get_caps(void)
 #if defined(MCUBOOT_SIGN_ED25519)
     res |= BOOTUTIL_CAP_ED25519;
 #endif
-#if defined(MCUBOOT_OVERWRITE_ONLY)
+#if defined(MCUBOOT_DIRECT_XIP)
+    res |= BOOTUTIL_CAP_DIRECT_XIP;
+#elif defined(MCUBOOT_OVERWRITE_ONLY)
     res |= BOOTUTIL_CAP_OVERWRITE_UPGRADE;
 #elif defined(MCUBOOT_SWAP_USING_MOVE)
     res |= BOOTUTIL_CAP_SWAP_USING_MOVE;
@@ -60,6 +62,21 @@ uint32_t bootutil_get_caps(void)
 #if defined(MCUBOOT_DOWNGRADE_PREVENTION)
     res |= BOOTUTIL_CAP_DOWNGRADE_PREVENTION;
 #endif
+#if defined(MCUBOOT_HASH_WHILE_COPY)
+    res |= BOOTUTIL_CAP_HASH_WHILE_COPY;
+#endif
+#if defined(MCUBOOT_DECOMPRESS_IMAGES)
+    res |= BOOTUTIL_CAP_DECOMPRESS_IMAGES;
+#endif
+#if defined(MCUBOOT_DELTA_IMAGES)
+    res |= BOOTUTIL_CAP_DELTA_IMAGES;
+#endif
+#if defined(MCUBOOT_VALIDATE_CACHE)
+    res |= BOOTUTIL_CAP_VALIDATE_CACHE;
+#endif
+#if defined(MCUBOOT_ASYNC_FLASH_WRITE)
+    res |= BOOTUTIL_CAP_ASYNC_FLASH_WRITE;
+#endif
 
     return res;
 }
@@ -0,0 +1,677 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Installation of compressed images.
+ *
+ * The payload of a compressed image is an LZ4 block: a sequence of
+ * (literals, match) pairs, the last one holding literals only.  Each
+ * sequence starts with a token byte, whose high nibble is the number of
+ * literals and low nibble the match length minus 4; a nibble of 15 is
+ * followed by bytes adding to it up to and including the first one that is
+ * not 255.  The literals follow, then the match offset as a little endian
+ * 16-bit value.  Offsets are limited to MCUBOOT_DECOMPRESS_WINDOW, so only
+ * that much of the output is kept in RAM.
+ *
+ * The hash and signature of the image in the secondary slot cover the
+ * compressed payload.  The protected TLVs also carry the size of the
+ * expanded payload, and the hash and signature of the image as it is
+ * rebuilt in the primary slot:
+ *
+ * - the header, with the size of the expanded payload and without
+ *   IMAGE_F_COMPRESSED;
+ * - the expanded payload;
+ * - the protected TLVs, without the IMAGE_TLV_DECOMP_[...] ones;
+ * - the other TLVs, where the hash and signature are replaced with the
+ *   IMAGE_TLV_DECOMP_SHA256 and IMAGE_TLV_DECOMP_SIGNATURE values, and the
+ *   encryption keys are dropped.
+ *
+ * so that the primary slot holds a regular image, which can be validated
+ * like any other one.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "bootutil/bootutil.h"
+#include "bootutil/image.h"
+#include "bootutil/sha256.h"
+#include "bootutil_priv.h"
+#include "bootutil/bootutil_log.h"
+#ifdef MCUBOOT_ENC_IMAGES
+#include "bootutil/enc_key.h"
+#endif
+
+#include "mcuboot_config/mcuboot_config.h"
+
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+
+MCUBOOT_LOG_MODULE_DECLARE(mcuboot);
+
+#define BOOT_DECOMP_WIN_MASK    (MCUBOOT_DECOMPRESS_WINDOW - 1)
+#define BOOT_DECOMP_MIN_MATCH   4
+#define BOOT_DECOMP_IN_SZ       256
+
+/* Where the rebuilt image differs from the compressed one. */
+struct boot_decomp_info {
+    uint32_t size;          /* Size of the expanded payload */
+    uint32_t sha_off;       /* Offset of the expanded image hash */
+    uint32_t sig_off;       /* Offset of its signature, 0 if none */
+    uint16_t sig_len;
+    uint16_t prot_sz;       /* Protected TLV area of the rebuilt image */
+    uint16_t tlv_sz;        /* Other TLV area of the rebuilt image */
+};
+
+/* Compressed payload, read (and decrypted) from the secondary slot. */
+struct boot_decomp_in {
+    struct boot_loader_state *state;
+    const struct flash_area *fap;
+    const struct image_header *hdr;
+    uint32_t off;           /* Offset of buf[0] in the flash area */
+    uint32_t end;           /* End of the payload in the flash area */
+    uint16_t pos;
+    uint16_t len;
+    bool read_err;          /* A flash read failed */
+    uint8_t buf[BOOT_DECOMP_IN_SZ];
+};
+
+/*
+ * Rebuilt image, written to the primary slot.  The last window of output is
+ * kept for back-references; it is written whenever it is full, and the
+ * bytes covered by the image hash are hashed at the same time.
+ */
+struct boot_decomp_out {
+    const struct flash_area *fap;
+    uint32_t total;         /* Bytes produced so far */
+    uint32_t limit;         /* Bytes the primary slot can take */
+    uint32_t hash_sz;       /* Bytes covered by the image hash */
+    bootutil_sha256_context sha;
+    uint8_t win[MCUBOOT_DECOMPRESS_WINDOW];
+};
+
+#if !defined(__BOOTSIM__)
+static struct boot_decomp_in boot_decomp_in;
+static struct boot_decomp_out boot_decomp_out;
+#endif
+
+static bool
+boot_decomp_is_sig(uint16_t type)
+{
+    return type == IMAGE_TLV_RSA2048_PSS || type == IMAGE_TLV_RSA3072_PSS ||
+           type == IMAGE_TLV_ECDSA224 || type == IMAGE_TLV_ECDSA256 ||
+           type == IMAGE_TLV_ED25519;
+}
+
+static bool
+boot_decomp_is_enc(uint16_t type)
+{
+    return type == IMAGE_TLV_ENC_RSA2048 || type == IMAGE_TLV_ENC_KW128 ||
+           type == IMAGE_TLV_ENC_EC256;
+}
+
+/*
+ * Length of the value a TLV of the compressed image has in the rebuilt one,
+ * and where it is read from.  Returns false if the TLV is dropped.
+ */
+static bool
+boot_decomp_map_tlv(const struct boot_decomp_info *info, bool prot,
+                    uint16_t type, uint32_t *off, uint16_t *len)
+{
+    if (prot) {
+        return type != IMAGE_TLV_DECOMP_SIZE &&
+               type != IMAGE_TLV_DECOMP_SHA256 &&
+               type != IMAGE_TLV_DECOMP_SIGNATURE;
+    }
+
+    if (type == IMAGE_TLV_SHA256) {
+        *off = info->sha_off;
+        *len = 32;
+    } else if (boot_decomp_is_sig(type)) {
+        *off = info->sig_off;
+        *len = info->sig_len;
+    } else if (boot_decomp_is_enc(type)) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Read the IMAGE_TLV_DECOMP_[...] TLVs of a compressed image, and size the
+ * TLV areas of the image it expands to.
+ */
+static int
+boot_decomp_read_info(const struct image_header *hdr,
+                      const struct flash_area *fap,
+                      struct boot_decomp_info *info)
+{
+    struct image_tlv_iter it;
+    uint32_t prot_sz;
+    uint32_t tlv_sz;
+    uint32_t off;
+    uint16_t len;
+    uint16_t type;
+    bool prot;
+    int rc;
+
+    memset(info, 0, sizeof(*info));
+
+    rc = bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false);
+    if (rc) {
+        return BOOT_EBADIMAGE;
+    }
+
+    prot_sz = sizeof(struct image_tlv_info);
+    tlv_sz = sizeof(struct image_tlv_info);
+    while (true) {
+        rc = bootutil_tlv_iter_next(&it, &off, &len, &type);
+        if (rc < 0) {
+            return BOOT_EBADIMAGE;
+        } else if (rc > 0) {
+            break;
+        }
+
+        prot = off < it.prot_end;
+        if (prot && type == IMAGE_TLV_DECOMP_SIZE) {
+            if (len != sizeof(info->size)) {
+                return BOOT_EBADIMAGE;
+            }
+            if (flash_area_read(fap, off, &info->size, len)) {
+                return BOOT_EFLASH;
+            }
+        } else if (prot && type == IMAGE_TLV_DECOMP_SHA256) {
+            if (len != 32) {
+                return BOOT_EBADIMAGE;
+            }
+            info->sha_off = off;
+        } else if (prot && type == IMAGE_TLV_DECOMP_SIGNATURE) {
+            info->sig_off = off;
+            info->sig_len = len;
+        }
+
+        /* The protected TLVs come first: the expanded image's hash and
+         * signature are known by the time the others are sized. */
+        if (!prot && boot_decomp_is_sig(type) && info->sig_off == 0) {
+            /* A signed image must carry the signature of the expanded one. */
+            return BOOT_EBADIMAGE;
+        }
+        if (!boot_decomp_map_tlv(info, prot, type, &off, &len)) {
+            continue;
+        }
+        if (prot) {
+            prot_sz += sizeof(struct image_tlv) + len;
+        } else {
+            tlv_sz += sizeof(struct image_tlv) + len;
+        }
+    }
+
+    if (info->size == 0 || info->sha_off == 0) {
+        return BOOT_EBADIMAGE;
+    }
+
+    if (prot_sz == sizeof(struct image_tlv_info)) {
+        /* No protected TLV left. */
+        prot_sz = 0;
+    }
+    if (prot_sz > UINT16_MAX || tlv_sz > UINT16_MAX) {
+        return BOOT_EBADIMAGE;
+    }
+    info->prot_sz = prot_sz;
+    info->tlv_sz = tlv_sz;
+
+    return 0;
+}
+
+static uint32_t
+boot_decomp_image_size(const struct image_header *hdr,
+                       const struct boot_decomp_info *info)
+{
+    return hdr->ih_hdr_size + info->size + info->prot_sz + info->tlv_sz;
+}
+
+/*
+ * Size of the image the compressed image in the given flash area expands
+ * to, including its TLVs.
+ */
+int
+boot_decompressed_size(struct boot_loader_state *state,
+                       const struct flash_area *fap, uint32_t *size)
+{
+    const struct image_header *hdr;
+    struct boot_decomp_info info;
+    int rc;
+
+    hdr = boot_img_hdr(state, BOOT_SECONDARY_SLOT);
+    rc = boot_decomp_read_info(hdr, fap, &info);
+    if (rc != 0) {
+        return rc;
+    }
+
+    *size = boot_decomp_image_size(hdr, &info);
+    return 0;
+}
+
+/*
+ * Get the next byte of the compressed payload, or -1 at its end or on read
+ * errors; read errors also set `read_err`.
+ */
+static int
+boot_decomp_get(struct boot_decomp_in *in)
+{
+    uint32_t off;
+    uint32_t sz;
+
+    if (in->pos == in->len) {
+        off = in->off + in->len;
+        if (off >= in->end) {
+            return -1;
+        }
+        sz = in->end - off;
+        if (sz > sizeof(in->buf)) {
+            sz = sizeof(in->buf);
+        }
+        if (flash_area_read(in->fap, off, in->buf, sz)) {
+            in->read_err = true;
+            return -1;
+        }
+#ifdef MCUBOOT_ENC_IMAGES
+        if (IS_ENCRYPTED(in->hdr)) {
+            off -= in->hdr->ih_hdr_size;
+            boot_encrypt(BOOT_CURR_ENC(in->state), BOOT_CURR_IMG(in->state),
+                         in->fap, off, sz, off & 0xf, in->buf);
+        }
+#endif
+        in->off += in->len;
+        in->len = sz;
+        in->pos = 0;
+    }
+
+    return in->buf[in->pos++];
+}
+
+static bool
+boot_decomp_at_end(const struct boot_decomp_in *in)
+{
+    return in->pos == in->len && in->off + in->len >= in->end;
+}
+
+/*
+ * Error to report when the payload could not be read: a flash error, or a
+ * truncated or malformed stream.
+ */
+static int
+boot_decomp_in_error(const struct boot_decomp_in *in)
+{
+    return in->read_err ? BOOT_EFLASH : BOOT_EBADIMAGE;
+}
+
+/* Add the extension bytes of a sequence length. */
+static int
+boot_decomp_get_len(struct boot_decomp_in *in, uint32_t *len)
+{
+    int c;
+
+    do {
+        c = boot_decomp_get(in);
+        if (c < 0 || *len > UINT32_MAX - 255) {
+            return -1;
+        }
+        *len += c;
+    } while (c == 255);
+
+    return 0;
+}
+
+/*
+ * Write the buffered output, up to the end of the image on the last call:
+ * it is padded to the write alignment of the flash area.
+ */
+static int
+boot_decomp_flush(struct boot_decomp_out *out, bool last)
+{
+    uint32_t start;
+    uint32_t len;
+    uint32_t hash_len;
+    uint32_t align;
+
+    if (!last) {
+        /* The window is full. */
+        len = MCUBOOT_DECOMPRESS_WINDOW;
+    } else {
+        len = out->total & BOOT_DECOMP_WIN_MASK;
+        if (len == 0) {
+            return 0;
+        }
+    }
+    start = out->total - len;
+
+    if (start < out->hash_sz) {
+        hash_len = out->hash_sz - start;
+        if (hash_len > len) {
+            hash_len = len;
+        }
+        bootutil_sha256_update(&out->sha, out->win, hash_len);
+    }
+
+    if (last) {
+        align = flash_area_align(out->fap);
+        assert((MCUBOOT_DECOMPRESS_WINDOW % align) == 0);
+        while (len % align != 0) {
+            out->win[len++] = flash_area_erased_val(out->fap);
+        }
+    }
+
+    if (flash_area_write(out->fap, start, out->win, len)) {
+        return BOOT_EFLASH;
+    }
+
+    MCUBOOT_WATCHDOG_FEED();
+
+    return 0;
+}
+
+static int
+boot_decomp_put(struct boot_decomp_out *out, uint8_t byte)
+{
+    if (out->total >= out->limit) {
+        return BOOT_EBADIMAGE;
+    }
+
+    out->win[out->total & BOOT_DECOMP_WIN_MASK] = byte;
+    out->total++;
+    if ((out->total & BOOT_DECOMP_WIN_MASK) == 0) {
+        return boot_decomp_flush(out, false);
+    }
+
+    return 0;
+}
+
+static int
+boot_decomp_put_buf(struct boot_decomp_out *out, const void *buf, uint32_t len)
+{
+    const uint8_t *p = buf;
+    int rc;
+
+    while (len-- > 0) {
+        rc = boot_decomp_put(out, *p++);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+/* Copy a region of the compressed image unchanged. */
+static int
+boot_decomp_put_flash(struct boot_decomp_out *out,
+                      const struct flash_area *fap, uint32_t off, uint32_t len)
+{
+    uint8_t buf[32];
+    uint32_t chunk;
+    int rc;
+
+    while (len > 0) {
+        chunk = len < sizeof(buf) ? len : sizeof(buf);
+        if (flash_area_read(fap, off, buf, chunk)) {
+            return BOOT_EFLASH;
+        }
+        rc = boot_decomp_put_buf(out, buf, chunk);
+        if (rc != 0) {
+            return rc;
+        }
+        off += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+/* Expand the payload; it must produce exactly `size` bytes. */
+static int
+boot_decomp_payload(struct boot_decomp_in *in, struct boot_decomp_out *out,
+                    uint32_t size)
+{
+    uint32_t start;
+    uint32_t dist;
+    uint32_t len;
+    int token;
+    int lo;
+    int hi;
+    int c;
+    int rc;
+
+    start = out->total;
+    while (!boot_decomp_at_end(in)) {
+        token = boot_decomp_get(in);
+        if (token < 0) {
+            return boot_decomp_in_error(in);
+        }
+
+        len = (uint32_t)token >> 4;
+        if (len == 15 && boot_decomp_get_len(in, &len)) {
+            return boot_decomp_in_error(in);
+        }
+        if (len > size - (out->total - start)) {
+            return BOOT_EBADIMAGE;
+        }
+        while (len-- > 0) {
+            c = boot_decomp_get(in);
+            if (c < 0) {
+                return boot_decomp_in_error(in);
+            }
+            rc = boot_decomp_put(out, c);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+
+        if (boot_decomp_at_end(in)) {
+            break;
+        }
+
+        lo = boot_decomp_get(in);
+        hi = boot_decomp_get(in);
+        if (lo < 0 || hi < 0) {
+            return boot_decomp_in_error(in);
+        }
+        dist = (uint32_t)lo | ((uint32_t)hi << 8);
+        if (dist == 0 || dist > MCUBOOT_DECOMPRESS_WINDOW ||
+            dist > out->total - start) {
+            return BOOT_EBADIMAGE;
+        }
+
+        len = (uint32_t)token & 0xf;
+        if (len == 15 && boot_decomp_get_len(in, &len)) {
+            return boot_decomp_in_error(in);
+        }
+        len += BOOT_DECOMP_MIN_MATCH;
+        if (len > size - (out->total - start)) {
+            return BOOT_EBADIMAGE;
+        }
+        while (len-- > 0) {
+            rc = boot_decomp_put(out,
+                    out->win[(out->total - dist) & BOOT_DECOMP_WIN_MASK]);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    if (out->total - start != size) {
+        return BOOT_EBADIMAGE;
+    }
+
+    return 0;
+}
+
+/* Write one TLV area of the rebuilt image. */
+static int
+boot_decomp_tlvs(struct boot_decomp_out *out, const struct image_header *hdr,
+                 const struct flash_area *fap,
+                 const struct boot_decomp_info *info, bool prot)
+{
+    struct image_tlv_iter it;
+    struct image_tlv_info tlv_info;
+    struct image_tlv tlv;
+    uint32_t off;
+    uint16_t len;
+    uint16_t type;
+    int rc;
+
+    if (prot) {
+        if (info->prot_sz == 0) {
+            return 0;
+        }
+        tlv_info.it_magic = IMAGE_TLV_PROT_INFO_MAGIC;
+        tlv_info.it_tlv_tot = info->prot_sz;
+    } else {
+        tlv_info.it_magic = IMAGE_TLV_INFO_MAGIC;
+        tlv_info.it_tlv_tot = info->tlv_sz;
+    }
+    rc = boot_decomp_put_buf(out, &tlv_info, sizeof(tlv_info));
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false);
+    if (rc) {
+        return BOOT_EBADIMAGE;
+    }
+    while (true) {
+        rc = bootutil_tlv_iter_next(&it, &off, &len, &type);
+        if (rc < 0) {
+            return BOOT_EBADIMAGE;
+        } else if (rc > 0) {
+            break;
+        }
+
+        if ((off < it.prot_end) != prot ||
+            !boot_decomp_map_tlv(info, prot, type, &off, &len)) {
+            continue;
+        }
+
+        tlv.it_type = type;
+        tlv.it_len = len;
+        rc = boot_decomp_put_buf(out, &tlv, sizeof(tlv));
+        if (rc == 0) {
+            rc = boot_decomp_put_flash(out, fap, off, len);
+        }
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Install the compressed image of the secondary slot: expand it into the
+ * primary slot, which must have been erased, and check the hash of the
+ * result.  The image in the secondary slot must have been validated, and
+ * its encryption key loaded.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+boot_decompress_image(struct boot_loader_state *state,
+                      const struct flash_area *fap_src,
+                      const struct flash_area *fap_dst)
+{
+#if !defined(__BOOTSIM__)
+    struct boot_decomp_in *in = &boot_decomp_in;
+    struct boot_decomp_out *out = &boot_decomp_out;
+#else
+    struct boot_decomp_in in_buf;
+    struct boot_decomp_out out_buf;
+    struct boot_decomp_in *in = &in_buf;
+    struct boot_decomp_out *out = &out_buf;
+#endif
+    const struct image_header *hdr;
+    struct boot_decomp_info info;
+    struct image_header new_hdr;
+    uint8_t hash[32];
+    uint8_t expected[32];
+    int rc;
+
+    hdr = boot_img_hdr(state, BOOT_SECONDARY_SLOT);
+    rc = boot_decomp_read_info(hdr, fap_src, &info);
+    if (rc != 0) {
+        return rc;
+    }
+
+    memset(out, 0, offsetof(struct boot_decomp_out, win));
+    out->fap = fap_dst;
+    out->limit = boot_status_off(fap_dst);
+    out->hash_sz = hdr->ih_hdr_size + info.size + info.prot_sz;
+    if (boot_decomp_image_size(hdr, &info) > out->limit) {
+        BOOT_LOG_ERR("Expanded image does not fit in the primary slot");
+        return BOOT_EBADIMAGE;
+    }
+
+    memset(in, 0, offsetof(struct boot_decomp_in, buf));
+    in->state = state;
+    in->fap = fap_src;
+    in->hdr = hdr;
+    in->off = hdr->ih_hdr_size;
+    in->end = hdr->ih_hdr_size + hdr->ih_img_size;
+
+    BOOT_LOG_INF("Expanding the secondary slot to the primary slot: "
+                 "0x%" PRIx32 " -> 0x%" PRIx32 " bytes",
+                 hdr->ih_img_size, info.size);
+
+    bootutil_sha256_init(&out->sha);
+
+    new_hdr = *hdr;
+    new_hdr.ih_img_size = info.size;
+    new_hdr.ih_protect_tlv_size = info.prot_sz;
+    new_hdr.ih_flags &= ~IMAGE_F_COMPRESSED;
+    rc = boot_decomp_put_buf(out, &new_hdr, sizeof(new_hdr));
+    if (rc == 0) {
+        /* The rest of the header, if padded. */
+        rc = boot_decomp_put_flash(out, fap_src, sizeof(new_hdr),
+                                   hdr->ih_hdr_size - sizeof(new_hdr));
+    }
+    if (rc == 0) {
+        rc = boot_decomp_payload(in, out, info.size);
+    }
+    if (rc == 0) {
+        rc = boot_decomp_tlvs(out, hdr, fap_src, &info, true);
+    }
+    if (rc == 0) {
+        rc = boot_decomp_tlvs(out, hdr, fap_src, &info, false);
+    }
+    if (rc == 0) {
+        rc = boot_decomp_flush(out, true);
+    }
+
+    bootutil_sha256_finish(&out->sha, hash);
+    if (rc != 0) {
+        return rc;
+    }
+
+    if (flash_area_read(fap_src, info.sha_off, expected, sizeof(expected))) {
+        return BOOT_EFLASH;
+    }
+    if (boot_secure_memequal(hash, expected, sizeof(hash))) {
+        return BOOT_EBADIMAGE;
+    }
+
+    return 0;
+}
+
+#endif /* MCUBOOT_DECOMPRESS_IMAGES */
@@ -0,0 +1,620 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Installation of delta images.
+ *
+ * The payload of a delta image is a patch, which rebuilds an image from the
+ * one in the primary slot.  The header and protected TLVs of a delta image
+ * are those of the image it rebuilds, with two more protected TLVs: the
+ * SHA256 of the image the patch applies to, IMAGE_TLV_DELTA_BASE_SHA256,
+ * and the SHA256 of the rebuilt image, IMAGE_TLV_DELTA_SHA256.
+ *
+ * The patch is made of little endian 32-bit values.  It starts with a
+ * magic, the number of bytes of the image in the primary slot it reads
+ * (the part covered by its hash), the size of the rebuilt image, TLVs
+ * included, and the number of chunks that follow.  There is a chunk per
+ * sector of the primary slot holding part of the rebuilt image, starting
+ * from the last sector.  A chunk starts with the offset of its sector in
+ * the slot, the number of bytes of the rebuilt image in that sector and
+ * the size of the operations that follow, which produce these bytes.  An
+ * operation is a byte followed by its arguments:
+ *
+ * - BOOT_DELTA_OP_COPY, an offset and a length: copy bytes of the image in
+ *   the primary slot;
+ * - BOOT_DELTA_OP_DATA, a length and the bytes to write.
+ *
+ * Each sector is rebuilt in the scratch area, then copied over the sector
+ * of the primary slot.  As the sectors are rewritten from the end of the
+ * slot, a sector and the ones before it still hold the image being
+ * patched: a copy must not read past the end of its own sector.
+ *
+ * The progress is recorded in the status area of the secondary slot, with
+ * two entries per sector: the sector is staged in the scratch area, and it
+ * is written to the primary slot.  An interrupted installation resumes
+ * from there, so only a write buffer is kept in RAM.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "sysflash/sysflash.h"
+#include "flash_map_backend/flash_map_backend.h"
+
+#include "bootutil/bootutil.h"
+#include "bootutil/image.h"
+#include "bootutil_priv.h"
+#include "bootutil/bootutil_log.h"
+
+#include "mcuboot_config/mcuboot_config.h"
+
+#ifdef MCUBOOT_DELTA_IMAGES
+
+MCUBOOT_LOG_MODULE_DECLARE(mcuboot);
+
+#define BOOT_DELTA_MAGIC        0xde17a5e1
+#define BOOT_DELTA_OP_COPY      0x01
+#define BOOT_DELTA_OP_DATA      0x02
+#define BOOT_DELTA_BUF_SZ       512
+
+/* Progress entries of a sector. */
+#define BOOT_DELTA_STAGED       0
+#define BOOT_DELTA_DONE         1
+
+struct boot_delta_header {
+    uint32_t magic;
+    uint32_t base_size;     /* Bytes of the image in the primary slot read */
+    uint32_t target_size;   /* Size of the rebuilt image */
+    uint32_t chunk_count;
+};
+
+struct boot_delta_chunk {
+    uint32_t off;           /* Offset of the sector in the primary slot */
+    uint32_t size;          /* Bytes of the rebuilt image in the sector */
+    uint32_t len;           /* Size of the operations */
+};
+
+/* Patch in the secondary slot. */
+struct boot_delta {
+    struct boot_loader_state *state;
+    const struct flash_area *fap_src;
+    const struct flash_area *fap_dst;
+    struct boot_delta_header hdr;
+    uint32_t off;           /* Offset of the next chunk */
+    uint32_t end;           /* End of the patch */
+};
+
+/* Sector being rebuilt in the scratch area. */
+struct boot_delta_out {
+    const struct flash_area *fap;
+    uint32_t off;           /* Offset of buf[0] in the flash area */
+    uint32_t len;
+    uint8_t buf[BOOT_DELTA_BUF_SZ];
+};
+
+#if !defined(__BOOTSIM__)
+static struct boot_delta_out boot_delta_out;
+#endif
+
+/* Read and check the header of the patch. */
+static int
+boot_delta_begin(struct boot_delta *d, struct boot_loader_state *state,
+                 const struct image_header *hdr,
+                 const struct flash_area *fap_src,
+                 const struct flash_area *fap_dst)
+{
+    uint32_t limit;
+
+    d->state = state;
+    d->fap_src = fap_src;
+    d->fap_dst = fap_dst;
+    d->off = hdr->ih_hdr_size;
+    d->end = hdr->ih_hdr_size + hdr->ih_img_size;
+
+    if (d->end - d->off < sizeof(d->hdr)) {
+        return BOOT_EBADIMAGE;
+    }
+    if (flash_area_read(fap_src, d->off, &d->hdr, sizeof(d->hdr))) {
+        return BOOT_EFLASH;
+    }
+    d->off += sizeof(d->hdr);
+
+    limit = boot_status_off(fap_dst);
+    if (d->hdr.magic != BOOT_DELTA_MAGIC || d->hdr.chunk_count == 0 ||
+        d->hdr.chunk_count > boot_img_num_sectors(state, BOOT_PRIMARY_SLOT) ||
+        d->hdr.chunk_count > BOOT_STATUS_MAX_ENTRIES ||
+        d->hdr.base_size > limit || d->hdr.target_size > limit) {
+        return BOOT_EBADIMAGE;
+    }
+
+    return 0;
+}
+
+/*
+ * Read the header of the next chunk, the idx-th one, and check that it
+ * covers the next sector of the rebuilt image.
+ */
+static int
+boot_delta_next_chunk(struct boot_delta *d, uint32_t idx,
+                      struct boot_delta_chunk *chunk, uint32_t *sector)
+{
+    uint32_t sector_off;
+    uint32_t sector_sz;
+
+    if (d->end - d->off < sizeof(*chunk)) {
+        return BOOT_EBADIMAGE;
+    }
+    if (flash_area_read(d->fap_src, d->off, chunk, sizeof(*chunk))) {
+        return BOOT_EFLASH;
+    }
+    d->off += sizeof(*chunk);
+
+    *sector = d->hdr.chunk_count - 1 - idx;
+    sector_off = boot_img_sector_off(d->state, BOOT_PRIMARY_SLOT, *sector);
+    sector_sz = boot_img_sector_size(d->state, BOOT_PRIMARY_SLOT, *sector);
+    if (chunk->off != sector_off || chunk->size == 0 ||
+        chunk->size > sector_sz || chunk->len > d->end - d->off) {
+        return BOOT_EBADIMAGE;
+    }
+
+    /* Only the last sector of the rebuilt image can be partly used. */
+    if (idx == 0) {
+        if (sector_off + chunk->size != d->hdr.target_size) {
+            return BOOT_EBADIMAGE;
+        }
+    } else if (chunk->size != sector_sz) {
+        return BOOT_EBADIMAGE;
+    }
+
+    return 0;
+}
+
+/*
+ * Write the buffered output, padded to the write alignment of the flash
+ * area.
+ */
+static int
+boot_delta_flush(struct boot_delta_out *out)
+{
+    uint32_t align;
+
+    align = flash_area_align(out->fap);
+    assert(align <= sizeof(out->buf));
+    while (out->len % align != 0) {
+        out->buf[out->len++] = flash_area_erased_val(out->fap);
+    }
+
+    if (out->len > 0 &&
+        flash_area_write(out->fap, out->off, out->buf, out->len)) {
+        return BOOT_EFLASH;
+    }
+    out->off += out->len;
+    out->len = 0;
+
+    MCUBOOT_WATCHDOG_FEED();
+
+    return 0;
+}
+
+/* Output bytes of a flash area; this only checks the patch if out is NULL. */
+static int
+boot_delta_put(struct boot_delta_out *out, const struct flash_area *fap,
+               uint32_t off, uint32_t len)
+{
+    uint32_t chunk;
+    int rc;
+
+    if (out == NULL) {
+        return 0;
+    }
+
+    while (len > 0) {
+        chunk = sizeof(out->buf) - out->len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        if (flash_area_read(fap, off, &out->buf[out->len], chunk)) {
+            return BOOT_EFLASH;
+        }
+        out->len += chunk;
+        off += chunk;
+        len -= chunk;
+
+        if (out->len == sizeof(out->buf)) {
+            rc = boot_delta_flush(out);
+            if (rc != 0) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Run, or check if out is NULL, the operations of a chunk. */
+static int
+boot_delta_ops(struct boot_delta *d, const struct boot_delta_chunk *chunk,
+               uint32_t sector, struct boot_delta_out *out)
+{
+    uint32_t args[2];
+    uint32_t limit;
+    uint32_t done;
+    uint32_t off;
+    uint32_t end;
+    uint8_t op;
+    int rc;
+
+    /* Copies can read the sector and the ones before it. */
+    limit = chunk->off + boot_img_sector_size(d->state, BOOT_PRIMARY_SLOT,
+                                              sector);
+    if (limit > d->hdr.base_size) {
+        limit = d->hdr.base_size;
+    }
+
+    off = d->off;
+    end = d->off + chunk->len;
+    done = 0;
+    while (off < end) {
+        if (flash_area_read(d->fap_src, off, &op, sizeof(op))) {
+            return BOOT_EFLASH;
+        }
+        off += sizeof(op);
+
+        if (op == BOOT_DELTA_OP_COPY) {
+            if (end - off < sizeof(args)) {
+                return BOOT_EBADIMAGE;
+            }
+            if (flash_area_read(d->fap_src, off, args, sizeof(args))) {
+                return BOOT_EFLASH;
+            }
+            off += sizeof(args);
+            if (args[0] > limit || args[1] > limit - args[0] ||
+                args[1] > chunk->size - done) {
+                return BOOT_EBADIMAGE;
+            }
+            rc = boot_delta_put(out, d->fap_dst, args[0], args[1]);
+        } else if (op == BOOT_DELTA_OP_DATA) {
+            if (end - off < sizeof(args[1])) {
+                return BOOT_EBADIMAGE;
+            }
+            if (flash_area_read(d->fap_src, off, &args[1], sizeof(args[1]))) {
+                return BOOT_EFLASH;
+            }
+            off += sizeof(args[1]);
+            if (args[1] > end - off || args[1] > chunk->size - done) {
+                return BOOT_EBADIMAGE;
+            }
+            rc = boot_delta_put(out, d->fap_src, off, args[1]);
+            off += args[1];
+        } else {
+            return BOOT_EBADIMAGE;
+        }
+        if (rc != 0) {
+            return rc;
+        }
+        done += args[1];
+    }
+
+    if (done != chunk->size) {
+        return BOOT_EBADIMAGE;
+    }
+    d->off = end;
+
+    return 0;
+}
+
+static uint32_t
+boot_delta_progress_off(const struct flash_area *fap, uint32_t sector,
+                        int step)
+{
+    return boot_status_off(fap) +
+           (sector * BOOT_STATUS_STATE_COUNT + step) * flash_area_align(fap);
+}
+
+static bool
+boot_delta_is_set(const struct flash_area *fap, uint32_t sector, int step)
+{
+    uint8_t val;
+
+    /* A read error repeats the step, which is harmless. */
+    return flash_area_read_is_empty(fap,
+                                    boot_delta_progress_off(fap, sector, step),
+                                    &val, sizeof(val)) == 0;
+}
+
+/* Record a step, using the output buffer, which must be empty. */
+static int
+boot_delta_set(struct boot_delta_out *out, const struct flash_area *fap,
+               uint32_t sector, int step)
+{
+    uint32_t align;
+
+    align = flash_area_align(fap);
+    assert(out->len == 0 && align <= sizeof(out->buf));
+    memset(out->buf, flash_area_erased_val(fap), align);
+    out->buf[0] = 1;
+
+    if (flash_area_write(fap, boot_delta_progress_off(fap, sector, step),
+                         out->buf, align)) {
+        return BOOT_EFLASH;
+    }
+
+    return 0;
+}
+
+/* Erase the sectors at the start of the scratch area holding `size` bytes. */
+static int
+boot_delta_erase_scratch(const struct flash_area *fap, uint32_t size)
+{
+#if !defined(__BOOTSIM__)
+    static boot_sector_t sectors[BOOT_MAX_IMG_SECTORS];
+#else
+    boot_sector_t sectors[BOOT_MAX_IMG_SECTORS];
+#endif
+    uint32_t erase_sz;
+    uint32_t i;
+    int rc;
+
+#ifndef MCUBOOT_USE_FLASH_AREA_GET_SECTORS
+    int num_sectors = BOOT_MAX_IMG_SECTORS;
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_SCRATCH, &num_sectors,
+                               sectors);
+#else
+    uint32_t num_sectors = BOOT_MAX_IMG_SECTORS;
+
+    rc = flash_area_get_sectors(FLASH_AREA_IMAGE_SCRATCH, &num_sectors,
+                                sectors);
+#endif
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    erase_sz = 0;
+    for (i = 0; i < (uint32_t)num_sectors && erase_sz < size; i++) {
+#ifndef MCUBOOT_USE_FLASH_AREA_GET_SECTORS
+        erase_sz += sectors[i].fa_size;
+#else
+        erase_sz += sectors[i].fs_size;
+#endif
+    }
+    if (erase_sz < size) {
+        return BOOT_EBADIMAGE;
+    }
+
+    return boot_erase_region(fap, 0, erase_sz);
+}
+
+/* Read the value of a protected hash TLV of the delta image. */
+static int
+boot_delta_read_hash(const struct image_header *hdr,
+                     const struct flash_area *fap, uint16_t type,
+                     uint8_t *hash)
+{
+    struct image_tlv_iter it;
+    uint32_t off;
+    uint16_t len;
+
+    if (bootutil_tlv_iter_begin(&it, hdr, fap, type, true) ||
+        bootutil_tlv_iter_next(&it, &off, &len, NULL) != 0 || len != 32) {
+        return BOOT_EBADIMAGE;
+    }
+    if (flash_area_read(fap, off, hash, len)) {
+        return BOOT_EFLASH;
+    }
+
+    return 0;
+}
+
+/**
+ * Check the delta image of the secondary slot, whose signature has been
+ * verified: the patch must be well formed, and unless its installation has
+ * started, apply to the valid image in the primary slot.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+boot_delta_check(struct boot_loader_state *state, struct image_header *hdr,
+                 const struct flash_area *fap, uint8_t *tmpbuf,
+                 uint32_t tmpbuf_sz)
+{
+    const struct flash_area *fap_primary_slot;
+    const struct flash_area *fap_scratch;
+    struct image_header *base_hdr;
+    struct boot_delta_chunk chunk;
+    struct boot_delta d;
+    uint8_t hash[32];
+    uint8_t expected[32];
+    uint32_t base_size;
+    uint32_t sector;
+    uint32_t i;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_PRIMARY(BOOT_CURR_IMG(state)),
+                         &fap_primary_slot);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+    rc = flash_area_open(FLASH_AREA_IMAGE_SCRATCH, &fap_scratch);
+    if (rc != 0) {
+        flash_area_close(fap_primary_slot);
+        return BOOT_EFLASH;
+    }
+
+    rc = boot_delta_begin(&d, state, hdr, fap, fap_primary_slot);
+    for (i = 0; rc == 0 && i < d.hdr.chunk_count; i++) {
+        rc = boot_delta_next_chunk(&d, i, &chunk, &sector);
+        if (rc == 0 &&
+            boot_img_sector_size(state, BOOT_PRIMARY_SLOT, sector) >
+            fap_scratch->fa_size) {
+            BOOT_LOG_ERR("Scratch area too small for delta images");
+            rc = BOOT_EBADIMAGE;
+        }
+        if (rc == 0) {
+            rc = boot_delta_ops(&d, &chunk, sector, NULL);
+        }
+    }
+    if (rc == 0 && d.off != d.end) {
+        rc = BOOT_EBADIMAGE;
+    }
+    if (rc != 0 ||
+        boot_delta_is_set(fap, d.hdr.chunk_count - 1, BOOT_DELTA_STAGED)) {
+        goto done;
+    }
+
+    /* Nothing written yet: the primary slot must hold the base image. */
+    base_hdr = boot_img_hdr(state, BOOT_PRIMARY_SLOT);
+    if (base_hdr->ih_magic != IMAGE_MAGIC ||
+        !boot_u32_safe_add(&base_size, base_hdr->ih_hdr_size,
+                           base_hdr->ih_img_size) ||
+        !boot_u32_safe_add(&base_size, base_size,
+                           base_hdr->ih_protect_tlv_size) ||
+        base_size != d.hdr.base_size) {
+        BOOT_LOG_ERR("Delta image does not apply to the primary slot");
+        rc = BOOT_EBADIMAGE;
+        goto done;
+    }
+
+    rc = boot_delta_read_hash(hdr, fap, IMAGE_TLV_DELTA_BASE_SHA256, expected);
+    if (rc == 0 &&
+        (bootutil_img_validate(NULL, BOOT_CURR_IMG(state), base_hdr,
+                               fap_primary_slot, tmpbuf, tmpbuf_sz, NULL, 0,
+                               hash) ||
+         boot_secure_memequal(hash, expected, sizeof(hash)))) {
+        BOOT_LOG_ERR("Delta image does not apply to the primary slot");
+        rc = BOOT_EBADIMAGE;
+    }
+
+done:
+    flash_area_close(fap_scratch);
+    flash_area_close(fap_primary_slot);
+    return rc;
+}
+
+/**
+ * Install the delta image of the secondary slot, which must have been
+ * checked by boot_delta_check(): patch the primary slot sector by sector,
+ * resuming an interrupted installation, then validate the result.
+ *
+ * @return                      0 on success; nonzero on failure.
+ */
+int
+boot_delta_image(struct boot_loader_state *state,
+                 const struct flash_area *fap_src,
+                 const struct flash_area *fap_dst)
+{
+#if !defined(__BOOTSIM__)
+    struct boot_delta_out *out = &boot_delta_out;
+#else
+    struct boot_delta_out out_buf;
+    struct boot_delta_out *out = &out_buf;
+#endif
+    const struct flash_area *fap_scratch;
+    struct boot_delta_chunk chunk;
+    struct boot_delta d;
+    struct image_header *hdr;
+    struct image_header new_hdr;
+    uint8_t hash[32];
+    uint8_t expected[32];
+    uint32_t copy_sz;
+    uint32_t align;
+    uint32_t sector;
+    uint32_t i;
+    int rc;
+
+    hdr = boot_img_hdr(state, BOOT_SECONDARY_SLOT);
+    rc = boot_delta_begin(&d, state, hdr, fap_src, fap_dst);
+    if (rc != 0) {
+        return rc;
+    }
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_SCRATCH, &fap_scratch);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    BOOT_LOG_INF("Patching the primary slot: 0x%" PRIx32 " bytes",
+                 d.hdr.target_size);
+
+    out->fap = fap_scratch;
+    out->len = 0;
+    align = flash_area_align(fap_dst);
+    for (i = 0; i < d.hdr.chunk_count; i++) {
+        rc = boot_delta_next_chunk(&d, i, &chunk, &sector);
+        if (rc != 0) {
+            goto done;
+        }
+        if (boot_delta_is_set(fap_src, sector, BOOT_DELTA_DONE)) {
+            d.off += chunk.len;
+            continue;
+        }
+
+        if (!boot_delta_is_set(fap_src, sector, BOOT_DELTA_STAGED)) {
+            out->off = 0;
+            rc = boot_delta_erase_scratch(fap_scratch, chunk.size);
+            if (rc == 0) {
+                rc = boot_delta_ops(&d, &chunk, sector, out);
+            }
+            if (rc == 0) {
+                rc = boot_delta_flush(out);
+            }
+            if (rc == 0) {
+                rc = boot_delta_set(out, fap_src, sector, BOOT_DELTA_STAGED);
+            }
+            if (rc != 0) {
+                goto done;
+            }
+        } else {
+            d.off += chunk.len;
+        }
+
+        /* The scratch area is erased past the rebuilt bytes. */
+        copy_sz = (chunk.size + align - 1) & ~(align - 1);
+        rc = boot_erase_region(fap_dst, chunk.off,
+                               boot_img_sector_size(state, BOOT_PRIMARY_SLOT,
+                                                    sector));
+        if (rc == 0) {
+            rc = boot_copy_region(state, fap_scratch, fap_dst, 0, chunk.off,
+                                  copy_sz);
+        }
+        if (rc == 0) {
+            rc = boot_delta_set(out, fap_src, sector, BOOT_DELTA_DONE);
+        }
+        if (rc != 0) {
+            goto done;
+        }
+    }
+
+    /* The rebuilt image must be the one the delta image was signed for. */
+    if (flash_area_read(fap_dst, 0, &new_hdr, sizeof(new_hdr))) {
+        rc = BOOT_EFLASH;
+    } else if (new_hdr.ih_magic != IMAGE_MAGIC ||
+               boot_delta_read_hash(hdr, fap_src, IMAGE_TLV_DELTA_SHA256,
+                                    expected) ||
+               bootutil_img_validate(NULL, BOOT_CURR_IMG(state), &new_hdr,
+                                     fap_dst, out->buf, sizeof(out->buf),
+                                     NULL, 0, hash) ||
+               boot_secure_memequal(hash, expected, sizeof(hash))) {
+        rc = BOOT_EBADIMAGE;
+    }
+
+done:
+    flash_area_close(fap_scratch);
+    return rc;
+}
+
+#endif /* MCUBOOT_DELTA_IMAGES */
@@ -740,16 +740,91 @@ boot_enc_valid(struct enc_key_data *enc_state, int image_index,
     return enc_state[rc].valid;
 }
 
+/*
+ * Number of AES blocks of keystream generated at a time by boot_encrypt().
+ * The keystream buffer lives on the stack.
+ */
+#ifndef MCUBOOT_ENC_CTR_BLOCKS
+#define MCUBOOT_ENC_CTR_BLOCKS  16
+#endif
+
+/* Increment a 128-bit big-endian counter block. */
+static inline void
+boot_enc_ctr_inc(uint8_t *ctr)
+{
+    int i;
+
+    for (i = 15; i >= 0; i--) {
+        if (++ctr[i] != 0) {
+            break;
+        }
+    }
+}
+
+/*
+ * Fill `ks` with `nblk` blocks of AES-CTR keystream starting at counter
+ * block `ctr`, and advance `ctr` past them.
+ */
+static void
+boot_enc_keystream(struct enc_key_data *enc, uint8_t *ctr, uint8_t *ks,
+        uint32_t nblk)
+{
+#if defined(MCUBOOT_USE_MBED_TLS) && defined(MBEDTLS_AES_ALT) && \
+    defined(MBEDTLS_CIPHER_MODE_CTR)
+    /* Hand the whole request to the AES accelerator, which can pipeline
+     * the blocks; encrypting zeroes yields the keystream. */
+    size_t nc_off = 0;
+    uint8_t stream_block[16];
+
+    memset(ks, 0, nblk * 16);
+    mbedtls_aes_crypt_ctr(&enc->aes, nblk * 16, &nc_off, ctr, stream_block,
+            ks, ks);
+#else
+    uint32_t i;
+
+    for (i = 0; i < nblk; i++) {
+#if defined(MCUBOOT_USE_MBED_TLS)
+        mbedtls_aes_crypt_ecb(&enc->aes, MBEDTLS_AES_ENCRYPT, ctr, ks);
+#else
+        tc_aes_encrypt(ks, ctr, &enc->aes);
+#endif
+        boot_enc_ctr_inc(ctr);
+        ks += 16;
+    }
+#endif
+}
+
+/* XOR `len` bytes of keystream into `buf`, a word at a time. */
+static void
+boot_enc_xor(uint8_t *buf, const uint8_t *ks, uint32_t len)
+{
+    uint32_t w, k;
+
+    while (len >= sizeof(uint32_t)) {
+        memcpy(&w, buf, sizeof(w));
+        memcpy(&k, ks, sizeof(k));
+        w ^= k;
+        memcpy(buf, &w, sizeof(w));
+        buf += sizeof(uint32_t);
+        ks += sizeof(uint32_t);
+        len -= sizeof(uint32_t);
+    }
+
+    while (len-- > 0) {
+        *buf++ ^= *ks++;
+    }
+}
+
 void
 boot_encrypt(struct enc_key_data *enc_state, int image_index,
         const struct flash_area *fap, uint32_t off, uint32_t sz,
         uint32_t blk_off, uint8_t *buf)
 {
     struct enc_key_data *enc;
-    uint32_t i, j;
-    uint8_t u8;
+    uint32_t nblk;
+    uint32_t len;
     uint8_t nonce[16];
-    uint8_t blk[16];
+    uint32_t ks[MCUBOOT_ENC_CTR_BLOCKS * 16 / sizeof(uint32_t)];
     int rc;
 
     memset(nonce, 0, 12);
@@ -767,24 +842,26 @@ boot_encrypt(struct enc_key_data *enc_state, int image_index,
 
     enc = &enc_state[rc];
     assert(enc->valid == 1);
-    for (i = 0; i < sz; i++) {
-        if (i == 0 || blk_off == 0) {
-#if defined(MCUBOOT_USE_MBED_TLS)
-            mbedtls_aes_crypt_ecb(&enc->aes, MBEDTLS_AES_ENCRYPT, nonce, blk);
-#else
-            tc_aes_encrypt(blk, nonce, &enc->aes);
-#endif
 
-            for (j = 16; j > 0; --j) {
-                if (++nonce[j - 1] != 0) {
-                    break;
-                }
-            }
+    /* `blk_off` is the offset of `buf` in the first counter block. */
+    while (sz > 0) {
+        nblk = (blk_off + sz + 15) / 16;
+        if (nblk > MCUBOOT_ENC_CTR_BLOCKS) {
+            nblk = MCUBOOT_ENC_CTR_BLOCKS;
         }
 
-        u8 = *buf;
-        *buf++ = u8 ^ blk[blk_off];
-        blk_off = (blk_off + 1) & 0x0f;
+        boot_enc_keystream(enc, nonce, (uint8_t *)ks, nblk);
+
+        len = nblk * 16 - blk_off;
+        if (len > sz) {
+            len = sz;
+        }
+
+        boot_enc_xor(buf, (uint8_t *)ks + blk_off, len);
+
+        buf += len;
+        sz -= len;
+        blk_off = 0;
     }
 }
 
@@ -282,14 +282,15 @@ bootutil_get_img_security_cnt(struct image_header *hdr,
 #endif /* MCUBOOT_HW_ROLLBACK_PROT */
 
 /*
- * Verify the integrity of the image.
- * Return non-zero if image could not be validated/does not validate.
+ * Check the TLVs of an image against its digest.  When hash_from_tlv is set,
+ * the digest is not known yet: it is taken from the SHA256 TLV and returned
+ * in hash, so that only the signature and security counter over it are
+ * checked here.
  */
-int
-bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
-                      struct image_header *hdr, const struct flash_area *fap,
-                      uint8_t *tmp_buf, uint32_t tmp_buf_sz, uint8_t *seed,
-                      int seed_len, uint8_t *out_hash)
+static int
+bootutil_img_check_tlvs(int image_index, struct image_header *hdr,
+                        const struct flash_area *fap, uint8_t *hash,
+                        bool hash_from_tlv)
 {
     uint32_t off;
     uint16_t len;
@@ -301,7 +302,6 @@ bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
 #endif
     struct image_tlv_iter it;
     uint8_t buf[SIG_BUF_SIZE];
-    uint8_t hash[32];
     int rc;
 #ifdef MCUBOOT_HW_ROLLBACK_PROT
     uint32_t security_cnt = UINT32_MAX;
@@ -309,16 +309,6 @@ bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
     int32_t security_counter_valid = 0;
 #endif
 
-    rc = bootutil_img_hash(enc_state, image_index, hdr, fap, tmp_buf,
-            tmp_buf_sz, hash, seed, seed_len);
-    if (rc) {
-        return rc;
-    }
-
-    if (out_hash) {
-        memcpy(out_hash, hash, 32);
-    }
-
     rc = bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false);
     if (rc) {
         return rc;
@@ -341,14 +331,16 @@ bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
              * Verify the SHA256 image hash.  This must always be
              * present.
              */
-            if (len != sizeof(hash)) {
+            if (len != 32) {
                 return -1;
             }
-            rc = flash_area_read(fap, off, buf, sizeof hash);
+            rc = flash_area_read(fap, off, buf, 32);
             if (rc) {
                 return rc;
             }
-            if (boot_secure_memequal(hash, buf, sizeof(hash))) {
+            if (hash_from_tlv) {
+                memcpy(hash, buf, 32);
+            } else if (boot_secure_memequal(hash, buf, 32)) {
                 return -1;
             }
 
@@ -384,7 +376,7 @@ bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
                 return -1;
             }
 			BOOT_LOG_INF("verify sig key id %d", key_id);
-            rc = bootutil_verify_sig(hash, sizeof(hash), buf, len, key_id);
+            rc = bootutil_verify_sig(hash, 32, buf, len, key_id);
             if (rc == 0) {
 				BOOT_LOG_INF("signature OK");
                 valid_signature = 1;
@@ -449,6 +441,23 @@ bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
             {
                 rc = 0;
             }
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+            /* Describe the image a compressed one expands to. */
+            if (type == IMAGE_TLV_DECOMP_SIZE ||
+                type == IMAGE_TLV_DECOMP_SHA256 ||
+                type == IMAGE_TLV_DECOMP_SIGNATURE)
+            {
+                rc = 0;
+            }
+#endif
+#ifdef MCUBOOT_DELTA_IMAGES
+            /* Bind a delta image to the image it patches and produces. */
+            if (type == IMAGE_TLV_DELTA_BASE_SHA256 ||
+                type == IMAGE_TLV_DELTA_SHA256)
+            {
+                rc = 0;
+            }
+#endif
             if (rc)
             {
 
@@ -498,11 +507,11 @@ bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
             }
         }
         /* read flash per doubleword */
-#if defined(MCUBOOT_OVERWRITE_ONLY)
+#if defined(MCUBOOT_OVERWRITE_ONLY) && !defined(MCUBOOT_DELTA_IMAGES)
         /* check pattern till magic at end of slot */
         uint32_t end = boot_magic_off(fap);
 #else
-        /* check pattern till trailer */
+        /* check pattern till trailer (delta images keep progress there) */
         uint32_t end = boot_status_off(fap);
 #endif /* MCUBOOT_OVERWRITE_ONLY */
         while (off < end)
@@ -524,3 +533,45 @@ bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
 #endif /* !defined(MCUBOOT_PRIMARY_ONLY) */
     return 0;
 }
+
+/*
+ * Verify the integrity of the image.
+ * Return non-zero if image could not be validated/does not validate.
+ */
+int
+bootutil_img_validate(struct enc_key_data *enc_state, int image_index,
+                      struct image_header *hdr, const struct flash_area *fap,
+                      uint8_t *tmp_buf, uint32_t tmp_buf_sz, uint8_t *seed,
+                      int seed_len, uint8_t *out_hash)
+{
+    uint8_t hash[32];
+    int rc;
+
+    rc = bootutil_img_hash(enc_state, image_index, hdr, fap, tmp_buf,
+            tmp_buf_sz, hash, seed, seed_len);
+    if (rc) {
+        return rc;
+    }
+
+    if (out_hash) {
+        memcpy(out_hash, hash, 32);
+    }
+
+    return bootutil_img_check_tlvs(image_index, hdr, fap, hash, false);
+}
+
+#ifdef MCUBOOT_HASH_WHILE_COPY
+/*
+ * Verify the signature and security counter of an image without reading its
+ * payload.  On success out_hash holds the authenticated image digest, which
+ * the caller must compare with the digest of the data it copies.
+ */
+int
+bootutil_img_validate_tlvs(int image_index, struct image_header *hdr,
+                           const struct flash_area *fap, uint8_t *out_hash)
+{
+    memset(out_hash, 0, 32);
+
+    return bootutil_img_check_tlvs(image_index, hdr, fap, out_hash, true);
+}
+#endif /* MCUBOOT_HASH_WHILE_COPY */
@@ -79,7 +79,8 @@ static struct boot_loader_state boot_data;
  * Compute the total size of the given image.  Includes the size of
  * the TLVs.
  */
-#if !defined(MCUBOOT_OVERWRITE_ONLY) || defined(MCUBOOT_OVERWRITE_ONLY_FAST)
+#if (!defined(MCUBOOT_OVERWRITE_ONLY) || defined(MCUBOOT_OVERWRITE_ONLY_FAST)) && \
+    !defined(MCUBOOT_DIRECT_XIP)
 static int
 boot_read_image_size(struct boot_loader_state *state, int slot, uint32_t *size)
 {
@@ -324,6 +325,11 @@ boot_status_is_reset(const struct boot_status *bs)
  * Writes the supplied boot status to the flash file system.  The boot status
  * contains the current state of an in-progress image copy operation.
  *
+ * Each entry takes a whole write unit and is written once.  Entries are not
+ * packed several to a unit: every entry is the commit point of a step that
+ * is followed by an erase, and flash with ECC (such as the STM32L5 internal
+ * flash) cannot program a unit a second time to append to it.
+ *
  * @param bs                    The boot status to write.
  *
  * @return                      0 on success; nonzero on failure.
@@ -426,11 +432,34 @@ boot_image_check(struct boot_loader_state *state, struct image_header *hdr,
     }
 #endif
 
+#ifdef MCUBOOT_HASH_WHILE_COPY
+    if (fap->fa_id == FLASH_AREA_IMAGE_SECONDARY(image_index)) {
+        /* Only the signature over the SHA256 TLV is checked here: the
+         * payload is hashed while it is copied to the primary slot, and the
+         * upgrade is only committed if that hash matches, see
+         * boot_copy_image().
+         */
+        if (bootutil_img_validate_tlvs(image_index, hdr, fap,
+                                       state->hash[image_index])) {
+            return BOOT_EBADIMAGE;
+        }
+
+        return 0;
+    }
+#endif
+
     if (bootutil_img_validate(BOOT_CURR_ENC(state), image_index, hdr, fap, tmpbuf,
                               BOOT_TMPBUF_SZ, NULL, 0, NULL)) {
         return BOOT_EBADIMAGE;
     }
 
+#ifdef MCUBOOT_DELTA_IMAGES
+    if (IS_DELTA(hdr) &&
+        boot_delta_check(state, hdr, fap, tmpbuf, BOOT_TMPBUF_SZ)) {
+        return BOOT_EBADIMAGE;
+    }
+#endif
+
     return 0;
 }
 
@@ -489,6 +518,32 @@ boot_is_header_valid(const struct image_header *hdr, const struct flash_area *fa
     return true;
 }
 
+/*
+ * Check that the image can be used from its slot: compressed and delta
+ * images can only be installed from the secondary slot, and only if
+ * supported.  A delta image is neither compressed nor encrypted.
+ */
+static bool
+boot_is_format_supported(const struct image_header *hdr, int slot)
+{
+#ifdef MCUBOOT_DELTA_IMAGES
+    if (IS_DELTA(hdr) &&
+        (slot == BOOT_PRIMARY_SLOT || IS_COMPRESSED(hdr) || IS_ENCRYPTED(hdr))) {
+        return false;
+    }
+#else
+    if (IS_DELTA(hdr)) {
+        return false;
+    }
+#endif
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+    return !IS_COMPRESSED(hdr) || slot != BOOT_PRIMARY_SLOT;
+#else
+    (void)slot;
+    return !IS_COMPRESSED(hdr);
+#endif
+}
+
 /*
  * Check that a memory area consists of a given value.
  */
@@ -531,7 +586,7 @@ boot_check_header_erased(struct boot_loader_state *state, int slot)
     return 0;
 }
 
-#if (BOOT_IMAGE_NUMBER > 1) || \
+#if (BOOT_IMAGE_NUMBER > 1) || defined(MCUBOOT_DIRECT_XIP) || \
     (defined(MCUBOOT_OVERWRITE_ONLY) && defined(MCUBOOT_DOWNGRADE_PREVENTION))
 /**
  * Check if the version of the image is not older than required.
@@ -616,7 +671,8 @@ boot_validate_slot(struct boot_loader_state *state, int slot,
     }
 #endif
 
-    if (!boot_is_header_valid(hdr, fap) || boot_image_check(state, hdr, fap, bs)) {
+    if (!boot_is_header_valid(hdr, fap) || !boot_is_format_supported(hdr, slot) ||
+        boot_image_check(state, hdr, fap, bs)) {
 #if !defined(MCUBOOT_PRIMARY_ONLY)
         if (slot != BOOT_PRIMARY_SLOT) {
 #endif
@@ -643,7 +699,7 @@ out:
     return rc;
 }
 
-#if !defined(MCUBOOT_PRIMARY_ONLY)
+#if !defined(MCUBOOT_PRIMARY_ONLY) && !defined(MCUBOOT_DIRECT_XIP)
 /**
  * Determines which swap operation to perform, if any.  If it is determined
  * that a swap operation is required, the image in the secondary slot is checked
@@ -674,7 +730,7 @@ boot_validated_swap_type(struct boot_loader_state *state,
 
     return swap_type;
 }
-#endif /* !MCUBOOT_PRIMARY_ONLY */
+#endif /* !MCUBOOT_PRIMARY_ONLY && !MCUBOOT_DIRECT_XIP */
 
 #ifdef MCUBOOT_HW_ROLLBACK_PROT
 /**
@@ -737,10 +793,14 @@ boot_erase_region(const struct flash_area *fap, uint32_t off, uint32_t sz)
     return flash_area_erase(fap, off, sz);
 }
 
+#if !defined(MCUBOOT_DIRECT_XIP)
 /**
  * Copies the contents of one flash region to another.  You must erase the
  * destination region prior to calling this function.
  *
+ * With MCUBOOT_ASYNC_FLASH_WRITE, two buffers are used: the next chunk is
+ * read, and decrypted if needed, while the previous one is being written.
+ *
  * @param flash_area_id_src     The ID of the source flash area.
  * @param flash_area_id_dst     The ID of the destination flash area.
  * @param off_src               The offset within the source flash area to
@@ -769,26 +829,42 @@ boot_copy_region(struct boot_loader_state *state,
     uint32_t blk_sz;
     uint8_t image_index;
 #endif
-#if !defined(MCUBOOT_OVERWRITE_ONLY)
-    TARGET_STATIC uint8_t buf[1024];
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+    TARGET_STATIC uint8_t bufs[2][MCUBOOT_COPY_BUF_SIZE];
+    bool pending;
+    int rc_wait;
 #else
-    /* fix me must be set according to sector size of target device */
-    TARGET_STATIC uint8_t buf[4096];
+    TARGET_STATIC uint8_t bufs[1][MCUBOOT_COPY_BUF_SIZE];
+#endif
+    uint8_t *buf;
+#ifdef MCUBOOT_HASH_WHILE_COPY
+    uint32_t hash_sz;
 #endif
 #if !defined(MCUBOOT_ENC_IMAGES)
     (void)state;
 #endif
 
     bytes_copied = 0;
+    rc = 0;
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+    pending = false;
+#endif
     while (bytes_copied < sz) {
-        if (sz - bytes_copied > sizeof buf) {
-            chunk_sz = sizeof buf;
+        if (sz - bytes_copied > MCUBOOT_COPY_BUF_SIZE) {
+            chunk_sz = MCUBOOT_COPY_BUF_SIZE;
         } else {
             chunk_sz = sz - bytes_copied;
         }
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+        /* The other buffer may still be being written. */
+        buf = bufs[(bytes_copied / MCUBOOT_COPY_BUF_SIZE) & 1];
+#else
+        buf = bufs[0];
+#endif
         rc = flash_area_read(fap_src, off_src + bytes_copied, buf, chunk_sz);
         if (rc != 0) {
-            return BOOT_EFLASH;
+            rc = BOOT_EFLASH;
+            break;
         }
 #if defined(MCUBOOT_PRIMARY_ONLY)
         image_index = BOOT_CURR_IMG(state);
@@ -850,15 +926,46 @@ boot_copy_region(struct boot_loader_state *state,
                              blk_off, &buf[idx]);
             }
         }
+#ifdef MCUBOOT_HASH_WHILE_COPY
+        /* Hash what is written to the primary slot: the header, the
+         * decrypted payload and the protected TLVs.
+         */
+        if (state->copy_sha != NULL &&
+                off_src + bytes_copied < state->copy_hash_sz) {
+            hash_sz = state->copy_hash_sz - (off_src + bytes_copied);
+            if (hash_sz > (uint32_t)chunk_sz) {
+                hash_sz = chunk_sz;
+            }
+            bootutil_sha256_update(state->copy_sha, buf, hash_sz);
+        }
+#endif
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+        if (pending) {
+            pending = false;
+            rc = flash_area_write_wait(fap_dst);
+            if (rc != 0) {
+                rc = BOOT_EFLASH;
+                break;
+            }
+        }
+#endif
 #if defined(MCUBOOT_PRIMARY_ONLY)
         rc = flash_area_erase(fap_dst, off_dst + bytes_copied, chunk_sz);
         if (rc != 0) {
-            return BOOT_EFLASH;
+            rc = BOOT_EFLASH;
+            break;
         }
 #endif
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+        rc = flash_area_write_async(fap_dst, off_dst + bytes_copied, buf,
+                                    chunk_sz);
+        pending = (rc == 0);
+#else
         rc = flash_area_write(fap_dst, off_dst + bytes_copied, buf, chunk_sz);
+#endif
         if (rc != 0) {
-            return BOOT_EFLASH;
+            rc = BOOT_EFLASH;
+            break;
         }
 
         bytes_copied += chunk_sz;
@@ -866,7 +973,17 @@ boot_copy_region(struct boot_loader_state *state,
         MCUBOOT_WATCHDOG_FEED();
     }
 
-    return 0;
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+    /* The buffers are static: never return with a write in progress. */
+    if (pending) {
+        rc_wait = flash_area_write_wait(fap_dst);
+        if (rc == 0 && rc_wait != 0) {
+            rc = BOOT_EFLASH;
+        }
+    }
+#endif
+
+    return rc;
 }
 
 /**
@@ -961,6 +1078,14 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
     const struct flash_area *fap_primary_slot;
     const struct flash_area *fap_secondary_slot;
     uint8_t image_index;
+#ifdef MCUBOOT_VALIDATE_CACHE
+    uint32_t off;
+#endif
+#ifdef MCUBOOT_HASH_WHILE_COPY
+    bootutil_sha256_context sha256_ctx;
+    struct image_header *hdr;
+    uint8_t hash[32];
+#endif
 
     (void)bs;
 
@@ -983,6 +1108,25 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
             &fap_secondary_slot);
     assert (rc == 0);
 
+#if defined(MCUBOOT_OVERWRITE_ONLY_FAST) && defined(MCUBOOT_DECOMPRESS_IMAGES)
+    if (IS_COMPRESSED(boot_img_hdr(state, BOOT_SECONDARY_SLOT))) {
+        /* Erase what the image expands to.  A malformed image is left to
+         * boot_decompress_image() to reject.
+         */
+        (void)boot_decompressed_size(state, fap_secondary_slot, &src_size);
+    }
+#endif
+
+#ifdef MCUBOOT_DELTA_IMAGES
+    if (IS_DELTA(boot_img_hdr(state, BOOT_SECONDARY_SLOT))) {
+        /* The patch reads the image in the primary slot, whose sectors are
+         * erased one at a time as they are rewritten.
+         */
+        rc = boot_delta_image(state, fap_secondary_slot, fap_primary_slot);
+        goto installed;
+    }
+#endif
+
     sect_count = boot_img_num_sectors(state, BOOT_PRIMARY_SLOT);
     for (sect = 0, size = 0; sect < sect_count; sect++) {
         this_size = boot_img_sector_size(state, BOOT_PRIMARY_SLOT, sect);
@@ -1013,17 +1157,100 @@ boot_copy_image(struct boot_loader_state *state, struct boot_status *bs)
     }
 #endif
 
-    BOOT_LOG_INF("Copying the secondary slot to the primary slot: 0x%x bytes",
-                 size);
-    rc = boot_copy_region(state, fap_secondary_slot, fap_primary_slot, 0, 0, size);
+#ifdef MCUBOOT_HASH_WHILE_COPY
+    hdr = boot_img_hdr(state, BOOT_SECONDARY_SLOT);
+    bootutil_sha256_init(&sha256_ctx);
+    state->copy_sha = &sha256_ctx;
+    state->copy_hash_sz = hdr->ih_hdr_size + hdr->ih_img_size +
+                          hdr->ih_protect_tlv_size;
+#endif
+
+#ifdef MCUBOOT_DECOMPRESS_IMAGES
+    if (IS_COMPRESSED(boot_img_hdr(state, BOOT_SECONDARY_SLOT))) {
+        rc = boot_decompress_image(state, fap_secondary_slot, fap_primary_slot);
+    } else
+#endif
+    {
+        BOOT_LOG_INF("Copying the secondary slot to the primary slot: 0x%x bytes",
+                     size);
+#ifdef MCUBOOT_VALIDATE_CACHE
+        /* Leave the validation record erased, to be written after the
+         * image is validated.
+         */
+        off = boot_validate_cache_off(fap_primary_slot);
+        if (size > off) {
+            rc = boot_copy_region(state, fap_secondary_slot, fap_primary_slot,
+                                  0, 0, off);
+            off += boot_validate_cache_sz();
+            if (rc == 0 && size > off) {
+                rc = boot_copy_region(state, fap_secondary_slot,
+                                      fap_primary_slot, off, off, size - off);
+            }
+        } else
+#endif
+        rc = boot_copy_region(state, fap_secondary_slot, fap_primary_slot,
+                              0, 0, size);
+    }
+
+#ifdef MCUBOOT_HASH_WHILE_COPY
+    state->copy_sha = NULL;
+    bootutil_sha256_finish(&sha256_ctx, hash);
+    if (rc == 0 &&
+        boot_secure_memequal(hash, state->hash[image_index], sizeof(hash))) {
+        /* The data copied does not have the signed hash: the upgrade is
+         * rejected below, which erases the primary header and the secondary
+         * slot.
+         */
+        BOOT_LOG_ERR("Copied image does not match its signed hash");
+        rc = BOOT_EBADIMAGE;
+    }
+#endif
+#ifdef MCUBOOT_DELTA_IMAGES
+installed:
+#endif
+#if defined(MCUBOOT_HASH_WHILE_COPY) || defined(MCUBOOT_DECOMPRESS_IMAGES) || \
+    defined(MCUBOOT_DELTA_IMAGES)
+    if (rc != 0 && rc != BOOT_EBADIMAGE) {
+        /* A flash error says nothing about the image: leave both slots as
+         * they are, so that the installation is retried, or resumed for a
+         * delta image, on the next boot.
+         */
+        BOOT_LOG_ERR("Image installation failed: %d", rc);
+
+        flash_area_close(fap_primary_slot);
+        flash_area_close(fap_secondary_slot);
+
+        return rc;
+    }
+    if (rc != 0) {
+        BOOT_LOG_ERR("Image in the secondary slot is not valid!");
+        /* The primary slot already holds part of the rejected image: erase
+         * its header so that it is never booted, and drop the secondary
+         * slot as boot_validate_slot() would have done.
+         */
+        rc = boot_erase_region(fap_primary_slot,
+                               boot_img_sector_off(state, BOOT_PRIMARY_SLOT, 0),
+                               boot_img_sector_size(state, BOOT_PRIMARY_SLOT, 0));
+        assert(rc == 0);
+        rc = boot_erase_region(fap_secondary_slot, 0,
+                               fap_secondary_slot->fa_size);
+        assert(rc == 0);
+
+        flash_area_close(fap_primary_slot);
+        flash_area_close(fap_secondary_slot);
+
+        return BOOT_EBADIMAGE;
+    }
+#endif
 
 #ifdef MCUBOOT_HW_ROLLBACK_PROT
     /* Update the stored security counter with the new image's security counter
-     * value. Both slots hold the new image at this point, but the secondary
-     * slot's image header must be passed since the image headers in the
-     * boot_data structure have not been updated yet.
+     * value. It is read from the secondary slot, which is only erased below:
+     * the image headers in the boot_data structure have not been updated yet,
+     * and the secondary slot's header does not describe the layout of a
+     * compressed or delta image once installed in the primary slot.
      */
-    rc = boot_update_security_counter(BOOT_CURR_IMG(state), BOOT_PRIMARY_SLOT,
+    rc = boot_update_security_counter(BOOT_CURR_IMG(state), BOOT_SECONDARY_SLOT,
                                 boot_img_hdr(state, BOOT_SECONDARY_SLOT));
     if (rc != 0) {
         BOOT_LOG_ERR("Security counter update failed after image upgrade.");
@@ -1380,6 +1607,18 @@ boot_perform_update(struct boot_loader_state *state, struct boot_status *bs)
     /* At this point there are no aborted swaps. */
 #if defined(MCUBOOT_OVERWRITE_ONLY)
     rc = boot_copy_image(state, bs);
+#if defined(MCUBOOT_HASH_WHILE_COPY) || defined(MCUBOOT_DECOMPRESS_IMAGES) || \
+    defined(MCUBOOT_DELTA_IMAGES)
+    if (rc == BOOT_EBADIMAGE) {
+        /* The installed image did not match its signed digest. */
+        BOOT_SWAP_TYPE(state) = BOOT_SWAP_TYPE_FAIL;
+        rc = 0;
+    } else if (rc != 0) {
+        /* The secondary slot is kept, the upgrade is retried on reset. */
+        BOOT_SWAP_TYPE(state) = BOOT_SWAP_TYPE_PANIC;
+        rc = 0;
+    }
+#endif
 #elif defined(MCUBOOT_BOOTSTRAP)
     /* Check if the image update was triggered by a bad image in the
      * primary slot (the validity of the image in the secondary slot had
@@ -1907,7 +2146,18 @@ context_boot_go(struct boot_loader_state *state, struct boot_rsp *rsp)
         ImageValidEnable = 1;
 #endif /* MCUBOOT_DOUBLE_SIGN_VERIF */
 
+#ifdef MCUBOOT_VALIDATE_CACHE
+        rc = boot_validate_cache_check(state);
+        if (rc != 0) {
+            rc = boot_validate_slot(state, BOOT_PRIMARY_SLOT, NULL);
+            if (rc == 0) {
+                /* Without a record, the next boot validates in full again. */
+                (void)boot_validate_cache_save(state);
+            }
+        }
+#else
         rc = boot_validate_slot(state, BOOT_PRIMARY_SLOT, NULL);
+#endif
         if (rc != 0) {
             rc = BOOT_EBADIMAGE;
             goto out;
@@ -2027,6 +2277,190 @@ out:
     return rc;
 }
 
+#else /* !MCUBOOT_DIRECT_XIP */
+
+/**
+ * Checks the trailer of the image in the given slot to decide whether it can
+ * be booted.  An image marked for test (magic set, image_ok unset) is given a
+ * single boot: its copy_done flag is set when it is first selected, and it is
+ * erased if it gets selected again without having confirmed itself, which
+ * reverts to the image in the other slot.
+ *
+ * @param state                 Boot loader status information.
+ * @param slot                  The slot of the image to boot.
+ * @param confirmed             Set to true if the image is not a test image.
+ *
+ * @return                      0 if the image can be booted; nonzero if it
+ *                                  must not be booted.
+ */
+static int
+boot_direct_xip_select(struct boot_loader_state *state, int slot,
+                       bool *confirmed)
+{
+    const struct flash_area *fap;
+    struct boot_swap_state swap_state;
+    int rc;
+
+    fap = BOOT_IMG_AREA(state, slot);
+    rc = boot_read_swap_state(fap, &swap_state);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    *confirmed = swap_state.magic != BOOT_MAGIC_GOOD ||
+                 swap_state.image_ok == BOOT_FLAG_SET;
+    if (*confirmed) {
+        /* Confirmed, or installed without a trailer. */
+        return 0;
+    }
+
+    if (swap_state.copy_done == BOOT_FLAG_SET) {
+        BOOT_LOG_INF("Image in the %s slot was not confirmed; erasing it",
+                     (slot == BOOT_PRIMARY_SLOT) ? "primary" : "secondary");
+        /* The header is erased first, so an interrupted erase still leaves
+         * a slot that is never booted.
+         */
+        rc = boot_erase_region(fap, 0, fap->fa_size);
+        assert(rc == 0);
+        return 1;
+    }
+
+    /* Mark the image as tried before running it, so that it is reverted on
+     * the next reset unless it confirms itself.  An image that cannot be
+     * marked is not booted: it could never be reverted.
+     */
+    rc = boot_write_copy_done(fap);
+    if (rc != 0) {
+        BOOT_LOG_ERR("Failed to set copy_done in the %s slot",
+                     (slot == BOOT_PRIMARY_SLOT) ? "primary" : "secondary");
+        return BOOT_EFLASH;
+    }
+
+    return 0;
+}
+
+/**
+ * Direct-XIP boot: the images are executed from the slot they were written
+ * to, and nothing is ever copied.  The image with the highest version that
+ * passes validation is booted; on equal versions, the primary slot wins.
+ */
+int
+context_boot_go(struct boot_loader_state *state, struct boot_rsp *rsp)
+{
+    bool bootable[BOOT_NUM_SLOTS];
+    struct image_header *hdr;
+    bool confirmed;
+    int slot;
+    int fa_id;
+    int rc;
+
+    memset(state, 0, sizeof(struct boot_loader_state));
+
+    for (slot = 0; slot < BOOT_NUM_SLOTS; slot++) {
+        fa_id = flash_area_id_from_multi_image_slot(BOOT_CURR_IMG(state), slot);
+        rc = flash_area_open(fa_id, &BOOT_IMG_AREA(state, slot));
+        assert(rc == 0);
+    }
+
+    rc = boot_read_image_headers(state, false, NULL);
+    if (rc != 0) {
+        goto out;
+    }
+
+    for (slot = 0; slot < BOOT_NUM_SLOTS; slot++) {
+        hdr = boot_img_hdr(state, slot);
+        bootable[slot] = hdr->ih_magic == IMAGE_MAGIC &&
+                         !(hdr->ih_flags & IMAGE_F_NON_BOOTABLE);
+    }
+
+    while (true) {
+        if (bootable[BOOT_PRIMARY_SLOT] && bootable[BOOT_SECONDARY_SLOT]) {
+            /* Boot from the secondary slot only if it is strictly newer. */
+            rc = boot_is_version_sufficient(
+                    &boot_img_hdr(state, BOOT_SECONDARY_SLOT)->ih_ver,
+                    &boot_img_hdr(state, BOOT_PRIMARY_SLOT)->ih_ver);
+            slot = (rc != 0) ? BOOT_SECONDARY_SLOT : BOOT_PRIMARY_SLOT;
+        } else if (bootable[BOOT_PRIMARY_SLOT]) {
+            slot = BOOT_PRIMARY_SLOT;
+        } else if (bootable[BOOT_SECONDARY_SLOT]) {
+            slot = BOOT_SECONDARY_SLOT;
+        } else {
+            BOOT_LOG_ERR("No bootable image found");
+            rc = BOOT_EBADIMAGE;
+            goto out;
+        }
+
+        rc = boot_direct_xip_select(state, slot, &confirmed);
+        if (rc == 0) {
+#if defined(MCUBOOT_DOUBLE_SIGN_VERIF)
+            /* Enable image validation double check */
+            ImageValidEnable = 1;
+            ImageValidIndex = 0;
+#endif /* MCUBOOT_DOUBLE_SIGN_VERIF */
+
+            rc = boot_validate_slot(state, slot, NULL);
+
+#if defined(MCUBOOT_DOUBLE_SIGN_VERIF)
+            /* Disable image validation double check */
+            ImageValidEnable = 0;
+#endif /* MCUBOOT_DOUBLE_SIGN_VERIF */
+        }
+        if (rc == 0) {
+            break;
+        }
+
+        /* Fall back to the image in the other slot, if any. */
+        bootable[slot] = false;
+    }
+
+    BOOT_LOG_INF("Booting image in the %s slot",
+                 (slot == BOOT_PRIMARY_SLOT) ? "primary" : "secondary");
+
+#ifdef MCUBOOT_HW_ROLLBACK_PROT
+    /* A test image can still be reverted to the other slot, so the security
+     * counter is only updated once the image has been confirmed.
+     */
+    if (confirmed) {
+        rc = boot_update_security_counter(BOOT_CURR_IMG(state), slot,
+                                          boot_img_hdr(state, slot));
+        if (rc != 0) {
+            BOOT_LOG_ERR("Security counter update failed after image "
+                         "validation.");
+            goto out;
+        }
+    }
+#endif /* MCUBOOT_HW_ROLLBACK_PROT */
+
+#ifdef MCUBOOT_MEASURED_BOOT
+    rc = boot_save_boot_status(BOOT_CURR_IMG(state), boot_img_hdr(state, slot),
+                               BOOT_IMG_AREA(state, slot));
+    if (rc != 0) {
+        BOOT_LOG_ERR("Failed to add Image %u data to shared memory area",
+                     BOOT_CURR_IMG(state));
+    }
+#endif /* MCUBOOT_MEASURED_BOOT */
+
+#ifdef MCUBOOT_DATA_SHARING
+    rc = boot_save_shared_data(boot_img_hdr(state, slot),
+                               BOOT_IMG_AREA(state, slot));
+    if (rc != 0) {
+        BOOT_LOG_ERR("Failed to add data to shared memory area.");
+    }
+#endif /* MCUBOOT_DATA_SHARING */
+
+    rsp->br_flash_dev_id = BOOT_IMG_AREA(state, slot)->fa_device_id;
+    rsp->br_image_off = boot_img_slot_off(state, slot);
+    rsp->br_hdr = boot_img_hdr(state, slot);
+    rc = 0;
+
+out:
+    for (slot = 0; slot < BOOT_NUM_SLOTS; slot++) {
+        flash_area_close(BOOT_IMG_AREA(state, BOOT_NUM_SLOTS - 1 - slot));
+    }
+    return rc;
+}
+#endif /* !MCUBOOT_DIRECT_XIP */
+
 /**
  * Prepares the booting process.  This function moves images around in flash as
  * appropriate, and tells you what address to boot from.
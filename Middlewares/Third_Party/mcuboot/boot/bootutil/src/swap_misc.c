@@ -100,27 +100,14 @@ swap_status_init(const struct boot_loader_state *state,
             &swap_state);
     assert(rc == 0);
 
-    if (bs->swap_type != BOOT_SWAP_TYPE_NONE) {
-        rc = boot_write_swap_info(fap, bs->swap_type, image_index);
-        assert(rc == 0);
-    }
+    rc = boot_write_swap_fields(fap, bs, bs->swap_type, image_index);
+    assert(rc == 0);
 
     if (swap_state.image_ok == BOOT_FLAG_SET) {
         rc = boot_write_image_ok(fap);
         assert(rc == 0);
     }
 
-    rc = boot_write_swap_size(fap, bs->swap_size);
-    assert(rc == 0);
-
-#ifdef MCUBOOT_ENC_IMAGES
-    rc = boot_write_enc_key(fap, 0, bs);
-    assert(rc == 0);
-
-    rc = boot_write_enc_key(fap, 1, bs);
-    assert(rc == 0);
-#endif
-
     rc = boot_write_magic(fap);
     assert(rc == 0);
 
@@ -164,6 +164,7 @@ boot_status_internal_off(const struct boot_status *bs, int elem_sz)
            (bs->state - BOOT_STATUS_STATE_0) * elem_sz;
 }
 
+#if !defined(MCUBOOT_DIRECT_XIP)
 /*
  * Slots are compatible when all sectors that store up to to size of the image
  * round up to sector size, in both slot's are able to fit in the scratch
@@ -259,6 +260,7 @@ boot_slots_compatible(struct boot_loader_state *state)
 
     return 1;
 }
+#endif /* !MCUBOOT_DIRECT_XIP */
 
 #define BOOT_LOG_SWAP_STATE(area, state)                            \
     BOOT_LOG_INF("%s: magic=%s, swap_type=0x%x, copy_done=0x%x, "   \
@@ -423,7 +425,7 @@ swap_status_source(struct boot_loader_state *state)
     return BOOT_STATUS_SOURCE_NONE;
 }
 
-#ifndef MCUBOOT_OVERWRITE_ONLY
+#if !defined(MCUBOOT_OVERWRITE_ONLY) && !defined(MCUBOOT_DIRECT_XIP)
 /**
  * Calculates the number of sectors the scratch area can contain.  A "last"
  * source sector is specified because images are copied backwards in flash
@@ -622,22 +624,10 @@ boot_swap_sectors(int idx, uint32_t sz, struct boot_loader_state *state,
                 assert(rc == 0);
             }
 
-            if (swap_state.swap_type != BOOT_SWAP_TYPE_NONE) {
-                rc = boot_write_swap_info(fap_primary_slot,
-                        swap_state.swap_type, image_index);
-                assert(rc == 0);
-            }
-
-            rc = boot_write_swap_size(fap_primary_slot, bs->swap_size);
+            rc = boot_write_swap_fields(fap_primary_slot, bs,
+                                        swap_state.swap_type, image_index);
             assert(rc == 0);
 
-#ifdef MCUBOOT_ENC_IMAGES
-            rc = boot_write_enc_key(fap_primary_slot, 0, bs);
-            assert(rc == 0);
-
-            rc = boot_write_enc_key(fap_primary_slot, 1, bs);
-            assert(rc == 0);
-#endif
             rc = boot_write_magic(fap_primary_slot);
             assert(rc == 0);
         }
@@ -0,0 +1,396 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Cached validation of the image in the primary slot.
+ *
+ * With MCUBOOT_VALIDATE_PRIMARY_SLOT, the hash and signature of the image in
+ * the primary slot are checked on every boot.  Once they have been, a record
+ * is written to the trailer of the slot, below the encryption keys: the
+ * HMAC-SHA256 of the header, payload and TLV area of the image and of the
+ * stored security counter, keyed with a key derived from the device-unique
+ * key of boot_validate_cache_key_get().  The following boots only check that
+ * HMAC: the whole image is still hashed, only the signature check is saved,
+ * and nothing is written to flash.
+ *
+ * A record which does not match, e.g. one written with another device key,
+ * costs a full validation, after which the sectors holding it are erased,
+ * the flags of the trailer are written back and a new record is written.
+ * That is only done if these sectors hold no part of the image and, unless
+ * upgrades overwrite the primary slot, once the image is confirmed: the
+ * image is otherwise validated in full on every boot, until it is replaced.
+ *
+ * Without the device key, no record is written nor accepted.
+ */
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "sysflash/sysflash.h"
+#include "flash_map_backend/flash_map_backend.h"
+
+#include "bootutil/bootutil.h"
+#include "bootutil/image.h"
+#include "bootutil/sha256.h"
+#include "bootutil/security_cnt.h"
+#include "bootutil/validate_cache.h"
+#include "bootutil_priv.h"
+#include "bootutil/bootutil_log.h"
+
+#include "mcuboot_config/mcuboot_config.h"
+
+#if defined(MCUBOOT_DOUBLE_SIGN_VERIF)
+#include "boot_hal_imagevalid.h"
+#endif /* MCUBOOT_DOUBLE_SIGN_VERIF */
+
+#ifdef MCUBOOT_VALIDATE_CACHE
+
+MCUBOOT_LOG_MODULE_DECLARE(mcuboot);
+
+#define BOOT_VALIDATE_MAGIC     0x5a11da7f
+#define BOOT_VALIDATE_BUF_SZ    256
+#define BOOT_VALIDATE_KEY_SZ    32
+#define BOOT_VALIDATE_MAC_SZ    32
+#define BOOT_VALIDATE_BLOCK_SZ  64      /* SHA256 block size */
+
+struct boot_validate_rec {
+    uint32_t magic;
+    uint8_t mac[BOOT_VALIDATE_MAC_SZ];
+};
+
+#define BOOT_VALIDATE_REC_SZ \
+    ((((sizeof(struct boot_validate_rec) - 1) / BOOT_MAX_ALIGN) + 1) * \
+     BOOT_MAX_ALIGN)
+
+/* Label of the derivation of the key of the records from the device key. */
+static const uint8_t boot_validate_label[] = "MCUBOOT_VALIDATE_CACHE";
+
+uint32_t
+boot_validate_cache_sz(void)
+{
+    return BOOT_VALIDATE_REC_SZ;
+}
+
+/*
+ * Starts an HMAC-SHA256 with a key of BOOT_VALIDATE_KEY_SZ bytes.  pad is
+ * left holding the outer padded key, for boot_validate_hmac_finish().
+ */
+static void
+boot_validate_hmac_start(bootutil_sha256_context *ctx, const uint8_t *key,
+                         uint8_t *pad)
+{
+    int i;
+
+    memset(pad, 0x36, BOOT_VALIDATE_BLOCK_SZ);
+    for (i = 0; i < BOOT_VALIDATE_KEY_SZ; i++) {
+        pad[i] ^= key[i];
+    }
+    bootutil_sha256_init(ctx);
+    bootutil_sha256_update(ctx, pad, BOOT_VALIDATE_BLOCK_SZ);
+
+    for (i = 0; i < BOOT_VALIDATE_BLOCK_SZ; i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+}
+
+static void
+boot_validate_hmac_finish(bootutil_sha256_context *ctx, uint8_t *pad,
+                          uint8_t *mac)
+{
+    bootutil_sha256_finish(ctx, mac);
+    bootutil_sha256_init(ctx);
+    bootutil_sha256_update(ctx, pad, BOOT_VALIDATE_BLOCK_SZ);
+    bootutil_sha256_update(ctx, mac, BOOT_VALIDATE_MAC_SZ);
+    bootutil_sha256_finish(ctx, mac);
+    memset(pad, 0, BOOT_VALIDATE_BLOCK_SZ);
+}
+
+/*
+ * Computes the HMAC of the record of the image in the primary slot.  Returns
+ * 1 if there is no device key.
+ */
+static int
+boot_validate_mac(struct boot_loader_state *state,
+                  const struct flash_area *fap,
+                  const struct image_header *hdr, uint8_t *buf, uint8_t *mac)
+{
+    bootutil_sha256_context sha256_ctx;
+    struct image_tlv_iter it;
+    uint8_t pad[BOOT_VALIDATE_BLOCK_SZ];
+    uint8_t key[BOOT_VALIDATE_KEY_SZ];
+    uint32_t off;
+    uint32_t len;
+    int rc;
+#ifdef MCUBOOT_HW_ROLLBACK_PROT
+    uint32_t security_cnt;
+#endif
+
+#if (BOOT_IMAGE_NUMBER == 1)
+    (void)state;
+#endif
+
+    if (bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false)) {
+        return BOOT_EBADIMAGE;
+    }
+
+#ifdef MCUBOOT_HW_ROLLBACK_PROT
+    if (boot_nv_security_counter_get(BOOT_CURR_IMG(state), &security_cnt)) {
+        return BOOT_EBADIMAGE;
+    }
+#endif
+
+    /* The key of the records, derived from the device key. */
+    if (boot_validate_cache_key_get(key, sizeof(key)) != 0) {
+        memset(key, 0, sizeof(key));
+        return 1;
+    }
+    boot_validate_hmac_start(&sha256_ctx, key, pad);
+    bootutil_sha256_update(&sha256_ctx, boot_validate_label,
+                           sizeof(boot_validate_label));
+    boot_validate_hmac_finish(&sha256_ctx, pad, key);
+
+    boot_validate_hmac_start(&sha256_ctx, key, pad);
+    memset(key, 0, sizeof(key));
+
+    rc = 0;
+    for (off = 0; off < it.tlv_end; off += len) {
+        len = it.tlv_end - off;
+        if (len > BOOT_VALIDATE_BUF_SZ) {
+            len = BOOT_VALIDATE_BUF_SZ;
+        }
+        if (flash_area_read(fap, off, buf, len)) {
+            rc = BOOT_EFLASH;
+            break;
+        }
+        bootutil_sha256_update(&sha256_ctx, buf, len);
+        MCUBOOT_WATCHDOG_FEED();
+    }
+
+#ifdef MCUBOOT_HW_ROLLBACK_PROT
+    bootutil_sha256_update(&sha256_ctx, &security_cnt, sizeof(security_cnt));
+#endif
+    boot_validate_hmac_finish(&sha256_ctx, pad, mac);
+
+    return rc;
+}
+
+/*
+ * Returns 1 if the record is erased, 0 if it is not.
+ */
+static int
+boot_validate_cache_is_empty(const struct flash_area *fap, uint8_t *buf)
+{
+    uint32_t off;
+    uint32_t end;
+    uint32_t len;
+    int rc;
+
+    off = boot_validate_cache_off(fap);
+    end = off + boot_validate_cache_sz();
+    for (; off < end; off += len) {
+        len = end - off;
+        if (len > BOOT_VALIDATE_BUF_SZ) {
+            len = BOOT_VALIDATE_BUF_SZ;
+        }
+        rc = flash_area_read_is_empty(fap, off, buf, len);
+        if (rc != 1) {
+            return rc;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Erase the sectors holding the record, and write back the flags of the
+ * trailer they also hold.  Returns 1 if this cannot be done safely.
+ */
+static int
+boot_validate_cache_reset(struct boot_loader_state *state,
+                          const struct flash_area *fap,
+                          const struct image_header *hdr)
+{
+    struct boot_swap_state swap_state;
+    struct image_tlv_iter it;
+    uint32_t sect_off;
+    uint32_t off;
+    size_t sect;
+    int rc;
+
+    rc = boot_read_swap_state(fap, &swap_state);
+    if (rc != 0) {
+        return rc;
+    }
+
+#ifndef MCUBOOT_OVERWRITE_ONLY
+    /* The trailer of an image on trial is needed to revert it. */
+    if (swap_state.copy_done != BOOT_FLAG_SET ||
+        swap_state.image_ok != BOOT_FLAG_SET) {
+        return 1;
+    }
+#endif
+
+    if (bootutil_tlv_iter_begin(&it, hdr, fap, IMAGE_TLV_ANY, false)) {
+        return BOOT_EBADIMAGE;
+    }
+
+    off = boot_validate_cache_off(fap);
+    sect = boot_img_num_sectors(state, BOOT_PRIMARY_SLOT);
+    do {
+        sect--;
+        sect_off = boot_img_sector_off(state, BOOT_PRIMARY_SLOT, sect);
+    } while (sect > 0 && sect_off > off);
+
+    if (sect_off < it.tlv_end) {
+        return 1;
+    }
+
+    BOOT_LOG_INF("Resetting the validation record of the primary slot");
+    rc = boot_erase_region(fap, sect_off, fap->fa_size - sect_off);
+    if (rc != 0) {
+        return rc;
+    }
+
+    /* The magic last, so that a reset leaves no trailer rather than a
+     * partial one.
+     */
+    if (swap_state.swap_type != BOOT_SWAP_TYPE_NONE) {
+        rc = boot_write_swap_info(fap, swap_state.swap_type,
+                                  swap_state.image_num);
+    }
+    if (rc == 0 && swap_state.copy_done == BOOT_FLAG_SET) {
+        rc = boot_write_copy_done(fap);
+    }
+    if (rc == 0 && swap_state.image_ok == BOOT_FLAG_SET) {
+        rc = boot_write_image_ok(fap);
+    }
+    if (rc == 0 && swap_state.magic == BOOT_MAGIC_GOOD) {
+        rc = boot_write_magic(fap);
+    }
+
+    return rc;
+}
+
+/**
+ * Checks the image in the primary slot against its validation record.
+ *
+ * @returns 0 if the image can be booted without validating it, 1 if it must
+ *          be validated in full, < 0 on errors.
+ */
+int
+boot_validate_cache_check(struct boot_loader_state *state)
+{
+    const struct flash_area *fap;
+    struct boot_validate_rec rec;
+    struct image_header *hdr;
+    uint8_t mac[BOOT_VALIDATE_MAC_SZ];
+    uint8_t buf[BOOT_VALIDATE_BUF_SZ];
+    int rc;
+
+    rc = flash_area_open(flash_area_id_from_multi_image_slot(
+                             BOOT_CURR_IMG(state), BOOT_PRIMARY_SLOT), &fap);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    hdr = boot_img_hdr(state, BOOT_PRIMARY_SLOT);
+    rc = 1;
+    if (hdr->ih_magic != IMAGE_MAGIC ||
+        flash_area_read(fap, boot_validate_cache_off(fap), &rec, sizeof(rec)) ||
+        rec.magic != BOOT_VALIDATE_MAGIC) {
+        goto out;
+    }
+
+    if (boot_validate_mac(state, fap, hdr, buf, mac) ||
+        boot_secure_memequal(mac, rec.mac, sizeof(mac))) {
+        BOOT_LOG_INF("Image in the primary slot does not match its record");
+        goto out;
+    }
+
+#if defined(MCUBOOT_DOUBLE_SIGN_VERIF)
+    /* Stands for the signature check: the second comparison is saved in
+     * ImageValidStatus[], as the signature verification does, and checked
+     * again before jumping to the image.
+     */
+    if (ImageValidEnable == 1) {
+        if (ImageValidIndex >= MCUBOOT_IMAGE_NUMBER) {
+            goto out;
+        }
+        mac[0] ^= IMAGE_VALID;
+        ImageValidStatus[ImageValidIndex++] =
+            boot_secure_memequal(mac, rec.mac, sizeof(mac));
+    }
+#endif /* MCUBOOT_DOUBLE_SIGN_VERIF */
+
+    rc = 0;
+
+out:
+    flash_area_close(fap);
+    return rc;
+}
+
+/**
+ * Writes the validation record of the image in the primary slot, which must
+ * just have been validated in full.
+ *
+ * @returns 0 on success, 1 if the record cannot be written, < 0 on errors.
+ */
+int
+boot_validate_cache_save(struct boot_loader_state *state)
+{
+    const struct flash_area *fap;
+    struct boot_validate_rec rec;
+    struct image_header *hdr;
+    uint8_t buf[BOOT_VALIDATE_BUF_SZ];
+    int rc;
+
+    rc = flash_area_open(flash_area_id_from_multi_image_slot(
+                             BOOT_CURR_IMG(state), BOOT_PRIMARY_SLOT), &fap);
+    if (rc != 0) {
+        return BOOT_EFLASH;
+    }
+
+    hdr = boot_img_hdr(state, BOOT_PRIMARY_SLOT);
+    rc = boot_validate_cache_is_empty(fap, buf);
+    if (rc == 0) {
+        rc = boot_validate_cache_reset(state, fap, hdr);
+        if (rc != 0) {
+            goto out;
+        }
+    } else if (rc < 0) {
+        goto out;
+    }
+
+    rec.magic = BOOT_VALIDATE_MAGIC;
+    rc = boot_validate_mac(state, fap, hdr, buf, rec.mac);
+    if (rc != 0) {
+        goto out;
+    }
+
+    memset(buf, flash_area_erased_val(fap), BOOT_VALIDATE_REC_SZ);
+    memcpy(buf, &rec, sizeof(rec));
+    if (flash_area_write(fap, boot_validate_cache_off(fap), buf,
+                         BOOT_VALIDATE_REC_SZ)) {
+        rc = BOOT_EFLASH;
+    }
+
+out:
+    flash_area_close(fap);
+    return rc;
+}
+
+#endif /* MCUBOOT_VALIDATE_CACHE */
@@ -90,6 +90,24 @@ uint8_t flash_area_erased_val(const struct flash_area *fap);
 int flash_area_read_is_empty(const struct flash_area *fa, uint32_t off,
         void *dst, uint32_t len);
 
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+/*
+ * Starts writing len bytes at off, returning before the write completes.
+ * The source buffer must not change until flash_area_write_wait() returns.
+ *
+ * Returns 0 on success, or an error code on failure.
+ */
+int flash_area_write_async(const struct flash_area *fa, uint32_t off,
+                           const void *src, uint32_t len);
+
+/*
+ * Waits for the write started on the flash area to complete.
+ *
+ * Returns 0 on success, or an error code if the write failed.
+ */
+int flash_area_write_wait(const struct flash_area *fa);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,7 +42,7 @@ struct line_input {
 };
 
 static struct device *uart_dev;
-static struct line_input line_bufs[2];
+static struct line_input line_bufs[CONFIG_BOOT_LINE_BUFS];
 
 static sys_slist_t avail_queue;
 static sys_slist_t lines_queue;
@@ -0,0 +1,105 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Payload compression for images expanded by the bootloader.
+
+The output is an LZ4 block, whose match offsets are limited to the window the
+bootloader keeps in RAM (MCUBOOT_DECOMPRESS_WINDOW).
+"""
+
+DEFAULT_WINDOW = 4096
+MIN_MATCH = 4
+MAX_WINDOW = 32768
+
+
+def _put_len(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _put_sequence(out, literals, dist=None, match_len=0):
+    lit_len = len(literals)
+    ml = match_len - MIN_MATCH if dist is not None else 0
+    out.append((min(lit_len, 15) << 4) | min(ml, 15))
+    if lit_len >= 15:
+        _put_len(out, lit_len - 15)
+    out += literals
+    if dist is not None:
+        out += dist.to_bytes(2, byteorder='little')
+        if ml >= 15:
+            _put_len(out, ml - 15)
+
+
+def lz4_compress(data, window=DEFAULT_WINDOW):
+    """Compress data to an LZ4 block with offsets of at most window bytes."""
+    if window & (window - 1) or not 0 < window <= MAX_WINDOW:
+        raise ValueError("Window must be a power of two, at most {}".format(
+                         MAX_WINDOW))
+    data = bytes(data)
+    n = len(data)
+    out = bytearray()
+    last = {}
+    anchor = 0
+    i = 0
+    while i + MIN_MATCH <= n:
+        key = data[i:i + MIN_MATCH]
+        cand = last.get(key)
+        last[key] = i
+        if cand is None or i - cand > window:
+            i += 1
+            continue
+        length = MIN_MATCH
+        while i + length < n and data[cand + length] == data[i + length]:
+            length += 1
+        _put_sequence(out, data[anchor:i], i - cand, length)
+        for j in range(i + 1, min(i + length, n - MIN_MATCH + 1)):
+            last[data[j:j + MIN_MATCH]] = j
+        i += length
+        anchor = i
+    _put_sequence(out, data[anchor:])
+    return bytes(out)
+
+
+def lz4_decompress(data):
+    """Expand an LZ4 block; used to check the compressor."""
+    out = bytearray()
+    i = 0
+    n = len(data)
+
+    def get_len(base):
+        nonlocal i
+        if base == 15:
+            while True:
+                c = data[i]
+                i += 1
+                base += c
+                if c != 255:
+                    break
+        return base
+
+    while i < n:
+        token = data[i]
+        i += 1
+        lit_len = get_len(token >> 4)
+        out += data[i:i + lit_len]
+        i += lit_len
+        if i >= n:
+            break
+        dist = data[i] | (data[i + 1] << 8)
+        i += 2
+        match_len = get_len(token & 0xf) + MIN_MATCH
+        for _ in range(match_len):
+            out.append(out[-dist])
+    return bytes(out)
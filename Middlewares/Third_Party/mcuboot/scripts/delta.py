@@ -0,0 +1,137 @@
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+Patches for delta images, applied in place by the bootloader.
+
+The primary slot is rewritten a sector at a time, from the last one, so the
+operations rebuilding a sector can only copy bytes of the old image from
+that sector and the ones before it.  See boot/bootutil/src/delta.c for the
+format.
+"""
+
+import struct
+
+MAGIC = 0xde17a5e1
+OP_COPY = 0x01
+OP_DATA = 0x02
+DEFAULT_SECTOR_SIZE = 0x1000
+
+# Shorter matches are stored as data: a copy takes 9 bytes.
+MIN_COPY = 16
+MAX_CANDIDATES = 32
+
+
+def _match_len(a, ai, b, bi, limit):
+    n = 0
+    while n + 256 <= limit and a[ai + n:ai + n + 256] == b[bi + n:bi + n + 256]:
+        n += 256
+    while n < limit and a[ai + n] == b[bi + n]:
+        n += 1
+    return n
+
+
+def _sector_ops(base, target, start, end, limit, index, e):
+    """Operations producing target[start:end] from base[:limit]."""
+    out = bytearray()
+    data_start = start
+    disp = None
+    i = start
+    while i < end:
+        cands = []
+        if disp is not None:
+            # Continue the last copy after a few changed bytes.
+            cands.append(i + disp)
+        if i + MIN_COPY <= end:
+            cands.extend(reversed(index.get(target[i:i + MIN_COPY], ())))
+        best_len, best_src = 0, 0
+        for src in cands[:MAX_CANDIDATES]:
+            if src < 0 or src + MIN_COPY > limit:
+                continue
+            n = _match_len(base, src, target, i, min(end - i, limit - src))
+            if n > best_len:
+                best_len, best_src = n, src
+        if best_len < MIN_COPY:
+            i += 1
+            continue
+        if i > data_start:
+            out += struct.pack(e + 'BI', OP_DATA, i - data_start)
+            out += target[data_start:i]
+        out += struct.pack(e + 'BII', OP_COPY, best_src, best_len)
+        disp = best_src - i
+        i += best_len
+        data_start = i
+    if end > data_start:
+        out += struct.pack(e + 'BI', OP_DATA, end - data_start)
+        out += target[data_start:end]
+    return out
+
+
+def make_patch(base, target, sector_size=DEFAULT_SECTOR_SIZE,
+               endian='little'):
+    """
+    Make the patch rebuilding target from base, in a slot of sectors of
+    sector_size bytes.  base is the part of the old image covered by its
+    hash.
+    """
+    e = '<' if endian == 'little' else '>'
+    base = bytes(base)
+    target = bytes(target)
+    index = {}
+    for i in range(len(base) - MIN_COPY + 1):
+        index.setdefault(base[i:i + MIN_COPY], []).append(i)
+
+    count = (len(target) + sector_size - 1) // sector_size
+    patch = bytearray(struct.pack(e + 'IIII', MAGIC, len(base), len(target),
+                                  count))
+    for sector in reversed(range(count)):
+        start = sector * sector_size
+        end = min(start + sector_size, len(target))
+        limit = min(start + sector_size, len(base))
+        ops = _sector_ops(base, target, start, end, limit, index, e)
+        patch += struct.pack(e + 'III', start, end - start, len(ops))
+        patch += ops
+    return bytes(patch)
+
+
+def apply_patch(base, patch, sector_size=DEFAULT_SECTOR_SIZE,
+                endian='little'):
+    """Apply a patch as the bootloader does; used to check make_patch."""
+    e = '<' if endian == 'little' else '>'
+    magic, base_size, target_size, count = struct.unpack_from(e + 'IIII',
+                                                              patch)
+    assert magic == MAGIC and base_size <= len(base)
+    slot = bytearray(base[:base_size])
+    slot += bytes(max(0, target_size - len(slot)))
+    off = 16
+    for sector in reversed(range(count)):
+        start, size, length = struct.unpack_from(e + 'III', patch, off)
+        assert start == sector * sector_size
+        off += 12
+        end = off + length
+        limit = min(start + sector_size, base_size)
+        out = bytearray()
+        while off < end:
+            op = patch[off]
+            if op == OP_COPY:
+                src, n = struct.unpack_from(e + 'II', patch, off + 1)
+                assert src + n <= limit
+                out += slot[src:src + n]
+                off += 9
+            else:
+                assert op == OP_DATA
+                n, = struct.unpack_from(e + 'I', patch, off + 1)
+                out += patch[off + 5:off + 5 + n]
+                off += 5 + n
+        assert len(out) == size
+        slot[start:start + size] = out
+    return bytes(slot[:target_size])
@@ -20,6 +20,8 @@ Image signing and management.
 
 import version as versmod
 from boot_record import create_sw_component_data
+import compress
+import delta as deltamod
 import click
 from enum import Enum
 from intelhex import IntelHex
@@ -34,6 +36,7 @@ from cryptography.hazmat.primitives.serialization import Encoding, PublicFormat
 from cryptography.hazmat.backends import default_backend
 from cryptography.hazmat.primitives import hashes, hmac
 from cryptography.exceptions import InvalidSignature
+import copy
 import ctypes
 import binascii
 #specific for OTFDEC 
@@ -45,6 +48,8 @@ BIN_EXT = "bin"
 INTEL_HEX_EXT = "hex"
 DEFAULT_MAX_SECTORS = 128
 MAX_ALIGN = 8
+# Validation record of MCUBOOT_VALIDATE_CACHE: magic and HMAC-SHA256
+VALIDATE_REC_SIZE = (int((4 + 32 - 1) / MAX_ALIGN) + 1) * MAX_ALIGN
 DEP_IMAGES_KEY = "images"
 DEP_VERSIONS_KEY = "versions"
 MAX_SW_TYPE_LENGTH = 12  # Bytes
@@ -56,6 +61,8 @@ IMAGE_F = {
         'ENCRYPTED':             0x0000004,
         'OTFDEC':                0x0000008,
         'PRIMARY_ONLY':          0x0000002,
+        'COMPRESSED':            0x0000040,
+        'DELTA':                 0x0000080,
 }
 
 c_uint8 = ctypes.c_uint8
@@ -67,6 +74,9 @@ class Flags_bits(ctypes.LittleEndianStructure):
             ("encrypted", c_uint8, 1),
             ("otfdec", c_uint8, 1),
             ("non_bootable", c_uint8, 1),
+            ("ram_load", c_uint8, 1),
+            ("compressed", c_uint8, 1),
+            ("delta", c_uint8, 1),
         ]
 
 class Flags(ctypes.Union):
@@ -87,6 +97,11 @@ TLV_VALUES = {
         'DEPENDENCY': 0x40,
         'SEC_CNT': 0x50,
         'BOOT_RECORD': 0x60,
+        'DECOMP_SIZE': 0x70,
+        'DECOMP_SHA256': 0x71,
+        'DECOMP_SIGNATURE': 0x72,
+        'DELTA_BASE_SHA256': 0x73,
+        'DELTA_SHA256': 0x74,
 }
 
 TLV_SIZE = 4
@@ -144,7 +159,10 @@ class Image():
                  pad_header=False, pad=False, confirm=False, align=1,
                  slot_size=0, max_sectors=DEFAULT_MAX_SECTORS,
                  overwrite_only=False, endian="little", load_addr=0,
-                 erased_val=None, save_enctlv=False, security_counter=None, otfdec=None , primary_only=None):
+                 erased_val=None, save_enctlv=False, security_counter=None, otfdec=None , primary_only=None,
+                 compress_window=None, delta_base=None,
+                 delta_sector_size=deltamod.DEFAULT_SECTOR_SIZE,
+                 validate_cache=False):
         self.version = version or versmod.decode_version("0")
         self.header_size = header_size
         self.pad_header = pad_header
@@ -165,6 +183,12 @@ class Image():
         self.primary_only = primary_only      
         self.save_enctlv = save_enctlv
         self.enctlv_len = 0
+        self.compress_window = compress_window
+        self.decomp_tlvs = []
+        self.delta_base = delta_base
+        self.delta_sector_size = delta_sector_size
+        self.delta_tlvs = []
+        self.validate_cache = validate_cache
         if primary_only:
             self.flags = 'PRIMARY_ONLY'
         if security_counter == 'auto':
@@ -194,20 +218,26 @@ class Image():
                     self.__class__.__name__,
                     len(self.payload))
 
-    def load(self, path):
-        """Load an image from a given file"""
+    @staticmethod
+    def read_file(path):
+        """Read a binary or hex file; returns its data and base address"""
         ext = os.path.splitext(path)[1][1:].lower()
         try:
             if ext == INTEL_HEX_EXT:
                 ih = IntelHex(path)
-                self.payload = ih.tobinarray()
-                self.base_addr = ih.minaddr()
+                return ih.tobinarray(), ih.minaddr()
             else:
                 with open(path, 'rb') as f:
-                    self.payload = f.read()
+                    return f.read(), None
         except FileNotFoundError:
             raise click.UsageError("Input file not found")
 
+    def load(self, path):
+        """Load an image from a given file"""
+        self.payload, base_addr = self.read_file(path)
+        if base_addr is not None:
+            self.base_addr = base_addr
+
         # Add the image header if needed.
         if self.pad_header and self.header_size > 0:
             if self.base_addr:
@@ -235,7 +265,8 @@ class Image():
                                                   self.overwrite_only,
                                                   self.enckey,
                                                   self.save_enctlv,
-                                                  self.enctlv_len)
+                                                  self.enctlv_len,
+                                                  self.validate_cache)
                 trailer_addr = (self.base_addr + self.slot_size) - trailer_size
                 padding = bytes([self.erased_val] *
                                 (trailer_size - len(boot_magic))) + boot_magic
@@ -257,7 +288,8 @@ class Image():
         if self.slot_size > 0:
             tsize = self._trailer_size(self.align, self.max_sectors,
                                        self.overwrite_only, self.enckey,
-                                       self.save_enctlv, self.enctlv_len)
+                                       self.save_enctlv, self.enctlv_len,
+                                       self.validate_cache)
             padding = self.slot_size - (len(self.payload) + tsize)
             if padding < 0:
                 msg = "Image size (0x{:x}) + trailer (0x{:x}) exceeds " \
@@ -337,17 +369,7 @@ class Image():
             # Add the size of the TLV info header
             protected_tlv_size += TLV_INFO_SIZE
 
-        # At this point the image is already on the payload, this adds
-        # the header to the payload as well
-        self.add_header(enckey, protected_tlv_size)
-
-        prot_tlv = TLV(self.endian, TLV_PROT_INFO_MAGIC)
-
-        # Protected TLVs must be added first, because they are also included
-        # in the hash calculation
-        protected_tlv_off = None
-        if protected_tlv_size != 0:
-
+        def add_protected_tlvs(prot_tlv):
             e = STRUCT_ENDIAN_DICT[self.endian]
 
             if self.security_counter is not None:
@@ -369,6 +391,30 @@ class Image():
                                     )
                     prot_tlv.add('DEPENDENCY', payload)
 
+        if self.compress_window is not None:
+            protected_tlv_size = self.compress(key, enckey, protected_tlv_size,
+                                               add_protected_tlvs)
+
+        if self.delta_base is not None:
+            protected_tlv_size = self.delta(key, dependencies, sw_type,
+                                            protected_tlv_size)
+
+        # At this point the image is already on the payload, this adds
+        # the header to the payload as well
+        self.add_header(enckey, protected_tlv_size,
+                        compressed=self.compress_window is not None,
+                        delta=self.delta_base is not None)
+
+        prot_tlv = TLV(self.endian, TLV_PROT_INFO_MAGIC)
+
+        # Protected TLVs must be added first, because they are also included
+        # in the hash calculation
+        protected_tlv_off = None
+        if protected_tlv_size != 0:
+            add_protected_tlvs(prot_tlv)
+            for kind, payload in self.decomp_tlvs + self.delta_tlvs:
+                prot_tlv.add(kind, payload)
+
             protected_tlv_off = len(self.payload)
             self.payload += prot_tlv.get()
 
@@ -484,7 +530,85 @@ class Image():
         self.payload += tlv.get()
         self.check_trailer()
 
-    def add_header(self, enckey, protected_tlv_size, force_encrypted=False ):
+    def compress(self, key, enckey, protected_tlv_size, add_protected_tlvs):
+        """
+        Compress the payload.  The bootloader expands it into the primary
+        slot as the image would be without compression, but for the
+        encryption keys: the size, hash and signature of that image are
+        added as protected TLVs.  Returns the new size of the protected TLV
+        area.
+        """
+        e = STRUCT_ENDIAN_DICT[self.endian]
+        plain_size = len(self.payload) - self.header_size
+
+        self.add_header(enckey, protected_tlv_size)
+        prot_tlv = TLV(self.endian, TLV_PROT_INFO_MAGIC)
+        add_protected_tlvs(prot_tlv)
+        plain = bytes(self.payload) + prot_tlv.get()
+        sha = hashlib.sha256()
+        sha.update(plain)
+        digest = sha.digest()
+
+        self.decomp_tlvs = [('DECOMP_SIZE', struct.pack(e + 'I', plain_size)),
+                            ('DECOMP_SHA256', digest)]
+        if key is not None:
+            if hasattr(key, 'sign'):
+                sig = key.sign(plain)
+            else:
+                sig = key.sign_digest(digest)
+            self.decomp_tlvs.append(('DECOMP_SIGNATURE', sig))
+
+        body = bytes(self.payload[self.header_size:])
+        packed = compress.lz4_compress(body, self.compress_window)
+        assert compress.lz4_decompress(packed) == body
+        self.payload = bytes(self.payload[:self.header_size]) + packed
+
+        size = protected_tlv_size if protected_tlv_size != 0 else TLV_INFO_SIZE
+        return size + sum(TLV_SIZE + len(p) for _, p in self.decomp_tlvs)
+
+    def delta(self, key, dependencies, sw_type, protected_tlv_size):
+        """
+        Replace the payload with a patch against the signed image in the
+        delta_base file, which the bootloader applies in the primary slot
+        to rebuild this image, signed as usual.  The hashes of both images
+        are added as protected TLVs.  Returns the new size of the protected
+        TLV area.
+        """
+        e = STRUCT_ENDIAN_DICT[self.endian]
+
+        def hashed(img):
+            # Header, payload and protected TLVs.
+            hdr_size, ptlv_size, img_size = struct.unpack(e + 'HHI',
+                                                          img[8:16])
+            return bytes(img[:hdr_size + img_size + ptlv_size])
+
+        base, _ = self.read_file(self.delta_base)
+        magic, = struct.unpack(e + 'I', base[:4])
+        if magic != IMAGE_MAGIC:
+            raise click.UsageError("Delta base is not a signed image")
+        base = hashed(base)
+
+        target = copy.copy(self)
+        target.delta_base = None
+        target.payload = bytes(self.payload)
+        target.create(key, None, dependencies, sw_type)
+        full = bytes(target.payload)
+
+        patch = deltamod.make_patch(base, full, self.delta_sector_size,
+                                    self.endian)
+        assert deltamod.apply_patch(base, patch, self.delta_sector_size,
+                                    self.endian) == full
+        self.payload = bytes(self.payload[:self.header_size]) + patch
+
+        self.delta_tlvs = [
+                ('DELTA_BASE_SHA256', hashlib.sha256(base).digest()),
+                ('DELTA_SHA256', hashlib.sha256(hashed(full)).digest())]
+
+        size = protected_tlv_size if protected_tlv_size != 0 else TLV_INFO_SIZE
+        return size + sum(TLV_SIZE + len(p) for _, p in self.delta_tlvs)
+
+    def add_header(self, enckey, protected_tlv_size, force_encrypted=False,
+                   compressed=False, delta=False):
         """Install the image header."""
 
         flags = 0
@@ -497,6 +621,10 @@ class Image():
         #all specific images are flags to be able to discrimate images
         if self.flags is not None:
             flags |= IMAGE_F[self.flags]              
+        if compressed:
+            flags |= IMAGE_F['COMPRESSED']
+        if delta:
+            flags |= IMAGE_F['DELTA']
         e = STRUCT_ENDIAN_DICT[self.endian]
         fmt = (e +
                # type ImageHdr struct {
@@ -526,17 +654,21 @@ class Image():
         self.payload[:len(header)] = header
 
     def _trailer_size(self, write_size, max_sectors, overwrite_only, enckey,
-                      save_enctlv, enctlv_len):
+                      save_enctlv, enctlv_len, validate_cache=False):
         # NOTE: should already be checked by the argument parser
         magic_size = 16
-        if overwrite_only:
+        if overwrite_only and not validate_cache:
             return MAX_ALIGN * 2 + magic_size
         else:
+            # The validation record lies below the status area, which must
+            # then be accounted for even with overwrite-only upgrades.
             if write_size not in set([1, 2, 4, 8]):
                 raise click.BadParameter("Invalid alignment: {}".format(
                     write_size))
             m = DEFAULT_MAX_SECTORS if max_sectors is None else max_sectors
             trailer = m * 3 * write_size  # status area
+            if validate_cache:
+                trailer += VALIDATE_REC_SIZE  # validation record
             if enckey is not None:
                 if save_enctlv:
                     # TLV saved by the bootloader is aligned
@@ -552,7 +684,8 @@ class Image():
         """Pad the image to the given size, with the given flash alignment."""
         tsize = self._trailer_size(self.align, self.max_sectors,
                                    self.overwrite_only, self.enckey,
-                                   self.save_enctlv, self.enctlv_len)
+                                   self.save_enctlv, self.enctlv_len,
+                                   self.validate_cache)
         padding = size - (len(self.payload) + tsize)
         pbytes = bytearray([self.erased_val] * padding)
         pbytes += bytearray([self.erased_val] * (tsize - len(boot_magic)))
@@ -591,7 +724,7 @@ class Image():
             return VerifyResult.INVALID_MAGIC, None
         decodedflags = Flags()
         decodedflags.asbyte = flags
-        print("Header Flags"+decodedflags.b.primary_only*" PRIMARY_ONLY"+decodedflags.b.encrypted*" ENCRYPTED"++decodedflags.b.otfdec*" OTFDEC")
+        print("Header Flags"+decodedflags.b.primary_only*" PRIMARY_ONLY"+decodedflags.b.encrypted*" ENCRYPTED"++decodedflags.b.otfdec*" OTFDEC"+decodedflags.b.compressed*" COMPRESSED"+decodedflags.b.delta*" DELTA")
         print("################ TLV protected #################")
         tlv_info = b[header_size+img_size:header_size+img_size+TLV_INFO_SIZE]
         magic, tlv_tot = struct.unpack('HH', tlv_info)
@@ -22,6 +22,8 @@ import sys
 import keys
 import macro_parser
 import image, version
+import compress
+import delta as deltamod
 from version import decode_version
 from keys import RSAUsageError, ECDSAUsageError
 import fileinput
@@ -277,6 +279,27 @@ def get_dependencies(ctx, param, value):
               default='little', help="Select little or big endian")
 @click.option('--overwrite-only', default=False, is_flag=True,
               help='Use overwrite-only instead of swap upgrades')
+@click.option('--validate-cache', default=False, is_flag=True,
+              help='Leave room in the trailer for the validation record of '
+                   'a bootloader built with MCUBOOT_VALIDATE_CACHE')
+@click.option('--compress', default=False, is_flag=True,
+              help='Compress the payload, to be expanded by the bootloader '
+                   'while installing (requires MCUBOOT_DECOMPRESS_IMAGES and '
+                   'overwrite-only upgrades)')
+@click.option('--compress-window', type=BasedIntParamType(),
+              default=str(compress.DEFAULT_WINDOW),
+              help='Largest match distance used when compressing; must not '
+                   'exceed the MCUBOOT_DECOMPRESS_WINDOW of the bootloader '
+                   '(defaults to 4096)')
+@click.option('--delta', metavar='filename', default=None,
+              help='Signed image in the primary slot: the payload is replaced '
+                   'with a patch against it, applied by the bootloader while '
+                   'installing (requires MCUBOOT_DELTA_IMAGES and '
+                   'overwrite-only upgrades)')
+@click.option('--delta-sector-size', type=BasedIntParamType(),
+              default=hex(deltamod.DEFAULT_SECTOR_SIZE),
+              help='Sector size of the primary slot the patch is applied to '
+                   '(defaults to 0x1000)')
 @click.option('--boot-record', metavar='sw_type', help='Create CBOR encoded '
               'boot record TLV. The sw_type represents the role of the '
               'software component (e.g. CoFM for coprocessor firmware). '
@@ -319,7 +342,14 @@ def get_dependencies(ctx, param, value):
 def sign(key, align, version, pad_sig, header_size, pad_header, slot_size, pad, confirm,
          max_sectors, overwrite_only, endian, encrypt, infile, outfile,
          dependencies, load_addr, hex_addr, erased_val, save_enctlv,
-         security_counter, boot_record, otfdec, primary_only):
+         security_counter, boot_record, otfdec, primary_only, compress,
+         compress_window, delta, delta_sector_size, validate_cache):
+    if compress and (otfdec is not None or primary_only):
+        raise click.UsageError("Compression can not be combined with "
+                               "--otfdec or --primary-only")
+    if delta and (encrypt or compress or otfdec is not None or primary_only):
+        raise click.UsageError("Delta images can not be encrypted, compressed, "
+                               "or combined with --otfdec or --primary-only")
     img = image.Image(version=decode_version(version), header_size=header_size,
                       pad_header=pad_header, pad=pad, confirm=confirm,
                       align=int(align), slot_size=slot_size,
@@ -327,7 +357,10 @@ def sign(key, align, version, pad_sig, header_size, pad_header, slot_size, pad,
                       endian=endian, load_addr=load_addr, erased_val=erased_val,
                       save_enctlv=save_enctlv,
                       security_counter=security_counter,
-                      otfdec=otfdec,primary_only=primary_only)
+                      otfdec=otfdec,primary_only=primary_only,
+                      compress_window=compress_window if compress else None,
+                      delta_base=delta, delta_sector_size=delta_sector_size,
+                      validate_cache=validate_cache)
     img.load(infile)
     key = load_key(key) if key else None
     enckey = load_key(encrypt) if encrypt else None
@@ -23,6 +23,12 @@ fn main() {
     let bootstrap = env::var("CARGO_FEATURE_BOOTSTRAP").is_ok();
     let multiimage = env::var("CARGO_FEATURE_MULTIIMAGE").is_ok();
     let downgrade_prevention = env::var("CARGO_FEATURE_DOWNGRADE_PREVENTION").is_ok();
+    let hash_while_copy = env::var("CARGO_FEATURE_HASH_WHILE_COPY").is_ok();
+    let direct_xip = env::var("CARGO_FEATURE_DIRECT_XIP").is_ok();
+    let decompress = env::var("CARGO_FEATURE_DECOMPRESS").is_ok();
+    let delta = env::var("CARGO_FEATURE_DELTA").is_ok();
+    let async_write = env::var("CARGO_FEATURE_ASYNC_WRITE").is_ok();
+    let validate_cache = env::var("CARGO_FEATURE_VALIDATE_CACHE").is_ok();
 
     let mut conf = cc::Build::new();
     conf.define("__BOOTSIM__", None);
@@ -36,6 +42,46 @@ fn main() {
         panic!("Downgrade prevention requires overwrite only");
     }
 
+    if hash_while_copy && !overwrite_only {
+        panic!("Hash-while-copy requires overwrite only");
+    }
+
+    if hash_while_copy && !(sig_rsa || sig_rsa3072 || sig_ecdsa || sig_ed25519) {
+        panic!("Hash-while-copy requires a signature type");
+    }
+
+    if direct_xip && (overwrite_only || swap_move) {
+        panic!("Direct-XIP cannot be combined with another upgrade strategy");
+    }
+
+    if direct_xip && (enc_rsa || enc_kw || enc_ec256) {
+        panic!("Direct-XIP does not support encrypted images");
+    }
+
+    if direct_xip && multiimage {
+        panic!("Direct-XIP supports a single image only");
+    }
+
+    if decompress && !overwrite_only {
+        panic!("Decompression requires overwrite only");
+    }
+
+    if decompress && hash_while_copy {
+        panic!("Decompression cannot be combined with hash-while-copy");
+    }
+
+    if delta && !overwrite_only {
+        panic!("Delta images require overwrite only");
+    }
+
+    if delta && hash_while_copy {
+        panic!("Delta images cannot be combined with hash-while-copy");
+    }
+
+    if validate_cache && (!validate_primary_slot || direct_xip) {
+        panic!("The validation cache requires validate-primary-slot");
+    }
+
     if bootstrap {
         conf.define("MCUBOOT_BOOTSTRAP", None);
     }
@@ -48,6 +94,30 @@ fn main() {
         conf.define("MCUBOOT_DOWNGRADE_PREVENTION", None);
     }
 
+    if hash_while_copy {
+        conf.define("MCUBOOT_HASH_WHILE_COPY", None);
+    }
+
+    if direct_xip {
+        conf.define("MCUBOOT_DIRECT_XIP", None);
+    }
+
+    if decompress {
+        conf.define("MCUBOOT_DECOMPRESS_IMAGES", None);
+    }
+
+    if delta {
+        conf.define("MCUBOOT_DELTA_IMAGES", None);
+    }
+
+    if async_write {
+        conf.define("MCUBOOT_ASYNC_FLASH_WRITE", None);
+    }
+
+    if validate_cache {
+        conf.define("MCUBOOT_VALIDATE_CACHE", None);
+    }
+
     // Currently no more than one sig type can be used simultaneously.
     if vec![sig_rsa, sig_rsa3072, sig_ecdsa, sig_ed25519].iter()
         .fold(0, |sum, &v| sum + v as i32) > 1 {
@@ -242,6 +312,9 @@ fn main() {
     conf.file("../../boot/bootutil/src/caps.c");
     conf.file("../../boot/bootutil/src/bootutil_misc.c");
     conf.file("../../boot/bootutil/src/tlv.c");
+    conf.file("../../boot/bootutil/src/decompress.c");
+    conf.file("../../boot/bootutil/src/delta.c");
+    conf.file("../../boot/bootutil/src/validate_cache.c");
     conf.file("csupport/run.c");
     conf.include("../../boot/bootutil/include");
     conf.include("csupport");
@@ -7,6 +7,7 @@
 #include <string.h>
 #include <bootutil/bootutil.h>
 #include <bootutil/image.h>
+#include <bootutil/validate_cache.h>
 
 #include <flash_map_backend/flash_map_backend.h>
 
@@ -42,14 +43,19 @@ extern int sim_flash_read(uint8_t flash_id, uint32_t offset, uint8_t *dest,
         uint32_t size);
 extern int sim_flash_write(uint8_t flash_id, uint32_t offset, const uint8_t *src,
         uint32_t size);
+extern int sim_flash_write_async(uint8_t flash_id, uint32_t offset,
+        const uint8_t *src, uint32_t size);
+extern int sim_flash_write_wait(uint8_t flash_id, uint32_t offset);
 extern uint8_t sim_flash_align(uint8_t flash_id);
 extern uint8_t sim_flash_erased_val(uint8_t flash_id);
+extern uint8_t sim_device_key(void);
 
 struct sim_context {
     int flash_counter;
     int jumped;
     uint8_t c_asserts;
     uint8_t c_catch_asserts;
+    uint32_t boot_image_off;
     jmp_buf boot_jmpbuf;
 };
 
@@ -224,6 +230,21 @@ struct area_desc {
     uint32_t num_slots;
 };
 
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+/*
+ * The write is done when started, and the flash timing overlaps it with what
+ * follows until it is waited for.  A copy of the source buffer catches one
+ * reused before then.
+ */
+static struct {
+    const struct flash_area *area;
+    uint32_t off;
+    const void *src;
+    uint32_t len;
+    uint8_t copy[MCUBOOT_COPY_BUF_SIZE];
+} pending_write;
+#endif
+
 int invoke_boot_go(struct sim_context *ctx, struct area_desc *adesc)
 {
     int res;
@@ -239,9 +260,16 @@ int invoke_boot_go(struct sim_context *ctx, struct area_desc *adesc)
 
     sim_set_flash_areas(adesc);
     sim_set_context(ctx);
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+    /* A write in progress when the last boot was interrupted is lost. */
+    pending_write.area = NULL;
+#endif
 
     if (setjmp(ctx->boot_jmpbuf) == 0) {
         res = context_boot_go(state, &rsp);
+        if (res == 0) {
+            ctx->boot_image_off = rsp.br_image_off;
+        }
         sim_reset_flash_areas();
         sim_reset_context();
         free(state);
@@ -322,6 +350,57 @@ int flash_area_write(const struct flash_area *area, uint32_t off, const void *sr
     return sim_flash_write(area->fa_device_id, area->fa_off + off, src, len);
 }
 
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+int flash_area_write_async(const struct flash_area *area, uint32_t off,
+                           const void *src, uint32_t len)
+{
+    BOOT_LOG_SIM("%s: area=%d, off=%x, len=%x", __func__,
+                 area->fa_id, off, len);
+    struct sim_context *ctx = sim_get_context();
+    int rc;
+    if (pending_write.area != NULL) {
+        printf("Write started with another one in progress\n");
+        abort();
+    }
+    if (len > sizeof(pending_write.copy)) {
+        printf("Write larger than a copy buffer\n");
+        abort();
+    }
+    if (--(ctx->flash_counter) == 0) {
+        ctx->jumped++;
+        longjmp(ctx->boot_jmpbuf, 1);
+    }
+    rc = sim_flash_write_async(area->fa_device_id, area->fa_off + off, src,
+                               len);
+    if (rc != 0) {
+        return rc;
+    }
+    pending_write.area = area;
+    pending_write.off = off;
+    pending_write.src = src;
+    pending_write.len = len;
+    memcpy(pending_write.copy, src, len);
+    return 0;
+}
+
+int flash_area_write_wait(const struct flash_area *area)
+{
+    const struct flash_area *pending_area = pending_write.area;
+
+    if (pending_area == NULL || pending_area != area) {
+        printf("No write in progress\n");
+        abort();
+    }
+    pending_write.area = NULL;
+    if (memcmp(pending_write.src, pending_write.copy, pending_write.len) != 0) {
+        printf("Source of a write changed before the write completed\n");
+        abort();
+    }
+    return sim_flash_write_wait(pending_area->fa_device_id,
+                                pending_area->fa_off + pending_write.off);
+}
+#endif /* MCUBOOT_ASYNC_FLASH_WRITE */
+
 int flash_area_erase(const struct flash_area *area, uint32_t off, uint32_t len)
 {
     BOOT_LOG_SIM("%s: area=%d, off=%x, len=%x", __func__,
@@ -450,6 +529,15 @@ void sim_assert(int x, const char *assertion, const char *file, unsigned int lin
     }
 }
 
+#ifdef MCUBOOT_VALIDATE_CACHE
+int32_t boot_validate_cache_key_get(uint8_t *key, size_t key_size)
+{
+    /* Each simulated device has its own key. */
+    memset(key, sim_device_key(), key_size);
+    return 0;
+}
+#endif
+
 uint32_t boot_max_align(void)
 {
     return BOOT_MAX_ALIGN;
@@ -10,7 +10,7 @@ use libc;
 use log::{Level, log_enabled, warn};
 use simflash::{Result, Flash, FlashPtr};
 use std::{
-    cell::RefCell,
+    cell::{Cell, RefCell},
     collections::HashMap,
     mem,
     ptr,
@@ -54,6 +54,7 @@ pub struct CSimContext {
     pub jumped: libc::c_int,
     pub c_asserts: u8,
     pub c_catch_asserts: u8,
+    pub boot_image_off: u32,
     // NOTE: Always leave boot_jmpbuf declaration at the end; this should
     // store a "jmp_buf" which is arch specific and not defined by libc crate.
     // The size below is enough to store data on a x86_64 machine.
@@ -75,6 +76,7 @@ impl CSimContextPtr {
 thread_local! {
     pub static THREAD_CTX: RefCell<FlashContext> = RefCell::new(FlashContext::new());
     pub static SIM_CTX: RefCell<CSimContextPtr> = RefCell::new(CSimContextPtr::new());
+    pub static DEVICE_KEY: Cell<u8> = Cell::new(0);
 }
 
 // Set the flash device to be used by the simulation.  The pointer is unsafely stashed away.
@@ -178,6 +180,34 @@ pub extern fn sim_flash_write(dev_id: u8, offset: u32, src: *const u8, size: u32
     rc
 }
 
+/// A write which returns once the program is started: see `Flash::start_write()`.
+#[no_mangle]
+pub extern fn sim_flash_write_async(dev_id: u8, offset: u32, src: *const u8,
+                                    size: u32) -> libc::c_int {
+    let mut rc: libc::c_int = -19;
+    THREAD_CTX.with(|ctx| {
+        if let Some(flash) = ctx.borrow().flash_map.get(&dev_id) {
+            let buf: &[u8] = unsafe { slice::from_raw_parts(src, size as usize) };
+            let dev = unsafe { &mut *(flash.ptr) };
+            rc = map_err(dev.start_write(offset as usize, &buf));
+        }
+    });
+    rc
+}
+
+#[no_mangle]
+pub extern fn sim_flash_write_wait(dev_id: u8, offset: u32) -> libc::c_int {
+    let mut rc: libc::c_int = -19;
+    THREAD_CTX.with(|ctx| {
+        if let Some(flash) = ctx.borrow().flash_map.get(&dev_id) {
+            let dev = unsafe { &*(flash.ptr) };
+            dev.wait_write(offset as usize);
+            rc = 0;
+        }
+    });
+    rc
+}
+
 #[no_mangle]
 pub extern fn sim_flash_align(id: u8) -> u8 {
     THREAD_CTX.with(|ctx| {
@@ -202,6 +232,16 @@ fn map_err(err: Result<()>) -> libc::c_int {
     }
 }
 
+/// The device key of the validation cache, filled with this byte.
+pub fn set_device_key(key: u8) {
+    DEVICE_KEY.with(|k| k.set(key));
+}
+
+#[no_mangle]
+pub extern fn sim_device_key() -> u8 {
+    DEVICE_KEY.with(|k| k.get())
+}
+
 /// Called by C code to determine if we should log at this level.  Levels are defined in
 /// bootutil/bootutil_log.h.  This makes the logging from the C code controlled by bootsim::api, so
 /// for example, it can be enabled with something like:
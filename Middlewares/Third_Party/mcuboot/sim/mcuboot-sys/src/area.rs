@@ -124,6 +124,17 @@ impl AreaDesc {
         None
     }
 
+    // Look for the image with the given ID, and return the sectors the
+    // bootloader sees in it. Returns None if the area is not present.
+    pub fn find_sectors(&self, id: FlashId) -> Option<&[FlashArea]> {
+        for (area, whole) in self.areas.iter().zip(&self.whole) {
+            if whole.flash_id == id && !area.is_empty() {
+                return Some(area);
+            }
+        }
+        None
+    }
+
     pub fn get_c(&self) -> CAreaDesc {
         let mut areas: CAreaDesc = Default::default();
 
@@ -14,6 +14,15 @@ use crate::api;
 /// Invoke the bootloader on this flash device.
 pub fn boot_go(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc,
                counter: Option<&mut i32>, catch_asserts: bool) -> (i32, u8) {
+    let (result, asserts, _) = boot_go_image(multiflash, areadesc, counter, catch_asserts);
+    (result, asserts)
+}
+
+/// Invoke the bootloader on this flash device.  Also returns the flash offset
+/// of the image the bootloader would jump to, which is only meaningful when
+/// the result is 0.
+pub fn boot_go_image(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc,
+                     counter: Option<&mut i32>, catch_asserts: bool) -> (i32, u8, usize) {
     unsafe {
         for (&dev_id, flash) in multiflash.iter_mut() {
             api::set_flash(dev_id, flash);
@@ -27,6 +36,7 @@ pub fn boot_go(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc,
         jumped: 0,
         c_asserts: 0,
         c_catch_asserts: if catch_asserts { 1 } else { 0 },
+        boot_image_off: 0,
         boot_jmpbuf: [0; 16],
     };
     let result = unsafe {
@@ -39,7 +49,13 @@ pub fn boot_go(multiflash: &mut SimMultiFlash, areadesc: &AreaDesc,
             api::clear_flash(dev_id);
         }
     };
-    (result, asserts)
+    (result, asserts, sim_ctx.boot_image_off as usize)
+}
+
+/// Select the device key of the validation cache, for the next boots of
+/// this thread.
+pub fn set_device_key(key: u8) {
+    api::set_device_key(key);
 }
 
 pub fn boot_trailer_sz(align: u32) -> u32 {
@@ -18,6 +18,8 @@ use rand::{
     distributions::{IndependentSample, Range},
 };
 use std::{
+    cell::{Cell, RefCell},
+    cmp,
     collections::HashMap,
     fs::File,
     io::{self, Write},
@@ -59,6 +61,8 @@ unsafe impl Send for FlashPtr {}
 pub trait Flash {
     fn erase(&mut self, offset: usize, len: usize) -> Result<()>;
     fn write(&mut self, offset: usize, payload: &[u8]) -> Result<()>;
+    fn start_write(&mut self, offset: usize, payload: &[u8]) -> Result<()>;
+    fn wait_write(&self, offset: usize);
     fn read(&self, offset: usize, data: &mut [u8]) -> Result<()>;
 
     fn add_bad_region(&mut self, offset: usize, len: usize, rate: f32) -> Result<()>;
@@ -66,6 +70,11 @@ pub trait Flash {
 
     fn set_verify_writes(&mut self, enable: bool);
 
+    fn sector_stats(&self) -> Vec<SectorStats>;
+    fn flash_time(&self) -> FlashTime;
+    fn flash_ops(&self) -> Vec<FlashOp>;
+    fn reset_stats(&mut self);
+
     fn sector_iter(&self) -> SectorIter<'_>;
     fn device_size(&self) -> usize;
 
@@ -87,6 +96,143 @@ fn esimulatedwrite<T: AsRef<str>>(message: T) -> FlashError {
     FlashError::SimulatedFail(message.as_ref().to_owned())
 }
 
+/// Counts of the operations done on one sector of a flash device.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct SectorStats {
+    /// Number of bytes read from the sector.
+    pub read_bytes: usize,
+    /// Number of bytes written to the sector.
+    pub write_bytes: usize,
+    /// Number of times the sector was erased.
+    pub erases: usize,
+}
+
+/// Latencies of a flash device, used to estimate the time taken by the operations done on it.
+/// The default makes every operation instantaneous.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct FlashTiming {
+    /// Time to start a read, in nanoseconds.
+    pub read_setup_ns: u64,
+    /// Read throughput, in bytes per microsecond.
+    pub read_bytes_per_us: u64,
+    /// Size of the unit programmed at once; a shorter write still takes the time of a unit.
+    pub program_size: usize,
+    /// Time to program a unit, in nanoseconds.
+    pub program_ns: u64,
+    /// Size of the unit erased at once.
+    pub erase_size: usize,
+    /// Time to erase a unit, in nanoseconds.
+    pub erase_ns: u64,
+    /// Number of equal banks the device is split into: one bank can be read while another is
+    /// programmed or erased.  A device without read-while-write has one.
+    pub banks: usize,
+}
+
+impl FlashTiming {
+    /// STM32L5 internal flash: 2 KB pages, programmed a double word at a time, read with 5 wait
+    /// states at 110 MHz.  Typical datasheet values.
+    pub const STM32L5: FlashTiming = FlashTiming {
+        read_setup_ns: 50,
+        read_bytes_per_us: 145,
+        program_size: 8,
+        program_ns: 81_700,
+        erase_size: 2048,
+        erase_ns: 22_000_000,
+        banks: 2,
+    };
+
+    /// Macronix MX25LM51245G on the OSPI bus, 8 lines in DTR mode at 200 MHz: 256 byte pages and
+    /// 4 KB sectors.  Typical datasheet values.
+    pub const MX25LM51245G: FlashTiming = FlashTiming {
+        read_setup_ns: 150,
+        read_bytes_per_us: 400,
+        program_size: 256,
+        program_ns: 150_000,
+        erase_size: 4096,
+        erase_ns: 25_000_000,
+        banks: 1,
+    };
+
+    fn read_ns(&self, len: usize) -> u64 {
+        if self.read_bytes_per_us == 0 {
+            return 0;
+        }
+        self.read_setup_ns + (len as u64 * 1000 + self.read_bytes_per_us - 1) / self.read_bytes_per_us
+    }
+
+    fn program_ns(&self, len: usize) -> u64 {
+        if self.program_size == 0 {
+            return 0;
+        }
+        ((len + self.program_size - 1) / self.program_size) as u64 * self.program_ns
+    }
+
+    fn erase_ns(&self, len: usize) -> u64 {
+        if self.erase_size == 0 {
+            return 0;
+        }
+        ((len + self.erase_size - 1) / self.erase_size) as u64 * self.erase_ns
+    }
+}
+
+/// A timed operation on a flash device.  The devices of a thread number their operations in
+/// the order they are done, for `overlapped_ns()` to replay those of several devices.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct FlashOp {
+    /// Position of the operation among those of all the devices of the thread.
+    pub seq: u64,
+    /// Bank of the device the operation was done on.
+    pub bank: usize,
+    /// Whether the operation is a program started by `start_write()`, which the caller does
+    /// not wait for, rather than an operation that returns once complete.  A wait for such a
+    /// program is an operation of no time on its bank.
+    pub background: bool,
+    /// Time taken by the operation, in nanoseconds.
+    pub ns: u64,
+}
+
+thread_local! {
+    static FLASH_OP_SEQ: Cell<u64> = Cell::new(0);
+}
+
+/// The time the operations of the given devices take when the programs started by
+/// `start_write()` run in the background, overlapping the operations that follow on other banks
+/// and devices until they are waited for.  Each operation still waits for its bank to be idle,
+/// and the others are done one at a time, in the order they were done.  Without such programs,
+/// this is the sum of all the times.
+pub fn overlapped_ns<'a, I: IntoIterator<Item = &'a dyn Flash>>(devs: I) -> u64 {
+    let mut ops = vec![];
+    for (dev, flash) in devs.into_iter().enumerate() {
+        ops.extend(flash.flash_ops().into_iter().map(|op| (dev, op)));
+    }
+    ops.sort_by_key(|&(_, op)| op.seq);
+
+    // Time at which the next operation can be started, and at which each bank is idle.
+    let mut now = 0;
+    let mut idle = HashMap::new();
+    for (dev, op) in ops {
+        let bank = idle.entry((dev, op.bank)).or_insert(0);
+        let start = cmp::max(now, *bank);
+        *bank = start + op.ns;
+        now = if op.background { start } else { *bank };
+    }
+    idle.values().fold(now, |end, &t| cmp::max(end, t))
+}
+
+/// Time spent on a flash device by each kind of operation, according to its `FlashTiming`.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct FlashTime {
+    pub read_ns: u64,
+    pub program_ns: u64,
+    pub erase_ns: u64,
+}
+
+impl FlashTime {
+    pub fn total_ns(&self) -> u64 {
+        self.read_ns + self.program_ns + self.erase_ns
+    }
+}
+
 /// An emulated flash device.  It is represented as a block of bytes, and a list of the sector
 /// mappings.
 #[derive(Clone)]
@@ -99,6 +245,12 @@ pub struct SimFlash {
     align: usize,
     verify_writes: bool,
     erased_val: u8,
+    // Per-sector operation counts; reads only borrow the device.
+    stats: RefCell<Vec<SectorStats>>,
+    timing: FlashTiming,
+    time: Cell<FlashTime>,
+    // Timed operations, for overlapped_ns().
+    ops: RefCell<Vec<FlashOp>>,
 }
 
 impl SimFlash {
@@ -109,6 +261,7 @@ impl SimFlash {
         assert!(align & (align - 1) == 0);
 
         let total = sectors.iter().sum();
+        let stats = vec![SectorStats::default(); sectors.len()];
         SimFlash {
             data: vec![erased_val; total],
             write_safe: vec![true; total],
@@ -117,9 +270,24 @@ impl SimFlash {
             align: align,
             verify_writes: true,
             erased_val: erased_val,
+            stats: RefCell::new(stats),
+            timing: FlashTiming::default(),
+            time: Cell::new(FlashTime::default()),
+            ops: RefCell::new(Vec::new()),
         }
     }
 
+    /// Set the latencies used to account for the time taken by operations.
+    pub fn set_timing(&mut self, timing: FlashTiming) {
+        assert!(timing.banks <= 1 || self.data.len() % timing.banks == 0);
+        self.timing = timing;
+    }
+
+    /// The latencies used to account for the time taken by operations.
+    pub fn timing(&self) -> FlashTiming {
+        self.timing
+    }
+
     #[allow(dead_code)]
     pub fn dump(&self) {
         self.data.dump();
@@ -146,34 +314,56 @@ impl SimFlash {
         return None;
     }
 
-}
-
-pub type SimMultiFlash = HashMap<u8, SimFlash>;
-
-impl Flash for SimFlash {
-    /// The flash drivers tend to erase beyond the bounds of the given range.  Instead, we'll be
-    /// strict, and make sure that the passed arguments are exactly at a sector boundary, otherwise
-    /// return an error.
-    fn erase(&mut self, offset: usize, len: usize) -> Result<()> {
-        let (_start, slen) = self.get_sector(offset).ok_or_else(|| ebounds("start"))?;
-        let (end, elen) = self.get_sector(offset + len - 1).ok_or_else(|| ebounds("end"))?;
-
-        if slen != 0 {
-            bail!(ebounds("offset not at start of sector"));
-        }
-        if elen != self.sectors[end] - 1 {
-            bail!(ebounds("end not at start of sector"));
+    // Call `count` for each sector overlapping the given range, with the number of bytes of the
+    // range that fall in that sector.
+    fn account<F: Fn(&mut SectorStats, usize)>(&self, offset: usize, len: usize, count: F) {
+        let mut stats = self.stats.borrow_mut();
+        let mut base = 0;
+        for (sector, &size) in self.sectors.iter().enumerate() {
+            if base >= offset + len {
+                break;
+            }
+            let start = cmp::max(base, offset);
+            let end = cmp::min(base + size, offset + len);
+            if start < end {
+                count(&mut stats[sector], end - start);
+            }
+            base += size;
         }
+    }
 
-        for x in &mut self.data[offset .. offset + len] {
-            *x = self.erased_val;
+    // Account for an operation of the given time, started at the given offset.
+    fn account_time<F: Fn(&mut FlashTime)>(&self, offset: usize, background: bool, ns: u64,
+                                           count: F) {
+        let mut time = self.time.get();
+        count(&mut time);
+        self.time.set(time);
+
+        if ns != 0 {
+            self.push_op(offset, background, ns);
         }
+    }
 
-        for x in &mut self.write_safe[offset .. offset + len] {
-            *x = true;
+    // Account for a wait for the programs started on the bank of the given offset.
+    fn account_wait(&self, offset: usize) {
+        if self.timing.program_size != 0 {
+            self.push_op(offset, false, 0);
         }
+    }
 
-        Ok(())
+    // Record a timed operation on the bank of the given offset, for overlapped_ns().
+    fn push_op(&self, offset: usize, background: bool, ns: u64) {
+        let bank = if self.timing.banks > 1 {
+            offset / (self.data.len() / self.timing.banks)
+        } else {
+            0
+        };
+        let seq = FLASH_OP_SEQ.with(|seq| {
+            let n = seq.get();
+            seq.set(n + 1);
+            n
+        });
+        self.ops.borrow_mut().push(FlashOp { seq, bank, background, ns });
     }
 
     /// We restrict to only allowing writes of values that are:
@@ -184,7 +374,7 @@ impl Flash for SimFlash {
     /// This emulates a flash device which starts out erased, with the
     /// added restriction that repeated writes to the same location
     /// are disallowed, even if they would be safe to do.
-    fn write(&mut self, offset: usize, payload: &[u8]) -> Result<()> {
+    fn program(&mut self, offset: usize, payload: &[u8], background: bool) -> Result<()> {
         for &(off, len, rate) in &self.bad_region {
             if offset >= off && (offset + payload.len()) <= (off + len) {
                 let mut rng = rand::thread_rng();
@@ -218,8 +408,61 @@ impl Flash for SimFlash {
 
         let sub = &mut self.data[offset .. offset + payload.len()];
         sub.copy_from_slice(payload);
+
+        self.account(offset, payload.len(), |s, n| s.write_bytes += n);
+        let ns = self.timing.program_ns(payload.len());
+        self.account_time(offset, background, ns, |t| t.program_ns += ns);
+
         Ok(())
     }
+}
+
+pub type SimMultiFlash = HashMap<u8, SimFlash>;
+
+impl Flash for SimFlash {
+    /// The flash drivers tend to erase beyond the bounds of the given range.  Instead, we'll be
+    /// strict, and make sure that the passed arguments are exactly at a sector boundary, otherwise
+    /// return an error.
+    fn erase(&mut self, offset: usize, len: usize) -> Result<()> {
+        let (_start, slen) = self.get_sector(offset).ok_or_else(|| ebounds("start"))?;
+        let (end, elen) = self.get_sector(offset + len - 1).ok_or_else(|| ebounds("end"))?;
+
+        if slen != 0 {
+            bail!(ebounds("offset not at start of sector"));
+        }
+        if elen != self.sectors[end] - 1 {
+            bail!(ebounds("end not at start of sector"));
+        }
+
+        for x in &mut self.data[offset .. offset + len] {
+            *x = self.erased_val;
+        }
+
+        for x in &mut self.write_safe[offset .. offset + len] {
+            *x = true;
+        }
+
+        self.account(offset, len, |s, _| s.erases += 1);
+        let ns = self.timing.erase_ns(len);
+        self.account_time(offset, false, ns, |t| t.erase_ns += ns);
+
+        Ok(())
+    }
+
+    fn write(&mut self, offset: usize, payload: &[u8]) -> Result<()> {
+        self.program(offset, payload, false)
+    }
+
+    /// A write which returns once the program is started, for `overlapped_ns()` to overlap it
+    /// with the operations that follow until `wait_write()`.
+    fn start_write(&mut self, offset: usize, payload: &[u8]) -> Result<()> {
+        self.program(offset, payload, true)
+    }
+
+    /// Wait for the programs started on the bank of the given offset to complete.
+    fn wait_write(&self, offset: usize) {
+        self.account_wait(offset);
+    }
 
     /// Read is simple.
     fn read(&self, offset: usize, data: &mut [u8]) -> Result<()> {
@@ -229,6 +472,11 @@ impl Flash for SimFlash {
 
         let sub = &self.data[offset .. offset + data.len()];
         data.copy_from_slice(sub);
+
+        self.account(offset, data.len(), |s, n| s.read_bytes += n);
+        let ns = self.timing.read_ns(data.len());
+        self.account_time(offset, false, ns, |t| t.read_ns += ns);
+
         Ok(())
     }
 
@@ -253,6 +501,31 @@ impl Flash for SimFlash {
         self.verify_writes = enable;
     }
 
+    /// The operation counts of each sector since the device was created or the counts were
+    /// last reset.
+    fn sector_stats(&self) -> Vec<SectorStats> {
+        self.stats.borrow().clone()
+    }
+
+    /// The time taken by the operations since the device was created or the counts were last
+    /// reset.
+    fn flash_time(&self) -> FlashTime {
+        self.time.get()
+    }
+
+    /// The timed operations since the device was created or the counts were last reset.
+    fn flash_ops(&self) -> Vec<FlashOp> {
+        self.ops.borrow().clone()
+    }
+
+    fn reset_stats(&mut self) {
+        for s in self.stats.get_mut().iter_mut() {
+            *s = SectorStats::default();
+        }
+        self.time.set(FlashTime::default());
+        self.ops.get_mut().clear();
+    }
+
     /// An iterator over each sector in the device.
     fn sector_iter(&self) -> SectorIter<'_> {
         SectorIter {
@@ -311,7 +584,10 @@ impl<'a> Iterator for SectorIter<'a> {
 
 #[cfg(test)]
 mod test {
-    use super::{Flash, FlashError, SimFlash, Result, Sector};
+    use super::{
+        overlapped_ns, Flash, FlashError, FlashTime, FlashTiming, SimFlash, Result, Sector,
+        SectorStats,
+    };
 
     #[test]
     fn test_flash() {
@@ -363,6 +639,102 @@ mod test {
             assert_eq!(buf.last(), Some(&byte));
             assert!(buf[1..buf.len()-1].iter().all(|&x| x == erased_val));
         }
+
+        // Check the operation counts, including a read spanning two sectors.
+        flash.reset_stats();
+        flash.erase(0, sectors[0].size).unwrap();
+        flash.write(0, &[0x55]).unwrap();
+        let mut buf = vec![0; sectors[0].size + 1];
+        flash.read(0, &mut buf).unwrap();
+        let stats = flash.sector_stats();
+        assert_eq!(stats[0], SectorStats { read_bytes: sectors[0].size, write_bytes: 1, erases: 1 });
+        assert_eq!(stats[1], SectorStats { read_bytes: 1, write_bytes: 0, erases: 0 });
+        assert!(stats[2..].iter().all(|s| *s == SectorStats::default()));
+    }
+
+    #[test]
+    fn test_timing() {
+        let mut flash = SimFlash::new(vec![2048; 16], 8, 0xff);
+        flash.write(0, &[0; 8]).unwrap();
+        assert_eq!(flash.flash_time(), FlashTime::default());
+
+        flash.set_timing(FlashTiming::STM32L5);
+        flash.erase(0, 2 * 2048).unwrap();
+        flash.write(0, &[0; 24]).unwrap();
+        let mut buf = [0; 290];
+        flash.read(0, &mut buf).unwrap();
+        assert_eq!(flash.flash_time(), FlashTime {
+            read_ns: 50 + 2000,
+            program_ns: 3 * 81_700,
+            erase_ns: 2 * 22_000_000,
+        });
+        assert_eq!(flash.flash_time().total_ns(), 44_247_150);
+
+        flash.reset_stats();
+        assert_eq!(flash.flash_time(), FlashTime::default());
+
+        // A partial page still takes the time of a page.
+        let mut flash = SimFlash::new(vec![4096; 16], 1, 0xff);
+        flash.set_timing(FlashTiming::MX25LM51245G);
+        flash.write(0, &[0; 300]).unwrap();
+        assert_eq!(flash.flash_time().program_ns, 2 * 150_000);
+    }
+
+    #[test]
+    fn test_overlap() {
+        // Two banks of 256 KB.
+        let mut flash = SimFlash::new(vec![2048; 256], 8, 0xff);
+        flash.set_timing(FlashTiming::STM32L5);
+        let bank1 = 256 * 1024;
+        let mut buf = [0; 1024];
+
+        // Erases and writes return once complete, so nothing overlaps.
+        flash.erase(0, 2048).unwrap();
+        flash.read(bank1, &mut buf).unwrap();
+        flash.write(0, &[0; 8]).unwrap();
+        flash.read(0, &mut buf[.. 8]).unwrap();
+        assert_eq!(flash.flash_time().total_ns(), 22_000_000 + 7_113 + 81_700 + 106);
+        assert_eq!(overlapped_ns(vec![&flash as &dyn Flash]), flash.flash_time().total_ns());
+
+        // A started write overlaps a read of the other bank until it is waited for, and a read
+        // of the same bank waits for it.
+        flash.erase(0, 2048).unwrap();
+        flash.reset_stats();
+        flash.start_write(0, &[0; 8]).unwrap();
+        flash.read(bank1, &mut buf).unwrap();
+        flash.wait_write(0);
+        flash.read(bank1, &mut buf[.. 8]).unwrap();
+        assert_eq!(overlapped_ns(vec![&flash as &dyn Flash]), 81_700 + 106);
+        flash.erase(0, 2048).unwrap();
+        flash.reset_stats();
+        flash.start_write(0, &[0; 8]).unwrap();
+        flash.read(0, &mut buf[.. 8]).unwrap();
+        assert_eq!(overlapped_ns(vec![&flash as &dyn Flash]), 81_700 + 106);
+
+        // Without timing, nothing is recorded.
+        let mut plain = SimFlash::new(vec![2048; 16], 8, 0xff);
+        plain.start_write(0, &[0; 8]).unwrap();
+        plain.wait_write(0);
+        assert!(plain.flash_ops().is_empty());
+
+        // A copy from another device, reading the next chunk while the previous one is being
+        // programmed, in the order the operations were done.
+        flash.erase(0, 2048).unwrap();
+        flash.reset_stats();
+        let mut ext = SimFlash::new(vec![4096; 16], 1, 0xff);
+        ext.set_timing(FlashTiming::MX25LM51245G);
+        ext.read(0, &mut buf[.. 256]).unwrap();
+        flash.start_write(0, &buf[.. 256]).unwrap();
+        ext.read(256, &mut buf[.. 256]).unwrap();
+        flash.wait_write(0);
+        flash.start_write(256, &buf[.. 256]).unwrap();
+        flash.wait_write(256);
+        assert_eq!(overlapped_ns(vec![&flash as &dyn Flash, &ext]), 790 + 2 * 32 * 81_700);
+        assert_eq!(flash.flash_time().total_ns() + ext.flash_time().total_ns(),
+                   2 * 790 + 2 * 32 * 81_700);
+
+        flash.reset_stats();
+        assert!(flash.flash_ops().is_empty());
     }
 
     // Helper checks for the result type.
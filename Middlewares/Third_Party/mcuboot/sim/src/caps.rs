@@ -23,6 +23,12 @@ pub enum Caps {
     EncEc256             = (1 << 10),
     SwapUsingMove        = (1 << 11),
     DowngradePrevention  = (1 << 12),
+    HashWhileCopy        = (1 << 13),
+    DirectXip            = (1 << 14),
+    DecompressImages     = (1 << 15),
+    DeltaImages          = (1 << 16),
+    ValidateCache        = (1 << 17),
+    AsyncFlashWrite      = (1 << 18),
 }
 
 impl Caps {
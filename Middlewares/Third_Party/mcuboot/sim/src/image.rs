@@ -5,7 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 use byteorder::{
-    LittleEndian, WriteBytesExt,
+    ByteOrder, LittleEndian, WriteBytesExt,
 };
 use log::{
     Level::Info,
@@ -19,10 +19,12 @@ use rand::{
     Rng, SeedableRng, XorShiftRng,
 };
 use std::{
-    collections::HashSet,
+    cmp,
+    collections::{HashMap, HashSet},
     io::{Cursor, Write},
     mem,
     slice,
+    time::Instant,
 };
 use aes_ctr::{
     Aes128Ctr,
@@ -33,7 +35,7 @@ use aes_ctr::{
     },
 };
 
-use simflash::{Flash, SimFlash, SimMultiFlash};
+use simflash::{overlapped_ns, Flash, FlashTime, FlashTiming, SimFlash, SimMultiFlash};
 use mcuboot_sys::{c, AreaDesc, FlashId};
 use crate::{
     ALL_DEVICES,
@@ -49,7 +51,7 @@ use crate::depends::{
     PairDep,
     UpgradeInfo,
 };
-use crate::tlv::{ManifestGen, TlvGen, TlvFlags};
+use crate::tlv::{ManifestGen, TlvGen, TlvFlags, TlvKinds};
 
 /// A builder for Images.  This describes a single run of the simulator,
 /// capturing the configuration of a particular set of devices, including
@@ -87,6 +89,20 @@ struct ImageData {
     cipher: Option<Vec<u8>>,
 }
 
+/// The cost of the flash operations done since the stats were reset.
+struct FlashCost {
+    /// Time the operations would take on the simulated parts, with the
+    /// driver waiting for each to complete.
+    time: FlashTime,
+    /// Time they take with the programs the bootloader starts without
+    /// waiting left running in the background, see
+    /// `simflash::overlapped_ns()`.
+    overlapped_ns: u64,
+    /// Largest number of erases of a single sector, which bounds the number
+    /// of such upgrades the flash endures.
+    wear: usize,
+}
+
 impl ImagesBuilder {
     /// Construct a new image builder for the given device.  Returns
     /// Some(builder) if is possible to test this configuration, or None if
@@ -325,6 +341,45 @@ impl ImagesBuilder {
                 flash.insert(1, dev1);
                 (flash, areadesc, &[Caps::SwapUsingMove])
             }
+            DeviceName::Stm32l5 => {
+                // STM32L5 internal flash, with the timing of the part: 2 KB pages, slots in
+                // different banks.
+                let mut dev = SimFlash::new(vec![2048; 256], align as usize, erased_val);
+                dev.set_timing(FlashTiming::STM32L5);
+
+                let dev_id = 0;
+                let mut areadesc = AreaDesc::new();
+                areadesc.add_flash_sectors(dev_id, &dev);
+                areadesc.add_image(0x020000, 0x020000, FlashId::Image0, dev_id);
+                areadesc.add_image(0x040000, 0x020000, FlashId::Image1, dev_id);
+                areadesc.add_image(0x060000, 0x002000, FlashId::ImageScratch, dev_id);
+
+                let mut flash = SimMultiFlash::new();
+                flash.insert(dev_id, dev);
+                (flash, areadesc, &[])
+            }
+            DeviceName::Stm32l5Ospi => {
+                // STM32L5 with the secondary slot in an MX25LM51245G octal flash on the OSPI
+                // bus, of which only the first MB is simulated.  The 4 KB sectors of the external
+                // flash differ from the internal pages, so swap-move is not possible.
+                let mut dev0 = SimFlash::new(vec![2048; 256], align as usize, erased_val);
+                dev0.set_timing(FlashTiming::STM32L5);
+                let mut dev1 = SimFlash::new(vec![4096; 256], align as usize, erased_val);
+                dev1.set_timing(FlashTiming::MX25LM51245G);
+
+                let mut areadesc = AreaDesc::new();
+                areadesc.add_flash_sectors(0, &dev0);
+                areadesc.add_flash_sectors(1, &dev1);
+
+                areadesc.add_image(0x020000, 0x020000, FlashId::Image0, 0);
+                areadesc.add_image(0x000000, 0x020000, FlashId::Image1, 1);
+                areadesc.add_image(0x060000, 0x002000, FlashId::ImageScratch, 0);
+
+                let mut flash = SimMultiFlash::new();
+                flash.insert(0, dev0);
+                flash.insert(1, dev1);
+                (flash, areadesc, &[Caps::SwapUsingMove])
+            }
             DeviceName::K64fMulti => {
                 // NXP style flash, but larger, to support multiple images.
                 let dev = SimFlash::new(vec![4096; 256], align as usize, erased_val);
@@ -358,8 +413,9 @@ impl Images {
     pub fn run_basic_upgrade(&self, permanent: bool) -> Result<i32, ()> {
         let (flash, total_count) = self.try_upgrade(None, permanent);
         info!("Total flash operation count={}", total_count);
+        self.flash_cost(&flash, "Upgrade");
 
-        if !self.verify_images(&flash, 0, 1) {
+        if !self.verify_upgraded(&flash) {
             warn!("Image mismatch after first boot");
             Err(())
         } else {
@@ -367,6 +423,433 @@ impl Images {
         }
     }
 
+    /// Check the flash cost of an upgrade on the devices with a timing.  The
+    /// primary slots must be programmed with the whole of the upgrades.
+    /// With async flash writes, the reads of one slot overlap the writes to
+    /// the other, which is in another bank or device; without, the
+    /// bootloader waits for every operation and nothing overlaps.
+    pub fn run_flash_cost(&self) -> bool {
+        if Caps::DirectXip.present() {
+            return false;
+        }
+
+        let (flash, _) = self.try_upgrade(None, true);
+        let cost = self.flash_cost(&flash, "Upgrade");
+        if cost.time.total_ns() == 0 {
+            return false;
+        }
+
+        let mut fails = 0;
+
+        let min_program_ns: u64 = self.images.iter().map(|image| {
+            let timing = flash[&image.slots[0].dev_id].timing();
+            if timing.program_size == 0 {
+                return 0;
+            }
+            let units = (image.upgrades.plain.len() + timing.program_size - 1) /
+                timing.program_size;
+            units as u64 * timing.program_ns
+        }).sum();
+        if cost.time.program_ns < min_program_ns {
+            warn!("Programs took {} ns, less than the {} ns of the upgrades",
+                  cost.time.program_ns, min_program_ns);
+            fails += 1;
+        }
+
+        if Caps::AsyncFlashWrite.present() {
+            if cost.overlapped_ns < cost.time.read_ns ||
+                cost.overlapped_ns >= cost.time.total_ns() {
+                warn!("Overlapped flash time {} ns out of [{}, {}) ns", cost.overlapped_ns,
+                      cost.time.read_ns, cost.time.total_ns());
+                fails += 1;
+            }
+        } else if cost.overlapped_ns != cost.time.total_ns() {
+            warn!("Overlapped flash time {} ns without async writes, not {} ns",
+                  cost.overlapped_ns, cost.time.total_ns());
+            fails += 1;
+        }
+
+        if cost.wear == 0 {
+            warn!("Upgrade erased no sector");
+            fails += 1;
+        }
+
+        if !self.verify_upgraded(&flash) {
+            warn!("Image mismatch after upgrade");
+            fails += 1;
+        }
+
+        fails > 0
+    }
+
+    /// Count the flash reads of a complete upgrade.  With hash-while-copy,
+    /// the payload of the secondary slot must only be read once: the copy
+    /// itself computes the digest that is checked against the signed hash.
+    pub fn run_upgrade_flash_ops(&self) -> bool {
+        if Caps::DirectXip.present() {
+            return false;
+        }
+
+        let mut flash = self.flash.clone();
+        for dev in flash.values_mut() {
+            dev.reset_stats();
+        }
+
+        let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+        if result != 0 {
+            warn!("Failed first boot");
+            return true;
+        }
+
+        if !self.verify_upgraded(&flash) {
+            warn!("Image mismatch after upgrade");
+            return true;
+        }
+
+        let mut fails = 0;
+        for image in &self.images {
+            let slot = &image.slots[1];
+
+            // The header of the upgrade, as it was before the boot.
+            let mut hdr = [0u8; 32];
+            self.flash[&slot.dev_id].read(slot.base_off, &mut hdr).unwrap();
+            let hdr_size = hdr[8] as usize | (hdr[9] as usize) << 8;
+            let img_size = hdr[12] as usize | (hdr[13] as usize) << 8 |
+                (hdr[14] as usize) << 16 | (hdr[15] as usize) << 24;
+            let payload = slot.base_off + hdr_size .. slot.base_off + hdr_size + img_size;
+
+            let dev = &flash[&slot.dev_id];
+            let stats = dev.sector_stats();
+            let mut read_bytes = 0;
+            for sector in dev.sector_iter() {
+                if sector.base < slot.base_off || sector.base >= slot.base_off + slot.len {
+                    continue;
+                }
+                let st = &stats[sector.num];
+                read_bytes += st.read_bytes;
+
+                let inside = sector.base >= payload.start &&
+                    sector.base + sector.size <= payload.end;
+                if Caps::HashWhileCopy.present() && inside && st.read_bytes > sector.size {
+                    warn!("Sector {} of the secondary slot read {} bytes", sector.num,
+                          st.read_bytes);
+                    fails += 1;
+                }
+            }
+            info!("Upgrade of a {} byte image read {} bytes of the secondary slot",
+                  img_size, read_bytes);
+        }
+
+        fails > 0
+    }
+
+    /// Corrupt the payload of each upgrade, leaving its signed TLVs as they
+    /// are, and check that it never boots.  Without hash-while-copy, the
+    /// upgrade is rejected before the primary slot is touched, so the images
+    /// in the primary slot must still be the ones booted.  With it, the
+    /// payload is only hashed while it is copied: the mismatch is found once
+    /// the primary slot has been overwritten, and both slots must then be
+    /// left without a bootable image.
+    pub fn run_badhash_upgrade(&self) -> bool {
+        if Caps::DirectXip.present() {
+            return false;
+        }
+
+        let mut flash = self.flash.clone();
+        let mut fails = 0;
+
+        info!("Try upgrade image with bad hash");
+
+        self.mark_upgrades(&mut flash, 1);
+        for image in &self.images {
+            let slot = &image.slots[1];
+            corrupt_byte(&mut flash, slot.dev_id, slot.base_off + 0x200);
+        }
+
+        let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+        if Caps::HashWhileCopy.present() {
+            if result == 0 {
+                warn!("Booted after an upgrade with a bad hash");
+                fails += 1;
+            }
+
+            if !self.verify_erased(&flash, 0) || !self.verify_erased(&flash, 1) {
+                warn!("Image header left after an upgrade with a bad hash");
+                fails += 1;
+            }
+        } else {
+            if result != 0 {
+                warn!("Failed first boot");
+                fails += 1;
+            }
+
+            if !self.verify_images(&flash, 0, 0) {
+                warn!("Primary slot changed by an upgrade with a bad hash");
+                fails += 1;
+            }
+        }
+
+        if fails > 0 {
+            error!("Expected an upgrade failure when image has bad hash");
+        }
+
+        fails > 0
+    }
+
+    /// With decompression, check that each upgrade is stored compressed, and
+    /// that the bootloader expands it into the primary slot.
+    pub fn run_decompress_upgrade(&self) -> bool {
+        if !Caps::DecompressImages.present() {
+            return false;
+        }
+
+        let mut fails = 0;
+        for image in &self.images {
+            let slot = &image.slots[1];
+            let mut hdr = [0u8; 32];
+            self.flash[&slot.dev_id].read(slot.base_off, &mut hdr).unwrap();
+            let img_size = hdr[12] as usize | (hdr[13] as usize) << 8 |
+                (hdr[14] as usize) << 16 | (hdr[15] as usize) << 24;
+            let flags = hdr[16] as u32 | (hdr[17] as u32) << 8 |
+                (hdr[18] as u32) << 16 | (hdr[19] as u32) << 24;
+            let compressed = TlvFlags::COMPRESSED as u32;
+            if flags & compressed != compressed || img_size >= image.upgrades.plain.len() {
+                warn!("Upgrade at {:#x} is not compressed", slot.base_off);
+                fails += 1;
+            }
+        }
+
+        let mut flash = self.flash.clone();
+        let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+        if result != 0 {
+            warn!("Failed first boot");
+            fails += 1;
+        } else if !self.verify_images(&flash, 0, 1) {
+            warn!("Upgrade not expanded into the primary slot");
+            fails += 1;
+        }
+
+        fails > 0
+    }
+
+    /// With delta images, replace each upgrade by a patch of the image in the
+    /// primary slot, and check that the bootloader rebuilds the upgrade, also
+    /// when interrupted, and that a patch of another image is rejected.
+    pub fn run_delta_upgrade(&self) -> bool {
+        if !Caps::DeltaImages.present() || Caps::EncRsa.present() ||
+            Caps::EncKw.present() || Caps::EncEc256.present() {
+            return false;
+        }
+
+        let mut flash = self.flash.clone();
+        let mut bad_flash = self.flash.clone();
+        let mut targets = vec![];
+        for (i, image) in self.images.iter().enumerate() {
+            // This mapping must match that defined in
+            // `boot/zephyr/include/sysflash/sysflash.h`.
+            let id = match i {
+                0 => FlashId::Image0,
+                1 => FlashId::Image2,
+                _ => panic!("More than 2 images not supported"),
+            };
+            let sectors: Vec<usize> = self.areadesc.find_sectors(id).unwrap()
+                .iter().map(|s| s.size as usize).collect();
+            let slot = &image.slots[1];
+
+            let (target, delta) = make_delta_image(&flash, &image.primaries.plain,
+                                                   &image.upgrades.plain, &sectors,
+                                                   slot, false);
+            install_delta_image(&mut flash, slot, &delta);
+            targets.push(ImageData {
+                plain: target,
+                cipher: None,
+            });
+
+            let (_, delta) = make_delta_image(&flash, &image.primaries.plain,
+                                              &image.upgrades.plain, &sectors,
+                                              slot, true);
+            install_delta_image(&mut bad_flash, slot, &delta);
+        }
+
+        let verify_targets = |flash: &SimMultiFlash| {
+            self.images.iter().zip(&targets).all(|(image, target)| {
+                verify_image(flash, &image.slots[0], target)
+            })
+        };
+
+        let mut fails = 0;
+
+        let mut counter = 0;
+        let mut upgraded = flash.clone();
+        let (result, _) = c::boot_go(&mut upgraded, &self.areadesc, Some(&mut counter), false);
+        let total = -counter;
+        if result != 0 {
+            warn!("Failed first boot");
+            fails += 1;
+        } else if !verify_targets(&upgraded) {
+            warn!("Upgrade not rebuilt in the primary slot");
+            fails += 1;
+        }
+
+        for stop in 1 .. total {
+            let mut interrupted = flash.clone();
+            let mut counter = stop;
+            match c::boot_go(&mut interrupted, &self.areadesc, Some(&mut counter), false) {
+                (-0x13579, _) | (0, _) => (),
+                (x, _) => panic!("Unknown return: {}", x),
+            }
+            let (result, _) = c::boot_go(&mut interrupted, &self.areadesc, None, false);
+            if result != 0 || !verify_targets(&interrupted) {
+                warn!("Delta upgrade interrupted after {} of {} flash operations failed",
+                      stop, total);
+                fails += 1;
+            }
+        }
+
+        let (result, _) = c::boot_go(&mut bad_flash, &self.areadesc, None, false);
+        if result != 0 {
+            warn!("Failed boot with a patch of another image");
+            fails += 1;
+        } else if !self.verify_images(&bad_flash, 0, 0) {
+            warn!("Patch of another image applied to the primary slot");
+            fails += 1;
+        } else if !self.verify_erased(&bad_flash, 1) {
+            warn!("Patch of another image not erased");
+            fails += 1;
+        }
+
+        fails > 0
+    }
+
+    /// With the validation cache, boot the upgraded images a few times.  The
+    /// first boot validates them in full and records them, the following
+    /// ones must be accepted from the records without writing to flash.  A
+    /// record that does not match, damaged or written by another device,
+    /// only costs a full validation, after which it is replaced, keeping the
+    /// flags of the trailer, unless it shares its sector with the image.
+    /// The replacement must survive an interruption at any of its flash
+    /// operations.  An image changed after its validation must not be
+    /// booted.  The time of both kinds of boot is logged, and only
+    /// meaningful when compared on the same host.
+    pub fn run_validate_cache(&self) -> bool {
+        if !Caps::ValidateCache.present() {
+            return false;
+        }
+
+        let mut fails = 0;
+        let mut flash = self.flash.clone();
+        self.mark_permanent_upgrades(&mut flash, 1);
+
+        // The upgrade, validated in full.
+        let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+        if result != 0 || self.validate_cache_records(&flash).iter().any(|rec| rec.is_none()) {
+            warn!("Failed first boot");
+            return true;
+        }
+
+        let resettable = self.validate_cache_resettable(&flash);
+        let records = self.validate_cache_records(&flash);
+        let flags = self.read_trailer_flags(&flash);
+        let mut cached_us = vec![];
+        for _ in 0 .. VALIDATE_CACHE_BOOTS {
+            let writes = flash_writes(&flash);
+            let start = Instant::now();
+            let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+            cached_us.push(start.elapsed().as_micros());
+            if result != 0 {
+                warn!("Failed boot after {} boots from the records", cached_us.len() - 1);
+                return true;
+            }
+            if flash_writes(&flash) != writes {
+                warn!("Boot from the records wrote to flash");
+                fails += 1;
+            }
+        }
+        if !self.verify_images(&flash, 0, 1) {
+            warn!("Image mismatch after boots from the records");
+            fails += 1;
+        }
+        let cached = flash;
+
+        // Boot the records on a device with another key, twice: the second
+        // boot must use the record written by the first where it could be.
+        let mut flash = cached.clone();
+        let mut count = 0;
+        c::set_device_key(1);
+        let start = Instant::now();
+        let (result, _) = c::boot_go(&mut flash, &self.areadesc, Some(&mut count), false);
+        let full_us = start.elapsed().as_micros();
+        let writes = flash_writes(&flash);
+        let (result2, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+        c::set_device_key(0);
+        if result != 0 || result2 != 0 || !self.verify_images(&flash, 0, 1) {
+            warn!("Failed boot with the records of another device");
+            fails += 1;
+        } else if flash_writes(&flash) != writes {
+            warn!("Second boot with the records of another device wrote to flash");
+            fails += 1;
+        } else if (self.validate_cache_records(&flash) == records) == resettable {
+            warn!("Record of another device {}", if resettable { "kept" } else { "replaced" });
+            fails += 1;
+        } else if self.read_trailer_flags(&flash) != flags {
+            warn!("Trailer flags changed by the reset of the records");
+            fails += 1;
+        }
+
+        let cached_avg = cached_us.iter().sum::<u128>() / cached_us.len() as u128;
+        info!("Boot of {} image(s) from the records: {} us, validated in full: {} us",
+              self.images.len(), cached_avg, full_us);
+
+        // Interrupt the full validation replacing the records.
+        let count = if resettable { -count } else { 0 };
+        c::set_device_key(1);
+        for i in 1 ..= count {
+            info!("Try interruption of the record reset at {}", i);
+            let mut flash = cached.clone();
+            let mut counter = i;
+            match c::boot_go(&mut flash, &self.areadesc, Some(&mut counter), false) {
+                (-0x13579, _) => (),
+                (x, _) => {
+                    warn!("Should have stopped at interruption point, got {}", x);
+                    fails += 1;
+                    continue;
+                }
+            }
+            for _ in 0 .. 2 {
+                let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+                if result != 0 || !self.verify_images(&flash, 0, 1) {
+                    warn!("FAIL interrupting the record reset at {}", i);
+                    fails += 1;
+                    break;
+                }
+            }
+        }
+        c::set_device_key(0);
+
+        // Change the payload of an image whose record is valid.
+        let mut flash = cached.clone();
+        let slot = &self.images[0].slots[0];
+        corrupt_byte(&mut flash, slot.dev_id, slot.base_off + 0x200);
+        let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+        if result == 0 {
+            warn!("Changed image booted from its record");
+            fails += 1;
+        }
+
+        // Damage the HMAC of a record.
+        let mut flash = cached.clone();
+        let align = flash[&slot.dev_id].align();
+        corrupt_byte(&mut flash, slot.dev_id, self.validate_cache_off(slot, align) + 8);
+        let (result, _) = c::boot_go(&mut flash, &self.areadesc, None, false);
+        if result != 0 || !self.verify_images(&flash, 0, 1) ||
+            (resettable && self.validate_cache_records(&flash) != records) {
+            warn!("Damaged record not replaced after a full validation");
+            fails += 1;
+        }
+
+        fails > 0
+    }
+
     /// Test a simple upgrade, with dependencies given, and verify that the
     /// image does as is described in the test.
     pub fn run_check_deps(&self, deps: &DepTest) -> bool {
@@ -402,6 +885,10 @@ impl Images {
     }
 
     pub fn run_perm_with_fails(&self) -> bool {
+        if Caps::DirectXip.present() {
+            return false;
+        }
+
         let mut fails = 0;
         let total_flash_ops = self.total_count.unwrap();
 
@@ -445,6 +932,10 @@ impl Images {
     }
 
     pub fn run_perm_with_random_fails(&self, total_fails: usize) -> bool {
+        if Caps::DirectXip.present() {
+            return false;
+        }
+
         let mut fails = 0;
         let total_flash_ops = self.total_count.unwrap();
         let (flash, total_counts) = self.try_random_fails(total_flash_ops, total_fails);
@@ -503,7 +994,7 @@ impl Images {
     }
 
     pub fn run_norevert(&self) -> bool {
-        if Caps::OverwriteUpgrade.present() {
+        if Caps::OverwriteUpgrade.present() || Caps::DirectXip.present() {
             return false;
         }
 
@@ -694,6 +1185,195 @@ impl Images {
         fails > 0
     }
 
+    /// Direct-XIP: an image marked for test in the secondary slot is run in
+    /// place once.  Unless it confirms itself, it is erased on the next boot
+    /// and the image in the primary slot runs again.
+    pub fn run_direct_xip(&self) -> bool {
+        if !Caps::DirectXip.present() {
+            return false;
+        }
+
+        let mut fails = 0;
+
+        info!("Try direct-XIP test boot and revert");
+
+        let mut flash = self.flash.clone();
+        self.mark_upgrades(&mut flash, 1);
+
+        if !self.boot_direct_xip(&mut flash, 1) {
+            fails += 1;
+        }
+        if !self.verify_trailers(&flash, 1, BOOT_MAGIC_GOOD,
+                                 BOOT_FLAG_UNSET, BOOT_FLAG_SET) {
+            warn!("Mismatched trailer for the secondary slot after test boot");
+            fails += 1;
+        }
+        if !self.boot_direct_xip(&mut flash, 0) {
+            fails += 1;
+        }
+        if !self.verify_erased(&flash, 1) {
+            warn!("Unconfirmed image in the secondary slot was not erased");
+            fails += 1;
+        }
+
+        info!("Try direct-XIP test boot and confirm");
+
+        let mut flash = self.flash.clone();
+        self.mark_upgrades(&mut flash, 1);
+
+        if !self.boot_direct_xip(&mut flash, 1) {
+            fails += 1;
+        }
+        self.mark_permanent_upgrades(&mut flash, 1);
+        for _ in 0 .. 2 {
+            if !self.boot_direct_xip(&mut flash, 1) {
+                fails += 1;
+            }
+        }
+        if !self.verify_trailers(&flash, 1, BOOT_MAGIC_GOOD,
+                                 BOOT_FLAG_SET, BOOT_FLAG_SET) {
+            warn!("Mismatched trailer for the secondary slot after confirm");
+            fails += 1;
+        }
+
+        if fails > 0 {
+            error!("Error running direct-XIP test boot");
+        }
+
+        fails > 0
+    }
+
+    /// Direct-XIP with power failures: interrupt the first boot of a test
+    /// image, and the boot that reverts it, at each of their flash
+    /// operations.  A reset must resume the same sequence.
+    pub fn run_direct_xip_with_fails(&self) -> bool {
+        if !Caps::DirectXip.present() {
+            return false;
+        }
+
+        let mut fails = 0;
+
+        let mut tested = self.flash.clone();
+        self.mark_upgrades(&mut tested, 1);
+
+        // Count the flash operations of the test boot and of the revert.
+        let mut reverted = tested.clone();
+        let mut test_count = 0;
+        c::boot_go(&mut reverted, &self.areadesc, Some(&mut test_count), false);
+        let tried = reverted.clone();
+        let mut revert_count = 0;
+        c::boot_go(&mut reverted, &self.areadesc, Some(&mut revert_count), false);
+        info!("Test boot: {} flash operations, revert: {}", -test_count, -revert_count);
+
+        for i in 1 ..= -test_count {
+            info!("Try interruption of the test boot at {}", i);
+            let mut flash = tested.clone();
+            if !self.interrupt_direct_xip(&mut flash, i) ||
+                !self.boot_direct_xip(&mut flash, 1) ||
+                !self.boot_direct_xip(&mut flash, 0) {
+                warn!("FAIL interrupting the test boot at {}", i);
+                fails += 1;
+            }
+        }
+
+        for i in 1 ..= -revert_count {
+            info!("Try interruption of the revert at {}", i);
+            let mut flash = tried.clone();
+            if !self.interrupt_direct_xip(&mut flash, i) ||
+                !self.boot_direct_xip(&mut flash, 0) ||
+                !self.verify_erased(&flash, 1) {
+                warn!("FAIL interrupting the revert at {}", i);
+                fails += 1;
+            }
+        }
+
+        fails > 0
+    }
+
+    /// Boot a direct-XIP configuration, and check that it runs the image in
+    /// the given slot, and that no image has been moved.
+    fn boot_direct_xip(&self, flash: &mut SimMultiFlash, slot: usize) -> bool {
+        let (result, _, off) = c::boot_go_image(flash, &self.areadesc, None, false);
+        if result != 0 {
+            warn!("Failed boot");
+            return false;
+        }
+
+        // Direct-XIP supports a single image.
+        let expected = self.images[0].slots[slot].base_off;
+        if off != expected {
+            warn!("Booted the image at {:#x}, expected {:#x}", off, expected);
+            return false;
+        }
+
+        if !self.verify_images(flash, slot, slot) {
+            warn!("Image mismatch in the booted slot");
+            return false;
+        }
+
+        true
+    }
+
+    /// Run the bootloader, stopping it after `count` flash operations.
+    fn interrupt_direct_xip(&self, flash: &mut SimMultiFlash, count: i32) -> bool {
+        let mut counter = count;
+        match c::boot_go(flash, &self.areadesc, Some(&mut counter), false) {
+            (-0x13579, _) => true,
+            (x, _) => {
+                warn!("Should have stopped at interruption point, got {}", x);
+                false
+            }
+        }
+    }
+
+    /// Offset of the validation record in the trailer of a slot.
+    fn validate_cache_off(&self, slot: &SlotInfo, align: usize) -> usize {
+        slot.base_off + slot.len - self.trailer_sz(align) + self.status_sz(align)
+    }
+
+    /// The validation record of each image, if there is one.
+    fn validate_cache_records(&self, flash: &SimMultiFlash) -> Vec<Option<Vec<u8>>> {
+        self.images.iter().map(|image| {
+            let slot = &image.slots[0];
+            let dev = &flash[&slot.dev_id];
+            let off = self.validate_cache_off(slot, dev.align());
+            let mut rec = vec![0u8; VALIDATE_REC_SZ];
+            dev.read(off, &mut rec).unwrap();
+            if LittleEndian::read_u32(&rec) == VALIDATE_MAGIC {
+                Some(rec)
+            } else {
+                None
+            }
+        }).collect()
+    }
+
+    /// Whether the sectors holding the validation records hold no part of the
+    /// images, so that the bootloader can reset the records.
+    fn validate_cache_resettable(&self, flash: &SimMultiFlash) -> bool {
+        self.images.iter().all(|image| {
+            let slot = &image.slots[0];
+            let dev = &flash[&slot.dev_id];
+            let off = self.validate_cache_off(slot, dev.align());
+            let end = slot.base_off + image.upgrades.plain.len();
+            dev.sector_iter().any(|sector| {
+                sector.base <= off && off < sector.base + sector.size && sector.base >= end
+            })
+        })
+    }
+
+    /// The magic, image_ok, copy_done and swap_info fields of the trailers of
+    /// the primary slots.
+    fn read_trailer_flags(&self, flash: &SimMultiFlash) -> Vec<Vec<u8>> {
+        let len = c::boot_magic_sz() + 3 * c::boot_max_align();
+
+        self.images.iter().map(|image| {
+            let slot = &image.slots[0];
+            let mut flags = vec![0u8; len];
+            flash[&slot.dev_id].read(slot.base_off + slot.len - len, &mut flags).unwrap();
+            flags
+        }).collect()
+    }
+
     fn trailer_sz(&self, align: usize) -> usize {
         c::boot_trailer_sz(align as u32) as usize
     }
@@ -706,7 +1386,7 @@ impl Images {
     /// allowing for fails in the status area. This should run to the end
     /// and warn that write fails were detected...
     pub fn run_with_status_fails_complete(&self) -> bool {
-        if !Caps::ValidatePrimarySlot.present() {
+        if !Caps::ValidatePrimarySlot.present() || Caps::DirectXip.present() {
             return false;
         }
 
@@ -761,7 +1441,7 @@ impl Images {
     /// allowing for fails in the status area. This should run to the end
     /// and warn that write fails were detected...
     pub fn run_with_status_fails_with_reset(&self) -> bool {
-        if Caps::OverwriteUpgrade.present() {
+        if Caps::OverwriteUpgrade.present() || Caps::DirectXip.present() {
             false
         } else if Caps::ValidatePrimarySlot.present() {
 
@@ -865,6 +1545,9 @@ impl Images {
     fn try_upgrade(&self, stop: Option<i32>, permanent: bool) -> (SimMultiFlash, i32) {
         // Clone the flash to have a new copy.
         let mut flash = self.flash.clone();
+        for dev in flash.values_mut() {
+            dev.reset_stats();
+        }
 
         if permanent {
             self.mark_permanent_upgrades(&mut flash, 1);
@@ -891,6 +1574,34 @@ impl Images {
         (flash, count - counter)
     }
 
+    /// Compute and log the cost of the flash operations done since the stats
+    /// were reset: the time they would take on the simulated parts, split by
+    /// operation, and the wear of the most erased sector.
+    fn flash_cost(&self, flash: &SimMultiFlash, what: &str) -> FlashCost {
+        let mut time = FlashTime::default();
+        let mut wear = 0;
+        for dev in flash.values() {
+            let t = dev.flash_time();
+            time.read_ns += t.read_ns;
+            time.program_ns += t.program_ns;
+            time.erase_ns += t.erase_ns;
+            for st in dev.sector_stats() {
+                wear = cmp::max(wear, st.erases);
+            }
+        }
+        let overlapped_ns = overlapped_ns(flash.values().map(|dev| dev as &dyn Flash));
+
+        if time.total_ns() > 0 {
+            info!("{} flash time: {} us (read {} us, program {} us, erase {} us), \
+                   {} us with async writes overlapped",
+                  what, time.total_ns() / 1000, time.read_ns / 1000,
+                  time.program_ns / 1000, time.erase_ns / 1000, overlapped_ns / 1000);
+        }
+        info!("{} erased a sector at most {} time(s)", what, wear);
+
+        FlashCost { time, overlapped_ns, wear }
+    }
+
     fn try_revert(&self, count: usize) -> SimMultiFlash {
         let mut flash = self.flash.clone();
 
@@ -1044,6 +1755,27 @@ impl Images {
         })
     }
 
+    /// Verify the images after a successful upgrade.  The upgrades have been
+    /// copied to the primary slot, or with direct-XIP, are run in place.
+    fn verify_upgraded(&self, flash: &SimMultiFlash) -> bool {
+        if Caps::DirectXip.present() {
+            self.verify_images(flash, 0, 0) && self.verify_images(flash, 1, 1)
+        } else {
+            self.verify_images(flash, 0, 1)
+        }
+    }
+
+    /// Verify that the header of the image in the given slot is erased.
+    fn verify_erased(&self, flash: &SimMultiFlash, slot: usize) -> bool {
+        self.images.iter().all(|image| {
+            let slot = &image.slots[slot];
+            let dev = flash.get(&slot.dev_id).unwrap();
+            let mut hdr = [0u8; 32];
+            dev.read(slot.base_off, &mut hdr).unwrap();
+            hdr.iter().all(|&b| b == dev.erased_val())
+        })
+    }
+
     /// Verify the images, according to the dependency test.
     fn verify_dep_images(&self, flash: &SimMultiFlash, deps: &DepTest) -> bool {
         for (image_num, (image, upgrade)) in self.images.iter().zip(deps.upgrades.iter()).enumerate() {
@@ -1127,6 +1859,10 @@ fn show_flash(flash: &dyn Flash) {
 /// fields used by the given code.  Returns a copy of the image that was written.
 fn install_image(flash: &mut SimMultiFlash, slot: &SlotInfo, len: usize,
                  deps: &dyn Depender, bad_sig: bool) -> ImageData {
+    if Caps::DecompressImages.present() && slot.index == 1 {
+        return install_compressed_image(flash, slot, len, deps, bad_sig);
+    }
+
     let offset = slot.base_off;
     let slot_len = slot.len;
     let dev_id = slot.dev_id;
@@ -1277,6 +2013,444 @@ fn install_image(flash: &mut SimMultiFlash, slot: &SlotInfo, len: usize,
     }
 }
 
+/// Install a compressed upgrade.  The `plain` image is the one the bootloader
+/// expands into the primary slot, `cipher` the one written to the secondary
+/// slot (compressed, and encrypted if the configuration asks for it).
+fn install_compressed_image(flash: &mut SimMultiFlash, slot: &SlotInfo, len: usize,
+                            deps: &dyn Depender, bad_sig: bool) -> ImageData {
+    let offset = slot.base_off;
+    let dev_id = slot.dev_id;
+
+    // The expanded image carries no encryption key: it is decrypted.
+    let mut plain_tlv = make_tlv();
+    plain_tlv.drop_enc_kinds();
+    let mut plain_tlv: Box<dyn ManifestGen> = Box::new(plain_tlv);
+    let mut tlv: Box<dyn ManifestGen> = Box::new(make_tlv());
+
+    for dep in deps.my_deps(offset, slot.index) {
+        plain_tlv.add_dependency(deps.other_id(), &dep);
+        tlv.add_dependency(deps.other_id(), &dep);
+    }
+
+    const HDR_SIZE: usize = 32;
+
+    let header = ImageHeader {
+        magic: plain_tlv.get_magic(),
+        load_addr: 0,
+        hdr_size: HDR_SIZE as u16,
+        protect_tlv_size: plain_tlv.protect_size(),
+        img_size: len as u32,
+        flags: plain_tlv.get_flags(),
+        ver: deps.my_version(offset, slot.index),
+        _pad2: 0,
+    };
+
+    let mut b_header = [0; HDR_SIZE];
+    b_header[..32].clone_from_slice(header.as_raw());
+    plain_tlv.add_bytes(&b_header);
+
+    // Pseudorandom data, every other block of which repeats the previous
+    // one so that the payload compresses.
+    let mut b_img = vec![0; len];
+    splat(&mut b_img, offset);
+    for i in 0 .. len {
+        if (i / 2048) % 2 == 1 {
+            b_img[i] = b_img[i - 2048];
+        }
+    }
+    {
+        let mut wr = Cursor::new(&mut b_img);
+        writeln!(&mut wr, "offset: {:#x}, dev_id: {:#x}, slot_info: {:?}",
+                 offset, dev_id, slot).unwrap();
+        writeln!(&mut wr, "version: {:?}", deps.my_version(offset, slot.index)).unwrap();
+    }
+
+    plain_tlv.add_bytes(&b_img);
+    let b_plain_tlv = plain_tlv.make_tlv();
+
+    let dev = flash.get_mut(&dev_id).unwrap();
+    let align = dev.align();
+
+    let mut plain = vec![];
+    plain.extend_from_slice(&b_header);
+    plain.extend_from_slice(&b_img);
+    plain.extend_from_slice(&b_plain_tlv);
+    while plain.len() % align != 0 {
+        plain.push(dev.erased_val());
+    }
+
+    // The hash and signature of the expanded image go into the protected
+    // TLVs of the compressed one.
+    let mut hash = None;
+    let mut sig = None;
+    for (kind, data) in tlv_entries(&b_plain_tlv) {
+        if kind == TlvKinds::SHA256 as u16 {
+            hash = Some(data);
+        } else if kind == TlvKinds::RSA2048 as u16 || kind == TlvKinds::RSA3072 as u16 ||
+            kind == TlvKinds::ECDSA224 as u16 || kind == TlvKinds::ECDSA256 as u16 ||
+            kind == TlvKinds::ED25519 as u16 {
+            sig = Some(data);
+        }
+    }
+    tlv.set_decompressed(len as u32, hash.expect("No image hash"), sig);
+
+    let mut b_comp = lz4_compress(&b_img, DECOMPRESS_WINDOW);
+    info!("Compressed upgrade from {:#x} to {:#x} bytes", len, b_comp.len());
+
+    let header = ImageHeader {
+        magic: tlv.get_magic(),
+        load_addr: 0,
+        hdr_size: HDR_SIZE as u16,
+        protect_tlv_size: tlv.protect_size(),
+        img_size: b_comp.len() as u32,
+        flags: tlv.get_flags(),
+        ver: deps.my_version(offset, slot.index),
+        _pad2: 0,
+    };
+
+    let mut b_header = [0; HDR_SIZE];
+    b_header[..32].clone_from_slice(header.as_raw());
+    tlv.add_bytes(&b_header);
+    tlv.add_bytes(&b_comp);
+
+    let flag = TlvFlags::ENCRYPTED as u32;
+    if (tlv.get_flags() & flag) == flag {
+        tlv.generate_enc_key();
+        let enc_key = tlv.get_enc_key();
+        let key = GenericArray::from_slice(enc_key.as_slice());
+        let nonce = GenericArray::from_slice(&[0; 16]);
+        let mut cipher = Aes128Ctr::new(&key, &nonce);
+        cipher.apply_keystream(&mut b_comp);
+    }
+
+    if bad_sig {
+        tlv.corrupt_sig();
+    }
+    let b_tlv = tlv.make_tlv();
+
+    let mut buf = vec![];
+    buf.extend_from_slice(&b_header);
+    buf.append(&mut b_comp);
+    buf.extend_from_slice(&b_tlv);
+    while buf.len() % align != 0 {
+        buf.push(dev.erased_val());
+    }
+
+    dev.write(offset, &buf).unwrap();
+    let mut copy = vec![0u8; buf.len()];
+    dev.read(offset, &mut copy).unwrap();
+
+    ImageData {
+        plain: plain,
+        cipher: Some(copy),
+    }
+}
+
+/// The largest match distance of compressed images; the default of
+/// MCUBOOT_DECOMPRESS_WINDOW.
+const DECOMPRESS_WINDOW: usize = 4096;
+
+/// Boots accepted from the validation records by run_validate_cache().
+const VALIDATE_CACHE_BOOTS: usize = 4;
+
+/// Magic and size of a validation record before padding, see
+/// validate_cache.c.
+const VALIDATE_MAGIC: u32 = 0x5a11da7f;
+const VALIDATE_REC_SZ: usize = 36;
+
+/// Compress to an LZ4 block whose matches are at most `window` bytes back,
+/// like scripts/compress.py.
+fn lz4_compress(data: &[u8], window: usize) -> Vec<u8> {
+    const MIN_MATCH: usize = 4;
+
+    fn put_len(out: &mut Vec<u8>, mut n: usize) {
+        while n >= 255 {
+            out.push(255);
+            n -= 255;
+        }
+        out.push(n as u8);
+    }
+
+    fn put_sequence(out: &mut Vec<u8>, literals: &[u8], dist: usize, match_len: usize) {
+        let ml = if dist > 0 { match_len - MIN_MATCH } else { 0 };
+        out.push(((cmp::min(literals.len(), 15) << 4) | cmp::min(ml, 15)) as u8);
+        if literals.len() >= 15 {
+            put_len(out, literals.len() - 15);
+        }
+        out.extend_from_slice(literals);
+        if dist > 0 {
+            out.write_u16::<LittleEndian>(dist as u16).unwrap();
+            if ml >= 15 {
+                put_len(out, ml - 15);
+            }
+        }
+    }
+
+    let n = data.len();
+    let mut out = vec![];
+    let mut last: HashMap<&[u8], usize> = HashMap::new();
+    let mut anchor = 0;
+    let mut i = 0;
+    while i + MIN_MATCH <= n {
+        let cand = match last.insert(&data[i .. i + MIN_MATCH], i) {
+            Some(c) if i - c <= window => c,
+            _ => {
+                i += 1;
+                continue;
+            }
+        };
+        let mut length = MIN_MATCH;
+        while i + length < n && data[cand + length] == data[i + length] {
+            length += 1;
+        }
+        put_sequence(&mut out, &data[anchor .. i], i - cand, length);
+        for j in i + 1 .. cmp::min(i + length, n - MIN_MATCH + 1) {
+            last.insert(&data[j .. j + MIN_MATCH], j);
+        }
+        i += length;
+        anchor = i;
+    }
+    put_sequence(&mut out, &data[anchor ..], 0, 0);
+    out
+}
+
+/// Build an upgrade from `base`, the image in the primary slot, with the
+/// version of `upgrade`, and the delta image rebuilding it from `base` in a
+/// primary slot made of `sectors`.  With `bad_base`, the patch applies to an
+/// image differing from `base`.  Returns the upgrade and the delta image.
+fn make_delta_image(flash: &SimMultiFlash, base: &[u8], upgrade: &[u8], sectors: &[usize],
+                    slot: &SlotInfo, bad_base: bool) -> (Vec<u8>, Vec<u8>) {
+    const HDR_SIZE: usize = 32;
+
+    let get_u16 = |b: &[u8], off: usize| b[off] as usize | (b[off + 1] as usize) << 8;
+    let get_u32 = |b: &[u8], off: usize| get_u16(b, off) | get_u16(b, off + 2) << 16;
+
+    let dev = &flash[&slot.dev_id];
+    let align = dev.align();
+
+    // The part of the base image covered by its hash.
+    let base_img_end = get_u16(base, 8) + get_u32(base, 12);
+    let base_size = base_img_end + get_u16(base, 10);
+    let mut base_hash = None;
+    for (kind, data) in tlv_entries(&base[base_img_end ..]) {
+        if kind == TlvKinds::SHA256 as u16 {
+            base_hash = Some(data.to_vec());
+        }
+    }
+    let mut base_hash = base_hash.expect("No image hash");
+    if bad_base {
+        base_hash[0] ^= 0x01;
+    }
+
+    // The payload of the base image, with bytes inserted, changed and
+    // removed.
+    let payload = &base[get_u16(base, 8) .. base_img_end];
+    let len = payload.len();
+    let mut b_img = vec![];
+    b_img.extend_from_slice(&payload[.. len / 3]);
+    let mut inserted = vec![0; 100];
+    splat(&mut inserted, slot.base_off);
+    b_img.extend_from_slice(&inserted);
+    b_img.extend_from_slice(&payload[len / 3 .. len - 100]);
+    for i in 0 .. 8 {
+        b_img[2 * len / 3 + 64 * i] ^= 0x5a;
+    }
+
+    let mut tlv: Box<dyn ManifestGen> = Box::new(make_tlv());
+
+    let header = ImageHeader {
+        magic: tlv.get_magic(),
+        load_addr: 0,
+        hdr_size: HDR_SIZE as u16,
+        protect_tlv_size: tlv.protect_size(),
+        img_size: b_img.len() as u32,
+        flags: tlv.get_flags(),
+        ver: ImageVersion {
+            major: upgrade[20],
+            minor: upgrade[21],
+            revision: get_u16(upgrade, 22) as u16,
+            build_num: get_u32(upgrade, 24) as u32,
+        },
+        _pad2: 0,
+    };
+
+    let mut b_header = [0; HDR_SIZE];
+    b_header[..32].clone_from_slice(header.as_raw());
+    tlv.add_bytes(&b_header);
+    tlv.add_bytes(&b_img);
+    let b_tlv = tlv.make_tlv();
+
+    let mut target = vec![];
+    target.extend_from_slice(&b_header);
+    target.extend_from_slice(&b_img);
+    target.extend_from_slice(&b_tlv);
+
+    let mut hash = None;
+    for (kind, data) in tlv_entries(&b_tlv) {
+        if kind == TlvKinds::SHA256 as u16 {
+            hash = Some(data);
+        }
+    }
+
+    let mut b_patch = delta_patch(&base[.. base_size], &target, sectors);
+    info!("Patch of {:#x} bytes for a {:#x} byte upgrade", b_patch.len(), target.len());
+
+    while target.len() % align != 0 {
+        target.push(dev.erased_val());
+    }
+
+    let mut tlv: Box<dyn ManifestGen> = Box::new(make_tlv());
+    tlv.set_delta(&base_hash, hash.expect("No image hash"));
+
+    let header = ImageHeader {
+        protect_tlv_size: tlv.protect_size(),
+        img_size: b_patch.len() as u32,
+        flags: tlv.get_flags(),
+        ..header
+    };
+
+    b_header[..32].clone_from_slice(header.as_raw());
+    tlv.add_bytes(&b_header);
+    tlv.add_bytes(&b_patch);
+    let b_tlv = tlv.make_tlv();
+
+    let mut delta = vec![];
+    delta.extend_from_slice(&b_header);
+    delta.append(&mut b_patch);
+    delta.extend_from_slice(&b_tlv);
+    while delta.len() % align != 0 {
+        delta.push(dev.erased_val());
+    }
+
+    (target, delta)
+}
+
+/// Replace the image in the given slot by a delta image, and mark it as an
+/// upgrade.
+fn install_delta_image(flash: &mut SimMultiFlash, slot: &SlotInfo, delta: &[u8]) {
+    let dev = flash.get_mut(&slot.dev_id).unwrap();
+    dev.erase(slot.base_off, slot.len).unwrap();
+    dev.write(slot.base_off, delta).unwrap();
+    mark_upgrade(flash, slot);
+}
+
+/// Make the patch rebuilding `target` from `base` in a primary slot made of
+/// `sectors`, like scripts/delta.py.  The sectors are rewritten from the last
+/// one, so the bytes of a sector can only be copied from the base image in
+/// that sector and the ones before it.
+fn delta_patch(base: &[u8], target: &[u8], sectors: &[usize]) -> Vec<u8> {
+    const MAGIC: u32 = 0xde17a5e1;
+    const OP_COPY: u8 = 0x01;
+    const OP_DATA: u8 = 0x02;
+    const MIN_COPY: usize = 16;
+    const MAX_CANDIDATES: usize = 32;
+
+    fn match_len(a: &[u8], b: &[u8]) -> usize {
+        a.iter().zip(b).take_while(|(x, y)| x == y).count()
+    }
+
+    fn put_data(out: &mut Vec<u8>, data: &[u8]) {
+        if !data.is_empty() {
+            out.push(OP_DATA);
+            out.write_u32::<LittleEndian>(data.len() as u32).unwrap();
+            out.extend_from_slice(data);
+        }
+    }
+
+    let mut index: HashMap<&[u8], Vec<usize>> = HashMap::new();
+    for i in 0 .. (base.len() + 1).saturating_sub(MIN_COPY) {
+        index.entry(&base[i .. i + MIN_COPY]).or_insert_with(Vec::new).push(i);
+    }
+
+    let mut chunks = vec![];
+    let mut start = 0;
+    for &size in sectors {
+        if start >= target.len() {
+            break;
+        }
+        let end = cmp::min(start + size, target.len());
+        let limit = cmp::min(start + size, base.len());
+
+        let mut ops = vec![];
+        let mut data_start = start;
+        let mut disp: Option<isize> = None;
+        let mut i = start;
+        while i < end {
+            // Continue the last copy after a few changed bytes.
+            let mut cands = vec![];
+            if let Some(disp) = disp {
+                cands.push(i as isize + disp);
+            }
+            if i + MIN_COPY <= end {
+                if let Some(found) = index.get(&target[i .. i + MIN_COPY]) {
+                    cands.extend(found.iter().rev().map(|&c| c as isize));
+                }
+            }
+            let (mut best_len, mut best_src) = (0, 0);
+            for &src in cands.iter().take(MAX_CANDIDATES) {
+                if src < 0 || src as usize + MIN_COPY > limit {
+                    continue;
+                }
+                let src = src as usize;
+                let n = match_len(&base[src .. limit], &target[i .. end]);
+                if n > best_len {
+                    best_len = n;
+                    best_src = src;
+                }
+            }
+            if best_len < MIN_COPY {
+                i += 1;
+                continue;
+            }
+            put_data(&mut ops, &target[data_start .. i]);
+            ops.push(OP_COPY);
+            ops.write_u32::<LittleEndian>(best_src as u32).unwrap();
+            ops.write_u32::<LittleEndian>(best_len as u32).unwrap();
+            disp = Some(best_src as isize - i as isize);
+            i += best_len;
+            data_start = i;
+        }
+        put_data(&mut ops, &target[data_start .. end]);
+
+        chunks.push((start, end - start, ops));
+        start += size;
+    }
+
+    let mut patch = vec![];
+    patch.write_u32::<LittleEndian>(MAGIC).unwrap();
+    patch.write_u32::<LittleEndian>(base.len() as u32).unwrap();
+    patch.write_u32::<LittleEndian>(target.len() as u32).unwrap();
+    patch.write_u32::<LittleEndian>(chunks.len() as u32).unwrap();
+    for (off, size, ops) in chunks.iter().rev() {
+        patch.write_u32::<LittleEndian>(*off as u32).unwrap();
+        patch.write_u32::<LittleEndian>(*size as u32).unwrap();
+        patch.write_u32::<LittleEndian>(ops.len() as u32).unwrap();
+        patch.extend_from_slice(ops);
+    }
+    patch
+}
+
+/// Return the kinds and values of the unprotected TLVs of a manifest.
+fn tlv_entries(b_tlv: &[u8]) -> Vec<(u16, &[u8])> {
+    let get_u16 = |off: usize| (b_tlv[off] as u16) | ((b_tlv[off + 1] as u16) << 8);
+
+    let mut off = 0;
+    if get_u16(0) == 0x6908 {
+        off = get_u16(2) as usize;
+    }
+    assert_eq!(get_u16(off), 0x6907);
+    let end = off + get_u16(off + 2) as usize;
+    off += 4;
+
+    let mut entries = vec![];
+    while off < end {
+        let len = get_u16(off + 2) as usize;
+        entries.push((get_u16(off), &b_tlv[off + 4 .. off + 4 + len]));
+        off += 4 + len;
+    }
+    entries
+}
+
 /// Install no image.  This is used when no upgrade happens.
 fn install_no_image() -> ImageData {
     ImageData {
@@ -1330,8 +2504,9 @@ impl ImageData {
     /// Find the image contents for the given slot.  This assumes that slot 0
     /// is unencrypted, and slot 1 is encrypted.
     fn find(&self, slot: usize) -> &Vec<u8> {
+        // Compressed upgrades are also stored as `cipher`.
         let encrypted = Caps::EncRsa.present() || Caps::EncKw.present() ||
-            Caps::EncEc256.present();
+            Caps::EncEc256.present() || Caps::DecompressImages.present();
         match (encrypted, slot) {
             (false, _) => &self.plain,
             (true, 0) => &self.plain,
@@ -1562,6 +2737,28 @@ fn mark_permanent_upgrade(flash: &mut SimMultiFlash, slot: &SlotInfo) {
     dev.write(off, &ok[..align]).unwrap();
 }
 
+/// Flip a bit of the byte at `offset` of a device, rewriting it in place.
+fn corrupt_byte(flash: &mut SimMultiFlash, dev_id: u8, offset: usize) {
+    let dev = flash.get_mut(&dev_id).unwrap();
+    let align = dev.align();
+    let base = offset - (offset % align);
+    let mut buf = vec![0u8; align];
+    dev.read(base, &mut buf).unwrap();
+    buf[offset - base] ^= 1;
+    dev.set_verify_writes(false);
+    dev.write(base, &buf).unwrap();
+    dev.set_verify_writes(true);
+}
+
+/// The number of bytes written and sectors erased on the devices since their
+/// stats were last reset.
+fn flash_writes(flash: &SimMultiFlash) -> usize {
+    flash.values()
+        .flat_map(|dev| dev.sector_stats())
+        .map(|st| st.write_bytes + st.erases)
+        .sum()
+}
+
 // Drop some pseudo-random gibberish onto the data.
 fn splat(data: &mut [u8], seed: usize) {
     let seed_block = [0x135782ea, 0x92184728, data.len() as u32, seed as u32];
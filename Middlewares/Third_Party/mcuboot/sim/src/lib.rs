@@ -62,7 +62,9 @@ struct Args {
 }
 
 #[derive(Copy, Clone, Debug, Deserialize)]
-pub enum DeviceName { Stm32f4, K64f, K64fBig, K64fMulti, Nrf52840, Nrf52840SpiFlash, }
+pub enum DeviceName {
+    Stm32f4, K64f, K64fBig, K64fMulti, Nrf52840, Nrf52840SpiFlash, Stm32l5, Stm32l5Ospi,
+}
 
 pub static ALL_DEVICES: &'static [DeviceName] = &[
     DeviceName::Stm32f4,
@@ -71,6 +73,8 @@ pub static ALL_DEVICES: &'static [DeviceName] = &[
     DeviceName::K64fMulti,
     DeviceName::Nrf52840,
     DeviceName::Nrf52840SpiFlash,
+    DeviceName::Stm32l5,
+    DeviceName::Stm32l5Ospi,
 ];
 
 impl fmt::Display for DeviceName {
@@ -82,6 +86,8 @@ impl fmt::Display for DeviceName {
             DeviceName::K64fMulti => "k64fmulti",
             DeviceName::Nrf52840 => "nrf52840",
             DeviceName::Nrf52840SpiFlash => "Nrf52840SpiFlash",
+            DeviceName::Stm32l5 => "stm32l5",
+            DeviceName::Stm32l5Ospi => "stm32l5ospi",
         };
         f.write_str(name)
     }
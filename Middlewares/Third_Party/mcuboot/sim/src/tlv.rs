@@ -54,6 +54,11 @@ pub enum TlvKinds {
     ENCKW128 = 0x31,
     ENCEC256 = 0x32,
     DEPENDENCY = 0x40,
+    DECOMP_SIZE = 0x70,
+    DECOMP_SHA256 = 0x71,
+    DECOMP_SIGNATURE = 0x72,
+    DELTA_BASE_SHA256 = 0x73,
+    DELTA_SHA256 = 0x74,
 }
 
 #[allow(dead_code, non_camel_case_types)]
@@ -62,6 +67,8 @@ pub enum TlvFlags {
     NON_BOOTABLE = 0x02,
     ENCRYPTED = 0x04,
     RAM_LOAD = 0x20,
+    COMPRESSED = 0x40,
+    DELTA = 0x80,
 }
 
 /// A generator for manifests.  The format of the manifest can be either a
@@ -81,6 +88,14 @@ pub trait ManifestGen {
     /// Add a dependency on another image.
     fn add_dependency(&mut self, id: u8, version: &ImageVersion);
 
+    /// Mark the payload as compressed, recording the size of the image it
+    /// expands to, and the hash and signature of that image.
+    fn set_decompressed(&mut self, size: u32, hash: &[u8], sig: Option<&[u8]>);
+
+    /// Mark the payload as a patch, recording the hashes of the image it
+    /// applies to and of the image it rebuilds.
+    fn set_delta(&mut self, base_hash: &[u8], hash: &[u8]);
+
     /// Add a sequence of bytes to the payload that the manifest is
     /// protecting.
     fn add_bytes(&mut self, bytes: &[u8]);
@@ -105,6 +120,10 @@ pub struct TlvGen {
     kinds: Vec<TlvKinds>,
     payload: Vec<u8>,
     dependencies: Vec<Dependency>,
+    /// The protected DECOMP_* TLVs of a compressed image.
+    decomp: Vec<u8>,
+    /// The protected DELTA_* TLVs of a delta image.
+    delta: Vec<u8>,
     enc_key: Vec<u8>,
     /// Should this signature be corrupted.
     gen_corrupted: bool,
@@ -119,6 +138,15 @@ struct Dependency {
 const AES_KEY_LEN: usize = 16;
 
 impl TlvGen {
+    /// Remove the encryption key TLVs, leaving the encrypted flag: this is the
+    /// manifest of an image decrypted into the primary slot.
+    pub fn drop_enc_kinds(&mut self) {
+        self.kinds.retain(|k| match k {
+            TlvKinds::ENCRSA2048 | TlvKinds::ENCKW128 | TlvKinds::ENCEC256 => false,
+            _ => true,
+        });
+    }
+
     /// Construct a new tlv generator that will only contain a hash of the data.
     #[allow(dead_code)]
     pub fn new_hash_only() -> TlvGen {
@@ -240,11 +268,12 @@ impl ManifestGen for TlvGen {
     }
 
     fn protect_size(&self) -> u16 {
-        if self.dependencies.is_empty() {
+        if self.dependencies.is_empty() && self.decomp.is_empty() && self.delta.is_empty() {
             0
         } else {
             // Include the header and space for each dependency.
-            4 + (self.dependencies.len() as u16) * (4 + 4 + 8)
+            4 + (self.dependencies.len() as u16) * (4 + 4 + 8) +
+                self.decomp.len() as u16 + self.delta.len() as u16
         }
     }
 
@@ -255,6 +284,36 @@ impl ManifestGen for TlvGen {
         });
     }
 
+    fn set_decompressed(&mut self, size: u32, hash: &[u8], sig: Option<&[u8]>) {
+        self.flags |= TlvFlags::COMPRESSED as u32;
+
+        self.decomp.write_u16::<LittleEndian>(TlvKinds::DECOMP_SIZE as u16).unwrap();
+        self.decomp.write_u16::<LittleEndian>(4).unwrap();
+        self.decomp.write_u32::<LittleEndian>(size).unwrap();
+
+        self.decomp.write_u16::<LittleEndian>(TlvKinds::DECOMP_SHA256 as u16).unwrap();
+        self.decomp.write_u16::<LittleEndian>(hash.len() as u16).unwrap();
+        self.decomp.extend_from_slice(hash);
+
+        if let Some(sig) = sig {
+            self.decomp.write_u16::<LittleEndian>(TlvKinds::DECOMP_SIGNATURE as u16).unwrap();
+            self.decomp.write_u16::<LittleEndian>(sig.len() as u16).unwrap();
+            self.decomp.extend_from_slice(sig);
+        }
+    }
+
+    fn set_delta(&mut self, base_hash: &[u8], hash: &[u8]) {
+        self.flags |= TlvFlags::DELTA as u32;
+
+        self.delta.write_u16::<LittleEndian>(TlvKinds::DELTA_BASE_SHA256 as u16).unwrap();
+        self.delta.write_u16::<LittleEndian>(base_hash.len() as u16).unwrap();
+        self.delta.extend_from_slice(base_hash);
+
+        self.delta.write_u16::<LittleEndian>(TlvKinds::DELTA_SHA256 as u16).unwrap();
+        self.delta.write_u16::<LittleEndian>(hash.len() as u16).unwrap();
+        self.delta.extend_from_slice(hash);
+    }
+
     fn corrupt_sig(&mut self) {
         self.gen_corrupted = true;
     }
@@ -283,6 +342,9 @@ impl ManifestGen for TlvGen {
                 protected_tlv.write_u32::<LittleEndian>(dep.version.build_num).unwrap();
             }
 
+            protected_tlv.extend_from_slice(&self.decomp);
+            protected_tlv.extend_from_slice(&self.delta);
+
             assert_eq!(size, protected_tlv.len() as u16, "protected TLV length incorrect");
         }
 
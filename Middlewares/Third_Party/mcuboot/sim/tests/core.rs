@@ -56,6 +56,14 @@ sim_test!(norevert, make_image(&NO_DEPS, true), run_norevert());
 sim_test!(status_write_fails_complete, make_image(&NO_DEPS, true), run_with_status_fails_complete());
 sim_test!(status_write_fails_with_reset, make_image(&NO_DEPS, true), run_with_status_fails_with_reset());
 sim_test!(downgrade_prevention, make_image(&REV_DEPS, true), run_nodowngrade());
+sim_test!(flash_cost, make_image(&NO_DEPS, true), run_flash_cost());
+sim_test!(upgrade_flash_ops, make_image(&NO_DEPS, true), run_upgrade_flash_ops());
+sim_test!(badhash_upgrade, make_image(&NO_DEPS, true), run_badhash_upgrade());
+sim_test!(decompress_upgrade, make_image(&NO_DEPS, true), run_decompress_upgrade());
+sim_test!(delta_upgrade, make_image(&NO_DEPS, true), run_delta_upgrade());
+sim_test!(validate_cache, make_image(&NO_DEPS, true), run_validate_cache());
+sim_test!(direct_xip, make_no_upgrade_image(&NO_DEPS), run_direct_xip());
+sim_test!(direct_xip_with_fails, make_no_upgrade_image(&NO_DEPS), run_direct_xip_with_fails());
 
 // Test various combinations of incorrect dependencies.
 test_shell!(dependency_combos, r, {
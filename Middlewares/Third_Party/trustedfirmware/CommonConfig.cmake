@@ -144,6 +144,8 @@ set (TFM_LEGACY_API ON)
 
 option(TFM_PARTITION_AUDIT_LOG "Enable the TF-M Audit Log partition" ON)
 option(TFM_PARTITION_PLATFORM "Enable the TF-M Platform partition" ON)
+option(BENCHMARK_TEST "Add the PSA service benchmarks to the regression tests" OFF)
+option(TFM_MM_IOVEC "Let PSA RoT services map client IOVECs instead of copying them (IPC model only)" OFF)
 
 if(${TARGET_PLATFORM} STREQUAL "AN521" OR ${TARGET_PLATFORM} STREQUAL "AN519" OR ${TARGET_PLATFORM} STREQUAL "AN539")
 	set (REFERENCE_PLATFORM ON)
@@ -170,6 +172,9 @@ endif()
 
 if (TFM_PSA_API)
 	add_definitions(-DTFM_PSA_API)
+	if (TFM_MM_IOVEC)
+		add_definitions(-DTFM_MM_IOVEC)
+	endif()
 endif()
 
 if (TFM_LEGACY_API)
@@ -313,6 +318,10 @@ if (NOT DEFINED SST_ROLLBACK_PROTECTION)
 	set (SST_ROLLBACK_PROTECTION OFF)
 endif()
 
+if (NOT DEFINED SST_CACHE_KEY)
+	set (SST_CACHE_KEY OFF)
+endif()
+
 if (NOT DEFINED SST_CREATE_FLASH_LAYOUT)
 	set (SST_CREATE_FLASH_LAYOUT OFF)
 endif()
@@ -128,6 +128,18 @@ int flash_area_write(const struct flash_area *area, uint32_t off,
 
 int flash_area_erase(const struct flash_area *area, uint32_t off, uint32_t len);
 
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+/*
+ * Start a write, and wait for the write started on the area to complete.
+ * The source buffer must not change until the write is complete.  With a
+ * driver that programs synchronously, the wait returns at once.
+ */
+int flash_area_write_async(const struct flash_area *area, uint32_t off,
+                           const void *src, uint32_t len);
+
+int flash_area_write_wait(const struct flash_area *area);
+#endif
+
 /*
  * Alignment restriction for flash writes.
  */
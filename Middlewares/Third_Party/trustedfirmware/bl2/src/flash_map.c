@@ -110,6 +110,47 @@ int flash_area_write(const struct flash_area *area, uint32_t off,
     return driver_list[area->fa_device_id]->ProgramData(area->fa_off + off, src, len);
 }
 
+#ifdef MCUBOOT_ASYNC_FLASH_WRITE
+/*
+ * A driver signalling ARM_FLASH_EVENT_READY programs in the background:
+ * ProgramData() returns once the write is started, and the driver reports
+ * busy until it is complete.  Other drivers, such as the one of the STM32L5
+ * internal flash, program before returning, so there is nothing to wait for
+ * and the copy falls back to the synchronous path.
+ */
+static bool flash_area_programs_async(const struct flash_area *area)
+{
+    ARM_DRIVER_FLASH *drv = driver_list[area->fa_device_id];
+
+    return drv->GetCapabilities != NULL && drv->GetStatus != NULL &&
+           drv->GetCapabilities().event_ready;
+}
+
+int flash_area_write_async(const struct flash_area *area, uint32_t off,
+                           const void *src, uint32_t len)
+{
+    BOOT_LOG_DBG("write async area=%d, off=%#x, len=%#x", area->fa_id, off,
+                 len);
+    return driver_list[area->fa_device_id]->ProgramData(area->fa_off + off,
+                                                        src, len);
+}
+
+int flash_area_write_wait(const struct flash_area *area)
+{
+    ARM_FLASH_STATUS status;
+
+    if (!flash_area_programs_async(area)) {
+        return 0;
+    }
+
+    do {
+        status = driver_list[area->fa_device_id]->GetStatus();
+    } while (status.busy);
+
+    return status.error ? -1 : 0;
+}
+#endif /* MCUBOOT_ASYNC_FLASH_WRITE */
+
 int flash_area_erase(const struct flash_area *area, uint32_t off, uint32_t len)
 {
     ARM_FLASH_INFO *flash_info;
@@ -66,6 +66,12 @@ enum psa_attest_err_t {
 #define PSA_INITIAL_ATTEST_CHALLENGE_SIZE_48  (48u)
 #define PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64  (64u)
 
+/**
+ * The maximum number of challenges signed together by
+ * \ref psa_initial_attest_get_batch_token
+ */
+#define PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES  (8u)
+
 /**
  * The list of fixed claims in the initial attestation token is still evolving,
  * you can expect slight changes in the future.
@@ -217,6 +223,39 @@ enum psa_attest_err_t
 psa_initial_attest_get_token_size(uint32_t  challenge_size,
                                   uint32_t *token_size);
 
+/**
+ * \brief Get one initial attestation token for a batch of challenges
+ *
+ * The challenges are the leaves of a Merkle tree, as defined in RFC 6962 with
+ * SHA-256: a leaf is H(0x00 || challenge) and a node is
+ * H(0x01 || left || right). The 32 bytes root of the tree is the challenge
+ * claim of the token, so a single signature covers all the challenges. The
+ * caller gives each relying party the token together with the audit path of
+ * its challenge, from which the relying party recomputes the root.
+ *
+ * The token has the same size as a token of a 32 bytes challenge.
+ *
+ * \param[in]     challenges      Pointer to buffer where the challenges are
+ *                                stored one after the other.
+ * \param[in]     challenge_size  Size of one challenge in bytes. All the
+ *                                challenges have the same size.
+ * \param[in]     challenge_count Number of challenges, at most
+ *                                \ref PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES
+ * \param[out]    token           Pointer to the buffer where attestation token
+ *                                must be stored.
+ * \param[in,out] token_size      Size of allocated buffer for token, which
+ *                                updated by initial attestation service with
+ *                                final token size.
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+enum psa_attest_err_t
+psa_initial_attest_get_batch_token(const uint8_t *challenges,
+                                   uint32_t       challenge_size,
+                                   uint32_t       challenge_count,
+                                   uint8_t       *token,
+                                   uint32_t      *token_size);
+
 #ifdef __cplusplus
 }
 #endif
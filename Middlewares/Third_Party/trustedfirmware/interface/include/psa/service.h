@@ -202,6 +202,105 @@ size_t psa_skip(psa_handle_t msg_handle, uint32_t invec_idx, size_t num_bytes);
 void psa_write(psa_handle_t msg_handle, uint32_t outvec_idx,
                const void *buffer, size_t num_bytes);
 
+#ifdef TFM_MM_IOVEC
+/**
+ * \brief Map a client input vector for direct access by a Secure Partition.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] invec_idx         Index of the input vector to map. Must be
+ *                              less than \ref PSA_MAX_IOVEC.
+ *
+ * \retval >0                   Pointer to the client input vector, which is
+ *                              valid for msg.in_size[invec_idx] bytes until
+ *                              the message is unmapped or replied to.
+ * \retval NULL                 The input vector has length zero.
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           invec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ * \arg                           The calling partition is not a PSA RoT
+ *                                partition.
+ * \arg                           The input vector has already been mapped,
+ *                                or accessed with \ref psa_read or
+ *                                \ref psa_skip.
+ */
+const void *psa_map_invec(psa_handle_t msg_handle, uint32_t invec_idx);
+
+/**
+ * \brief Unmap a client input vector mapped with \ref psa_map_invec.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] invec_idx         Index of the input vector to unmap. Must be
+ *                              less than \ref PSA_MAX_IOVEC.
+ *
+ * \retval void                 Success. The whole input vector is considered
+ *                              as read.
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           invec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ * \arg                           The input vector is not mapped, or has
+ *                                already been unmapped.
+ */
+void psa_unmap_invec(psa_handle_t msg_handle, uint32_t invec_idx);
+
+/**
+ * \brief Map a client output vector for direct access by a Secure Partition.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] outvec_idx        Index of the output vector to map. Must be
+ *                              less than \ref PSA_MAX_IOVEC.
+ *
+ * \retval >0                   Pointer to the client output vector, which is
+ *                              valid for msg.out_size[outvec_idx] bytes until
+ *                              the message is unmapped or replied to.
+ * \retval NULL                 The output vector has length zero.
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           outvec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ * \arg                           The calling partition is not a PSA RoT
+ *                                partition.
+ * \arg                           The output vector has already been mapped,
+ *                                or written with \ref psa_write.
+ */
+void *psa_map_outvec(psa_handle_t msg_handle, uint32_t outvec_idx);
+
+/**
+ * \brief Unmap a client output vector mapped with \ref psa_map_outvec and
+ *        set the number of bytes written to it.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] outvec_idx        Index of the output vector to unmap. Must be
+ *                              less than \ref PSA_MAX_IOVEC.
+ * \param[in] len               Number of bytes written to the output vector.
+ *
+ * \retval void                 Success
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           outvec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ * \arg                           The output vector is not mapped, or has
+ *                                already been unmapped.
+ * \arg                           len is greater than the size of the output
+ *                                vector.
+ */
+void psa_unmap_outvec(psa_handle_t msg_handle, uint32_t outvec_idx,
+                      size_t len);
+#endif /* TFM_MM_IOVEC */
+
 /**
  * \brief Complete handling of a specific message and unblock the client.
  *
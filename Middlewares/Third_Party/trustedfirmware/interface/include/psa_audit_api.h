@@ -50,6 +50,45 @@ psa_status_t psa_audit_retrieve_record(const uint32_t record_index,
                                        const uint32_t token_size,
                                        uint8_t *buffer,
                                        uint32_t *record_size);
+
+/**
+ * \brief Retrieves consecutive records starting at the specified index
+ *
+ * \details The function retrieves up to num_records items starting from the
+ *          item specified by first_index, as many whole items as fit in the
+ *          buffer provided. The items are returned one after the other, in
+ *          the same format as returned by \ref psa_audit_retrieve_record.
+ *          The token is passed as a challenge value for the encryption scheme
+ *
+ * \note Currently the cryptography support is not yet enabled, so the
+ *       token value is not used and must be passed as NULL, with 0 size
+ *
+ * \param[in]  first_index       Index of the first record to retrieve
+ * \param[in]  num_records       Maximum number of records to retrieve
+ * \param[in]  buffer_size       Size in bytes of the provided buffer
+ * \param[in]  token             Must be set to NULL. Token used as a
+ *                               challenge for encryption, to protect against
+ *                               rollback attacks
+ * \param[in]  token_size        Must be set to 0. Size in bytes of the token
+ *                               used as challenge
+ * \param[out] buffer            Buffer used to store the retrieved records
+ * \param[out] retrieved_records Number of records retrieved
+ * \param[out] retrieved_size    Size in bytes of the retrieved records
+ *
+ * \return Returns values as specified by the \ref psa_status_t. If the
+ *         buffer is too small to hold the first record, nothing is retrieved
+ *         and PSA_ERROR_BUFFER_TOO_SMALL is returned
+ *
+ */
+psa_status_t psa_audit_retrieve_records(const uint32_t first_index,
+                                        const uint32_t num_records,
+                                        const uint32_t buffer_size,
+                                        const uint8_t *token,
+                                        const uint32_t token_size,
+                                        uint8_t *buffer,
+                                        uint32_t *retrieved_records,
+                                        uint32_t *retrieved_size);
+
 /**
  * \brief Returns the total number and size of the records stored
  *
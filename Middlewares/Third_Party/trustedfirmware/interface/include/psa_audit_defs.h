@@ -27,6 +27,17 @@ struct psa_audit_record {
     uint8_t  payload[]; /*!< Flexible array member for payload */
 };
 
+/*!
+ * \struct psa_audit_records_range
+ *
+ * \brief This structure contains the range of consecutive records to be
+ *        retrieved from the audit log in a single request
+ */
+struct psa_audit_records_range {
+    uint32_t first_index; /*!< Index of the first record to retrieve */
+    uint32_t num_records; /*!< Maximum number of records to retrieve */
+};
+
 #ifdef __cplusplus
 }
 #endif
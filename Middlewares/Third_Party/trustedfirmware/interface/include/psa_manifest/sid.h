@@ -45,6 +45,8 @@ extern "C" {
 #define TFM_ATTEST_GET_TOKEN_VERSION                               (1U)
 #define TFM_ATTEST_GET_TOKEN_SIZE_SID                              (0x00000021U)
 #define TFM_ATTEST_GET_TOKEN_SIZE_VERSION                          (1U)
+#define TFM_ATTEST_GET_BATCH_TOKEN_SID                             (0x00000022U)
+#define TFM_ATTEST_GET_BATCH_TOKEN_VERSION                         (1U)
 
 #ifdef TFM_PARTITION_TEST_CORE
 /******** TFM_SP_CORE_TEST ********/
@@ -56,3 +56,32 @@ psa_initial_attest_get_token_size(uint32_t  challenge_size,
                             (uint32_t)in_vec,  IOVEC_LEN(in_vec),
                             (uint32_t)out_vec, IOVEC_LEN(out_vec));
 }
+
+enum psa_attest_err_t
+psa_initial_attest_get_batch_token(const uint8_t *challenges,
+                                   uint32_t       challenge_size,
+                                   uint32_t       challenge_count,
+                                   uint8_t       *token,
+                                   uint32_t      *token_size)
+{
+    int32_t res;
+
+    psa_invec in_vec[] = {
+        {challenges, challenge_size * challenge_count},
+        {&challenge_size, sizeof(challenge_size)}
+    };
+    psa_outvec out_vec[] = {
+        {token, *token_size}
+    };
+
+    res = tfm_ns_interface_dispatch(
+                        (veneer_fn)tfm_initial_attest_get_batch_token_veneer,
+                        (uint32_t)in_vec,  IOVEC_LEN(in_vec),
+                        (uint32_t)out_vec, IOVEC_LEN(out_vec));
+
+    if (res == (int32_t)PSA_ATTEST_ERR_SUCCESS) {
+        *token_size = out_vec[0].len;
+    }
+
+    return (enum psa_attest_err_t)res;
+}
@@ -81,3 +81,43 @@ psa_initial_attest_get_token_size(uint32_t  challenge_size,
 
     return (enum psa_attest_err_t)status;
 }
+
+enum psa_attest_err_t
+psa_initial_attest_get_batch_token(const uint8_t *challenges,
+                                   uint32_t       challenge_size,
+                                   uint32_t       challenge_count,
+                                   uint8_t       *token,
+                                   uint32_t      *token_size)
+{
+    psa_handle_t handle = PSA_NULL_HANDLE;
+    psa_status_t status;
+
+    psa_invec in_vec[] = {
+        {challenges, challenge_size * challenge_count},
+        {&challenge_size, sizeof(challenge_size)}
+    };
+    psa_outvec out_vec[] = {
+        {token, *token_size}
+    };
+
+    handle = psa_connect(TFM_ATTEST_GET_BATCH_TOKEN_SID,
+                         TFM_ATTEST_GET_BATCH_TOKEN_VERSION);
+    if (handle <= 0) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    status = psa_call(handle, PSA_IPC_CALL,
+                      in_vec, IOVEC_LEN(in_vec),
+                      out_vec, IOVEC_LEN(out_vec));
+    psa_close(handle);
+
+    if (status < PSA_SUCCESS) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    if (status == PSA_SUCCESS) {
+        *token_size = out_vec[0].len;
+    }
+
+    return (enum psa_attest_err_t)status;
+}
@@ -43,6 +43,12 @@ typedef enum {
     TFM_SVC_PSA_REPLY,
     TFM_SVC_PSA_NOTIFY,
     TFM_SVC_PSA_CLEAR,
+#ifdef TFM_MM_IOVEC
+    TFM_SVC_PSA_MAP_INVEC,
+    TFM_SVC_PSA_UNMAP_INVEC,
+    TFM_SVC_PSA_MAP_OUTVEC,
+    TFM_SVC_PSA_UNMAP_OUTVEC,
+#endif
 #endif
     TFM_SVC_GET_BOOT_VALUE,
 } tfm_svc_number_t;
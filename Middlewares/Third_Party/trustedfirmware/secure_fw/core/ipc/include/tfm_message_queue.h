@@ -24,6 +24,9 @@ struct tfm_msg_body_t {
                                      * Save caller outvec pointer for
                                      * write length update
                                      */
+#ifdef TFM_MM_IOVEC
+    uint32_t iovec_status;          /* Mapping status of the iovecs     */
+#endif
     struct tfm_msg_body_t *next;    /* List operators                   */
 };
 
@@ -11,6 +11,7 @@
 #include <stddef.h>
 #include "tfm_arch.h"
 #include "cmsis_compiler.h"
+#include "tfm_list.h"
 
 /* Status code */
 #define THRD_STAT_CREATING        0
@@ -51,7 +52,7 @@ struct tfm_thrd_ctx {
     uint32_t        status;             /* status                       */
 
     struct tfm_state_context state_ctx; /* State context                */
-    struct tfm_thrd_ctx *next;          /* next thread in list          */
+    struct tfm_list_node_t runn_node;   /* node in runnable queue       */
 };
 
 /*
@@ -80,7 +81,8 @@ void tfm_thrd_init(struct tfm_thrd_ctx *pth,
  *
  * Notes :
  *  Set thread priority. Priority is set to THRD_PRIOR_MEDIUM in
- *  tfm_thrd_init().
+ *  tfm_thrd_init(). It must not be changed after tfm_thrd_start(), as
+ *  the runnable queue is ordered by priority.
  */
 void __STATIC_INLINE tfm_thrd_priority(struct tfm_thrd_ctx *pth,
                                        uint32_t prior)
@@ -98,6 +100,7 @@ void __STATIC_INLINE tfm_thrd_priority(struct tfm_thrd_ctx *pth,
  *
  * Notes
  *  Reuse prior of thread context to shift down non-secure thread priority.
+ *  Like the priority, it must be set before tfm_thrd_start().
  */
 void __STATIC_INLINE tfm_thrd_secure(struct tfm_thrd_ctx *pth,
                                      uint32_t attr_secure)
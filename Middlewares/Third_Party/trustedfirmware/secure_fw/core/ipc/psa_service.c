@@ -67,6 +67,41 @@ void psa_write(psa_handle_t msg_handle, uint32_t outvec_idx,
                    : : "I" (TFM_SVC_PSA_WRITE));
 }
 
+#ifdef TFM_MM_IOVEC
+__attribute__((naked, section("SFN")))
+const void *psa_map_invec(psa_handle_t msg_handle, uint32_t invec_idx)
+{
+    __ASM volatile("SVC %0           \n"
+                   "BX LR            \n"
+                   : : "I" (TFM_SVC_PSA_MAP_INVEC));
+}
+
+__attribute__((naked, section("SFN")))
+void psa_unmap_invec(psa_handle_t msg_handle, uint32_t invec_idx)
+{
+    __ASM volatile("SVC %0           \n"
+                   "BX LR            \n"
+                   : : "I" (TFM_SVC_PSA_UNMAP_INVEC));
+}
+
+__attribute__((naked, section("SFN")))
+void *psa_map_outvec(psa_handle_t msg_handle, uint32_t outvec_idx)
+{
+    __ASM volatile("SVC %0           \n"
+                   "BX LR            \n"
+                   : : "I" (TFM_SVC_PSA_MAP_OUTVEC));
+}
+
+__attribute__((naked, section("SFN")))
+void psa_unmap_outvec(psa_handle_t msg_handle, uint32_t outvec_idx,
+                      size_t len)
+{
+    __ASM volatile("SVC %0           \n"
+                   "BX LR            \n"
+                   : : "I" (TFM_SVC_PSA_UNMAP_OUTVEC));
+}
+#endif /* TFM_MM_IOVEC */
+
 __attribute__((naked, section("SFN")))
 void psa_reply(psa_handle_t msg_handle, psa_status_t retval)
 {
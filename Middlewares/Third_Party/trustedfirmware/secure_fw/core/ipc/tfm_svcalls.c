@@ -29,6 +29,25 @@
 /* remove IAR warning relative to pointless comparison */
 #pragma diag_suppress=Pa084
 #endif
+
+#ifdef TFM_MM_IOVEC
+/*
+ * Flags in the iovec_status of a message body. Each flag has one bit per
+ * vector, from bit (flag position + index).
+ */
+#define IOVEC_INVEC_MAPPED_POS      (0u)
+#define IOVEC_INVEC_UNMAPPED_POS    (4u)
+#define IOVEC_INVEC_ACCESSED_POS    (8u)
+#define IOVEC_OUTVEC_MAPPED_POS     (12u)
+#define IOVEC_OUTVEC_UNMAPPED_POS   (16u)
+#define IOVEC_OUTVEC_ACCESSED_POS   (20u)
+
+#define IOVEC_FLAG(pos, idx)        (1u << ((pos) + (idx)))
+
+#if (PSA_MAX_IOVEC > 4)
+#error "The iovec_status flags only cover 4 vectors of each direction"
+#endif
+#endif /* TFM_MM_IOVEC */
 void tfm_irq_handler(uint32_t partition_id, psa_signal_t signal,
                      IRQn_Type irq_line);
 
@@ -578,6 +597,15 @@ static size_t tfm_svcall_psa_read(uint32_t *args)
         tfm_panic();
     }
 
+#ifdef TFM_MM_IOVEC
+    /* It is a fatal error if the input vector has been mapped */
+    if (msg->iovec_status &
+        IOVEC_FLAG(IOVEC_INVEC_MAPPED_POS, invec_idx)) {
+        tfm_panic();
+    }
+    msg->iovec_status |= IOVEC_FLAG(IOVEC_INVEC_ACCESSED_POS, invec_idx);
+#endif
+
     /* There was no remaining data in this input vector */
     if (msg->msg.in_size[invec_idx] == 0) {
         return 0;
@@ -655,6 +683,15 @@ static size_t tfm_svcall_psa_skip(uint32_t *args)
         tfm_panic();
     }
 
+#ifdef TFM_MM_IOVEC
+    /* It is a fatal error if the input vector has been mapped */
+    if (msg->iovec_status &
+        IOVEC_FLAG(IOVEC_INVEC_MAPPED_POS, invec_idx)) {
+        tfm_panic();
+    }
+    msg->iovec_status |= IOVEC_FLAG(IOVEC_INVEC_ACCESSED_POS, invec_idx);
+#endif
+
     /* There was no remaining data in this input vector */
     if (msg->msg.in_size[invec_idx] == 0) {
         return 0;
@@ -735,6 +772,15 @@ static void tfm_svcall_psa_write(uint32_t *args)
         tfm_panic();
     }
 
+#ifdef TFM_MM_IOVEC
+    /* It is a fatal error if the output vector has been mapped */
+    if (msg->iovec_status &
+        IOVEC_FLAG(IOVEC_OUTVEC_MAPPED_POS, outvec_idx)) {
+        tfm_panic();
+    }
+    msg->iovec_status |= IOVEC_FLAG(IOVEC_OUTVEC_ACCESSED_POS, outvec_idx);
+#endif
+
     /*
      * It is a fatal error if the call attempts to write data past the end of
      * the client output vector
@@ -760,6 +806,224 @@ static void tfm_svcall_psa_write(uint32_t *args)
     msg->outvec[outvec_idx].len += num_bytes;
 }
 
+#ifdef TFM_MM_IOVEC
+/**
+ * \brief Get the request message a mapping call refers to.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] idx               Index of the vector to be (un)mapped.
+ *
+ * \retval msg                  The message body.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ * \arg                           The partition of the RoT Service is not a
+ *                                PSA RoT partition.
+ */
+static struct tfm_msg_body_t *get_mapping_msg(psa_handle_t msg_handle,
+                                              uint32_t idx)
+{
+    struct tfm_msg_body_t *msg = NULL;
+    struct spm_partition_desc_t *partition = NULL;
+
+    /* It is a fatal error if message handle is invalid */
+    msg = tfm_spm_get_msg_from_handle(msg_handle);
+    if (!msg) {
+        tfm_panic();
+    }
+
+    /*
+     * It is a fatal error if message handle does not refer to a request
+     * message
+     */
+    if (msg->msg.type < PSA_IPC_CALL) {
+        tfm_panic();
+    }
+
+    /*
+     * It is a fatal error if the vector index is equal to or greater than
+     * PSA_MAX_IOVEC
+     */
+    if (idx >= PSA_MAX_IOVEC) {
+        tfm_panic();
+    }
+
+    /*
+     * The client memory has been checked against the client's access rights
+     * in psa_call(), but the service accesses it directly with its own. Only
+     * PSA RoT partitions, which run privileged, are trusted to do so.
+     */
+    partition = msg->service->partition;
+    if (tfm_spm_partition_get_privileged_mode(
+        partition->static_data->partition_flags) !=
+        TFM_PARTITION_PRIVILEGED_MODE) {
+        tfm_panic();
+    }
+
+    return msg;
+}
+
+/**
+ * \brief SVC handler for \ref psa_map_invec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, invec_idx.
+ *
+ * \retval >0                   Pointer to the client input vector.
+ * \retval NULL                 The input vector has length zero.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           The checks of \ref get_mapping_msg fail.
+ * \arg                           The input vector has already been mapped,
+ *                                or accessed with psa_read() or psa_skip().
+ */
+static const void *tfm_svcall_psa_map_invec(uint32_t *args)
+{
+    uint32_t invec_idx;
+    struct tfm_msg_body_t *msg = NULL;
+
+    TFM_ASSERT(args != NULL);
+    invec_idx = args[1];
+    msg = get_mapping_msg((psa_handle_t)args[0], invec_idx);
+
+    if (msg->iovec_status &
+        (IOVEC_FLAG(IOVEC_INVEC_MAPPED_POS, invec_idx) |
+         IOVEC_FLAG(IOVEC_INVEC_ACCESSED_POS, invec_idx))) {
+        tfm_panic();
+    }
+
+    if (msg->msg.in_size[invec_idx] == 0) {
+        return NULL;
+    }
+
+    msg->iovec_status |= IOVEC_FLAG(IOVEC_INVEC_MAPPED_POS, invec_idx);
+
+    return msg->invec[invec_idx].base;
+}
+
+/**
+ * \brief SVC handler for \ref psa_unmap_invec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, invec_idx.
+ *
+ * \retval void                 Success.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           The checks of \ref get_mapping_msg fail.
+ * \arg                           The input vector is not mapped, or has
+ *                                already been unmapped.
+ */
+static void tfm_svcall_psa_unmap_invec(uint32_t *args)
+{
+    uint32_t invec_idx;
+    struct tfm_msg_body_t *msg = NULL;
+
+    TFM_ASSERT(args != NULL);
+    invec_idx = args[1];
+    msg = get_mapping_msg((psa_handle_t)args[0], invec_idx);
+
+    if (!(msg->iovec_status &
+          IOVEC_FLAG(IOVEC_INVEC_MAPPED_POS, invec_idx)) ||
+        (msg->iovec_status &
+         IOVEC_FLAG(IOVEC_INVEC_UNMAPPED_POS, invec_idx))) {
+        tfm_panic();
+    }
+
+    msg->iovec_status |= IOVEC_FLAG(IOVEC_INVEC_UNMAPPED_POS, invec_idx);
+
+    /* The whole input vector is considered as read */
+    msg->invec[invec_idx].base = (char *)msg->invec[invec_idx].base +
+                                 msg->msg.in_size[invec_idx];
+    msg->msg.in_size[invec_idx] = 0;
+}
+
+/**
+ * \brief SVC handler for \ref psa_map_outvec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, outvec_idx.
+ *
+ * \retval >0                   Pointer to the client output vector.
+ * \retval NULL                 The output vector has length zero.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           The checks of \ref get_mapping_msg fail.
+ * \arg                           The output vector has already been mapped,
+ *                                or written with psa_write().
+ */
+static void *tfm_svcall_psa_map_outvec(uint32_t *args)
+{
+    uint32_t outvec_idx;
+    struct tfm_msg_body_t *msg = NULL;
+
+    TFM_ASSERT(args != NULL);
+    outvec_idx = args[1];
+    msg = get_mapping_msg((psa_handle_t)args[0], outvec_idx);
+
+    if (msg->iovec_status &
+        (IOVEC_FLAG(IOVEC_OUTVEC_MAPPED_POS, outvec_idx) |
+         IOVEC_FLAG(IOVEC_OUTVEC_ACCESSED_POS, outvec_idx))) {
+        tfm_panic();
+    }
+
+    if (msg->msg.out_size[outvec_idx] == 0) {
+        return NULL;
+    }
+
+    msg->iovec_status |= IOVEC_FLAG(IOVEC_OUTVEC_MAPPED_POS, outvec_idx);
+
+    return msg->outvec[outvec_idx].base;
+}
+
+/**
+ * \brief SVC handler for \ref psa_unmap_outvec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, outvec_idx, len.
+ *
+ * \retval void                 Success.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           The checks of \ref get_mapping_msg fail.
+ * \arg                           The output vector is not mapped, or has
+ *                                already been unmapped.
+ * \arg                           len is greater than the size of the output
+ *                                vector.
+ */
+static void tfm_svcall_psa_unmap_outvec(uint32_t *args)
+{
+    uint32_t outvec_idx;
+    size_t len;
+    struct tfm_msg_body_t *msg = NULL;
+
+    TFM_ASSERT(args != NULL);
+    outvec_idx = args[1];
+    len = (size_t)args[2];
+    msg = get_mapping_msg((psa_handle_t)args[0], outvec_idx);
+
+    if (!(msg->iovec_status &
+          IOVEC_FLAG(IOVEC_OUTVEC_MAPPED_POS, outvec_idx)) ||
+        (msg->iovec_status &
+         IOVEC_FLAG(IOVEC_OUTVEC_UNMAPPED_POS, outvec_idx))) {
+        tfm_panic();
+    }
+
+    if (len > msg->msg.out_size[outvec_idx]) {
+        tfm_panic();
+    }
+
+    msg->iovec_status |= IOVEC_FLAG(IOVEC_OUTVEC_UNMAPPED_POS, outvec_idx);
+
+    /* Report the number of bytes written, as psa_write() would */
+    msg->outvec[outvec_idx].len = len;
+}
+#endif /* TFM_MM_IOVEC */
+
 static void update_caller_outvec_len(struct tfm_msg_body_t *msg)
 {
     int32_t i = 0;
@@ -1156,6 +1420,18 @@ int32_t SVC_Handler_IPC(tfm_svc_number_t svc_num, uint32_t *ctx, uint32_t lr)
     case TFM_SVC_PSA_WRITE:
         tfm_svcall_psa_write(ctx);
         break;
+#ifdef TFM_MM_IOVEC
+    case TFM_SVC_PSA_MAP_INVEC:
+        return (int32_t)tfm_svcall_psa_map_invec(ctx);
+    case TFM_SVC_PSA_UNMAP_INVEC:
+        tfm_svcall_psa_unmap_invec(ctx);
+        break;
+    case TFM_SVC_PSA_MAP_OUTVEC:
+        return (int32_t)tfm_svcall_psa_map_outvec(ctx);
+    case TFM_SVC_PSA_UNMAP_OUTVEC:
+        tfm_svcall_psa_unmap_outvec(ctx);
+        break;
+#endif
     case TFM_SVC_PSA_REPLY:
         tfm_svcall_psa_reply(ctx);
         break;
@@ -13,72 +13,96 @@
 #include "spm_api.h"
 #include "tfm_core_utils.h"
 
+/*
+ * Runnable threads are queued in priority buckets. Each bucket keeps its
+ * threads sorted by priority value, first in first out among equals, and
+ * bit (31 - bucket) of the bitmap is set while the bucket is not empty. The
+ * highest priority runnable thread is the head of the bucket given by the
+ * leading zero count of the bitmap, whatever the number of threads.
+ */
+#define THRD_RUNN_BUCKETS         32
+#define THRD_PRIOR_BUCKET_SHIFT   3
+#define THRD_RUNN_BIT(bucket)     (1UL << (THRD_RUNN_BUCKETS - 1 - (bucket)))
+
 /* Force ZERO in case ZI(bss) clear is missing */
-static struct tfm_thrd_ctx *p_thrd_head = NULL;
-static struct tfm_thrd_ctx *p_runn_head = NULL;
+static uint32_t runn_bitmap = 0;
 static struct tfm_thrd_ctx *p_curr_thrd = NULL;
 
+/* Bucket heads are only valid while their bit is set in the bitmap */
+static struct tfm_list_node_t runn_queue[THRD_RUNN_BUCKETS];
+
 /* Define Macro to fetch global to support future expansion (PERCPU e.g.) */
-#define LIST_HEAD   p_thrd_head
-#define RUNN_HEAD   p_runn_head
+#define RUNN_BITMAP runn_bitmap
+#define RUNN_QUEUE  runn_queue
 #define CURR_THRD   p_curr_thrd
 
-static struct tfm_thrd_ctx *find_next_running_thread(struct tfm_thrd_ctx *pth)
+#define RUNN_NODE_TO_THRD(node) \
+    (TFM_GET_CONTAINER_PTR(node, struct tfm_thrd_ctx, runn_node))
+
+/*
+ * Non-secure threads share the lowest priority bucket, where they are sorted
+ * behind the secure threads by the security attribute in their priority.
+ */
+static uint32_t prior_to_bucket(uint32_t prior)
 {
-    while (pth && pth->status != THRD_STAT_RUNNING) {
-        pth = pth->next;
+    if (prior & THRD_ATTR_NON_SECURE) {
+        return THRD_RUNN_BUCKETS - 1;
     }
 
-    return pth;
+    return (prior & THRD_PRIOR_MASK) >> THRD_PRIOR_BUCKET_SHIFT;
 }
 
-/* To get next running thread for scheduler */
-struct tfm_thrd_ctx *tfm_thrd_next_thread(void)
+/* Queue a thread behind the runnable threads of the same priority */
+static void runn_queue_insert(struct tfm_thrd_ctx *pth)
 {
-    /*
-     * First RUNNING thread has highest priority since threads are sorted with
-     * priority.
-     */
-    return find_next_running_thread(RUNN_HEAD);
+    uint32_t bucket = prior_to_bucket(pth->prior);
+    struct tfm_list_node_t *head = &RUNN_QUEUE[bucket];
+    struct tfm_list_node_t *node;
+
+    if (!(RUNN_BITMAP & THRD_RUNN_BIT(bucket))) {
+        tfm_list_init(head);
+        RUNN_BITMAP |= THRD_RUNN_BIT(bucket);
+    }
+
+    TFM_LIST_FOR_EACH(node, head) {
+        if (RUNN_NODE_TO_THRD(node)->prior > pth->prior) {
+            break;
+        }
+    }
+
+    /* Adding at the tail of a node inserts in front of it */
+    tfm_list_add_tail(node, &pth->runn_node);
 }
 
-/* To get current thread for caller */
-struct tfm_thrd_ctx *tfm_thrd_curr_thread()
+static void runn_queue_remove(struct tfm_thrd_ctx *pth)
 {
-    return CURR_THRD;
+    uint32_t bucket = prior_to_bucket(pth->prior);
+
+    tfm_list_del_node(&pth->runn_node);
+
+    if (tfm_list_is_empty(&RUNN_QUEUE[bucket])) {
+        RUNN_BITMAP &= ~THRD_RUNN_BIT(bucket);
+    }
 }
 
-/* Insert a new thread into list by descending priority (Highest at head) */
-static void insert_by_prior(struct tfm_thrd_ctx **head,
-                            struct tfm_thrd_ctx *node)
+/* To get next running thread for scheduler */
+struct tfm_thrd_ctx *tfm_thrd_next_thread(void)
 {
-    if (*head == NULL || (node->prior <= (*head)->prior)) {
-        node->next = *head;
-        *head = node;
-    } else {
-        struct tfm_thrd_ctx *iter = *head;
-
-        while (iter->next && (node->prior > iter->next->prior)) {
-            iter = iter->next;
-        }
-        node->next = iter->next;
-        iter->next = node;
+    struct tfm_list_node_t *head;
+
+    if (RUNN_BITMAP == 0) {
+        return NULL;
     }
+
+    head = &RUNN_QUEUE[__CLZ(RUNN_BITMAP)];
+
+    return RUNN_NODE_TO_THRD(tfm_list_first_node(head));
 }
 
-/*
- * Set first running thread as head to reduce enumerate
- * depth while searching for a first running thread.
- */
-static void update_running_head(struct tfm_thrd_ctx **runn,
-                                struct tfm_thrd_ctx *node)
+/* To get current thread for caller */
+struct tfm_thrd_ctx *tfm_thrd_curr_thread()
 {
-    if ((node->status == THRD_STAT_RUNNING) &&
-        (*runn == NULL || (node->prior < (*runn)->prior))) {
-        *runn = node;
-    } else {
-        *runn = LIST_HEAD;
-    }
+    return CURR_THRD;
 }
 
 /* Set context members only. No validation here */
@@ -144,10 +168,7 @@ uint32_t tfm_thrd_start(struct tfm_thrd_ctx *pth)
                                 pth->param, (uintptr_t)pth->pfn,
                                 pth->sp_btm, pth->sp_top);
 
-    /* Insert a new thread with priority */
-    insert_by_prior(&LIST_HEAD, pth);
-
-    /* Mark it as RUNNING after insertion */
+    /* Marking it as RUNNING queues it by priority */
     tfm_thrd_set_status(pth, THRD_STAT_RUNNING);
 
     return THRD_SUCCESS;
@@ -157,8 +178,15 @@ void tfm_thrd_set_status(struct tfm_thrd_ctx *pth, uint32_t new_status)
 {
     TFM_ASSERT(pth != NULL && new_status < THRD_STAT_INVALID);
 
+    if ((pth->status != THRD_STAT_RUNNING) &&
+        (new_status == THRD_STAT_RUNNING)) {
+        runn_queue_insert(pth);
+    } else if ((pth->status == THRD_STAT_RUNNING) &&
+               (new_status != THRD_STAT_RUNNING)) {
+        runn_queue_remove(pth);
+    }
+
     pth->status = new_status;
-    update_running_head(&RUNN_HEAD, pth);
 }
 
 /* Scheduling won't happen immediately but after the exception returns */
@@ -184,7 +212,7 @@ void tfm_thrd_start_scheduler(struct tfm_thrd_ctx *pth)
 /* Remove current thread out of the schedulable list */
 void tfm_svcall_thrd_exit(void)
 {
-    CURR_THRD->status = THRD_STAT_DETACH;
+    tfm_thrd_set_status(CURR_THRD, THRD_STAT_DETACH);
     tfm_arch_trigger_pendsv();
 }
 
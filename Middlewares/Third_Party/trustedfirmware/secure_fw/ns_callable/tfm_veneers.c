@@ -30,6 +30,7 @@ psa_status_t audit_core_add_record(psa_invec *, size_t, psa_outvec *, size_t);
 psa_status_t audit_core_get_info(psa_invec *, size_t, psa_outvec *, size_t);
 psa_status_t audit_core_get_record_info(psa_invec *, size_t, psa_outvec *, size_t);
 psa_status_t audit_core_delete_record(psa_invec *, size_t, psa_outvec *, size_t);
+psa_status_t audit_core_retrieve_records(psa_invec *, size_t, psa_outvec *, size_t);
 #endif /* TFM_PARTITION_AUDIT_LOG */
 
 /******** TFM_SP_CRYPTO ********/
@@ -86,6 +87,7 @@ psa_status_t platform_sp_ioctl(psa_invec *, size_t, psa_outvec *, size_t);
 /******** TFM_SP_INITIAL_ATTESTATION ********/
 psa_status_t initial_attest_get_token(psa_invec *, size_t, psa_outvec *, size_t);
 psa_status_t initial_attest_get_token_size(psa_invec *, size_t, psa_outvec *, size_t);
+psa_status_t initial_attest_get_batch_token(psa_invec *, size_t, psa_outvec *, size_t);
 
 #ifdef TFM_PARTITION_TEST_CORE
 /******** TFM_SP_CORE_TEST ********/
@@ -156,6 +158,7 @@ TFM_VENEER_FUNCTION(TFM_SP_AUDIT_LOG, audit_core_add_record)
 TFM_VENEER_FUNCTION(TFM_SP_AUDIT_LOG, audit_core_get_info)
 TFM_VENEER_FUNCTION(TFM_SP_AUDIT_LOG, audit_core_get_record_info)
 TFM_VENEER_FUNCTION(TFM_SP_AUDIT_LOG, audit_core_delete_record)
+TFM_VENEER_FUNCTION(TFM_SP_AUDIT_LOG, audit_core_retrieve_records)
 #endif /* TFM_PARTITION_AUDIT_LOG */
 
 /******** TFM_SP_CRYPTO ********/
@@ -212,6 +215,7 @@ TFM_VENEER_FUNCTION(TFM_SP_PLATFORM, platform_sp_ioctl)
 /******** TFM_SP_INITIAL_ATTESTATION ********/
 TFM_VENEER_FUNCTION(TFM_SP_INITIAL_ATTESTATION, initial_attest_get_token)
 TFM_VENEER_FUNCTION(TFM_SP_INITIAL_ATTESTATION, initial_attest_get_token_size)
+TFM_VENEER_FUNCTION(TFM_SP_INITIAL_ATTESTATION, initial_attest_get_batch_token)
 
 #ifdef TFM_PARTITION_TEST_CORE
 /******** TFM_SP_CORE_TEST ********/
@@ -11,6 +11,9 @@
 #include "audit_core.h"
 #include "psa_audit_defs.h"
 #include "tfm_secure_api.h"
+#ifdef AUDIT_ITS_PERSISTENCE
+#include "psa/internal_trusted_storage.h"
+#endif
 
 /*!
  * \def AUDIT_UART_REDIRECTION
@@ -77,33 +80,48 @@ static const char hex_values[] = "0123456789ABCDEF";
                               MEMBER_SIZE(struct log_hdr, iv_counter) + \
                               MEMBER_SIZE(struct log_hdr, partition_id) + \
                               MEMBER_SIZE(struct log_hdr, size))
+/*!
+ * \def AUDIT_LOG_SIZE
+ *
+ * \brief Size of the allocated space for the log, in bytes. It can be set by
+ *        the build system, the default is 1024 bytes
+ *
+ * \note Must be a multiple of 8 bytes.
+ */
+#ifndef AUDIT_LOG_SIZE
+#define AUDIT_LOG_SIZE (1024)
+#endif
+
+#if ((AUDIT_LOG_SIZE % 8) != 0)
+#error "AUDIT_LOG_SIZE must be a multiple of 8 bytes"
+#endif
+
 /*!
  * \def LOG_SIZE
  *
  * \brief Size of the allocated space for the log, in bytes
+ */
+#define LOG_SIZE (AUDIT_LOG_SIZE)
+
+/*!
+ * \def LOG_MAX_RECORDS
  *
- * \note Must be a multiple of 8 bytes.
+ * \brief Maximum number of records in the log, i.e. the number of records
+ *        without ID nor payload which fit in LOG_SIZE bytes
  */
-#define LOG_SIZE (1024)
+#define LOG_MAX_RECORDS (LOG_SIZE / (LOG_FIXED_FIELD_SIZE + LOG_MAC_SIZE))
 
 /*!
  * \var log_buffer
  *
- * \brief The private buffer containing the the log in memory
+ * \brief The private buffer containing the the log in memory. Log entries are
+ *        written in place, the buffer is the only copy of the log
  *
  * \note Aligned to 4 bytes to keep the wrapping on a 4-byte aligned boundary
  */
 __attribute__ ((aligned(4)))
 static uint8_t log_buffer[LOG_SIZE] = {0};
 
-/*!
- * \var scratch_buffer
- *
- * \brief Scratch buffers needed to hold plain text (and encrypted, if
- *        available) log items to be added
- */
-static uint64_t scratch_buffer[(LOG_SIZE)/8] = {0};
-
 /*!
  * \struct log_vars
  *
@@ -120,6 +138,8 @@ struct log_vars {
                                 zero after a reset, i.e. log is empty */
     uint32_t stored_size;  /*!< Indicates the total size of the items
                                 currently stored in the log */
+    uint32_t first_slot;   /*!< Slot in record_idx of the first element
+                                in chronological order */
 };
 
 /*!
@@ -129,6 +149,15 @@ struct log_vars {
  */
 static struct log_vars log_state = {0};
 
+/*!
+ * \var record_idx
+ *
+ * \brief Index in the log of each record, as a circular array starting at
+ *        log_state.first_slot in chronological order. It avoids walking the
+ *        log to find a record from its record index
+ */
+static uint32_t record_idx[LOG_MAX_RECORDS] = {0};
+
 /*!
  * \var global_timestamp
  *
@@ -141,6 +170,110 @@ static struct log_vars log_state = {0};
  */
 static uint64_t global_timestamp = 0;
 
+#ifdef AUDIT_ITS_PERSISTENCE
+/*!
+ * \def AUDIT_ITS_BLOCK_SIZE
+ *
+ * \brief Size in bytes of the blocks the log is stored in, as one ITS asset
+ *        per block. It must not be greater than the maximum asset size of the
+ *        ITS service
+ */
+#ifndef AUDIT_ITS_BLOCK_SIZE
+#define AUDIT_ITS_BLOCK_SIZE (512)
+#endif
+
+/*!
+ * \def AUDIT_ITS_FLUSH_SIZE
+ *
+ * \brief Size in bytes of the log entries added since the last update of the
+ *        stored copy which triggers a new update
+ */
+#ifndef AUDIT_ITS_FLUSH_SIZE
+#define AUDIT_ITS_FLUSH_SIZE (AUDIT_ITS_BLOCK_SIZE)
+#endif
+
+/*!
+ * \def AUDIT_ITS_UID
+ *
+ * \brief UID of the ITS asset holding the state of the log. The blocks of the
+ *        log are stored at the following UIDs
+ */
+#ifndef AUDIT_ITS_UID
+#define AUDIT_ITS_UID (0x41550000U)
+#endif
+
+/*!
+ * \def AUDIT_ITS_NUM_BLOCKS
+ *
+ * \brief Number of blocks the log is stored in, the last one can be shorter
+ */
+#define AUDIT_ITS_NUM_BLOCKS \
+    ((LOG_SIZE + AUDIT_ITS_BLOCK_SIZE - 1) / AUDIT_ITS_BLOCK_SIZE)
+
+#if (AUDIT_ITS_NUM_BLOCKS > 32)
+#error "The audit log must be stored in 32 ITS blocks at most"
+#endif
+
+/*!
+ * \def AUDIT_ITS_TIMESTAMP_RESERVE
+ *
+ * \brief Number of timestamps reserved each time the upper bound stored in
+ *        ITS is reached. The timestamps handed out since the last update of
+ *        the stored copy are skipped after a reset
+ */
+#ifndef AUDIT_ITS_TIMESTAMP_RESERVE
+#define AUDIT_ITS_TIMESTAMP_RESERVE (64)
+#endif
+
+#if (AUDIT_ITS_TIMESTAMP_RESERVE < 1)
+#error "AUDIT_ITS_TIMESTAMP_RESERVE must be at least 1"
+#endif
+
+/*!
+ * \struct log_its_state
+ *
+ * \brief State of the log as stored in ITS, after the blocks of the log
+ */
+struct log_its_state {
+    struct log_vars vars;       /*!< State variables of the log */
+    uint32_t log_size;          /*!< Log size the blocks were written with */
+    uint64_t timestamp;         /*!< Upper bound of the timestamps used */
+};
+
+/*!
+ * \var its_dirty_blocks
+ *
+ * \brief Bitmap of the blocks of the log changed since the last update of the
+ *        stored copy
+ */
+static uint32_t its_dirty_blocks = 0;
+
+/*!
+ * \var its_unsaved_size
+ *
+ * \brief Size in bytes of the log entries added since the last update of the
+ *        stored copy
+ */
+static uint32_t its_unsaved_size = 0;
+
+/*!
+ * \var its_restored
+ *
+ * \brief Set to 1 once the log has been restored from ITS. The restore is
+ *        done on the first request, as the ITS partition may be initialised
+ *        after this one
+ */
+static uint8_t its_restored = 0U;
+
+/*!
+ * \var its_timestamp_limit
+ *
+ * \brief Upper bound of the timestamps handed out, as stored in ITS. No
+ *        timestamp equal or greater is used before a new bound is stored
+ */
+static uint64_t its_timestamp_limit = 0;
+#endif /* AUDIT_ITS_PERSISTENCE */
+
 /*!
  * \brief Static inline function to get the log buffer ptr from index
  *
@@ -225,141 +358,182 @@ static void audit_update_state(const uint32_t first_el_idx,
 }
 
 /*!
- * \brief Static function to identify the begin and end position for a new write
- *        into the log. It will replace items based on "older entries first"
- *        policy in case not enough space is available in the log
+ * \brief Static inline function to get the index in the log of a record
  *
- * \param[in]  size  Size of the record we need to fit
- * \param[out] begin Pointer to the index to begin
- * \param[out] end   Pointer to the index to end
+ * \param[in] record_index Index of the record, in chronological order
  *
+ * \return Index of the record in the log
  */
-static void audit_replace_record(const uint32_t size,
-                                 uint32_t *begin,
-                                 uint32_t *end)
+__attribute__ ((always_inline)) __STATIC_INLINE
+uint32_t GET_RECORD_LOG_INDEX(const uint32_t record_index)
 {
-    uint32_t first_el_idx = 0, last_el_idx = 0;
-    uint32_t num_items = 0, stored_size = 0;
-    uint32_t start_pos = 0, stop_pos = 0;
+    return record_idx[(log_state.first_slot + record_index) % LOG_MAX_RECORDS];
+}
 
-    /* Retrieve the current state variables of the log */
-    first_el_idx = log_state.first_el_idx;
-    last_el_idx = log_state.last_el_idx;
-    num_items = log_state.num_records;
-    stored_size = log_state.stored_size;
+/*!
+ * \brief Static function to remove the oldest record from the log
+ *
+ * \note The log must not be empty
+ *
+ */
+static void audit_remove_first_record(void)
+{
+    uint32_t first_el_idx = log_state.first_el_idx;
 
-    /* If there is not enough size, remove older entries */
-    while (size > (LOG_SIZE - stored_size)) {
-
-        /* In case we did a full loop without finding space, reset */
-        if (num_items == 0) {
-            first_el_idx = 0;
-            last_el_idx = 0;
-            num_items = 0;
-            stored_size = 0;
-            break;
-        }
+    log_state.stored_size -= COMPUTE_LOG_ENTRY_SIZE(
+                                 *GET_SIZE_FIELD_POINTER(first_el_idx) );
+    log_state.first_el_idx = GET_NEXT_LOG_INDEX(first_el_idx);
+    log_state.first_slot = (log_state.first_slot + 1) % LOG_MAX_RECORDS;
+    log_state.num_records--;
+}
 
-        /* Remove the oldest */
-        stored_size -= COMPUTE_LOG_ENTRY_SIZE(
-                           *GET_SIZE_FIELD_POINTER(first_el_idx) );
-        num_items--;
-        first_el_idx = GET_NEXT_LOG_INDEX(first_el_idx);
+/*!
+ * \brief Static function to reserve the space for a new entry at the end of
+ *        the log. It will replace items based on "older entries first" policy
+ *        in case not enough space is available in the log
+ *
+ * \param[in] entry_size Full size of the log entry to be added
+ *
+ * \return Index in the log where the new entry has to be written
+ */
+static uint32_t audit_reserve_entry(const uint32_t entry_size)
+{
+    /* If there is not enough size, remove older entries */
+    while ((log_state.num_records > 0) &&
+           (entry_size > (LOG_SIZE - log_state.stored_size))) {
+        audit_remove_first_record();
     }
 
-    /* Get the start and stop positions */
-    if (num_items == 0) {
-        start_pos = first_el_idx;
-    } else {
-        start_pos = GET_NEXT_LOG_INDEX(last_el_idx);
+    /* An empty log is written from the position of its first element */
+    if (log_state.num_records == 0) {
+        return log_state.first_el_idx;
     }
-    stop_pos = ((start_pos + COMPUTE_LOG_ENTRY_SIZE(size)) % LOG_SIZE);
 
-    /* Return begin and end positions */
-    *begin = start_pos;
-    *end = stop_pos;
+    return GET_NEXT_LOG_INDEX(log_state.last_el_idx);
+}
 
-    /* Update the state with the new values of variables */
-    audit_update_state(first_el_idx, last_el_idx, stored_size, num_items);
+/*!
+ * \brief Static function to commit an entry written at the end of the log in
+ *        the state variables
+ *
+ * \param[in] start_pos  Index in the log of the entry
+ * \param[in] entry_size Full size of the entry
+ *
+ */
+static void audit_commit_entry(const uint32_t start_pos,
+                               const uint32_t entry_size)
+{
+    record_idx[(log_state.first_slot + log_state.num_records) %
+               LOG_MAX_RECORDS] = start_pos;
+
+    /* The last element is the one just written */
+    audit_update_state(log_state.first_el_idx,
+                       start_pos,
+                       log_state.stored_size + entry_size,
+                       log_state.num_records + 1);
 }
 
+#ifdef AUDIT_ITS_PERSISTENCE
 /*!
- * \brief Static function to perform memory copying into the log buffer. It
- *        takes into account circular wrapping on the log buffer size.
+ * \brief Static function to mark the blocks of the log covering a region as
+ *        changed since the last update of the stored copy
  *
- * \param[in]  src  Pointer to the source buffer
- * \param[in]  size Size in bytes to be copied
- * \param[out] dest Pointer to the destination buffer
+ * \param[in] idx  Index in the log of the region
+ * \param[in] size Size in bytes of the region, which must not wrap
  *
  */
-static psa_status_t audit_buffer_copy(const uint8_t *src,
-                                      const uint32_t size,
-                                      uint8_t *dest)
+static void audit_its_mark_dirty(const uint32_t idx, const uint32_t size)
 {
-    uint32_t idx = 0;
-    uint32_t dest_idx = (uint32_t)dest - (uint32_t)&log_buffer[0];
+    uint32_t block;
 
-    if ((dest_idx >= LOG_SIZE) || (size > LOG_SIZE)) {
-        return PSA_ERROR_BUFFER_TOO_SMALL;
+    if (size == 0) {
+        return;
     }
 
-    /* TODO: This can be an optimized copy using uint32_t
-     *       and enforcing the condition that wrapping
-     *       happens only on 4-byte boundaries
-     */
+    for (block = idx / AUDIT_ITS_BLOCK_SIZE;
+         block <= (idx + size - 1) / AUDIT_ITS_BLOCK_SIZE;
+         block++) {
+        its_dirty_blocks |= 1U << block;
+    }
+}
+#endif
 
-    for (idx = 0; idx < size; idx++) {
-        log_buffer[(dest_idx + idx) % LOG_SIZE] = src[idx];
+/*!
+ * \brief Static function to copy data into the log buffer. It takes into
+ *        account circular wrapping on the log buffer size, the copy is done
+ *        in two contiguous parts at most
+ *
+ * \param[in] idx  Index in the log where to copy the data
+ * \param[in] src  Pointer to the source buffer
+ * \param[in] size Size in bytes to be copied, not greater than LOG_SIZE
+ *
+ * \return Index in the log following the copied data
+ */
+static uint32_t audit_log_write(const uint32_t idx,
+                                const void *src,
+                                const uint32_t size)
+{
+    uint32_t head = LOG_SIZE - idx;
+
+    if (size < head) {
+        head = size;
     }
 
-    return PSA_SUCCESS;
+    (void)memcpy(&log_buffer[idx], src, head);
+    (void)memcpy(&log_buffer[0], (const uint8_t *)src + head, size - head);
+
+#ifdef AUDIT_ITS_PERSISTENCE
+    audit_its_mark_dirty(idx, head);
+    audit_its_mark_dirty(0, size - head);
+#endif
+
+    return (idx + size) % LOG_SIZE;
 }
 
 /*!
- * \brief Static function to emulate memcpy
+ * \brief Static function to copy data out of the log buffer. It takes into
+ *        account circular wrapping on the log buffer size, the copy is done
+ *        in two contiguous parts at most
  *
- * \param[in]  src  Pointer to the source buffer
- * \param[in]  size Size in bytes to be copied
+ * \param[in]  idx  Index in the log where to copy the data from
+ * \param[in]  size Size in bytes to be copied, not greater than LOG_SIZE
  * \param[out] dest Pointer to the destination buffer
  *
  */
-static psa_status_t audit_memcpy(const uint8_t *src,
-                                 const uint32_t size,
-                                 uint8_t *dest)
+static void audit_log_read(const uint32_t idx,
+                           const uint32_t size,
+                           uint8_t *dest)
 {
-    uint32_t idx = 0;
+    uint32_t head = LOG_SIZE - idx;
 
-    for (idx = 0; idx < size; idx++) {
-        dest[idx] = src[idx];
+    if (size < head) {
+        head = size;
     }
 
-    return PSA_SUCCESS;
+    (void)memcpy(dest, &log_buffer[idx], head);
+    (void)memcpy(dest + head, &log_buffer[0], size - head);
 }
 
 /*!
- * \brief Static function to format a log entry before the addition to the log
+ * \brief Static function to write a log entry in place at the given index
  *
- * \param[in]  record       Pointer to the record to be added
- * \param[in]  partition_id Value of the partition ID for the partition which
- *                          originated the audit logging request
- * \param[out] buffer       Pointer to the buffer to format
+ * \param[in] start_pos    Index in the log where to write the entry
+ * \param[in] record       Pointer to the record to be added
+ * \param[in] size         Validated size of the (ID, PAYLOAD) fields, the
+ *                         SIZE field of the record is not read again
+ * \param[in] partition_id Value of the partition ID for the partition which
+ *                         originated the audit logging request
  *
  */
-static psa_status_t audit_format_buffer(const struct psa_audit_record *record,
-                                        const int32_t partition_id,
-                                        uint64_t *buffer)
+static void audit_write_entry(const uint32_t start_pos,
+                              const struct psa_audit_record *record,
+                              const uint32_t size,
+                              const int32_t partition_id)
 {
-    struct log_hdr *hdr = NULL;
-    struct log_tlr *tlr = NULL;
-    uint32_t size;
-    uint8_t idx;
-    psa_status_t status;
-
-    /* Get the size from the record */
-    size = record->size;
-
-    /* Format the scratch buffer with the complete log item */
-    hdr = (struct log_hdr *) buffer;
+    struct log_hdr hdr;
+    struct log_tlr tlr;
+    uint32_t idx;
+    uint8_t mac_idx;
 
     /* FIXME: Timestamping needs to be obtained through Secure Time service, not
      *        yet available. Use a global timestamp for the time being, without
@@ -369,27 +543,237 @@ static psa_status_t audit_format_buffer(const struct psa_audit_record *record,
      *        to be increased every time the timestamp didn't change between
      *        consecutive invocations.
      */
-    hdr->timestamp = global_timestamp++;
-    hdr->iv_counter = 0;
-    hdr->partition_id = partition_id;
-
-    /* Copy the record into the scratch buffer */
-    status = audit_memcpy((const uint8_t *) record,
-                          size+4,
-                          (uint8_t *) &(hdr->size));
+    hdr.timestamp = global_timestamp++;
+    hdr.iv_counter = 0;
+    hdr.partition_id = partition_id;
+    hdr.size = size;
+
+    /* The fixed fields up to SIZE */
+    idx = audit_log_write(start_pos, &hdr, offsetof(struct log_hdr, id));
+
+    /* The (ID, PAYLOAD) fields are copied from the caller straight into the
+     * log, with the size validated by the caller
+     */
+    idx = audit_log_write(idx, &record->id, size);
+
+    /* FIXME: The MAC here is just a dummy value for prototyping. It will be
+     *        filled by a call to the crypto interface directly when available.
+     */
+    for (mac_idx = 0; mac_idx < LOG_MAC_SIZE; mac_idx++) {
+        tlr.mac[mac_idx] = mac_idx;
+    }
+    (void)audit_log_write(idx, &tlr, LOG_MAC_SIZE);
+}
+
+#ifdef AUDIT_ITS_PERSISTENCE
+/*!
+ * \brief Static function to update the stored copy of the log in ITS. Only
+ *        the changed blocks are written, followed by the state of the log
+ *
+ * \return Returns values as specified by the \ref psa_status_t
+ */
+static psa_status_t audit_its_flush(void)
+{
+    struct log_its_state its_state;
+    uint32_t block, size;
+    psa_status_t status;
+
+    for (block = 0; block < AUDIT_ITS_NUM_BLOCKS; block++) {
+        if ((its_dirty_blocks & (1U << block)) == 0) {
+            continue;
+        }
+
+        size = LOG_SIZE - (block * AUDIT_ITS_BLOCK_SIZE);
+        if (size > AUDIT_ITS_BLOCK_SIZE) {
+            size = AUDIT_ITS_BLOCK_SIZE;
+        }
+
+        status = psa_its_set(AUDIT_ITS_UID + 1 + block, size,
+                             &log_buffer[block * AUDIT_ITS_BLOCK_SIZE],
+                             PSA_STORAGE_FLAG_NONE);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+
+        its_dirty_blocks &= ~(1U << block);
+    }
+
+    its_state.vars = log_state;
+    its_state.log_size = LOG_SIZE;
+    its_state.timestamp = its_timestamp_limit;
+
+    status = psa_its_set(AUDIT_ITS_UID, sizeof(its_state), &its_state,
+                         PSA_STORAGE_FLAG_NONE);
     if (status != PSA_SUCCESS) {
         return status;
     }
 
-    /* FIXME: The MAC here is just a dummy value for prototyping. It will be
-     *        filled by a call to the crypto interface directly when available.
+    its_unsaved_size = 0;
+
+    return PSA_SUCCESS;
+}
+
+/*!
+ * \brief Static function to restore the log from ITS on the first request.
+ *        The log is left empty if there is no valid stored copy
+ *
+ * \return Returns values as specified by the \ref psa_status_t
+ */
+static psa_status_t audit_its_restore(void)
+{
+    struct log_its_state its_state;
+    uint32_t block, size, idx, num, stored_size = 0;
+    size_t data_length;
+    psa_status_t status;
+
+    if (its_restored == 1U) {
+        return PSA_SUCCESS;
+    }
+
+    status = psa_its_get(AUDIT_ITS_UID, 0, sizeof(its_state), &its_state,
+                         &data_length);
+    if (status == PSA_ERROR_DOES_NOT_EXIST) {
+        its_restored = 1U;
+        return PSA_SUCCESS;
+    }
+
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (data_length == sizeof(its_state)) {
+        /* Timestamps keep increasing even if the stored log is discarded */
+        global_timestamp = its_state.timestamp;
+        its_timestamp_limit = its_state.timestamp;
+    }
+
+    if ((data_length != sizeof(its_state)) ||
+        (its_state.log_size != LOG_SIZE) ||
+        (its_state.vars.num_records > LOG_MAX_RECORDS) ||
+        (its_state.vars.first_el_idx >= LOG_SIZE)) {
+        /* Stored with a different configuration, start from an empty log */
+        its_restored = 1U;
+        return PSA_SUCCESS;
+    }
+
+    for (block = 0; block < AUDIT_ITS_NUM_BLOCKS; block++) {
+        size = LOG_SIZE - (block * AUDIT_ITS_BLOCK_SIZE);
+        if (size > AUDIT_ITS_BLOCK_SIZE) {
+            size = AUDIT_ITS_BLOCK_SIZE;
+        }
+
+        status = psa_its_get(AUDIT_ITS_UID + 1 + block, 0, size,
+                             &log_buffer[block * AUDIT_ITS_BLOCK_SIZE],
+                             &data_length);
+        if ((status == PSA_ERROR_DOES_NOT_EXIST) ||
+            ((status == PSA_SUCCESS) && (data_length != size))) {
+            its_restored = 1U;
+            return PSA_SUCCESS;
+        }
+
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+    }
+
+    /* Rebuild the record indexes, checking that the records stored are
+     * consistent with the state, which is written last
      */
-    tlr = (struct log_tlr *) ((uint8_t *)hdr + LOG_FIXED_FIELD_SIZE + size);
-    for (idx=0; idx<LOG_MAC_SIZE; idx++) {
-        tlr->mac[idx] = idx;
+    idx = its_state.vars.first_el_idx;
+    for (num = 0; num < its_state.vars.num_records; num++) {
+        size = *GET_SIZE_FIELD_POINTER(idx);
+        if ((size % 4) ||
+            (size > (LOG_SIZE - (LOG_FIXED_FIELD_SIZE + LOG_MAC_SIZE))) ||
+            (COMPUTE_LOG_ENTRY_SIZE(size) > (LOG_SIZE - stored_size))) {
+            its_restored = 1U;
+            return PSA_SUCCESS;
+        }
+
+        record_idx[num] = idx;
+        stored_size += COMPUTE_LOG_ENTRY_SIZE(size);
+        idx = GET_NEXT_LOG_INDEX(idx);
+    }
+
+    if ((stored_size != its_state.vars.stored_size) ||
+        ((num > 0) && (record_idx[num - 1] != its_state.vars.last_el_idx))) {
+        its_restored = 1U;
+        return PSA_SUCCESS;
     }
 
+    log_state = its_state.vars;
+    log_state.first_slot = 0;
+    its_restored = 1U;
+
+    return PSA_SUCCESS;
+}
+#endif /* AUDIT_ITS_PERSISTENCE */
+
+/*!
+ * \brief Static function to restore the log from persistent storage, if
+ *        supported, before it is accessed for the first time
+ *
+ * \return Returns values as specified by the \ref psa_status_t
+ */
+static psa_status_t audit_log_restore(void)
+{
+#ifdef AUDIT_ITS_PERSISTENCE
+    return audit_its_restore();
+#else
     return PSA_SUCCESS;
+#endif
+}
+
+/*!
+ * \brief Static function to make sure the next timestamp can be handed out,
+ *        storing a new upper bound of the timestamps used if supported
+ *
+ * \return Returns values as specified by the \ref psa_status_t
+ */
+static psa_status_t audit_log_reserve_timestamp(void)
+{
+#ifdef AUDIT_ITS_PERSISTENCE
+    psa_status_t status;
+
+    if (global_timestamp < its_timestamp_limit) {
+        return PSA_SUCCESS;
+    }
+
+    /* The stored copy is updated with the new bound before any timestamp
+     * beyond the previous one is used, so none is repeated after a reset
+     */
+    its_timestamp_limit = global_timestamp + AUDIT_ITS_TIMESTAMP_RESERVE;
+
+    status = audit_its_flush();
+    if (status != PSA_SUCCESS) {
+        its_timestamp_limit = global_timestamp;
+    }
+
+    return status;
+#else
+    return PSA_SUCCESS;
+#endif
+}
+
+/*!
+ * \brief Static function to update the stored copy of the log, if supported,
+ *        once enough has changed. A failed update is retried on the next
+ *        change
+ *
+ * \param[in] added_size Size in bytes of the entries added to the log, 0 to
+ *                       force the update
+ *
+ */
+static void audit_log_persist(const uint32_t added_size)
+{
+#ifdef AUDIT_ITS_PERSISTENCE
+    its_unsaved_size += added_size;
+
+    if ((added_size == 0) || (its_unsaved_size >= AUDIT_ITS_FLUSH_SIZE)) {
+        (void)audit_its_flush();
+    }
+#else
+    (void)added_size;
+#endif
 }
 
 /*!
@@ -422,36 +806,16 @@ static void audit_uart_redirection(const uint32_t start_idx)
 #endif
 }
 
-static psa_status_t _audit_core_get_info(uint32_t *num_records, uint32_t *size)
-{
-    /* Return the number of records that are currently stored */
-    *num_records = log_state.num_records;
-
-    /* Return the size of the records currently stored */
-    *size = log_state.stored_size;
-
-    return PSA_SUCCESS;
-}
-
 static psa_status_t _audit_core_get_record_info(const uint32_t record_index,
                                                 uint32_t *size)
 {
-    uint32_t start_idx, idx;
-
     if (record_index >= log_state.num_records) {
         return PSA_ERROR_PROGRAMMER_ERROR;
     }
 
-    /* First element to read from the log */
-    start_idx = log_state.first_el_idx;
-
-    /* Move the start_idx index to the desired element */
-    for (idx = 0; idx < record_index; idx++) {
-        start_idx = GET_NEXT_LOG_INDEX(start_idx);
-    }
-
     /* Get the size of the requested record */
-    *size = COMPUTE_LOG_ENTRY_SIZE(*GET_SIZE_FIELD_POINTER(start_idx));
+    *size = COMPUTE_LOG_ENTRY_SIZE(
+                *GET_SIZE_FIELD_POINTER(GET_RECORD_LOG_INDEX(record_index)));
 
     return PSA_SUCCESS;
 }
@@ -493,7 +857,7 @@ psa_status_t audit_core_delete_record(psa_invec in_vec[],
                                       psa_outvec out_vec[],
                                       size_t out_len)
 {
-    uint32_t first_el_idx, size_removed;
+    psa_status_t status;
 
     if ((in_len != 2) || (out_len != 0)) {
         return PSA_ERROR_CONNECTION_REFUSED;
@@ -523,36 +887,27 @@ psa_status_t audit_core_delete_record(psa_invec in_vec[],
         return PSA_ERROR_NOT_SUPPORTED;
     }
 
+    status = audit_log_restore();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
     /* Check that the record index to be removed is contained in the log */
     if (record_index >= log_state.num_records) {
         return PSA_ERROR_PROGRAMMER_ERROR;
     }
 
-    /* If the log contains just one element, reset the state and return */
     if (log_state.num_records == 1) {
-
-        /* Clear the log state variables */
+        /* If the log contains just one element, reset the state */
         audit_update_state(0,0,0,0);
-
-        return PSA_SUCCESS;
+    } else {
+        /* Remove the oldest entry, it means moving the first element to the
+         * next log index */
+        audit_remove_first_record();
     }
 
-    /* Get the index to the element to be removed */
-    first_el_idx = log_state.first_el_idx;
-
-    /* Get the size of the element that is being removed */
-    size_removed = COMPUTE_LOG_ENTRY_SIZE(
-                                         *GET_SIZE_FIELD_POINTER(first_el_idx));
-
-    /* Remove the oldest entry, it means moving the first element to the
-     * next log index */
-    first_el_idx = GET_NEXT_LOG_INDEX(first_el_idx);
-
-    /* Update the state with the new head and decrease the number of records
-     * currently stored and the new size of the stored records */
-    log_state.first_el_idx = first_el_idx;
-    log_state.num_records--;
-    log_state.stored_size -= size_removed;
+    /* A removal is stored straight away, it only changes the state */
+    audit_log_persist(0);
 
     return PSA_SUCCESS;
 }
@@ -562,6 +917,8 @@ psa_status_t audit_core_get_info(psa_invec in_vec[],
                                  psa_outvec out_vec[],
                                  size_t out_len)
 {
+    psa_status_t status;
+
     if ((in_len != 0) || (out_len != 2)) {
         return PSA_ERROR_CONNECTION_REFUSED;
     }
@@ -574,6 +931,11 @@ psa_status_t audit_core_get_info(psa_invec in_vec[],
     uint32_t *num_records = out_vec[0].base;
     uint32_t *size = out_vec[1].base;
 
+    status = audit_log_restore();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
     /* Return the number of records that are currently stored */
     *num_records = log_state.num_records;
 
@@ -588,7 +950,7 @@ psa_status_t audit_core_get_record_info(psa_invec in_vec[],
                                         psa_outvec out_vec[],
                                         size_t out_len)
 {
-    uint32_t start_idx, idx;
+    psa_status_t status;
 
     if ((in_len != 1) || (out_len != 1)) {
         return PSA_ERROR_CONNECTION_REFUSED;
@@ -602,22 +964,12 @@ psa_status_t audit_core_get_record_info(psa_invec in_vec[],
     const uint32_t record_index = *((uint32_t *)in_vec[0].base);
     uint32_t *size = out_vec[0].base;
 
-    if (record_index >= log_state.num_records) {
-        return PSA_ERROR_PROGRAMMER_ERROR;
-    }
-
-    /* First element to read from the log */
-    start_idx = log_state.first_el_idx;
-
-    /* Move the start_idx index to the desired element */
-    for (idx = 0; idx < record_index; idx++) {
-        start_idx = GET_NEXT_LOG_INDEX(start_idx);
+    status = audit_log_restore();
+    if (status != PSA_SUCCESS) {
+        return status;
     }
 
-    /* Get the size of the requested record */
-    *size = COMPUTE_LOG_ENTRY_SIZE(*GET_SIZE_FIELD_POINTER(start_idx));
-
-    return PSA_SUCCESS;
+    return _audit_core_get_record_info(record_index, size);
 }
 
 psa_status_t audit_core_add_record(psa_invec in_vec[],
@@ -625,9 +977,7 @@ psa_status_t audit_core_add_record(psa_invec in_vec[],
                                    psa_outvec out_vec[],
                                    size_t out_len)
 {
-    uint32_t start_pos = 0, stop_pos = 0;
-    uint32_t first_el_idx = 0, last_el_idx = 0, size = 0;
-    uint32_t num_items = 0, stored_size = 0;
+    uint32_t start_pos = 0, size = 0, entry_size = 0;
     int32_t partition_id;
     psa_status_t status;
 
@@ -666,63 +1016,34 @@ psa_status_t audit_core_add_record(psa_invec in_vec[],
         return PSA_ERROR_INSUFFICIENT_MEMORY;
     }
 
-    /* Get the size in bytes and num of elements present in the log */
-    status = _audit_core_get_info(&num_items, &stored_size);
-    if (status !=  PSA_SUCCESS) {
-        return status;
-    }
-
-    if (num_items == 0) {
-
-        start_pos = 0;
-
-    } else {
-
-        /* The log is not empty, need to decide the candidate position
-         * and invalidate older entries in case there is not enough space
-         */
-        audit_replace_record(COMPUTE_LOG_ENTRY_SIZE(size),
-                             &start_pos,
-                             &stop_pos);
-    }
-
-    /* Format the scratch buffer with the complete log item */
-    status = audit_format_buffer(record, partition_id, &scratch_buffer[0]);
+    status = audit_log_restore();
     if (status != PSA_SUCCESS) {
         return status;
     }
 
-    /* TODO: At this point, encryption should be called if supported */
-
-    /* Do the copy of the log item to be added in the log */
-    status = audit_buffer_copy((const uint8_t *) &scratch_buffer[0],
-                               COMPUTE_LOG_ENTRY_SIZE(size),
-                               (uint8_t *) &log_buffer[start_pos]);
+    status = audit_log_reserve_timestamp();
     if (status != PSA_SUCCESS) {
         return status;
     }
 
-    /* Retrieve current log state */
-    first_el_idx = log_state.first_el_idx;
-    num_items = log_state.num_records;
-    stored_size = log_state.stored_size;
+    entry_size = COMPUTE_LOG_ENTRY_SIZE(size);
 
-    /* The last element is the one we just added */
-    last_el_idx = start_pos;
+    /* Decide the position of the new entry, invalidating older entries in
+     * case there is not enough space
+     */
+    start_pos = audit_reserve_entry(entry_size);
 
-    /* Update the number of items and stored size */
-    num_items++;
-    stored_size += COMPUTE_LOG_ENTRY_SIZE(size);
+    /* TODO: At this point, encryption should be called if supported */
 
-    /* Update the log state */
-    audit_update_state(first_el_idx, last_el_idx, stored_size, num_items);
+    /* Write the log item in place and add it to the log */
+    audit_write_entry(start_pos, record, size, partition_id);
+    audit_commit_entry(start_pos, entry_size);
 
-    /* TODO: At this point, we would need to update the stored copy in
-     *       persistent storage. Need to define a strategy for this
-     */
+    /* Update the stored copy of the log, if any, once enough was added */
+    audit_log_persist(entry_size);
 
     /* Stream to a secure UART if available for the platform and built */
-    audit_uart_redirection(last_el_idx);
+    audit_uart_redirection(start_pos);
 
     return PSA_SUCCESS;
 }
@@ -732,7 +1053,7 @@ psa_status_t audit_core_retrieve_record(psa_invec in_vec[],
                                         psa_outvec out_vec[],
                                         size_t out_len)
 {
-    uint32_t idx, start_idx, record_size_tmp;
+    uint32_t record_size_tmp;
     psa_status_t status;
 
     if ((in_len != 2) || (out_len != 1)) {
@@ -757,6 +1078,12 @@ psa_status_t audit_core_retrieve_record(psa_invec in_vec[],
         return PSA_ERROR_NOT_SUPPORTED;
     }
 
+    status = audit_log_restore();
+    if (status != PSA_SUCCESS) {
+        out_vec[0].len = 0;
+        return status;
+    }
+
     /* Get the size of the record we want to retrieve */
     status = _audit_core_get_record_info(record_index, &record_size_tmp);
 
@@ -772,21 +1099,86 @@ psa_status_t audit_core_retrieve_record(psa_invec in_vec[],
         return PSA_ERROR_BUFFER_TOO_SMALL;
     }
 
-    /* First element to read from the log */
-    start_idx = log_state.first_el_idx;
+    /* Do the copy */
+    audit_log_read(GET_RECORD_LOG_INDEX(record_index), record_size_tmp, buffer);
+
+    /* Update the retrieved size */
+    out_vec[0].len = record_size_tmp;
 
-    /* Move the start_idx index to the desired element */
-    for (idx=0; idx<record_index; idx++) {
-        start_idx = GET_NEXT_LOG_INDEX(start_idx);
+    return PSA_SUCCESS;
+}
+
+psa_status_t audit_core_retrieve_records(psa_invec in_vec[],
+                                         size_t in_len,
+                                         psa_outvec out_vec[],
+                                         size_t out_len)
+{
+    uint32_t record_index, record_size_tmp, retrieved_size = 0;
+    psa_status_t status;
+
+    if ((in_len != 2) || (out_len != 2)) {
+        return PSA_ERROR_CONNECTION_REFUSED;
     }
 
-    /* Do the copy */
-    for (idx=0; idx<record_size_tmp; idx++) {
-        buffer[idx] = log_buffer[(start_idx + idx) % LOG_SIZE];
+    if ((in_vec[0].len != sizeof(struct psa_audit_records_range)) ||
+        (out_vec[1].len != sizeof(uint32_t))) {
+        return PSA_ERROR_CONNECTION_REFUSED;
     }
 
-    /* Update the retrieved size */
-    out_vec[0].len = record_size_tmp;
+    const struct psa_audit_records_range *range = in_vec[0].base;
+    const uint8_t *token = in_vec[1].base;
+    const uint32_t token_size = in_vec[1].len;
+    uint8_t *buffer = out_vec[0].base;
+    uint32_t buffer_size = out_vec[0].len;
+    uint32_t *retrieved_records = out_vec[1].base;
+
+    out_vec[0].len = 0;
+    *retrieved_records = 0;
+
+    /* FixMe: Currently token and token_size parameters are not evaluated
+     *        to be used as a challenge for encryption as encryption support
+     *        is still not yet available
+     */
+    if ((token != NULL) || (token_size != 0)) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    status = audit_log_restore();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (range->first_index >= log_state.num_records) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+
+    /* Consecutive records are contiguous in the log, so the records which
+     * fit in the buffer are copied at once
+     */
+    for (record_index = range->first_index;
+         (record_index < log_state.num_records) &&
+         (record_index - range->first_index < range->num_records);
+         record_index++) {
+
+        (void)_audit_core_get_record_info(record_index, &record_size_tmp);
+        if (record_size_tmp > (buffer_size - retrieved_size)) {
+            break;
+        }
+
+        retrieved_size += record_size_tmp;
+    }
+
+    /* buffer_size must be enough to hold at least the first record */
+    if ((range->num_records > 0) && (retrieved_size == 0)) {
+        return PSA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    audit_log_read(GET_RECORD_LOG_INDEX(range->first_index),
+                   retrieved_size, buffer);
+
+    /* Update the number of records and the size retrieved */
+    *retrieved_records = record_index - range->first_index;
+    out_vec[0].len = retrieved_size;
 
     return PSA_SUCCESS;
 }
@@ -49,6 +49,8 @@ extern "C" {
  * must be less than LOG_SIZE - MAC_SIZE - 12 and equal or greater than
  * LOG_MIN_SIZE
  *
+ * LOG_SIZE: set at build time through AUDIT_LOG_SIZE (1024 bytes by default)
+ *
  */
 
 /*!
@@ -141,6 +143,7 @@ psa_status_t audit_core_init(void);
     X(audit_core_get_record_info)            \
     X(audit_core_add_record)                 \
     X(audit_core_retrieve_record)            \
+    X(audit_core_retrieve_records)           \
 
 #define X(api_name) UNIFORM_SIGNATURE_API(api_name);
 LIST_TFM_AUDIT_UNIFORM_SIGNATURE_API
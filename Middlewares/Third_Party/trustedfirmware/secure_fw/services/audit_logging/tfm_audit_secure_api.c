@@ -49,6 +49,37 @@ psa_status_t psa_audit_retrieve_record(const uint32_t record_index,
     return status;
 }
 
+__attribute__((section("SFN")))
+psa_status_t psa_audit_retrieve_records(const uint32_t first_index,
+                                        const uint32_t num_records,
+                                        const uint32_t buffer_size,
+                                        const uint8_t *token,
+                                        const uint32_t token_size,
+                                        uint8_t *buffer,
+                                        uint32_t *retrieved_records,
+                                        uint32_t *retrieved_size)
+{
+    psa_status_t status;
+    struct psa_audit_records_range range = {
+        .first_index = first_index,
+        .num_records = num_records,
+    };
+    psa_invec in_vec[] = {
+        {.base = &range, .len = sizeof(struct psa_audit_records_range)},
+        {.base = token, .len = token_size},
+    };
+    psa_outvec out_vec[] = {
+        {.base = buffer, .len = buffer_size},
+        {.base = retrieved_records, .len = sizeof(uint32_t)},
+    };
+
+    status = API_DISPATCH(audit_core_retrieve_records);
+
+    *retrieved_size = out_vec[0].len;
+
+    return status;
+}
+
 __attribute__((section("SFN")))
 psa_status_t psa_audit_get_info(uint32_t *num_records, uint32_t *size)
 {
@@ -18,28 +18,189 @@
  * \def TFM_CRYPTO_CONC_OPER_NUM
  *
  * \brief This is the default value for the maximum number of concurrent
- *        operations that can be active (allocated) at any time, supported
- *        by the implementation
+ *        operations (cipher, MAC, hash, generator) that can be active
+ *        (allocated) at any time, supported by the implementation. It is
+ *        also the default size of each of the per-type pools below, so that
+ *        a single type can use all of them as with a shared pool
  */
 #ifndef TFM_CRYPTO_CONC_OPER_NUM
 #define TFM_CRYPTO_CONC_OPER_NUM (8)
 #endif
 
+/**
+ * \def TFM_CRYPTO_CONC_HASH_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        hash operations that can be active (allocated) at any time,
+ *        supported by the implementation
+ */
+#ifndef TFM_CRYPTO_CONC_HASH_OPER_NUM
+#if (TFM_CRYPTO_HASH_MODULE_DISABLED != 0)
+#define TFM_CRYPTO_CONC_HASH_OPER_NUM (0)
+#else
+#define TFM_CRYPTO_CONC_HASH_OPER_NUM TFM_CRYPTO_CONC_OPER_NUM
+#endif
+#endif
+
+/**
+ * \def TFM_CRYPTO_CONC_MAC_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        MAC operations that can be active (allocated) at any time,
+ *        supported by the implementation
+ */
+#ifndef TFM_CRYPTO_CONC_MAC_OPER_NUM
+#if (TFM_CRYPTO_MAC_MODULE_DISABLED != 0)
+#define TFM_CRYPTO_CONC_MAC_OPER_NUM (0)
+#else
+#define TFM_CRYPTO_CONC_MAC_OPER_NUM TFM_CRYPTO_CONC_OPER_NUM
+#endif
+#endif
+
+/**
+ * \def TFM_CRYPTO_CONC_CIPHER_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        cipher operations that can be active (allocated) at any time,
+ *        supported by the implementation
+ */
+#ifndef TFM_CRYPTO_CONC_CIPHER_OPER_NUM
+#if (TFM_CRYPTO_CIPHER_MODULE_DISABLED != 0)
+#define TFM_CRYPTO_CONC_CIPHER_OPER_NUM (0)
+#else
+#define TFM_CRYPTO_CONC_CIPHER_OPER_NUM TFM_CRYPTO_CONC_OPER_NUM
+#endif
+#endif
+
+/**
+ * \def TFM_CRYPTO_CONC_GENERATOR_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        generator operations that can be active (allocated) at any time,
+ *        supported by the implementation
+ */
+#ifndef TFM_CRYPTO_CONC_GENERATOR_OPER_NUM
+#if (TFM_CRYPTO_GENERATOR_MODULE_DISABLED != 0)
+#define TFM_CRYPTO_CONC_GENERATOR_OPER_NUM (0)
+#else
+#define TFM_CRYPTO_CONC_GENERATOR_OPER_NUM TFM_CRYPTO_CONC_OPER_NUM
+#endif
+#endif
+
+/**
+ * \brief Total number of slots in the per-type pools
+ */
+#define TFM_CRYPTO_OPER_SLOT_NUM (TFM_CRYPTO_CONC_CIPHER_OPER_NUM + \
+                                  TFM_CRYPTO_CONC_MAC_OPER_NUM + \
+                                  TFM_CRYPTO_CONC_HASH_OPER_NUM + \
+                                  TFM_CRYPTO_CONC_GENERATOR_OPER_NUM)
+
+/*
+ * A handle encodes the slot it refers to, so that it can be resolved with a
+ * bounds check instead of a search:
+ *
+ *   bits [7:0]   slot index, plus one
+ *   bits [31:8]  generation of the slot when the handle was allocated
+ *
+ * The generation of a slot is incremented every time the slot is released,
+ * so a stale copy of a released handle never resolves to a context which has
+ * been reallocated in the meantime. A valid handle is never equal to
+ * TFM_CRYPTO_INVALID_HANDLE, as the index field is never zero.
+ */
+#define TFM_CRYPTO_HANDLE_IDX_MASK (0xFFu)
+#define TFM_CRYPTO_HANDLE_GEN_POS  (8u)
+#define TFM_CRYPTO_HANDLE_GEN_MASK (0xFFFFFFu)
+
+#if (TFM_CRYPTO_OPER_SLOT_NUM == 0)
+#error "At least one operation type must be enabled in the Crypto service"
+#endif
+#if (TFM_CRYPTO_OPER_SLOT_NUM > TFM_CRYPTO_HANDLE_IDX_MASK)
+#error "Too many concurrent operations for the handle format"
+#endif
+
+/* Marks the end of a free list */
+#define TFM_CRYPTO_FREE_LIST_END (UINT32_MAX)
+
 struct tfm_crypto_operation_s {
     uint32_t in_use;                /*!< Indicates if the operation is in use */
     int32_t owner;                  /*!< Indicates an ID of the owner of
                                      *   the context
                                      */
     enum tfm_crypto_operation_type type; /*!< Type of the operation */
-    union {
-        psa_cipher_operation_t cipher;    /*!< Cipher operation context */
-        psa_mac_operation_t mac;          /*!< MAC operation context */
-        psa_hash_operation_t hash;        /*!< Hash operation context */
-        psa_crypto_generator_t generator; /*!< Generator operation context */
-    } operation;
+    uint32_t generation;            /*!< Generation of the slot, incremented
+                                     *   on each release
+                                     */
+    uint32_t next_free;             /*!< Index of the next free slot of the
+                                     *   same type, when not in use
+                                     */
+    void *ctx;                      /*!< Context in the pool of the type */
 };
 
-static struct tfm_crypto_operation_s operation[TFM_CRYPTO_CONC_OPER_NUM] ={{0}};
+static struct tfm_crypto_operation_s operation[TFM_CRYPTO_OPER_SLOT_NUM];
+
+/*
+ * The contexts are kept in a pool per operation type, each sized for its own
+ * type, rather than in a union sized for the largest one.
+ */
+#if (TFM_CRYPTO_CONC_CIPHER_OPER_NUM > 0)
+static psa_cipher_operation_t cipher_ctx[TFM_CRYPTO_CONC_CIPHER_OPER_NUM];
+#endif
+#if (TFM_CRYPTO_CONC_MAC_OPER_NUM > 0)
+static psa_mac_operation_t mac_ctx[TFM_CRYPTO_CONC_MAC_OPER_NUM];
+#endif
+#if (TFM_CRYPTO_CONC_HASH_OPER_NUM > 0)
+static psa_hash_operation_t hash_ctx[TFM_CRYPTO_CONC_HASH_OPER_NUM];
+#endif
+#if (TFM_CRYPTO_CONC_GENERATOR_OPER_NUM > 0)
+static psa_crypto_generator_t generator_ctx[TFM_CRYPTO_CONC_GENERATOR_OPER_NUM];
+#endif
+
+/*
+ * \brief Index of the first free slot of each type, indexed by
+ *        \ref tfm_crypto_operation_type
+ */
+static uint32_t free_head[TFM_CRYPTO_GENERATOR_OPERATION + 1];
+
+/*
+ * \brief Number of operations of any type currently active, which is limited
+ *        to TFM_CRYPTO_CONC_OPER_NUM
+ */
+static uint32_t oper_in_use;
+
+/*
+ * \brief Function used to add a pool of contexts to the slot table
+ *
+ * \param[in] type     Type of the contexts in the pool
+ * \param[in] pool     Base of the array of contexts
+ * \param[in] ctx_size Size of a single context
+ * \param[in] num      Number of contexts in the pool
+ * \param[in] first    Index of the first slot to use for the pool
+ *
+ * \return Index of the first slot following the pool
+ */
+static uint32_t init_pool(enum tfm_crypto_operation_type type,
+                          void *pool,
+                          uint32_t ctx_size,
+                          uint32_t num,
+                          uint32_t first)
+{
+    uint32_t i;
+
+    /* Clear the contents of the local contexts */
+    (void)tfm_memset(pool, 0, num * ctx_size);
+
+    /* Chain all the slots of the pool in the free list of the type */
+    for (i = 0; i < num; i++) {
+        operation[first + i].type = type;
+        operation[first + i].ctx = (uint8_t *)pool + (i * ctx_size);
+        operation[first + i].next_free = (i + 1 < num) ?
+                                         (first + i + 1) :
+                                         TFM_CRYPTO_FREE_LIST_END;
+    }
+    free_head[type] = (num > 0) ? first : TFM_CRYPTO_FREE_LIST_END;
+
+    return first + num;
+}
 
 /*
  * \brief Function used to clear the memory associated to a backend context
@@ -53,8 +214,6 @@ static void memset_operation_context(uint32_t index)
 {
     uint32_t mem_size;
 
-    uint8_t *mem_ptr = (uint8_t *) &(operation[index].operation);
-
     switch(operation[index].type) {
     case TFM_CRYPTO_CIPHER_OPERATION:
         mem_size = sizeof(psa_cipher_operation_t);
@@ -75,7 +234,36 @@ static void memset_operation_context(uint32_t index)
     }
 
     /* Clear the contents of the backend context */
-    (void)tfm_memset(mem_ptr, 0, mem_size);
+    (void)tfm_memset(operation[index].ctx, 0, mem_size);
+}
+
+/*
+ * \brief Function used to resolve a handle to the slot it refers to
+ *
+ * \param[in] handle       Handle to resolve
+ * \param[in] partition_id ID of the caller, which must own the slot
+ *
+ * \return The slot, or NULL if the handle does not refer to a context in use
+ *         owned by the caller
+ */
+static struct tfm_crypto_operation_s *resolve_handle(uint32_t handle,
+                                                     int32_t partition_id)
+{
+    uint32_t idx = handle & TFM_CRYPTO_HANDLE_IDX_MASK;
+    struct tfm_crypto_operation_s *op;
+
+    if ((idx == 0) || (idx > TFM_CRYPTO_OPER_SLOT_NUM)) {
+        return NULL;
+    }
+
+    op = &operation[idx - 1];
+    if ((op->in_use != TFM_CRYPTO_IN_USE) ||
+        (op->generation != (handle >> TFM_CRYPTO_HANDLE_GEN_POS)) ||
+        (op->owner != partition_id)) {
+        return NULL;
+    }
+
+    return op;
 }
 
 /*!
@@ -86,8 +274,42 @@ static void memset_operation_context(uint32_t index)
 /*!@{*/
 psa_status_t tfm_crypto_init_alloc(void)
 {
-    /* Clear the contents of the local contexts */
+    uint32_t next = 0;
+
     (void)tfm_memset(operation, 0, sizeof(operation));
+    oper_in_use = 0;
+
+#if (TFM_CRYPTO_CONC_CIPHER_OPER_NUM > 0)
+    next = init_pool(TFM_CRYPTO_CIPHER_OPERATION, cipher_ctx,
+                     sizeof(psa_cipher_operation_t),
+                     TFM_CRYPTO_CONC_CIPHER_OPER_NUM, next);
+#else
+    free_head[TFM_CRYPTO_CIPHER_OPERATION] = TFM_CRYPTO_FREE_LIST_END;
+#endif
+#if (TFM_CRYPTO_CONC_MAC_OPER_NUM > 0)
+    next = init_pool(TFM_CRYPTO_MAC_OPERATION, mac_ctx,
+                     sizeof(psa_mac_operation_t),
+                     TFM_CRYPTO_CONC_MAC_OPER_NUM, next);
+#else
+    free_head[TFM_CRYPTO_MAC_OPERATION] = TFM_CRYPTO_FREE_LIST_END;
+#endif
+#if (TFM_CRYPTO_CONC_HASH_OPER_NUM > 0)
+    next = init_pool(TFM_CRYPTO_HASH_OPERATION, hash_ctx,
+                     sizeof(psa_hash_operation_t),
+                     TFM_CRYPTO_CONC_HASH_OPER_NUM, next);
+#else
+    free_head[TFM_CRYPTO_HASH_OPERATION] = TFM_CRYPTO_FREE_LIST_END;
+#endif
+#if (TFM_CRYPTO_CONC_GENERATOR_OPER_NUM > 0)
+    next = init_pool(TFM_CRYPTO_GENERATOR_OPERATION, generator_ctx,
+                     sizeof(psa_crypto_generator_t),
+                     TFM_CRYPTO_CONC_GENERATOR_OPER_NUM, next);
+#else
+    free_head[TFM_CRYPTO_GENERATOR_OPERATION] = TFM_CRYPTO_FREE_LIST_END;
+#endif
+    free_head[TFM_CRYPTO_OPERATION_NONE] = TFM_CRYPTO_FREE_LIST_END;
+
+    (void)next;
     return PSA_SUCCESS;
 }
 
@@ -95,7 +317,7 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
                                         uint32_t *handle,
                                         void **ctx)
 {
-    uint32_t i = 0;
+    uint32_t i;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -115,23 +337,29 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
     }
     *ctx = NULL;
 
-    for (i=0; i<TFM_CRYPTO_CONC_OPER_NUM; i++) {
-        if (operation[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            operation[i].in_use = TFM_CRYPTO_IN_USE;
-            operation[i].owner = partition_id;
-            operation[i].type = type;
-            *handle = i + 1;
-            *ctx = (void *) &(operation[i].operation);
-            return PSA_SUCCESS;
-        }
+    if ((uint32_t)type > TFM_CRYPTO_GENERATOR_OPERATION) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+    /* Take the first free slot of the type, within the overall limit */
+    i = free_head[type];
+    if ((i == TFM_CRYPTO_FREE_LIST_END) ||
+        (oper_in_use >= TFM_CRYPTO_CONC_OPER_NUM)) {
+        return PSA_ERROR_NOT_PERMITTED;
     }
+    free_head[type] = operation[i].next_free;
+    oper_in_use++;
 
-    return PSA_ERROR_NOT_PERMITTED;
+    operation[i].in_use = TFM_CRYPTO_IN_USE;
+    operation[i].owner = partition_id;
+    *handle = (operation[i].generation << TFM_CRYPTO_HANDLE_GEN_POS) | (i + 1);
+    *ctx = operation[i].ctx;
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_release(uint32_t *handle)
 {
-    uint32_t h_val = *handle;
+    struct tfm_crypto_operation_s *op;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -140,26 +368,30 @@ psa_status_t tfm_crypto_operation_release(uint32_t *handle)
         return status;
     }
 
-    if ( (h_val != TFM_CRYPTO_INVALID_HANDLE) &&
-         (h_val <= TFM_CRYPTO_CONC_OPER_NUM) &&
-         (operation[h_val - 1].in_use == TFM_CRYPTO_IN_USE) &&
-         (operation[h_val - 1].owner == partition_id)) {
-
-        memset_operation_context(h_val - 1);
-        operation[h_val - 1].in_use = TFM_CRYPTO_NOT_IN_USE;
-        operation[h_val - 1].type = TFM_CRYPTO_OPERATION_NONE;
-        operation[h_val - 1].owner = 0;
-        *handle = TFM_CRYPTO_INVALID_HANDLE;
-        return PSA_SUCCESS;
+    op = resolve_handle(*handle, partition_id);
+    if (op == NULL) {
+        return PSA_ERROR_INVALID_ARGUMENT;
     }
 
-    return PSA_ERROR_INVALID_ARGUMENT;
+    memset_operation_context(op - operation);
+    op->in_use = TFM_CRYPTO_NOT_IN_USE;
+    op->owner = 0;
+    op->generation = (op->generation + 1) & TFM_CRYPTO_HANDLE_GEN_MASK;
+
+    /* Return the slot to the free list of its type */
+    op->next_free = free_head[op->type];
+    free_head[op->type] = op - operation;
+    oper_in_use--;
+
+    *handle = TFM_CRYPTO_INVALID_HANDLE;
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
                                          uint32_t handle,
                                          void **ctx)
 {
+    struct tfm_crypto_operation_s *op;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -168,16 +400,12 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
         return status;
     }
 
-    if ( (handle != TFM_CRYPTO_INVALID_HANDLE) &&
-         (handle <= TFM_CRYPTO_CONC_OPER_NUM) &&
-         (operation[handle - 1].in_use == TFM_CRYPTO_IN_USE) &&
-         (operation[handle - 1].type == type) &&
-         (operation[handle - 1].owner == partition_id)) {
-
-        *ctx = (void *) &(operation[handle - 1].operation);
-        return PSA_SUCCESS;
+    op = resolve_handle(handle, partition_id);
+    if ((op == NULL) || (op->type != type)) {
+        return PSA_ERROR_BAD_STATE;
     }
 
-    return PSA_ERROR_BAD_STATE;
+    *ctx = op->ctx;
+    return PSA_SUCCESS;
 }
 /*!@}*/
@@ -21,6 +21,7 @@
 #endif
 
 #ifdef TFM_PSA_API
+#include <stdbool.h>
 #include "psa/service.h"
 #include "psa_manifest/tfm_crypto.h"
 #include "tfm_memory_utils.h"
@@ -104,6 +105,110 @@ static psa_status_t tfm_crypto_clear_scratch(void)
     return PSA_SUCCESS;
 }
 
+#ifdef TFM_MM_IOVEC
+/**
+ * \brief Checks if a mapped client vector can be passed to the secure
+ *        functions in place.
+ *
+ * \details The secure functions access the vectors with the alignment of
+ *          TFM_CRYPTO_IOVEC_ALIGNMENT, and Mbed Crypto does not support an
+ *          output which partially overlaps an input. An output vector is
+ *          passed in place only if it does not overlap any other vector.
+ *
+ * \param[in] base      Mapped vector
+ * \param[in] len       Length of the vector
+ * \param[in] out_idx   Index of the output vector, or PSA_MAX_IOVEC for an
+ *                      input vector
+ * \param[in] in_map    Mapped input vectors, from index 1
+ * \param[in] in_len    Number of input vectors
+ * \param[in] out_map   Mapped output vectors
+ * \param[in] out_len   Number of output vectors
+ * \param[in] msg       Message of the vectors
+ *
+ * \return True if the vector can be passed in place
+ */
+static bool tfm_crypto_iovec_in_place(const void *base, size_t len,
+                                      size_t out_idx,
+                                      const void *const *in_map, size_t in_len,
+                                      void *const *out_map, size_t out_len,
+                                      const psa_msg_t *msg)
+{
+    uintptr_t start = (uintptr_t)base;
+    uintptr_t other;
+    size_t i;
+
+    /* An empty vector is not mapped */
+    if (base == NULL) {
+        return true;
+    }
+
+    if ((start & (TFM_CRYPTO_IOVEC_ALIGNMENT - 1)) != 0) {
+        return false;
+    }
+
+    if (out_idx >= PSA_MAX_IOVEC) {
+        return true;
+    }
+
+    for (i = 1; i < in_len; i++) {
+        other = (uintptr_t)in_map[i];
+        if ((other != 0) && (other < start + len) &&
+            (start < other + msg->in_size[i])) {
+            return false;
+        }
+    }
+
+    for (i = 0; i < out_len; i++) {
+        other = (uintptr_t)out_map[i];
+        if ((i != out_idx) && (other != 0) && (other < start + len) &&
+            (start < other + msg->out_size[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * \brief Unmaps the client vectors, after copying to them the output written
+ *        in the scratch.
+ *
+ * \param[in] msg       Message of the vectors
+ * \param[in] in_map    Mapped input vectors, from index 1
+ * \param[in] in_len    Number of input vectors
+ * \param[in] out_map   Mapped output vectors
+ * \param[in] out_vec   Output vectors passed to the secure function, or NULL
+ *                      if nothing has been written
+ * \param[in] out_len   Number of output vectors
+ */
+static void tfm_crypto_unmap_iovecs(const psa_msg_t *msg,
+                                    const void *const *in_map, size_t in_len,
+                                    void *const *out_map,
+                                    const psa_outvec *out_vec, size_t out_len)
+{
+    size_t i, len;
+
+    for (i = 1; i < in_len; i++) {
+        if (in_map[i] != NULL) {
+            psa_unmap_invec(msg->handle, i);
+        }
+    }
+
+    for (i = 0; i < out_len; i++) {
+        if (out_map[i] == NULL) {
+            continue;
+        }
+
+        len = (out_vec != NULL) ? out_vec[i].len : 0;
+        if ((len != 0) && (out_vec[i].base != out_map[i])) {
+            /* Copy the output written in the scratch */
+            (void)tfm_memcpy(out_map[i], out_vec[i].base, len);
+        }
+        psa_unmap_outvec(msg->handle, i, len);
+    }
+}
+#endif /* TFM_MM_IOVEC */
+
 static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
                                         struct tfm_crypto_pack_iovec *iov,
                                         const uint32_t sfn_id)
@@ -113,6 +218,10 @@ static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
     psa_invec in_vec[PSA_MAX_IOVEC] = { {0} };
     psa_outvec out_vec[PSA_MAX_IOVEC] = { {0} };
     void *alloc_buf_ptr = NULL;
+#ifdef TFM_MM_IOVEC
+    const void *in_map[PSA_MAX_IOVEC] = {NULL};
+    void *out_map[PSA_MAX_IOVEC] = {NULL};
+#endif
 
     /* Check the number of in_vec filled */
     while ((in_len > 0) && (msg->in_size[in_len - 1] == 0)) {
@@ -127,36 +236,74 @@ static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
     in_vec[0].base = iov;
     in_vec[0].len = sizeof(struct tfm_crypto_pack_iovec);
 
+    /* Check the number of out_vec filled */
+    while ((out_len > 0) && (msg->out_size[out_len - 1] == 0)) {
+        out_len--;
+    }
+
+#ifdef TFM_MM_IOVEC
+    /* Map the client vectors, to access them in place when possible */
+    for (i = 1; i < in_len; i++) {
+        in_map[i] = psa_map_invec(msg->handle, i);
+    }
+    for (i = 0; i < out_len; i++) {
+        out_map[i] = psa_map_outvec(msg->handle, i);
+    }
+#endif
+
     /* Alloc/read from the second element as the first is read when parsing */
     for (i = 1; i < in_len; i++) {
+        in_vec[i].len = msg->in_size[i];
+#ifdef TFM_MM_IOVEC
+        if (tfm_crypto_iovec_in_place(in_map[i], msg->in_size[i],
+                                      PSA_MAX_IOVEC, in_map, in_len,
+                                      out_map, out_len, msg)) {
+            in_vec[i].base = in_map[i];
+            continue;
+        }
+#endif
         /* Allocate necessary space in the internal scratch */
         status = tfm_crypto_alloc_scratch(msg->in_size[i], &alloc_buf_ptr);
         if (status != PSA_SUCCESS) {
+#ifdef TFM_MM_IOVEC
+            tfm_crypto_unmap_iovecs(msg, in_map, in_len, out_map, NULL,
+                                    out_len);
+#endif
             (void)tfm_crypto_clear_scratch();
             return status;
         }
+#ifdef TFM_MM_IOVEC
+        /* Copy the client input which cannot be accessed in place */
+        (void)tfm_memcpy(alloc_buf_ptr, in_map[i], msg->in_size[i]);
+#else
         /* Read from the IPC framework inputs into the scratch */
         (void) psa_read(msg->handle, i, alloc_buf_ptr, msg->in_size[i]);
+#endif
         /* Populate the fields of the input to the secure function */
         in_vec[i].base = alloc_buf_ptr;
-        in_vec[i].len = msg->in_size[i];
-    }
-
-    /* Check the number of out_vec filled */
-    while ((out_len > 0) && (msg->out_size[out_len - 1] == 0)) {
-        out_len--;
     }
 
     for (i = 0; i < out_len; i++) {
+        out_vec[i].len = msg->out_size[i];
+#ifdef TFM_MM_IOVEC
+        if (tfm_crypto_iovec_in_place(out_map[i], msg->out_size[i], i,
+                                      in_map, in_len, out_map, out_len, msg)) {
+            out_vec[i].base = out_map[i];
+            continue;
+        }
+#endif
         /* Allocate necessary space for the output in the internal scratch */
         status = tfm_crypto_alloc_scratch(msg->out_size[i], &alloc_buf_ptr);
         if (status != PSA_SUCCESS) {
+#ifdef TFM_MM_IOVEC
+            tfm_crypto_unmap_iovecs(msg, in_map, in_len, out_map, NULL,
+                                    out_len);
+#endif
             (void)tfm_crypto_clear_scratch();
             return status;
         }
         /* Populate the fields of the output to the secure function */
         out_vec[i].base = alloc_buf_ptr;
-        out_vec[i].len = msg->out_size[i];
     }
 
     /* Set the owner of the data in the scratch */
@@ -165,10 +312,15 @@ static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
     /* Call the uniform signature API */
     status = sfid_func_table[sfn_id](in_vec, in_len, out_vec, out_len);
 
+#ifdef TFM_MM_IOVEC
+    /* Release the client vectors and report the number of bytes written */
+    tfm_crypto_unmap_iovecs(msg, in_map, in_len, out_map, out_vec, out_len);
+#else
     /* Write into the IPC framework outputs from the scratch */
     for (i = 0; i < out_len; i++) {
         psa_write(msg->handle, i, out_vec[i].base, out_vec[i].len);
     }
+#endif
 
     /* Clear the allocated internal scratch before returning */
     if (tfm_crypto_clear_scratch() != PSA_SUCCESS) {
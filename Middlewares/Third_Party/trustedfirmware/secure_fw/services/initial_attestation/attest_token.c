@@ -226,3 +226,144 @@ Done:
     return return_value;
 }
 
+
+
+/*
+ Public function. See attest_token.h
+ */
+void attest_token_start_payload(struct attest_token_ctx *me,
+                                const struct q_useful_buf *out_buf)
+{
+    me->opt_flags  = 0;
+    me->key_select = 0;
+
+    QCBOREncode_Init(&(me->cbor_enc_ctx), *out_buf);
+
+    QCBOREncode_OpenMap(&(me->cbor_enc_ctx));
+}
+
+
+/*
+ Public function. See attest_token.h
+ */
+size_t attest_token_get_encoded_len(struct attest_token_ctx *me)
+{
+    return UsefulOutBuf_GetEndPosition(&(me->cbor_enc_ctx.OutBuf));
+}
+
+
+/*
+ Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_finish_payload(struct attest_token_ctx *me,
+                            struct q_useful_buf_c *payload,
+                            size_t *head_len)
+{
+    size_t      claims_len;
+    QCBORError  qcbor_result;
+
+    claims_len = attest_token_get_encoded_len(me);
+
+    QCBOREncode_CloseMap(&(me->cbor_enc_ctx));
+
+    qcbor_result = QCBOREncode_Finish(&(me->cbor_enc_ctx), payload);
+    if(qcbor_result == QCBOR_ERR_BUFFER_TOO_SMALL) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    } else if (qcbor_result != QCBOR_SUCCESS) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+
+    *head_len = payload->len - claims_len;
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+
+/*
+ Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_encode_integer(int64_t value,
+                            struct q_useful_buf out_buf,
+                            struct q_useful_buf_c *encoded)
+{
+    QCBOREncodeContext cbor_enc_ctx;
+
+    QCBOREncode_Init(&cbor_enc_ctx, out_buf);
+    QCBOREncode_AddInt64(&cbor_enc_ctx, value);
+
+    if(QCBOREncode_Finish(&cbor_enc_ctx, encoded) != QCBOR_SUCCESS) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    }
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
+
+/*
+ Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_sign_encoded(struct attest_token_ctx *me,
+                          int32_t key_select,
+                          int32_t cose_alg_id,
+                          const struct q_useful_buf_c *payload,
+                          const struct q_useful_buf *out_buf,
+                          struct q_useful_buf_c *completed_token)
+{
+    enum t_cose_err_t       cose_return_value;
+    QCBORError              qcbor_result;
+    struct q_useful_buf_c   wrapped_payload;
+    size_t                  payload_start;
+
+    me->opt_flags  = 0;
+    me->key_select = key_select;
+
+    QCBOREncode_Init(&(me->cbor_enc_ctx), *out_buf);
+
+    cose_return_value = t_cose_sign1_init(&(me->signer_ctx),
+                                          0,
+                                          cose_alg_id,
+                                          key_select,
+                                          &(me->cbor_enc_ctx));
+    if(cose_return_value) {
+        return t_cose_err_to_attest_err(cose_return_value);
+    }
+
+    /* The payload bstr holds exactly the bytes a bstr wrapped map of
+     * the same claims would, so the signature is computed over the
+     * encoded bstr, head included, as it is in the output buffer.
+     */
+    payload_start = attest_token_get_encoded_len(me);
+    QCBOREncode_AddBytes(&(me->cbor_enc_ctx), *payload);
+
+    qcbor_result = QCBOREncode_GetErrorState(&(me->cbor_enc_ctx));
+    if(qcbor_result == QCBOR_ERR_BUFFER_TOO_SMALL) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    } else if (qcbor_result != QCBOR_SUCCESS) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+
+    wrapped_payload.len = attest_token_get_encoded_len(me) - payload_start;
+    if(out_buf->ptr != NULL) {
+        wrapped_payload.ptr = (const uint8_t *)out_buf->ptr + payload_start;
+    } else {
+        /* Only the size of the token is computed */
+        wrapped_payload.ptr = NULL;
+    }
+
+    cose_return_value = t_cose_sign1_finish(&(me->signer_ctx),
+                                            wrapped_payload);
+    if(cose_return_value) {
+        return t_cose_err_to_attest_err(cose_return_value);
+    }
+
+    qcbor_result = QCBOREncode_Finish(&(me->cbor_enc_ctx), completed_token);
+    if(qcbor_result == QCBOR_ERR_BUFFER_TOO_SMALL) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    } else if (qcbor_result != QCBOR_SUCCESS) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
@@ -248,6 +248,99 @@ enum attest_token_err_t
 attest_token_finish(struct attest_token_ctx *me,
                     struct q_useful_buf_c *completed_token);
 
+
+
+/**
+ * \brief Initialize a context to encode a bare claims payload.
+ *
+ * \param[in] me          The token creation context to be initialized.
+ * \param[out] out_buffer The output buffer to write the encoded claims into.
+ *
+ * This encodes the claims map only, without the COSE structure around
+ * it, so that it can be kept and signed later with
+ * attest_token_sign_encoded(). The claims are added with the same add
+ * methods as for a full token.
+ */
+void attest_token_start_payload(struct attest_token_ctx *me,
+                                const struct q_useful_buf *out_buffer);
+
+
+/**
+ * \brief Get the number of payload bytes encoded so far.
+ *
+ * \param[in] me     Token creation context.
+ *
+ * \return The offset in the output buffer where the next claim is
+ * going to be encoded.
+ *
+ * The head of the claims map is only inserted when the map is closed,
+ * so offsets taken while it is open are off by the size of the head.
+ * attest_token_finish_payload() gives the size of the head back.
+ */
+size_t attest_token_get_encoded_len(struct attest_token_ctx *me);
+
+
+/**
+ * \brief Finish the claims payload started by attest_token_start_payload().
+ *
+ * \param[in] me         Token creation context.
+ * \param[out] payload   Pointer and length of the encoded claims map.
+ * \param[out] head_len  Size of the map head which was inserted in front
+ *                       of the claims when the map was closed.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ */
+enum attest_token_err_t
+attest_token_finish_payload(struct attest_token_ctx *me,
+                            struct q_useful_buf_c *payload,
+                            size_t *head_len);
+
+
+/**
+ * \brief Encode an integer claim value on its own.
+ *
+ * \param[in] value     The integer claim data.
+ * \param[in] out_buf   Buffer to encode the value into, 9 bytes are
+ *                      always enough.
+ * \param[out] encoded  Pointer and length of the encoded value.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * The encoding is the same as the value gets in the payload, so that a
+ * claim of an encoded payload can be overwritten in place when the
+ * encoded length of the new value does not change.
+ */
+enum attest_token_err_t
+attest_token_encode_integer(int64_t value,
+                            struct q_useful_buf out_buf,
+                            struct q_useful_buf_c *encoded);
+
+
+/**
+ * \brief Create a signed token around an already encoded claims payload.
+ *
+ * \param[in] me              The token creation context.
+ * \param[in] key_select      Selects which attestation key to sign with.
+ * \param[in] cose_alg_id     The algorithm to sign with.
+ * \param[in] payload         The encoded claims map, as output by
+ *                            attest_token_finish_payload().
+ * \param[out] out_buffer     The output buffer to write the token into.
+ * \param[out] completed_token Pointer and length to completed token.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ *
+ * The token is the same as the one attest_token_start(), the add
+ * methods and attest_token_finish() would create with the same claims.
+ * The size only mode of attest_token_start() is supported as well.
+ */
+enum attest_token_err_t
+attest_token_sign_encoded(struct attest_token_ctx *me,
+                          int32_t key_select,
+                          int32_t cose_alg_id,
+                          const struct q_useful_buf_c *payload,
+                          const struct q_useful_buf *out_buffer,
+                          struct q_useful_buf_c *completed_token);
+
 #ifdef __cplusplus
 }
 #endif
@@ -104,6 +104,23 @@ initial_attest_get_token(const psa_invec  *in_vec,  uint32_t num_invec,
 enum psa_attest_err_t
 initial_attest_get_token_size(const psa_invec  *in_vec,  uint32_t num_invec,
                                     psa_outvec *out_vec, uint32_t num_outvec);
+
+/**
+ * \brief Get an initial attestation token for a batch of challenges
+ *
+ * \param[in]     in_vec     Pointer to in_vec array, which contains input data
+ *                           to attestation service: the challenges and the
+ *                           size of one challenge
+ * \param[in]     num_invec  Number of elements in in_vec array
+ * \param[in,out] out_vec    Pointer out_vec array, which contains output data
+ *                           to attestation service
+ * \param[in]     num_outvec Number of elements in out_vec array
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+enum psa_attest_err_t
+initial_attest_get_batch_token(const psa_invec  *in_vec,  uint32_t num_invec,
+                                     psa_outvec *out_vec, uint32_t num_outvec);
 #ifdef __cplusplus
 }
 #endif
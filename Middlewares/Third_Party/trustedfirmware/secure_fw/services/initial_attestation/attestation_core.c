@@ -16,12 +16,28 @@
 #include "tfm_plat_boot_seed.h"
 #include "tfm_attest_hal.h"
 #include "attest_token.h"
+#include "q_useful_buf.h"
 #include "attest_eat_defines.h"
 #include "t_cose_defines.h"
 #include "tfm_memory_utils.h"
+#include "psa/crypto.h"
 
 #define MAX_BOOT_STATUS 512
 
+/* Size of the buffer which keeps the encoded claims between tokens */
+#ifndef ATTEST_CLAIMS_CACHE_SIZE
+#define ATTEST_CLAIMS_CACHE_SIZE 0x200
+#endif
+
+/* Largest encoded integer claim value: head byte + 64-bit argument */
+#define ATTEST_INTEGER_CLAIM_MAX_SIZE 9
+
+/* Merkle tree of the batched challenges, as defined in RFC 6962 */
+#define ATTEST_MERKLE_HASH_ALG     PSA_ALG_SHA_256
+#define ATTEST_MERKLE_HASH_SIZE    PSA_HASH_SIZE(ATTEST_MERKLE_HASH_ALG)
+#define ATTEST_MERKLE_LEAF_PREFIX  0x00
+#define ATTEST_MERKLE_NODE_PREFIX  0x01
+
 /* Indicates how to encode SW components' measurements in the CBOR map */
 #define EAT_SW_COMPONENT_NESTED     1  /* Nested map */
 #define EAT_SW_COMPONENT_NOT_NESTED 0  /* Flat structure */
@@ -594,20 +610,14 @@ attest_add_implementation_id_claim(struct attest_token_ctx *token_ctx)
  * \brief Static function to add caller id claim to attestation token.
  *
  * \param[in]  token_ctx  Token encoding context
+ * \param[in]  caller_id  Client ID of the caller
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
 static enum psa_attest_err_t
-attest_add_caller_id_claim(struct attest_token_ctx *token_ctx)
+attest_add_caller_id_claim(struct attest_token_ctx *token_ctx,
+                           int32_t caller_id)
 {
-    enum psa_attest_err_t res;
-    int32_t caller_id;
-
-    res = attest_get_caller_client_id(&caller_id);
-    if (res != PSA_ATTEST_ERR_SUCCESS) {
-        return res;
-    }
-
     attest_token_add_integer(token_ctx,
                              EAT_CBOR_ARM_LABEL_CLIENT_ID,
                              (int64_t)caller_id);
@@ -616,17 +626,15 @@ attest_add_caller_id_claim(struct attest_token_ctx *token_ctx)
 }
 
 /*!
- * \brief Static function to add security lifecycle claim to attestation token.
+ * \brief Static function to get the security lifecycle state of the device.
  *
- * \param[in]  token_ctx  Token encoding context
+ * \param[out] security_lifecycle  Security lifecycle state
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
-
 static enum psa_attest_err_t
-attest_add_security_lifecycle_claim(struct attest_token_ctx *token_ctx)
+attest_get_security_lifecycle(enum tfm_security_lifecycle_t *security_lifecycle)
 {
-    enum tfm_security_lifecycle_t security_lifecycle;
     uint32_t slc_value;
     int32_t res;
     struct q_useful_buf_c claim_value = {0};
@@ -645,20 +653,36 @@ attest_add_security_lifecycle_claim(struct attest_token_ctx *token_ctx)
         if (res) {
             return PSA_ATTEST_ERR_GENERAL;
         }
-        security_lifecycle = (enum tfm_security_lifecycle_t)slc_value;
+        *security_lifecycle = (enum tfm_security_lifecycle_t)slc_value;
     } else {
         /* If not found in boot status then use callback function to get it
          * from runtime SW
          */
-        security_lifecycle = tfm_attest_hal_get_security_lifecycle();
+        *security_lifecycle = tfm_attest_hal_get_security_lifecycle();
     }
 
     /* Sanity check */
-    if (security_lifecycle < TFM_SLC_UNKNOWN ||
-        security_lifecycle > TFM_SLC_DECOMMISSIONED) {
+    if (*security_lifecycle < TFM_SLC_UNKNOWN ||
+        *security_lifecycle > TFM_SLC_DECOMMISSIONED) {
         return PSA_ATTEST_ERR_GENERAL;
     }
 
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to add security lifecycle claim to attestation token.
+ *
+ * \param[in]  token_ctx           Token encoding context
+ * \param[in]  security_lifecycle  Security lifecycle state
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_add_security_lifecycle_claim(
+                        struct attest_token_ctx *token_ctx,
+                        enum tfm_security_lifecycle_t security_lifecycle)
+{
     attest_token_add_integer(token_ctx,
                              EAT_CBOR_ARM_LABEL_SECURITY_LIFECYCLE,
                              (int64_t)security_lifecycle);
@@ -856,6 +880,317 @@ static void attest_get_option_flags(struct q_useful_buf_c *challenge,
 }
 #endif /* INCLUDE_TEST_CODE_AND_KEY_ID */
 
+/*!
+ * \brief Static function to add the claims which do not change after boot to
+ *        the attestation token.
+ *
+ * \param[in]  token_ctx  Token encoding context
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_add_boot_time_claims(struct attest_token_ctx *token_ctx)
+{
+    enum psa_attest_err_t attest_err;
+
+    /* Mandatory claims in IAT token */
+    attest_err = attest_add_boot_seed_claim(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_add_instance_id_claim(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_add_implementation_id_claim(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_add_all_sw_components(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_add_hw_version_claim(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+#ifdef INCLUDE_OPTIONAL_CLAIMS
+    /* Optional claims in IAT token, remove them from release build */
+    attest_err = attest_add_verification_service(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_add_profile_definition(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+#endif /* INCLUDE_OPTIONAL_CLAIMS */
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \struct attest_claim_pos
+ *
+ * \brief Position of a claim value in the cached claims
+ */
+struct attest_claim_pos {
+    size_t offset; /* Offset of the encoded value in the claims */
+    size_t len;    /* Size of the encoded value */
+};
+
+/*!
+ * \struct attest_claims_cache
+ *
+ * \brief Encoded claims kept between tokens
+ *
+ * \details Apart from the challenge, the caller ID and the security
+ *          lifecycle, the claims do not change once the device has booted.
+ *          The claims are encoded once and, for each token, only the values
+ *          of these three claims are overwritten in place. The claims are
+ *          encoded again when the challenge size or the encoded size of one
+ *          of the integers changes.
+ */
+struct attest_claims_cache {
+    uint8_t buf[ATTEST_CLAIMS_CACHE_SIZE];
+    struct q_useful_buf_c claims;
+    struct attest_claim_pos challenge;
+    struct attest_claim_pos caller_id;
+    struct attest_claim_pos security_lifecycle;
+    int32_t caller_id_value;
+    enum tfm_security_lifecycle_t security_lifecycle_value;
+    uint32_t valid;
+};
+
+static struct attest_claims_cache claims_cache;
+
+/*!
+ * \brief Static function to get the position of an integer claim value which
+ *        ends at the given offset of the claims.
+ *
+ * \param[in]  value  Value of the claim
+ * \param[in]  end    Offset of the end of the claim value
+ * \param[out] pos    Position of the claim value
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_get_integer_claim_pos(int64_t value, size_t end,
+                             struct attest_claim_pos *pos)
+{
+    Q_USEFUL_BUF_MAKE_STACK_UB(value_buf, ATTEST_INTEGER_CLAIM_MAX_SIZE);
+    struct q_useful_buf_c encoded;
+    enum attest_token_err_t token_err;
+
+    token_err = attest_token_encode_integer(value, value_buf, &encoded);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return error_mapping(token_err);
+    }
+
+    pos->offset = end - encoded.len;
+    pos->len = encoded.len;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to overwrite an integer claim value of the cached
+ *        claims.
+ *
+ * \param[in]  pos    Position of the claim value
+ * \param[in]  value  New value of the claim
+ *
+ * \retval  PSA_ATTEST_ERR_SUCCESS   The value was overwritten
+ * \retval  PSA_ATTEST_ERR_GENERAL   The encoded size of the value changed,
+ *                                   the claims must be encoded again.
+ */
+static enum psa_attest_err_t
+attest_update_integer_claim(const struct attest_claim_pos *pos, int64_t value)
+{
+    Q_USEFUL_BUF_MAKE_STACK_UB(value_buf, ATTEST_INTEGER_CLAIM_MAX_SIZE);
+    struct q_useful_buf_c encoded;
+    enum attest_token_err_t token_err;
+
+    token_err = attest_token_encode_integer(value, value_buf, &encoded);
+    if ((token_err != ATTEST_TOKEN_ERR_SUCCESS) || (encoded.len != pos->len)) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    (void)tfm_memcpy(&claims_cache.buf[pos->offset], encoded.ptr, encoded.len);
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to encode all the claims into the claims cache.
+ *
+ * The challenge is encoded as zeros, it is overwritten for each token.
+ *
+ * \param[in]  challenge_len       Size of the challenge
+ * \param[in]  caller_id           Client ID of the caller
+ * \param[in]  security_lifecycle  Security lifecycle state
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_fill_claims_cache(size_t challenge_len,
+                         int32_t caller_id,
+                         enum tfm_security_lifecycle_t security_lifecycle)
+{
+    static const uint8_t no_challenge[PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64];
+    struct q_useful_buf cache_buf = {claims_cache.buf,
+                                     sizeof(claims_cache.buf)};
+    struct q_useful_buf_c challenge = {no_challenge, challenge_len};
+    struct attest_token_ctx attest_token_ctx;
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    size_t challenge_end, caller_id_end, security_lifecycle_end;
+    size_t head_len;
+
+    claims_cache.valid = 0;
+
+    attest_token_start_payload(&attest_token_ctx, &cache_buf);
+
+    /* The claims which change between tokens come first, the offsets
+     * where they end are taken before the map head gets inserted in front
+     * of them.
+     */
+    attest_err = attest_add_challenge_claim(&attest_token_ctx, &challenge);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+    challenge_end = attest_token_get_encoded_len(&attest_token_ctx);
+
+    attest_err = attest_add_caller_id_claim(&attest_token_ctx, caller_id);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+    caller_id_end = attest_token_get_encoded_len(&attest_token_ctx);
+
+    attest_err = attest_add_security_lifecycle_claim(&attest_token_ctx,
+                                                     security_lifecycle);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+    security_lifecycle_end = attest_token_get_encoded_len(&attest_token_ctx);
+
+    attest_err = attest_add_boot_time_claims(&attest_token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    token_err = attest_token_finish_payload(&attest_token_ctx,
+                                            &claims_cache.claims,
+                                            &head_len);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return error_mapping(token_err);
+    }
+
+    claims_cache.challenge.offset = head_len + challenge_end - challenge_len;
+    claims_cache.challenge.len = challenge_len;
+
+    attest_err = attest_get_integer_claim_pos(caller_id,
+                                              head_len + caller_id_end,
+                                              &claims_cache.caller_id);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_get_integer_claim_pos(security_lifecycle,
+                                              head_len + security_lifecycle_end,
+                                              &claims_cache.security_lifecycle);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    claims_cache.caller_id_value = caller_id;
+    claims_cache.security_lifecycle_value = security_lifecycle;
+    claims_cache.valid = 1;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to get the encoded claims of a token from the claims
+ *        cache.
+ *
+ * The claims which can change between tokens are read again and updated in
+ * the cache, the rest of the claims are used as they were encoded.
+ *
+ * \param[in]  challenge  Structure to carry the challenge value:
+ *                        pointer + challeng's length. The pointer is NULL
+ *                        if only the size of the token is needed.
+ * \param[out] claims     Pointer and length of the encoded claims
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_get_cached_claims(const struct q_useful_buf_c *challenge,
+                         struct q_useful_buf_c *claims)
+{
+    enum psa_attest_err_t attest_err;
+    enum tfm_security_lifecycle_t security_lifecycle;
+    int32_t caller_id;
+    uint32_t refill = 0;
+
+    attest_err = attest_get_caller_client_id(&caller_id);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_get_security_lifecycle(&security_lifecycle);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    if (!claims_cache.valid ||
+        (claims_cache.challenge.len != challenge->len)) {
+        refill = 1;
+    }
+
+    if (!refill && (claims_cache.caller_id_value != caller_id)) {
+        if (attest_update_integer_claim(&claims_cache.caller_id,
+                                        caller_id) == PSA_ATTEST_ERR_SUCCESS) {
+            claims_cache.caller_id_value = caller_id;
+        } else {
+            refill = 1;
+        }
+    }
+
+    if (!refill &&
+        (claims_cache.security_lifecycle_value != security_lifecycle)) {
+        if (attest_update_integer_claim(&claims_cache.security_lifecycle,
+                                        security_lifecycle) ==
+                                                    PSA_ATTEST_ERR_SUCCESS) {
+            claims_cache.security_lifecycle_value = security_lifecycle;
+        } else {
+            refill = 1;
+        }
+    }
+
+    if (refill) {
+        attest_err = attest_fill_claims_cache(challenge->len, caller_id,
+                                              security_lifecycle);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+    }
+
+    if (challenge->ptr != NULL) {
+        (void)tfm_memcpy(&claims_cache.buf[claims_cache.challenge.offset],
+                         challenge->ptr, challenge->len);
+    }
+
+    *claims = claims_cache.claims;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
 /*!
  * \brief Static function to create the initial attestation token
  *
@@ -876,6 +1211,9 @@ attest_create_token(struct q_useful_buf_c *challenge,
     enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
     enum attest_token_err_t token_err;
     struct attest_token_ctx attest_token_ctx;
+    struct q_useful_buf_c claims;
+    enum tfm_security_lifecycle_t security_lifecycle;
+    int32_t caller_id;
     int32_t key_select = 0;
     uint32_t option_flags = 0;
 
@@ -883,6 +1221,22 @@ attest_create_token(struct q_useful_buf_c *challenge,
     attest_get_option_flags(challenge, &option_flags, &key_select);
 #endif
 
+    /* Tokens with test options are always created from scratch. Otherwise
+     * the claims come from the cache, unless they do not fit in it.
+     */
+    if (option_flags == 0) {
+        attest_err = attest_get_cached_claims(challenge, &claims);
+        if (attest_err == PSA_ATTEST_ERR_SUCCESS) {
+            token_err = attest_token_sign_encoded(&attest_token_ctx,
+                                                  key_select,
+                                                  COSE_ALGORITHM_ES256,
+                                                  &claims,
+                                                  token,
+                                                  completed_token);
+            return error_mapping(token_err);
+        }
+    }
+
     /* Get started creating the token. This sets up the CBOR and COSE contexts
      * which causes the COSE headers to be constructed.
      */
@@ -904,53 +1258,32 @@ attest_create_token(struct q_useful_buf_c *challenge,
     }
 
     if (!(option_flags & TOKEN_OPT_OMIT_CLAIMS)) {
-        /* Mandatory claims in IAT token */
-        attest_err = attest_add_boot_seed_claim(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_instance_id_claim(&attest_token_ctx);
+        /* Mandatory claims in IAT token, in the order of the cached claims */
+        attest_err = attest_get_caller_client_id(&caller_id);
         if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
             goto error;
         }
 
-        attest_err = attest_add_implementation_id_claim(&attest_token_ctx);
+        attest_err = attest_add_caller_id_claim(&attest_token_ctx, caller_id);
         if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
             goto error;
         }
 
-        attest_err = attest_add_caller_id_claim(&attest_token_ctx);
+        attest_err = attest_get_security_lifecycle(&security_lifecycle);
         if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
             goto error;
         }
 
-        attest_err = attest_add_security_lifecycle_claim(&attest_token_ctx);
+        attest_err = attest_add_security_lifecycle_claim(&attest_token_ctx,
+                                                         security_lifecycle);
         if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
             goto error;
         }
 
-        attest_err = attest_add_all_sw_components(&attest_token_ctx);
+        attest_err = attest_add_boot_time_claims(&attest_token_ctx);
         if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
             goto error;
         }
-
-        attest_err = attest_add_hw_version_claim(&attest_token_ctx);
-               if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-                   goto error;
-        }
-#ifdef INCLUDE_OPTIONAL_CLAIMS
-        /* Optional claims in IAT token, remove them from release build */
-        attest_err = attest_add_verification_service(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_profile_definition(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-#endif /* INCLUDE_OPTIONAL_CLAIMS */
     }
 
     /* Finish up creating the token. This is where the actual signature
@@ -1061,3 +1394,191 @@ initial_attest_get_token_size(const psa_invec  *in_vec,  uint32_t num_invec,
 error:
     return attest_err;
 }
+
+/*!
+ * \brief Static function to hash a node of the Merkle tree
+ *
+ * \param[in]  prefix     Domain separation prefix of the node type
+ * \param[in]  left       Leaf data or hash of the left child
+ * \param[in]  left_len   Size of the left data
+ * \param[in]  right      Hash of the right child, NULL for a leaf
+ * \param[in]  right_len  Size of the right data
+ * \param[out] hash       Buffer of \ref ATTEST_MERKLE_HASH_SIZE bytes to
+ *                        store the hash of the node
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_merkle_hash(uint8_t prefix,
+                   const uint8_t *left, size_t left_len,
+                   const uint8_t *right, size_t right_len,
+                   uint8_t *hash)
+{
+    psa_hash_operation_t operation = PSA_HASH_OPERATION_INIT;
+    psa_status_t status;
+    size_t hash_len;
+
+    status = psa_hash_setup(&operation, ATTEST_MERKLE_HASH_ALG);
+    if (status != PSA_SUCCESS) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    status = psa_hash_update(&operation, &prefix, sizeof(prefix));
+    if (status == PSA_SUCCESS) {
+        status = psa_hash_update(&operation, left, left_len);
+    }
+    if ((status == PSA_SUCCESS) && (right != NULL)) {
+        status = psa_hash_update(&operation, right, right_len);
+    }
+    if (status == PSA_SUCCESS) {
+        status = psa_hash_finish(&operation, hash, ATTEST_MERKLE_HASH_SIZE,
+                                 &hash_len);
+    }
+
+    if (status != PSA_SUCCESS) {
+        (void)psa_hash_abort(&operation);
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to compute the root of the Merkle tree of a batch
+ *        of challenges.
+ *
+ * The tree is the one of RFC 6962: leaves are H(0x00 || challenge) and nodes
+ * are H(0x01 || left || right). Built bottom up, the last node of a level
+ * with an odd number of nodes is moved up to the next level as it is.
+ *
+ * \param[in]  challenges      Challenges, one after the other
+ * \param[in]  challenge_size  Size of each challenge
+ * \param[in]  count           Number of challenges, at most
+ *                             \ref PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES
+ * \param[out] root            Buffer of \ref ATTEST_MERKLE_HASH_SIZE bytes
+ *                             to store the root of the tree
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_get_merkle_root(const uint8_t *challenges,
+                       size_t challenge_size,
+                       uint32_t count,
+                       uint8_t *root)
+{
+    uint8_t nodes[PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES]
+                 [ATTEST_MERKLE_HASH_SIZE];
+    enum psa_attest_err_t attest_err;
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        attest_err = attest_merkle_hash(ATTEST_MERKLE_LEAF_PREFIX,
+                                        &challenges[i * challenge_size],
+                                        challenge_size,
+                                        NULL, 0,
+                                        nodes[i]);
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+    }
+
+    while (count > 1) {
+        for (i = 0; i + 1 < count; i += 2) {
+            attest_err = attest_merkle_hash(ATTEST_MERKLE_NODE_PREFIX,
+                                            nodes[i], ATTEST_MERKLE_HASH_SIZE,
+                                            nodes[i + 1],
+                                            ATTEST_MERKLE_HASH_SIZE,
+                                            nodes[i / 2]);
+            if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+                return attest_err;
+            }
+        }
+
+        if (count & 1) {
+            (void)tfm_memcpy(nodes[count / 2], nodes[count - 1],
+                             ATTEST_MERKLE_HASH_SIZE);
+        }
+        count = (count + 1) / 2;
+    }
+
+    (void)tfm_memcpy(root, nodes[0], ATTEST_MERKLE_HASH_SIZE);
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+enum psa_attest_err_t
+initial_attest_get_batch_token(const psa_invec  *in_vec,  uint32_t num_invec,
+                                     psa_outvec *out_vec, uint32_t num_outvec)
+{
+    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
+    uint8_t root[ATTEST_MERKLE_HASH_SIZE];
+    uint32_t challenge_size;
+    uint32_t challenge_count;
+    struct q_useful_buf_c challenge;
+    struct q_useful_buf token;
+    struct q_useful_buf_c completed_token;
+
+    if ((num_invec < 2) || (num_outvec < 1) ||
+        (in_vec[1].len != sizeof(challenge_size))) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
+        goto error;
+    }
+
+    (void)tfm_memcpy(&challenge_size, in_vec[1].base, sizeof(challenge_size));
+
+    attest_err = attest_verify_challenge_size(challenge_size);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    challenge_count = in_vec[0].len / challenge_size;
+    if ((challenge_count == 0) ||
+        (challenge_count > PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES) ||
+        (in_vec[0].len != challenge_count * challenge_size)) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
+        goto error;
+    }
+
+    attest_err = attest_check_memory_access((void *)in_vec[0].base,
+                                            in_vec[0].len,
+                                            TFM_ATTEST_ACCESS_RO);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    token.ptr = out_vec[0].base;
+    token.len = out_vec[0].len;
+
+    if (token.len == 0) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
+        goto error;
+    }
+
+    attest_err = attest_check_memory_access(token.ptr,
+                                            token.len,
+                                            TFM_ATTEST_ACCESS_RW);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    /* The root of the tree is signed in place of a single challenge */
+    attest_err = attest_get_merkle_root(in_vec[0].base, challenge_size,
+                                        challenge_count, root);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    challenge.ptr = root;
+    challenge.len = sizeof(root);
+
+    attest_err = attest_create_token(&challenge, &token, &completed_token);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        goto error;
+    }
+
+    out_vec[0].base = (void *)completed_token.ptr;
+    out_vec[0].len  = completed_token.len;
+
+error:
+    return attest_err;
+}
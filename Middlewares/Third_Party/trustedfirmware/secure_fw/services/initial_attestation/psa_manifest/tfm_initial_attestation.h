@@ -16,6 +16,7 @@ extern "C" {
 
 #define PSA_ATTEST_GET_TOKEN_SIG                                (1U << ( 0 + 4))
 #define PSA_ATTEST_GET_TOKEN_SIZE_SIG                           (1U << ( 1 + 4))
+#define PSA_ATTEST_GET_BATCH_TOKEN_SIG                          (1U << ( 2 + 4))
 
 #ifdef __cplusplus
 }
@@ -97,6 +97,58 @@ static enum psa_attest_err_t psa_attest_get_token_size(const psa_msg_t *msg)
     return status;
 }
 
+static enum psa_attest_err_t psa_attest_get_batch_token(const psa_msg_t *msg)
+{
+    enum psa_attest_err_t status = PSA_ATTEST_ERR_SUCCESS;
+    /* Kept off the stack, which the token buffer already mostly uses */
+    static uint8_t challenge_buff[PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES *
+                                  PSA_INITIAL_ATTEST_CHALLENGE_SIZE_64];
+    uint8_t token_buff[PSA_INITIAL_ATTEST_TOKEN_MAX_SIZE];
+    uint32_t challenge_size;
+    uint32_t bytes_read = 0;
+    size_t challenges_size = msg->in_size[0];
+    size_t token_size = msg->out_size[0];
+    psa_invec in_vec[] = {
+        {challenge_buff, challenges_size},
+        {&challenge_size, sizeof(challenge_size)}
+    };
+    psa_outvec out_vec[] = {
+        {token_buff, token_size}
+    };
+
+    if (challenges_size > sizeof(challenge_buff)
+        || msg->in_size[1] != sizeof(challenge_size)) {
+        return PSA_ATTEST_ERR_INVALID_INPUT;
+    }
+
+    /* store the client ID here for later use in service */
+    g_attest_caller_id = msg->client_id;
+
+    bytes_read = psa_read(msg->handle, 0,
+                          challenge_buff, challenges_size);
+    if (bytes_read != challenges_size) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    bytes_read = psa_read(msg->handle, 1,
+                          &challenge_size, sizeof(challenge_size));
+    if (bytes_read != sizeof(challenge_size)) {
+        return PSA_ATTEST_ERR_GENERAL;
+    }
+
+    token_size = (token_size < PSA_INITIAL_ATTEST_TOKEN_MAX_SIZE) ?
+                  token_size : PSA_INITIAL_ATTEST_TOKEN_MAX_SIZE;
+    out_vec[0].len = token_size;
+
+    status = initial_attest_get_batch_token(in_vec, IOVEC_LEN(in_vec),
+                                            out_vec, IOVEC_LEN(out_vec));
+    if (status == PSA_ATTEST_ERR_SUCCESS) {
+        psa_write(msg->handle, 0, out_vec[0].base, out_vec[0].len);
+    }
+
+    return status;
+}
+
 /*
  * Fixme: Temporarily implement abort as infinite loop,
  * will replace it later.
@@ -151,6 +203,9 @@ enum psa_attest_err_t attest_partition_init(void)
         } else if (signals & PSA_ATTEST_GET_TOKEN_SIZE_SIG) {
             attest_signal_handle(PSA_ATTEST_GET_TOKEN_SIZE_SIG,
                                  psa_attest_get_token_size);
+        } else if (signals & PSA_ATTEST_GET_BATCH_TOKEN_SIG) {
+            attest_signal_handle(PSA_ATTEST_GET_BATCH_TOKEN_SIG,
+                                 psa_attest_get_batch_token);
         } else {
             tfm_abort();
         }
@@ -109,6 +109,38 @@ struct its_flash_fs_context_t {
 
 static struct its_flash_fs_context_t its_flash_fs_ctx;
 
+/*!
+ * \def ITS_FID_HASH_EMPTY
+ *
+ * \brief Hash value recorded in the index for a free file metadata entry.
+ */
+#define ITS_FID_HASH_EMPTY  0
+
+/*!
+ * \struct its_mblock_index_t
+ *
+ * \brief Structure to store a RAM index of a metadata block.
+ *
+ * \note  The index holds the parts of the metadata needed to find a file or
+ *        the free space for a new one, so that those searches do not read the
+ *        whole metadata table from flash. The entries found through the index
+ *        are still read, and validated, from flash before they are used.
+ */
+struct its_mblock_index_t {
+    uint32_t fid_hash[ITS_MAX_NUM_FILES];     /*!< Hash of the ID of each file
+                                               *   metadata entry
+                                               */
+    size_t free_size[ITS_NUM_ACTIVE_DBLOCKS]; /*!< Free size of each logical
+                                               *   data block
+                                               */
+};
+
+/* One index per physical metadata block. The index of the scratch metadata
+ * block is updated along with it, so that it is the active one's index once
+ * the metadata blocks are swapped.
+ */
+static struct its_mblock_index_t its_mblock_index[2];
+
 #define ITS_BLOCK_META_HEADER_SIZE  sizeof(struct its_metadata_block_header_t)
 #define ITS_BLOCK_METADATA_SIZE     sizeof(struct its_block_meta_t)
 #define ITS_FILE_METADATA_SIZE      sizeof(struct its_file_meta_t)
@@ -185,6 +217,88 @@ static inline uint32_t its_mblock_cur_meta_active(void)
     return its_flash_fs_ctx.active_metablock;
 }
 
+/**
+ * \brief Gets the RAM index of the given metadata block.
+ *
+ * \param[in] metablock  Metadata block ID
+ *
+ * \return Pointer to the index of the metadata block
+ */
+__attribute__((always_inline))
+static inline struct its_mblock_index_t *its_mblock_index_of(uint32_t metablock)
+{
+    return &its_mblock_index[metablock];
+}
+
+/**
+ * \brief Gets the hash of a file ID, as recorded in the RAM index.
+ *
+ * \param[in] fid  ID of the file
+ *
+ * \return Returns the hash value, or ITS_FID_HASH_EMPTY if the ID is not valid
+ */
+static uint32_t its_mblock_fid_hash(const uint8_t *fid)
+{
+    uint32_t hash = 2166136261U;
+    uint32_t i;
+
+    if (its_utils_validate_fid(fid) != PSA_SUCCESS) {
+        return ITS_FID_HASH_EMPTY;
+    }
+
+    /* FNV-1a */
+    for (i = 0; i < ITS_FILE_ID_SIZE; i++) {
+        hash = (hash ^ fid[i]) * 16777619U;
+    }
+
+    /* Keep the empty value for free entries */
+    return (hash == ITS_FID_HASH_EMPTY) ? (hash + 1) : hash;
+}
+
+/**
+ * \brief Builds the RAM index of the active metadata block from flash.
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_mblock_build_index(void)
+{
+    struct its_block_meta_t block_meta;
+    psa_status_t err;
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    struct its_mblock_index_t *index;
+    uint32_t metablock;
+    uint32_t i;
+
+    metablock = its_mblock_cur_meta_active();
+    index = its_mblock_index_of(metablock);
+
+    for (i = 0; i < ITS_NUM_ACTIVE_DBLOCKS; i++) {
+        err = its_flash_read(metablock, (uint8_t *)&block_meta,
+                             its_mblock_block_meta_offset(i),
+                             ITS_BLOCK_METADATA_SIZE);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        index->free_size[i] = block_meta.free_size;
+    }
+
+    /* Only the ID of each file metadata entry is needed */
+    for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
+        err = its_flash_read(metablock, fid,
+                             its_mblock_file_meta_offset(i)
+                             + offsetof(struct its_file_meta_t, id),
+                             ITS_FILE_ID_SIZE);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        index->fid_hash[i] = its_mblock_fid_hash(fid);
+    }
+
+    return PSA_SUCCESS;
+}
+
 /**
  * \brief Swaps metablocks. Scratch becomes active and active becomes scratch.
  */
@@ -361,20 +475,16 @@ static inline psa_status_t its_mblock_validate_block_meta(
  */
 static uint32_t its_get_free_file_index(void)
 {
-    psa_status_t err;
+    const struct its_mblock_index_t *index;
     uint32_t i;
-    struct its_file_meta_t tmp_metadata;
 
-    for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
-        err = its_flash_fs_mblock_read_file_meta(i, &tmp_metadata);
-        if (err != PSA_SUCCESS) {
-            return ITS_METADATA_INVALID_INDEX;
-        }
+    index = its_mblock_index_of(its_mblock_cur_meta_active());
 
-        /* Check if this entry is free by checking if ID values is an
-         * invalid ID.
+    for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
+        /* Check if this entry is free by checking if the index recorded an
+         * invalid ID for it.
          */
-        if (its_utils_validate_fid(tmp_metadata.id) != PSA_SUCCESS) {
+        if (index->fid_hash[i] == ITS_FID_HASH_EMPTY) {
             /* Found */
             return i;
         }
@@ -431,14 +541,22 @@ static psa_status_t its_mblock_erase_scratch_blocks(void)
 static psa_status_t its_mblock_update_scratch_block_meta(uint32_t lblock,
                                       const struct its_block_meta_t *block_meta)
 {
+    psa_status_t err;
     uint32_t meta_block;
     size_t pos;
 
     meta_block = its_cur_meta_scratch_id();
     /* Calculate the position */
     pos = its_mblock_block_meta_offset(lblock);
-    return its_flash_write(meta_block, (const uint8_t *)block_meta, pos,
-                           ITS_BLOCK_METADATA_SIZE);
+    err = its_flash_write(meta_block, (const uint8_t *)block_meta, pos,
+                          ITS_BLOCK_METADATA_SIZE);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    its_mblock_index_of(meta_block)->free_size[lblock] = block_meta->free_size;
+
+    return PSA_SUCCESS;
 }
 
 /**
@@ -452,6 +570,7 @@ static psa_status_t its_mblock_copy_remaining_block_meta(uint32_t lblock)
 {
     struct its_block_meta_t block_meta;
     psa_status_t err;
+    uint32_t i;
     uint32_t meta_block;
     size_t pos;
     uint32_t scratch_block;
@@ -508,8 +627,23 @@ static psa_status_t its_mblock_copy_remaining_block_meta(uint32_t lblock)
 
     size = its_mblock_file_meta_offset(0) - pos;
 
-    return its_flash_block_to_block_move(scratch_block, pos, meta_block, pos,
-                                         size);
+    err = its_flash_block_to_block_move(scratch_block, pos, meta_block, pos,
+                                        size);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* Logical block 0 has the same free size in both indexes, so it can be
+     * copied as well.
+     */
+    for (i = 0; i < ITS_NUM_ACTIVE_DBLOCKS; i++) {
+        if (i != lblock) {
+            its_mblock_index_of(scratch_block)->free_size[i] =
+                               its_mblock_index_of(meta_block)->free_size[i];
+        }
+    }
+
+    return PSA_SUCCESS;
 }
 
 /**
@@ -642,8 +776,16 @@ static psa_status_t its_mblock_reserve_file(const uint8_t *fid, size_t size,
 {
     psa_status_t err;
     uint32_t i;
+    const struct its_mblock_index_t *index;
+
+    index = its_mblock_index_of(its_mblock_cur_meta_active());
 
     for (i = 0; i < ITS_NUM_ACTIVE_DBLOCKS; i++) {
+        /* Skip the blocks which the index shows as not having enough space */
+        if (index->free_size[i] < size) {
+            continue;
+        }
+
         err = its_flash_fs_mblock_read_block_metadata(i, block_meta);
         if (err != PSA_SUCCESS) {
             return PSA_ERROR_GENERIC_ERROR;
@@ -731,6 +873,7 @@ psa_status_t its_flash_fs_mblock_cp_remaining_file_meta(uint32_t idx)
 {
     psa_status_t err;
     size_t end;
+    uint32_t i;
     uint32_t meta_block;
     size_t pos;
     uint32_t scratch_block;
@@ -757,9 +900,19 @@ psa_status_t its_flash_fs_mblock_cp_remaining_file_meta(uint32_t idx)
     if (end > pos) {
         err = its_flash_block_to_block_move(scratch_block, pos, meta_block,
                                             pos, (end - pos));
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
     }
 
-    return err;
+    for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
+        if (i != idx) {
+            its_mblock_index_of(scratch_block)->fid_hash[i] =
+                                 its_mblock_index_of(meta_block)->fid_hash[i];
+        }
+    }
+
+    return PSA_SUCCESS;
 }
 
 uint32_t its_flash_fs_mblock_cur_data_scratch_id(uint32_t lblock)
@@ -775,16 +928,29 @@ uint32_t its_flash_fs_mblock_cur_data_scratch_id(uint32_t lblock)
 psa_status_t its_flash_fs_mblock_get_file_idx(const uint8_t *fid, uint32_t *idx)
 {
     psa_status_t err;
+    uint32_t hash;
     uint32_t i;
+    const struct its_mblock_index_t *index;
     struct its_file_meta_t tmp_metadata;
 
+    hash = its_mblock_fid_hash(fid);
+    if (hash == ITS_FID_HASH_EMPTY) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    index = its_mblock_index_of(its_mblock_cur_meta_active());
+
     for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
+        /* Only the entries with a matching hash need to be read */
+        if (index->fid_hash[i] != hash) {
+            continue;
+        }
+
         err = its_flash_fs_mblock_read_file_meta(i, &tmp_metadata);
         if (err != PSA_SUCCESS) {
             return PSA_ERROR_GENERIC_ERROR;
         }
 
-        /* ID with value 0x00 means end of file meta section */
         if (!tfm_memcmp(tmp_metadata.id, fid, ITS_FILE_ID_SIZE)) {
             /* Found */
             *idx = i;
@@ -815,6 +981,12 @@ psa_status_t its_flash_fs_mblock_init(void)
         return PSA_ERROR_GENERIC_ERROR;
     }
 
+    /* Build the RAM index of the active metadata block */
+    err = its_mblock_build_index();
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
     /* Erase the other scratch metadata block */
     return its_mblock_erase_scratch_blocks();
 }
@@ -1058,6 +1230,7 @@ psa_status_t its_flash_fs_mblock_update_scratch_block_meta(
 psa_status_t its_flash_fs_mblock_update_scratch_file_meta(uint32_t idx,
                                         const struct its_file_meta_t *file_meta)
 {
+    psa_status_t err;
     size_t pos;
     uint32_t scratch_block;
 
@@ -1065,6 +1238,14 @@ psa_status_t its_flash_fs_mblock_update_scratch_file_meta(uint32_t idx,
 
     /* Calculate the position */
     pos = its_mblock_file_meta_offset(idx);
-    return its_flash_write(scratch_block, (const uint8_t *)file_meta, pos,
-                           ITS_FILE_METADATA_SIZE);
+    err = its_flash_write(scratch_block, (const uint8_t *)file_meta, pos,
+                          ITS_FILE_METADATA_SIZE);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    its_mblock_index_of(scratch_block)->fid_hash[idx] =
+                                              its_mblock_fid_hash(file_meta->id);
+
+    return PSA_SUCCESS;
 }
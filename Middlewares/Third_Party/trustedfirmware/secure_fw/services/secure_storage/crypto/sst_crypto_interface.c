@@ -26,16 +26,46 @@
     PSA_ALG_AEAD_WITH_TAG_LENGTH(PSA_ALG_GCM, SST_TAG_LEN_BYTES)
 
 static psa_key_handle_t sst_key_handle;
+#ifdef SST_CACHE_KEY
+/* The cached key handle is owned by the partition which loaded it, so it is
+ * only loaded and used outside of the (re)initialisation of SST, which may run
+ * in the context of another partition.
+ */
+static psa_key_handle_t sst_cached_key_handle;
+static bool sst_key_cached = false;
+static bool sst_key_cache_enabled = true;
+#endif
 static uint8_t sst_crypto_iv_buf[SST_IV_LEN_BYTES];
 
 psa_ps_status_t sst_crypto_init(void)
 {
-    /* Currently, no initialisation is required. This may change if key
-     * handling is changed.
+#ifdef SST_CACHE_KEY
+    psa_status_t status;
+
+    sst_key_cache_enabled = false;
+
+    /* Release the key cached before the (re)initialisation. If it was loaded
+     * in the context of another partition, it can not be destroyed from this
+     * one and is kept for the next operations of that partition instead.
      */
+    if (sst_key_cached) {
+        status = psa_destroy_key(sst_cached_key_handle);
+        if (status != PSA_ERROR_NOT_PERMITTED) {
+            sst_key_cached = false;
+        }
+    }
+#endif
+
     return PSA_PS_SUCCESS;
 }
 
+void sst_crypto_init_complete(void)
+{
+#ifdef SST_CACHE_KEY
+    sst_key_cache_enabled = true;
+#endif
+}
+
 psa_ps_status_t sst_crypto_getkey(uint32_t key_len, uint8_t *key)
 {
     enum tfm_plat_err_t err;
@@ -67,27 +97,87 @@ psa_ps_status_t sst_crypto_setkey(uint32_t key_len, const uint8_t *key)
         return PSA_PS_ERROR_OPERATION_FAILED;
     }
 
-    /* Set the key policy */
+    /* Set the key policy. The key is not exportable. */
     psa_key_policy_set_usage(&key_policy, SST_KEY_USAGE, SST_CRYPTO_ALG);
     status = psa_set_key_policy(sst_key_handle, &key_policy);
-    if (status != PSA_SUCCESS) {
-        return PSA_PS_ERROR_OPERATION_FAILED;
+    if (status == PSA_SUCCESS) {
+        status = psa_import_key(sst_key_handle, SST_KEY_TYPE, key, key_len);
     }
 
-    status = psa_import_key(sst_key_handle, SST_KEY_TYPE, key, key_len);
     if (status != PSA_SUCCESS) {
+        /* Release the key handle */
+        (void)psa_destroy_key(sst_key_handle);
         return PSA_PS_ERROR_OPERATION_FAILED;
     }
 
     return PSA_PS_SUCCESS;
 }
 
+psa_ps_status_t sst_crypto_loadkey(void)
+{
+    psa_ps_status_t err;
+
+    /* SST key. Aligned to a 32-bit boundary so that crypto implementations
+     * can copy key material with 32-bit accesses.
+     */
+    __attribute__ ((aligned(4)))
+    static uint8_t sst_key[SST_KEY_LEN_BYTES];
+
+#ifdef SST_CACHE_KEY
+    if (sst_key_cache_enabled && sst_key_cached) {
+        sst_key_handle = sst_cached_key_handle;
+        return PSA_PS_SUCCESS;
+    }
+#endif
+
+    err = sst_crypto_getkey(SST_KEY_LEN_BYTES, sst_key);
+    if (err == PSA_PS_SUCCESS) {
+        err = sst_crypto_setkey(SST_KEY_LEN_BYTES, sst_key);
+    }
+
+    /* The key is only held by the crypto service from this point */
+    (void)tfm_memset(sst_key, 0, SST_KEY_LEN_BYTES);
+
+#ifdef SST_CACHE_KEY
+    if (sst_key_cache_enabled && (err == PSA_PS_SUCCESS)) {
+        sst_cached_key_handle = sst_key_handle;
+        sst_key_cached = true;
+    }
+#endif
+
+    return err;
+}
+
+psa_ps_status_t sst_crypto_unloadkey(void)
+{
+#ifdef SST_CACHE_KEY
+    if (sst_key_cache_enabled) {
+        /* Keep the key for the next operations */
+        return PSA_PS_SUCCESS;
+    }
+#endif
+
+    return sst_crypto_destroykey();
+}
+
 psa_ps_status_t sst_crypto_destroykey(void)
 {
+    psa_key_handle_t handle = sst_key_handle;
     psa_status_t status;
 
+#ifdef SST_CACHE_KEY
+    if (sst_key_cache_enabled) {
+        if (!sst_key_cached) {
+            return PSA_PS_SUCCESS;
+        }
+
+        handle = sst_cached_key_handle;
+        sst_key_cached = false;
+    }
+#endif
+
     /* Destroy the transient key */
-    status = psa_destroy_key(sst_key_handle);
+    status = psa_destroy_key(handle);
     if (status != PSA_SUCCESS) {
         return PSA_PS_ERROR_OPERATION_FAILED;
     }
@@ -33,12 +33,22 @@ union sst_crypto_t {
 };
 
 /**
- * \brief Initializes the crypto engine.
+ * \brief Initializes the crypto engine, at the start of the (re)initialisation
+ *        of SST.
+ *
+ * \note  If SST_CACHE_KEY is defined, the key cached so far is released and
+ *        no key is cached until \ref sst_crypto_init_complete is called.
  *
  * \return Returns values as described in \ref psa_ps_status_t
  */
 psa_ps_status_t sst_crypto_init(void);
 
+/**
+ * \brief Marks the end of the (re)initialisation of SST, after which the key
+ *        can be cached again.
+ */
+void sst_crypto_init_complete(void);
+
 /**
  * \brief Gets a key for specific client id.
  *
@@ -66,6 +76,31 @@ psa_ps_status_t sst_crypto_destroykey(void);
  */
 psa_ps_status_t sst_crypto_setkey(uint32_t key_len, const uint8_t *key);
 
+/**
+ * \brief Gets the SST key and sets it as the key to use for crypto operations.
+ *
+ * \note  The key material is cleared from SST memory once it has been
+ *        imported in the crypto service. If SST_CACHE_KEY is defined, only the
+ *        first call outside of the (re)initialisation of SST gets and imports
+ *        the key, which is then kept until \ref sst_crypto_destroykey or
+ *        \ref sst_crypto_init is called.
+ *
+ * \return Returns values as described in \ref psa_ps_status_t
+ */
+psa_ps_status_t sst_crypto_loadkey(void);
+
+/**
+ * \brief Releases the key set by \ref sst_crypto_loadkey, once the crypto
+ *        operations which use it are complete.
+ *
+ * \note  If SST_CACHE_KEY is defined, the key is kept for the next operations,
+ *        except during the (re)initialisation of SST. Otherwise, it is
+ *        destroyed.
+ *
+ * \return Returns values as described in \ref psa_ps_status_t
+ */
+psa_ps_status_t sst_crypto_unloadkey(void);
+
 /**
  * \brief Encrypts and tags the given plaintext data.
  *
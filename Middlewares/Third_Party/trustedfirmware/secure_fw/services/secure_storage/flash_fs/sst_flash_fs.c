@@ -226,6 +226,14 @@ psa_ps_status_t sst_flash_fs_file_write(uint32_t fid, uint32_t size,
         return PSA_PS_ERROR_UID_NOT_FOUND;
     }
 
+    /* Check that the content fits in the file and does not leave a gap after
+     * the current file data.
+     */
+    err = sst_utils_check_contained_in(file_meta.max_size, offset, size);
+    if ((err != PSA_PS_SUCCESS) || (offset > file_meta.cur_size)) {
+        return PSA_PS_ERROR_INVALID_ARGUMENT;
+    }
+
     /* Read block metadata */
     err = sst_flash_fs_mblock_read_block_metadata(file_meta.lblock,
                                                   &block_meta);
@@ -239,9 +247,27 @@ psa_ps_status_t sst_flash_fs_file_write(uint32_t fid, uint32_t size,
         return PSA_PS_ERROR_OPERATION_FAILED;
     }
 
-    if (size > file_meta.cur_size) {
+    /* Copy the file data before the written content */
+    if (offset > 0) {
+        err = sst_flash_fs_dblock_cp_data_to_scratch(file_meta.lblock,
+                                                     file_meta.data_idx,
+                                                     offset);
+        if (err != PSA_PS_SUCCESS) {
+            return PSA_PS_ERROR_OPERATION_FAILED;
+        }
+    }
+
+    if ((offset + size) < file_meta.cur_size) {
+        /* Copy the file data after the written content */
+        err = sst_flash_fs_dblock_cp_data_to_scratch(file_meta.lblock,
+                                          file_meta.data_idx + offset + size,
+                                          file_meta.cur_size - (offset + size));
+        if (err != PSA_PS_SUCCESS) {
+            return PSA_PS_ERROR_OPERATION_FAILED;
+        }
+    } else {
         /* Update the file metadata */
-        file_meta.cur_size = size;
+        file_meta.cur_size = offset + size;
     }
 
     err = sst_flash_fs_dblock_cp_remaining_data(&block_meta, &file_meta);
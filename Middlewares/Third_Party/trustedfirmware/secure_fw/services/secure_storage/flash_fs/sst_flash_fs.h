@@ -101,6 +101,10 @@ psa_ps_status_t sst_flash_fs_file_get_info(uint32_t fid,
  * \param[in] offset  Offset in the file
  * \param[in] data    Pointer to buffer containing data to be written
  *
+ * \note The rest of the file data is kept, so data can be appended to the
+ *       file by writing it at the current file size. The offset cannot be
+ *       larger than the current file size.
+ *
  * \return Returns error code as specified in \ref psa_ps_status_t
  */
 psa_ps_status_t sst_flash_fs_file_write(uint32_t fid,
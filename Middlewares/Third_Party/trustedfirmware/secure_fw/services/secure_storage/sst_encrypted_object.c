@@ -15,231 +15,492 @@
 #include "sst_object_defs.h"
 #include "sst_utils.h"
 
-/* Gets the size of data to encrypt */
-#define SST_ENCRYPT_SIZE(plaintext_size) \
-    ((plaintext_size) + SST_OBJECT_HEADER_SIZE - sizeof(union sst_crypto_t))
+/* An encrypted object is stored in the file system as the header IV, the
+ * format version and the number of chunks, followed by the encrypted header
+ * and the encrypted object data. The header tag is stored in the object table.
+ * The object data is encrypted and authenticated in chunks of SST_CHUNK_SIZE
+ * bytes, whose IV and tag are stored in the encrypted header, so that each
+ * chunk can be read or updated on its own. The header only stores the chunk
+ * metadata of the maximum size of the object.
+ */
 
-#define SST_CRYPTO_CLEAR_BUF_VALUE 0
-#define SST_OBJECT_START_POSITION  0
-#define SST_EMPTY_OBJECT_SIZE      0
+/* Position of the object in the object structure */
+#define SST_OBJECT_IMAGE_OFFSET  offsetof(struct sst_object_t, header.crypto.ref.iv)
+
+/* Size of the header fields stored in the clear */
+#define SST_PLAIN_HEADER_SIZE \
+    (offsetof(struct sst_object_t, header.info) - SST_OBJECT_IMAGE_OFFSET)
+
+/* Size of the encrypted part of the header, for the given number of chunks */
+#define SST_ENCRYPTED_HEADER_SIZE(num_chunks) \
+    (sizeof(struct sst_object_info_t) + \
+     ((num_chunks) * sizeof(union sst_crypto_t)))
 
-/* Buffer to store the maximum encrypted object */
-/* FIXME: Do partial encrypt/decrypt to reduce the size of internal buffer */
-#define SST_MAX_ENCRYPTED_OBJ_SIZE GET_ALIGNED_FLASH_BYTES( \
-                                     SST_ENCRYPT_SIZE(SST_MAX_OBJECT_DATA_SIZE))
+/* Position of the object data in the file */
+#define SST_DATA_START_POSITION(num_chunks) \
+    GET_ALIGNED_FLASH_BYTES(SST_PLAIN_HEADER_SIZE + \
+                            SST_ENCRYPTED_HEADER_SIZE(num_chunks))
 
-/* FIXME: add the tag length to the crypto buffer size to account for the tag
- * being appended to the ciphertext by the crypto layer.
+/* Gets the size of an object in the file system */
+#define SST_FILE_SIZE(num_chunks, data_size) \
+    GET_ALIGNED_FLASH_BYTES(SST_DATA_START_POSITION(num_chunks) + (data_size))
+
+#define SST_OBJECT_START_POSITION  0
+
+/* Checks at compile time that the object as stored in the file system, which
+ * starts at the header IV, fits in the object structure, with the object data
+ * not before its position in the structure.
+ */
+SST_UTILS_BOUND_CHECK(ENCRYPTED_OBJECT_NOT_FIT_IN_OBJECT,
+                      SST_FILE_SIZE(SST_NUM_CHUNKS, SST_MAX_OBJECT_DATA_SIZE),
+                      (SST_MAX_OBJECT_SIZE - SST_OBJECT_IMAGE_OFFSET));
+SST_UTILS_BOUND_CHECK(ENCRYPTED_OBJECT_DATA_NOT_FIT_IN_OBJECT,
+                      SST_DATA_START_POSITION(SST_NUM_CHUNKS),
+                      (offsetof(struct sst_object_t, data)
+                       - SST_OBJECT_IMAGE_OFFSET));
+
+/* Buffer to store an encrypted header or chunk. The tag length is added to
+ * account for the tag being appended to the ciphertext by the crypto layer.
  */
-#define SST_CRYPTO_BUF_LEN (SST_MAX_ENCRYPTED_OBJ_SIZE + SST_TAG_LEN_BYTES)
+#define SST_MAX_ENCRYPTED_HEADER_SIZE \
+    SST_ENCRYPTED_HEADER_SIZE(SST_NUM_CHUNKS)
+#define SST_CRYPTO_BUF_LEN \
+    (((SST_MAX_ENCRYPTED_HEADER_SIZE > SST_CHUNK_SIZE) ? \
+      SST_MAX_ENCRYPTED_HEADER_SIZE : SST_CHUNK_SIZE) + SST_TAG_LEN_BYTES)
 
 static uint8_t sst_crypto_buf[SST_CRYPTO_BUF_LEN];
 
+/*!
+ * \struct sst_header_assoc_data_t
+ *
+ * \brief Associated data which binds the header to its file and the header
+ *        fields stored in the clear.
+ */
+struct sst_header_assoc_data_t {
+    uint32_t fid;             /*!< File ID */
+    uint16_t format_version;  /*!< Object format version */
+    uint16_t num_chunks;      /*!< Number of chunk metadata entries stored */
+};
+
+/*!
+ * \struct sst_chunk_assoc_data_t
+ *
+ * \brief Associated data which binds a data chunk to its object.
+ */
+struct sst_chunk_assoc_data_t {
+    psa_ps_uid_t uid;   /*!< Unique identifier of the object */
+    int32_t client_id;  /*!< Identifier of the object's owner */
+    uint32_t index;     /*!< Index of the chunk in the object data */
+};
+
 /**
- * \brief Gets the encryption key and sets it as the key to be used for
- *        cryptographic operations.
+ * \brief Gets the size of a data chunk.
  *
- * \return Returns error code as specified in \ref psa_ps_status_t
+ * \param[in] idx        Chunk index
+ * \param[in] data_size  Current size of the object data
+ *
+ * \return Returns the number of bytes of object data in the chunk
  */
-static psa_ps_status_t sst_object_set_encryption_key(void)
+__attribute__((always_inline))
+static inline uint32_t sst_object_chunk_size(uint32_t idx, uint32_t data_size)
 {
-    psa_ps_status_t err;
+    uint32_t start = idx * SST_CHUNK_SIZE;
 
-    /* SST object key. Aligned to a 32-bit boundary so that crypto
-     * implementations can copy key material with 32-bit accesses.
-     */
-    __attribute__ ((aligned(4)))
-    static uint8_t sst_encryption_key[SST_KEY_LEN_BYTES];
-
-    /* Get the encryption key */
-    err = sst_crypto_getkey(SST_KEY_LEN_BYTES, sst_encryption_key);
-    if (err != PSA_PS_SUCCESS) {
-        return err;
-    }
+    return ((data_size - start) < SST_CHUNK_SIZE) ? (data_size - start)
+                                                  : SST_CHUNK_SIZE;
+}
 
-    /* Set the key to be used for crypto operations */
-    err = sst_crypto_setkey(SST_KEY_LEN_BYTES, sst_encryption_key);
+/**
+ * \brief Moves the object data towards the start of the object.
+ *
+ * \param[out] dst   Destination, not after the source
+ * \param[in]  src   Source
+ * \param[in]  size  Number of bytes to move
+ */
+static void sst_object_move_data(uint8_t *dst, const uint8_t *src,
+                                 uint32_t size)
+{
+    uint32_t i;
 
-    return err;
+    /* A forward copy is safe as the destination is not after the source */
+    if (dst != src) {
+        for (i = 0; i < size; i++) {
+            dst[i] = src[i];
+        }
+    }
 }
 
 /**
- * \brief Performs authenticated decryption on object data, with the header as
- *        the associated data.
+ * \brief Performs authenticated decryption on the object header.
  *
- * \param[in]  fid       File ID
- * \param[in]  cur_size  Size of the object data to decrypt
- * \param[in,out] obj    Pointer to the object structure to authenticate and
- *                       fill in with the decrypted data. The tag of the object
- *                       is the one stored in the object table for the given
- *                       File ID.
+ * \param[in]     fid  File ID
+ * \param[in,out] obj  Pointer to the object structure to authenticate and
+ *                     fill in with the decrypted header. The tag of the header
+ *                     is the one stored in the object table for the given
+ *                     File ID.
  *
  * \return Returns error code as specified in \ref psa_ps_status_t
  */
-static psa_ps_status_t sst_object_auth_decrypt(uint32_t fid,
-                                               uint32_t cur_size,
-                                               struct sst_object_t *obj)
+static psa_ps_status_t sst_object_auth_decrypt_header(uint32_t fid,
+                                                      struct sst_object_t *obj)
 {
     psa_ps_status_t err;
-    uint8_t *p_obj_data = (uint8_t *)&obj->header.info;
+    uint8_t *p_hdr = (uint8_t *)&obj->header.info;
+    uint32_t hdr_size = SST_ENCRYPTED_HEADER_SIZE(obj->header.num_chunks);
+    struct sst_header_assoc_data_t assoc_data = {
+        .fid = fid,
+        .format_version = obj->header.format_version,
+        .num_chunks = obj->header.num_chunks,
+    };
     size_t out_len;
 
-    err = sst_object_set_encryption_key();
-    if (err != PSA_PS_SUCCESS) {
-        return err;
-    }
-
-    (void)tfm_memcpy(sst_crypto_buf, p_obj_data, cur_size);
+    (void)tfm_memcpy(sst_crypto_buf, p_hdr, hdr_size);
 
     /* Use File ID as a part of the associated data to authenticate
      * the object in the FS. The tag will be stored in the object table and
      * not as a part of the object's data stored in the FS.
      */
-
     err = sst_crypto_auth_and_decrypt(&obj->header.crypto,
-                                      (const uint8_t *)&fid,
-                                      sizeof(fid),
+                                      (const uint8_t *)&assoc_data,
+                                      sizeof(assoc_data),
                                       sst_crypto_buf,
-                                      cur_size,
-                                      p_obj_data,
-                                      sizeof(*obj) - sizeof(obj->header.crypto),
+                                      hdr_size,
+                                      p_hdr,
+                                      hdr_size,
                                       &out_len);
-    if (err != PSA_PS_SUCCESS || out_len != cur_size) {
-        (void)sst_crypto_destroykey();
+    if (err != PSA_PS_SUCCESS) {
         return err;
     }
 
-    return sst_crypto_destroykey();
+    if (out_len != hdr_size) {
+        return PSA_PS_ERROR_OPERATION_FAILED;
+    }
+
+    /* The number of chunks is authenticated, but must also be the one of the
+     * maximum size of the object
+     */
+    if ((obj->header.info.current_size > obj->header.info.max_size) ||
+        (obj->header.num_chunks !=
+         SST_OBJECT_NUM_CHUNKS(obj->header.info.max_size))) {
+        return PSA_PS_ERROR_DATA_CORRUPT;
+    }
+
+    return PSA_PS_SUCCESS;
 }
 
 /**
- * \brief Performs authenticated encryption on object data, with the header as
- *        the associated data.
+ * \brief Performs authenticated encryption on the object header.
  *
- * \param[in]  fid       File ID
- * \param[in]  cur_size  Size of the object data to encrypt
- * \param[out] obj       Pointer to the object structure to authenticate and
- *                       fill in with the encrypted data.
+ * \param[in]     fid  File ID
+ * \param[in,out] obj  Pointer to the object structure to authenticate and
+ *                     fill in with the encrypted header.
  *
  * \return Returns error code as specified in \ref psa_ps_status_t
  */
-static psa_ps_status_t sst_object_auth_encrypt(uint32_t fid,
-                                               uint32_t cur_size,
-                                               struct sst_object_t *obj)
+static psa_ps_status_t sst_object_auth_encrypt_header(uint32_t fid,
+                                                      struct sst_object_t *obj)
 {
     psa_ps_status_t err;
-    uint8_t *p_obj_data = (uint8_t *)&obj->header.info;
+    uint8_t *p_hdr = (uint8_t *)&obj->header.info;
+    uint32_t hdr_size = SST_ENCRYPTED_HEADER_SIZE(obj->header.num_chunks);
+    struct sst_header_assoc_data_t assoc_data = {
+        .fid = fid,
+        .format_version = obj->header.format_version,
+        .num_chunks = obj->header.num_chunks,
+    };
     size_t out_len;
 
-    err = sst_object_set_encryption_key();
+    /* FIXME: should have an IV per object with key diversification */
+    /* Get a new IV for each encryption */
+    sst_crypto_get_iv(&obj->header.crypto);
+
+    err = sst_crypto_encrypt_and_tag(&obj->header.crypto,
+                                     (const uint8_t *)&assoc_data,
+                                     sizeof(assoc_data),
+                                     p_hdr,
+                                     hdr_size,
+                                     sst_crypto_buf,
+                                     sizeof(sst_crypto_buf),
+                                     &out_len);
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
 
-    /* FIXME: should have an IV per object with key diversification */
-    /* Get a new IV for each encryption */
-    sst_crypto_get_iv(&obj->header.crypto);
+    if (out_len != hdr_size) {
+        return PSA_PS_ERROR_OPERATION_FAILED;
+    }
 
-    /* Use File ID as a part of the associated data to authenticate
-     * the object in the FS. The tag will be stored in the object table and
-     * not as a part of the object's data stored in the FS.
+    (void)tfm_memcpy(p_hdr, sst_crypto_buf, hdr_size);
+
+    return PSA_PS_SUCCESS;
+}
+
+/**
+ * \brief Reads a data chunk and performs authenticated decryption on it.
+ *
+ * \param[in]     fid         File ID
+ * \param[in]     assoc_data  Associated data of the chunk
+ * \param[in,out] obj         Pointer to the object structure to fill in with
+ *                            the decrypted chunk
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_read_chunk(
+                               uint32_t fid,
+                               const struct sst_chunk_assoc_data_t *assoc_data,
+                               struct sst_object_t *obj)
+{
+    psa_ps_status_t err;
+    uint32_t chunk_offset = assoc_data->index * SST_CHUNK_SIZE;
+    uint32_t chunk_size;
+    size_t out_len;
+
+    chunk_size = sst_object_chunk_size(assoc_data->index,
+                                       obj->header.info.current_size);
+
+    err = sst_flash_fs_file_read(fid, chunk_size,
+                                 SST_DATA_START_POSITION(obj->header.num_chunks)
+                                 + chunk_offset,
+                                 sst_crypto_buf);
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+
+    /* The IV and tag in the authenticated header make an older version of
+     * the chunk fail the authentication.
      */
+    err = sst_crypto_auth_and_decrypt(
+                                 &obj->header.chunk_crypto[assoc_data->index],
+                                 (const uint8_t *)assoc_data,
+                                 sizeof(*assoc_data),
+                                 sst_crypto_buf,
+                                 chunk_size,
+                                 obj->data + chunk_offset,
+                                 chunk_size,
+                                 &out_len);
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
 
-    err = sst_crypto_encrypt_and_tag(&obj->header.crypto,
-                                     (const uint8_t *)&fid,
-                                     sizeof(fid),
-                                     p_obj_data,
-                                     cur_size,
+    if (out_len != chunk_size) {
+        return PSA_PS_ERROR_OPERATION_FAILED;
+    }
+
+    return PSA_PS_SUCCESS;
+}
+
+/**
+ * \brief Performs authenticated encryption on a data chunk, in place.
+ *
+ * \param[in]     assoc_data  Associated data of the chunk
+ * \param[in,out] obj         Pointer to the object structure which contains
+ *                            the chunk to encrypt
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_encrypt_chunk(
+                               const struct sst_chunk_assoc_data_t *assoc_data,
+                               struct sst_object_t *obj)
+{
+    psa_ps_status_t err;
+    union sst_crypto_t *crypto = &obj->header.chunk_crypto[assoc_data->index];
+    uint8_t *p_chunk = obj->data + (assoc_data->index * SST_CHUNK_SIZE);
+    uint32_t chunk_size;
+    size_t out_len;
+
+    chunk_size = sst_object_chunk_size(assoc_data->index,
+                                       obj->header.info.current_size);
+
+    /* Get a new IV for each encryption */
+    sst_crypto_get_iv(crypto);
+
+    err = sst_crypto_encrypt_and_tag(crypto,
+                                     (const uint8_t *)assoc_data,
+                                     sizeof(*assoc_data),
+                                     p_chunk,
+                                     chunk_size,
                                      sst_crypto_buf,
                                      sizeof(sst_crypto_buf),
                                      &out_len);
-    if (err != PSA_PS_SUCCESS || out_len != cur_size) {
-        (void)sst_crypto_destroykey();
+    if (err != PSA_PS_SUCCESS) {
         return err;
     }
 
-    (void)tfm_memcpy(p_obj_data, sst_crypto_buf, cur_size);
+    if (out_len != chunk_size) {
+        return PSA_PS_ERROR_OPERATION_FAILED;
+    }
+
+    (void)tfm_memcpy(p_chunk, sst_crypto_buf, chunk_size);
 
-    return sst_crypto_destroykey();
+    return PSA_PS_SUCCESS;
 }
 
 psa_ps_status_t sst_encrypted_object_read(uint32_t fid,
+                                          psa_ps_uid_t uid,
+                                          int32_t client_id,
+                                          uint32_t offset,
+                                          uint32_t size,
                                           struct sst_object_t *obj)
 {
+    struct sst_chunk_assoc_data_t assoc_data = {
+        .uid = uid,
+        .client_id = client_id,
+    };
     psa_ps_status_t err;
-    struct sst_file_info_t file_info;
-    uint32_t decrypt_size;
+    uint32_t end;
+    uint32_t num_chunks;
 
-    /* Get the current size of the encrypted object */
-    err = sst_flash_fs_file_get_info(fid, &file_info);
+    /* Read the header fields stored in the clear, which give the size of the
+     * encrypted header
+     */
+    err = sst_flash_fs_file_read(fid, SST_PLAIN_HEADER_SIZE,
+                                 SST_OBJECT_START_POSITION,
+                                 obj->header.crypto.ref.iv);
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
 
-    /* Read the encrypted object from the the persistent area */
-    err = sst_flash_fs_file_read(fid, file_info.size_current,
-                                 SST_OBJECT_START_POSITION,
-                                 obj->header.crypto.ref.iv);
+    if ((obj->header.format_version != SST_OBJECT_FORMAT_VERSION) ||
+        (obj->header.num_chunks > SST_NUM_CHUNKS)) {
+        return PSA_PS_ERROR_DATA_CORRUPT;
+    }
+
+    /* Read the encrypted header from the the persistent area */
+    err = sst_flash_fs_file_read(fid,
+                               SST_ENCRYPTED_HEADER_SIZE(obj->header.num_chunks),
+                               SST_PLAIN_HEADER_SIZE,
+                               (uint8_t *)&obj->header.info);
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
 
-    /* Get the decrypt size */
-    decrypt_size = file_info.size_current -
-                     GET_ALIGNED_FLASH_BYTES(sizeof(obj->header.crypto.ref.iv));
+    err = sst_crypto_loadkey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
 
-    /* Decrypt the object data */
-    err = sst_object_auth_decrypt(fid, decrypt_size, obj);
+    /* Decrypt the object header */
+    err = sst_object_auth_decrypt_header(fid, obj);
     if (err != PSA_PS_SUCCESS) {
+        (void)sst_crypto_destroykey();
         return err;
     }
 
-    return PSA_PS_SUCCESS;
+    /* Only the chunks which contain object data are stored */
+    num_chunks = (obj->header.info.current_size + SST_CHUNK_SIZE - 1)
+                 / SST_CHUNK_SIZE;
+    end = (size != 0) ? ((offset + size + SST_CHUNK_SIZE - 1) / SST_CHUNK_SIZE)
+                      : 0;
+    if (end > num_chunks) {
+        end = num_chunks;
+    }
+
+    /* Decrypt the chunks which contain the data range */
+    for (assoc_data.index = offset / SST_CHUNK_SIZE; assoc_data.index < end;
+         assoc_data.index++) {
+        err = sst_object_read_chunk(fid, &assoc_data, obj);
+        if (err != PSA_PS_SUCCESS) {
+            (void)sst_crypto_destroykey();
+            return err;
+        }
+    }
+
+    return sst_crypto_unloadkey();
 }
 
 psa_ps_status_t sst_encrypted_object_write(uint32_t fid,
+                                           uint32_t old_fid,
+                                           psa_ps_uid_t uid,
+                                           int32_t client_id,
+                                           uint32_t offset,
+                                           uint32_t size,
                                            struct sst_object_t *obj)
 {
+    struct sst_chunk_assoc_data_t assoc_data = {
+        .uid = uid,
+        .client_id = client_id,
+    };
     psa_ps_status_t err;
+    uint32_t first;
+    uint32_t end;
+    uint32_t num_chunks;
+    uint32_t data_size;
+    uint32_t data_start;
+    uint32_t max_size;
     uint32_t wrt_size;
 
-    wrt_size = SST_ENCRYPT_SIZE(obj->header.info.max_size) +
-               sizeof(obj->header.crypto.ref.iv);
+    /* Size the chunk metadata stored in the header by the maximum size of the
+     * object.
+     */
+    obj->header.format_version = SST_OBJECT_FORMAT_VERSION;
+    obj->header.num_chunks = SST_OBJECT_NUM_CHUNKS(obj->header.info.max_size);
+    data_start = SST_DATA_START_POSITION(obj->header.num_chunks);
+
+    /* Get the file sizes before the header is encrypted */
+    data_size = obj->header.info.current_size;
+    max_size = SST_FILE_SIZE(obj->header.num_chunks,
+                             obj->header.info.max_size);
+    wrt_size = SST_FILE_SIZE(obj->header.num_chunks, data_size);
 
-    wrt_size = GET_ALIGNED_FLASH_BYTES(wrt_size);
+    num_chunks = (data_size + SST_CHUNK_SIZE - 1) / SST_CHUNK_SIZE;
 
-#if (SST_FLASH_PROGRAM_UNIT!=1)
-    /* FIX ME
-     * As GET_ALIGNED_FLASH_BYTES is called twice
-     * to align  IV ,and header + payload
-     */
-    wrt_size +=SST_FLASH_PROGRAM_UNIT;
-#endif
+    /* Chunks which contain the updated data range */
+    first = offset / SST_CHUNK_SIZE;
+    end = (size != 0) ? ((offset + size + SST_CHUNK_SIZE - 1) / SST_CHUNK_SIZE)
+                      : first;
 
-    /* Create an object in the object system */
-    err = sst_flash_fs_file_create(fid, wrt_size, SST_EMPTY_OBJECT_SIZE, NULL);
+    err = sst_crypto_loadkey();
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
 
-    wrt_size = GET_ALIGNED_FLASH_BYTES(
-                               SST_ENCRYPT_SIZE(obj->header.info.current_size));
+    for (assoc_data.index = 0; assoc_data.index < num_chunks;
+         assoc_data.index++) {
+        if ((assoc_data.index >= first) && (assoc_data.index < end)) {
+            err = sst_object_encrypt_chunk(&assoc_data, obj);
+        } else {
+            /* Copy the unchanged chunk, which stays valid with the IV and tag
+             * kept in the header.
+             */
+            err = sst_flash_fs_file_read(old_fid,
+                                 sst_object_chunk_size(assoc_data.index,
+                                                       data_size),
+                                 data_start
+                                 + (assoc_data.index * SST_CHUNK_SIZE),
+                                 obj->data + (assoc_data.index * SST_CHUNK_SIZE));
+        }
+
+        if (err != PSA_PS_SUCCESS) {
+            (void)sst_crypto_destroykey();
+            return err;
+        }
+    }
+
+    /* Clear the crypto metadata of the stored chunks beyond the object data */
+    (void)tfm_memset(&obj->header.chunk_crypto[num_chunks], 0,
+                     (obj->header.num_chunks - num_chunks)
+                     * sizeof(union sst_crypto_t));
 
-    /* Authenticate and encrypt the object */
-    err = sst_object_auth_encrypt(fid, wrt_size, obj);
+    /* Authenticate and encrypt the object header */
+    err = sst_object_auth_encrypt_header(fid, obj);
     if (err != PSA_PS_SUCCESS) {
+        (void)sst_crypto_destroykey();
         return err;
     }
 
-    wrt_size += sizeof(obj->header.crypto.ref.iv);
+    err = sst_crypto_unloadkey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
 
-    wrt_size = GET_ALIGNED_FLASH_BYTES(wrt_size);
+    /* Move the object data right after the stored chunk metadata */
+    sst_object_move_data((uint8_t *)obj + SST_OBJECT_IMAGE_OFFSET + data_start,
+                         obj->data, data_size);
 
-    /* Write the encrypted object to the persistent area. The tag values is not
-     * copied as it is stored in the object table.
+    /* Create the object in the object system and write the encrypted object
+     * to the persistent area. The tag values is not copied as it is stored in
+     * the object table.
      */
-    err = sst_flash_fs_file_write(fid, wrt_size, SST_OBJECT_START_POSITION,
-                                  obj->header.crypto.ref.iv);
-
-    return err;
+    return sst_flash_fs_file_create(fid, max_size, wrt_size,
+                                    obj->header.crypto.ref.iv);
 }
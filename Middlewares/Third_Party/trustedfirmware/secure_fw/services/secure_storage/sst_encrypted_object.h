@@ -17,22 +17,46 @@ extern "C" {
 #endif
 
 /**
- * \brief Reads object referenced by the object File ID.
+ * \brief Reads the object referenced by the object File ID, and authenticates
+ *        and decrypts its header and the object data chunks which contain the
+ *        given data range.
  *
- * \param[in]  fid      File ID
- * \param[out] obj      Pointer to the object structure to fill in
+ * \param[in]  fid        File ID
+ * \param[in]  uid        Unique identifier of the object
+ * \param[in]  client_id  Identifier of the object's owner
+ * \param[in]  offset     Offset of the data range in the object data
+ * \param[in]  size       Size of the data range. It is set to 0 to read the
+ *                        object header only.
+ * \param[out] obj        Pointer to the object structure to fill in
+ *
+ * Note: Only the chunks which contain current object data are read, so the
+ *       data range can extend beyond the current object size.
  *
  * \return Returns error code specified in \ref psa_ps_status_t
  */
 psa_ps_status_t sst_encrypted_object_read(uint32_t fid,
+                                          psa_ps_uid_t uid,
+                                          int32_t client_id,
+                                          uint32_t offset,
+                                          uint32_t size,
                                           struct sst_object_t *obj);
 
 /**
  * \brief Creates and writes a new encrypted object based on the given
  *        sst_object_t structure data.
  *
- * \param[in]     fid      File ID
- * \param[in,out] obj      Pointer to the object structure to write.
+ * \param[in]     fid        File ID
+ * \param[in]     old_fid    File ID of the previous version of the object,
+ *                           or SST_INVALID_FID if there is none
+ * \param[in]     uid        Unique identifier of the object
+ * \param[in]     client_id  Identifier of the object's owner
+ * \param[in]     offset     Offset of the data range updated in obj
+ * \param[in]     size       Size of the data range updated in obj
+ * \param[in,out] obj        Pointer to the object structure to write.
+ *
+ * Note: Only the chunks which contain the updated data range are encrypted
+ *       from obj, so obj must hold the whole of those chunks. The other chunks
+ *       are copied, still encrypted, from the previous version of the object.
  *
  * Note: The function will use obj to store the encrypted data before write it
  *       into the flash to reduce the memory requirements and the number of
@@ -42,6 +66,11 @@ psa_ps_status_t sst_encrypted_object_read(uint32_t fid,
  * \return Returns error code specified in \ref psa_ps_status_t
  */
 psa_ps_status_t sst_encrypted_object_write(uint32_t fid,
+                                           uint32_t old_fid,
+                                           psa_ps_uid_t uid,
+                                           int32_t client_id,
+                                           uint32_t offset,
+                                           uint32_t size,
                                            struct sst_object_t *obj);
 
 #ifdef __cplusplus
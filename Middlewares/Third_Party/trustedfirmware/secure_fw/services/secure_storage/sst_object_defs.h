@@ -29,6 +29,47 @@ struct sst_object_info_t {
     psa_ps_create_flags_t create_flags; /*!< Object creation flags */
 };
 
+#define SST_MAX_OBJECT_DATA_SIZE  GET_ALIGNED_FLASH_BYTES(SST_MAX_ASSET_SIZE)
+
+#ifdef SST_ENCRYPTION
+/*!
+ * \def SST_CHUNK_SIZE
+ *
+ * \brief Size of the chunks in which the object data is encrypted and
+ *        authenticated. It can be overridden in flash_layout.h.
+ */
+#ifndef SST_CHUNK_SIZE
+#define SST_CHUNK_SIZE  256
+#endif
+
+/*!
+ * \def SST_OBJECT_NUM_CHUNKS
+ *
+ * \brief Number of chunk crypto metadata entries stored in the header of an
+ *        object of the given maximum size.
+ */
+#define SST_OBJECT_NUM_CHUNKS(max_size) \
+    (((max_size) + SST_CHUNK_SIZE - 1) / SST_CHUNK_SIZE)
+
+/*!
+ * \def SST_NUM_CHUNKS
+ *
+ * \brief Number of chunk crypto metadata entries in the object header in RAM,
+ *        for an object of the maximum size. It is rounded up to an odd number
+ *        so that the object data, which follows the header in the file system,
+ *        starts at the same offset in RAM when all the entries are stored.
+ */
+#define SST_NUM_CHUNKS (SST_OBJECT_NUM_CHUNKS(SST_MAX_OBJECT_DATA_SIZE) | 1u)
+
+/*!
+ * \def SST_OBJECT_FORMAT_VERSION
+ *
+ * \brief Version of the format of the encrypted objects in the file system.
+ *        Objects stored with another format are rejected as corrupted.
+ */
+#define SST_OBJECT_FORMAT_VERSION  1u
+#endif
+
 /*!
  * \struct sst_obj_header_t
  *
@@ -37,16 +78,25 @@ struct sst_object_info_t {
 struct sst_obj_header_t {
 #ifdef SST_ENCRYPTION
     union sst_crypto_t crypto;     /*!< Crypto metadata */
+    uint16_t format_version;       /*!< Object format version, not encrypted */
+    uint16_t num_chunks;           /*!< Number of entries of chunk_crypto
+                                    *   stored, not encrypted
+                                    */
 #else
     uint32_t version;              /*!< Object version */
     uint32_t fid;                  /*!< File ID */
 #endif
     struct sst_object_info_t info; /*!< Object information */
+#ifdef SST_ENCRYPTION
+    union sst_crypto_t chunk_crypto[SST_NUM_CHUNKS]; /*!< Crypto metadata of
+                                                      *   each data chunk, only
+                                                      *   the first num_chunks
+                                                      *   entries are stored
+                                                      */
+#endif
 };
 
 
-#define SST_MAX_OBJECT_DATA_SIZE  GET_ALIGNED_FLASH_BYTES(SST_MAX_ASSET_SIZE)
-
 /*!
  * \struct sst_object_t
  *
@@ -66,9 +116,10 @@ struct sst_object_t {
  * \def SST_MAX_NUM_OBJECTS
  *
  * \brief Specifies the maximum number of objects in the system, which is the
- *        number of defined assets, the object table and 2 temporary objects to
- *        store the temporary object table and temporary updated object.
+ *        number of defined assets, the object table, the object table change
+ *        log and 2 temporary objects to store the temporary object table and
+ *        temporary updated object.
  */
-#define SST_MAX_NUM_OBJECTS (SST_NUM_ASSETS + 3)
+#define SST_MAX_NUM_OBJECTS (SST_NUM_ASSETS + 4)
 
 #endif /* __SST_OBJECT_DEFS_H__ */
@@ -13,6 +13,7 @@
 #include "flash_fs/sst_flash_fs.h"
 #include "tfm_memory_utils.h"
 #ifdef SST_ENCRYPTION
+#include "crypto/sst_crypto_interface.h"
 #include "sst_encrypted_object.h"
 #endif
 #include "sst_object_defs.h"
@@ -162,20 +163,27 @@ psa_ps_status_t sst_system_prepare(void)
 {
     psa_ps_status_t err;
 
-    err = sst_flash_fs_prepare();
+#ifdef SST_ENCRYPTION
+    err = sst_crypto_init();
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
+#endif
 
-    /* Reuse the allocated g_sst_object.data to store a temporary object table
-     * data to be validate inside the function.
-     * The stored date will be cleaned up when the g_sst_object.data will
-     * be used for the first time in the object system.
-     */
-    err = sst_object_table_init(g_sst_object.data);
+    err = sst_flash_fs_prepare();
+    if (err == PSA_PS_SUCCESS) {
+        /* Reuse the allocated g_sst_object.data to store a temporary object
+         * table data to be validate inside the function.
+         * The stored date will be cleaned up when the g_sst_object.data will
+         * be used for the first time in the object system.
+         */
+        err = sst_object_table_init(g_sst_object.data);
+    }
 
 #ifdef SST_ENCRYPTION
     g_obj_tbl_info.tag = g_sst_object.header.crypto.ref.tag;
+
+    sst_crypto_init_complete();
 #endif
 
     return err;
@@ -196,7 +204,8 @@ psa_ps_status_t sst_object_read(psa_ps_uid_t uid, int32_t client_id,
 
     /* Read object */
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, uid, client_id,
+                                    offset, size, &g_sst_object);
 #else
     /* Read object header */
     err = sst_read_object(READ_ALL_OBJECT);
@@ -246,8 +255,9 @@ psa_ps_status_t sst_object_create(psa_ps_uid_t uid, int32_t client_id,
     err = sst_object_table_get_obj_tbl_info(uid, client_id, &g_obj_tbl_info);
     if (err == PSA_PS_SUCCESS) {
 #ifdef SST_ENCRYPTION
-        /* Read the object */
-        err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+        /* Read the object header */
+        err = sst_encrypted_object_read(g_obj_tbl_info.fid, uid, client_id,
+                                        0, 0, &g_sst_object);
 #else
         /* Read the object header */
         err = sst_read_object(READ_HEADER_ONLY);
@@ -298,7 +308,9 @@ psa_ps_status_t sst_object_create(psa_ps_uid_t uid, int32_t client_id,
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_write(g_obj_tbl_info.fid, &g_sst_object);
+    /* The whole object data is replaced */
+    err = sst_encrypted_object_write(g_obj_tbl_info.fid, old_fid, uid,
+                                     client_id, 0, size, &g_sst_object);
 #else
     wrt_size = SST_OBJECT_SIZE(g_sst_object.header.info.current_size);
 
@@ -358,7 +370,11 @@ psa_ps_status_t sst_object_write(psa_ps_uid_t uid, int32_t client_id,
 
     /* Read the object */
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    /* Read the object header and the object data in the chunks which are
+     * partially updated.
+     */
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, uid, client_id,
+                                    offset, size, &g_sst_object);
 #else
     err = sst_read_object(READ_ALL_OBJECT);
 #endif
@@ -408,7 +424,8 @@ psa_ps_status_t sst_object_write(psa_ps_uid_t uid, int32_t client_id,
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_write(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_write(g_obj_tbl_info.fid, old_fid, uid,
+                                     client_id, offset, size, &g_sst_object);
 #else
     wrt_size = SST_OBJECT_SIZE(g_sst_object.header.info.current_size);
 
@@ -457,7 +474,8 @@ psa_ps_status_t sst_object_get_info(psa_ps_uid_t uid, int32_t client_id,
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, uid, client_id, 0, 0,
+                                    &g_sst_object);
 #else
     err = sst_read_object(READ_HEADER_ONLY);
 #endif
@@ -490,7 +508,8 @@ psa_ps_status_t sst_object_delete(psa_ps_uid_t uid, int32_t client_id)
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, uid, client_id, 0, 0,
+                                    &g_sst_object);
 #else
     err = sst_read_object(READ_HEADER_ONLY);
 #endif
@@ -534,6 +553,11 @@ psa_ps_status_t sst_system_wipe_all(void)
      * this function doesn't block on the lock and directly
      * moves to erasing the flash instead.
      */
+#if defined(SST_ENCRYPTION) && defined(SST_CACHE_KEY)
+    /* Destroy the cached key. It is loaded again by the next operation. */
+    (void)sst_crypto_destroykey();
+#endif
+
     err = sst_flash_fs_wipe_all();
     if (err != PSA_PS_SUCCESS) {
         return err;
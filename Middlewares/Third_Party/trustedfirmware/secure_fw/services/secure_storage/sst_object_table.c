@@ -114,6 +114,72 @@ struct __attribute__((__aligned__(SST_FLASH_PROGRAM_UNIT))) sst_obj_table_t {
 #define SST_OBJECT_FS_ID_TO_IDX(fid) ((fid - 1) - \
                                       SST_TABLE_FS_ID(SST_OBJ_TABLE_IDX_1))
 
+/*!
+ * \def SST_OBJ_TABLE_LOG_ENTRIES
+ *
+ * \brief Maximum number of object table changes recorded in the change log.
+ *        When the change log is full, the next change is saved by writing the
+ *        whole object table, which compacts the change log. It can be
+ *        overridden in flash_layout.h, and set to 0 to write the whole object
+ *        table on every change.
+ */
+#ifndef SST_OBJ_TABLE_LOG_ENTRIES
+#define SST_OBJ_TABLE_LOG_ENTRIES 4
+#endif
+
+/*!
+ * \def SST_OBJ_TABLE_LOG_FS_ID
+ *
+ * \brief File ID to be used in order to store the object table change log in
+ *        the file system. It follows the file IDs of the objects.
+ */
+#define SST_OBJ_TABLE_LOG_FS_ID SST_OBJECT_FS_ID(SST_OBJ_TABLE_ENTRIES)
+
+/* Specifies that a change log record does not delete or set an entry */
+#define SST_OBJ_TABLE_LOG_NO_IDX SST_OBJ_TABLE_ENTRIES
+
+/*!
+ * \struct sst_obj_table_log_rec_t
+ *
+ * \brief Object table change log record structure.
+ */
+struct __attribute__((__aligned__(SST_FLASH_PROGRAM_UNIT)))
+sst_obj_table_log_rec_t {
+#ifdef SST_ENCRYPTION
+    union sst_crypto_t crypto;     /*!< Crypto metadata */
+#endif
+    uint32_t base_id;              /*!< Identifier of the object table which
+                                    *   the change applies to
+                                    */
+#ifdef SST_ROLLBACK_PROTECTION
+    uint32_t nv_counter;           /*!< SST NV counter 1 value of the change */
+#endif
+    uint32_t del_idx;              /*!< Index of the entry to delete */
+    uint32_t set_idx;              /*!< Index of the entry to set */
+    struct sst_obj_table_entry_t entry; /*!< Content of the entry to set */
+};
+
+/* Change log record size */
+#define SST_OBJ_TABLE_LOG_REC_SIZE  sizeof(struct sst_obj_table_log_rec_t)
+
+/* Change log file size */
+#define SST_OBJ_TABLE_LOG_SIZE  (SST_OBJ_TABLE_LOG_ENTRIES * \
+                                 SST_OBJ_TABLE_LOG_REC_SIZE)
+
+/* Number of slots in the hash index of the table entries. It is more than twice
+ * the number of entries to keep the probe sequences short.
+ */
+#define SST_OBJ_TABLE_HASH_SIZE  ((2 * SST_OBJ_TABLE_ENTRIES) + 1)
+
+/* Specifies an empty slot in the hash index. The other slots store the entry
+ * index plus one.
+ */
+#define SST_OBJ_TABLE_HASH_EMPTY 0
+
+/* Check at compilation time if the entry indexes fit in the hash index slots */
+SST_UTILS_BOUND_CHECK(OBJ_TABLE_ENTRIES_NOT_FIT_IN_HASH_SLOT,
+                      SST_OBJ_TABLE_ENTRIES, (UINT8_MAX - 1));
+
 /*!
  * \struct sst_obj_table_ctx_t
  *
@@ -123,6 +189,21 @@ struct sst_obj_table_ctx_t {
     struct sst_obj_table_t obj_table; /*!< Object tables */
     uint8_t active_table;             /*!< Active object table */
     uint8_t scratch_table;            /*!< Scratch object table */
+    uint8_t hash_idx[SST_OBJ_TABLE_HASH_SIZE]; /*!< Hash index of the table
+                                                *   entries
+                                                */
+    uint32_t log_num_recs;            /*!< Number of records in the change
+                                       *   log
+                                       */
+    uint32_t log_base_id;             /*!< Identifier of the active object
+                                       *   table in the change log records
+                                       */
+#ifdef SST_ENCRYPTION
+    uint8_t log_tag[SST_TAG_LEN_BYTES]; /*!< Tag of the last change log
+                                         *   record, or of the active object
+                                         *   table if the change log is empty
+                                         */
+#endif
 };
 
 /* Object table context */
@@ -162,6 +243,19 @@ struct sst_crypto_assoc_data_t {
                                         SST_NON_AUTH_OBJ_TABLE_SIZE)
 #endif /* SST_ROLLBACK_PROTECTION */
 
+#ifdef SST_ENCRYPTION
+#define SST_OBJ_TABLE_LOG_AUTH_DATA_SIZE (SST_OBJ_TABLE_LOG_REC_SIZE - \
+                                          SST_NON_AUTH_OBJ_TABLE_SIZE)
+
+/* The associated data of a change log record is the record, minus the crypto
+ * data, chained to the tag of the previous record or of the object table.
+ */
+struct sst_obj_table_log_assoc_data_t {
+    uint8_t prev_tag[SST_TAG_LEN_BYTES];
+    uint8_t log_rec_data[SST_OBJ_TABLE_LOG_AUTH_DATA_SIZE];
+};
+#endif /* SST_ENCRYPTION */
+
 /* The sst_object_table_init function uses the static memory allocated for
  * the object data manipulation, in sst_object_table.c (g_sst_object), to load a
  * temporary object table to be validated at that stage.
@@ -202,7 +296,20 @@ struct sst_obj_table_init_ctx_t {
 #ifdef SST_ROLLBACK_PROTECTION
     uint32_t nvc_1;        /*!< Non-volatile counter value 1 */
     uint32_t nvc_3;        /*!< Non-volatile counter value 3 */
+    uint32_t log_nvc;      /*!< Non-volatile counter value 1 of the last
+                            *   change log record
+                            */
 #endif /* SST_ROLLBACK_PROTECTION */
+    uint32_t log_num_recs; /*!< Number of records in the change log */
+    uint32_t log_base_id;  /*!< Object table identifier in the change log */
+    uint8_t log_table;     /*!< Index of the object table which the change log
+                            *   applies to
+                            */
+#ifdef SST_ENCRYPTION
+    union sst_crypto_t log_crypto; /*!< Crypto metadata of the last change log
+                                    *   record
+                                    */
+#endif
 };
 
 /**
@@ -270,35 +377,243 @@ __STATIC_INLINE psa_ps_status_t sst_object_table_fs_write_table(
     return PSA_PS_SUCCESS;
 }
 
+/**
+ * \brief Reads the number of records in the change log from persistent memory.
+ *
+ * \param[out] init_ctx  Pointer to the init object table context
+ *
+ */
+__attribute__ ((always_inline))
+__STATIC_INLINE void sst_object_table_fs_read_log_info(
+                                      struct sst_obj_table_init_ctx_t *init_ctx)
+{
+    psa_ps_status_t err;
+    struct sst_file_info_t info;
+
+    err = sst_flash_fs_file_get_info(SST_OBJ_TABLE_LOG_FS_ID, &info);
+    if (err == PSA_PS_SUCCESS) {
+        init_ctx->log_num_recs = info.size_current / SST_OBJ_TABLE_LOG_REC_SIZE;
+    }
+}
+
+#ifdef SST_ENCRYPTION
+/**
+ * \brief Generates change log record authentication tag.
+ *
+ * \param[in]     prev_tag  Tag of the previous record, or of the object table
+ *                          for the first record
+ * \param[in,out] log_rec   Pointer to the change log record to generate
+ *                          authentication
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_log_generate_auth_tag(
+                                      const uint8_t *prev_tag,
+                                      struct sst_obj_table_log_rec_t *log_rec)
+{
+    struct sst_obj_table_log_assoc_data_t assoc_data;
+    union sst_crypto_t *crypto = &log_rec->crypto;
+
+    /* Get new IV */
+    sst_crypto_get_iv(crypto);
+
+    (void)tfm_memcpy(assoc_data.prev_tag, prev_tag, SST_TAG_LEN_BYTES);
+    (void)tfm_memcpy(assoc_data.log_rec_data,
+                     SST_CRYPTO_ASSOCIATED_DATA(crypto),
+                     SST_OBJ_TABLE_LOG_AUTH_DATA_SIZE);
+
+    return sst_crypto_generate_auth_tag(crypto, (const uint8_t *)&assoc_data,
+                                        sizeof(assoc_data));
+}
+
+/**
+ * \brief Authenticates change log record.
+ *
+ * \param[in] prev_tag  Tag of the previous record, or of the object table for
+ *                      the first record
+ * \param[in] log_rec   Pointer to the change log record to authenticate
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_log_authenticate(
+                                 const uint8_t *prev_tag,
+                                 const struct sst_obj_table_log_rec_t *log_rec)
+{
+    struct sst_obj_table_log_assoc_data_t assoc_data;
+    const union sst_crypto_t *crypto = &log_rec->crypto;
+
+    (void)tfm_memcpy(assoc_data.prev_tag, prev_tag, SST_TAG_LEN_BYTES);
+    (void)tfm_memcpy(assoc_data.log_rec_data,
+                     SST_CRYPTO_ASSOCIATED_DATA(crypto),
+                     SST_OBJ_TABLE_LOG_AUTH_DATA_SIZE);
+
+    return sst_crypto_authenticate(crypto, (const uint8_t *)&assoc_data,
+                                   sizeof(assoc_data));
+}
+
+#ifdef SST_ROLLBACK_PROTECTION
+/**
+ * \brief Authenticates object table with the given SST non-volatile counter 1
+ *        value.
+ *
+ * \param[in] nvc_1      Value of SST non-volatile counter 1
+ * \param[in] obj_table  Pointer to the object table to authenticate
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_nvc_authenticate_table(
+                                        uint32_t nvc_1,
+                                        const struct sst_obj_table_t *obj_table)
+{
+    struct sst_crypto_assoc_data_t assoc_data;
+    const union sst_crypto_t *crypto = &obj_table->crypto;
+
+    assoc_data.nv_counter = nvc_1;
+    (void)tfm_memcpy(assoc_data.obj_table_data,
+                     SST_CRYPTO_ASSOCIATED_DATA(crypto),
+                     SST_OBJ_TABLE_AUTH_DATA_SIZE);
+
+    return sst_crypto_authenticate(crypto, (const uint8_t *)&assoc_data,
+                                   SST_CRYPTO_ASSOCIATED_DATA_LEN);
+}
+#endif /* SST_ROLLBACK_PROTECTION */
+#endif /* SST_ENCRYPTION */
+
+/**
+ * \brief Clears a table entry.
+ *
+ * \param[out] entry  Pointer to the entry to clear
+ *
+ */
+static void sst_table_clear_entry(struct sst_obj_table_entry_t *entry)
+{
+    entry->uid = TFM_SST_INVALID_UID;
+    entry->client_id = 0;
+
 #ifdef SST_ENCRYPTION
+    (void)tfm_memset(entry->tag, SST_DEFAULT_EMPTY_BUFF_VAL,
+                     SST_TAG_LEN_BYTES);
+#else
+    entry->version = 0;
+#endif
+}
+
 /**
- * \brief Sets crypto key for object table.
+ * \brief Applies a change log record to an object table.
+ *
+ * \param[in,out] obj_table  Pointer to the object table to update
+ * \param[in]     log_rec    Pointer to the change log record to apply
  *
  * \return Returns error code as specified in \ref psa_ps_status_t
  */
-static psa_ps_status_t sst_object_table_set_crypto_key(void)
+static psa_ps_status_t sst_object_table_log_apply(
+                                 struct sst_obj_table_t *obj_table,
+                                 const struct sst_obj_table_log_rec_t *log_rec)
+{
+    if ((log_rec->del_idx > SST_OBJ_TABLE_LOG_NO_IDX)
+        || (log_rec->set_idx > SST_OBJ_TABLE_LOG_NO_IDX)) {
+        return PSA_PS_ERROR_OPERATION_FAILED;
+    }
+
+    if (log_rec->del_idx != SST_OBJ_TABLE_LOG_NO_IDX) {
+        sst_table_clear_entry(&obj_table->obj_db[log_rec->del_idx]);
+    }
+
+    if (log_rec->set_idx != SST_OBJ_TABLE_LOG_NO_IDX) {
+        (void)tfm_memcpy(&obj_table->obj_db[log_rec->set_idx], &log_rec->entry,
+                         SST_OBJECTS_TABLE_ENTRY_SIZE);
+    }
+
+    return PSA_PS_SUCCESS;
+}
+
+/**
+ * \brief Authenticates the change log records, if the change log is based on
+ *        the given object table, and applies them to that object table.
+ *
+ * \param[in]     table_idx  Table index in the init context
+ * \param[in,out] init_ctx   Pointer to the init object table context
+ *
+ * \return Returns PSA_PS_SUCCESS if the change log has been applied to the
+ *         object table. If the change log is not based on the object table, it
+ *         returns PSA_PS_ERROR_UID_NOT_FOUND. Otherwise, it returns error code
+ *         as specified in \ref psa_ps_status_t.
+ */
+static psa_ps_status_t sst_object_table_load_log(uint8_t table_idx,
+                                      struct sst_obj_table_init_ctx_t *init_ctx)
 {
+    struct sst_obj_table_t *p_table = init_ctx->p_table[table_idx];
+    struct sst_obj_table_log_rec_t log_rec;
     psa_ps_status_t err;
+    uint32_t base_id = 0;
+    uint32_t i;
+#ifdef SST_ENCRYPTION
+    uint8_t prev_tag[SST_TAG_LEN_BYTES];
 
-    /* Secure storage system key. Aligned to a 32-bit boundary so that crypto
-     * implementations can copy key material with 32-bit accesses.
-     */
-    __attribute__ ((aligned(4)))
-    static uint8_t sst_key[SST_KEY_LEN_BYTES];
+    (void)tfm_memcpy(prev_tag, p_table->crypto.ref.tag, SST_TAG_LEN_BYTES);
+#endif
 
-    err = sst_crypto_getkey(SST_KEY_LEN_BYTES, sst_key);
-    if (err != PSA_PS_SUCCESS) {
-        return err;
+    if (init_ctx->log_num_recs == 0) {
+        return PSA_PS_ERROR_UID_NOT_FOUND;
     }
 
-    err = sst_crypto_setkey(SST_KEY_LEN_BYTES, sst_key);
-    if (err != PSA_PS_SUCCESS) {
-        return err;
+    for (i = 0; i < init_ctx->log_num_recs; i++) {
+        err = sst_flash_fs_file_read(SST_OBJ_TABLE_LOG_FS_ID,
+                                     SST_OBJ_TABLE_LOG_REC_SIZE,
+                                     (i * SST_OBJ_TABLE_LOG_REC_SIZE),
+                                     (uint8_t *)&log_rec);
+        if (err != PSA_PS_SUCCESS) {
+            return PSA_PS_ERROR_OPERATION_FAILED;
+        }
+
+        if (i == 0) {
+            /* Check that the change log is based on the object table */
+#ifdef SST_ROLLBACK_PROTECTION
+            err = sst_object_table_nvc_authenticate_table(log_rec.base_id,
+                                                          p_table);
+            if (err != PSA_PS_SUCCESS) {
+                return PSA_PS_ERROR_UID_NOT_FOUND;
+            }
+#else
+            if (log_rec.base_id != p_table->swap_count) {
+                return PSA_PS_ERROR_UID_NOT_FOUND;
+            }
+#endif /* SST_ROLLBACK_PROTECTION */
+
+            base_id = log_rec.base_id;
+        } else if (log_rec.base_id != base_id) {
+            return PSA_PS_ERROR_OPERATION_FAILED;
+        }
+
+#ifdef SST_ENCRYPTION
+        err = sst_object_table_log_authenticate(prev_tag, &log_rec);
+        if (err != PSA_PS_SUCCESS) {
+            return err;
+        }
+
+        (void)tfm_memcpy(prev_tag, log_rec.crypto.ref.tag, SST_TAG_LEN_BYTES);
+#endif
+
+        err = sst_object_table_log_apply(p_table, &log_rec);
+        if (err != PSA_PS_SUCCESS) {
+            return err;
+        }
     }
 
-    return err;
+    init_ctx->log_table = table_idx;
+    init_ctx->log_base_id = base_id;
+#ifdef SST_ENCRYPTION
+    (void)tfm_memcpy(&init_ctx->log_crypto, &log_rec.crypto,
+                     sizeof(union sst_crypto_t));
+#endif
+#ifdef SST_ROLLBACK_PROTECTION
+    init_ctx->log_nvc = log_rec.nv_counter;
+#endif
+
+    return PSA_PS_SUCCESS;
 }
 
+#ifdef SST_ENCRYPTION
 #ifdef SST_ROLLBACK_PROTECTION
 /**
  * \brief Aligns all SST non-volatile counters.
@@ -380,33 +695,42 @@ __STATIC_INLINE psa_ps_status_t sst_object_table_nvc_generate_auth_tag(
 static void sst_object_table_authenticate(uint8_t table_idx,
                                       struct sst_obj_table_init_ctx_t *init_ctx)
 {
-    struct sst_crypto_assoc_data_t assoc_data;
-    union sst_crypto_t *crypto = &init_ctx->p_table[table_idx]->crypto;
+    struct sst_obj_table_t *p_table = init_ctx->p_table[table_idx];
     psa_ps_status_t err;
 
-    /* Init associated data with NVC 1 */
-    assoc_data.nv_counter = init_ctx->nvc_1;
-    (void)tfm_memcpy(assoc_data.obj_table_data,
-                     SST_CRYPTO_ASSOCIATED_DATA(crypto),
-                     SST_OBJ_TABLE_AUTH_DATA_SIZE);
-
-    err = sst_crypto_authenticate(crypto, (const uint8_t *)&assoc_data,
-                                  SST_CRYPTO_ASSOCIATED_DATA_LEN);
+    /* Check with NVC 1 */
+    err = sst_object_table_nvc_authenticate_table(init_ctx->nvc_1, p_table);
     if (err == PSA_PS_SUCCESS) {
         init_ctx->table_state[table_idx] = SST_OBJ_TABLE_NVC_1_VALID;
         return;
     }
 
+    /* If the change log is based on the table, the last change log record
+     * holds the SST area version.
+     */
+    err = sst_object_table_load_log(table_idx, init_ctx);
+    if (err == PSA_PS_SUCCESS) {
+        if (init_ctx->log_nvc == init_ctx->nvc_1) {
+            init_ctx->table_state[table_idx] = SST_OBJ_TABLE_NVC_1_VALID;
+        } else if ((init_ctx->nvc_3 != SST_INVALID_NVC_VALUE)
+                   && (init_ctx->log_nvc == init_ctx->nvc_3)) {
+            init_ctx->table_state[table_idx] = SST_OBJ_TABLE_NVC_3_VALID;
+        } else {
+            init_ctx->table_state[table_idx] = SST_OBJ_TABLE_INVALID;
+        }
+        return;
+    } else if (err != PSA_PS_ERROR_UID_NOT_FOUND) {
+        init_ctx->table_state[table_idx] = SST_OBJ_TABLE_INVALID;
+        return;
+    }
+
     if (init_ctx->nvc_3 == SST_INVALID_NVC_VALUE) {
         init_ctx->table_state[table_idx] = SST_OBJ_TABLE_INVALID;
         return;
     }
 
     /* Check with NVC 3 */
-    assoc_data.nv_counter = init_ctx->nvc_3;
-
-    err = sst_crypto_authenticate(crypto, (const uint8_t *)&assoc_data,
-                                  SST_CRYPTO_ASSOCIATED_DATA_LEN);
+    err = sst_object_table_nvc_authenticate_table(init_ctx->nvc_3, p_table);
     if (err != PSA_PS_SUCCESS) {
         init_ctx->table_state[table_idx] = SST_OBJ_TABLE_INVALID;
     } else {
@@ -529,6 +853,33 @@ __STATIC_INLINE void sst_object_table_authenticate_ctx_tables(
 #endif /* SST_ROLLBACK_PROTECTION */
 #endif /* SST_ENCRYPTION */
 
+#ifndef SST_ROLLBACK_PROTECTION
+/**
+ * \brief Applies the change log to the object table which it is based on.
+ *
+ * \param[in,out] init_ctx  Pointer to the init object table context
+ *
+ */
+__attribute__ ((always_inline))
+__STATIC_INLINE void sst_object_table_load_ctx_log(
+                                      struct sst_obj_table_init_ctx_t *init_ctx)
+{
+    psa_ps_status_t err;
+    uint8_t i;
+
+    for (i = 0; i < SST_NUM_OBJ_TABLES; i++) {
+        if (init_ctx->table_state[i] == SST_OBJ_TABLE_INVALID) {
+            continue;
+        }
+
+        err = sst_object_table_load_log(i, init_ctx);
+        if (err != PSA_PS_SUCCESS && err != PSA_PS_ERROR_UID_NOT_FOUND) {
+            init_ctx->table_state[i] = SST_OBJ_TABLE_INVALID;
+        }
+    }
+}
+#endif /* SST_ROLLBACK_PROTECTION */
+
 /**
  * \brief Saves object table in the persistent memory.
  *
@@ -569,7 +920,7 @@ static psa_ps_status_t sst_object_table_save_table(
 
 #ifdef SST_ENCRYPTION
     /* Set object table key */
-    err = sst_object_table_set_crypto_key();
+    err = sst_crypto_loadkey();
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
@@ -589,26 +940,168 @@ static psa_ps_status_t sst_object_table_save_table(
         return err;
     }
 
-    err = sst_crypto_destroykey();
+    err = sst_crypto_unloadkey();
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
 #endif /* SST_ENCRYPTION */
 
     err = sst_object_table_fs_write_table(obj_table);
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+
+    /* The changes in the change log are part of the new object table, so the
+     * change log restarts from it.
+     */
+    sst_obj_table_ctx.log_num_recs = 0;
+#ifdef SST_ROLLBACK_PROTECTION
+    sst_obj_table_ctx.log_base_id = nvc_1;
+#else
+    sst_obj_table_ctx.log_base_id = obj_table->swap_count;
+#endif
+#ifdef SST_ENCRYPTION
+    (void)tfm_memcpy(sst_obj_table_ctx.log_tag, obj_table->crypto.ref.tag,
+                     SST_TAG_LEN_BYTES);
+#endif
+
+#ifdef SST_ROLLBACK_PROTECTION
+    /* Align SST NV counters to have the same value */
+    err = sst_object_table_align_nv_counters(nvc_1);
+#endif /* SST_ROLLBACK_PROTECTION */
+
+    return err;
+}
+
+/**
+ * \brief Appends a change of the object table to the change log in the
+ *        persistent memory.
+ *
+ * \param[in] set_idx  Index of the entry set by the change, or
+ *                     SST_OBJ_TABLE_LOG_NO_IDX
+ * \param[in] del_idx  Index of the entry deleted by the change, or
+ *                     SST_OBJ_TABLE_LOG_NO_IDX
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_log_append(uint32_t set_idx,
+                                                   uint32_t del_idx)
+{
+    psa_ps_status_t err;
+    struct sst_obj_table_log_rec_t log_rec;
+
+    (void)tfm_memset(&log_rec, SST_DEFAULT_EMPTY_BUFF_VAL,
+                     SST_OBJ_TABLE_LOG_REC_SIZE);
+
+    log_rec.base_id = sst_obj_table_ctx.log_base_id;
+    log_rec.del_idx = del_idx;
+    log_rec.set_idx = set_idx;
+
+    if (set_idx != SST_OBJ_TABLE_LOG_NO_IDX) {
+        (void)tfm_memcpy(&log_rec.entry,
+                         &sst_obj_table_ctx.obj_table.obj_db[set_idx],
+                         SST_OBJECTS_TABLE_ENTRY_SIZE);
+    }
 
 #ifdef SST_ROLLBACK_PROTECTION
+    err = sst_increment_nv_counter(TFM_SST_NV_COUNTER_1);
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+
+    err = sst_read_nv_counter(TFM_SST_NV_COUNTER_1, &log_rec.nv_counter);
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif /* SST_ROLLBACK_PROTECTION */
+
+#ifdef SST_ENCRYPTION
+    /* Set object table key */
+    err = sst_crypto_loadkey();
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
 
+    /* Generate authentication tag chained to the previous record */
+    err = sst_object_table_log_generate_auth_tag(sst_obj_table_ctx.log_tag,
+                                                 &log_rec);
+    if (err != PSA_PS_SUCCESS) {
+        (void)sst_crypto_destroykey();
+        return err;
+    }
+
+    err = sst_crypto_unloadkey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif /* SST_ENCRYPTION */
+
+    if (sst_obj_table_ctx.log_num_recs == 0) {
+        /* Remove the change log of a previous object table, if it has not
+         * been removed yet.
+         */
+        if (sst_flash_fs_file_exist(SST_OBJ_TABLE_LOG_FS_ID) ==
+                                                               PSA_PS_SUCCESS) {
+            err = sst_flash_fs_file_delete(SST_OBJ_TABLE_LOG_FS_ID);
+            if (err != PSA_PS_SUCCESS) {
+                return err;
+            }
+        }
+
+        err = sst_flash_fs_file_create(SST_OBJ_TABLE_LOG_FS_ID,
+                                       SST_OBJ_TABLE_LOG_SIZE,
+                                       SST_OBJ_TABLE_LOG_REC_SIZE,
+                                       (const uint8_t *)&log_rec);
+    } else {
+        err = sst_flash_fs_file_write(SST_OBJ_TABLE_LOG_FS_ID,
+                                      SST_OBJ_TABLE_LOG_REC_SIZE,
+                                      (sst_obj_table_ctx.log_num_recs *
+                                       SST_OBJ_TABLE_LOG_REC_SIZE),
+                                      (const uint8_t *)&log_rec);
+    }
+
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+
+    sst_obj_table_ctx.log_num_recs++;
+#ifdef SST_ENCRYPTION
+    (void)tfm_memcpy(sst_obj_table_ctx.log_tag, log_rec.crypto.ref.tag,
+                     SST_TAG_LEN_BYTES);
+#endif
+
+#ifdef SST_ROLLBACK_PROTECTION
     /* Align SST NV counters to have the same value */
-    err = sst_object_table_align_nv_counters(nvc_1);
+    err = sst_object_table_align_nv_counters(log_rec.nv_counter);
 #endif /* SST_ROLLBACK_PROTECTION */
 
     return err;
 }
 
+/**
+ * \brief Saves a change of the object table in the persistent memory.
+ *
+ * \details The change is appended to the change log while it has free
+ *          records. Otherwise, the whole object table is saved, which
+ *          restarts the change log.
+ *
+ * \param[in] set_idx  Index of the entry set by the change, or
+ *                     SST_OBJ_TABLE_LOG_NO_IDX
+ * \param[in] del_idx  Index of the entry deleted by the change, or
+ *                     SST_OBJ_TABLE_LOG_NO_IDX
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_save_change(uint32_t set_idx,
+                                                    uint32_t del_idx)
+{
+    if (sst_obj_table_ctx.log_num_recs < SST_OBJ_TABLE_LOG_ENTRIES) {
+        return sst_object_table_log_append(set_idx, del_idx);
+    }
+
+    return sst_object_table_save_table(&sst_obj_table_ctx.obj_table);
+}
+
 /**
  * \brief Checks the validity of the table version.
  *
@@ -746,6 +1239,116 @@ static psa_ps_status_t sst_set_active_object_table(
     return PSA_PS_SUCCESS;
 }
 
+/**
+ * \brief Gets the home slot in the hash index for the given object UID and
+ *        client ID.
+ *
+ * \param[in] uid        Object UID
+ * \param[in] client_id  Client UID
+ *
+ * \return Returns hash index slot
+ */
+static uint32_t sst_table_hash(psa_ps_uid_t uid, int32_t client_id)
+{
+    uint32_t hash;
+
+    hash = (uint32_t)uid ^ (uint32_t)(uid >> 32);
+    hash ^= (uint32_t)client_id * 0x9E3779B1U;
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6BU;
+    hash ^= hash >> 13;
+
+    return hash % SST_OBJ_TABLE_HASH_SIZE;
+}
+
+/**
+ * \brief Adds a table entry to the hash index.
+ *
+ * \param[in] idx  Entry index
+ *
+ */
+static void sst_table_index_entry(uint32_t idx)
+{
+    struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
+    uint32_t slot = sst_table_hash(p_table->obj_db[idx].uid,
+                                   p_table->obj_db[idx].client_id);
+
+    /* The hash index has more slots than entries, so there is always an empty
+     * slot in the probe sequence.
+     */
+    while (sst_obj_table_ctx.hash_idx[slot] != SST_OBJ_TABLE_HASH_EMPTY) {
+        slot = (slot + 1) % SST_OBJ_TABLE_HASH_SIZE;
+    }
+
+    sst_obj_table_ctx.hash_idx[slot] = (uint8_t)(idx + 1);
+}
+
+/**
+ * \brief Removes a table entry from the hash index.
+ *
+ * \param[in] idx  Entry index
+ *
+ */
+static void sst_table_unindex_entry(uint32_t idx)
+{
+    uint8_t *hash_idx = sst_obj_table_ctx.hash_idx;
+    struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
+    struct sst_obj_table_entry_t *entry;
+    uint32_t slot = sst_table_hash(p_table->obj_db[idx].uid,
+                                   p_table->obj_db[idx].client_id);
+    uint32_t next;
+    uint32_t home;
+
+    while (hash_idx[slot] != (uint8_t)(idx + 1)) {
+        if (hash_idx[slot] == SST_OBJ_TABLE_HASH_EMPTY) {
+            return;
+        }
+        slot = (slot + 1) % SST_OBJ_TABLE_HASH_SIZE;
+    }
+
+    /* Shift back the following slots of the probe sequence, so that lookups
+     * do not stop at the removed slot.
+     */
+    next = slot;
+    for (;;) {
+        next = (next + 1) % SST_OBJ_TABLE_HASH_SIZE;
+        if (hash_idx[next] == SST_OBJ_TABLE_HASH_EMPTY) {
+            break;
+        }
+
+        entry = &p_table->obj_db[hash_idx[next] - 1];
+        home = sst_table_hash(entry->uid, entry->client_id);
+
+        /* The slot stays if its home slot is cyclically in (slot, next] */
+        if ((slot < next) ? ((home > slot) && (home <= next))
+                          : ((home > slot) || (home <= next))) {
+            continue;
+        }
+
+        hash_idx[slot] = hash_idx[next];
+        slot = next;
+    }
+
+    hash_idx[slot] = SST_OBJ_TABLE_HASH_EMPTY;
+}
+
+/**
+ * \brief Builds the hash index of the table entries.
+ */
+static void sst_table_build_index(void)
+{
+    uint32_t i;
+
+    (void)tfm_memset(sst_obj_table_ctx.hash_idx, SST_OBJ_TABLE_HASH_EMPTY,
+                     SST_OBJ_TABLE_HASH_SIZE);
+
+    for (i = 0; i < SST_OBJ_TABLE_ENTRIES; i++) {
+        if (sst_obj_table_ctx.obj_table.obj_db[i].uid != TFM_SST_INVALID_UID) {
+            sst_table_index_entry(i);
+        }
+    }
+}
+
 /**
  * \brief Gets table's entry index based on the given object UID and client ID.
  *
@@ -760,15 +1363,18 @@ static psa_ps_status_t sst_get_object_entry_idx(psa_ps_uid_t uid,
                                                 int32_t client_id,
                                                 uint32_t *idx)
 {
+    uint32_t slot = sst_table_hash(uid, client_id);
     uint32_t i;
     struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
 
-    for (i = 0; i < SST_OBJ_TABLE_ENTRIES; i++) {
+    while (sst_obj_table_ctx.hash_idx[slot] != SST_OBJ_TABLE_HASH_EMPTY) {
+        i = sst_obj_table_ctx.hash_idx[slot] - 1;
         if (p_table->obj_db[i].uid == uid
             && p_table->obj_db[i].client_id == client_id) {
             *idx = i;
             return PSA_PS_SUCCESS;
         }
+        slot = (slot + 1) % SST_OBJ_TABLE_HASH_SIZE;
     }
 
     return PSA_PS_ERROR_UID_NOT_FOUND;
@@ -823,17 +1429,8 @@ __STATIC_INLINE psa_ps_status_t sst_table_free_idx(uint32_t idx_num,
  */
 static void sst_table_delete_entry(uint32_t idx)
 {
-    struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
-
-    p_table->obj_db[idx].uid = TFM_SST_INVALID_UID;
-    p_table->obj_db[idx].client_id = 0;
-
-#ifdef SST_ENCRYPTION
-    (void)tfm_memset(p_table->obj_db[idx].tag, SST_DEFAULT_EMPTY_BUFF_VAL,
-                     SST_OBJECTS_TABLE_ENTRY_SIZE);
-#else
-    p_table->obj_db[idx].version = 0;
-#endif
+    sst_table_unindex_entry(idx);
+    sst_table_clear_entry(&sst_obj_table_ctx.obj_table.obj_db[idx]);
 }
 
 psa_ps_status_t sst_object_table_create(void)
@@ -862,6 +1459,8 @@ psa_ps_status_t sst_object_table_create(void)
 
     p_table->version = SST_OBJECT_SYSTEM_VERSION;
 
+    sst_table_build_index();
+
     /* Save object table contents */
     return sst_object_table_save_table(p_table);
 }
@@ -875,7 +1474,11 @@ psa_ps_status_t sst_object_table_init(uint8_t *obj_data)
 #ifdef SST_ROLLBACK_PROTECTION
         .nvc_1 = 0U,
         .nvc_3 = 0U,
+        .log_nvc = 0U,
 #endif /* SST_ROLLBACK_PROTECTION */
+        .log_num_recs = 0U,
+        .log_base_id = 0U,
+        .log_table = SST_NUM_OBJ_TABLES,
     };
 
     init_ctx.p_table[SST_OBJ_TABLE_IDX_1] = (struct sst_obj_table_t *)obj_data;
@@ -883,9 +1486,12 @@ psa_ps_status_t sst_object_table_init(uint8_t *obj_data)
     /* Read table from the file system */
     sst_object_table_fs_read_table(&init_ctx);
 
+    /* Read the change log size from the file system */
+    sst_object_table_fs_read_log_info(&init_ctx);
+
 #ifdef SST_ENCRYPTION
     /* Set object table key */
-    err = sst_object_table_set_crypto_key();
+    err = sst_crypto_loadkey();
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
@@ -906,12 +1512,18 @@ psa_ps_status_t sst_object_table_init(uint8_t *obj_data)
     }
 #else
     sst_object_table_authenticate_ctx_tables(&init_ctx);
+
+    /* Authenticate and apply the change log */
+    sst_object_table_load_ctx_log(&init_ctx);
 #endif /* SST_ROLLBACK_PROTECTION */
 
-    err = sst_crypto_destroykey();
+    err = sst_crypto_unloadkey();
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
+#else
+    /* Apply the change log */
+    sst_object_table_load_ctx_log(&init_ctx);
 #endif /* SST_ENCRYPTION */
 
     /* Check tables version */
@@ -930,16 +1542,63 @@ psa_ps_status_t sst_object_table_init(uint8_t *obj_data)
         return err;
     }
 
+    if (init_ctx.log_table == sst_obj_table_ctx.active_table) {
+        /* The change log has been applied to the active table, so new changes
+         * are appended to it.
+         */
+        sst_obj_table_ctx.log_num_recs = init_ctx.log_num_recs;
+        sst_obj_table_ctx.log_base_id = init_ctx.log_base_id;
+#ifdef SST_ENCRYPTION
+        (void)tfm_memcpy(sst_obj_table_ctx.log_tag,
+                         init_ctx.log_crypto.ref.tag, SST_TAG_LEN_BYTES);
+#endif
+    } else {
+        sst_obj_table_ctx.log_num_recs = 0;
 #ifdef SST_ROLLBACK_PROTECTION
-    /* Align SST NV counters */
-    err = sst_object_table_align_nv_counters(init_ctx.nvc_1);
-    if (err != PSA_PS_SUCCESS) {
-        return err;
+        if (init_ctx.table_state[sst_obj_table_ctx.active_table] ==
+                                                    SST_OBJ_TABLE_NVC_3_VALID) {
+            sst_obj_table_ctx.log_base_id = init_ctx.nvc_3;
+        } else {
+            sst_obj_table_ctx.log_base_id = init_ctx.nvc_1;
+        }
+#else
+        sst_obj_table_ctx.log_base_id = sst_obj_table_ctx.obj_table.swap_count;
+#endif /* SST_ROLLBACK_PROTECTION */
+#ifdef SST_ENCRYPTION
+        (void)tfm_memcpy(sst_obj_table_ctx.log_tag,
+                         sst_obj_table_ctx.obj_table.crypto.ref.tag,
+                         SST_TAG_LEN_BYTES);
+#endif
+
+        /* Remove the change log of the old object table */
+        err = sst_flash_fs_file_delete(SST_OBJ_TABLE_LOG_FS_ID);
+        if (err != PSA_PS_SUCCESS && err != PSA_PS_ERROR_UID_NOT_FOUND) {
+            return err;
+        }
+    }
+
+    sst_table_build_index();
+
+#ifdef SST_ROLLBACK_PROTECTION
+    /* Align SST NV counters. If the active table has been validated with
+     * NVC 3, the counters are aligned by the next change, as the table would
+     * not be valid anymore at the next init.
+     */
+    if (init_ctx.table_state[sst_obj_table_ctx.active_table] ==
+                                                    SST_OBJ_TABLE_NVC_1_VALID) {
+        err = sst_object_table_align_nv_counters(init_ctx.nvc_1);
+        if (err != PSA_PS_SUCCESS) {
+            return err;
+        }
     }
 #endif /* SST_ROLLBACK_PROTECTION */
 
 #ifdef SST_ENCRYPTION
-    sst_crypto_set_iv(&sst_obj_table_ctx.obj_table.crypto);
+    if (init_ctx.log_table == sst_obj_table_ctx.active_table) {
+        sst_crypto_set_iv(&init_ctx.log_crypto);
+    } else {
+        sst_crypto_set_iv(&sst_obj_table_ctx.obj_table.crypto);
+    }
 #endif
 
     return PSA_PS_SUCCESS;
@@ -994,7 +1653,7 @@ psa_ps_status_t sst_object_table_set_obj_tbl_info(psa_ps_uid_t uid,
 {
     psa_ps_status_t err;
     uint32_t idx = 0;
-    uint32_t backup_idx = 0;
+    uint32_t backup_idx = SST_OBJ_TABLE_LOG_NO_IDX;
     struct sst_obj_table_entry_t backup_entry = {
 #ifdef SST_ENCRYPTION
         .tag = {0U},
@@ -1016,6 +1675,8 @@ psa_ps_status_t sst_object_table_set_obj_tbl_info(psa_ps_uid_t uid,
 
         /* Deletes old object information if it exist in the table */
         sst_table_delete_entry(backup_idx);
+    } else {
+        backup_idx = SST_OBJ_TABLE_LOG_NO_IDX;
     }
 
     idx = SST_OBJECT_FS_ID_TO_IDX(obj_tbl_info->fid);
@@ -1030,15 +1691,18 @@ psa_ps_status_t sst_object_table_set_obj_tbl_info(psa_ps_uid_t uid,
     p_table->obj_db[idx].version = obj_tbl_info->version;
 #endif
 
-    err = sst_object_table_save_table(p_table);
+    sst_table_index_entry(idx);
+
+    err = sst_object_table_save_change(idx, backup_idx);
     if (err != PSA_PS_SUCCESS) {
+        sst_table_delete_entry(idx);
+
         if (backup_entry.uid != TFM_SST_INVALID_UID) {
             /* Rollback the change in the table */
             (void)tfm_memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                              SST_OBJECTS_TABLE_ENTRY_SIZE);
+            sst_table_index_entry(backup_idx);
         }
-
-        sst_table_delete_entry(idx);
     }
 
     return err;
@@ -1095,11 +1759,12 @@ psa_ps_status_t sst_object_table_delete_object(psa_ps_uid_t uid,
 
     sst_table_delete_entry(backup_idx);
 
-    err = sst_object_table_save_table(p_table);
+    err = sst_object_table_save_change(SST_OBJ_TABLE_LOG_NO_IDX, backup_idx);
     if (err != PSA_PS_SUCCESS) {
        /* Rollback the change in the table */
        (void)tfm_memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                         SST_OBJECTS_TABLE_ENTRY_SIZE);
+       sst_table_index_entry(backup_idx);
     }
 
     return err;
@@ -1107,7 +1772,24 @@ psa_ps_status_t sst_object_table_delete_object(psa_ps_uid_t uid,
 
 psa_ps_status_t sst_object_table_delete_old_table(void)
 {
+    psa_ps_status_t err;
     uint32_t table_id = SST_TABLE_FS_ID(sst_obj_table_ctx.scratch_table);
 
-    return sst_flash_fs_file_delete(table_id);
+    /* There is no old table when the change has been appended to the change
+     * log.
+     */
+    err = sst_flash_fs_file_delete(table_id);
+    if (err != PSA_PS_SUCCESS && err != PSA_PS_ERROR_UID_NOT_FOUND) {
+        return err;
+    }
+
+    if (sst_obj_table_ctx.log_num_recs == 0) {
+        /* Remove the change log of the old object table */
+        err = sst_flash_fs_file_delete(SST_OBJ_TABLE_LOG_FS_ID);
+        if (err != PSA_PS_SUCCESS && err != PSA_PS_ERROR_UID_NOT_FOUND) {
+            return err;
+        }
+    }
+
+    return PSA_PS_SUCCESS;
 }
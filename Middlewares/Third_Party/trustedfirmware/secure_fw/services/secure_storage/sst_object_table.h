@@ -125,7 +125,9 @@ psa_ps_status_t sst_object_table_delete_object(psa_ps_uid_t uid,
                                                int32_t client_id);
 
 /**
- * \brief Deletes old object table from the persistent area.
+ * \brief Deletes old object table from the persistent area. The change log
+ *        of the old object table is deleted as well, if the last change has
+ *        restarted it.
  *
  * \return Returns error code as specified in \ref psa_ps_status_t
  */
@@ -19,6 +19,7 @@
 #include "test/suites/invert/non_secure/invert_ns_tests.h"
 #include "test/suites/core/non_secure/core_ns_tests.h"
 #include "test/suites/ipc/non_secure/ipc_ns_tests.h"
+#include "test/suites/benchmark/non_secure/benchmark_ns_tests.h"
 
 static struct test_suite_t test_suites[] = {
 #ifdef SERVICES_TEST_NS
@@ -55,6 +56,11 @@ static struct test_suite_t test_suites[] = {
     /* Note: since this is sample code, only run if test services are enabled */
     {&register_testsuite_ns_invert_interface, 0, 0, 0},
 #endif
+
+#ifdef ENABLE_BENCHMARK_TESTS
+    /* Non-secure benchmark test cases */
+    {&register_testsuite_ns_benchmark, 0, 0, 0},
+#endif
 #endif /* SERVICES_TEST_NS */
 
 #ifdef CORE_TEST_POSITIVE
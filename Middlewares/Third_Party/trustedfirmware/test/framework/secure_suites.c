@@ -17,6 +17,7 @@
 #include "test/suites/invert/secure/invert_s_tests.h"
 #include "test/suites/crypto/secure/crypto_s_tests.h"
 #include "test/suites/ipc/secure/ipc_s_tests.h"
+#include "test/suites/benchmark/secure/benchmark_s_tests.h"
 
 static struct test_suite_t test_suites[] = {
 #ifdef SERVICES_TEST_S
@@ -61,6 +62,11 @@ static struct test_suite_t test_suites[] = {
     /* Secure IPC test cases */
     {&register_testsuite_s_ipc_interface, 0, 0, 0},
 #endif
+
+#ifdef ENABLE_BENCHMARK_TESTS
+    /* Secure benchmark test cases */
+    {&register_testsuite_s_benchmark, 0, 0, 0},
+#endif
 #endif /* SERVICES_TEST_S */
     /* End of test suites */
     {0, 0, 0, 0}
@@ -0,0 +1,19 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __CMSIS_H__
+#define __CMSIS_H__
+
+/* Host replacement of the platform CMSIS header: no core registers */
+
+#include <stdint.h>
+#include "cmsis_compiler.h"
+
+/* Interrupt numbers, as used by the SVC handlers of the IPC model */
+typedef int32_t IRQn_Type;
+
+#endif /* __CMSIS_H__ */
@@ -0,0 +1,27 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __CMSIS_COMPILER_H__
+#define __CMSIS_COMPILER_H__
+
+/* Host replacement of the CMSIS compiler abstraction used by the services */
+
+#include <stdint.h>
+
+#define __STATIC_INLINE static inline
+
+/* Count leading zeros, returning 32 for zero as the CLZ instruction does */
+__STATIC_INLINE uint8_t __CLZ(uint32_t value)
+{
+    return (value == 0U) ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+#ifndef __PACKED
+#define __PACKED __attribute__((packed))
+#endif
+
+#endif /* __CMSIS_COMPILER_H__ */
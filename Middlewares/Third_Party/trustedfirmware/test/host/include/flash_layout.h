@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __FLASH_LAYOUT_H__
+#define __FLASH_LAYOUT_H__
+
+/*
+ * Host flash layout. The storage areas have the same geometry as on the
+ * STM32L562E-DK so that the services behave as on the board, but they are
+ * emulated in RAM (ITS_RAM_FS and SST_RAM_FS) and never touch a flash driver.
+ * The SST power cut test is the exception: it stores the SST area through
+ * its own RAM flash driver, TFM_Driver_FLASH0.
+ */
+#define FLASH_AREA_IMAGE_SECTOR_SIZE    (0x1000)     /* 4 KB */
+
+#define FLASH_SST_AREA_OFFSET           (0x0)
+#define FLASH_SST_AREA_SIZE             (0x2000)     /* 8 KB */
+#define FLASH_ITS_AREA_OFFSET           (FLASH_SST_AREA_OFFSET + \
+                                         FLASH_SST_AREA_SIZE)
+#define FLASH_ITS_AREA_SIZE             (0x2000)     /* 8 KB */
+
+/* Secure Storage (SST) Service definitions */
+#define SST_FLASH_DEV_NAME              TFM_Driver_FLASH0
+#define SST_FLASH_AREA_ADDR             FLASH_SST_AREA_OFFSET
+#define SST_SECTOR_SIZE                 FLASH_AREA_IMAGE_SECTOR_SIZE
+#define SST_NBR_OF_SECTORS              (FLASH_SST_AREA_SIZE / SST_SECTOR_SIZE)
+#define SST_FLASH_PROGRAM_UNIT          (0x8)
+#define SST_MAX_ASSET_SIZE              (512)
+#define SST_NUM_ASSETS                  (10)
+
+/* Internal Trusted Storage (ITS) Service definitions */
+#define ITS_FLASH_DEV_NAME              TFM_Driver_FLASH0
+#define ITS_FLASH_AREA_ADDR             FLASH_ITS_AREA_OFFSET
+#define ITS_SECTOR_SIZE                 FLASH_AREA_IMAGE_SECTOR_SIZE
+#define ITS_NBR_OF_SECTORS              (FLASH_ITS_AREA_SIZE / ITS_SECTOR_SIZE)
+#define ITS_FLASH_PROGRAM_UNIT          (0x8)
+#define ITS_MAX_ASSET_SIZE              (512)
+#define ITS_NUM_ASSETS                  (10)
+
+#endif /* __FLASH_LAYOUT_H__ */
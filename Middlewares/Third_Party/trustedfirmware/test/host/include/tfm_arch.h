@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_ARCH_H__
+#define __TFM_ARCH_H__
+
+/*
+ * Host replacement of secure_fw/core/arch/include/tfm_arch.h for the thread
+ * scheduler tests. The contexts keep their Armv8-M Mainline layout, but they
+ * are only ever copied around: no thread is run on the host.
+ */
+
+#include <inttypes.h>
+#include "cmsis_compiler.h"
+
+#define XPSR_T32            0x01000000
+
+/* General core state context */
+struct tfm_state_context_t {
+    uint32_t    r0;
+    uint32_t    r1;
+    uint32_t    r2;
+    uint32_t    r3;
+    uint32_t    r12;
+    uint32_t    lr;
+    uint32_t    ra;
+    uint32_t    xpsr;
+};
+
+struct tfm_state_context_ext {
+    uint32_t    r4;
+    uint32_t    r5;
+    uint32_t    r6;
+    uint32_t    r7;
+    uint32_t    r8;
+    uint32_t    r9;
+    uint32_t    r10;
+    uint32_t    r11;
+    uint32_t    sp;
+    uint32_t    sp_limit;
+    uint32_t    dummy;
+    uint32_t    lr;
+};
+
+/* Never dereferenced on the host, where sp is a truncated pointer */
+#define TFM_STATE_1ST_ARG(ctx)     \
+          (((struct tfm_state_context_t *)(uintptr_t)(ctx)->ctxb.sp)->r0)
+#define TFM_STATE_RET_VAL(ctx)     \
+          (((struct tfm_state_context_t *)(uintptr_t)(ctx)->ctxb.sp)->r0)
+
+/* Scheduling requests are counted instead of pending PendSV */
+extern uint32_t tfm_host_pendsv_count;
+
+__STATIC_INLINE void tfm_arch_trigger_pendsv(void)
+{
+    tfm_host_pendsv_count++;
+}
+
+void tfm_arch_initialize_ctx_ext(struct tfm_state_context_ext *p_ctxb,
+                                 uint32_t sp, uint32_t sp_limit);
+
+#endif /* __TFM_ARCH_H__ */
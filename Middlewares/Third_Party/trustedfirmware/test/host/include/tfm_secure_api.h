@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_SECURE_API_H__
+#define __TFM_SECURE_API_H__
+
+/*
+ * Host replacement of secure_fw/core/include/tfm_secure_api.h. It is found
+ * before the real header by the host build, so that the secure services and
+ * the generated veneers compile unchanged while their requests are dispatched
+ * by the direct-call stand-in of tfm_host_spm.c instead of the SPM.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cmsis_compiler.h"
+#include "tfm_api.h"
+#include "psa/client.h"
+#include "bl2/include/tfm_boot_status.h"
+
+#define __tfm_secure_gateway_attributes__
+
+#define TFM_ERROR_STATUS(status) (status)
+
+enum tfm_memory_access_e {
+    TFM_MEMORY_ACCESS_RO = 1,
+    TFM_MEMORY_ACCESS_RW = 2,
+};
+
+extern int32_t tfm_core_validate_secure_caller(void);
+
+extern int32_t tfm_core_get_caller_client_id(int32_t *caller_client_id);
+
+extern int32_t tfm_core_memory_permission_check(const void *ptr,
+                                                uint32_t size,
+                                                int32_t access);
+
+extern int32_t tfm_core_get_boot_data(uint8_t major_type,
+                                      struct tfm_boot_data *boot_data,
+                                      uint32_t len);
+
+/**
+ * \brief Calls a secure function of a partition directly, tracking the
+ *        partition as the running one for the duration of the call.
+ *
+ * \param[in] sp_id     Partition ID of the secure function
+ * \param[in] sfn       Secure function, with the iovec signature
+ * \param[in] in_vec    Input vectors
+ * \param[in] in_len    Number of input vectors
+ * \param[in] out_vec   Output vectors
+ * \param[in] out_len   Number of output vectors
+ *
+ * \return Returns the value returned by the secure function
+ */
+int32_t tfm_host_sfn_request(uint32_t sp_id, void *sfn,
+                             psa_invec *in_vec, size_t in_len,
+                             psa_outvec *out_vec, size_t out_len);
+
+#define TFM_CORE_IOVEC_SFN_REQUEST(id, fn, a, b, c, d) \
+        return tfm_host_sfn_request(id, fn, a, b, c, d)
+
+#endif /* __TFM_SECURE_API_H__ */
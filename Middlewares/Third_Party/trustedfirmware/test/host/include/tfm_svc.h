@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_HOST_SVC_H__
+#define __TFM_HOST_SVC_H__
+
+/*
+ * Host replacement of secure_fw/core/include/tfm_svc.h. The SVC numbers are
+ * taken from the real header, but an SVC is a call to tfm_host_svc().
+ */
+
+#include "secure_fw/core/include/tfm_svc.h"
+
+#undef SVC
+#define SVC(code) tfm_host_svc(code)
+
+void tfm_host_svc(tfm_svc_number_t code);
+
+#endif /* __TFM_HOST_SVC_H__ */
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_HOST_H__
+#define __TFM_HOST_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Partition ID the host test runner calls the services from. It is the
+ *        ID the secure test partition has on the target.
+ */
+#define TFM_HOST_TEST_PARTITION_ID (TFM_SP_BASE + 8)
+
+/**
+ * \brief Partition initialisation function, as called by the SPM
+ */
+typedef int32_t (*tfm_host_init_t)(void);
+
+/**
+ * \brief Runs the initialisation function of a partition in the context of
+ *        that partition.
+ *
+ * \param[in] sp_id  Partition ID
+ * \param[in] init   Initialisation function of the partition
+ *
+ * \return Returns the value returned by the initialisation function
+ */
+int32_t tfm_host_partition_init(uint32_t sp_id, tfm_host_init_t init);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFM_HOST_H__ */
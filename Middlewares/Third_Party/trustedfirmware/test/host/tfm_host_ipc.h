@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_HOST_IPC_H__
+#define __TFM_HOST_IPC_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "psa/client.h"
+#include "psa/service.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Operation on a vector of the request message, called by
+ *        \ref tfm_host_ipc_panics
+ */
+typedef void (*tfm_host_ipc_op_t)(psa_handle_t msg_handle, uint32_t idx);
+
+/**
+ * \brief Fills the request message of the IPC stand-in with the client
+ *        vectors, as psa_call() does, and gets it as psa_get() does.
+ *
+ * \param[in]  in_vec   Client input vectors
+ * \param[in]  in_len   Number of client input vectors
+ * \param[in]  out_vec  Client output vectors
+ * \param[in]  out_len  Number of client output vectors
+ * \param[in]  psa_rot  Whether the service is in a PSA RoT partition
+ * \param[out] msg      Message as seen by the service
+ */
+void tfm_host_ipc_call(const psa_invec *in_vec, size_t in_len,
+                       const psa_outvec *out_vec, size_t out_len,
+                       bool psa_rot, psa_msg_t *msg);
+
+/**
+ * \brief Gets the number of bytes written to a client output vector, as
+ *        reported to the client by psa_reply().
+ *
+ * \param[in] outvec_idx  Index of the output vector
+ *
+ * \return Returns the number of bytes written
+ */
+size_t tfm_host_ipc_written(uint32_t outvec_idx);
+
+/**
+ * \brief Runs an operation on a vector of the request message and reports
+ *        if it is a fatal error of the service.
+ *
+ * \param[in] op   Operation to run
+ * \param[in] idx  Index of the vector
+ *
+ * \return Returns true if the operation has panicked
+ */
+bool tfm_host_ipc_panics(tfm_host_ipc_op_t op, uint32_t idx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFM_HOST_IPC_H__ */
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Stand-in of the IPC model SPM for the Secure Partition API. The SVC handlers
+ * of tfm_svcalls.c are included and called directly with the arguments the
+ * SVC would stack, on a single request message filled as psa_call() does.
+ * The SVC arguments are 32-bit, so the host build is not position independent
+ * and only static buffers are passed by address. The rest of the SPM is not
+ * linked, and the handlers which would need it are removed by the linker.
+ */
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "secure_fw/core/ipc/tfm_svcalls.c"
+#include "tfm_host_ipc.h"
+
+/* Handle of the request message */
+#define TFM_HOST_IPC_MSG_HANDLE ((psa_handle_t)0x1000)
+
+static struct spm_partition_static_data_t partition_data;
+static struct spm_partition_desc_t partition = {
+    .static_data = &partition_data,
+};
+static struct tfm_spm_service_t service = {
+    .partition = &partition,
+};
+static struct tfm_msg_body_t msg_body;
+
+/* Return point of a fatal error expected by the test */
+static jmp_buf *panic_jmp;
+
+/**
+ * \brief Gets an address as an SVC argument.
+ */
+static uint32_t tfm_host_ipc_arg(const void *ptr)
+{
+    if ((uintptr_t)ptr > UINT32_MAX) {
+        printf("Address %p does not fit in an SVC argument\r\n", ptr);
+        abort();
+    }
+
+    return (uint32_t)(uintptr_t)ptr;
+}
+
+void tfm_panic(void)
+{
+    if (panic_jmp == NULL) {
+        printf("Unexpected fatal error of the service\r\n");
+        abort();
+    }
+
+    longjmp(*panic_jmp, 1);
+}
+
+struct tfm_msg_body_t *tfm_spm_get_msg_from_handle(psa_handle_t msg_handle)
+{
+    return (msg_handle == TFM_HOST_IPC_MSG_HANDLE) ? &msg_body : NULL;
+}
+
+uint32_t tfm_spm_partition_get_privileged_mode(uint32_t partition_flags)
+{
+    if (partition_flags & SPM_PART_FLAG_PSA_ROT) {
+        return TFM_PARTITION_PRIVILEGED_MODE;
+    } else {
+        return TFM_PARTITION_UNPRIVILEGED_MODE;
+    }
+}
+
+int32_t tfm_memory_check(const void *buffer, size_t len, int32_t ns_caller,
+                         enum tfm_memory_access_e access,
+                         uint32_t privileged)
+{
+    (void)ns_caller;
+    (void)access;
+    (void)privileged;
+
+    /* There is no memory ownership on the host */
+    if ((buffer == NULL) && (len != 0)) {
+        return IPC_ERROR_BAD_PARAMETERS;
+    }
+
+    return IPC_SUCCESS;
+}
+
+void tfm_host_ipc_call(const psa_invec *in_vec, size_t in_len,
+                       const psa_outvec *out_vec, size_t out_len,
+                       bool psa_rot, psa_msg_t *msg)
+{
+    size_t i;
+
+    (void)tfm_core_util_memset(&msg_body, 0, sizeof(msg_body));
+    partition_data.partition_flags = psa_rot ? SPM_PART_FLAG_PSA_ROT : 0;
+
+    msg_body.service = &service;
+    msg_body.msg.type = PSA_IPC_CALL;
+    msg_body.msg.handle = TFM_HOST_IPC_MSG_HANDLE;
+    msg_body.msg.client_id = -1;
+
+    for (i = 0; i < in_len; i++) {
+        msg_body.msg.in_size[i] = in_vec[i].len;
+        msg_body.invec[i].base = in_vec[i].base;
+    }
+    for (i = 0; i < out_len; i++) {
+        msg_body.msg.out_size[i] = out_vec[i].len;
+        msg_body.outvec[i].base = out_vec[i].base;
+    }
+
+    *msg = msg_body.msg;
+}
+
+size_t tfm_host_ipc_written(uint32_t outvec_idx)
+{
+    return msg_body.outvec[outvec_idx].len;
+}
+
+bool tfm_host_ipc_panics(tfm_host_ipc_op_t op, uint32_t idx)
+{
+    jmp_buf jmp;
+
+    if (setjmp(jmp) != 0) {
+        panic_jmp = NULL;
+        return true;
+    }
+
+    panic_jmp = &jmp;
+    op(TFM_HOST_IPC_MSG_HANDLE, idx);
+    panic_jmp = NULL;
+
+    return false;
+}
+
+/* Secure Partition API, as implemented by psa_service.c with an SVC */
+
+size_t psa_read(psa_handle_t msg_handle, uint32_t invec_idx,
+                void *buffer, size_t num_bytes)
+{
+    uint32_t args[] = {(uint32_t)msg_handle, invec_idx,
+                       tfm_host_ipc_arg(buffer), (uint32_t)num_bytes};
+
+    return tfm_svcall_psa_read(args);
+}
+
+size_t psa_skip(psa_handle_t msg_handle, uint32_t invec_idx, size_t num_bytes)
+{
+    uint32_t args[] = {(uint32_t)msg_handle, invec_idx, (uint32_t)num_bytes};
+
+    return tfm_svcall_psa_skip(args);
+}
+
+void psa_write(psa_handle_t msg_handle, uint32_t outvec_idx,
+               const void *buffer, size_t num_bytes)
+{
+    uint32_t args[] = {(uint32_t)msg_handle, outvec_idx,
+                       tfm_host_ipc_arg(buffer), (uint32_t)num_bytes};
+
+    tfm_svcall_psa_write(args);
+}
+
+#ifdef TFM_MM_IOVEC
+const void *psa_map_invec(psa_handle_t msg_handle, uint32_t invec_idx)
+{
+    uint32_t args[] = {(uint32_t)msg_handle, invec_idx};
+
+    return tfm_svcall_psa_map_invec(args);
+}
+
+void psa_unmap_invec(psa_handle_t msg_handle, uint32_t invec_idx)
+{
+    uint32_t args[] = {(uint32_t)msg_handle, invec_idx};
+
+    tfm_svcall_psa_unmap_invec(args);
+}
+
+void *psa_map_outvec(psa_handle_t msg_handle, uint32_t outvec_idx)
+{
+    uint32_t args[] = {(uint32_t)msg_handle, outvec_idx};
+
+    return tfm_svcall_psa_map_outvec(args);
+}
+
+void psa_unmap_outvec(psa_handle_t msg_handle, uint32_t outvec_idx,
+                      size_t len)
+{
+    uint32_t args[] = {(uint32_t)msg_handle, outvec_idx, (uint32_t)len};
+
+    tfm_svcall_psa_unmap_outvec(args);
+}
+#endif /* TFM_MM_IOVEC */
@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+/*
+ * Tests and benchmark of the crypto partition requests in the IPC model. The
+ * dispatcher of crypto_init.c is included to reach its static functions, and
+ * the client vectors go through the SVC handlers of tfm_host_ipc_spm.c. The
+ * test is built once copying the client vectors and once mapping them
+ * (TFM_MM_IOVEC).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "secure_fw/services/crypto/crypto_init.c"
+#include "mbedtls/sha256.h"
+#include "tfm_host_ipc.h"
+#include "test/framework/test_framework.h"
+#include "test/framework/test_framework_integ_test_helper.h"
+
+/* Size of the data hashed by the tests */
+#define IPC_TEST_DATA_SIZE       4096
+
+/* Size of a SHA-256 digest */
+#define IPC_TEST_HASH_SIZE       32
+
+/* Requests timed by the benchmark, for each input size */
+#define IPC_BENCH_REQUESTS       2000
+
+/* Client buffers, with room to be passed at an unaligned address */
+static uint8_t test_data[IPC_TEST_DATA_SIZE + 4] __attribute__((aligned(4)));
+static uint8_t test_hash[IPC_TEST_HASH_SIZE + 4] __attribute__((aligned(4)));
+static uint8_t test_handle[sizeof(uint32_t) + 4] __attribute__((aligned(4)));
+
+/* Service buffers, passed by address to the SVC handlers */
+static struct tfm_crypto_pack_iovec service_iov;
+
+/**
+ * \brief Sends a request to the crypto partition, as the client API does,
+ *        and dispatches it as the partition does.
+ */
+static psa_status_t ipc_test_request(struct tfm_crypto_pack_iovec *iov,
+                                     const psa_invec *in, size_t in_len,
+                                     const psa_outvec *out, size_t out_len)
+{
+    psa_invec in_vec[PSA_MAX_IOVEC] = {
+        {.base = iov, .len = sizeof(struct tfm_crypto_pack_iovec)},
+    };
+    psa_msg_t msg;
+    uint32_t sfn_id;
+    psa_status_t status;
+    size_t i;
+
+    for (i = 0; i < in_len; i++) {
+        in_vec[i + 1] = in[i];
+    }
+
+    tfm_host_ipc_call(in_vec, in_len + 1, out, out_len, true, &msg);
+
+    status = tfm_crypto_parse_msg(&msg, &service_iov, &sfn_id);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    return tfm_crypto_call_sfn(&msg, &service_iov, sfn_id);
+}
+
+/**
+ * \brief Computes a SHA-256 digest with hash setup, update and finish
+ *        requests.
+ *
+ * \param[in]  input       Client input
+ * \param[in]  input_len   Length of the client input
+ * \param[out] handle_out  Client output of the operation handle
+ * \param[out] hash        Client output of the digest
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t ipc_test_hash(const uint8_t *input, size_t input_len,
+                                  uint8_t *handle_out, uint8_t *hash)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .sfn_id = TFM_CRYPTO_HASH_SETUP_SID,
+        .alg = PSA_ALG_SHA_256,
+    };
+    psa_invec in[] = {
+        {.base = input, .len = input_len},
+    };
+    psa_outvec out[] = {
+        {.base = handle_out, .len = sizeof(uint32_t)},
+        {.base = hash, .len = IPC_TEST_HASH_SIZE},
+    };
+    psa_status_t status;
+
+    status = ipc_test_request(&iov, NULL, 0, out, 1);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    iov.sfn_id = TFM_CRYPTO_HASH_UPDATE_SID;
+    (void)memcpy(&iov.op_handle, handle_out, sizeof(uint32_t));
+    status = ipc_test_request(&iov, in, 1, out, 1);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    iov.sfn_id = TFM_CRYPTO_HASH_FINISH_SID;
+    (void)memcpy(&iov.op_handle, handle_out, sizeof(uint32_t));
+    status = ipc_test_request(&iov, NULL, 0, out, 2);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (tfm_host_ipc_written(1) != IPC_TEST_HASH_SIZE) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    return PSA_SUCCESS;
+}
+
+static void ipc_test_fill_data(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(test_data); i++) {
+        test_data[i] = (uint8_t)(i * 7 + 1);
+    }
+}
+
+/* List of tests */
+static void tfm_ipc_test_1001(struct test_result_t *ret);
+static void tfm_ipc_test_1002(struct test_result_t *ret);
+static void tfm_ipc_test_1003(struct test_result_t *ret);
+#ifdef TFM_MM_IOVEC
+static void tfm_ipc_test_1004(struct test_result_t *ret);
+#endif
+static void tfm_ipc_test_1005(struct test_result_t *ret);
+
+static struct test_t ipc_tests[] = {
+    {&tfm_ipc_test_1001, "TFM_IPC_TEST_1001",
+     "Crypto requests with aligned client vectors", {0} },
+    {&tfm_ipc_test_1002, "TFM_IPC_TEST_1002",
+     "Crypto requests with unaligned client vectors", {0} },
+    {&tfm_ipc_test_1003, "TFM_IPC_TEST_1003",
+     "Crypto requests with overlapping client vectors", {0} },
+#ifdef TFM_MM_IOVEC
+    {&tfm_ipc_test_1004, "TFM_IPC_TEST_1004",
+     "Map and copy exclusion rules of the client vectors", {0} },
+#endif
+    {&tfm_ipc_test_1005, "TFM_IPC_TEST_1005",
+     "Crypto request throughput", {0} },
+};
+
+static void register_testsuite_host_ipc(struct test_suite_t *p_test_suite)
+{
+    uint32_t list_size = (sizeof(ipc_tests) / sizeof(ipc_tests[0]));
+
+    set_testsuite("IPC crypto host tests (TFM_IPC_TEST_1XXX)",
+                  ipc_tests, list_size, p_test_suite);
+}
+
+/**
+ * \brief Hashes the data with every client vector aligned.
+ */
+static void tfm_ipc_test_1001(struct test_result_t *ret)
+{
+    uint8_t ref_hash[IPC_TEST_HASH_SIZE];
+
+    ipc_test_fill_data();
+    (void)mbedtls_sha256_ret(test_data, IPC_TEST_DATA_SIZE, ref_hash, 0);
+
+    if (ipc_test_hash(test_data, IPC_TEST_DATA_SIZE, test_handle,
+                      test_hash) != PSA_SUCCESS) {
+        TEST_FAIL("Hash requests should succeed");
+        return;
+    }
+
+    if (memcmp(test_hash, ref_hash, IPC_TEST_HASH_SIZE) != 0) {
+        TEST_FAIL("Digest is not the expected one");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+/**
+ * \brief Hashes the data with every client vector unaligned. The operation
+ *        handle is accessed as a word by the service.
+ */
+static void tfm_ipc_test_1002(struct test_result_t *ret)
+{
+    uint8_t ref_hash[IPC_TEST_HASH_SIZE];
+
+    ipc_test_fill_data();
+    (void)mbedtls_sha256_ret(&test_data[1], IPC_TEST_DATA_SIZE, ref_hash, 0);
+
+    if (ipc_test_hash(&test_data[1], IPC_TEST_DATA_SIZE, &test_handle[1],
+                      &test_hash[3]) != PSA_SUCCESS) {
+        TEST_FAIL("Hash requests should succeed");
+        return;
+    }
+
+    if (memcmp(&test_hash[3], ref_hash, IPC_TEST_HASH_SIZE) != 0) {
+        TEST_FAIL("Digest is not the expected one");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+/**
+ * \brief Hashes the data with the operation handle output overlapping the
+ *        start of the input. The service writes the handle before it hashes
+ *        the input, which must not see that write.
+ */
+static void tfm_ipc_test_1003(struct test_result_t *ret)
+{
+    struct tfm_crypto_pack_iovec iov = {
+        .sfn_id = TFM_CRYPTO_HASH_SETUP_SID,
+        .alg = PSA_ALG_SHA_256,
+    };
+    psa_invec in[] = {
+        {.base = test_data, .len = IPC_TEST_DATA_SIZE},
+    };
+    psa_outvec out[] = {
+        {.base = test_data, .len = sizeof(uint32_t)},
+        {.base = test_hash, .len = IPC_TEST_HASH_SIZE},
+    };
+    uint8_t ref_hash[IPC_TEST_HASH_SIZE];
+    uint32_t handle;
+
+    if (ipc_test_request(&iov, NULL, 0, &out[0], 1) != PSA_SUCCESS) {
+        TEST_FAIL("Hash setup should succeed");
+        return;
+    }
+    (void)memcpy(&handle, test_data, sizeof(handle));
+
+    ipc_test_fill_data();
+    (void)mbedtls_sha256_ret(test_data, IPC_TEST_DATA_SIZE, ref_hash, 0);
+
+    iov.sfn_id = TFM_CRYPTO_HASH_UPDATE_SID;
+    iov.op_handle = handle;
+    if (ipc_test_request(&iov, in, 1, &out[0], 1) != PSA_SUCCESS) {
+        TEST_FAIL("Hash update should succeed");
+        return;
+    }
+
+    iov.sfn_id = TFM_CRYPTO_HASH_FINISH_SID;
+    out[0].base = test_handle;
+    if (ipc_test_request(&iov, NULL, 0, out, 2) != PSA_SUCCESS) {
+        TEST_FAIL("Hash finish should succeed");
+        return;
+    }
+
+    if (memcmp(test_hash, ref_hash, IPC_TEST_HASH_SIZE) != 0) {
+        TEST_FAIL("Digest should be the one of the input before the request");
+        return;
+    }
+
+    if (memcmp(test_data, &handle, sizeof(handle)) != 0) {
+        TEST_FAIL("Operation handle should be written to the client");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+#ifdef TFM_MM_IOVEC
+/* Buffer of the read and write operations */
+static uint8_t op_buf[4];
+/* Length passed to psa_unmap_outvec() by op_unmap_out() */
+static size_t op_unmap_len;
+/* Vector returned by the last map operation */
+static const void *op_map;
+
+static void op_read(psa_handle_t msg_handle, uint32_t idx)
+{
+    (void)psa_read(msg_handle, idx, op_buf, 1);
+}
+
+static void op_skip(psa_handle_t msg_handle, uint32_t idx)
+{
+    (void)psa_skip(msg_handle, idx, 1);
+}
+
+static void op_write(psa_handle_t msg_handle, uint32_t idx)
+{
+    psa_write(msg_handle, idx, op_buf, 1);
+}
+
+static void op_map_in(psa_handle_t msg_handle, uint32_t idx)
+{
+    op_map = psa_map_invec(msg_handle, idx);
+}
+
+static void op_unmap_in(psa_handle_t msg_handle, uint32_t idx)
+{
+    psa_unmap_invec(msg_handle, idx);
+}
+
+static void op_map_out(psa_handle_t msg_handle, uint32_t idx)
+{
+    op_map = psa_map_outvec(msg_handle, idx);
+}
+
+static void op_unmap_out(psa_handle_t msg_handle, uint32_t idx)
+{
+    psa_unmap_outvec(msg_handle, idx, op_unmap_len);
+}
+
+static void ipc_test_new_msg(bool psa_rot)
+{
+    psa_invec in[] = {
+        {.base = test_data, .len = 10},
+        {.base = NULL, .len = 0},
+    };
+    psa_outvec out[] = {
+        {.base = test_hash, .len = IPC_TEST_HASH_SIZE},
+    };
+    psa_msg_t msg;
+
+    tfm_host_ipc_call(in, 2, out, 1, psa_rot, &msg);
+}
+
+/**
+ * \brief Checks that a vector is either mapped or copied, and that only PSA
+ *        RoT partitions map vectors.
+ */
+static void tfm_ipc_test_1004(struct test_result_t *ret)
+{
+    ipc_test_new_msg(true);
+
+    if (tfm_host_ipc_panics(op_map_in, 0) || (op_map != test_data)) {
+        TEST_FAIL("Input vector should be mapped");
+        return;
+    }
+    if (!tfm_host_ipc_panics(op_map_in, 0) ||
+        !tfm_host_ipc_panics(op_read, 0) ||
+        !tfm_host_ipc_panics(op_skip, 0)) {
+        TEST_FAIL("Mapped input vector should not be mapped again or read");
+        return;
+    }
+    if (tfm_host_ipc_panics(op_map_in, 1) || (op_map != NULL)) {
+        TEST_FAIL("Empty input vector should be mapped as NULL");
+        return;
+    }
+    if (tfm_host_ipc_panics(op_unmap_in, 0) ||
+        !tfm_host_ipc_panics(op_unmap_in, 0) ||
+        !tfm_host_ipc_panics(op_unmap_in, 1)) {
+        TEST_FAIL("Only a mapped input vector should be unmapped, once");
+        return;
+    }
+
+    if (tfm_host_ipc_panics(op_map_out, 0) || (op_map != test_hash)) {
+        TEST_FAIL("Output vector should be mapped");
+        return;
+    }
+    if (!tfm_host_ipc_panics(op_write, 0)) {
+        TEST_FAIL("Mapped output vector should not be written");
+        return;
+    }
+    op_unmap_len = IPC_TEST_HASH_SIZE + 1;
+    if (!tfm_host_ipc_panics(op_unmap_out, 0)) {
+        TEST_FAIL("Unmapped length should fit in the output vector");
+        return;
+    }
+    op_unmap_len = 20;
+    if (tfm_host_ipc_panics(op_unmap_out, 0) ||
+        (tfm_host_ipc_written(0) != 20) ||
+        !tfm_host_ipc_panics(op_unmap_out, 0)) {
+        TEST_FAIL("Output vector should be unmapped once, with its length");
+        return;
+    }
+    if (!tfm_host_ipc_panics(op_map_in, PSA_MAX_IOVEC) ||
+        !tfm_host_ipc_panics(op_map_out, PSA_MAX_IOVEC)) {
+        TEST_FAIL("Vector index should be checked");
+        return;
+    }
+
+    ipc_test_new_msg(true);
+
+    if (tfm_host_ipc_panics(op_read, 0) ||
+        !tfm_host_ipc_panics(op_map_in, 0)) {
+        TEST_FAIL("Read input vector should not be mapped");
+        return;
+    }
+    op_unmap_len = 1;
+    if (tfm_host_ipc_panics(op_write, 0) ||
+        !tfm_host_ipc_panics(op_map_out, 0) ||
+        !tfm_host_ipc_panics(op_unmap_out, 0)) {
+        TEST_FAIL("Written output vector should not be mapped or unmapped");
+        return;
+    }
+
+    ipc_test_new_msg(false);
+
+    if (!tfm_host_ipc_panics(op_map_in, 0) ||
+        !tfm_host_ipc_panics(op_map_out, 0)) {
+        TEST_FAIL("Application RoT partition should not map vectors");
+        return;
+    }
+    if (tfm_host_ipc_panics(op_read, 0) || tfm_host_ipc_panics(op_write, 0) ||
+        (tfm_host_ipc_written(0) != 1)) {
+        TEST_FAIL("Application RoT partition should copy vectors");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+#endif /* TFM_MM_IOVEC */
+
+static uint64_t ipc_bench_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief Times hash update requests of small and large inputs, which are
+ *        dominated by the handling of the client vectors and by the hashing
+ *        respectively.
+ */
+static void tfm_ipc_test_1005(struct test_result_t *ret)
+{
+    static const size_t sizes[] = {64, IPC_TEST_DATA_SIZE};
+    struct tfm_crypto_pack_iovec iov = {
+        .sfn_id = TFM_CRYPTO_HASH_SETUP_SID,
+        .alg = PSA_ALG_SHA_256,
+    };
+    psa_invec in[] = {
+        {.base = test_data, .len = 0},
+    };
+    psa_outvec out[] = {
+        {.base = test_handle, .len = sizeof(uint32_t)},
+        {.base = test_hash, .len = IPC_TEST_HASH_SIZE},
+    };
+    uint64_t start, ns;
+    uint32_t i, n;
+
+    ipc_test_fill_data();
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        iov.sfn_id = TFM_CRYPTO_HASH_SETUP_SID;
+        iov.op_handle = TFM_CRYPTO_INVALID_HANDLE;
+        if (ipc_test_request(&iov, NULL, 0, out, 1) != PSA_SUCCESS) {
+            TEST_FAIL("Hash setup should succeed");
+            return;
+        }
+
+        iov.sfn_id = TFM_CRYPTO_HASH_UPDATE_SID;
+        (void)memcpy(&iov.op_handle, test_handle, sizeof(uint32_t));
+        in[0].len = sizes[i];
+
+        start = ipc_bench_ns();
+        for (n = 0; n < IPC_BENCH_REQUESTS; n++) {
+            if (ipc_test_request(&iov, in, 1, out, 1) != PSA_SUCCESS) {
+                TEST_FAIL("Hash update should succeed");
+                return;
+            }
+        }
+        ns = ipc_bench_ns() - start;
+
+        iov.sfn_id = TFM_CRYPTO_HASH_FINISH_SID;
+        if (ipc_test_request(&iov, NULL, 0, out, 2) != PSA_SUCCESS) {
+            TEST_FAIL("Hash finish should succeed");
+            return;
+        }
+
+        TEST_LOG("  SHA-256 update of %lu bytes (%s): %lu ns/request, "
+                 "%lu KB/s\r\n", (unsigned long)sizes[i],
+#ifdef TFM_MM_IOVEC
+                 "mapped",
+#else
+                 "copied",
+#endif
+                 (unsigned long)(ns / IPC_BENCH_REQUESTS),
+                 (unsigned long)(((uint64_t)sizes[i] * IPC_BENCH_REQUESTS *
+                                  1000000ULL) / (ns ? ns : 1)));
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+static struct test_suite_t test_suites[] = {
+    {&register_testsuite_host_ipc, 0, 0, 0},
+
+    /* End of test suites */
+    {0, 0, 0, 0}
+};
+
+int main(void)
+{
+    if ((tfm_crypto_module_init() != PSA_SUCCESS) ||
+        (tfm_crypto_engine_init() != PSA_SUCCESS)) {
+        printf("Crypto partition initialisation failed\r\n");
+        return 1;
+    }
+
+    integ_test("Host IPC", test_suites);
+
+    return (test_suites[0].val == TEST_PASSED) ? 0 : 1;
+}
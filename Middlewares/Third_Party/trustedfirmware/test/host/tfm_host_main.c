@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdio.h>
+#include "tfm_host.h"
+#include "secure_fw/spm/spm_partition_defs.h"
+#include "test/framework/test_framework.h"
+#include "test/framework/test_framework_integ_test_helper.h"
+
+/* Service specific includes */
+#include "test/suites/sst/secure/sst_tests.h"
+#include "test/suites/its/secure/its_s_tests.h"
+#include "test/suites/crypto/secure/crypto_s_tests.h"
+#include "test/suites/attestation/secure/attestation_s_tests.h"
+#include "test/suites/audit/secure/audit_s_tests.h"
+#include "test/suites/benchmark/secure/benchmark_s_tests.h"
+
+static struct test_suite_t test_suites[] = {
+    /* Secure SST test cases */
+    {&register_testsuite_s_psa_ps_interface, 0, 0, 0},
+    {&register_testsuite_s_psa_ps_reliability, 0, 0, 0},
+
+#ifdef SST_TEST_NV_COUNTERS
+    {&register_testsuite_s_rollback_protection, 0, 0, 0},
+#endif
+
+    /* Secure ITS test cases */
+    {&register_testsuite_s_psa_its_interface, 0, 0, 0},
+    {&register_testsuite_s_psa_its_reliability, 0, 0, 0},
+
+    /* Crypto test cases */
+    {&register_testsuite_s_crypto_interface, 0, 0, 0},
+
+    /* Secure initial attestation service test cases */
+    {&register_testsuite_s_attestation_interface, 0, 0, 0},
+
+    /* Secure Audit Logging test cases */
+    {&register_testsuite_s_audit_interface, 0, 0, 0},
+
+    /* Secure benchmark test cases */
+    {&register_testsuite_s_benchmark, 0, 0, 0},
+
+    /* End of test suites */
+    {0, 0, 0, 0}
+};
+
+/* Partition entry points, declared as in the SPM database */
+extern int32_t tfm_crypto_init(void);
+extern int32_t tfm_its_req_mngr_init(void);
+extern int32_t tfm_sst_req_mngr_init(void);
+extern int32_t attest_partition_init(void);
+extern int32_t audit_core_init(void);
+
+/* Partitions in the order their dependencies require */
+static const struct {
+    uint32_t sp_id;
+    tfm_host_init_t init;
+    const char *name;
+} partitions[] = {
+    {TFM_SP_CRYPTO_ID, tfm_crypto_init, "Crypto"},
+    {TFM_SP_ITS_ID, tfm_its_req_mngr_init, "ITS"},
+    {TFM_SP_STORAGE_ID, tfm_sst_req_mngr_init, "SST"},
+    {TFM_SP_INITIAL_ATTESTATION_ID, attest_partition_init, "Attestation"},
+    {TFM_SP_AUDIT_LOG_ID, audit_core_init, "Audit Logging"},
+};
+
+int main(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(partitions) / sizeof(partitions[0]); i++) {
+        if (tfm_host_partition_init(partitions[i].sp_id,
+                                    partitions[i].init) != 0) {
+            printf("%s partition failed to initialise\r\n",
+                   partitions[i].name);
+            return 1;
+        }
+    }
+
+    integ_test("Host", test_suites);
+
+    for (i = 0; test_suites[i].freg != NULL; i++) {
+        if (test_suites[i].val != TEST_PASSED) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "platform/include/tfm_plat_crypto_keys.h"
+#include "platform/include/tfm_plat_device_id.h"
+#include "platform/include/tfm_plat_boot_seed.h"
+#include "platform/include/tfm_attest_hal.h"
+#include "test/suites/benchmark/benchmark_tests_common.h"
+
+/*
+ * Host implementation of the platform services used by the partitions and of
+ * the benchmark timer.
+ */
+
+/* Fixed hardware unique key, so that runs are reproducible */
+#define TFM_HOST_HUK_BYTE (0x5A)
+
+/* Values of the attestation claims the token tests expect */
+static const uint8_t boot_seed[BOOT_SEED_SIZE] = {
+    0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+    0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+    0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7,
+    0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF
+};
+
+static const uint8_t implementation_id[] = {
+    0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA,
+    0xBB, 0xBB, 0xBB, 0xBB, 0xBB, 0xBB, 0xBB, 0xBB,
+    0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC, 0xCC,
+    0xDD, 0xDD, 0xDD, 0xDD, 0xDD, 0xDD, 0xDD, 0xDD
+};
+
+static const char hw_version[] = "060456527282910010";
+
+static const char verification_service_url[] = "www.trustedfirmware.org";
+
+static const char attestation_profile_definition[] = "PSA_IOT_PROFILE_1";
+
+/* Example key pair of platform/ext/common/tfm_initial_attestation_key.pem */
+extern const enum ecc_curve_t initial_attestation_curve_type;
+extern const uint8_t  initial_attestation_private_key[];
+extern const uint32_t initial_attestation_private_key_size;
+extern const uint8_t  initial_attestation_public_x_key[];
+extern const uint32_t initial_attestation_public_x_key_size;
+extern const uint8_t  initial_attestation_public_y_key[];
+extern const uint32_t initial_attestation_public_y_key_size;
+extern const uint8_t  initial_attestation_raw_public_key_hash[];
+extern const uint32_t initial_attestation_raw_public_key_hash_size;
+
+/* The host timer counts nanoseconds, which the reports call cycles */
+#define TFM_HOST_TIMER_FREQ (1000000000U)
+
+enum tfm_plat_err_t tfm_plat_get_crypto_huk(uint8_t *key, uint32_t size)
+{
+    memset(key, TFM_HOST_HUK_BYTE, size);
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_plat_err_t
+tfm_plat_get_initial_attest_key(uint8_t          *key_buf,
+                                uint32_t          size,
+                                struct ecc_key_t *ecc_key,
+                                enum ecc_curve_t *curve_type)
+{
+    uint32_t key_size = initial_attestation_private_key_size +
+                        initial_attestation_public_x_key_size +
+                        initial_attestation_public_y_key_size;
+
+    if (size < key_size) {
+        return TFM_PLAT_ERR_SYSTEM_ERR;
+    }
+
+    *curve_type = initial_attestation_curve_type;
+
+    ecc_key->priv_key = key_buf;
+    ecc_key->priv_key_size = initial_attestation_private_key_size;
+    memcpy(ecc_key->priv_key, initial_attestation_private_key,
+           ecc_key->priv_key_size);
+
+    ecc_key->pubx_key = ecc_key->priv_key + ecc_key->priv_key_size;
+    ecc_key->pubx_key_size = initial_attestation_public_x_key_size;
+    memcpy(ecc_key->pubx_key, initial_attestation_public_x_key,
+           ecc_key->pubx_key_size);
+
+    ecc_key->puby_key = ecc_key->pubx_key + ecc_key->pubx_key_size;
+    ecc_key->puby_key_size = initial_attestation_public_y_key_size;
+    memcpy(ecc_key->puby_key, initial_attestation_public_y_key,
+           ecc_key->puby_key_size);
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_plat_err_t tfm_plat_get_boot_seed(uint32_t size, uint8_t *buf)
+{
+    if (size != BOOT_SEED_SIZE) {
+        return TFM_PLAT_ERR_INVALID_INPUT;
+    }
+
+    memcpy(buf, boot_seed, size);
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_plat_err_t tfm_plat_get_instance_id(uint32_t *size, uint8_t *buf)
+{
+    /* UEID type byte followed by the hash of the public key */
+    if (*size < initial_attestation_raw_public_key_hash_size + 1) {
+        return TFM_PLAT_ERR_SYSTEM_ERR;
+    }
+
+    buf[0] = 0x01;
+    memcpy(&buf[1], initial_attestation_raw_public_key_hash,
+           initial_attestation_raw_public_key_hash_size);
+    *size = initial_attestation_raw_public_key_hash_size + 1;
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_plat_err_t tfm_plat_get_implementation_id(uint32_t *size,
+                                                   uint8_t  *buf)
+{
+    if (*size < sizeof(implementation_id)) {
+        return TFM_PLAT_ERR_SYSTEM_ERR;
+    }
+
+    memcpy(buf, implementation_id, sizeof(implementation_id));
+    *size = sizeof(implementation_id);
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_plat_err_t tfm_plat_get_hw_version(uint32_t *size, uint8_t *buf)
+{
+    /* Without the terminating zero */
+    if (*size < sizeof(hw_version) - 1) {
+        return TFM_PLAT_ERR_SYSTEM_ERR;
+    }
+
+    memcpy(buf, hw_version, sizeof(hw_version) - 1);
+    *size = sizeof(hw_version) - 1;
+
+    return TFM_PLAT_ERR_SUCCESS;
+}
+
+enum tfm_security_lifecycle_t tfm_attest_hal_get_security_lifecycle(void)
+{
+    return TFM_SLC_SECURED;
+}
+
+const char *
+tfm_attest_hal_get_verification_service(uint32_t *size)
+{
+    *size = sizeof(verification_service_url) - 1;
+
+    return verification_service_url;
+}
+
+const char *
+tfm_attest_hal_get_profile_definition(uint32_t *size)
+{
+    *size = sizeof(attestation_profile_definition) - 1;
+
+    return attestation_profile_definition;
+}
+
+int32_t bench_timer_init(void)
+{
+    return 0;
+}
+
+uint32_t bench_timer_read(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)((uint64_t)now.tv_sec * TFM_HOST_TIMER_FREQ +
+                      (uint64_t)now.tv_nsec);
+}
+
+uint32_t bench_timer_freq(void)
+{
+    return TFM_HOST_TIMER_FREQ;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "tfm_secure_api.h"
+#include "secure_fw/spm/spm_partition_defs.h"
+#include "tfm_host.h"
+
+/*
+ * Direct-call stand-in for the SPM. Secure functions are called on the
+ * caller's stack, without isolation. The iovec parameters are checked as the
+ * SPM does, except for memory ownership, and the only SPM state kept is the
+ * chain of running partitions, which is what the services observe through
+ * tfm_core_get_caller_client_id().
+ */
+
+/* Deepest chain of nested partition calls, e.g. test -> SST -> crypto */
+#define TFM_HOST_MAX_CALL_DEPTH (8)
+
+typedef psa_status_t (*tfm_host_sfn_t)(psa_invec *in_vec, size_t in_len,
+                                       psa_outvec *out_vec, size_t out_len);
+
+static uint32_t running_partition[TFM_HOST_MAX_CALL_DEPTH] = {
+    TFM_HOST_TEST_PARTITION_ID
+};
+static uint32_t call_depth;
+
+/* No partition owns a region of half the 32-bit address space on target, so
+ * the SPM rejects anything at least this large as a memory access violation.
+ */
+#define TFM_HOST_MAX_REGION_SIZE (0x80000000UL)
+
+/**
+ * \brief Checks the iovec parameters as the SPM does. The memory ownership
+ *        checks are reduced to rejecting regions too large to be owned.
+ */
+static enum tfm_status_e tfm_host_check_sfn_parameters(
+                                            const psa_invec *in_vec,
+                                            size_t in_len,
+                                            const psa_outvec *out_vec,
+                                            size_t out_len)
+{
+    uint32_t i;
+
+    if ((in_len > PSA_MAX_IOVEC) || (out_len > PSA_MAX_IOVEC) ||
+        (in_len + out_len > PSA_MAX_IOVEC)) {
+        return TFM_ERROR_INVALID_PARAMETER;
+    }
+
+    if ((in_len > 0) != (in_vec != NULL)) {
+        return TFM_ERROR_INVALID_PARAMETER;
+    }
+    if ((out_len > 0) != (out_vec != NULL)) {
+        return TFM_ERROR_INVALID_PARAMETER;
+    }
+
+    for (i = 0; i < in_len; ++i) {
+        if ((in_vec[i].len > 0) && ((in_vec[i].base == NULL) ||
+            (in_vec[i].len >= TFM_HOST_MAX_REGION_SIZE))) {
+            return TFM_ERROR_INVALID_PARAMETER;
+        }
+    }
+    for (i = 0; i < out_len; ++i) {
+        if ((out_vec[i].len > 0) && ((out_vec[i].base == NULL) ||
+            (out_vec[i].len >= TFM_HOST_MAX_REGION_SIZE))) {
+            return TFM_ERROR_INVALID_PARAMETER;
+        }
+    }
+
+    return TFM_SUCCESS;
+}
+
+int32_t tfm_host_sfn_request(uint32_t sp_id, void *sfn,
+                             psa_invec *in_vec, size_t in_len,
+                             psa_outvec *out_vec, size_t out_len)
+{
+    enum tfm_status_e res;
+    psa_status_t status;
+    uint32_t i;
+
+    res = tfm_host_check_sfn_parameters(in_vec, in_len, out_vec, out_len);
+    if (res != TFM_SUCCESS) {
+        return (int32_t)res;
+    }
+
+    /* The SPM does not allow a partition to be re-entered */
+    for (i = 0; i <= call_depth; i++) {
+        if (running_partition[i] == sp_id) {
+            return (int32_t)TFM_ERROR_PARTITION_NON_REENTRANT;
+        }
+    }
+
+    if (call_depth + 1 >= TFM_HOST_MAX_CALL_DEPTH) {
+        printf("Partition call chain too deep\r\n");
+        abort();
+    }
+
+    running_partition[++call_depth] = sp_id;
+    status = ((tfm_host_sfn_t)sfn)(in_vec, in_len, out_vec, out_len);
+    call_depth--;
+
+    return (int32_t)status;
+}
+
+int32_t tfm_host_partition_init(uint32_t sp_id, tfm_host_init_t init)
+{
+    int32_t ret;
+
+    running_partition[++call_depth] = sp_id;
+    ret = init();
+    call_depth--;
+
+    return ret;
+}
+
+int32_t tfm_core_get_caller_client_id(int32_t *caller_client_id)
+{
+    if (call_depth == 0) {
+        /* Not called from a secure function */
+        return (int32_t)TFM_ERROR_INVALID_PARAMETER;
+    }
+
+    /* Secure callers are identified by their partition ID */
+    *caller_client_id = (int32_t)running_partition[call_depth - 1];
+
+    return (int32_t)TFM_SUCCESS;
+}
+
+int32_t tfm_core_validate_secure_caller(void)
+{
+    return (call_depth > 0) ? (int32_t)TFM_SUCCESS
+                            : (int32_t)TFM_ERROR_INVALID_PARAMETER;
+}
+
+int32_t tfm_core_memory_permission_check(const void *ptr,
+                                         uint32_t size,
+                                         int32_t access)
+{
+    (void)ptr;
+    (void)size;
+    (void)access;
+
+    /* Everything is one address space on the host */
+    return (int32_t)TFM_SUCCESS;
+}
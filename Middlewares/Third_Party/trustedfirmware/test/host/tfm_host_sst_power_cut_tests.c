@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "tfm_host.h"
+#include "Driver_Flash.h"
+#include "flash_layout.h"
+#include "psa/protected_storage.h"
+#include "secure_fw/spm/spm_partition_defs.h"
+#include "secure_fw/services/secure_storage/sst_object_system.h"
+#include "test/framework/test_framework.h"
+#include "test/framework/test_framework_integ_test_helper.h"
+#include "test/suites/sst/secure/nv_counters/test_sst_nv_counters.h"
+
+/* Assets changed by the test, with UIDs 1 to PC_TEST_UIDS */
+#define PC_TEST_UIDS             5
+#define PC_TEST_MAX_SIZE         64
+
+/* Random changes, each one cut by a power failure or not */
+#define PC_TEST_STEPS            10000
+
+/* Flash operations before a power cut are drawn below this value, which is
+ * above the number of operations done by a change.
+ */
+#define PC_TEST_MAX_OPS          128
+
+/* Specifies that no power cut is scheduled */
+#define PC_TEST_NO_CUT           UINT32_MAX
+
+/*
+ * RAM stand-in of the SST flash device. Programming can only clear bits, as
+ * on a flash device, and a power cut is simulated at a given flash operation:
+ * that operation is either not done at all or torn (only its first half is
+ * done), and every later flash operation and NV counter increment fails until
+ * the power is restored.
+ */
+static uint8_t flash_mem[FLASH_SST_AREA_SIZE];
+static uint32_t flash_ops;
+static uint32_t flash_ops_left = PC_TEST_NO_CUT;
+static bool flash_cut_torn;
+static bool flash_power_off;
+
+static void pc_flash_power_cut(void)
+{
+    flash_power_off = true;
+    test_sst_disable_increment_nv_counter();
+}
+
+/* Returns the number of bytes of an operation done before the power is cut */
+static uint32_t pc_flash_op_size(uint32_t size)
+{
+    if (flash_power_off) {
+        return 0;
+    }
+
+    flash_ops++;
+
+    if (flash_ops_left == PC_TEST_NO_CUT) {
+        return size;
+    }
+
+    if (flash_ops_left != 0) {
+        flash_ops_left--;
+        return size;
+    }
+
+    pc_flash_power_cut();
+
+    return flash_cut_torn ? (size / 2) : 0;
+}
+
+static void pc_flash_power_on(void)
+{
+    flash_ops_left = PC_TEST_NO_CUT;
+    flash_power_off = false;
+    test_sst_enable_increment_nv_counter();
+}
+
+static int32_t pc_flash_initialize(ARM_Flash_SignalEvent_t cb_event)
+{
+    (void)cb_event;
+
+    return ARM_DRIVER_OK;
+}
+
+static int32_t pc_flash_read_data(uint32_t addr, void *data, uint32_t cnt)
+{
+    if ((addr > FLASH_SST_AREA_SIZE) || (cnt > FLASH_SST_AREA_SIZE - addr)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    (void)memcpy(data, &flash_mem[addr], cnt);
+
+    return ARM_DRIVER_OK;
+}
+
+static int32_t pc_flash_program_data(uint32_t addr, const void *data,
+                                     uint32_t cnt)
+{
+    const uint8_t *src = data;
+    uint32_t done;
+    uint32_t i;
+
+    if ((addr > FLASH_SST_AREA_SIZE) || (cnt > FLASH_SST_AREA_SIZE - addr)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    done = pc_flash_op_size(cnt);
+    for (i = 0; i < done; i++) {
+        flash_mem[addr + i] &= src[i];
+    }
+
+    return (done == cnt) ? ARM_DRIVER_OK : ARM_DRIVER_ERROR;
+}
+
+static int32_t pc_flash_erase_sector(uint32_t addr)
+{
+    uint32_t done;
+
+    if ((addr % SST_SECTOR_SIZE != 0) || (addr >= FLASH_SST_AREA_SIZE)) {
+        return ARM_DRIVER_ERROR_PARAMETER;
+    }
+
+    done = pc_flash_op_size(SST_SECTOR_SIZE);
+    (void)memset(&flash_mem[addr], 0xFF, done);
+
+    return (done == SST_SECTOR_SIZE) ? ARM_DRIVER_OK : ARM_DRIVER_ERROR;
+}
+
+ARM_DRIVER_FLASH TFM_Driver_FLASH0 = {
+    .Initialize = pc_flash_initialize,
+    .ReadData = pc_flash_read_data,
+    .ProgramData = pc_flash_program_data,
+    .EraseSector = pc_flash_erase_sector,
+};
+
+/* Expected content of the assets */
+struct pc_test_asset_t {
+    bool present;
+    uint32_t size;
+    uint8_t data[PC_TEST_MAX_SIZE];
+};
+
+static struct pc_test_asset_t assets[PC_TEST_UIDS];
+
+/* Simple LCG, the sequence only has to be reproducible */
+static uint32_t pc_test_rand(void)
+{
+    static uint32_t state = 0x5ca1ab1e;
+
+    state = state * 1103515245U + 12345U;
+    return state >> 8;
+}
+
+/* Returns true if the stored asset has the given content */
+static bool pc_test_asset_is(psa_ps_uid_t uid,
+                             const struct pc_test_asset_t *asset)
+{
+    struct psa_ps_info_t info;
+    uint8_t data[PC_TEST_MAX_SIZE];
+    psa_ps_status_t status;
+
+    status = psa_ps_get_info(uid, &info);
+    if (!asset->present) {
+        return status == PSA_PS_ERROR_UID_NOT_FOUND;
+    }
+
+    if ((status != PSA_PS_SUCCESS) || (info.size != asset->size)) {
+        return false;
+    }
+
+    status = psa_ps_get(uid, 0, asset->size, data);
+
+    return (status == PSA_PS_SUCCESS) &&
+           (memcmp(data, asset->data, asset->size) == 0);
+}
+
+/* List of tests */
+static void tfm_sst_test_5001(struct test_result_t *ret);
+
+static struct test_t power_cut_tests[] = {
+    {&tfm_sst_test_5001, "TFM_SST_TEST_5001",
+     "Each change survives or is undone by a power cut", {0} },
+};
+
+static void register_testsuite_host_sst_power_cut(
+                                             struct test_suite_t *p_test_suite)
+{
+    uint32_t list_size = (sizeof(power_cut_tests) /
+                          sizeof(power_cut_tests[0]));
+
+    set_testsuite("SST power cut host tests (TFM_SST_TEST_5XXX)",
+                  power_cut_tests, list_size, p_test_suite);
+}
+
+/**
+ * \brief Sets and removes assets, with a power cut at a random flash operation
+ *        of most changes, and checks after each reboot that a cut change is
+ *        either complete or not done, and that the other assets have not
+ *        changed.
+ */
+static void tfm_sst_test_5001(struct test_result_t *ret)
+{
+    struct pc_test_asset_t next;
+    psa_ps_status_t status;
+    psa_ps_uid_t uid;
+    uint32_t step, i, j;
+    uint32_t cuts = 0;
+    uint32_t undone = 0;
+    uint32_t sets = 0;
+    uint32_t set_ops = 0;
+    uint32_t ops;
+
+    /* The first request creates the SST area, before any power cut */
+    if (!pc_test_asset_is(1, &assets[0])) {
+        TEST_FAIL("Asset should not exist");
+        return;
+    }
+
+    for (step = 0; step < PC_TEST_STEPS; step++) {
+        i = pc_test_rand() % PC_TEST_UIDS;
+        uid = i + 1;
+
+        next = assets[i];
+        if (assets[i].present && (pc_test_rand() % 4 == 0)) {
+            next.present = false;
+        } else {
+            next.present = true;
+            next.size = 1 + (pc_test_rand() % PC_TEST_MAX_SIZE);
+            for (j = 0; j < next.size; j++) {
+                next.data[j] = (uint8_t)pc_test_rand();
+            }
+        }
+
+        if (pc_test_rand() % 3 != 0) {
+            flash_ops_left = pc_test_rand() % PC_TEST_MAX_OPS;
+            flash_cut_torn = (pc_test_rand() % 2 == 0);
+        }
+
+        ops = flash_ops;
+        if (next.present) {
+            status = psa_ps_set(uid, next.size, next.data, PSA_PS_FLAG_NONE);
+        } else {
+            status = psa_ps_remove(uid);
+        }
+        ops = flash_ops - ops;
+
+        if (!flash_power_off) {
+            /* The power cut, if any, was scheduled after the change */
+            pc_flash_power_on();
+
+            if (status != PSA_PS_SUCCESS) {
+                TEST_FAIL("Change should not fail without a power cut");
+                return;
+            }
+
+            if (next.present) {
+                sets++;
+                set_ops += ops;
+            }
+        } else {
+            cuts++;
+            pc_flash_power_on();
+
+            /* Simulates a reboot in the system */
+            if (sst_system_prepare() != PSA_PS_SUCCESS) {
+                TEST_FAIL("SST system prepare should not fail after a cut");
+                return;
+            }
+
+            if ((status != PSA_PS_SUCCESS) &&
+                pc_test_asset_is(uid, &assets[i])) {
+                /* The change was not reported done and has been undone */
+                next = assets[i];
+                undone++;
+            }
+        }
+
+        if (!pc_test_asset_is(uid, &next)) {
+            TEST_FAIL("Asset should have the content before or after the "
+                      "change");
+            return;
+        }
+        assets[i] = next;
+
+        /* Also reboots from time to time without a power cut */
+        if (pc_test_rand() % 8 == 0) {
+            if (sst_system_prepare() != PSA_PS_SUCCESS) {
+                TEST_FAIL("SST system prepare should not fail");
+                return;
+            }
+        }
+
+        for (i = 0; i < PC_TEST_UIDS; i++) {
+            if (!pc_test_asset_is(i + 1, &assets[i])) {
+                TEST_FAIL("Other assets should not change");
+                return;
+            }
+        }
+    }
+
+    TEST_LOG("  %lu power cuts, %lu changes undone, "
+             "%lu flash program/erase operations per psa_ps_set\r\n",
+             (unsigned long)cuts, (unsigned long)undone,
+             (unsigned long)(set_ops / sets));
+
+    ret->val = TEST_PASSED;
+}
+
+static struct test_suite_t test_suites[] = {
+    {&register_testsuite_host_sst_power_cut, 0, 0, 0},
+
+    /* End of test suites */
+    {0, 0, 0, 0}
+};
+
+/* Partition entry points, declared as in the SPM database */
+extern int32_t tfm_crypto_init(void);
+extern int32_t tfm_sst_req_mngr_init(void);
+
+int main(void)
+{
+    /* The flash is erased when the device is first used */
+    (void)memset(flash_mem, 0xFF, sizeof(flash_mem));
+
+    if ((tfm_host_partition_init(TFM_SP_CRYPTO_ID, tfm_crypto_init) != 0) ||
+        (tfm_host_partition_init(TFM_SP_STORAGE_ID,
+                                 tfm_sst_req_mngr_init) != 0)) {
+        printf("Partitions failed to initialise\r\n");
+        return 1;
+    }
+
+    integ_test("Host SST power cut", test_suites);
+
+    return (test_suites[0].val == TEST_PASSED) ? 0 : 1;
+}
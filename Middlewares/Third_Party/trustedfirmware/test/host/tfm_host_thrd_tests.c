@@ -0,0 +1,314 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tfm_thread.h"
+#include "tfm_svc.h"
+#include "test/framework/test_framework.h"
+#include "test/framework/test_framework_integ_test_helper.h"
+
+/* Number of threads, about twice the partitions of a full regression build */
+#define THRD_TEST_THREADS        48
+#define THRD_TEST_STACK_SIZE     256
+
+/* Priorities 0 to 69, each given to two threads and several to a bucket */
+#define THRD_TEST_PRIOR(i)       ((((i) * 7) % 24) * 3)
+
+/* Random status changes checked against the reference scheduler */
+#define THRD_TEST_STEPS          2000
+
+/* Calls timed by the benchmark */
+#define THRD_BENCH_CALLS         100000
+
+/* Host stand-ins of the architecture and SVC layers used by tfm_thread.c */
+uint32_t tfm_host_pendsv_count;
+
+void tfm_arch_initialize_ctx_ext(struct tfm_state_context_ext *p_ctxb,
+                                 uint32_t sp, uint32_t sp_limit)
+{
+    p_ctxb->sp = sp;
+    p_ctxb->sp_limit = sp_limit;
+}
+
+void tfm_host_svc(tfm_svc_number_t code)
+{
+    (void)code;
+
+    /* Threads are never run on the host, so they never exit through SVC */
+    abort();
+}
+
+void tfm_panic(void)
+{
+    abort();
+}
+
+static struct tfm_thrd_ctx threads[THRD_TEST_THREADS];
+static uint8_t stacks[THRD_TEST_THREADS][THRD_TEST_STACK_SIZE]
+                                                    __attribute__((aligned(8)));
+
+/* Order in which the threads last became runnable, for the reference */
+static uint32_t runn_seq[THRD_TEST_THREADS];
+static uint32_t seq;
+
+static void *thrd_test_entry(void *param)
+{
+    return param;
+}
+
+/*
+ * Reference scheduler: scans every thread for the running one with the
+ * lowest priority value, the one which became runnable first among equals.
+ */
+static struct tfm_thrd_ctx *ref_next_thread(void)
+{
+    struct tfm_thrd_ctx *next = NULL;
+    uint32_t next_seq = 0;
+    uint32_t i;
+
+    for (i = 0; i < THRD_TEST_THREADS; i++) {
+        if (threads[i].status != THRD_STAT_RUNNING) {
+            continue;
+        }
+        if ((next == NULL) || (threads[i].prior < next->prior) ||
+            ((threads[i].prior == next->prior) && (runn_seq[i] < next_seq))) {
+            next = &threads[i];
+            next_seq = runn_seq[i];
+        }
+    }
+
+    return next;
+}
+
+static void thrd_test_set_status(uint32_t i, uint32_t status)
+{
+    if ((status == THRD_STAT_RUNNING) &&
+        (threads[i].status != THRD_STAT_RUNNING)) {
+        runn_seq[i] = seq++;
+    }
+    tfm_thrd_set_status(&threads[i], status);
+}
+
+/* Simple LCG, the sequence only has to be reproducible */
+static uint32_t thrd_test_rand(void)
+{
+    static uint32_t state = 0x12345678;
+
+    state = state * 1103515245U + 12345U;
+    return state >> 8;
+}
+
+/* List of tests */
+static void tfm_thrd_test_1001(struct test_result_t *ret);
+static void tfm_thrd_test_1002(struct test_result_t *ret);
+static void tfm_thrd_test_1003(struct test_result_t *ret);
+
+static struct test_t thrd_tests[] = {
+    {&tfm_thrd_test_1001, "TFM_THRD_TEST_1001",
+     "Next thread is the highest priority running thread", {0} },
+    {&tfm_thrd_test_1002, "TFM_THRD_TEST_1002",
+     "Exited thread leaves the runnable queue", {0} },
+    {&tfm_thrd_test_1003, "TFM_THRD_TEST_1003",
+     "Next thread latency with most threads blocked", {0} },
+};
+
+static void register_testsuite_host_thrd(struct test_suite_t *p_test_suite)
+{
+    uint32_t list_size = (sizeof(thrd_tests) / sizeof(thrd_tests[0]));
+
+    set_testsuite("Thread scheduler host tests (TFM_THRD_TEST_1XXX)",
+                  thrd_tests, list_size, p_test_suite);
+}
+
+/**
+ * \brief Starts the threads and checks the next thread against the reference
+ *        scheduler through random status changes.
+ *
+ * \details The last thread is non-secure and of the highest priority, so it
+ *          must only be picked when no secure thread is running.
+ */
+static void tfm_thrd_test_1001(struct test_result_t *ret)
+{
+    uint32_t i, step;
+
+    for (i = 0; i < THRD_TEST_THREADS; i++) {
+        tfm_thrd_init(&threads[i], thrd_test_entry, NULL,
+                      (uintptr_t)&stacks[i][THRD_TEST_STACK_SIZE],
+                      (uintptr_t)&stacks[i][0]);
+        tfm_thrd_priority(&threads[i], THRD_TEST_PRIOR(i));
+        if (i == THRD_TEST_THREADS - 1) {
+            tfm_thrd_priority(&threads[i], THRD_PRIOR_HIGHEST);
+            tfm_thrd_secure(&threads[i], THRD_ATTR_NON_SECURE);
+        }
+
+        runn_seq[i] = seq++;
+        if (tfm_thrd_start(&threads[i]) != THRD_SUCCESS) {
+            TEST_FAIL("Thread should start");
+            return;
+        }
+
+        if (tfm_thrd_next_thread() != ref_next_thread()) {
+            TEST_FAIL("Wrong next thread after a thread start");
+            return;
+        }
+    }
+
+    for (step = 0; step < THRD_TEST_STEPS; step++) {
+        i = thrd_test_rand() % THRD_TEST_THREADS;
+        thrd_test_set_status(i, (threads[i].status == THRD_STAT_RUNNING) ?
+                                THRD_STAT_BLOCK : THRD_STAT_RUNNING);
+
+        if (tfm_thrd_next_thread() != ref_next_thread()) {
+            TEST_FAIL("Wrong next thread after a status change");
+            return;
+        }
+    }
+
+    for (i = 0; i < THRD_TEST_THREADS; i++) {
+        thrd_test_set_status(i, THRD_STAT_BLOCK);
+    }
+    if (tfm_thrd_next_thread() != NULL) {
+        TEST_FAIL("No thread should be picked when all are blocked");
+        return;
+    }
+
+    for (i = 0; i < THRD_TEST_THREADS; i++) {
+        thrd_test_set_status(i, THRD_STAT_RUNNING);
+    }
+    if (tfm_thrd_next_thread() != ref_next_thread()) {
+        TEST_FAIL("Wrong next thread after all threads are woken up");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+/**
+ * \brief Switches to the next thread and makes it exit.
+ */
+static void tfm_thrd_test_1002(struct test_result_t *ret)
+{
+    static struct tfm_thrd_ctx boot_thrd;
+    struct tfm_state_context_ext ctxb = {0};
+    struct tfm_thrd_ctx *pth;
+    uint32_t pendsv_count;
+
+    tfm_thrd_start_scheduler(&boot_thrd);
+
+    pth = tfm_thrd_next_thread();
+    if (pth == NULL) {
+        TEST_FAIL("A thread should be running");
+        return;
+    }
+
+    tfm_thrd_context_switch(&ctxb, &boot_thrd, pth);
+    if (tfm_thrd_curr_thread() != pth) {
+        TEST_FAIL("Current thread should be the next thread");
+        return;
+    }
+
+    pendsv_count = tfm_host_pendsv_count;
+    tfm_svcall_thrd_exit();
+
+    if (pth->status != THRD_STAT_DETACH) {
+        TEST_FAIL("Exited thread should be detached");
+        return;
+    }
+
+    if (tfm_host_pendsv_count == pendsv_count) {
+        TEST_FAIL("Thread exit should request a schedule");
+        return;
+    }
+
+    if ((tfm_thrd_next_thread() == pth) ||
+        (tfm_thrd_next_thread() != ref_next_thread())) {
+        TEST_FAIL("Exited thread should not be picked");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+static uint64_t thrd_bench_ns(void)
+{
+    struct timespec ts;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * \brief Times the scheduler with only the lowest priority thread running,
+ *        the worst case of a scan from the highest priority thread.
+ */
+static void tfm_thrd_test_1003(struct test_result_t *ret)
+{
+    struct tfm_thrd_ctx *volatile next;
+    struct tfm_thrd_ctx *first = NULL, *last = NULL;
+    uint64_t start, next_ns, wake_ns;
+    uint32_t i, n;
+
+    for (i = 0; i < THRD_TEST_THREADS; i++) {
+        if (threads[i].status == THRD_STAT_RUNNING) {
+            thrd_test_set_status(i, THRD_STAT_BLOCK);
+        }
+        if (threads[i].status != THRD_STAT_BLOCK) {
+            continue;
+        }
+        if ((first == NULL) || (threads[i].prior < first->prior)) {
+            first = &threads[i];
+        }
+        if ((last == NULL) || (threads[i].prior > last->prior)) {
+            last = &threads[i];
+        }
+    }
+    thrd_test_set_status(last - threads, THRD_STAT_RUNNING);
+
+    start = thrd_bench_ns();
+    for (n = 0; n < THRD_BENCH_CALLS; n++) {
+        next = tfm_thrd_next_thread();
+    }
+    next_ns = thrd_bench_ns() - start;
+
+    if (next != last) {
+        TEST_FAIL("Only the lowest priority thread should be picked");
+        return;
+    }
+
+    /* Wake up and block the highest priority thread */
+    start = thrd_bench_ns();
+    for (n = 0; n < THRD_BENCH_CALLS; n++) {
+        tfm_thrd_set_status(first, THRD_STAT_RUNNING);
+        next = tfm_thrd_next_thread();
+        tfm_thrd_set_status(first, THRD_STAT_BLOCK);
+    }
+    wake_ns = thrd_bench_ns() - start;
+
+    TEST_LOG("  %lu threads: tfm_thrd_next_thread %lu ps/call, "
+             "wake up + next + block %lu ps\r\n",
+             (unsigned long)THRD_TEST_THREADS,
+             (unsigned long)((next_ns * 1000) / THRD_BENCH_CALLS),
+             (unsigned long)((wake_ns * 1000) / THRD_BENCH_CALLS));
+
+    ret->val = TEST_PASSED;
+}
+
+static struct test_suite_t test_suites[] = {
+    {&register_testsuite_host_thrd, 0, 0, 0},
+
+    /* End of test suites */
+    {0, 0, 0, 0}
+};
+
+int main(void)
+{
+    integ_test("Host thread", test_suites);
+
+    return (test_suites[0].val == TEST_PASSED) ? 0 : 1;
+}
@@ -11,6 +11,7 @@
 #include "attest_token_test.h"
 #include "q_useful_buf.h"
 #include "psa/initial_attestation.h"
+#include "psa/crypto.h"
 #include "attest_token_decode.h"
 #include "attest_token_test_values.h"
 
@@ -917,3 +918,190 @@ int_fast16_t decode_test_normal_sig(void)
 {
     return decode_test_internal(NORMAL_SIGN);
 }
+
+
+/* Number of challenges signed together by decode_test_batch_token() */
+#define BATCH_TEST_CHALLENGES 3
+
+/* Domain separation prefixes of the leaf and inner nodes of the tree */
+#define BATCH_TEST_LEAF_PREFIX 0x00
+#define BATCH_TEST_NODE_PREFIX 0x01
+
+
+/**
+ * \brief Hash a node of the batch token Merkle tree.
+ *
+ * \param[in] prefix  Domain separation prefix of the node.
+ * \param[in] left    First part of the hashed data.
+ * \param[in] right   Second part of the hashed data, can be NULL_Q_USEFUL_BUF_C.
+ * \param[in] hash    Buffer of PSA_HASH_SIZE(PSA_ALG_SHA_256) bytes.
+ *
+ * \return 0 on success, non-zero otherwise.
+ */
+static int_fast16_t batch_test_hash(uint8_t prefix,
+                                    struct q_useful_buf_c left,
+                                    struct q_useful_buf_c right,
+                                    struct q_useful_buf hash)
+{
+    psa_hash_operation_t operation = psa_hash_operation_init();
+    psa_status_t         status;
+    size_t               hash_len;
+
+    status = psa_hash_setup(&operation, PSA_ALG_SHA_256);
+    if(status != PSA_SUCCESS) {
+        return -1;
+    }
+
+    status = psa_hash_update(&operation, &prefix, sizeof(prefix));
+    if(status == PSA_SUCCESS) {
+        status = psa_hash_update(&operation, left.ptr, left.len);
+    }
+    if(status == PSA_SUCCESS && right.len != 0) {
+        status = psa_hash_update(&operation, right.ptr, right.len);
+    }
+    if(status == PSA_SUCCESS) {
+        status = psa_hash_finish(&operation, hash.ptr, hash.len, &hash_len);
+    }
+
+    if(status != PSA_SUCCESS) {
+        (void)psa_hash_abort(&operation);
+        return -2;
+    }
+
+    return 0;
+}
+
+
+/*
+ * Public function. See token_test.h
+ */
+int_fast16_t decode_test_batch_token(void)
+{
+    int_fast16_t                        return_value;
+    enum psa_attest_err_t               attest_err;
+    struct attest_token_decode_context  token_decode;
+    struct q_useful_buf_c               nonce;
+    struct q_useful_buf_c               leaf[BATCH_TEST_CHALLENGES];
+    struct q_useful_buf_c               node;
+    struct q_useful_buf_c               root;
+    uint32_t                            token_size;
+    uint32_t                            i;
+    Q_USEFUL_BUF_MAKE_STACK_UB(         token_storage, ATTEST_TOKEN_MAX_SIZE);
+    Q_USEFUL_BUF_MAKE_STACK_UB(         challenges,
+                                        BATCH_TEST_CHALLENGES *
+                                        PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32);
+    Q_USEFUL_BUF_MAKE_STACK_UB(         hashes,
+                                        (BATCH_TEST_CHALLENGES + 2) *
+                                        PSA_HASH_SIZE(PSA_ALG_SHA_256));
+
+    /* Challenges of different values, as from different verifiers */
+    for(i = 0; i < challenges.len; i++) {
+        ((uint8_t *)challenges.ptr)[i] =
+            (uint8_t)(i / PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32 + 1);
+    }
+
+    /* -- Challenge size or count out of range must be rejected -- */
+    token_size = (uint32_t)token_storage.len;
+    attest_err = psa_initial_attest_get_batch_token(
+                                    challenges.ptr,
+                                    PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32 + 1,
+                                    BATCH_TEST_CHALLENGES,
+                                    token_storage.ptr,
+                                    &token_size);
+    if(attest_err != PSA_ATTEST_ERR_INVALID_INPUT) {
+        return_value = -10;
+        goto Done;
+    }
+
+    attest_err = psa_initial_attest_get_batch_token(
+                                    challenges.ptr,
+                                    PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32,
+                                    0,
+                                    token_storage.ptr,
+                                    &token_size);
+    if(attest_err != PSA_ATTEST_ERR_INVALID_INPUT) {
+        return_value = -11;
+        goto Done;
+    }
+
+    /* -- Get and validate a token over all the challenges -- */
+    attest_err = psa_initial_attest_get_batch_token(
+                                    challenges.ptr,
+                                    PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32,
+                                    BATCH_TEST_CHALLENGES,
+                                    token_storage.ptr,
+                                    &token_size);
+    if(attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return_value = (int_fast16_t)attest_err;
+        goto Done;
+    }
+
+    attest_token_decode_init(&token_decode, 0);
+    return_value = attest_token_decode_validate_token(
+                            &token_decode,
+                            (struct q_useful_buf_c){token_storage.ptr,
+                                                    token_size});
+    if(return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        goto Done;
+    }
+
+    return_value = attest_token_decode_get_nonce(&token_decode, &nonce);
+    if(return_value != ATTEST_TOKEN_ERR_SUCCESS) {
+        goto Done;
+    }
+
+    /* -- Recompute the root the verifiers check the nonce against --
+     *
+     *            root
+     *           /    \
+     *        node     \
+     *       /    \     \
+     *   leaf0  leaf1  leaf2
+     */
+    for(i = 0; i < BATCH_TEST_CHALLENGES; i++) {
+        leaf[i] = (struct q_useful_buf_c){
+            (uint8_t *)hashes.ptr + i * PSA_HASH_SIZE(PSA_ALG_SHA_256),
+            PSA_HASH_SIZE(PSA_ALG_SHA_256)};
+        return_value = batch_test_hash(
+                        BATCH_TEST_LEAF_PREFIX,
+                        (struct q_useful_buf_c){
+                            (uint8_t *)challenges.ptr +
+                                i * PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32,
+                            PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32},
+                        NULL_Q_USEFUL_BUF_C,
+                        q_useful_buf_unconst(leaf[i]));
+        if(return_value) {
+            goto Done;
+        }
+    }
+
+    node = (struct q_useful_buf_c){
+        (uint8_t *)hashes.ptr +
+            BATCH_TEST_CHALLENGES * PSA_HASH_SIZE(PSA_ALG_SHA_256),
+        PSA_HASH_SIZE(PSA_ALG_SHA_256)};
+    return_value = batch_test_hash(BATCH_TEST_NODE_PREFIX, leaf[0], leaf[1],
+                                   q_useful_buf_unconst(node));
+    if(return_value) {
+        goto Done;
+    }
+
+    root = (struct q_useful_buf_c){
+        (uint8_t *)hashes.ptr +
+            (BATCH_TEST_CHALLENGES + 1) * PSA_HASH_SIZE(PSA_ALG_SHA_256),
+        PSA_HASH_SIZE(PSA_ALG_SHA_256)};
+    return_value = batch_test_hash(BATCH_TEST_NODE_PREFIX, node, leaf[2],
+                                   q_useful_buf_unconst(root));
+    if(return_value) {
+        goto Done;
+    }
+
+    if(q_useful_buf_compare(nonce, root)) {
+        return_value = -12;
+        goto Done;
+    }
+
+    return_value = 0;
+
+Done:
+    return return_value;
+}
@@ -99,6 +99,19 @@ int_fast16_t decode_test_normal_sig(void);
  */
 int_fast16_t decode_test_short_circuit_sig(void);
 
+
+/**
+ * \brief Test a token signed over several challenges at once.
+ *
+ * \return non-zero on failure.
+ *
+ * Gets a batch token of three challenges with a real ECDSA signature,
+ * validates it and checks that its nonce is the root of the Merkle
+ * tree of the challenges, recomputed here as a verifier would. Out of
+ * range challenge sizes and counts must be rejected.
+ */
+int_fast16_t decode_test_batch_token(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -25,6 +25,7 @@ static void tfm_attest_test_2003(struct test_result_t *ret);
 #endif
 static void tfm_attest_test_2004(struct test_result_t *ret);
 static void tfm_attest_test_2005(struct test_result_t *ret);
+static void tfm_attest_test_2006(struct test_result_t *ret);
 
 static struct test_t attestation_interface_tests[] = {
 #ifdef INCLUDE_TEST_CODE_AND_KEY_ID /* Remove them from release build */
@@ -39,6 +40,8 @@ static struct test_t attestation_interface_tests[] = {
      "ECDSA signature test of attest token", {0} },
     {&tfm_attest_test_2005, "TFM_ATTEST_TEST_2005",
      "Negative test cases for initial attestation service", {0} },
+    {&tfm_attest_test_2006, "TFM_ATTEST_TEST_2006",
+     "Batch token test of attest token", {0} },
 };
 
 void
@@ -178,3 +181,24 @@ static void tfm_attest_test_2005(struct test_result_t *ret)
 
     ret->val = TEST_PASSED;
 }
+
+/*!
+ * \brief Get a token signed over several challenges at once. Validate the
+ *        signature and check that the nonce claim is the Merkle tree root
+ *        of the challenges.
+ *
+ * More info in token_test.h
+ */
+static void tfm_attest_test_2006(struct test_result_t *ret)
+{
+    int32_t err;
+
+    err = decode_test_batch_token();
+    if (err != 0) {
+        TEST_LOG("decode_test_batch_token() returned: %d\r\n", err);
+        TEST_FAIL("Attest token decode_test_batch_token() has failed");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
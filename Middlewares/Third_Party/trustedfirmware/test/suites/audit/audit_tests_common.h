@@ -50,16 +50,17 @@ extern "C" {
 /*!
  * \def INITIAL_LOGGING_REQUESTS
  *
- * \brief Number of initial consecutive logging requests to perform
+ * \brief Number of initial consecutive logging requests to perform, i.e. the
+ *        number of standard size log items which fill the log without wrapping
  */
-#define INITIAL_LOGGING_REQUESTS (36)
+#define INITIAL_LOGGING_REQUESTS (MAX_LOG_SIZE / STANDARD_LOG_ENTRY_SIZE)
 
 /*!
  * \def INITIAL_LOGGING_SIZE
  *
  * \brief Size of the initial consecutive logging requests
  */
-#define INITIAL_LOGGING_SIZE (1008)
+#define INITIAL_LOGGING_SIZE (INITIAL_LOGGING_REQUESTS * STANDARD_LOG_ENTRY_SIZE)
 
 /*!
  * \def FINAL_LOGGING_REQUESTS
@@ -97,15 +98,23 @@ extern "C" {
  */
 #define SECOND_ELEMENT_EXPECTED_CONTENT ( (DUMMY_TEST_RECORD_ID_BASE) + \
                       (INITIAL_LOGGING_REQUESTS+1+FINAL_LOGGING_REQUESTS) )
+/*!
+ * \def AUDIT_LOG_SIZE
+ *
+ * \brief Size of the log the service is built with. It is set by the build
+ *        system together with the one of the service, the default is the
+ *        same as the service one
+ */
+#ifndef AUDIT_LOG_SIZE
+#define AUDIT_LOG_SIZE (1024)
+#endif
+
 /*!
  * \def MAX_LOG_SIZE
  *
  * \brief The maximum possible log size in the current implementation
- *
- * \brief This parameter for tests has to be changed for the tests in case the
- *        implementation is modified
  */
-#define MAX_LOG_SIZE (1024)
+#define MAX_LOG_SIZE (AUDIT_LOG_SIZE)
 
 /*!
  * \def MAX_LOG_RECORD_SIZE
@@ -115,7 +124,7 @@ extern "C" {
  * \note This takes into account additional fields that are concatenated to the
  *       record in the header and trailer
  */
-#define MAX_LOG_RECORD_SIZE (1000)
+#define MAX_LOG_RECORD_SIZE (MAX_LOG_SIZE - 24)
 
 /*!
  * \def INITIAL_LOG_SIZE
@@ -85,7 +85,7 @@ static void tfm_audit_test_1001(struct test_result_t *ret)
     psa_status_t status;
 
     uint8_t local_buffer[LOCAL_BUFFER_SIZE];
-    uint32_t idx, stored_size, num_records, retrieved_size;
+    uint32_t idx, stored_size, num_records, retrieved_size, retrieved_records;
 
     struct psa_audit_record *retrieved_buffer;
 
@@ -204,6 +204,35 @@ static void tfm_audit_test_1001(struct test_result_t *ret)
         return;
     }
 
+    /* Retrieve all the elements stored in the log in one request */
+    status = psa_audit_retrieve_records(0,
+                                        INITIAL_LOG_RECORDS,
+                                        LOCAL_BUFFER_SIZE,
+                                        NULL,
+                                        0,
+                                        &local_buffer[0],
+                                        &retrieved_records,
+                                        &retrieved_size);
+
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Log records retrieval from NS returned error");
+        return;
+    }
+
+    if ((retrieved_records != INITIAL_LOG_RECORDS) ||
+        (retrieved_size != INITIAL_LOG_SIZE)) {
+        TEST_FAIL("Expected log size is " STR(INITIAL_LOG_SIZE));
+        return;
+    }
+
+    retrieved_buffer = (struct psa_audit_record *)
+        &local_buffer[offsetof(struct log_hdr, size)+STANDARD_LOG_ENTRY_SIZE];
+
+    if (retrieved_buffer->id != SECOND_ELEMENT_EXPECTED_CONTENT) {
+        TEST_FAIL("Unexpected argument in the second entry");
+        return;
+    }
+
     /* Delete oldest element in the log */
     status = psa_audit_delete_record(0, NULL, 0);
     if (status != PSA_SUCCESS) {
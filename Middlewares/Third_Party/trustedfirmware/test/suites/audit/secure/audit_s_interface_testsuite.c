@@ -28,12 +28,23 @@
  */
 #define FIRST_RETRIEVAL_LOG_INDEX (0)
 
+/*!
+ * \var max_record_buffer
+ *
+ * \brief Buffer holding the record with the maximum possible payload
+ */
+__attribute__ ((aligned(4)))
+static uint8_t max_record_buffer[MAX_LOG_SIZE];
+
 /* List of tests */
 static void tfm_audit_test_1001(struct test_result_t *ret);
+static void tfm_audit_test_1002(struct test_result_t *ret);
 
 static struct test_t audit_veneers_tests[] = {
     {&tfm_audit_test_1001, "TFM_AUDIT_TEST_1001",
      "Secure functional", {0} },
+    {&tfm_audit_test_1002, "TFM_AUDIT_TEST_1002",
+     "Secure batched retrieval", {0} },
 };
 
 void register_testsuite_s_audit_interface(struct test_suite_t *p_test_suite)
@@ -63,14 +74,15 @@ void register_testsuite_s_audit_interface(struct test_suite_t *p_test_suite)
 static void tfm_audit_test_1001(struct test_result_t *ret)
 {
     psa_status_t status;
-    uint8_t local_buffer[LOCAL_BUFFER_SIZE], idx;
+    uint8_t local_buffer[LOCAL_BUFFER_SIZE];
+    uint32_t idx;
     struct psa_audit_record *record = (struct psa_audit_record *)
                                                   &local_buffer[0];
     uint32_t num_records, stored_size, record_size;
     struct psa_audit_record *retrieved_buffer;
 
-    /* Fill the log with 36 records, each record is 28 bytes
-     * we end up filling the log without wrapping
+    /* Fill the log with records of 28 bytes, 36 records for a log of 1024
+     * bytes, we end up filling the log without wrapping
      */
     for (idx=0; idx<INITIAL_LOGGING_REQUESTS; idx++) {
         record->size = sizeof(struct psa_audit_record) - 4;
@@ -288,10 +300,11 @@ static void tfm_audit_test_1001(struct test_result_t *ret)
     }
 
     /* Fill now one big record that will invalidate all existing records */
+    record = (struct psa_audit_record *)&max_record_buffer[0];
     record->size = MAX_LOG_RECORD_SIZE;
     record->id = DUMMY_TEST_RECORD_ID_BASE + INITIAL_LOGGING_REQUESTS + 1;
 
-    /* The record has maximum possible payload for log size of 1024 */
+    /* The record has maximum possible payload for the log size */
     status = psa_audit_add_record(record);
     if (status != PSA_SUCCESS) {
         TEST_FAIL("Record addition has returned an error");
@@ -395,3 +408,119 @@ static void tfm_audit_test_1001(struct test_result_t *ret)
 
     ret->val = TEST_PASSED;
 }
+
+/**
+ * \brief Retrieval of consecutive records in a single request
+ *
+ * \note This test only reads the log, so it keeps the status in which
+ *       TFM_AUDIT_TEST_1001 leaves it for the Non Secure functional tests.
+ */
+static void tfm_audit_test_1002(struct test_result_t *ret)
+{
+    psa_status_t status;
+    uint8_t local_buffer[LOCAL_BUFFER_SIZE];
+    uint32_t num_records, retrieved_records, retrieved_size;
+    struct psa_audit_record *retrieved_buffer;
+
+    /* Retrieve all the records in one request */
+    status = psa_audit_retrieve_records(0,
+                                        FINAL_LOGGING_REQUESTS,
+                                        LOCAL_BUFFER_SIZE,
+                                        NULL,
+                                        0,
+                                        &local_buffer[0],
+                                        &retrieved_records,
+                                        &retrieved_size);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Retrieval of the records has returned an error");
+        return;
+    }
+
+    if (retrieved_records != FINAL_LOGGING_REQUESTS) {
+        TEST_FAIL("Expected retrieved records are "
+                  STR(FINAL_LOGGING_REQUESTS));
+        return;
+    }
+
+    if (retrieved_size != FINAL_LOGGING_SIZE) {
+        TEST_FAIL("Expected retrieved size is " STR(FINAL_LOGGING_SIZE));
+        return;
+    }
+
+    /* The records are returned one after the other */
+    retrieved_buffer = (struct psa_audit_record *)
+        &local_buffer[offsetof(struct log_hdr, size)];
+    if (retrieved_buffer->id != (DUMMY_TEST_RECORD_ID_BASE +
+                                 INITIAL_LOGGING_REQUESTS + 2)) {
+        TEST_FAIL("Unexpected argument in the first entry");
+        return;
+    }
+
+    retrieved_buffer = (struct psa_audit_record *)
+        &local_buffer[offsetof(struct log_hdr, size)+STANDARD_LOG_ENTRY_SIZE];
+    if (retrieved_buffer->id != SECOND_ELEMENT_EXPECTED_CONTENT) {
+        TEST_FAIL("Unexpected argument in the second entry");
+        return;
+    }
+
+    /* Only the whole records which fit in the buffer are retrieved */
+    status = psa_audit_retrieve_records(0,
+                                        FINAL_LOGGING_REQUESTS,
+                                        STANDARD_LOG_ENTRY_SIZE + 4,
+                                        NULL,
+                                        0,
+                                        &local_buffer[0],
+                                        &retrieved_records,
+                                        &retrieved_size);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Retrieval of the records has returned an error");
+        return;
+    }
+
+    if ((retrieved_records != 1) ||
+        (retrieved_size != STANDARD_LOG_ENTRY_SIZE)) {
+        TEST_FAIL("Only the first record should have been retrieved");
+        return;
+    }
+
+    /* Nothing is retrieved if the first record doesn't fit */
+    status = psa_audit_retrieve_records(1,
+                                        FINAL_LOGGING_REQUESTS,
+                                        STANDARD_LOG_ENTRY_SIZE - 4,
+                                        NULL,
+                                        0,
+                                        &local_buffer[0],
+                                        &retrieved_records,
+                                        &retrieved_size);
+    if (status != PSA_ERROR_BUFFER_TOO_SMALL) {
+        TEST_FAIL("Retrieval into a too small buffer should fail");
+        return;
+    }
+
+    if ((retrieved_records != 0) || (retrieved_size != 0)) {
+        TEST_FAIL("Nothing should have been retrieved");
+        return;
+    }
+
+    /* Retrieval starting past the last record fails */
+    status = psa_audit_get_info(&num_records, &retrieved_size);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Getting log info has returned error");
+        return;
+    }
+
+    status = psa_audit_retrieve_records(num_records,
+                                        1,
+                                        LOCAL_BUFFER_SIZE,
+                                        NULL,
+                                        0,
+                                        &local_buffer[0],
+                                        &retrieved_records,
+                                        &retrieved_size);
+    if (status == PSA_SUCCESS) {
+        TEST_FAIL("Retrieval of non-existent records has not failed");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "benchmark_tests_common.h"
+
+#include "psa/internal_trusted_storage.h"
+#include "psa/protected_storage.h"
+#include "psa/initial_attestation.h"
+
+/* UIDs used by the storage benchmarks */
+#define BENCH_UID          0x42454E43U /* "BENC" */
+#define BENCH_MISSING_UID  0x42454E44U /* Never created */
+
+/* Key material used by the crypto benchmarks */
+#define BENCH_KEY_DATA  "THIS IS MY KEY1"
+
+/* Nonce and associated data used by the AEAD benchmark */
+#define BENCH_NONCE_SIZE       (12)
+#define BENCH_ASSOC_DATA_SIZE  (16)
+
+/* Worst case tag size of the AEAD algorithms which can be benchmarked */
+#define BENCH_TAG_SIZE (16)
+
+/* Tokens are signed, so fewer iterations keep the test short */
+#define BENCH_ATTEST_ITERATIONS (8)
+
+/**
+ * \brief Cycle counts accumulated over the calls of one benchmark
+ */
+struct bench_stats_t {
+    uint32_t calls;  /*!< Number of timed calls */
+    uint64_t total;  /*!< Sum of the cycles taken by each call */
+    uint32_t min;    /*!< Cycles taken by the fastest call */
+    uint32_t max;    /*!< Cycles taken by the slowest call */
+};
+
+/* The data buffers are static to keep them off the test partition stack */
+static uint8_t bench_input[BENCH_DATA_SIZE];
+static uint8_t bench_output[BENCH_DATA_SIZE + BENCH_TAG_SIZE];
+
+static void bench_stats_init(struct bench_stats_t *stats)
+{
+    stats->calls = 0;
+    stats->total = 0;
+    stats->min = UINT32_MAX;
+    stats->max = 0;
+}
+
+static void bench_stats_add(struct bench_stats_t *stats,
+                            uint32_t start, uint32_t end)
+{
+    /* Unsigned subtraction gives the right delta across a counter wrap */
+    uint32_t cycles = end - start;
+
+    stats->calls++;
+    stats->total += cycles;
+    if (cycles < stats->min) {
+        stats->min = cycles;
+    }
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+}
+
+/**
+ * \brief Prints the operations per second and cycles per call of a benchmark,
+ *        plus the throughput if each call processes \p bytes bytes.
+ */
+static void bench_stats_report(const char *name,
+                               const struct bench_stats_t *stats,
+                               uint32_t bytes)
+{
+    uint64_t ops_per_sec = 0;
+    uint64_t kb_per_sec;
+
+    if (stats->calls == 0) {
+        return;
+    }
+
+    if (stats->total != 0) {
+        ops_per_sec = ((uint64_t)stats->calls * bench_timer_freq()) /
+                      stats->total;
+    }
+
+    TEST_LOG("  %s: %lu ops/s, %lu cycles/call (min %lu, max %lu)",
+             name, (unsigned long)ops_per_sec,
+             (unsigned long)(stats->total / stats->calls),
+             (unsigned long)stats->min, (unsigned long)stats->max);
+
+    if (bytes != 0) {
+        kb_per_sec = (ops_per_sec * bytes) / 1024;
+        TEST_LOG(", %lu KB/s", (unsigned long)kb_per_sec);
+    }
+
+    TEST_LOG("\r\n");
+}
+
+static int32_t bench_start(struct test_result_t *ret)
+{
+    if (bench_timer_init() != 0) {
+        TEST_FAIL("Cycle counter is not available in both security states");
+        return 1;
+    }
+
+    return 0;
+}
+
+void bench_psa_call_test(struct test_result_t *ret)
+{
+    struct bench_stats_t stats;
+    struct psa_storage_info_t info;
+    psa_status_t status;
+    uint32_t start, i;
+
+    if (bench_start(ret) != 0) {
+        return;
+    }
+
+    bench_stats_init(&stats);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        start = bench_timer_read();
+        status = psa_its_get_info(BENCH_MISSING_UID, &info);
+        bench_stats_add(&stats, start, bench_timer_read());
+
+        if (status != PSA_ERROR_DOES_NOT_EXIST) {
+            TEST_FAIL("ITS get_info should not find the UID");
+            return;
+        }
+    }
+
+    bench_stats_report("psa_its_get_info (missing UID)", &stats, 0);
+
+    ret->val = TEST_PASSED;
+}
+
+void bench_hash_test(const psa_algorithm_t alg, struct test_result_t *ret)
+{
+    struct bench_stats_t stats;
+    psa_hash_operation_t handle;
+    uint8_t hash[PSA_HASH_MAX_SIZE];
+    size_t hash_length;
+    psa_status_t status;
+    uint32_t start, i;
+
+    if (bench_start(ret) != 0) {
+        return;
+    }
+
+    bench_stats_init(&stats);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        handle = psa_hash_operation_init();
+
+        start = bench_timer_read();
+        status = psa_hash_setup(&handle, alg);
+        if (status == PSA_SUCCESS) {
+            status = psa_hash_update(&handle, bench_input,
+                                     sizeof(bench_input));
+        }
+        if (status == PSA_SUCCESS) {
+            status = psa_hash_finish(&handle, hash, sizeof(hash),
+                                     &hash_length);
+        }
+        bench_stats_add(&stats, start, bench_timer_read());
+
+        if (status != PSA_SUCCESS) {
+            (void)psa_hash_abort(&handle);
+            TEST_FAIL("Error computing the hash");
+            return;
+        }
+    }
+
+    bench_stats_report("psa_hash setup/update/finish", &stats,
+                       sizeof(bench_input));
+
+    ret->val = TEST_PASSED;
+}
+
+void bench_aead_test(const psa_key_type_t key_type,
+                     const psa_algorithm_t alg,
+                     struct test_result_t *ret)
+{
+    struct bench_stats_t stats;
+    psa_key_handle_t key_handle;
+    psa_key_policy_t policy = psa_key_policy_init();
+    const uint8_t data[] = BENCH_KEY_DATA;
+    const uint8_t nonce[BENCH_NONCE_SIZE] = {0};
+    const uint8_t associated_data[BENCH_ASSOC_DATA_SIZE] = {0};
+    size_t output_length;
+    psa_status_t status;
+    uint32_t start, i;
+
+    if (bench_start(ret) != 0) {
+        return;
+    }
+
+    status = psa_allocate_key(&key_handle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Failed to allocate key");
+        return;
+    }
+
+    psa_key_policy_set_usage(&policy, PSA_KEY_USAGE_ENCRYPT, alg);
+    status = psa_set_key_policy(key_handle, &policy);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Failed to set key policy");
+        goto destroy_key_aead;
+    }
+
+    status = psa_import_key(key_handle, key_type, data, sizeof(data));
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error importing a key");
+        goto destroy_key_aead;
+    }
+
+    bench_stats_init(&stats);
+
+    for (i = 0; i < BENCH_ITERATIONS; i++) {
+        start = bench_timer_read();
+        status = psa_aead_encrypt(key_handle, alg, nonce, sizeof(nonce),
+                                  associated_data, sizeof(associated_data),
+                                  bench_input, sizeof(bench_input),
+                                  bench_output, sizeof(bench_output),
+                                  &output_length);
+        bench_stats_add(&stats, start, bench_timer_read());
+
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Error performing AEAD encryption");
+            goto destroy_key_aead;
+        }
+    }
+
+    bench_stats_report("psa_aead_encrypt", &stats, sizeof(bench_input));
+
+    ret->val = TEST_PASSED;
+
+destroy_key_aead:
+    status = psa_destroy_key(key_handle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error destroying the key");
+    }
+}
+
+void bench_its_test(struct test_result_t *ret)
+{
+    struct bench_stats_t set_stats, get_stats;
+    psa_status_t status;
+    size_t data_length;
+    uint32_t start, i;
+
+    if (bench_start(ret) != 0) {
+        return;
+    }
+
+    bench_stats_init(&set_stats);
+    bench_stats_init(&get_stats);
+
+    for (i = 0; i < BENCH_STORAGE_ITERATIONS; i++) {
+        start = bench_timer_read();
+        status = psa_its_set(BENCH_UID, BENCH_ASSET_SIZE, bench_input,
+                             PSA_STORAGE_FLAG_NONE);
+        bench_stats_add(&set_stats, start, bench_timer_read());
+
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Set should not fail");
+            goto remove_uid_its;
+        }
+
+        start = bench_timer_read();
+        status = psa_its_get(BENCH_UID, 0, BENCH_ASSET_SIZE, bench_output,
+                             &data_length);
+        bench_stats_add(&get_stats, start, bench_timer_read());
+
+        if (status != PSA_SUCCESS || data_length != BENCH_ASSET_SIZE) {
+            TEST_FAIL("Get should not fail");
+            goto remove_uid_its;
+        }
+    }
+
+    bench_stats_report("psa_its_set", &set_stats, BENCH_ASSET_SIZE);
+    bench_stats_report("psa_its_get", &get_stats, BENCH_ASSET_SIZE);
+
+    ret->val = TEST_PASSED;
+
+remove_uid_its:
+    if (psa_its_remove(BENCH_UID) != PSA_SUCCESS) {
+        TEST_FAIL("Remove should not fail");
+    }
+}
+
+void bench_sst_test(struct test_result_t *ret)
+{
+    struct bench_stats_t set_stats, get_stats;
+    psa_ps_status_t status;
+    uint32_t start, i;
+
+    if (bench_start(ret) != 0) {
+        return;
+    }
+
+    bench_stats_init(&set_stats);
+    bench_stats_init(&get_stats);
+
+    for (i = 0; i < BENCH_STORAGE_ITERATIONS; i++) {
+        start = bench_timer_read();
+        status = psa_ps_set(BENCH_UID, BENCH_ASSET_SIZE, bench_input,
+                            PSA_PS_FLAG_NONE);
+        bench_stats_add(&set_stats, start, bench_timer_read());
+
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Set should not fail");
+            goto remove_uid_sst;
+        }
+
+        start = bench_timer_read();
+        status = psa_ps_get(BENCH_UID, 0, BENCH_ASSET_SIZE, bench_output);
+        bench_stats_add(&get_stats, start, bench_timer_read());
+
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Get should not fail");
+            goto remove_uid_sst;
+        }
+    }
+
+    bench_stats_report("psa_ps_set", &set_stats, BENCH_ASSET_SIZE);
+    bench_stats_report("psa_ps_get", &get_stats, BENCH_ASSET_SIZE);
+
+    ret->val = TEST_PASSED;
+
+remove_uid_sst:
+    if (psa_ps_remove(BENCH_UID) != PSA_PS_SUCCESS) {
+        TEST_FAIL("Remove should not fail");
+    }
+}
+
+void bench_attest_test(struct test_result_t *ret)
+{
+    struct bench_stats_t token_stats, batch_stats;
+    enum psa_attest_err_t err;
+    uint32_t token_size;
+    uint32_t start, i;
+
+    if (bench_start(ret) != 0) {
+        return;
+    }
+
+    bench_stats_init(&token_stats);
+    bench_stats_init(&batch_stats);
+
+    for (i = 0; i < BENCH_ATTEST_ITERATIONS; i++) {
+        /* A fresh challenge for each token */
+        bench_input[0] = (uint8_t)i;
+
+        token_size = sizeof(bench_output);
+        start = bench_timer_read();
+        err = psa_initial_attest_get_token(bench_input,
+                                           PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32,
+                                           bench_output, &token_size);
+        bench_stats_add(&token_stats, start, bench_timer_read());
+
+        if (err != PSA_ATTEST_ERR_SUCCESS) {
+            TEST_FAIL("Get token should not fail");
+            return;
+        }
+
+        token_size = sizeof(bench_output);
+        start = bench_timer_read();
+        err = psa_initial_attest_get_batch_token(
+                                       bench_input,
+                                       PSA_INITIAL_ATTEST_CHALLENGE_SIZE_32,
+                                       PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES,
+                                       bench_output, &token_size);
+        bench_stats_add(&batch_stats, start, bench_timer_read());
+
+        if (err != PSA_ATTEST_ERR_SUCCESS) {
+            TEST_FAIL("Get batch token should not fail");
+            return;
+        }
+    }
+
+    bench_stats_report("psa_initial_attest_get_token", &token_stats, 0);
+    bench_stats_report("psa_initial_attest_get_batch_token (batch of 8)",
+                       &batch_stats, 0);
+
+    ret->val = TEST_PASSED;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __BENCHMARK_TESTS_COMMON_H__
+#define __BENCHMARK_TESTS_COMMON_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "psa/crypto.h"
+#include "test/framework/test_framework_helpers.h"
+
+/**
+ * \brief Number of timed calls made by each service benchmark
+ */
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS (64)
+#endif
+
+/**
+ * \brief Number of timed calls made by each storage benchmark. It is kept
+ *        lower than \ref BENCH_ITERATIONS as every set wears the flash.
+ */
+#ifndef BENCH_STORAGE_ITERATIONS
+#define BENCH_STORAGE_ITERATIONS (16)
+#endif
+
+/**
+ * \brief Size in bytes of the data processed by each crypto benchmark call
+ */
+#define BENCH_DATA_SIZE (1024)
+
+/**
+ * \brief Size in bytes of the asset written and read by the storage
+ *        benchmarks
+ */
+#define BENCH_ASSET_SIZE (64)
+
+/**
+ * \brief Initialises the cycle counter used to time the benchmarks
+ *
+ * The target implementation lives in benchmark_timer.c. Host builds provide
+ * their own in the host stand-in.
+ *
+ * \return Returns 0 if the counter is running and keeps counting in Secure
+ *         state, 1 otherwise
+ */
+int32_t bench_timer_init(void);
+
+/**
+ * \brief Reads the free running cycle counter
+ *
+ * \return Returns the current counter value. The counter may wrap, so only
+ *         differences between two reads are meaningful.
+ */
+uint32_t bench_timer_read(void);
+
+/**
+ * \brief Gets the frequency of the cycle counter
+ *
+ * \return Returns the number of counter ticks per second
+ */
+uint32_t bench_timer_freq(void);
+
+/**
+ * \brief Measures the round trip of the cheapest PSA service call: an ITS
+ *        get_info on a UID which does not exist
+ *
+ * \param[out] ret  Test result
+ */
+void bench_psa_call_test(struct test_result_t *ret);
+
+/**
+ * \brief Measures a complete multi-part hash (setup, update, finish) of
+ *        \ref BENCH_DATA_SIZE bytes
+ *
+ * \param[in]  alg  PSA hash algorithm
+ * \param[out] ret  Test result
+ */
+void bench_hash_test(const psa_algorithm_t alg, struct test_result_t *ret);
+
+/**
+ * \brief Measures a one-shot AEAD encryption of \ref BENCH_DATA_SIZE bytes
+ *
+ * \param[in]  key_type  PSA key type
+ * \param[in]  alg       PSA AEAD algorithm
+ * \param[out] ret       Test result
+ */
+void bench_aead_test(const psa_key_type_t key_type,
+                     const psa_algorithm_t alg,
+                     struct test_result_t *ret);
+
+/**
+ * \brief Measures ITS set and get of a \ref BENCH_ASSET_SIZE bytes asset
+ *
+ * \param[out] ret  Test result
+ */
+void bench_its_test(struct test_result_t *ret);
+
+/**
+ * \brief Measures SST set and get of a \ref BENCH_ASSET_SIZE bytes asset
+ *
+ * \param[out] ret  Test result
+ */
+void bench_sst_test(struct test_result_t *ret);
+
+/**
+ * \brief Measures the initial attestation token latency, for one challenge
+ *        and for a batch of \ref PSA_INITIAL_ATTEST_BATCH_MAX_CHALLENGES
+ *        challenges
+ *
+ * \param[out] ret  Test result
+ */
+void bench_attest_test(struct test_result_t *ret);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BENCHMARK_TESTS_COMMON_H__ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "benchmark_tests_common.h"
+
+/*
+ * The benchmarks are timed with the DWT cycle counter. The registers are
+ * accessed through their architectural addresses, which are the same on all
+ * Armv7-M and Armv8-M Mainline cores, so that the test library does not depend
+ * on the CMSIS device header of the platform.
+ */
+#define BENCH_DEMCR       (*(volatile uint32_t *)0xE000EDFCU)
+#define BENCH_DWT_CTRL    (*(volatile uint32_t *)0xE0001000U)
+#define BENCH_DWT_CYCCNT  (*(volatile uint32_t *)0xE0001004U)
+
+#define BENCH_DEMCR_TRCENA         (1UL << 24)
+#define BENCH_DWT_CTRL_NOCYCCNT    (1UL << 25)
+#define BENCH_DWT_CTRL_CYCCNTENA   (1UL << 0)
+
+#if defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+/*
+ * On Armv8-M the counter stops while the PE is in Secure state if the Secure
+ * cycle count is disabled, or if Secure non-invasive debug is not allowed, as
+ * set by DAUTHCTRL and the authentication interface. A benchmark run from the
+ * Non-secure side would then only count the Non-secure part of each call. The
+ * resulting state is read from DAUTHSTATUS, which both states can access.
+ */
+#define BENCH_DAUTHSTATUS  (*(volatile uint32_t *)0xE000EFB8U)
+
+#define BENCH_DWT_CTRL_CYCDISS          (1UL << 23)
+#define BENCH_DAUTHSTATUS_SNID_MASK     (3UL << 6)
+#define BENCH_DAUTHSTATUS_SNID_DISABLED (2UL << 6)
+#endif
+
+/* Core clock frequency, maintained by the CMSIS system file of the platform */
+extern uint32_t SystemCoreClock;
+
+int32_t bench_timer_init(void)
+{
+    uint32_t start;
+
+    BENCH_DEMCR |= BENCH_DEMCR_TRCENA;
+
+    if ((BENCH_DWT_CTRL & BENCH_DWT_CTRL_NOCYCCNT) != 0) {
+        return 1;
+    }
+
+#if defined(BENCH_DWT_CTRL_CYCDISS)
+    /* Refuse to time calls which would not be fully counted */
+    if (((BENCH_DWT_CTRL & BENCH_DWT_CTRL_CYCDISS) != 0) ||
+        ((BENCH_DAUTHSTATUS & BENCH_DAUTHSTATUS_SNID_MASK) ==
+         BENCH_DAUTHSTATUS_SNID_DISABLED)) {
+        return 1;
+    }
+#endif
+
+    BENCH_DWT_CTRL |= BENCH_DWT_CTRL_CYCCNTENA;
+
+    /* The counter may not be accessible from this security state, in which
+     * case it reads as a constant.
+     */
+    start = BENCH_DWT_CYCCNT;
+    __asm volatile ("nop");
+    __asm volatile ("nop");
+
+    return (BENCH_DWT_CYCCNT != start) ? 0 : 1;
+}
+
+uint32_t bench_timer_read(void)
+{
+    return BENCH_DWT_CYCCNT;
+}
+
+uint32_t bench_timer_freq(void)
+{
+    return SystemCoreClock;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "benchmark_ns_tests.h"
+#include "../benchmark_tests_common.h"
+
+/* List of tests */
+static void tfm_bench_test_2001(struct test_result_t *ret);
+static void tfm_bench_test_2002(struct test_result_t *ret);
+static void tfm_bench_test_2003(struct test_result_t *ret);
+static void tfm_bench_test_2004(struct test_result_t *ret);
+static void tfm_bench_test_2005(struct test_result_t *ret);
+static void tfm_bench_test_2006(struct test_result_t *ret);
+static void tfm_bench_test_2007(struct test_result_t *ret);
+
+static struct test_t benchmark_tests[] = {
+    {&tfm_bench_test_2001, "TFM_BENCH_TEST_2001",
+     "Non-secure PSA service call round trip", {0} },
+    {&tfm_bench_test_2002, "TFM_BENCH_TEST_2002",
+     "Non-secure Hash (SHA-256) throughput", {0} },
+    {&tfm_bench_test_2003, "TFM_BENCH_TEST_2003",
+     "Non-secure AEAD (AES-128-CCM) throughput", {0} },
+    {&tfm_bench_test_2004, "TFM_BENCH_TEST_2004",
+     "Non-secure AEAD (AES-128-GCM) throughput", {0} },
+    {&tfm_bench_test_2005, "TFM_BENCH_TEST_2005",
+     "Non-secure ITS set/get latency", {0} },
+    {&tfm_bench_test_2006, "TFM_BENCH_TEST_2006",
+     "Non-secure SST set/get latency", {0} },
+    {&tfm_bench_test_2007, "TFM_BENCH_TEST_2007",
+     "Non-secure initial attestation token latency", {0} },
+};
+
+void register_testsuite_ns_benchmark(struct test_suite_t *p_test_suite)
+{
+    uint32_t list_size = (sizeof(benchmark_tests) /
+                          sizeof(benchmark_tests[0]));
+
+    set_testsuite("Benchmark non-secure tests (TFM_BENCH_TEST_2XXX)",
+                  benchmark_tests, list_size, p_test_suite);
+}
+
+/**
+ * \brief Non-secure benchmarks of the PSA services
+ *
+ * \details Each test times a fixed number of calls to a service API from the
+ *          non-secure test thread and logs the operations per second and
+ *          the cycles per call. A test only fails if one of the calls fails.
+ *
+ */
+static void tfm_bench_test_2001(struct test_result_t *ret)
+{
+    bench_psa_call_test(ret);
+}
+
+static void tfm_bench_test_2002(struct test_result_t *ret)
+{
+    bench_hash_test(PSA_ALG_SHA_256, ret);
+}
+
+static void tfm_bench_test_2003(struct test_result_t *ret)
+{
+    bench_aead_test(PSA_KEY_TYPE_AES, PSA_ALG_CCM, ret);
+}
+
+static void tfm_bench_test_2004(struct test_result_t *ret)
+{
+    bench_aead_test(PSA_KEY_TYPE_AES, PSA_ALG_GCM, ret);
+}
+
+static void tfm_bench_test_2005(struct test_result_t *ret)
+{
+    bench_its_test(ret);
+}
+
+static void tfm_bench_test_2006(struct test_result_t *ret)
+{
+    bench_sst_test(ret);
+}
+
+static void tfm_bench_test_2007(struct test_result_t *ret)
+{
+    bench_attest_test(ret);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2019, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "benchmark_s_tests.h"
+#include "../benchmark_tests_common.h"
+
+/* List of tests */
+static void tfm_bench_test_1001(struct test_result_t *ret);
+static void tfm_bench_test_1002(struct test_result_t *ret);
+static void tfm_bench_test_1003(struct test_result_t *ret);
+static void tfm_bench_test_1004(struct test_result_t *ret);
+static void tfm_bench_test_1005(struct test_result_t *ret);
+static void tfm_bench_test_1006(struct test_result_t *ret);
+static void tfm_bench_test_1007(struct test_result_t *ret);
+
+static struct test_t benchmark_tests[] = {
+    {&tfm_bench_test_1001, "TFM_BENCH_TEST_1001",
+     "Secure PSA service call round trip", {0} },
+    {&tfm_bench_test_1002, "TFM_BENCH_TEST_1002",
+     "Secure Hash (SHA-256) throughput", {0} },
+    {&tfm_bench_test_1003, "TFM_BENCH_TEST_1003",
+     "Secure AEAD (AES-128-CCM) throughput", {0} },
+    {&tfm_bench_test_1004, "TFM_BENCH_TEST_1004",
+     "Secure AEAD (AES-128-GCM) throughput", {0} },
+    {&tfm_bench_test_1005, "TFM_BENCH_TEST_1005",
+     "Secure ITS set/get latency", {0} },
+    {&tfm_bench_test_1006, "TFM_BENCH_TEST_1006",
+     "Secure SST set/get latency", {0} },
+    {&tfm_bench_test_1007, "TFM_BENCH_TEST_1007",
+     "Secure initial attestation token latency", {0} },
+};
+
+void register_testsuite_s_benchmark(struct test_suite_t *p_test_suite)
+{
+    uint32_t list_size = (sizeof(benchmark_tests) /
+                          sizeof(benchmark_tests[0]));
+
+    set_testsuite("Benchmark secure tests (TFM_BENCH_TEST_1XXX)",
+                  benchmark_tests, list_size, p_test_suite);
+}
+
+/**
+ * \brief Secure benchmarks of the PSA services
+ *
+ * \details Each test times a fixed number of calls to a service API from the
+ *          secure test partition and logs the operations per second and the
+ *          cycles per call. A test only fails if one of the calls fails.
+ *
+ */
+static void tfm_bench_test_1001(struct test_result_t *ret)
+{
+    bench_psa_call_test(ret);
+}
+
+static void tfm_bench_test_1002(struct test_result_t *ret)
+{
+    bench_hash_test(PSA_ALG_SHA_256, ret);
+}
+
+static void tfm_bench_test_1003(struct test_result_t *ret)
+{
+    bench_aead_test(PSA_KEY_TYPE_AES, PSA_ALG_CCM, ret);
+}
+
+static void tfm_bench_test_1004(struct test_result_t *ret)
+{
+    bench_aead_test(PSA_KEY_TYPE_AES, PSA_ALG_GCM, ret);
+}
+
+static void tfm_bench_test_1005(struct test_result_t *ret)
+{
+    bench_its_test(ret);
+}
+
+static void tfm_bench_test_1006(struct test_result_t *ret)
+{
+    bench_sst_test(ret);
+}
+
+static void tfm_bench_test_1007(struct test_result_t *ret)
+{
+    bench_attest_test(ret);
+}
@@ -471,6 +471,137 @@ void psa_hash_test(const psa_algorithm_t alg,
     ret->val = TEST_PASSED;
 }
 
+void psa_hash_interleaved_test(struct test_result_t *ret)
+{
+    const char *msg[] = {"This is my test message, ",
+                         "please generate a hash for this."};
+
+    const size_t msg_size[] = {25, 32}; /* Length in bytes of msg[0], msg[1] */
+    const uint32_t msg_num = sizeof(msg)/sizeof(msg[0]);
+    const psa_algorithm_t alg = PSA_ALG_SHA_256;
+    uint32_t idx, op;
+
+    psa_status_t status;
+    psa_hash_operation_t handle[2] = {psa_hash_operation_init(),
+                                      psa_hash_operation_init()};
+    psa_hash_operation_t stale_handle;
+
+    /* Setup two hash operations which are going to be active at once */
+    for (op=0; op<2; op++) {
+        status = psa_hash_setup(&handle[op], alg);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Error setting up hash operation object");
+            return;
+        }
+    }
+
+    /* Interleave the updates of the two operations */
+    for (idx=0; idx<msg_num; idx++) {
+        for (op=0; op<2; op++) {
+            status = psa_hash_update(&handle[op],
+                                     (const uint8_t *)msg[idx], msg_size[idx]);
+            if (status != PSA_SUCCESS) {
+                TEST_FAIL("Error updating the hash operation object");
+                return;
+            }
+        }
+    }
+
+    /* Cycle until idx points to the correct index in the algorithm table */
+    for (idx=0; hash_alg[idx] != alg; idx++);
+
+    /* Keep a copy of the handle which is about to be released */
+    stale_handle = handle[0];
+
+    status = psa_hash_verify(&handle[0], &(hash_val[idx][0]),
+                             PSA_HASH_SIZE(alg));
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error verifying the first hash operation object");
+        return;
+    }
+
+    /* Reuse the context which has just been released */
+    status = psa_hash_setup(&handle[0], alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up hash operation object");
+        return;
+    }
+
+    /* The released handle must not give access to the new operation */
+    status = psa_hash_update(&stale_handle,
+                             (const uint8_t *)msg[0], msg_size[0]);
+    if (status != PSA_ERROR_BAD_STATE) {
+        TEST_FAIL("Stale handle should not be accepted");
+        return;
+    }
+
+    status = psa_hash_abort(&handle[0]);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error aborting the hash operation object");
+        return;
+    }
+
+    /* The second operation must not have been affected by the first one */
+    status = psa_hash_verify(&handle[1], &(hash_val[idx][0]),
+                             PSA_HASH_SIZE(alg));
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error verifying the second hash operation object");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+void psa_hash_concurrent_test(struct test_result_t *ret)
+{
+    const psa_algorithm_t alg = PSA_ALG_SHA_256;
+    uint32_t op;
+
+    psa_status_t status;
+    psa_hash_operation_t handle[TEST_CONC_HASH_OPER_NUM + 1];
+
+    for (op=0; op<=TEST_CONC_HASH_OPER_NUM; op++) {
+        handle[op] = psa_hash_operation_init();
+    }
+
+    /* Setup as many hash operations as the service can have active at once */
+    for (op=0; op<TEST_CONC_HASH_OPER_NUM; op++) {
+        status = psa_hash_setup(&handle[op], alg);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Error setting up hash operation object");
+            goto abort_operations;
+        }
+    }
+
+    /* One more operation is above the limit */
+    status = psa_hash_setup(&handle[TEST_CONC_HASH_OPER_NUM], alg);
+    if (status != PSA_ERROR_NOT_PERMITTED) {
+        TEST_FAIL("Hash operation above the limit should not be set up");
+        goto abort_operations;
+    }
+
+    /* Releasing an operation makes room for a new one */
+    status = psa_hash_abort(&handle[0]);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error aborting the hash operation object");
+        goto abort_operations;
+    }
+
+    status = psa_hash_setup(&handle[0], alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up hash operation object");
+        goto abort_operations;
+    }
+
+    ret->val = TEST_PASSED;
+
+abort_operations:
+    /* Aborting an operation which has not been set up just fails */
+    for (op=0; op<=TEST_CONC_HASH_OPER_NUM; op++) {
+        (void)psa_hash_abort(&handle[op]);
+    }
+}
+
 static const uint8_t hmac_val[][PSA_HASH_SIZE(PSA_ALG_SHA_512)] = {
     {0x0d, 0xa6, 0x9d, 0x02, 0x43, 0x17, 0x3e, 0x7e, /*!< SHA-1 */
      0xe7, 0x3b, 0xc6, 0xa9, 0x51, 0x06, 0x8a, 0xea,
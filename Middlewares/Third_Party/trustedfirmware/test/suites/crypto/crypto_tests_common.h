@@ -21,6 +21,16 @@ extern "C" {
  */
 #define BIT_SIZE_TEST_KEY (128)
 
+/**
+ * \brief Number of hash operations which the service can have active at the
+ *        same time, i.e. the lowest of its TFM_CRYPTO_CONC_OPER_NUM and
+ *        TFM_CRYPTO_CONC_HASH_OPER_NUM
+ *
+ */
+#ifndef TEST_CONC_HASH_OPER_NUM
+#define TEST_CONC_HASH_OPER_NUM (8)
+#endif
+
 /**
  * \brief Size of the long key to use in tests in bits
  *
@@ -100,6 +110,22 @@ void psa_invalid_cipher_test(const psa_key_type_t key_type,
  */
 void psa_hash_test(const psa_algorithm_t alg,
                    struct test_result_t *ret);
+/**
+ * \brief Tests two multipart hash operations active at the same time, and
+ *        that the handle of a released operation is rejected
+ *
+ * \param[out] ret Test result
+ *
+ */
+void psa_hash_interleaved_test(struct test_result_t *ret);
+/**
+ * \brief Tests that as many hash operations as the service allows can be
+ *        active at the same time, and that one more is refused
+ *
+ * \param[out] ret Test result
+ *
+ */
+void psa_hash_concurrent_test(struct test_result_t *ret);
 /**
  * \brief Tests different MAC algorithms
  *
@@ -31,6 +31,8 @@ static void tfm_crypto_test_5030(struct test_result_t *ret);
 static void tfm_crypto_test_5031(struct test_result_t *ret);
 static void tfm_crypto_test_5032(struct test_result_t *ret);
 static void tfm_crypto_test_5033(struct test_result_t *ret);
+static void tfm_crypto_test_5034(struct test_result_t *ret);
+static void tfm_crypto_test_5035(struct test_result_t *ret);
 
 static struct test_t crypto_tests[] = {
     {&tfm_crypto_test_5001, "TFM_CRYPTO_TEST_5001",
@@ -75,6 +77,10 @@ static struct test_t crypto_tests[] = {
      "Secure key policy interface", {0} },
     {&tfm_crypto_test_5033, "TFM_CRYPTO_TEST_5033",
      "Secure key policy check permissions", {0} },
+    {&tfm_crypto_test_5034, "TFM_CRYPTO_TEST_5034",
+     "Secure interleaved hash operations", {0} },
+    {&tfm_crypto_test_5035, "TFM_CRYPTO_TEST_5035",
+     "Secure concurrent hash operations up to the limit", {0} },
 };
 
 void register_testsuite_s_crypto_interface(struct test_suite_t *p_test_suite)
@@ -200,3 +206,13 @@ static void tfm_crypto_test_5033(struct test_result_t *ret)
 {
     psa_policy_invalid_policy_usage_test(ret);
 }
+
+static void tfm_crypto_test_5034(struct test_result_t *ret)
+{
+    psa_hash_interleaved_test(ret);
+}
+
+static void tfm_crypto_test_5035(struct test_result_t *ret)
+{
+    psa_hash_concurrent_test(ret);
+}
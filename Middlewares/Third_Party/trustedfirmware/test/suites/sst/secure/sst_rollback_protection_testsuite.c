@@ -34,6 +34,11 @@
 #define READ_DATA        "############################################"
 #define RESULT_DATA      ("####" WRITE_DATA "####")
 
+/* Number of changes done in test 10. It is larger than the default number of
+ * object table change log records, so that the object table is also written.
+ */
+#define NUM_LOGGED_CHANGES 10
+
 /*
  * Summary of tests covered by the test suite.
  *
@@ -50,6 +55,9 @@
  *
  * Test 9 checks the SST result when the non-volatile (NV) counter 1 cannot be
  * incremented (e.g it has reached its maximum value).
+ *
+ * Test 10 checks the SST area version when it is stored in the object table
+ * change log, after each change, with the cases of tests 1, 2 and 4.
  */
 
 /* List of tests */
@@ -62,6 +70,7 @@ static void tfm_sst_test_4006(struct test_result_t *ret);
 static void tfm_sst_test_4007(struct test_result_t *ret);
 static void tfm_sst_test_4008(struct test_result_t *ret);
 static void tfm_sst_test_4009(struct test_result_t *ret);
+static void tfm_sst_test_4010(struct test_result_t *ret);
 
 static struct test_t interface_tests[] = {
     {&tfm_sst_test_4001, "TFM_SST_TEST_4001",
@@ -88,6 +97,9 @@ static struct test_t interface_tests[] = {
      "and SST area version match NV counter 3 value", {0}},
     {&tfm_sst_test_4009, "TFM_SST_TEST_4009",
      "Check SST area version when NV counter 1 cannot be incremented", {0}},
+    {&tfm_sst_test_4010, "TFM_SST_TEST_4010",
+     "Check SST area version when it is stored in the object table change log",
+     {0}},
 };
 
 void register_testsuite_s_rollback_protection(struct test_suite_t *p_test_suite)
@@ -812,3 +824,151 @@ static void tfm_sst_test_4009(struct test_result_t *ret)
 
     ret->val = TEST_PASSED;
 }
+
+/**
+ * \brief Check SST area version when it is stored in the object table change
+ *        log. For each change, it checks that the SST area version is valid
+ *        when NV counters 1/2/3 have the same value, and when it matches NV
+ *        counters 2 and 3 values after a power cut before the next change is
+ *        written. Finally, it checks that an old SST area version is invalid.
+ */
+static void tfm_sst_test_4010(struct test_result_t *ret)
+{
+    psa_ps_status_t status;
+    const psa_ps_uid_t uid = TEST_UID;
+    const psa_ps_create_flags_t flags = PSA_PS_FLAG_NONE;
+    const uint32_t data_len = WRITE_DATA_SIZE;
+    const uint32_t offset = 0;
+    const uint8_t write_data[] = WRITE_DATA;
+    uint8_t read_data[] = READ_DATA;
+    uint32_t i;
+
+    for (i = 0; i < NUM_LOGGED_CHANGES; i++) {
+        /* Sets data in the asset to generate a new SST area version */
+        status = psa_ps_set(uid, data_len, write_data, flags);
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Set should not fail with valid UID");
+            return;
+        }
+
+        /* Simulates a reboot in the system by calling sst_system_prepare().
+         *
+         * Prepare should not fail as the NV counters have the same values and
+         * the SST area version is aligned with those values.
+         */
+        status = sst_system_prepare();
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("SST system prepare should not fail");
+            return;
+        }
+
+        /* Gets the data from the asset */
+        (void)tfm_memcpy(read_data, READ_DATA, sizeof(read_data));
+        status = psa_ps_get(uid, offset, data_len, (read_data +
+                                                    HALF_PADDING_SIZE));
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Get should not fail");
+            return;
+        }
+
+        if (tfm_memcmp(read_data, RESULT_DATA, sizeof(read_data)) != 0) {
+            TEST_FAIL("The data should not have changed");
+            return;
+        }
+
+        /* Increments NV counter 1 to simulate a power cut before the next
+         * change is written.
+         */
+        status = test_sst_increment_nv_counter(TFM_SST_NV_COUNTER_1);
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Increment should not fail");
+            return;
+        }
+
+        /* Prepare should not fail as the SST area version match the NV
+         * counter 2 and 3 values.
+         */
+        status = sst_system_prepare();
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("SST system prepare should not fail");
+            return;
+        }
+
+        /* Gets the data from the asset */
+        (void)tfm_memcpy(read_data, READ_DATA, sizeof(read_data));
+        status = psa_ps_get(uid, offset, data_len, (read_data +
+                                                    HALF_PADDING_SIZE));
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Get should not fail");
+            return;
+        }
+
+        if (tfm_memcmp(read_data, RESULT_DATA, sizeof(read_data)) != 0) {
+            TEST_FAIL("The data should not have changed");
+            return;
+        }
+    }
+
+    /* Increments all counters to make that SST area version old/invalid */
+    status = test_sst_increment_nv_counter(TFM_SST_NV_COUNTER_1);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Increment should not fail");
+        return;
+    }
+
+    status = test_sst_increment_nv_counter(TFM_SST_NV_COUNTER_2);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Increment should not fail");
+        return;
+    }
+
+    status = test_sst_increment_nv_counter(TFM_SST_NV_COUNTER_3);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Increment should not fail");
+        return;
+    }
+
+    /* Prepare should fail as the SST area version does not match the
+     * NV counters values.
+     */
+    status = sst_system_prepare();
+    if (status != PSA_PS_ERROR_OPERATION_FAILED) {
+        TEST_FAIL("SST system prepare should fail as version is old");
+        return;
+    }
+
+    /* Aligns NV counters with the SST area version */
+    status = test_sst_decrement_nv_counter(TFM_SST_NV_COUNTER_1);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Decrement should not fail");
+        return;
+    }
+
+    status = test_sst_decrement_nv_counter(TFM_SST_NV_COUNTER_2);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Decrement should not fail");
+        return;
+    }
+
+    status = test_sst_decrement_nv_counter(TFM_SST_NV_COUNTER_3);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Decrement should not fail");
+        return;
+    }
+
+    /* Calls sst_system_prepare to mark the SST area as a valid image */
+    status = sst_system_prepare();
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("SST system prepare should not fail");
+        return;
+    }
+
+    /* Removes the asset to clean up storage for the next test */
+    status = psa_ps_remove(uid);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Remove should not fail with valid UID");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
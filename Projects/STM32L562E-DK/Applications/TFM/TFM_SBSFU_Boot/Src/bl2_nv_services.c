@@ -57,6 +57,10 @@
 #include "flash_layout.h"
 #include "stm32l5xx_ll_crc.h"
 #include "stm32l5xx_ll_bus.h"
+#include "mcuboot_config/mcuboot_config.h"
+#ifdef MCUBOOT_VALIDATE_CACHE
+#include "bootutil/validate_cache.h"
+#endif /* MCUBOOT_VALIDATE_CACHE */
 
 /** @defgroup NVCNT Implementation NVCNT Implementation
   * @{
@@ -424,6 +428,65 @@ enum tfm_plat_err_t tfm_plat_read_nv_counter(enum tfm_nv_counter_t counter_id,
     return TFM_PLAT_ERR_SYSTEM_ERR;
   }
 }
+
+#ifdef MCUBOOT_VALIDATE_CACHE
+/**
+  * @brief  Read the HUK authenticating the validation records of BL2.
+  *         Without TFM_HUK_RANDOM_GENERATION, the header of the NV area holds
+  *         no device-unique key, and the records are not used.
+  * @param  key pointer to the key buffer
+  * @param  key_size key size, HUK_SIZE
+  * @retval 0 on success, -1 if no HUK is available
+  */
+int32_t boot_validate_cache_key_get(uint8_t *key, size_t key_size)
+{
+#ifdef TFM_HUK_RANDOM_GENERATION
+  /* Set to __IO to force value cleaning */
+  __IO NVCNT_ELEMENT_TYPE addressvalue = 0U;
+  __IO NVCNT_DATA_TYPE huk[HUK_SIZE / sizeof(NVCNT_DATA_TYPE)];
+  int32_t loop = sizeof(huk) / sizeof(NVCNT_DATA_TYPE) - 1;
+  uint32_t address = BL2_NV_COUNTERS_AREA_ADDR;
+  int32_t ret = 0;
+
+  if (key_size != HUK_SIZE)
+  {
+    return -1;
+  }
+  /* The HUK is stored in revert order, as written by Write_Header */
+  while ((loop >= 0) && (ret == 0))
+  {
+    if ((FLASH_DEV_NAME.ReadData(address, (void *)&addressvalue,
+                                 sizeof(addressvalue)) != ARM_DRIVER_OK)
+        || (addressvalue == NVCNT_PAGESTAT_ERASED)
+        || (NVCNT_ID_VALUE(addressvalue) != NVCNT_ID_HUK)
+        || (CalculateCrc(NVCNT_DATA_VALUE(addressvalue), NVCNT_ID_VALUE(addressvalue))
+            != NVCNT_CRC_VALUE(addressvalue)))
+    {
+      ret = -1;
+    }
+    else
+    {
+      huk[loop] = NVCNT_DATA_VALUE(addressvalue);
+    }
+    address += sizeof(NVCNT_ELEMENT_TYPE);
+    loop--;
+  }
+  if (ret == 0)
+  {
+    memcpy(key, (const void *)huk, HUK_SIZE);
+  }
+
+  /* clean huk footprint  */
+  memset((void *)huk, 0, sizeof(huk));
+  addressvalue = 0;
+  return ret;
+#else
+  (void)key;
+  (void)key_size;
+  return -1;
+#endif /* TFM_HUK_RANDOM_GENERATION */
+}
+#endif /* MCUBOOT_VALIDATE_CACHE */
 /**
   * @}
   */